@@ -0,0 +1,510 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "../base/noncopymove.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom {
+
+/// A concurrency model of COM apartment.
+enum class Apartment_model {
+  /// Multithreaded apartment (MTA).
+  multithreaded,
+  /// Single-threaded apartment (STA).
+  apartment_threaded
+};
+
+// -----------------------------------------------------------------------------
+// Apartment_context
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief The context of the worker thread of an apartment pool.
+ *
+ * @details The context owns the thread-local objects created with `local()`.
+ * These objects (typically the proxies which are bound to the apartment) are
+ * destroyed in reverse order of creation before the COM library of the
+ * worker is uninitialized.
+ */
+class Apartment_context final : private Noncopymove {
+public:
+  /// @returns The context of the calling thread, or `nullptr` if it's not a
+  /// worker of an apartment pool.
+  static Apartment_context* current() noexcept
+  {
+    return current_ref();
+  }
+
+  /// @returns The index of the worker.
+  std::size_t worker_index() const noexcept
+  {
+    return worker_index_;
+  }
+
+  /// @returns The concurrency model of the apartment of the worker.
+  Apartment_model model() const noexcept
+  {
+    return model_;
+  }
+
+  /**
+   * @returns The object of type `T` of this worker. If there is no such an
+   * object yet, it's created as if by `make()`.
+   */
+  template<class T, class Make>
+  T& local(Make&& make)
+  {
+    for (auto& entry : locals_) {
+      if (*entry.type == typeid(T))
+        return *static_cast<T*>(entry.object.get());
+    }
+    Object object{new T(std::invoke(std::forward<Make>(make))), &destroy<T>};
+    auto* const result = static_cast<T*>(object.get());
+    locals_.push_back(Local{&typeid(T), std::move(object)});
+    return *result;
+  }
+
+  /// @overload
+  template<class T>
+  T& local()
+  {
+    return local<T>([]{return T{};});
+  }
+
+  /// Destroys the objects created with `local()` in reverse order.
+  void clear_locals() noexcept
+  {
+    while (!locals_.empty())
+      locals_.pop_back();
+  }
+
+private:
+  template<class> friend class Basic_apartment_pool;
+
+  using Object = std::unique_ptr<void, void(*)(void*)>;
+
+  struct Local final {
+    const std::type_info* type{};
+    Object object;
+  };
+
+  const void* pool_{};
+  std::size_t worker_index_{};
+  Apartment_model model_{Apartment_model::multithreaded};
+  std::vector<Local> locals_;
+
+  Apartment_context(const void* const pool, const std::size_t worker_index,
+    const Apartment_model model) noexcept
+    : pool_{pool}
+    , worker_index_{worker_index}
+    , model_{model}
+  {}
+
+  static Apartment_context*& current_ref() noexcept
+  {
+    thread_local Apartment_context* result{};
+    return result;
+  }
+
+  template<class T>
+  static void destroy(void* const object) noexcept
+  {
+    delete static_cast<T*>(object);
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Affinity
+// -----------------------------------------------------------------------------
+
+/// A hint of where to run the task.
+class Affinity final {
+public:
+  /// Any worker (the calling one if the caller is a worker of the pool).
+  static Affinity any() noexcept
+  {
+    return Affinity{};
+  }
+
+  /// The worker `index` preferably. Other workers may steal the task.
+  static Affinity prefer(const std::size_t index) noexcept
+  {
+    return Affinity{index, false};
+  }
+
+  /**
+   * @brief The worker `index` only.
+   *
+   * @details Required for the tasks which use the proxies owned by the
+   * particular (in particular, single-threaded) apartment.
+   */
+  static Affinity require(const std::size_t index) noexcept
+  {
+    return Affinity{index, true};
+  }
+
+  Affinity() noexcept = default;
+
+  /// @returns The worker index if any.
+  std::optional<std::size_t> worker() const noexcept
+  {
+    return worker_;
+  }
+
+  /// @returns `true` if the task must not be stolen.
+  bool is_strict() const noexcept
+  {
+    return is_strict_;
+  }
+
+private:
+  std::optional<std::size_t> worker_;
+  bool is_strict_{};
+
+  Affinity(const std::size_t worker, const bool is_strict) noexcept
+    : worker_{worker}
+    , is_strict_{is_strict}
+  {}
+};
+
+// -----------------------------------------------------------------------------
+// Basic_apartment_pool
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief A pool of worker threads each of which runs in its own initialized
+ * COM apartment.
+ *
+ * @details Every worker has a queue of its own. The tasks which are not
+ * pinned to a worker can be stolen by the idle workers. The pool is
+ * stopped by the destructor as follows:
+ *   -# the queued tasks are completed;
+ *   -# the objects created with `Apartment_context::local()` are destroyed
+ *   on their workers;
+ *   -# the apartments are destroyed (i.e. COM is uninitialized) on their
+ *   workers;
+ *   -# the workers are joined.
+ *
+ * @tparam Apartment The type which initializes COM while alive. It must be
+ * constructible from `Apartment_model`. (See `Apartment_pool`.)
+ */
+template<class Apartment>
+class Basic_apartment_pool final : private Noncopymove {
+public:
+  /// The options of the pool.
+  struct Options final {
+    std::size_t worker_count{std::max(std::thread::hardware_concurrency(), 1u)};
+    Apartment_model model{Apartment_model::multithreaded};
+    /// Called on each worker after its apartment is initialized.
+    std::function<void(Apartment_context&)> on_start;
+  };
+
+  /// The statistics of a worker.
+  struct Worker_stats final {
+    std::size_t executed{};
+    /// The number of tasks taken from the queues of other workers.
+    std::size_t stolen{};
+  };
+
+  /// Completes the queued tasks and stops the pool.
+  ~Basic_apartment_pool()
+  {
+    stop();
+  }
+
+  /// The constructor.
+  Basic_apartment_pool()
+    : Basic_apartment_pool{Options{}}
+  {}
+
+  /**
+   * @brief Starts the workers.
+   *
+   * @throws The exception thrown by construction of `Apartment` or by
+   * `options.on_start` on any worker. The started workers are stopped then.
+   */
+  explicit Basic_apartment_pool(Options options)
+    : options_{std::move(options)}
+  {
+    if (!options_.worker_count)
+      throw std::invalid_argument{"invalid worker count of apartment pool"};
+
+    workers_.reserve(options_.worker_count);
+    for (std::size_t i{}; i < options_.worker_count; ++i)
+      workers_.push_back(std::make_unique<Worker>());
+
+    std::vector<std::future<void>> started;
+    started.reserve(workers_.size());
+    try {
+      for (std::size_t i{}; i < workers_.size(); ++i) {
+        std::promise<void> promise;
+        started.push_back(promise.get_future());
+        workers_[i]->thread = std::thread{&Basic_apartment_pool::run, this, i,
+          std::move(promise)};
+      }
+      for (auto& future : started)
+        future.get();
+    } catch (...) {
+      stop();
+      throw;
+    }
+  }
+
+  /**
+   * @brief Submits the task.
+   *
+   * @param task The callable of signature `R(Apartment_context&)`.
+   *
+   * @returns The future of the result of `task`.
+   */
+  template<class F>
+  auto submit(F&& task, const Affinity affinity = {})
+    -> std::future<std::invoke_result_t<std::decay_t<F>&, Apartment_context&>>
+  {
+    using R = std::invoke_result_t<std::decay_t<F>&, Apartment_context&>;
+    std::packaged_task<R(Apartment_context&)> packaged{std::forward<F>(task)};
+    auto result = packaged.get_future();
+    enqueue(Task{std::move(packaged)}, affinity);
+    return result;
+  }
+
+  /// @returns The number of workers.
+  std::size_t worker_count() const noexcept
+  {
+    return workers_.size();
+  }
+
+  /// @returns The statistics of the worker `index`.
+  Worker_stats stats(const std::size_t index) const
+  {
+    const auto& worker = *workers_.at(index);
+    return Worker_stats{worker.executed.load(std::memory_order_relaxed),
+      worker.stolen.load(std::memory_order_relaxed)};
+  }
+
+private:
+  class Task final {
+  public:
+    Task() = default;
+
+    template<class F>
+    explicit Task(F&& f)
+      : impl_{std::make_unique<Impl<std::decay_t<F>>>(std::forward<F>(f))}
+    {}
+
+    void operator()(Apartment_context& context)
+    {
+      impl_->run(context);
+    }
+
+  private:
+    struct Base {
+      virtual ~Base() = default;
+      virtual void run(Apartment_context& context) = 0;
+    };
+
+    template<class F>
+    struct Impl final : Base {
+      explicit Impl(F&& f)
+        : f{std::move(f)}
+      {}
+
+      void run(Apartment_context& context) override
+      {
+        f(context);
+      }
+
+      F f;
+    };
+
+    std::unique_ptr<Base> impl_;
+  };
+
+  struct Worker final {
+    std::mutex mutex;
+    std::deque<Task> shared;
+    std::deque<Task> pinned;
+    std::atomic_size_t pinned_count{};
+    std::atomic_size_t executed{};
+    std::atomic_size_t stolen{};
+    std::thread thread;
+  };
+
+  Options options_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic_size_t next_worker_{};
+  std::atomic_size_t shared_count_{};
+  std::atomic_size_t sleeper_count_{};
+  std::atomic_bool is_stopping_{};
+  std::mutex sleep_mutex_;
+  std::condition_variable wakeup_;
+
+  void enqueue(Task&& task, const Affinity affinity)
+  {
+    if (is_stopping_.load())
+      throw std::logic_error{"cannot submit task to stopped apartment pool"};
+
+    std::size_t index{};
+    if (const auto worker = affinity.worker()) {
+      if (*worker >= workers_.size())
+        throw std::out_of_range{"invalid worker index of apartment pool"};
+      index = *worker;
+    } else if (const auto* const ctx = Apartment_context::current();
+      ctx && ctx->pool_ == this)
+      index = ctx->worker_index();
+    else
+      index = next_worker_.fetch_add(1, std::memory_order_relaxed)
+        % workers_.size();
+
+    auto& worker = *workers_[index];
+    {
+      const std::lock_guard lg{worker.mutex};
+      if (affinity.is_strict()) {
+        worker.pinned.push_back(std::move(task));
+        ++worker.pinned_count;
+      } else {
+        worker.shared.push_back(std::move(task));
+        ++shared_count_;
+      }
+    }
+
+    // Pairs with the increment of the sleeper count by the waiting workers.
+    if (sleeper_count_.load()) {
+      const std::lock_guard lg{sleep_mutex_};
+      if (affinity.is_strict())
+        wakeup_.notify_all();
+      else
+        wakeup_.notify_one();
+    }
+  }
+
+  std::optional<Task> take(const std::size_t index)
+  {
+    auto& self = *workers_[index];
+    {
+      const std::lock_guard lg{self.mutex};
+      if (!self.pinned.empty()) {
+        std::optional<Task> result{std::move(self.pinned.front())};
+        self.pinned.pop_front();
+        --self.pinned_count;
+        return result;
+      } else if (!self.shared.empty()) {
+        std::optional<Task> result{std::move(self.shared.front())};
+        self.shared.pop_front();
+        --shared_count_;
+        return result;
+      }
+    }
+
+    if (!shared_count_.load())
+      return std::nullopt;
+    const auto size = workers_.size();
+    for (std::size_t i{1}; i < size; ++i) {
+      auto& victim = *workers_[(index + i) % size];
+      const std::lock_guard lg{victim.mutex};
+      if (!victim.shared.empty()) {
+        std::optional<Task> result{std::move(victim.shared.back())};
+        victim.shared.pop_back();
+        --shared_count_;
+        self.stolen.fetch_add(1, std::memory_order_relaxed);
+        return result;
+      }
+    }
+    return std::nullopt;
+  }
+
+  bool has_work(const std::size_t index) const noexcept
+  {
+    return shared_count_.load() || workers_[index]->pinned_count.load();
+  }
+
+  void run(const std::size_t index, std::promise<void> started)
+  {
+    Apartment_context context{this, index, options_.model};
+    Apartment_context::current_ref() = &context;
+    std::optional<Apartment> apartment;
+    try {
+      apartment.emplace(options_.model);
+      if (options_.on_start)
+        options_.on_start(context);
+    } catch (...) {
+      context.clear_locals();
+      apartment.reset();
+      Apartment_context::current_ref() = nullptr;
+      started.set_exception(std::current_exception());
+      return;
+    }
+    started.set_value();
+
+    auto& self = *workers_[index];
+    while (true) {
+      if (auto task = take(index)) {
+        (*task)(context);
+        self.executed.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+
+      std::unique_lock lk{sleep_mutex_};
+      ++sleeper_count_;
+      wakeup_.wait(lk, [this, index]
+      {
+        return is_stopping_.load() || has_work(index);
+      });
+      --sleeper_count_;
+      if (is_stopping_.load() && !has_work(index))
+        break;
+    }
+
+    // Release the proxies before COM is uninitialized.
+    context.clear_locals();
+    apartment.reset();
+    Apartment_context::current_ref() = nullptr;
+  }
+
+  void stop() noexcept
+  {
+    {
+      const std::lock_guard lg{sleep_mutex_};
+      is_stopping_ = true;
+    }
+    wakeup_.notify_all();
+    for (auto& worker : workers_) {
+      if (worker->thread.joinable())
+        worker->thread.join();
+    }
+  }
+};
+
+} // namespace dmitigr::wincom
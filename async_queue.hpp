@@ -0,0 +1,327 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "../base/noncopymove.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace dmitigr::wincom {
+
+/// The options of `Basic_async_queue`.
+struct Async_queue_options final {
+  /// The maximum number of the calls in flight.
+  std::size_t max_in_flight{32};
+};
+
+/**
+ * @brief The queue of the asynchronous calls in flight issued and completed
+ * on the owner thread.
+ *
+ * @details The calls are begun when submitted, and are finished by `poll()`
+ * which resolves the futures and resumes the coroutines awaiting them. If
+ * the limit of calls in flight is reached, the submission polls until one
+ * of them completes.
+ *
+ * @tparam Call The movable type with:
+ *   - `Result`, the type of the result (possibly `void`);
+ *   - `void begin()`, which begins the call or throws;
+ *   - `bool is_completed()`, which doesn't block;
+ *   - `Result finish()`, which returns the result of the completed call or
+ *   throws;
+ *   - `void cancel() noexcept`, which requests the cancellation of the call
+ *   (which still must be finished);
+ *   - `static std::size_t wait_any(std::span<Call* const> calls,
+ *   std::chrono::milliseconds timeout)`, which waits for the completion of
+ *   any of `calls` and returns its index, or `calls.size()` on timeout.
+ *
+ * @remarks Not thread-safe: all the members must be used on the owner thread.
+ */
+template<class Call>
+class Basic_async_queue final : private Noncopymove {
+public:
+  using Result = typename Call::Result;
+  using Timeout = std::chrono::milliseconds;
+
+  /// The statistics of the queue.
+  struct Stats final {
+    /// The number of calls begun.
+    std::uint64_t begun{};
+    /// The number of calls finished (either way).
+    std::uint64_t finished{};
+    /// The number of calls cancelled.
+    std::uint64_t cancelled{};
+    /// The maximum number of the calls in flight.
+    std::size_t max_in_flight{};
+  };
+
+  /// The awaitable of the call result, resumed by `poll()`.
+  class Awaitable final {
+  public:
+    bool await_ready() const noexcept
+    {
+      return false;
+    }
+
+    void await_suspend(const std::coroutine_handle<> handle)
+    {
+      handle_ = handle;
+      queue_->push(std::move(call_), timeout_, this);
+    }
+
+    Result await_resume()
+    {
+      if (auto* const error = std::get_if<std::exception_ptr>(&outcome_))
+        std::rethrow_exception(*error);
+      if constexpr (!std::is_void_v<Result>)
+        return std::move(std::get<Value>(outcome_));
+    }
+
+  private:
+    friend Basic_async_queue;
+    using Value = std::conditional_t<std::is_void_v<Result>,
+      std::monostate, Result>;
+
+    Basic_async_queue* queue_{};
+    Call call_;
+    std::optional<Timeout> timeout_;
+    std::coroutine_handle<> handle_;
+    std::variant<std::monostate, Value, std::exception_ptr> outcome_;
+
+    Awaitable(Basic_async_queue& queue, Call&& call,
+      const std::optional<Timeout> timeout)
+      : queue_{&queue}
+      , call_{std::move(call)}
+      , timeout_{timeout}
+    {}
+  };
+
+  /// Cancels and finishes the calls in flight.
+  ~Basic_async_queue()
+  {
+    cancel_all();
+    try {
+      wait_all();
+    } catch (...) {}
+  }
+
+  /// The constructor.
+  explicit Basic_async_queue(const Async_queue_options& options = {})
+    : options_{options}
+  {
+    if (!options_.max_in_flight)
+      throw std::invalid_argument{"cannot create async queue: zero in-flight"
+        " limit"};
+  }
+
+  /**
+   * @brief Begins `call`.
+   *
+   * @param timeout The duration after which the call is cancelled.
+   *
+   * @returns The future of the result which is ready after the call is
+   * finished by `poll()`.
+   */
+  std::future<Result> submit(Call call,
+    const std::optional<Timeout> timeout = {})
+  {
+    std::promise<Result> promise;
+    auto result = promise.get_future();
+    push(std::move(call), timeout, std::move(promise));
+    return result;
+  }
+
+  /**
+   * @returns The awaitable which begins `call` when awaited.
+   *
+   * @see submit().
+   */
+  Awaitable async(Call call, const std::optional<Timeout> timeout = {})
+  {
+    return Awaitable{*this, std::move(call), timeout};
+  }
+
+  /**
+   * @brief Finishes the completed calls, waiting up to `timeout` for the
+   * completion of any call, and cancels the calls timed out.
+   *
+   * @returns The number of calls finished.
+   */
+  std::size_t poll(const Timeout timeout = Timeout::zero())
+  {
+    const auto deadline = timeout == Timeout::max() ?
+      Clock::time_point::max() : Clock::now() + timeout;
+    while (true) {
+      cancel_expired();
+      if (const auto result = finish_completed())
+        return result;
+
+      const auto now = Clock::now();
+      if (entries_.empty() || now >= deadline)
+        return 0;
+      auto wait_until = deadline;
+      for (const auto& entry : entries_) {
+        if (entry->deadline && !entry->is_cancelled)
+          wait_until = std::min(wait_until, *entry->deadline);
+      }
+      std::vector<Call*> calls;
+      calls.reserve(entries_.size());
+      for (const auto& entry : entries_)
+        calls.push_back(&entry->call);
+      Call::wait_any(std::span<Call* const>{calls},
+        std::chrono::ceil<Timeout>(std::max(wait_until - now,
+            Clock::duration::zero())));
+    }
+  }
+
+  /// Finishes all the calls in flight.
+  void wait_all()
+  {
+    while (!entries_.empty())
+      poll(Timeout::max());
+  }
+
+  /// Requests the cancellation of all the calls in flight.
+  void cancel_all() noexcept
+  {
+    for (const auto& entry : entries_)
+      cancel(*entry);
+  }
+
+  /// @returns The number of calls in flight.
+  std::size_t size() const noexcept
+  {
+    return entries_.size();
+  }
+
+  /// @returns The statistics.
+  const Stats& stats() const noexcept
+  {
+    return stats_;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry final {
+    Call call;
+    std::optional<Clock::time_point> deadline;
+    bool is_cancelled{};
+    std::variant<std::promise<Result>, Awaitable*> completion;
+  };
+
+  Async_queue_options options_;
+  std::vector<std::unique_ptr<Entry>> entries_;
+  Stats stats_;
+
+  template<class Completion>
+  void push(Call&& call, const std::optional<Timeout> timeout,
+    Completion&& completion)
+  {
+    while (entries_.size() >= options_.max_in_flight)
+      poll(Timeout::max());
+
+    auto entry = std::make_unique<Entry>(Entry{std::move(call),
+      timeout ? std::optional{Clock::now() + *timeout} : std::nullopt,
+      false, std::forward<Completion>(completion)});
+    entries_.reserve(entries_.size() + 1);
+    entry->call.begin();
+    entries_.push_back(std::move(entry));
+    ++stats_.begun;
+    stats_.max_in_flight = std::max(stats_.max_in_flight, entries_.size());
+  }
+
+  void cancel(Entry& entry) noexcept
+  {
+    if (!entry.is_cancelled) {
+      entry.is_cancelled = true;
+      entry.call.cancel();
+      ++stats_.cancelled;
+    }
+  }
+
+  void cancel_expired() noexcept
+  {
+    const auto now = Clock::now();
+    for (const auto& entry : entries_) {
+      if (entry->deadline && *entry->deadline <= now)
+        cancel(*entry);
+    }
+  }
+
+  std::size_t finish_completed()
+  {
+    // Detach the completed entries first, since resumed coroutines may
+    // submit new calls.
+    std::vector<std::unique_ptr<Entry>> completed;
+    for (auto i = entries_.begin(); i != entries_.end();) {
+      if ((*i)->call.is_completed()) {
+        completed.push_back(std::move(*i));
+        i = entries_.erase(i);
+      } else
+        ++i;
+    }
+    for (auto& entry : completed) {
+      ++stats_.finished;
+      finish(*entry);
+    }
+    return completed.size();
+  }
+
+  static void finish(Entry& entry)
+  {
+    if (auto* const promise = std::get_if<0>(&entry.completion)) {
+      try {
+        if constexpr (std::is_void_v<Result>) {
+          entry.call.finish();
+          promise->set_value();
+        } else
+          promise->set_value(entry.call.finish());
+      } catch (...) {
+        promise->set_exception(std::current_exception());
+      }
+    } else {
+      auto* const awaitable = std::get<1>(entry.completion);
+      try {
+        if constexpr (std::is_void_v<Result>) {
+          entry.call.finish();
+          awaitable->outcome_.template emplace<1>();
+        } else
+          awaitable->outcome_.template emplace<1>(entry.call.finish());
+      } catch (...) {
+        awaitable->outcome_.template emplace<2>(std::current_exception());
+      }
+      awaitable->handle_.resume();
+    }
+  }
+};
+
+} // namespace dmitigr::wincom
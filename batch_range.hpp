@@ -0,0 +1,299 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "../base/noncopymove.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom {
+
+namespace detail {
+
+struct No_thread_scope final {};
+
+template<class Fetcher>
+struct Thread_scope final {
+  using Type = No_thread_scope;
+};
+
+template<class Fetcher> requires requires {typename Fetcher::Thread_scope;}
+struct Thread_scope<Fetcher> final {
+  using Type = typename Fetcher::Thread_scope;
+};
+
+} // namespace detail
+
+/// The options of `Basic_batch_range`.
+struct Batch_range_options final {
+  /// The number of elements requested per fetch.
+  std::size_t batch_size{64};
+  /// Should the next batch be fetched on a helper thread?
+  bool is_prefetching{};
+};
+
+/**
+ * @brief An input range of elements fetched in batches into the reused
+ * buffer of slots.
+ *
+ * @details The fetched slots are converted to the values one at a time as
+ * the range is iterated, and are cleared together before the buffer is
+ * refilled. In prefetching mode the next batch is fetched on the helper
+ * thread into the second buffer while the current one is consumed.
+ *
+ * @tparam Fetcher The type with:
+ *   - `Slot`, which is value-initialized to the empty state;
+ *   - `Value`, the type of elements;
+ *   - `std::size_t fetch(std::span<Slot> slots)`, which fills up to
+ *   `slots.size()` slots and returns the number of filled ones, which is
+ *   less than `slots.size()` only if the source is exhausted;
+ *   - `Value convert(Slot& slot)`;
+ *   - `static void clear(Slot& slot) noexcept`;
+ *   - optionally, `Thread_scope`, the default-constructible type an instance
+ *   of which is alive on the helper thread while it runs (e.g. initializes
+ *   COM for that thread).
+ * In prefetching mode `fetch()` is called on the helper thread concurrently
+ * with `convert()` of other slots.
+ *
+ * @remarks The range is single-pass: `begin()` may be called only once.
+ */
+template<class Fetcher>
+class Basic_batch_range final : private Noncopymove {
+public:
+  using Slot = typename Fetcher::Slot;
+  using Value = typename Fetcher::Value;
+
+  /// The iterator of the range.
+  class Iterator final {
+  public:
+    using iterator_concept = std::input_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = Value;
+
+    Iterator() = default;
+
+    Value& operator*() const noexcept
+    {
+      return *range_->value_;
+    }
+
+    Value* operator->() const noexcept
+    {
+      return &*range_->value_;
+    }
+
+    Iterator& operator++()
+    {
+      range_->advance();
+      return *this;
+    }
+
+    void operator++(int)
+    {
+      ++*this;
+    }
+
+    friend bool operator==(const Iterator& lhs, std::default_sentinel_t) noexcept
+    {
+      return lhs.is_end();
+    }
+
+  private:
+    friend Basic_batch_range;
+
+    Basic_batch_range* range_{};
+
+    explicit Iterator(Basic_batch_range& range) noexcept
+      : range_{&range}
+    {}
+
+    bool is_end() const noexcept
+    {
+      return !range_->value_;
+    }
+  };
+
+  /// Stops the helper thread and clears the slots.
+  ~Basic_batch_range()
+  {
+    if (helper_.joinable()) {
+      {
+        const std::lock_guard lg{mutex_};
+        is_stopping_ = true;
+      }
+      cond_.notify_all();
+      helper_.join();
+      if (is_prefetched_)
+        clear(next_, next_fetched_);
+    }
+    clear(current_, fetched_);
+  }
+
+  /**
+   * @brief The constructor.
+   *
+   * @details In prefetching mode the first batch is requested immediately.
+   */
+  explicit Basic_batch_range(Fetcher fetcher,
+    const Batch_range_options& options = {})
+    : fetcher_{std::move(fetcher)}
+    , current_(options.batch_size)
+  {
+    if (!options.batch_size)
+      throw std::invalid_argument{"cannot create batch range: zero batch size"};
+
+    if (options.is_prefetching) {
+      next_.resize(options.batch_size);
+      is_requested_ = true;
+      helper_ = std::thread{&Basic_batch_range::prefetch, this};
+    }
+  }
+
+  /// @returns The iterator to the first element.
+  Iterator begin()
+  {
+    if (is_started_)
+      throw std::logic_error{"cannot iterate batch range twice"};
+    is_started_ = true;
+    advance();
+    return Iterator{*this};
+  }
+
+  /// @returns The sentinel.
+  std::default_sentinel_t end() const noexcept
+  {
+    return std::default_sentinel;
+  }
+
+  /// @returns The number of fetches completed.
+  std::size_t fetch_count() const noexcept
+  {
+    return fetch_count_;
+  }
+
+private:
+  Fetcher fetcher_;
+  std::vector<Slot> current_;
+  std::size_t fetched_{};
+  std::size_t position_{};
+  std::optional<Value> value_;
+  bool is_started_{};
+  bool is_last_{};
+  std::size_t fetch_count_{};
+
+  // Prefetching.
+  std::vector<Slot> next_;
+  std::size_t next_fetched_{};
+  std::exception_ptr next_error_;
+  bool is_requested_{};
+  bool is_prefetched_{};
+  bool is_stopping_{};
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::thread helper_;
+
+  static void clear(std::vector<Slot>& slots, const std::size_t count) noexcept
+  {
+    for (std::size_t i{}; i < count; ++i)
+      Fetcher::clear(slots[i]);
+  }
+
+  void advance()
+  {
+    value_.reset();
+    while (position_ == fetched_) {
+      if (is_last_)
+        return;
+      clear(current_, fetched_);
+      fetched_ = position_ = 0;
+      refill();
+    }
+    value_.emplace(fetcher_.convert(current_[position_]));
+    ++position_;
+  }
+
+  void refill()
+  {
+    if (!helper_.joinable()) {
+      fetched_ = fetcher_.fetch(std::span{current_});
+      is_last_ = fetched_ < current_.size();
+    } else {
+      std::unique_lock lk{mutex_};
+      cond_.wait(lk, [this]{return is_prefetched_;});
+      is_prefetched_ = false;
+      if (next_error_) {
+        is_last_ = true;
+        std::rethrow_exception(std::exchange(next_error_, nullptr));
+      }
+      current_.swap(next_);
+      fetched_ = next_fetched_;
+      is_last_ = fetched_ < current_.size();
+      if (!is_last_) {
+        is_requested_ = true;
+        lk.unlock();
+        cond_.notify_all();
+      }
+    }
+    ++fetch_count_;
+  }
+
+  void prefetch()
+  {
+    std::optional<typename detail::Thread_scope<Fetcher>::Type> scope;
+    std::exception_ptr scope_error;
+    try {
+      scope.emplace();
+    } catch (...) {
+      scope_error = std::current_exception();
+    }
+
+    std::unique_lock lk{mutex_};
+    while (true) {
+      cond_.wait(lk, [this]{return is_requested_ || is_stopping_;});
+      if (is_stopping_)
+        return;
+      is_requested_ = false;
+      lk.unlock();
+      std::size_t fetched{};
+      std::exception_ptr error{scope_error};
+      if (!error) {
+        try {
+          fetched = fetcher_.fetch(std::span{next_});
+        } catch (...) {
+          error = std::current_exception();
+        }
+      }
+      lk.lock();
+      next_fetched_ = fetched;
+      next_error_ = error;
+      is_prefetched_ = true;
+      cond_.notify_all();
+    }
+  }
+};
+
+} // namespace dmitigr::wincom
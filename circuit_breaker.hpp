@@ -0,0 +1,354 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "../base/noncopymove.hpp"
+#include "retry.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace dmitigr::wincom {
+
+/**
+ * @returns `true` if `hresult` denotes the failure of a call to a host which
+ * is unreachable or unresponsive, that is either a transient error (see
+ * `is_transient_error()`) or `RPC_E_CALL_CANCELED` (e.g. by the deadline).
+ */
+constexpr bool is_unreachable_error(const std::int32_t hresult) noexcept
+{
+  return is_transient_error(hresult) ||
+    static_cast<std::uint32_t>(hresult) == 0x80010002; // RPC_E_CALL_CANCELED
+}
+
+/// The options of circuit breakers.
+struct Circuit_breaker_options final {
+  /// The duration of the window the failure rate is measured over.
+  std::chrono::milliseconds window{60000};
+  /// The minimum number of calls in the window to open the circuit.
+  std::size_t min_call_count{5};
+  /// The failure rate in (0, 1] which opens the circuit.
+  double failure_rate{.5};
+  /// The duration of the open state before the trial calls.
+  std::chrono::milliseconds open_duration{30000};
+  /// The number of successful trial calls which close the circuit.
+  std::size_t trial_call_count{1};
+  /// The classifier of `HRESULT`s of unreachable hosts.
+  bool (*is_failure)(std::int32_t) noexcept{is_unreachable_error};
+};
+
+/// The state of a circuit breaker.
+enum class Circuit_state {
+  /// The calls are made and their outcomes are counted.
+  closed,
+  /// The calls fail immediately.
+  open,
+  /// The limited number of trial calls are made.
+  half_open
+};
+
+/// The statistics of circuit breakers.
+struct Circuit_breaker_stats final {
+  /// The number of times the circuits opened.
+  std::uint64_t opened{};
+  /// The number of calls failed immediately.
+  std::uint64_t short_circuited{};
+};
+
+// -----------------------------------------------------------------------------
+// Basic_circuit_breaker
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief The circuit breaker of calls to a host.
+ *
+ * @details The circuit opens if the rate of failures among at least
+ * `min_call_count` calls over the last `window` reaches `failure_rate`.
+ * After `open_duration` it turns half-open and lets `trial_call_count` calls
+ * through at a time: it closes if all of them succeed, and opens again on the
+ * first failure.
+ *
+ * @tparam Clock The type with `now()`. (See `System_retry_clock`.)
+ */
+template<class Clock>
+class Basic_circuit_breaker final : private Noncopymove {
+public:
+  using Time_point = decltype(std::declval<const Clock&>().now());
+
+  /// The constructor.
+  explicit Basic_circuit_breaker(const Circuit_breaker_options& options,
+    const Clock& clock = {})
+    : options_{options}
+    , clock_{clock}
+  {}
+
+  /// @returns The options.
+  const Circuit_breaker_options& options() const noexcept
+  {
+    return options_;
+  }
+
+  /// @returns The current state.
+  Circuit_state state() const
+  {
+    const std::lock_guard lg{mutex_};
+    return state_ == Circuit_state::open && is_open_expired() ?
+      Circuit_state::half_open : state_;
+  }
+
+  /**
+   * @returns `true` if the call is allowed. Every allowed call must be
+   * followed by `record()`.
+   */
+  bool try_acquire()
+  {
+    const std::lock_guard lg{mutex_};
+    if (state_ == Circuit_state::open) {
+      if (!is_open_expired())
+        return false;
+      state_ = Circuit_state::half_open;
+      trial_count_ = success_count_ = 0;
+    }
+    if (state_ == Circuit_state::half_open) {
+      if (trial_count_ == options_.trial_call_count)
+        return false;
+      ++trial_count_;
+    }
+    return true;
+  }
+
+  /// Records the outcome of the allowed call.
+  void record(const bool is_failure)
+  {
+    const std::lock_guard lg{mutex_};
+    const auto now = clock_.now();
+    if (state_ == Circuit_state::half_open) {
+      if (is_failure)
+        open(now);
+      else if (++success_count_ == options_.trial_call_count) {
+        state_ = Circuit_state::closed;
+        buckets_.fill(Bucket{});
+      } else
+        --trial_count_;
+      return;
+    } else if (state_ == Circuit_state::open)
+      return; // opened by a concurrent call
+
+    auto& bucket = current_bucket(now);
+    ++bucket.call_count;
+    if (is_failure) {
+      ++bucket.failure_count;
+      std::size_t call_count{};
+      std::size_t failure_count{};
+      const auto index = bucket_index(now);
+      for (const auto& b : buckets_) {
+        if (b.index + static_cast<std::int64_t>(bucket_count) > index) {
+          call_count += b.call_count;
+          failure_count += b.failure_count;
+        }
+      }
+      if (call_count >= options_.min_call_count &&
+        static_cast<double>(failure_count) >=
+        options_.failure_rate * static_cast<double>(call_count))
+        open(now);
+    }
+  }
+
+  /// @returns The number of times the circuit opened.
+  std::uint64_t open_count() const noexcept
+  {
+    return open_count_.load(std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr std::size_t bucket_count{10};
+
+  struct Bucket final {
+    std::int64_t index{-1};
+    std::size_t call_count{};
+    std::size_t failure_count{};
+  };
+
+  Circuit_breaker_options options_;
+  Clock clock_;
+  mutable std::mutex mutex_;
+  Circuit_state state_{Circuit_state::closed};
+  Time_point opened_at_{};
+  std::size_t trial_count_{};
+  std::size_t success_count_{};
+  std::array<Bucket, bucket_count> buckets_{};
+  std::atomic_uint64_t open_count_{};
+
+  bool is_open_expired() const
+  {
+    return clock_.now() - opened_at_ >= options_.open_duration;
+  }
+
+  void open(const Time_point now) noexcept
+  {
+    state_ = Circuit_state::open;
+    opened_at_ = now;
+    open_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::int64_t bucket_index(const Time_point now) const noexcept
+  {
+    const auto duration = std::max<std::chrono::nanoseconds::rep>(
+      std::chrono::nanoseconds{options_.window}.count() / bucket_count, 1);
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      now.time_since_epoch()).count() / duration;
+  }
+
+  Bucket& current_bucket(const Time_point now) noexcept
+  {
+    const auto index = bucket_index(now);
+    auto& result = buckets_[static_cast<std::size_t>(index) % bucket_count];
+    if (result.index != index)
+      result = Bucket{index};
+    return result;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Basic_circuit_breakers
+// -----------------------------------------------------------------------------
+
+namespace detail {
+
+/// The type of exceptions which are never thrown.
+struct No_timeout_error final {};
+
+} // namespace detail
+
+/**
+ * @brief The circuit breakers keyed by host name (case-insensitively).
+ *
+ * @tparam Clock See `Basic_circuit_breaker`.
+ */
+template<class Clock>
+class Basic_circuit_breakers final : private Noncopymove {
+public:
+  using Breaker = Basic_circuit_breaker<Clock>;
+
+  /// The constructor.
+  explicit Basic_circuit_breakers(const Circuit_breaker_options& options,
+    const Clock& clock = {})
+    : options_{options}
+    , clock_{clock}
+  {}
+
+  /// @returns The breaker of `host`.
+  Breaker& breaker(const std::wstring_view host)
+  {
+    auto key = normalized(host);
+    {
+      const std::shared_lock lk{mutex_};
+      if (const auto i = breakers_.find(key); i != breakers_.end())
+        return *i->second;
+    }
+    const std::lock_guard lg{mutex_};
+    auto& result = breakers_[std::move(key)];
+    if (!result)
+      result = std::make_unique<Breaker>(options_, clock_);
+    return *result;
+  }
+
+  /**
+   * @brief Calls `f` unless the circuit of `host` is open.
+   *
+   * @tparam Error The type of exceptions with `code()` which returns
+   * `HRESULT` and constructible from the message and the code.
+   * @tparam TimeoutError The type of exceptions of the timed out calls,
+   * which are counted as failures.
+   *
+   * @returns The result of `f`.
+   *
+   * @throws `Error` with `RPC_S_SERVER_UNAVAILABLE` if the circuit is open.
+   */
+  template<class Error, class TimeoutError = detail::No_timeout_error, class F>
+  decltype(auto) call(const std::wstring_view host, F&& f)
+  {
+    auto& brk = breaker(host);
+    if (!brk.try_acquire()) {
+      short_circuit_count_.fetch_add(1, std::memory_order_relaxed);
+      throw Error{"cannot call remote host: circuit breaker is open",
+        static_cast<std::int32_t>(0x800706BA)};
+    }
+    try {
+      if constexpr (std::is_void_v<std::invoke_result_t<F&>>) {
+        f();
+        brk.record(false);
+      } else {
+        auto result = f();
+        brk.record(false);
+        return result;
+      }
+    } catch (const Error& e) {
+      brk.record(options_.is_failure &&
+        options_.is_failure(static_cast<std::int32_t>(e.code())));
+      throw;
+    } catch (const TimeoutError&) {
+      brk.record(true);
+      throw;
+    } catch (...) {
+      brk.record(false);
+      throw;
+    }
+  }
+
+  /// @returns The statistics.
+  Circuit_breaker_stats stats() const
+  {
+    Circuit_breaker_stats result;
+    result.short_circuited = short_circuit_count_.load(
+      std::memory_order_relaxed);
+    const std::shared_lock lk{mutex_};
+    for (const auto& [host, brk] : breakers_)
+      result.opened += brk->open_count();
+    return result;
+  }
+
+private:
+  Circuit_breaker_options options_;
+  Clock clock_;
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::wstring, std::unique_ptr<Breaker>> breakers_;
+  std::atomic_uint64_t short_circuit_count_{};
+
+  static std::wstring normalized(const std::wstring_view host)
+  {
+    std::wstring result{host};
+    for (auto& ch : result) {
+      if (ch >= L'A' && ch <= L'Z')
+        ch = static_cast<wchar_t>(ch - L'A' + L'a');
+    }
+    return result;
+  }
+};
+
+} // namespace dmitigr::wincom
@@ -20,6 +20,12 @@
 
 dmitigr_libs_set_library_info(wincom 0 0 0 "Windows COM stuff")
 
+# ------------------------------------------------------------------------------
+# Fake
+# ------------------------------------------------------------------------------
+
+include(${CMAKE_CURRENT_LIST_DIR}/dmitigr_wincom_fake.cmake)
+
 # ------------------------------------------------------------------------------
 # Sources
 # ------------------------------------------------------------------------------
@@ -29,13 +35,35 @@ if (NOT WIN32)
 endif()
 
 set(dmitigr_wincom_headers
+  apartment_pool.hpp
+  async_queue.hpp
+  batch_range.hpp
+  circuit_breaker.hpp
+  date.hpp
   enumerator.hpp
   exceptions.hpp
   firewall.hpp
+  hash.hpp
+  instrumentation.hpp
   library.hpp
+  literal.hpp
   object.hpp
+  partitioned_enumeration.hpp
   rdp.hpp
+  retry.hpp
+  sta_executor.hpp
   tasc.hpp
+  tasc_columnar.hpp
+  tasc_completion.hpp
+  tasc_forecast.hpp
+  tasc_index.hpp
+  tasc_monitor.hpp
+  tasc_schedule.hpp
+  tasc_snapshot.hpp
+  tasc_sync.hpp
+  timer_wheel.hpp
+  tracing.hpp
+  variant_batch.hpp
   wmi.hpp
 )
 
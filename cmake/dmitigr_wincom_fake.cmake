@@ -0,0 +1,32 @@
+# -*- cmake -*-
+#
+# Copyright 2024 Dmitry Igrishin
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# The header-only fake COM runtime (see fake/runtime.hpp) to build the tests
+# and the benchmarks of the wrappers on any platform (see tests). The stand-ins
+# of the SDK headers are in fake/include. The stand-ins of the base and winbase
+# libraries (fake/base, fake/winbase) are found via fake/include if these
+# libraries are not beside wincom.
+if (NOT TARGET dmitigr_wincom_fake)
+  add_library(dmitigr_wincom_fake INTERFACE)
+  target_include_directories(dmitigr_wincom_fake INTERFACE
+    ${CMAKE_CURRENT_LIST_DIR}/../fake/include
+    ${CMAKE_CURRENT_LIST_DIR}/../../..)
+  target_compile_features(dmitigr_wincom_fake INTERFACE cxx_std_20)
+  if (NOT WIN32)
+    find_package(Threads REQUIRED)
+    target_link_libraries(dmitigr_wincom_fake INTERFACE Threads::Threads)
+  endif()
+endif()
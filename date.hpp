@@ -0,0 +1,186 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+
+/*
+ * Conversions of OLE Automation dates (`DATE`) without VariantTimeToSystemTime().
+ *
+ * `DATE` is the number of days since 1899-12-30 00:00:00. Its integral part is
+ * the signed number of days, while the absolute value of its fractional part
+ * is the time of day. Thus, -1.25 is 1899-12-29 06:00:00 rather than
+ * 1899-12-28 18:00:00.
+ */
+
+namespace dmitigr::wincom {
+
+/// The minimum valid `DATE` (0100-01-01 00:00:00).
+inline constexpr double ole_date_min{-657434};
+
+/// The maximum valid `DATE` (9999-12-31 23:59:59.999...).
+inline constexpr double ole_date_max{2958466};
+
+/// @returns `true` if `date` is within [ole_date_min, ole_date_max).
+constexpr bool is_ole_date_valid(const double date) noexcept
+{
+  return ole_date_min <= date && date < ole_date_max; // false for NaN
+}
+
+namespace detail {
+
+/// The distance between the Unix epoch and the `DATE` epoch in days.
+inline constexpr std::int64_t ole_date_epoch_days{-25569};
+
+template<class Duration>
+inline constexpr std::int64_t ole_date_ticks_per_day{
+  std::chrono::duration_cast<Duration>(std::chrono::days{1}).count()};
+
+template<class Duration>
+inline std::int64_t ole_date_to_ticks(const double date) noexcept
+{
+  constexpr auto tpd = static_cast<double>(ole_date_ticks_per_day<Duration>);
+  constexpr auto epoch = ole_date_epoch_days * ole_date_ticks_per_day<Duration>;
+  const double days = std::trunc(date);
+  const double time = std::fabs(date - days);
+  return static_cast<std::int64_t>(std::nearbyint(days*tpd + time*tpd)) + epoch;
+}
+
+template<class Duration>
+inline double ole_date_from_ticks(const std::int64_t ticks) noexcept
+{
+  constexpr auto tpd = ole_date_ticks_per_day<Duration>;
+  const auto t = ticks - ole_date_epoch_days * tpd;
+  const auto q = t / tpd;
+  const auto days = q - (t % tpd < 0); // floor division
+  const double time = static_cast<double>(t - days*tpd) / static_cast<double>(tpd);
+  return static_cast<double>(days) + std::copysign(time, static_cast<double>(days));
+}
+
+template<class TimePoint>
+inline void check_ole_date_batch(const std::span<const double> dates,
+  const std::span<TimePoint> result)
+{
+  if (dates.size() != result.size())
+    throw std::invalid_argument{"cannot convert DATE values: size mismatch"};
+  bool is_valid{true};
+  for (const auto date : dates)
+    is_valid &= is_ole_date_valid(date);
+  if (!is_valid)
+    throw std::out_of_range{"cannot convert DATE values: value out of range"};
+}
+
+} // namespace detail
+
+/**
+ * @returns The time point denoted by `date`, rounded to the nearest tick of
+ * `Duration`.
+ *
+ * @throws `std::out_of_range` if `!is_ole_date_valid(date)`.
+ */
+template<class Duration = std::chrono::milliseconds>
+std::chrono::sys_time<Duration> to_sys_time(const double date)
+{
+  if (!is_ole_date_valid(date))
+    throw std::out_of_range{"cannot convert DATE value: value out of range"};
+  return std::chrono::sys_time<Duration>{
+    Duration{detail::ole_date_to_ticks<Duration>(date)}};
+}
+
+/**
+ * @returns The local time point denoted by `date`.
+ *
+ * @remarks Task Scheduler reports `DATE` values in local time of the host.
+ *
+ * @see to_sys_time().
+ */
+template<class Duration = std::chrono::milliseconds>
+std::chrono::local_time<Duration> to_local_time(const double date)
+{
+  return std::chrono::local_time<Duration>{
+    to_sys_time<Duration>(date).time_since_epoch()};
+}
+
+/// @returns The `DATE` value denoted by `time`.
+template<class Duration>
+double to_ole_date(const std::chrono::sys_time<Duration> time) noexcept
+{
+  return detail::ole_date_from_ticks<Duration>(time.time_since_epoch().count());
+}
+
+/// @overload
+template<class Duration>
+double to_ole_date(const std::chrono::local_time<Duration> time) noexcept
+{
+  return detail::ole_date_from_ticks<Duration>(time.time_since_epoch().count());
+}
+
+/**
+ * @brief Converts `dates` to `result` element-wise.
+ *
+ * @details The range is validated before the conversion. The conversion loop
+ * is branch-free so the compiler is able to vectorize it.
+ *
+ * @throws `std::invalid_argument` if the sizes differ, or `std::out_of_range`
+ * if any of `dates` is invalid. `result` is untouched in both cases.
+ */
+template<class Duration>
+void to_sys_time(const std::span<const double> dates,
+  const std::span<std::chrono::sys_time<Duration>> result)
+{
+  detail::check_ole_date_batch(dates, result);
+  const auto size = dates.size();
+  for (std::size_t i{}; i < size; ++i)
+    result[i] = std::chrono::sys_time<Duration>{
+      Duration{detail::ole_date_to_ticks<Duration>(dates[i])}};
+}
+
+/// @overload
+template<class Duration>
+void to_local_time(const std::span<const double> dates,
+  const std::span<std::chrono::local_time<Duration>> result)
+{
+  detail::check_ole_date_batch(dates, result);
+  const auto size = dates.size();
+  for (std::size_t i{}; i < size; ++i)
+    result[i] = std::chrono::local_time<Duration>{
+      Duration{detail::ole_date_to_ticks<Duration>(dates[i])}};
+}
+
+/**
+ * @brief Converts `times` to `result` element-wise.
+ *
+ * @throws `std::invalid_argument` if the sizes differ.
+ */
+template<class Clock, class Duration>
+void to_ole_date(const std::span<const std::chrono::time_point<Clock, Duration>> times,
+  const std::span<double> result)
+{
+  if (times.size() != result.size())
+    throw std::invalid_argument{"cannot convert to DATE values: size mismatch"};
+  const auto size = times.size();
+  for (std::size_t i{}; i < size; ++i)
+    result[i] = detail::ole_date_from_ticks<Duration>(
+      times[i].time_since_epoch().count());
+}
+
+} // namespace dmitigr::wincom
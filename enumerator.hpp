@@ -16,7 +16,18 @@
 
 #pragma once
 
+#include "batch_range.hpp"
+#include "library.hpp"
 #include "object.hpp"
+#include "partitioned_enumeration.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
 
 namespace dmitigr::wincom {
 
@@ -34,10 +45,114 @@ public:
   Enumerator clone() const
   {
     IEnumVARIANT* instance{};
-    const auto err = detail::api(*this).Clone(&instance);
+    const auto err = detail::call<&Api::Clone>(*this, "Clone", &instance);
     throw_if_error(err, "cannot clone Enumerator");
     return Enumerator{instance};
   }
 };
 
+/**
+ * @brief The fetcher of `Enumerator_range`.
+ *
+ * @tparam T The wrapper (e.g. `firewall::Rule`, `tasc::Registered_task`)
+ * constructible from the pointer to `T::Api`.
+ */
+template<class T>
+class Enumerator_fetcher final {
+public:
+  using Slot = VARIANT;
+  using Value = T;
+  /// The helper thread of the prefetching range joins the MTA.
+  using Thread_scope = Library;
+
+  explicit Enumerator_fetcher(Enumerator enumerator)
+    : enumerator_{std::move(enumerator)}
+  {}
+
+  std::size_t fetch(const std::span<VARIANT> slots)
+  {
+    ULONG fetched{};
+    const auto err = detail::call<&IEnumVARIANT::Next>(enumerator_, "Next",
+      static_cast<ULONG>(slots.size()), slots.data(), &fetched);
+    if (FAILED(err))
+      throw Win_error{"cannot fetch next elements of Enumerator", err};
+    return fetched;
+  }
+
+  T convert(VARIANT& slot) const
+  {
+    IUnknown* const unknown = slot.vt == VT_DISPATCH ? slot.pdispVal :
+      slot.vt == VT_UNKNOWN ? slot.punkVal : nullptr;
+    if (!unknown)
+      throw std::runtime_error{"cannot convert element of Enumerator:"
+        " not an interface"};
+    typename T::Api* api{};
+    unknown->QueryInterface(&api);
+    if (!api)
+      throw std::runtime_error{"cannot convert element of Enumerator:"
+        " interface not supported"};
+    return T{api};
+  }
+
+  static void clear(VARIANT& slot) noexcept
+  {
+    VariantClear(&slot);
+  }
+
+  /**
+   * @returns The fetcher of the clone of the enumerator, or `std::nullopt`
+   * if cloning is not supported.
+   *
+   * @see collect_partitioned().
+   */
+  std::optional<Enumerator_fetcher> clone() const
+  {
+    IEnumVARIANT* instance{};
+    const auto err = detail::call<&IEnumVARIANT::Clone>(enumerator_, "Clone",
+      &instance);
+    if (err == E_NOTIMPL || err == E_NOINTERFACE)
+      return std::nullopt;
+    throw_if_error(err, "cannot clone Enumerator");
+    return Enumerator_fetcher{Enumerator{instance}};
+  }
+
+  /// Skips `count` elements.
+  void skip(std::size_t count)
+  {
+    constexpr std::size_t max_count{std::numeric_limits<ULONG>::max()};
+    while (count) {
+      const auto n = std::min(count, max_count);
+      const auto err = detail::call<&IEnumVARIANT::Skip>(enumerator_, "Skip",
+        static_cast<ULONG>(n));
+      if (FAILED(err))
+        throw Win_error{"cannot skip elements of Enumerator", err};
+      else if (err == S_FALSE)
+        break;
+      count -= n;
+    }
+  }
+
+private:
+  Enumerator enumerator_;
+};
+
+/**
+ * @brief An input range of the elements of `Enumerator` converted to `T`.
+ *
+ * @details Fetches `Batch_range_options::batch_size` elements per
+ * `IEnumVARIANT::Next()` call.
+ *
+ * @par Example
+ * @code
+ * Enumerator_range<tasc::Registered_task> tasks{folder.tasks(0).enumerator()};
+ * for (auto& task : tasks)
+ *   // ...
+ * @endcode
+ *
+ * @remarks In prefetching mode the enumerator is used on the helper thread
+ * which joins the MTA, so the enumerator must be obtained in the MTA too.
+ */
+template<class T>
+using Enumerator_range = Basic_batch_range<Enumerator_fetcher<T>>;
+
 } // namespace dmitigr::wincom
@@ -42,6 +42,11 @@ private:
   long code_{};
 };
 
+class Timeout_error final : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
 template<typename T>
 inline void check(const T& condition, const std::string& message)
 {
@@ -0,0 +1,43 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+ * The stand-in of the subset of base/contract.hpp used by the wrappers. It's
+ * found via the include directory `fake/include` (as `../base/contract.hpp`)
+ * if the base library is not beside wincom.
+ */
+
+#include <stdexcept>
+#include <utility>
+
+namespace dmitigr {
+
+/**
+ * @returns `value` forwarded if it's convertible to `true`.
+ *
+ * @throws `E{what}` otherwise.
+ */
+template<class E = std::invalid_argument, typename T>
+auto&& forward_or_throw(T&& value, const char* const what)
+{
+  if (!value)
+    throw E{what};
+  return std::forward<T>(value);
+}
+
+} // namespace dmitigr
@@ -0,0 +1,49 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+ * The stand-in of base/noncopymove.hpp (see contract.hpp).
+ */
+
+namespace dmitigr {
+
+/// The base of noncopyable types.
+class Noncopy {
+public:
+  Noncopy(const Noncopy&) = delete;
+  Noncopy& operator=(const Noncopy&) = delete;
+  Noncopy(Noncopy&&) = default;
+  Noncopy& operator=(Noncopy&&) = default;
+protected:
+  Noncopy() = default;
+  ~Noncopy() = default;
+};
+
+/// The base of noncopyable and nonmovable types.
+class Noncopymove {
+public:
+  Noncopymove(const Noncopymove&) = delete;
+  Noncopymove& operator=(const Noncopymove&) = delete;
+  Noncopymove(Noncopymove&&) = delete;
+  Noncopymove& operator=(Noncopymove&&) = delete;
+protected:
+  Noncopymove() = default;
+  ~Noncopymove() = default;
+};
+
+} // namespace dmitigr
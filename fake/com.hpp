@@ -0,0 +1,1094 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <limits>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/*
+ * The portable subset of the COM ABI of Windows SDK: the types, the codes,
+ * the core interfaces, and the functions of BSTR, VARIANT and SAFEARRAY.
+ *
+ * It's source compatible with the SDK to the extent used by the wrappers,
+ * but not binary compatible: e.g. `OLECHAR` is `wchar_t` of the platform and
+ * the interface identifiers are derived from the interface names.
+ */
+
+// -----------------------------------------------------------------------------
+// Types
+// -----------------------------------------------------------------------------
+
+#define STDMETHODCALLTYPE
+#define WINAPI
+
+using BYTE = unsigned char;
+using CHAR = char;
+using WCHAR = wchar_t;
+using SHORT = short;
+using USHORT = unsigned short;
+using WORD = unsigned short;
+using INT = int;
+using UINT = unsigned int;
+using BOOL = int;
+using LONG = long;
+using ULONG = unsigned long;
+using DWORD = unsigned long;
+using LPDWORD = DWORD*;
+using LONGLONG = long long;
+using ULONGLONG = unsigned long long;
+using LONG64 = std::int64_t;
+using ULONG64 = std::uint64_t;
+using FLOAT = float;
+using DOUBLE = double;
+using ULONG_PTR = std::uintptr_t;
+using SIZE_T = std::size_t;
+using WPARAM = std::uintptr_t;
+using LPARAM = std::intptr_t;
+using LRESULT = std::intptr_t;
+using PVOID = void*;
+using LPVOID = void*;
+using HANDLE = void*;
+using HWND = void*;
+using HTASK = void*;
+using LPSTR = char*;
+using LPCSTR = const char*;
+using LPWSTR = wchar_t*;
+using LPCWSTR = const wchar_t*;
+using OLECHAR = wchar_t;
+using LPOLESTR = OLECHAR*;
+using LPCOLESTR = const OLECHAR*;
+using BSTR = OLECHAR*;
+using HRESULT = long;
+using SCODE = long;
+using LCID = DWORD;
+using DISPID = LONG;
+using MEMBERID = DISPID;
+using VARIANT_BOOL = short;
+using VARTYPE = unsigned short;
+using DATE = double;
+
+inline constexpr BOOL TRUE{1};
+inline constexpr BOOL FALSE{0};
+inline constexpr VARIANT_BOOL VARIANT_TRUE{-1};
+inline constexpr VARIANT_BOOL VARIANT_FALSE{0};
+
+// -----------------------------------------------------------------------------
+// GUID
+// -----------------------------------------------------------------------------
+
+struct GUID final {
+  std::uint32_t Data1;
+  std::uint16_t Data2;
+  std::uint16_t Data3;
+  std::uint8_t Data4[8];
+
+  friend constexpr bool operator==(const GUID& lhs, const GUID& rhs) noexcept
+  {
+    if (lhs.Data1 != rhs.Data1 || lhs.Data2 != rhs.Data2
+      || lhs.Data3 != rhs.Data3)
+      return false;
+    for (int i{}; i < 8; ++i) {
+      if (lhs.Data4[i] != rhs.Data4[i])
+        return false;
+    }
+    return true;
+  }
+};
+
+using IID = GUID;
+using CLSID = GUID;
+using REFGUID = const GUID&;
+using REFIID = const IID&;
+using REFCLSID = const CLSID&;
+
+inline constexpr GUID GUID_NULL{};
+
+namespace dmitigr::wincom::fake::detail {
+
+/// The identifier of `T` specialized by `DMITIGR_WINCOM_FAKE_UUID`.
+template<class T>
+struct Uuid;
+
+/// The base interface of `T` specialized by `DMITIGR_WINCOM_FAKE_INTERFACE`.
+template<class T>
+struct Interface_base final {
+  using Type = void;
+};
+
+/// @returns The identifier derived from `name` by FNV-1a.
+constexpr GUID make_uuid(const std::string_view name) noexcept
+{
+  std::uint64_t hi{14695981039346656037ull};
+  std::uint64_t lo{1099511628211ull};
+  for (const char ch : name) {
+    hi = (hi ^ static_cast<unsigned char>(ch)) * 1099511628211ull;
+    lo = (lo ^ static_cast<unsigned char>(ch)) * 14029467366897019727ull;
+  }
+  GUID result{static_cast<std::uint32_t>(hi >> 32),
+    static_cast<std::uint16_t>(hi >> 16), static_cast<std::uint16_t>(hi), {}};
+  for (int i{}; i < 8; ++i)
+    result.Data4[i] = static_cast<std::uint8_t>(lo >> (8 * i));
+  return result;
+}
+
+} // namespace dmitigr::wincom::fake::detail
+
+/// Declares the identifier of the interface or the class `T`.
+#define DMITIGR_WINCOM_FAKE_UUID(T)                                     \
+  template<> struct dmitigr::wincom::fake::detail::Uuid<T> final {      \
+    static constexpr GUID value{                                        \
+      dmitigr::wincom::fake::detail::make_uuid(#T)};                    \
+  }
+
+/// Declares the identifier and the base interface of the interface `T`.
+#define DMITIGR_WINCOM_FAKE_INTERFACE(T, Base)                          \
+  DMITIGR_WINCOM_FAKE_UUID(T);                                          \
+  template<> struct dmitigr::wincom::fake::detail::Interface_base<T>    \
+    final {                                                             \
+    using Type = Base;                                                  \
+  }
+
+/// The emulation of `__uuidof` of MSVC (for types and expressions).
+#define __uuidof(x) (dmitigr::wincom::fake::detail::Uuid<               \
+    std::remove_cvref_t<std::remove_pointer_t<                          \
+      std::remove_cvref_t<__typeof__(x)>>>>::value)
+
+// -----------------------------------------------------------------------------
+// Codes
+// -----------------------------------------------------------------------------
+
+namespace dmitigr::wincom::fake::detail {
+
+/// @returns The `HRESULT` of the hexadecimal representation `value`.
+constexpr HRESULT hresult(const std::uint32_t value) noexcept
+{
+  return static_cast<std::int32_t>(value);
+}
+
+} // namespace dmitigr::wincom::fake::detail
+
+constexpr bool SUCCEEDED(const HRESULT hr) noexcept
+{
+  return hr >= 0;
+}
+
+constexpr bool FAILED(const HRESULT hr) noexcept
+{
+  return hr < 0;
+}
+
+constexpr HRESULT HRESULT_FROM_WIN32(const unsigned long code) noexcept
+{
+  return static_cast<HRESULT>(code) <= 0 ? static_cast<HRESULT>(code) :
+    dmitigr::wincom::fake::detail::hresult(
+      (static_cast<std::uint32_t>(code) & 0x0000FFFF) | 0x80070000);
+}
+
+inline constexpr long ERROR_SUCCESS{0};
+inline constexpr long ERROR_FILE_NOT_FOUND{2};
+inline constexpr long ERROR_PATH_NOT_FOUND{3};
+inline constexpr long ERROR_ACCESS_DENIED{5};
+inline constexpr long ERROR_INVALID_HANDLE{6};
+inline constexpr long ERROR_NOT_ENOUGH_MEMORY{8};
+inline constexpr long ERROR_DIR_NOT_EMPTY{145};
+inline constexpr long ERROR_INVALID_PARAMETER{87};
+inline constexpr long ERROR_ALREADY_EXISTS{183};
+inline constexpr long ERROR_ONLY_IF_CONNECTED{1251};
+inline constexpr long ERROR_TIMEOUT{1460};
+inline constexpr long RPC_S_SERVER_UNAVAILABLE{1722};
+
+#define DMITIGR_WINCOM_FAKE_HRESULT(name, value) \
+  inline constexpr HRESULT name{dmitigr::wincom::fake::detail::hresult(value)}
+
+DMITIGR_WINCOM_FAKE_HRESULT(S_OK, 0);
+DMITIGR_WINCOM_FAKE_HRESULT(S_FALSE, 1);
+DMITIGR_WINCOM_FAKE_HRESULT(E_NOTIMPL, 0x80004001);
+DMITIGR_WINCOM_FAKE_HRESULT(E_NOINTERFACE, 0x80004002);
+DMITIGR_WINCOM_FAKE_HRESULT(E_POINTER, 0x80004003);
+DMITIGR_WINCOM_FAKE_HRESULT(E_ABORT, 0x80004004);
+DMITIGR_WINCOM_FAKE_HRESULT(E_FAIL, 0x80004005);
+DMITIGR_WINCOM_FAKE_HRESULT(CO_E_NOT_SUPPORTED, 0x80004021);
+DMITIGR_WINCOM_FAKE_HRESULT(E_UNEXPECTED, 0x8000FFFF);
+DMITIGR_WINCOM_FAKE_HRESULT(RPC_E_CALL_REJECTED, 0x80010001);
+DMITIGR_WINCOM_FAKE_HRESULT(RPC_E_CALL_CANCELED, 0x80010002);
+DMITIGR_WINCOM_FAKE_HRESULT(RPC_E_CHANGED_MODE, 0x80010106);
+DMITIGR_WINCOM_FAKE_HRESULT(RPC_E_DISCONNECTED, 0x80010108);
+DMITIGR_WINCOM_FAKE_HRESULT(RPC_E_SERVERCALL_RETRYLATER, 0x8001010A);
+DMITIGR_WINCOM_FAKE_HRESULT(RPC_E_WRONG_THREAD, 0x8001010E);
+DMITIGR_WINCOM_FAKE_HRESULT(RPC_S_CALLPENDING, 0x80010115);
+DMITIGR_WINCOM_FAKE_HRESULT(RPC_E_CALL_COMPLETE, 0x80010117);
+DMITIGR_WINCOM_FAKE_HRESULT(RPC_E_TOO_LATE, 0x80010119);
+DMITIGR_WINCOM_FAKE_HRESULT(CO_E_CANCEL_DISABLED, 0x80010140);
+DMITIGR_WINCOM_FAKE_HRESULT(DISP_E_MEMBERNOTFOUND, 0x80020003);
+DMITIGR_WINCOM_FAKE_HRESULT(DISP_E_TYPEMISMATCH, 0x80020005);
+DMITIGR_WINCOM_FAKE_HRESULT(DISP_E_UNKNOWNNAME, 0x80020006);
+DMITIGR_WINCOM_FAKE_HRESULT(DISP_E_BADVARTYPE, 0x80020008);
+DMITIGR_WINCOM_FAKE_HRESULT(DISP_E_OVERFLOW, 0x8002000A);
+DMITIGR_WINCOM_FAKE_HRESULT(DISP_E_BADINDEX, 0x8002000B);
+DMITIGR_WINCOM_FAKE_HRESULT(DISP_E_ARRAYISLOCKED, 0x8002000D);
+DMITIGR_WINCOM_FAKE_HRESULT(CONNECT_E_NOCONNECTION, 0x80040200);
+DMITIGR_WINCOM_FAKE_HRESULT(CONNECT_E_CANNOTCONNECT, 0x80040202);
+DMITIGR_WINCOM_FAKE_HRESULT(CLASS_E_NOAGGREGATION, 0x80040110);
+DMITIGR_WINCOM_FAKE_HRESULT(REGDB_E_CLASSNOTREG, 0x80040154);
+DMITIGR_WINCOM_FAKE_HRESULT(CO_E_NOTINITIALIZED, 0x800401F0);
+DMITIGR_WINCOM_FAKE_HRESULT(E_ACCESSDENIED, 0x80070005);
+DMITIGR_WINCOM_FAKE_HRESULT(E_HANDLE, 0x80070006);
+DMITIGR_WINCOM_FAKE_HRESULT(E_OUTOFMEMORY, 0x8007000E);
+DMITIGR_WINCOM_FAKE_HRESULT(E_INVALIDARG, 0x80070057);
+
+// -----------------------------------------------------------------------------
+// IUnknown
+// -----------------------------------------------------------------------------
+
+struct IUnknown {
+  virtual HRESULT QueryInterface(REFIID id, void** object) = 0;
+  virtual ULONG AddRef() = 0;
+  virtual ULONG Release() = 0;
+
+  template<class Q>
+  HRESULT QueryInterface(Q** const object)
+  {
+    return QueryInterface(__uuidof(Q), reinterpret_cast<void**>(object));
+  }
+};
+using LPUNKNOWN = IUnknown*;
+DMITIGR_WINCOM_FAKE_UUID(IUnknown);
+inline constexpr IID IID_IUnknown{__uuidof(IUnknown)};
+
+// -----------------------------------------------------------------------------
+// BSTR
+// -----------------------------------------------------------------------------
+
+namespace dmitigr::wincom::fake {
+
+/// The number of `BSTR`s allocated and not freed.
+inline std::atomic_int64_t bstr_count;
+
+} // namespace dmitigr::wincom::fake
+
+/// @remarks The length prefix is the byte length as in Windows.
+inline BSTR SysAllocStringLen(const OLECHAR* const str, const UINT length)
+{
+  constexpr auto prefix = alignof(std::max_align_t);
+  auto* const memory = static_cast<char*>(std::malloc(prefix +
+      (static_cast<std::size_t>(length) + 1) * sizeof(OLECHAR)));
+  if (!memory)
+    return nullptr;
+  const auto bytes = static_cast<std::uint32_t>(length * sizeof(OLECHAR));
+  std::memcpy(memory + prefix - sizeof(bytes), &bytes, sizeof(bytes));
+  auto* const result = reinterpret_cast<BSTR>(memory + prefix);
+  if (str)
+    std::wmemcpy(result, str, length);
+  else
+    std::wmemset(result, 0, length);
+  result[length] = 0;
+  dmitigr::wincom::fake::bstr_count.fetch_add(1, std::memory_order_relaxed);
+  return result;
+}
+
+inline BSTR SysAllocString(const OLECHAR* const str)
+{
+  return str ? SysAllocStringLen(str, static_cast<UINT>(std::wcslen(str))) :
+    nullptr;
+}
+
+inline void SysFreeString(const BSTR str) noexcept
+{
+  if (str) {
+    dmitigr::wincom::fake::bstr_count.fetch_sub(1, std::memory_order_relaxed);
+    std::free(reinterpret_cast<char*>(str) - alignof(std::max_align_t));
+  }
+}
+
+inline UINT SysStringByteLen(const BSTR str) noexcept
+{
+  if (!str)
+    return 0;
+  std::uint32_t result{};
+  std::memcpy(&result, reinterpret_cast<const char*>(str) - sizeof(result),
+    sizeof(result));
+  return result;
+}
+
+inline UINT SysStringLen(const BSTR str) noexcept
+{
+  return SysStringByteLen(str) / sizeof(OLECHAR);
+}
+
+inline BOOL SysReAllocString(BSTR* const str, const OLECHAR* const value)
+{
+  if (!str)
+    return FALSE;
+  const auto result = SysAllocString(value);
+  if (value && !result)
+    return FALSE;
+  SysFreeString(*str);
+  *str = result;
+  return TRUE;
+}
+
+// -----------------------------------------------------------------------------
+// VARIANT
+// -----------------------------------------------------------------------------
+
+enum VARENUM : VARTYPE {
+  VT_EMPTY = 0,
+  VT_NULL = 1,
+  VT_I2 = 2,
+  VT_I4 = 3,
+  VT_R4 = 4,
+  VT_R8 = 5,
+  VT_DATE = 7,
+  VT_BSTR = 8,
+  VT_DISPATCH = 9,
+  VT_ERROR = 10,
+  VT_BOOL = 11,
+  VT_VARIANT = 12,
+  VT_UNKNOWN = 13,
+  VT_I1 = 16,
+  VT_UI1 = 17,
+  VT_UI2 = 18,
+  VT_UI4 = 19,
+  VT_I8 = 20,
+  VT_UI8 = 21,
+  VT_INT = 22,
+  VT_UINT = 23,
+  VT_ARRAY = 0x2000,
+  VT_BYREF = 0x4000,
+  VT_TYPEMASK = 0x0FFF
+};
+
+struct IDispatch;
+struct tagSAFEARRAY;
+
+struct tagVARIANT {
+  VARTYPE vt;
+  WORD wReserved1;
+  WORD wReserved2;
+  WORD wReserved3;
+  union {
+    LONGLONG llVal;
+    ULONGLONG ullVal;
+    LONG lVal;
+    ULONG ulVal;
+    INT intVal;
+    UINT uintVal;
+    SHORT iVal;
+    USHORT uiVal;
+    CHAR cVal;
+    BYTE bVal;
+    FLOAT fltVal;
+    DOUBLE dblVal;
+    VARIANT_BOOL boolVal;
+    SCODE scode;
+    DATE date;
+    BSTR bstrVal;
+    IUnknown* punkVal;
+    IDispatch* pdispVal;
+    tagSAFEARRAY* parray;
+    tagVARIANT* pvarVal;
+    PVOID byref;
+  };
+};
+using VARIANT = tagVARIANT;
+using VARIANTARG = tagVARIANT;
+using LPVARIANT = VARIANT*;
+
+// -----------------------------------------------------------------------------
+// SAFEARRAY
+// -----------------------------------------------------------------------------
+
+struct SAFEARRAYBOUND final {
+  ULONG cElements;
+  LONG lLbound;
+};
+
+/**
+ * @remarks The element type is kept in front of the structure and the
+ * elements are laid out with the first index varying fastest.
+ */
+struct tagSAFEARRAY {
+  USHORT cDims;
+  USHORT fFeatures;
+  ULONG cbElements;
+  ULONG cLocks;
+  PVOID pvData;
+  SAFEARRAYBOUND rgsabound[1];
+};
+using SAFEARRAY = tagSAFEARRAY;
+using LPSAFEARRAY = SAFEARRAY*;
+
+// -----------------------------------------------------------------------------
+// IDispatch
+// -----------------------------------------------------------------------------
+
+struct ITypeInfo;
+
+struct DISPPARAMS final {
+  VARIANTARG* rgvarg;
+  DISPID* rgdispidNamedArgs;
+  UINT cArgs;
+  UINT cNamedArgs;
+};
+
+struct EXCEPINFO final {
+  WORD wCode;
+  WORD wReserved;
+  BSTR bstrSource;
+  BSTR bstrDescription;
+  BSTR bstrHelpFile;
+  DWORD dwHelpContext;
+  PVOID pvReserved;
+  HRESULT (*pfnDeferredFillIn)(EXCEPINFO*);
+  SCODE scode;
+};
+
+inline constexpr DISPID DISPID_UNKNOWN{-1};
+inline constexpr DISPID DISPID_VALUE{0};
+inline constexpr DISPID DISPID_NEWENUM{-4};
+inline constexpr WORD DISPATCH_METHOD{1};
+inline constexpr WORD DISPATCH_PROPERTYGET{2};
+inline constexpr WORD DISPATCH_PROPERTYPUT{4};
+
+struct IDispatch : IUnknown {
+  virtual HRESULT GetTypeInfoCount(UINT* info) = 0;
+  virtual HRESULT GetTypeInfo(UINT info, LCID cid, ITypeInfo** tinfo) = 0;
+  virtual HRESULT GetIDsOfNames(REFIID riid, LPOLESTR* names,
+    UINT name_count, LCID cid, DISPID* disp_id) = 0;
+  virtual HRESULT Invoke(DISPID member, REFIID riid, LCID cid, WORD flags,
+    DISPPARAMS* params, VARIANT* result, EXCEPINFO* excep_info,
+    UINT* arg_err) = 0;
+};
+using LPDISPATCH = IDispatch*;
+DMITIGR_WINCOM_FAKE_INTERFACE(IDispatch, IUnknown);
+inline constexpr IID IID_IDispatch{__uuidof(IDispatch)};
+
+// -----------------------------------------------------------------------------
+// VARIANT functions
+// -----------------------------------------------------------------------------
+
+inline HRESULT SafeArrayCopy(SAFEARRAY* array, SAFEARRAY** result);
+inline HRESULT SafeArrayDestroy(SAFEARRAY* array);
+
+inline void VariantInit(VARIANT* const variant) noexcept
+{
+  std::memset(variant, 0, sizeof(*variant));
+}
+
+inline HRESULT VariantClear(VARIANT* const variant)
+{
+  if (!variant)
+    return E_INVALIDARG;
+  if (!(variant->vt & VT_BYREF)) {
+    if (variant->vt & VT_ARRAY)
+      SafeArrayDestroy(variant->parray);
+    else if (variant->vt == VT_BSTR)
+      SysFreeString(variant->bstrVal);
+    else if ((variant->vt == VT_UNKNOWN || variant->vt == VT_DISPATCH)
+      && variant->punkVal)
+      variant->punkVal->Release();
+  }
+  VariantInit(variant);
+  return S_OK;
+}
+
+inline HRESULT VariantCopy(VARIANT* const dest, const VARIANT* const source)
+{
+  if (!dest || !source)
+    return E_INVALIDARG;
+  else if (dest == source)
+    return S_OK;
+
+  VARIANT result{*source};
+  if (!(source->vt & VT_BYREF)) {
+    if (source->vt & VT_ARRAY) {
+      if (const auto err = SafeArrayCopy(source->parray, &result.parray))
+        return err;
+    } else if (source->vt == VT_BSTR) {
+      if (source->bstrVal) {
+        result.bstrVal = SysAllocStringLen(source->bstrVal,
+          SysStringLen(source->bstrVal));
+        if (!result.bstrVal)
+          return E_OUTOFMEMORY;
+      }
+    } else if ((source->vt == VT_UNKNOWN || source->vt == VT_DISPATCH)
+      && source->punkVal)
+      source->punkVal->AddRef();
+  }
+  VariantClear(dest);
+  *dest = result;
+  return S_OK;
+}
+
+namespace dmitigr::wincom::fake::detail {
+
+/// @returns The numeric value of `variant`, or `false` if it's not numeric.
+inline bool variant_number(const VARIANT& variant, double& result) noexcept
+{
+  switch (variant.vt) {
+  case VT_EMPTY: result = 0; break;
+  case VT_I1: result = variant.cVal; break;
+  case VT_UI1: result = variant.bVal; break;
+  case VT_I2: result = variant.iVal; break;
+  case VT_UI2: result = variant.uiVal; break;
+  case VT_I4: result = variant.lVal; break;
+  case VT_UI4: result = variant.ulVal; break;
+  case VT_INT: result = variant.intVal; break;
+  case VT_UINT: result = variant.uintVal; break;
+  case VT_I8: result = static_cast<double>(variant.llVal); break;
+  case VT_UI8: result = static_cast<double>(variant.ullVal); break;
+  case VT_R4: result = variant.fltVal; break;
+  case VT_R8: result = variant.dblVal; break;
+  case VT_DATE: result = variant.date; break;
+  case VT_BOOL: result = variant.boolVal ? -1 : 0; break;
+  case VT_ERROR: result = variant.scode; break;
+  default: return false;
+  }
+  return true;
+}
+
+} // namespace dmitigr::wincom::fake::detail
+
+/**
+ * @brief Converts between `VT_BSTR`, `VT_BOOL` and the numeric types.
+ *
+ * @remarks The numbers are formatted and parsed in the "C" locale.
+ */
+inline HRESULT VariantChangeType(VARIANT* const dest,
+  const VARIANT* const source, const USHORT /*flags*/, const VARTYPE vt)
+{
+  if (!dest || !source)
+    return E_INVALIDARG;
+  else if (source->vt == vt)
+    return VariantCopy(dest, source);
+
+  VARIANT result{};
+  result.vt = vt;
+  double number{};
+  if (source->vt == VT_BSTR) {
+    const std::wstring_view str{source->bstrVal ? source->bstrVal : L"",
+      SysStringLen(source->bstrVal)};
+    if (vt == VT_BOOL) {
+      if (str == L"True" || str == L"true" || str == L"-1")
+        number = -1;
+      else if (str == L"False" || str == L"false" || str == L"0")
+        number = 0;
+      else
+        return DISP_E_TYPEMISMATCH;
+    } else {
+      const std::wstring value{str};
+      wchar_t* end{};
+      number = std::wcstod(value.c_str(), &end);
+      if (value.empty() || *end)
+        return DISP_E_TYPEMISMATCH;
+    }
+  } else if (!dmitigr::wincom::fake::detail::variant_number(*source, number))
+    return DISP_E_TYPEMISMATCH;
+
+  const auto integer = [number](auto& value) -> HRESULT
+  {
+    using T = std::decay_t<decltype(value)>;
+    if (number < static_cast<double>(std::numeric_limits<T>::min())
+      || number > static_cast<double>(std::numeric_limits<T>::max()))
+      return DISP_E_OVERFLOW;
+    value = static_cast<T>(number);
+    return S_OK;
+  };
+  HRESULT err{S_OK};
+  switch (vt) {
+  case VT_EMPTY: break;
+  case VT_I1: err = integer(result.cVal); break;
+  case VT_UI1: err = integer(result.bVal); break;
+  case VT_I2: err = integer(result.iVal); break;
+  case VT_UI2: err = integer(result.uiVal); break;
+  case VT_I4: err = integer(result.lVal); break;
+  case VT_UI4: err = integer(result.ulVal); break;
+  case VT_INT: err = integer(result.intVal); break;
+  case VT_UINT: err = integer(result.uintVal); break;
+  case VT_I8: err = integer(result.llVal); break;
+  case VT_UI8: err = integer(result.ullVal); break;
+  case VT_R4: result.fltVal = static_cast<FLOAT>(number); break;
+  case VT_R8: result.dblVal = number; break;
+  case VT_DATE: result.date = number; break;
+  case VT_BOOL: result.boolVal = number ? VARIANT_TRUE : VARIANT_FALSE; break;
+  case VT_BSTR: {
+    std::wstring value;
+    if (source->vt == VT_BOOL)
+      value = source->boolVal ? L"True" : L"False";
+    else if (number == static_cast<double>(static_cast<long long>(number)))
+      value = std::to_wstring(static_cast<long long>(number));
+    else {
+      value.resize(32);
+      value.resize(static_cast<std::size_t>(std::swprintf(value.data(),
+            value.size(), L"%.15g", number)));
+    }
+    result.bstrVal = SysAllocStringLen(value.data(),
+      static_cast<UINT>(value.size()));
+    if (!result.bstrVal)
+      return E_OUTOFMEMORY;
+    break;
+  }
+  default:
+    return DISP_E_BADVARTYPE;
+  }
+  if (err != S_OK)
+    return err;
+
+  VariantClear(dest);
+  *dest = result;
+  return S_OK;
+}
+
+// -----------------------------------------------------------------------------
+// SAFEARRAY functions
+// -----------------------------------------------------------------------------
+
+namespace dmitigr::wincom::fake::detail {
+
+inline constexpr std::size_t safe_array_prefix{alignof(std::max_align_t)};
+
+inline VARTYPE& safe_array_vt(SAFEARRAY* const array) noexcept
+{
+  return *reinterpret_cast<VARTYPE*>(
+    reinterpret_cast<char*>(array) - safe_array_prefix);
+}
+
+inline std::size_t safe_array_size(const SAFEARRAY* const array) noexcept
+{
+  std::size_t result{1};
+  for (USHORT i{}; i < array->cDims; ++i)
+    result *= array->rgsabound[i].cElements;
+  return result;
+}
+
+inline ULONG safe_array_element_size(const VARTYPE vt) noexcept
+{
+  switch (vt) {
+  case VT_I1: case VT_UI1: return 1;
+  case VT_I2: case VT_UI2: case VT_BOOL: return 2;
+  case VT_I4: case VT_UI4: case VT_INT: case VT_UINT: case VT_R4:
+  case VT_ERROR: return 4;
+  case VT_I8: case VT_UI8: case VT_R8: case VT_DATE: return 8;
+  case VT_BSTR: case VT_UNKNOWN: case VT_DISPATCH: return sizeof(void*);
+  case VT_VARIANT: return sizeof(VARIANT);
+  default: return 0;
+  }
+}
+
+/// @returns The pointer to the element at `indices`, or `nullptr`.
+inline void* safe_array_element(SAFEARRAY* const array,
+  const LONG* const indices) noexcept
+{
+  std::size_t offset{};
+  std::size_t stride{1};
+  for (USHORT i{}; i < array->cDims; ++i) {
+    const auto& bound = array->rgsabound[i];
+    const auto index = indices[i] - bound.lLbound;
+    if (index < 0 || static_cast<ULONG>(index) >= bound.cElements)
+      return nullptr;
+    offset += static_cast<std::size_t>(index) * stride;
+    stride *= bound.cElements;
+  }
+  return static_cast<char*>(array->pvData) + offset * array->cbElements;
+}
+
+/// Copies the element of type `vt` from `source` to the cleared `dest`.
+inline HRESULT safe_array_copy_element(const VARTYPE vt, void* const dest,
+  const void* const source, const ULONG size)
+{
+  switch (vt) {
+  case VT_BSTR: {
+    const auto str = *static_cast<const BSTR*>(source);
+    auto& result = *static_cast<BSTR*>(dest);
+    result = str ? SysAllocStringLen(str, SysStringLen(str)) : nullptr;
+    return str && !result ? E_OUTOFMEMORY : S_OK;
+  }
+  case VT_VARIANT:
+    VariantInit(static_cast<VARIANT*>(dest));
+    return VariantCopy(static_cast<VARIANT*>(dest),
+      static_cast<const VARIANT*>(source));
+  case VT_UNKNOWN:
+  case VT_DISPATCH:
+    if (auto* const unknown = *static_cast<IUnknown* const*>(source))
+      unknown->AddRef();
+    [[fallthrough]];
+  default:
+    std::memcpy(dest, source, size);
+    return S_OK;
+  }
+}
+
+/// Clears the element of type `vt`.
+inline void safe_array_clear_element(const VARTYPE vt, void* const element,
+  const ULONG size) noexcept
+{
+  switch (vt) {
+  case VT_BSTR:
+    SysFreeString(*static_cast<BSTR*>(element));
+    break;
+  case VT_VARIANT:
+    VariantClear(static_cast<VARIANT*>(element));
+    break;
+  case VT_UNKNOWN:
+  case VT_DISPATCH:
+    if (auto* const unknown = *static_cast<IUnknown**>(element))
+      unknown->Release();
+    break;
+  default:
+    break;
+  }
+  std::memset(element, 0, size);
+}
+
+} // namespace dmitigr::wincom::fake::detail
+
+inline SAFEARRAY* SafeArrayCreate(const VARTYPE vt, const UINT dim_count,
+  const SAFEARRAYBOUND* const bounds)
+{
+  namespace detail = dmitigr::wincom::fake::detail;
+  const auto element_size = detail::safe_array_element_size(vt);
+  if (!element_size || !dim_count || !bounds
+    || dim_count > std::numeric_limits<USHORT>::max())
+    return nullptr;
+
+  const auto header_size = detail::safe_array_prefix + sizeof(SAFEARRAY)
+    + (dim_count - 1) * sizeof(SAFEARRAYBOUND);
+  auto* const memory = static_cast<char*>(std::calloc(1, header_size));
+  if (!memory)
+    return nullptr;
+  auto* const result = reinterpret_cast<SAFEARRAY*>(memory +
+    detail::safe_array_prefix);
+  result->cDims = static_cast<USHORT>(dim_count);
+  result->cbElements = element_size;
+  std::copy(bounds, bounds + dim_count, result->rgsabound);
+  detail::safe_array_vt(result) = vt;
+  result->pvData = std::calloc(std::max<std::size_t>(
+      detail::safe_array_size(result), 1), element_size);
+  if (!result->pvData) {
+    std::free(memory);
+    return nullptr;
+  }
+  return result;
+}
+
+inline SAFEARRAY* SafeArrayCreateVector(const VARTYPE vt, const LONG lower,
+  const ULONG count)
+{
+  const SAFEARRAYBOUND bound{count, lower};
+  return SafeArrayCreate(vt, 1, &bound);
+}
+
+inline HRESULT SafeArrayDestroy(SAFEARRAY* const array)
+{
+  namespace detail = dmitigr::wincom::fake::detail;
+  if (!array)
+    return S_OK;
+  else if (array->cLocks)
+    return DISP_E_ARRAYISLOCKED;
+
+  const auto vt = detail::safe_array_vt(array);
+  const auto size = detail::safe_array_size(array);
+  auto* const data = static_cast<char*>(array->pvData);
+  for (std::size_t i{}; i < size; ++i)
+    detail::safe_array_clear_element(vt, data + i * array->cbElements,
+      array->cbElements);
+  std::free(array->pvData);
+  std::free(reinterpret_cast<char*>(array) - detail::safe_array_prefix);
+  return S_OK;
+}
+
+inline UINT SafeArrayGetDim(SAFEARRAY* const array) noexcept
+{
+  return array ? array->cDims : 0;
+}
+
+inline UINT SafeArrayGetElemsize(SAFEARRAY* const array) noexcept
+{
+  return array ? array->cbElements : 0;
+}
+
+inline HRESULT SafeArrayGetVartype(SAFEARRAY* const array,
+  VARTYPE* const result) noexcept
+{
+  if (!array || !result)
+    return E_INVALIDARG;
+  *result = dmitigr::wincom::fake::detail::safe_array_vt(array);
+  return S_OK;
+}
+
+/// @param dim 1-based dimension.
+inline HRESULT SafeArrayGetLBound(SAFEARRAY* const array, const UINT dim,
+  LONG* const result) noexcept
+{
+  if (!array || !result)
+    return E_INVALIDARG;
+  else if (!dim || dim > array->cDims)
+    return DISP_E_BADINDEX;
+  *result = array->rgsabound[dim - 1].lLbound;
+  return S_OK;
+}
+
+/// @param dim 1-based dimension.
+inline HRESULT SafeArrayGetUBound(SAFEARRAY* const array, const UINT dim,
+  LONG* const result) noexcept
+{
+  if (!array || !result)
+    return E_INVALIDARG;
+  else if (!dim || dim > array->cDims)
+    return DISP_E_BADINDEX;
+  const auto& bound = array->rgsabound[dim - 1];
+  *result = bound.lLbound + static_cast<LONG>(bound.cElements) - 1;
+  return S_OK;
+}
+
+inline HRESULT SafeArrayLock(SAFEARRAY* const array) noexcept
+{
+  if (!array)
+    return E_INVALIDARG;
+  ++array->cLocks;
+  return S_OK;
+}
+
+inline HRESULT SafeArrayUnlock(SAFEARRAY* const array) noexcept
+{
+  if (!array || !array->cLocks)
+    return E_UNEXPECTED;
+  --array->cLocks;
+  return S_OK;
+}
+
+inline HRESULT SafeArrayAccessData(SAFEARRAY* const array,
+  void** const data) noexcept
+{
+  if (!array || !data)
+    return E_INVALIDARG;
+  ++array->cLocks;
+  *data = array->pvData;
+  return S_OK;
+}
+
+inline HRESULT SafeArrayUnaccessData(SAFEARRAY* const array) noexcept
+{
+  return SafeArrayUnlock(array);
+}
+
+/// Copies the element at `indices` to `result`.
+inline HRESULT SafeArrayGetElement(SAFEARRAY* const array,
+  const LONG* const indices, void* const result)
+{
+  namespace detail = dmitigr::wincom::fake::detail;
+  if (!array || !indices || !result)
+    return E_INVALIDARG;
+  const auto* const element = detail::safe_array_element(array, indices);
+  if (!element)
+    return DISP_E_BADINDEX;
+  return detail::safe_array_copy_element(detail::safe_array_vt(array), result,
+    element, array->cbElements);
+}
+
+/// Copies `value` to the element at `indices`.
+inline HRESULT SafeArrayPutElement(SAFEARRAY* const array,
+  const LONG* const indices, void* const value)
+{
+  namespace detail = dmitigr::wincom::fake::detail;
+  if (!array || !indices)
+    return E_INVALIDARG;
+  auto* const element = detail::safe_array_element(array, indices);
+  if (!element)
+    return DISP_E_BADINDEX;
+
+  const auto vt = detail::safe_array_vt(array);
+  // The pointer-like elements are passed by value, the others by pointer.
+  void* pointer{value};
+  void* const source = vt == VT_BSTR || vt == VT_UNKNOWN || vt == VT_DISPATCH ?
+    &pointer : value;
+  if (!source)
+    return E_INVALIDARG;
+  detail::safe_array_clear_element(vt, element, array->cbElements);
+  return detail::safe_array_copy_element(vt, element, source,
+    array->cbElements);
+}
+
+inline HRESULT SafeArrayCopy(SAFEARRAY* const array, SAFEARRAY** const result)
+{
+  namespace detail = dmitigr::wincom::fake::detail;
+  if (!result)
+    return E_INVALIDARG;
+  *result = nullptr;
+  if (!array)
+    return S_OK;
+
+  const auto vt = detail::safe_array_vt(array);
+  auto* const copy = SafeArrayCreate(vt, array->cDims, array->rgsabound);
+  if (!copy)
+    return E_OUTOFMEMORY;
+  const auto size = detail::safe_array_size(array);
+  for (std::size_t i{}; i < size; ++i) {
+    const auto offset = i * array->cbElements;
+    const auto err = detail::safe_array_copy_element(vt,
+      static_cast<char*>(copy->pvData) + offset,
+      static_cast<const char*>(array->pvData) + offset, array->cbElements);
+    if (err != S_OK) {
+      SafeArrayDestroy(copy);
+      return err;
+    }
+  }
+  *result = copy;
+  return S_OK;
+}
+
+// -----------------------------------------------------------------------------
+// Core interfaces
+// -----------------------------------------------------------------------------
+
+struct IEnumVARIANT : IUnknown {
+  virtual HRESULT Next(ULONG count, VARIANT* result, ULONG* fetched) = 0;
+  virtual HRESULT Skip(ULONG count) = 0;
+  virtual HRESULT Reset() = 0;
+  virtual HRESULT Clone(IEnumVARIANT** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IEnumVARIANT, IUnknown);
+
+/// The stream of the marshaled interface (see
+/// `CoMarshalInterThreadInterfaceInStream()`).
+struct IStream : IUnknown {};
+using LPSTREAM = IStream*;
+DMITIGR_WINCOM_FAKE_INTERFACE(IStream, IUnknown);
+
+struct IConnectionPointContainer;
+struct IEnumConnections;
+struct IEnumConnectionPoints;
+
+struct IConnectionPoint : IUnknown {
+  virtual HRESULT GetConnectionInterface(IID* result) = 0;
+  virtual HRESULT GetConnectionPointContainer(
+    IConnectionPointContainer** result) = 0;
+  virtual HRESULT Advise(IUnknown* sink, DWORD* cookie) = 0;
+  virtual HRESULT Unadvise(DWORD cookie) = 0;
+  virtual HRESULT EnumConnections(IEnumConnections** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IConnectionPoint, IUnknown);
+
+struct IConnectionPointContainer : IUnknown {
+  virtual HRESULT EnumConnectionPoints(IEnumConnectionPoints** result) = 0;
+  virtual HRESULT FindConnectionPoint(REFIID id,
+    IConnectionPoint** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IConnectionPointContainer, IUnknown);
+
+enum MSHCTX {
+  MSHCTX_LOCAL = 0,
+  MSHCTX_NOSHAREDMEM = 1,
+  MSHCTX_DIFFERENTMACHINE = 2,
+  MSHCTX_INPROC = 3
+};
+
+enum MSHLFLAGS {
+  MSHLFLAGS_NORMAL = 0,
+  MSHLFLAGS_TABLESTRONG = 1,
+  MSHLFLAGS_TABLEWEAK = 2
+};
+
+struct IMarshal : IUnknown {};
+DMITIGR_WINCOM_FAKE_INTERFACE(IMarshal, IUnknown);
+
+struct INTERFACEINFO final {
+  IUnknown* pUnk;
+  IID iid;
+  WORD wMethod;
+};
+using LPINTERFACEINFO = INTERFACEINFO*;
+
+enum SERVERCALL {
+  SERVERCALL_ISHANDLED = 0,
+  SERVERCALL_REJECTED = 1,
+  SERVERCALL_RETRYLATER = 2
+};
+
+enum PENDINGMSG {
+  PENDINGMSG_CANCELCALL = 0,
+  PENDINGMSG_WAITNOPROCESS = 1,
+  PENDINGMSG_WAITDEFPROCESS = 2
+};
+
+struct IMessageFilter : IUnknown {
+  virtual DWORD HandleInComingCall(DWORD call_type, HTASK caller,
+    DWORD tick_count, INTERFACEINFO* info) = 0;
+  virtual DWORD RetryRejectedCall(HTASK callee, DWORD tick_count,
+    DWORD reject_type) = 0;
+  virtual DWORD MessagePending(HTASK callee, DWORD tick_count,
+    DWORD pending_type) = 0;
+};
+using LPMESSAGEFILTER = IMessageFilter*;
+DMITIGR_WINCOM_FAKE_INTERFACE(IMessageFilter, IUnknown);
+
+struct ICallFactory : IUnknown {
+  virtual HRESULT CreateCall(REFIID async_id, IUnknown* outer, REFIID id,
+    IUnknown** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(ICallFactory, IUnknown);
+
+struct ISynchronize : IUnknown {
+  virtual HRESULT Wait(DWORD flags, DWORD milliseconds) = 0;
+  virtual HRESULT Signal() = 0;
+  virtual HRESULT Reset() = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(ISynchronize, IUnknown);
+
+struct ISynchronizeHandle : IUnknown {
+  virtual HRESULT GetHandle(HANDLE* result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(ISynchronizeHandle, IUnknown);
+
+struct ICancelMethodCalls : IUnknown {
+  virtual HRESULT Cancel(ULONG seconds) = 0;
+  virtual HRESULT TestCancel() = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(ICancelMethodCalls, IUnknown);
+
+using RPC_AUTH_IDENTITY_HANDLE = void*;
+
+struct IClientSecurity : IUnknown {
+  virtual HRESULT QueryBlanket(IUnknown* proxy, DWORD* authn, DWORD* authz,
+    OLECHAR** server_princ_name, DWORD* authn_level, DWORD* imperson_level,
+    void** auth_info, DWORD* capabilities) = 0;
+  virtual HRESULT SetBlanket(IUnknown* proxy, DWORD authn, DWORD authz,
+    OLECHAR* server_princ_name, DWORD authn_level, DWORD imperson_level,
+    void* auth_info, DWORD capabilities) = 0;
+  virtual HRESULT CopyProxy(IUnknown* proxy, IUnknown** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IClientSecurity, IUnknown);
+
+struct AsyncIUnknown : IUnknown {
+  virtual HRESULT Begin_QueryInterface(REFIID id) = 0;
+  virtual HRESULT Finish_QueryInterface(void** result) = 0;
+  virtual HRESULT Begin_AddRef() = 0;
+  virtual ULONG Finish_AddRef() = 0;
+  virtual HRESULT Begin_Release() = 0;
+  virtual ULONG Finish_Release() = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(AsyncIUnknown, IUnknown);
@@ -0,0 +1,488 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "com.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/*
+ * The portable subset of the compiler COM support classes of MSVC: `_bstr_t`,
+ * `_variant_t` and `_com_error`. The narrow strings are UTF-8 (rather than
+ * of the ANSI code page).
+ */
+
+namespace dmitigr::wincom::fake::detail {
+
+/// @returns The UTF-8 representation of `str`.
+inline std::string to_utf8(const std::wstring_view str)
+{
+  std::string result;
+  result.reserve(str.size());
+  for (std::size_t i{}; i < str.size(); ++i) {
+    auto cp = static_cast<std::uint32_t>(str[i]);
+    if constexpr (sizeof(wchar_t) == 2) {
+      if (cp >= 0xD800 && cp < 0xDC00 && i + 1 < str.size()) {
+        const auto low = static_cast<std::uint32_t>(str[i + 1]);
+        if (low >= 0xDC00 && low < 0xE000) {
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+          ++i;
+        }
+      }
+    }
+    if (cp < 0x80)
+      result += static_cast<char>(cp);
+    else if (cp < 0x800) {
+      result += static_cast<char>(0xC0 | (cp >> 6));
+      result += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+      result += static_cast<char>(0xE0 | (cp >> 12));
+      result += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+      result += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+      result += static_cast<char>(0xF0 | (cp >> 18));
+      result += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+      result += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+      result += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+  }
+  return result;
+}
+
+/// @returns The wide representation of UTF-8 `str`.
+inline std::wstring to_wide(const std::string_view str)
+{
+  std::wstring result;
+  result.reserve(str.size());
+  for (std::size_t i{}; i < str.size();) {
+    const auto lead = static_cast<unsigned char>(str[i]);
+    const std::size_t length = lead < 0x80 ? 1 : lead < 0xE0 ? 2 :
+      lead < 0xF0 ? 3 : 4;
+    std::uint32_t cp = length == 1 ? lead : length == 2 ? lead & 0x1F :
+      length == 3 ? lead & 0x0F : lead & 0x07;
+    for (std::size_t j{1}; j < length && i + j < str.size(); ++j)
+      cp = (cp << 6) | (static_cast<unsigned char>(str[i + j]) & 0x3F);
+    i += length;
+    if (sizeof(wchar_t) == 2 && cp >= 0x10000) {
+      cp -= 0x10000;
+      result += static_cast<wchar_t>(0xD800 + (cp >> 10));
+      result += static_cast<wchar_t>(0xDC00 + (cp & 0x3FF));
+    } else
+      result += static_cast<wchar_t>(cp);
+  }
+  return result;
+}
+
+} // namespace dmitigr::wincom::fake::detail
+
+// -----------------------------------------------------------------------------
+// _com_error
+// -----------------------------------------------------------------------------
+
+class _com_error {
+public:
+  virtual ~_com_error() = default;
+
+  explicit _com_error(const HRESULT hr) noexcept
+    : hr_{hr}
+  {}
+
+  HRESULT Error() const noexcept
+  {
+    return hr_;
+  }
+
+  const wchar_t* ErrorMessage() const noexcept
+  {
+    return L"COM error";
+  }
+
+private:
+  HRESULT hr_{};
+};
+
+[[noreturn]] inline void _com_issue_error(const HRESULT hr)
+{
+  throw _com_error{hr};
+}
+
+// -----------------------------------------------------------------------------
+// _bstr_t
+// -----------------------------------------------------------------------------
+
+/// The shared `BSTR` with the lazily created narrow copy.
+class _bstr_t final {
+public:
+  _bstr_t() noexcept = default;
+
+  _bstr_t(const char* const str)
+    : data_{str ? make(wide(str)) : nullptr}
+  {}
+
+  _bstr_t(const wchar_t* const str)
+    : data_{str ? make(str) : nullptr}
+  {}
+
+  /// Takes the ownership of `str` unless `copy`.
+  _bstr_t(const BSTR str, const bool copy)
+  {
+    if (!str)
+      return;
+    else if (copy)
+      data_ = make(std::wstring_view{str, SysStringLen(str)});
+    else
+      data_ = std::make_shared<Data>(str);
+  }
+
+  operator const wchar_t*() const noexcept
+  {
+    return data_ ? data_->wide : nullptr;
+  }
+
+  operator wchar_t*() const noexcept
+  {
+    return data_ ? data_->wide : nullptr;
+  }
+
+  operator const char*() const
+  {
+    return data_ ? narrow() : nullptr;
+  }
+
+  operator char*() const
+  {
+    return data_ ? const_cast<char*>(narrow()) : nullptr;
+  }
+
+  bool operator!() const noexcept
+  {
+    return !data_;
+  }
+
+  /// @returns The number of characters.
+  unsigned int length() const noexcept
+  {
+    return data_ ? SysStringLen(data_->wide) : 0;
+  }
+
+  /// @returns The copy of the string to be freed by the caller.
+  BSTR copy() const
+  {
+    return data_ ? SysAllocStringLen(data_->wide, length()) : nullptr;
+  }
+
+  /// @returns The string released from the ownership.
+  BSTR Detach()
+  {
+    if (!data_)
+      return nullptr;
+    else if (data_.use_count() > 1)
+      return copy();
+    const auto result = data_->wide;
+    data_->wide = nullptr;
+    data_.reset();
+    return result;
+  }
+
+  BSTR* GetAddress()
+  {
+    if (!data_ || data_.use_count() > 1)
+      data_ = std::make_shared<Data>(nullptr);
+    else {
+      SysFreeString(data_->wide);
+      data_->wide = nullptr;
+      data_->narrow.reset();
+    }
+    return &data_->wide;
+  }
+
+  _bstr_t& operator+=(const _bstr_t& rhs)
+  {
+    std::wstring result{view()};
+    result.append(rhs.view());
+    data_ = make(result);
+    return *this;
+  }
+
+  friend bool operator==(const _bstr_t& lhs, const _bstr_t& rhs) noexcept
+  {
+    return lhs.view() == rhs.view();
+  }
+
+private:
+  struct Data final {
+    ~Data()
+    {
+      SysFreeString(wide);
+    }
+
+    explicit Data(const BSTR str) noexcept
+      : wide{str}
+    {}
+
+    Data(const Data&) = delete;
+    Data& operator=(const Data&) = delete;
+
+    BSTR wide{};
+    std::unique_ptr<std::string> narrow;
+  };
+
+  std::shared_ptr<Data> data_;
+
+  static std::shared_ptr<Data> make(const std::wstring_view str)
+  {
+    const auto result = SysAllocStringLen(str.data(),
+      static_cast<UINT>(str.size()));
+    if (!result)
+      throw std::bad_alloc{};
+    return std::make_shared<Data>(result);
+  }
+
+  static std::wstring wide(const char* const str)
+  {
+    return dmitigr::wincom::fake::detail::to_wide(str);
+  }
+
+  std::wstring_view view() const noexcept
+  {
+    return data_ && data_->wide ?
+      std::wstring_view{data_->wide, length()} : std::wstring_view{};
+  }
+
+  const char* narrow() const
+  {
+    if (!data_->narrow)
+      data_->narrow = std::make_unique<std::string>(
+        dmitigr::wincom::fake::detail::to_utf8(view()));
+    return data_->narrow->c_str();
+  }
+};
+
+// -----------------------------------------------------------------------------
+// _variant_t
+// -----------------------------------------------------------------------------
+
+/// The owning `VARIANT`.
+class _variant_t final : public VARIANT {
+public:
+  ~_variant_t()
+  {
+    VariantClear(this);
+  }
+
+  _variant_t() noexcept
+  {
+    VariantInit(this);
+  }
+
+  _variant_t(const VARIANT& rhs)
+  {
+    VariantInit(this);
+    if (const auto err = VariantCopy(this, &rhs); err != S_OK)
+      _com_issue_error(err);
+  }
+
+  _variant_t(const _variant_t& rhs)
+    : _variant_t{static_cast<const VARIANT&>(rhs)}
+  {}
+
+  _variant_t& operator=(const _variant_t& rhs)
+  {
+    if (this != &rhs) {
+      _variant_t tmp{rhs};
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  _variant_t(_variant_t&& rhs) noexcept
+    : VARIANT{rhs}
+  {
+    VariantInit(&rhs);
+  }
+
+  _variant_t& operator=(_variant_t&& rhs) noexcept
+  {
+    if (this != &rhs) {
+      _variant_t tmp{std::move(rhs)};
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  _variant_t(const short value, const VARTYPE type = VT_I2)
+  {
+    VariantInit(this);
+    if (type == VT_BOOL) {
+      vt = VT_BOOL;
+      boolVal = value ? VARIANT_TRUE : VARIANT_FALSE;
+    } else {
+      vt = VT_I2;
+      iVal = value;
+    }
+  }
+
+  _variant_t(const long value, const VARTYPE type = VT_I4)
+  {
+    VariantInit(this);
+    if (type == VT_ERROR) {
+      vt = VT_ERROR;
+      scode = value;
+    } else if (type == VT_BOOL) {
+      vt = VT_BOOL;
+      boolVal = value ? VARIANT_TRUE : VARIANT_FALSE;
+    } else {
+      vt = VT_I4;
+      lVal = value;
+    }
+  }
+
+  _variant_t(const int value, const VARTYPE type = VT_INT)
+  {
+    VariantInit(this);
+    if (type == VT_I4) {
+      vt = VT_I4;
+      lVal = value;
+    } else {
+      vt = VT_INT;
+      intVal = value;
+    }
+  }
+
+  _variant_t(const unsigned long value) noexcept
+  {
+    VariantInit(this);
+    vt = VT_UI4;
+    ulVal = value;
+  }
+
+  _variant_t(const long long value) noexcept
+  {
+    VariantInit(this);
+    vt = VT_I8;
+    llVal = value;
+  }
+
+  _variant_t(const double value, const VARTYPE type = VT_R8)
+  {
+    VariantInit(this);
+    if (type == VT_DATE) {
+      vt = VT_DATE;
+      date = value;
+    } else {
+      vt = VT_R8;
+      dblVal = value;
+    }
+  }
+
+  _variant_t(const bool value) noexcept
+  {
+    VariantInit(this);
+    vt = VT_BOOL;
+    boolVal = value ? VARIANT_TRUE : VARIANT_FALSE;
+  }
+
+  _variant_t(const wchar_t* const value)
+  {
+    VariantInit(this);
+    vt = VT_BSTR;
+    bstrVal = _bstr_t{value}.Detach();
+  }
+
+  _variant_t(const char* const value)
+  {
+    VariantInit(this);
+    vt = VT_BSTR;
+    bstrVal = _bstr_t{value}.Detach();
+  }
+
+  _variant_t(const _bstr_t& value)
+  {
+    VariantInit(this);
+    vt = VT_BSTR;
+    bstrVal = value.copy();
+  }
+
+  _variant_t(IUnknown* const value, const bool add_ref = true) noexcept
+  {
+    VariantInit(this);
+    vt = VT_UNKNOWN;
+    punkVal = value;
+    if (value && add_ref)
+      value->AddRef();
+  }
+
+  _variant_t(IDispatch* const value, const bool add_ref = true) noexcept
+  {
+    VariantInit(this);
+    vt = VT_DISPATCH;
+    pdispVal = value;
+    if (value && add_ref)
+      value->AddRef();
+  }
+
+  void Clear()
+  {
+    if (const auto err = VariantClear(this); err != S_OK)
+      _com_issue_error(err);
+  }
+
+  void Attach(VARIANT& value)
+  {
+    Clear();
+    static_cast<VARIANT&>(*this) = value;
+    VariantInit(&value);
+  }
+
+  VARIANT Detach() noexcept
+  {
+    const VARIANT result{*this};
+    VariantInit(this);
+    return result;
+  }
+
+  VARIANT& GetVARIANT() noexcept
+  {
+    return *this;
+  }
+
+  VARIANT* GetAddress()
+  {
+    Clear();
+    return this;
+  }
+
+  void ChangeType(const VARTYPE type, const _variant_t* const source = {})
+  {
+    const auto err = VariantChangeType(this, source ? source : this, 0, type);
+    if (err != S_OK)
+      _com_issue_error(err);
+  }
+
+  void swap(_variant_t& other) noexcept
+  {
+    const VARIANT tmp{*this};
+    static_cast<VARIANT&>(*this) = other;
+    static_cast<VARIANT&>(other) = tmp;
+  }
+};
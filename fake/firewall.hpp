@@ -0,0 +1,946 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "object.hpp"
+
+#include <netfw.h>
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom::fake::firewall {
+
+// -----------------------------------------------------------------------------
+// Authorized_application
+// -----------------------------------------------------------------------------
+
+/// The data of the authorized application.
+struct Application_data final {
+  std::wstring name;
+  std::wstring image_file_name;
+  NET_FW_IP_VERSION ip_version{NET_FW_IP_VERSION_ANY};
+  NET_FW_SCOPE scope{NET_FW_SCOPE_ALL};
+  std::wstring remote_addresses{L"*"};
+  bool enabled{true};
+};
+
+/// The fake of `INetFwAuthorizedApplication`.
+class Authorized_application final :
+    public Object<INetFwAuthorizedApplication> {
+public:
+  explicit Authorized_application(Application_data data = {})
+    : properties_{std::move(data)}
+  {}
+
+  HRESULT get_Name(BSTR* const result) override
+  {
+    return properties_.get("INetFwAuthorizedApplication::get_Name",
+      &Application_data::name, result);
+  }
+
+  HRESULT put_Name(const BSTR value) override
+  {
+    return properties_.put("INetFwAuthorizedApplication::put_Name",
+      &Application_data::name, value);
+  }
+
+  HRESULT get_ProcessImageFileName(BSTR* const result) override
+  {
+    return properties_.get(
+      "INetFwAuthorizedApplication::get_ProcessImageFileName",
+      &Application_data::image_file_name, result);
+  }
+
+  HRESULT put_ProcessImageFileName(const BSTR value) override
+  {
+    return properties_.put(
+      "INetFwAuthorizedApplication::put_ProcessImageFileName",
+      &Application_data::image_file_name, value);
+  }
+
+  HRESULT get_IpVersion(NET_FW_IP_VERSION* const result) override
+  {
+    return properties_.get("INetFwAuthorizedApplication::get_IpVersion",
+      &Application_data::ip_version, result);
+  }
+
+  HRESULT put_IpVersion(const NET_FW_IP_VERSION value) override
+  {
+    return properties_.put("INetFwAuthorizedApplication::put_IpVersion",
+      &Application_data::ip_version, value);
+  }
+
+  HRESULT get_Scope(NET_FW_SCOPE* const result) override
+  {
+    return properties_.get("INetFwAuthorizedApplication::get_Scope",
+      &Application_data::scope, result);
+  }
+
+  HRESULT put_Scope(const NET_FW_SCOPE value) override
+  {
+    return properties_.put("INetFwAuthorizedApplication::put_Scope",
+      &Application_data::scope, value);
+  }
+
+  HRESULT get_RemoteAddresses(BSTR* const result) override
+  {
+    return properties_.get("INetFwAuthorizedApplication::get_RemoteAddresses",
+      &Application_data::remote_addresses, result);
+  }
+
+  HRESULT put_RemoteAddresses(const BSTR value) override
+  {
+    return properties_.put("INetFwAuthorizedApplication::put_RemoteAddresses",
+      &Application_data::remote_addresses, value);
+  }
+
+  HRESULT get_Enabled(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("INetFwAuthorizedApplication::get_Enabled",
+      &Application_data::enabled, result);
+  }
+
+  HRESULT put_Enabled(const VARIANT_BOOL value) override
+  {
+    return properties_.put("INetFwAuthorizedApplication::put_Enabled",
+      &Application_data::enabled, value);
+  }
+
+  /// @returns The copy of the data.
+  Application_data data() const
+  {
+    return properties_.data();
+  }
+
+private:
+  Property_store<Application_data> properties_;
+};
+
+// -----------------------------------------------------------------------------
+// Rule
+// -----------------------------------------------------------------------------
+
+/// The data of the firewall rule.
+struct Rule_data final {
+  std::wstring name;
+  std::wstring description;
+  std::wstring application_name;
+  std::wstring service_name;
+  long protocol{NET_FW_IP_PROTOCOL_ANY};
+  std::wstring local_ports;
+  std::wstring remote_ports;
+  std::wstring local_addresses{L"*"};
+  std::wstring remote_addresses{L"*"};
+  NET_FW_RULE_DIRECTION direction{NET_FW_RULE_DIR_IN};
+  std::wstring interface_types{L"All"};
+  bool enabled{};
+  std::wstring grouping;
+  long profiles{NET_FW_PROFILE2_ALL};
+  bool edge_traversal{};
+  NET_FW_ACTION action{NET_FW_ACTION_ALLOW};
+};
+
+/// The fake of `INetFwRule`.
+class Rule final : public Object<INetFwRule> {
+public:
+  explicit Rule(Rule_data data = {})
+    : properties_{std::move(data)}
+  {}
+
+  HRESULT get_Name(BSTR* const result) override
+  {
+    return properties_.get("INetFwRule::get_Name", &Rule_data::name, result);
+  }
+
+  HRESULT put_Name(const BSTR value) override
+  {
+    return properties_.put("INetFwRule::put_Name", &Rule_data::name, value);
+  }
+
+  HRESULT get_Description(BSTR* const result) override
+  {
+    return properties_.get("INetFwRule::get_Description",
+      &Rule_data::description, result);
+  }
+
+  HRESULT put_Description(const BSTR value) override
+  {
+    return properties_.put("INetFwRule::put_Description",
+      &Rule_data::description, value);
+  }
+
+  HRESULT get_ApplicationName(BSTR* const result) override
+  {
+    return properties_.get("INetFwRule::get_ApplicationName",
+      &Rule_data::application_name, result);
+  }
+
+  HRESULT put_ApplicationName(const BSTR value) override
+  {
+    return properties_.put("INetFwRule::put_ApplicationName",
+      &Rule_data::application_name, value);
+  }
+
+  HRESULT get_ServiceName(BSTR* const result) override
+  {
+    return properties_.get("INetFwRule::get_ServiceName",
+      &Rule_data::service_name, result);
+  }
+
+  HRESULT put_ServiceName(const BSTR value) override
+  {
+    return properties_.put("INetFwRule::put_ServiceName",
+      &Rule_data::service_name, value);
+  }
+
+  HRESULT get_Protocol(LONG* const result) override
+  {
+    return properties_.get("INetFwRule::get_Protocol",
+      &Rule_data::protocol, result);
+  }
+
+  HRESULT put_Protocol(const LONG value) override
+  {
+    return properties_.put("INetFwRule::put_Protocol",
+      &Rule_data::protocol, value);
+  }
+
+  HRESULT get_LocalPorts(BSTR* const result) override
+  {
+    return properties_.get("INetFwRule::get_LocalPorts",
+      &Rule_data::local_ports, result);
+  }
+
+  HRESULT put_LocalPorts(const BSTR value) override
+  {
+    return properties_.put("INetFwRule::put_LocalPorts",
+      &Rule_data::local_ports, value);
+  }
+
+  HRESULT get_RemotePorts(BSTR* const result) override
+  {
+    return properties_.get("INetFwRule::get_RemotePorts",
+      &Rule_data::remote_ports, result);
+  }
+
+  HRESULT put_RemotePorts(const BSTR value) override
+  {
+    return properties_.put("INetFwRule::put_RemotePorts",
+      &Rule_data::remote_ports, value);
+  }
+
+  HRESULT get_LocalAddresses(BSTR* const result) override
+  {
+    return properties_.get("INetFwRule::get_LocalAddresses",
+      &Rule_data::local_addresses, result);
+  }
+
+  HRESULT put_LocalAddresses(const BSTR value) override
+  {
+    return properties_.put("INetFwRule::put_LocalAddresses",
+      &Rule_data::local_addresses, value);
+  }
+
+  HRESULT get_RemoteAddresses(BSTR* const result) override
+  {
+    return properties_.get("INetFwRule::get_RemoteAddresses",
+      &Rule_data::remote_addresses, result);
+  }
+
+  HRESULT put_RemoteAddresses(const BSTR value) override
+  {
+    return properties_.put("INetFwRule::put_RemoteAddresses",
+      &Rule_data::remote_addresses, value);
+  }
+
+  HRESULT get_Direction(NET_FW_RULE_DIRECTION* const result) override
+  {
+    return properties_.get("INetFwRule::get_Direction",
+      &Rule_data::direction, result);
+  }
+
+  HRESULT put_Direction(const NET_FW_RULE_DIRECTION value) override
+  {
+    return properties_.put("INetFwRule::put_Direction",
+      &Rule_data::direction, value);
+  }
+
+  HRESULT get_InterfaceTypes(BSTR* const result) override
+  {
+    return properties_.get("INetFwRule::get_InterfaceTypes",
+      &Rule_data::interface_types, result);
+  }
+
+  HRESULT put_InterfaceTypes(const BSTR value) override
+  {
+    return properties_.put("INetFwRule::put_InterfaceTypes",
+      &Rule_data::interface_types, value);
+  }
+
+  HRESULT get_Enabled(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("INetFwRule::get_Enabled",
+      &Rule_data::enabled, result);
+  }
+
+  HRESULT put_Enabled(const VARIANT_BOOL value) override
+  {
+    return properties_.put("INetFwRule::put_Enabled",
+      &Rule_data::enabled, value);
+  }
+
+  HRESULT get_Grouping(BSTR* const result) override
+  {
+    return properties_.get("INetFwRule::get_Grouping",
+      &Rule_data::grouping, result);
+  }
+
+  HRESULT put_Grouping(const BSTR value) override
+  {
+    return properties_.put("INetFwRule::put_Grouping",
+      &Rule_data::grouping, value);
+  }
+
+  HRESULT get_Profiles(long* const result) override
+  {
+    return properties_.get("INetFwRule::get_Profiles",
+      &Rule_data::profiles, result);
+  }
+
+  HRESULT put_Profiles(const long value) override
+  {
+    return properties_.put("INetFwRule::put_Profiles",
+      &Rule_data::profiles, value);
+  }
+
+  HRESULT get_EdgeTraversal(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("INetFwRule::get_EdgeTraversal",
+      &Rule_data::edge_traversal, result);
+  }
+
+  HRESULT put_EdgeTraversal(const VARIANT_BOOL value) override
+  {
+    return properties_.put("INetFwRule::put_EdgeTraversal",
+      &Rule_data::edge_traversal, value);
+  }
+
+  HRESULT get_Action(NET_FW_ACTION* const result) override
+  {
+    return properties_.get("INetFwRule::get_Action",
+      &Rule_data::action, result);
+  }
+
+  HRESULT put_Action(const NET_FW_ACTION value) override
+  {
+    return properties_.put("INetFwRule::put_Action",
+      &Rule_data::action, value);
+  }
+
+  /// @returns The copy of the data.
+  Rule_data data() const
+  {
+    return properties_.data();
+  }
+
+  /// @returns The result of `f(data)` called under the lock of the rule.
+  template<class F>
+  decltype(auto) with(F&& f)
+  {
+    return properties_.with(std::forward<F>(f));
+  }
+
+private:
+  Property_store<Rule_data> properties_;
+};
+
+// -----------------------------------------------------------------------------
+// Store
+// -----------------------------------------------------------------------------
+
+/// The state of the firewall of the host.
+class Store final {
+public:
+  /// The constructor.
+  Store()
+  {
+    clear();
+  }
+
+  /// Resets the state to the defaults (no rules, all profiles enabled).
+  void clear()
+  {
+    std::vector<Ref<Rule>> rules;
+    std::array<std::vector<Ref<Authorized_application>>, 2> applications;
+    const std::lock_guard lg{mutex_};
+    rules.swap(rules_);
+    applications.swap(applications_);
+    current_profile_types_ = NET_FW_PROFILE2_PRIVATE;
+    enabled_profile_types_ = NET_FW_PROFILE2_DOMAIN | NET_FW_PROFILE2_PRIVATE
+      | NET_FW_PROFILE2_PUBLIC;
+    modify_state_ = NET_FW_MODIFY_STATE_OK;
+  }
+
+  /// @returns The snapshot of the rules.
+  std::vector<Ref<Rule>> rules() const
+  {
+    const std::lock_guard lg{mutex_};
+    return rules_;
+  }
+
+  /// Appends the `rule`. (Duplicate names are allowed as by Windows.)
+  void add(Ref<Rule> rule)
+  {
+    const std::lock_guard lg{mutex_};
+    rules_.push_back(std::move(rule));
+  }
+
+  /// Removes the first rule named `name`.
+  void remove_rule(const std::wstring_view name)
+  {
+    Ref<Rule> removed;
+    const std::lock_guard lg{mutex_};
+    const auto i = find_rule(rules_, name);
+    if (i != rules_.end()) {
+      removed = std::move(*i);
+      rules_.erase(i);
+    }
+  }
+
+  /// @returns The first rule named `name`, or null reference.
+  Ref<Rule> rule(const std::wstring_view name) const
+  {
+    const std::lock_guard lg{mutex_};
+    const auto i = find_rule(rules_, name);
+    return i != rules_.end() ? *i : Ref<Rule>{};
+  }
+
+  /// @returns The snapshot of the applications authorized in `profile`.
+  std::vector<Ref<Authorized_application>>
+  applications(const NET_FW_PROFILE_TYPE profile) const
+  {
+    const std::lock_guard lg{mutex_};
+    return applications_[index(profile)];
+  }
+
+  /// Authorizes the `application` in `profile` replacing the one with the
+  /// same image file name.
+  void add(const NET_FW_PROFILE_TYPE profile,
+    Ref<Authorized_application> application)
+  {
+    const auto image_file_name = application->data().image_file_name;
+    Ref<Authorized_application> replaced;
+    const std::lock_guard lg{mutex_};
+    auto& apps = applications_[index(profile)];
+    const auto i = find_application(apps, image_file_name);
+    if (i != apps.end())
+      replaced = std::exchange(*i, std::move(application));
+    else
+      apps.push_back(std::move(application));
+  }
+
+  /// Removes the application `image_file_name` from `profile`.
+  void remove_application(const NET_FW_PROFILE_TYPE profile,
+    const std::wstring_view image_file_name)
+  {
+    Ref<Authorized_application> removed;
+    const std::lock_guard lg{mutex_};
+    auto& apps = applications_[index(profile)];
+    const auto i = find_application(apps, image_file_name);
+    if (i != apps.end()) {
+      removed = std::move(*i);
+      apps.erase(i);
+    }
+  }
+
+  /// @returns The application `image_file_name` of `profile`, or null.
+  Ref<Authorized_application>
+  application(const NET_FW_PROFILE_TYPE profile,
+    const std::wstring_view image_file_name) const
+  {
+    const std::lock_guard lg{mutex_};
+    const auto& apps = applications_[index(profile)];
+    const auto i = find_application(apps, image_file_name);
+    return i != apps.end() ? *i : Ref<Authorized_application>{};
+  }
+
+  /// @returns The bitmask of `NET_FW_PROFILE_TYPE2` of the active profiles.
+  long current_profile_types() const
+  {
+    const std::lock_guard lg{mutex_};
+    return current_profile_types_;
+  }
+
+  /// Sets the bitmask of `NET_FW_PROFILE_TYPE2` of the active profiles.
+  void set_current_profile_types(const long value)
+  {
+    const std::lock_guard lg{mutex_};
+    current_profile_types_ = value;
+  }
+
+  /// @returns The legacy type of the current profile.
+  NET_FW_PROFILE_TYPE current_profile_type() const
+  {
+    return current_profile_types() & NET_FW_PROFILE2_DOMAIN ?
+      NET_FW_PROFILE_DOMAIN : NET_FW_PROFILE_STANDARD;
+  }
+
+  /// @returns `true` if the firewall is enabled for all of `profiles`.
+  bool is_enabled(const long profiles) const
+  {
+    const std::lock_guard lg{mutex_};
+    return (enabled_profile_types_ & profiles) == profiles;
+  }
+
+  /// Toggles the firewall for `profiles`.
+  void set_enabled(const long profiles, const bool value)
+  {
+    const std::lock_guard lg{mutex_};
+    if (value)
+      enabled_profile_types_ |= profiles;
+    else
+      enabled_profile_types_ &= ~profiles;
+  }
+
+  /// @returns The state of modifications of the local policy.
+  NET_FW_MODIFY_STATE modify_state() const
+  {
+    const std::lock_guard lg{mutex_};
+    return modify_state_;
+  }
+
+  /// Sets the state of modifications of the local policy.
+  void set_modify_state(const NET_FW_MODIFY_STATE value)
+  {
+    const std::lock_guard lg{mutex_};
+    modify_state_ = value;
+  }
+
+  /// @returns The `NET_FW_PROFILE_TYPE2` of the legacy `profile`.
+  static long profile_types(const NET_FW_PROFILE_TYPE profile) noexcept
+  {
+    return profile == NET_FW_PROFILE_DOMAIN ?
+      NET_FW_PROFILE2_DOMAIN : NET_FW_PROFILE2_PRIVATE;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::vector<Ref<Rule>> rules_;
+  std::array<std::vector<Ref<Authorized_application>>, 2> applications_;
+  long current_profile_types_{};
+  long enabled_profile_types_{};
+  NET_FW_MODIFY_STATE modify_state_{};
+
+  static std::size_t index(const NET_FW_PROFILE_TYPE profile) noexcept
+  {
+    return profile == NET_FW_PROFILE_DOMAIN ? 0 : 1;
+  }
+
+  template<class Rules>
+  static auto find_rule(Rules& rules, const std::wstring_view name)
+    -> decltype(rules.begin())
+  {
+    return std::find_if(rules.begin(), rules.end(),
+      [name](const auto& rule)
+      {
+        return rule->with([name](const Rule_data& data)
+        {
+          return detail::iequals(data.name, name);
+        });
+      });
+  }
+
+  template<class Apps>
+  static auto find_application(Apps& apps,
+    const std::wstring_view image_file_name) -> decltype(apps.begin())
+  {
+    return std::find_if(apps.begin(), apps.end(),
+      [image_file_name](const auto& app)
+      {
+        return detail::iequals(app->data().image_file_name, image_file_name);
+      });
+  }
+};
+
+/// @returns The state of the fake firewall.
+inline Store& store()
+{
+  static Store result;
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Legacy API
+// -----------------------------------------------------------------------------
+
+/// The fake of `INetFwAuthorizedApplications` of a profile.
+class Authorized_applications final :
+    public Object<INetFwAuthorizedApplications> {
+public:
+  explicit Authorized_applications(const NET_FW_PROFILE_TYPE profile) noexcept
+    : profile_{profile}
+  {}
+
+  HRESULT get_Count(long* const result) override
+  {
+    if (const auto err = enter("INetFwAuthorizedApplications::get_Count");
+        err != S_OK)
+      return err;
+    return get(store().applications(profile_).size(), result);
+  }
+
+  HRESULT Add(INetFwAuthorizedApplication* const app) override
+  {
+    if (!app)
+      return E_POINTER;
+    if (const auto err = enter("INetFwAuthorizedApplications::Add");
+        err != S_OK)
+      return err;
+    auto* const fake = dynamic_cast<Authorized_application*>(app);
+    if (!fake)
+      return E_INVALIDARG;
+    fake->AddRef();
+    store().add(profile_, Ref<Authorized_application>{fake});
+    return S_OK;
+  }
+
+  HRESULT Remove(const BSTR image_file_name) override
+  {
+    if (!image_file_name)
+      return E_INVALIDARG;
+    if (const auto err = enter("INetFwAuthorizedApplications::Remove");
+        err != S_OK)
+      return err;
+    store().remove_application(profile_,
+      {image_file_name, SysStringLen(image_file_name)});
+    return S_OK;
+  }
+
+  HRESULT Item(const BSTR image_file_name,
+    INetFwAuthorizedApplication** const result) override
+  {
+    if (!image_file_name || !result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("INetFwAuthorizedApplications::Item");
+        err != S_OK)
+      return err;
+    const auto app = store().application(profile_,
+      {image_file_name, SysStringLen(image_file_name)});
+    return app ? get(app, result) : HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+  }
+
+  HRESULT get__NewEnum(IUnknown** const result) override
+  {
+    if (const auto err = enter("INetFwAuthorizedApplications::get__NewEnum");
+        err != S_OK)
+      return err;
+    return new_enum(store().applications(profile_), result);
+  }
+
+private:
+  NET_FW_PROFILE_TYPE profile_{};
+};
+
+/// The fake of `INetFwProfile`.
+class Profile final : public Object<INetFwProfile> {
+public:
+  explicit Profile(const NET_FW_PROFILE_TYPE type) noexcept
+    : type_{type}
+  {}
+
+  HRESULT get_Type(NET_FW_PROFILE_TYPE* const result) override
+  {
+    return get(type_, result);
+  }
+
+  HRESULT get_FirewallEnabled(VARIANT_BOOL* const result) override
+  {
+    if (const auto err = enter("INetFwProfile::get_FirewallEnabled");
+        err != S_OK)
+      return err;
+    return get(store().is_enabled(Store::profile_types(type_)), result);
+  }
+
+  HRESULT put_FirewallEnabled(const VARIANT_BOOL value) override
+  {
+    if (const auto err = enter("INetFwProfile::put_FirewallEnabled");
+        err != S_OK)
+      return err;
+    store().set_enabled(Store::profile_types(type_), value != VARIANT_FALSE);
+    return S_OK;
+  }
+
+  HRESULT get_AuthorizedApplications(
+    INetFwAuthorizedApplications** const result) override
+  {
+    if (const auto err = enter("INetFwProfile::get_AuthorizedApplications");
+        err != S_OK)
+      return err;
+    return get(make<Authorized_applications>(type_), result);
+  }
+
+private:
+  NET_FW_PROFILE_TYPE type_{};
+};
+
+/// The fake of `INetFwPolicy`.
+class Policy final : public Object<INetFwPolicy> {
+public:
+  HRESULT get_CurrentProfile(INetFwProfile** const result) override
+  {
+    return GetProfileByType(NET_FW_PROFILE_CURRENT, result);
+  }
+
+  HRESULT GetProfileByType(NET_FW_PROFILE_TYPE type,
+    INetFwProfile** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("INetFwPolicy::GetProfileByType"); err != S_OK)
+      return err;
+    if (type == NET_FW_PROFILE_CURRENT)
+      type = store().current_profile_type();
+    else if (type != NET_FW_PROFILE_DOMAIN && type != NET_FW_PROFILE_STANDARD)
+      return E_INVALIDARG;
+    return get(make<Profile>(type), result);
+  }
+};
+
+/// The fake of `INetFwMgr` (the class `NetFwMgr`).
+class Manager final : public Object<INetFwMgr> {
+public:
+  HRESULT get_LocalPolicy(INetFwPolicy** const result) override
+  {
+    if (const auto err = enter("INetFwMgr::get_LocalPolicy"); err != S_OK)
+      return err;
+    return get(make<Policy>(), result);
+  }
+
+  HRESULT get_CurrentProfileType(NET_FW_PROFILE_TYPE* const result) override
+  {
+    if (const auto err = enter("INetFwMgr::get_CurrentProfileType");
+        err != S_OK)
+      return err;
+    return get(store().current_profile_type(), result);
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Advanced Security API
+// -----------------------------------------------------------------------------
+
+/// The fake of `INetFwRules`.
+class Rules final : public Object<INetFwRules> {
+public:
+  HRESULT get_Count(long* const result) override
+  {
+    if (const auto err = enter("INetFwRules::get_Count"); err != S_OK)
+      return err;
+    return get(store().rules().size(), result);
+  }
+
+  HRESULT Add(INetFwRule* const rule) override
+  {
+    if (!rule)
+      return E_POINTER;
+    if (const auto err = enter("INetFwRules::Add"); err != S_OK)
+      return err;
+    auto* const fake = dynamic_cast<Rule*>(rule);
+    if (!fake)
+      return E_INVALIDARG;
+    fake->AddRef();
+    store().add(Ref<Rule>{fake});
+    return S_OK;
+  }
+
+  HRESULT Remove(const BSTR name) override
+  {
+    if (!name)
+      return E_INVALIDARG;
+    if (const auto err = enter("INetFwRules::Remove"); err != S_OK)
+      return err;
+    store().remove_rule({name, SysStringLen(name)});
+    return S_OK;
+  }
+
+  HRESULT Item(const BSTR name, INetFwRule** const result) override
+  {
+    if (!name || !result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("INetFwRules::Item"); err != S_OK)
+      return err;
+    const auto rule = store().rule({name, SysStringLen(name)});
+    return rule ? get(rule, result) : HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+  }
+
+  HRESULT get__NewEnum(IUnknown** const result) override
+  {
+    if (const auto err = enter("INetFwRules::get__NewEnum"); err != S_OK)
+      return err;
+    return new_enum(store().rules(), result);
+  }
+};
+
+/// The fake of `INetFwPolicy2` (the class `NetFwPolicy2`).
+class Policy2 final : public Object<INetFwPolicy2> {
+public:
+  HRESULT get_CurrentProfileTypes(long* const result) override
+  {
+    if (const auto err = enter("INetFwPolicy2::get_CurrentProfileTypes");
+        err != S_OK)
+      return err;
+    return get(store().current_profile_types(), result);
+  }
+
+  HRESULT get_FirewallEnabled(const NET_FW_PROFILE_TYPE2 profile,
+    VARIANT_BOOL* const result) override
+  {
+    if (const auto err = enter("INetFwPolicy2::get_FirewallEnabled");
+        err != S_OK)
+      return err;
+    return get(store().is_enabled(profile), result);
+  }
+
+  HRESULT put_FirewallEnabled(const NET_FW_PROFILE_TYPE2 profile,
+    const VARIANT_BOOL value) override
+  {
+    if (const auto err = enter("INetFwPolicy2::put_FirewallEnabled");
+        err != S_OK)
+      return err;
+    store().set_enabled(profile, value != VARIANT_FALSE);
+    return S_OK;
+  }
+
+  HRESULT get_Rules(INetFwRules** const result) override
+  {
+    if (const auto err = enter("INetFwPolicy2::get_Rules"); err != S_OK)
+      return err;
+    return get(make<Rules>(), result);
+  }
+
+  /// Toggles the rules of `group` which apply to any of `profiles`.
+  HRESULT EnableRuleGroup(const long profiles, const BSTR group,
+    const VARIANT_BOOL value) override
+  {
+    if (!group)
+      return E_INVALIDARG;
+    if (const auto err = enter("INetFwPolicy2::EnableRuleGroup"); err != S_OK)
+      return err;
+    for (const auto& rule : store().rules()) {
+      rule->with([&](Rule_data& data)
+      {
+        if (is_matched(data, profiles, group))
+          data.enabled = value != VARIANT_FALSE;
+      });
+    }
+    return S_OK;
+  }
+
+  /// Checks that all the rules of `group` which apply to any of `profiles`
+  /// are enabled.
+  HRESULT IsRuleGroupEnabled(const long profiles, const BSTR group,
+    VARIANT_BOOL* const result) override
+  {
+    if (!group || !result)
+      return E_POINTER;
+    if (const auto err = enter("INetFwPolicy2::IsRuleGroupEnabled");
+        err != S_OK)
+      return err;
+    return get(is_group_enabled(profiles, group), result);
+  }
+
+  HRESULT get_LocalPolicyModifyState(
+    NET_FW_MODIFY_STATE* const result) override
+  {
+    if (const auto err = enter("INetFwPolicy2::get_LocalPolicyModifyState");
+        err != S_OK)
+      return err;
+    return get(store().modify_state(), result);
+  }
+
+  HRESULT get_IsRuleGroupCurrentlyEnabled(const BSTR group,
+    VARIANT_BOOL* const result) override
+  {
+    if (!group || !result)
+      return E_POINTER;
+    if (const auto err = enter(
+        "INetFwPolicy2::get_IsRuleGroupCurrentlyEnabled"); err != S_OK)
+      return err;
+    return get(is_group_enabled(store().current_profile_types(), group),
+      result);
+  }
+
+private:
+  static bool is_matched(const Rule_data& data, const long profiles,
+    const BSTR group)
+  {
+    return (data.profiles & profiles)
+      && detail::iequals(data.grouping, {group, SysStringLen(group)});
+  }
+
+  static bool is_group_enabled(const long profiles, const BSTR group)
+  {
+    bool result{};
+    for (const auto& rule : store().rules()) {
+      const auto data = rule->data();
+      if (is_matched(data, profiles, group)) {
+        if (!data.enabled)
+          return false;
+        result = true;
+      }
+    }
+    return result;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Registration
+// -----------------------------------------------------------------------------
+
+/// Registers the classes of the fake firewall.
+inline void register_classes()
+{
+  register_class(__uuidof(NetFwAuthorizedApplication),
+    [](REFIID id, void** const result)
+    {
+      return make<Authorized_application>()->QueryInterface(id, result);
+    });
+  register_class(__uuidof(NetFwMgr), [](REFIID id, void** const result)
+  {
+    return make<Manager>()->QueryInterface(id, result);
+  });
+  register_class(__uuidof(NetFwRule), [](REFIID id, void** const result)
+  {
+    return make<Rule>()->QueryInterface(id, result);
+  });
+  register_class(__uuidof(NetFwPolicy2), [](REFIID id, void** const result)
+  {
+    return make<Policy2>()->QueryInterface(id, result);
+  });
+}
+
+} // namespace dmitigr::wincom::fake::firewall
@@ -0,0 +1,182 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+ * The stand-in of the SDK header of the same name: the subset of the Remote
+ * Desktop Sharing interfaces used by the wrappers (see ../rdp.hpp).
+ */
+
+#include "../runtime.hpp"
+
+// -----------------------------------------------------------------------------
+// Enumerations
+// -----------------------------------------------------------------------------
+
+enum CTRL_LEVEL {
+  CTRL_LEVEL_MIN = 0,
+  CTRL_LEVEL_INVALID = 0,
+  CTRL_LEVEL_NONE = 1,
+  CTRL_LEVEL_VIEW = 2,
+  CTRL_LEVEL_INTERACTIVE = 3,
+  CTRL_LEVEL_REQCTRL_VIEW = 4,
+  CTRL_LEVEL_REQCTRL_INTERACTIVE = 5,
+  CTRL_LEVEL_MAX = 5
+};
+
+enum ATTENDEE_DISCONNECT_REASON {
+  ATTENDEE_DISCONNECT_REASON_MIN = 0,
+  ATTENDEE_DISCONNECT_REASON_APP = 0,
+  ATTENDEE_DISCONNECT_REASON_SRV = 1,
+  ATTENDEE_DISCONNECT_REASON_CLI = 2,
+  ATTENDEE_DISCONNECT_REASON_MAX = 2
+};
+
+// -----------------------------------------------------------------------------
+// Event identifiers of _IRDPSessionEvents
+// -----------------------------------------------------------------------------
+
+inline constexpr DISPID DISPID_RDPSRAPI_EVENT_ON_ATTENDEE_CONNECTED{301};
+inline constexpr DISPID DISPID_RDPSRAPI_EVENT_ON_ATTENDEE_DISCONNECTED{302};
+inline constexpr DISPID DISPID_RDPSRAPI_EVENT_ON_ATTENDEE_UPDATE{303};
+inline constexpr DISPID DISPID_RDPSRAPI_EVENT_ON_ERROR{304};
+inline constexpr DISPID DISPID_RDPSRAPI_EVENT_ON_VIEWER_CONNECTED{305};
+inline constexpr DISPID DISPID_RDPSRAPI_EVENT_ON_VIEWER_DISCONNECTED{306};
+inline constexpr DISPID DISPID_RDPSRAPI_EVENT_ON_VIEWER_AUTHENTICATED{307};
+inline constexpr DISPID DISPID_RDPSRAPI_EVENT_ON_VIEWER_CONNECTFAILED{308};
+inline constexpr DISPID DISPID_RDPSRAPI_EVENT_ON_CTRLLEVEL_CHANGE_REQUEST{309};
+inline constexpr DISPID DISPID_RDPSRAPI_EVENT_ON_GRAPHICS_STREAM_PAUSED{310};
+inline constexpr DISPID DISPID_RDPSRAPI_EVENT_ON_GRAPHICS_STREAM_RESUMED{311};
+
+// -----------------------------------------------------------------------------
+// Interfaces
+// -----------------------------------------------------------------------------
+
+struct IRDPSRAPIInvitation : IDispatch {
+  virtual HRESULT get_ConnectionString(BSTR* result) = 0;
+  virtual HRESULT get_GroupName(BSTR* result) = 0;
+  virtual HRESULT get_Password(BSTR* result) = 0;
+  virtual HRESULT get_AttendeeLimit(long* result) = 0;
+  virtual HRESULT put_AttendeeLimit(long value) = 0;
+  virtual HRESULT get_Revoked(VARIANT_BOOL* result) = 0;
+  virtual HRESULT put_Revoked(VARIANT_BOOL value) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRDPSRAPIInvitation, IDispatch);
+
+struct IRDPSRAPIInvitationManager : IDispatch {
+  virtual HRESULT get__NewEnum(IUnknown** result) = 0;
+  virtual HRESULT get_Item(VARIANT item, IRDPSRAPIInvitation** result) = 0;
+  virtual HRESULT get_Count(long* result) = 0;
+  virtual HRESULT CreateInvitation(BSTR auth_string, BSTR group_name,
+    BSTR password, long attendee_limit, IRDPSRAPIInvitation** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRDPSRAPIInvitationManager, IDispatch);
+
+struct IRDPSRAPITcpConnectionInfo : IDispatch {
+  virtual HRESULT get_Protocol(long* result) = 0;
+  virtual HRESULT get_LocalPort(long* result) = 0;
+  virtual HRESULT get_LocalIP(BSTR* result) = 0;
+  virtual HRESULT get_PeerPort(long* result) = 0;
+  virtual HRESULT get_PeerIP(BSTR* result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRDPSRAPITcpConnectionInfo, IDispatch);
+
+struct IRDPSRAPIAttendee : IDispatch {
+  virtual HRESULT get_Id(long* result) = 0;
+  virtual HRESULT get_RemoteName(BSTR* result) = 0;
+  virtual HRESULT get_ControlLevel(CTRL_LEVEL* result) = 0;
+  virtual HRESULT put_ControlLevel(CTRL_LEVEL value) = 0;
+  virtual HRESULT get_Invitation(IRDPSRAPIInvitation** result) = 0;
+  virtual HRESULT TerminateConnection() = 0;
+  virtual HRESULT get_Flags(long* result) = 0;
+  virtual HRESULT get_ConnectivityInfo(IUnknown** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRDPSRAPIAttendee, IDispatch);
+
+struct IRDPSRAPIAttendeeManager : IDispatch {
+  virtual HRESULT get__NewEnum(IUnknown** result) = 0;
+  virtual HRESULT get_Item(long id, IRDPSRAPIAttendee** result) = 0;
+  virtual HRESULT get_Count(long* result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRDPSRAPIAttendeeManager, IDispatch);
+
+struct IRDPSRAPIAttendeeDisconnectInfo : IDispatch {
+  virtual HRESULT get_Attendee(IRDPSRAPIAttendee** result) = 0;
+  virtual HRESULT get_Reason(ATTENDEE_DISCONNECT_REASON* result) = 0;
+  virtual HRESULT get_Code(long* result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRDPSRAPIAttendeeDisconnectInfo, IDispatch);
+
+struct IRDPSRAPISessionProperties : IDispatch {
+  virtual HRESULT get_Property(BSTR name, VARIANT* result) = 0;
+  virtual HRESULT put_Property(BSTR name, VARIANT value) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRDPSRAPISessionProperties, IDispatch);
+
+struct IRDPSRAPIClipboardUseEvents : IUnknown {
+  virtual HRESULT OnPasteFromClipboard(UINT clipboard_format,
+    IDispatch* attendee, VARIANT_BOOL* result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRDPSRAPIClipboardUseEvents, IUnknown);
+
+struct IRDPSRAPISharingSession : IDispatch {
+  virtual HRESULT Open() = 0;
+  virtual HRESULT Close() = 0;
+  virtual HRESULT put_ColorDepth(long value) = 0;
+  virtual HRESULT get_ColorDepth(long* result) = 0;
+  virtual HRESULT get_Properties(IRDPSRAPISessionProperties** result) = 0;
+  virtual HRESULT get_Attendees(IRDPSRAPIAttendeeManager** result) = 0;
+  virtual HRESULT get_Invitations(IRDPSRAPIInvitationManager** result) = 0;
+  virtual HRESULT Pause() = 0;
+  virtual HRESULT Resume() = 0;
+  virtual HRESULT ConnectToClient(BSTR connection_string) = 0;
+  virtual HRESULT SetDesktopSharedRect(long left, long top, long right,
+    long bottom) = 0;
+  virtual HRESULT GetDesktopSharedRect(long* left, long* top, long* right,
+    long* bottom) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRDPSRAPISharingSession, IDispatch);
+
+struct IRDPSRAPIViewer : IDispatch {
+  virtual HRESULT Connect(BSTR connection_string, BSTR name,
+    BSTR password) = 0;
+  virtual HRESULT Disconnect() = 0;
+  virtual HRESULT get_Attendees(IRDPSRAPIAttendeeManager** result) = 0;
+  virtual HRESULT get_Invitations(IRDPSRAPIInvitationManager** result) = 0;
+  virtual HRESULT put_SmartSizing(VARIANT_BOOL value) = 0;
+  virtual HRESULT get_SmartSizing(VARIANT_BOOL* result) = 0;
+  virtual HRESULT RequestControl(CTRL_LEVEL level) = 0;
+  virtual HRESULT put_DisconnectedText(BSTR value) = 0;
+  virtual HRESULT get_DisconnectedText(BSTR* result) = 0;
+  virtual HRESULT RequestColorDepthChange(long bpp) = 0;
+  virtual HRESULT get_Properties(IRDPSRAPISessionProperties** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRDPSRAPIViewer, IDispatch);
+
+/// The dispatch interface of the events of both the session and the viewer.
+struct _IRDPSessionEvents : IDispatch {};
+DMITIGR_WINCOM_FAKE_INTERFACE(_IRDPSessionEvents, IDispatch);
+
+// -----------------------------------------------------------------------------
+// Classes
+// -----------------------------------------------------------------------------
+
+class RDPViewer;
+DMITIGR_WINCOM_FAKE_UUID(RDPViewer);
+
+class RDPSession;
+DMITIGR_WINCOM_FAKE_UUID(RDPSession);
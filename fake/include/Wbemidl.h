@@ -0,0 +1,141 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+ * The stand-in of the SDK header of the same name: the subset of the WMI
+ * client interfaces used by the wrappers (see ../wmi.hpp).
+ */
+
+#include "../runtime.hpp"
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+using CIMTYPE = long;
+
+enum CIMTYPE_ENUMERATION {
+  CIM_ILLEGAL = 0xFFF,
+  CIM_EMPTY = 0,
+  CIM_SINT8 = 16,
+  CIM_UINT8 = 17,
+  CIM_SINT16 = 2,
+  CIM_UINT16 = 18,
+  CIM_SINT32 = 3,
+  CIM_UINT32 = 19,
+  CIM_SINT64 = 20,
+  CIM_UINT64 = 21,
+  CIM_REAL32 = 4,
+  CIM_REAL64 = 5,
+  CIM_BOOLEAN = 11,
+  CIM_STRING = 8,
+  CIM_DATETIME = 101,
+  CIM_REFERENCE = 102,
+  CIM_CHAR16 = 103,
+  CIM_OBJECT = 13,
+  CIM_FLAG_ARRAY = 0x2000
+};
+
+enum WBEM_GENERIC_FLAG_TYPE {
+  WBEM_FLAG_RETURN_WBEM_COMPLETE = 0,
+  WBEM_FLAG_BIDIRECTIONAL = 0,
+  WBEM_FLAG_RETURN_IMMEDIATELY = 0x10,
+  WBEM_FLAG_FORWARD_ONLY = 0x20,
+  WBEM_FLAG_NO_ERROR_OBJECT = 0x40,
+  WBEM_FLAG_SEND_STATUS = 0x80
+};
+
+enum WBEM_CONNECT_OPTIONS {
+  WBEM_FLAG_CONNECT_REPOSITORY_ONLY = 0x40,
+  WBEM_FLAG_CONNECT_USE_MAX_WAIT = 0x80
+};
+
+enum WBEM_TIMEOUT_TYPE {
+  WBEM_NO_WAIT = 0,
+  WBEM_INFINITE = -1
+};
+
+DMITIGR_WINCOM_FAKE_HRESULT(WBEM_S_NO_ERROR, 0);
+DMITIGR_WINCOM_FAKE_HRESULT(WBEM_S_FALSE, 1);
+DMITIGR_WINCOM_FAKE_HRESULT(WBEM_S_TIMEDOUT, 0x40004);
+DMITIGR_WINCOM_FAKE_HRESULT(WBEM_S_NO_MORE_DATA, 0x40005);
+DMITIGR_WINCOM_FAKE_HRESULT(WBEM_E_FAILED, 0x80041001);
+DMITIGR_WINCOM_FAKE_HRESULT(WBEM_E_NOT_FOUND, 0x80041002);
+DMITIGR_WINCOM_FAKE_HRESULT(WBEM_E_ACCESS_DENIED, 0x80041003);
+DMITIGR_WINCOM_FAKE_HRESULT(WBEM_E_INVALID_PARAMETER, 0x80041008);
+DMITIGR_WINCOM_FAKE_HRESULT(WBEM_E_INVALID_NAMESPACE, 0x8004100E);
+DMITIGR_WINCOM_FAKE_HRESULT(WBEM_E_INVALID_CLASS, 0x80041010);
+DMITIGR_WINCOM_FAKE_HRESULT(WBEM_E_TRANSPORT_FAILURE, 0x80041015);
+DMITIGR_WINCOM_FAKE_HRESULT(WBEM_E_INVALID_QUERY, 0x80041017);
+DMITIGR_WINCOM_FAKE_HRESULT(WBEM_E_INVALID_QUERY_TYPE, 0x80041018);
+DMITIGR_WINCOM_FAKE_HRESULT(WBEM_E_INVALID_OBJECT_PATH, 0x8004103A);
+
+// -----------------------------------------------------------------------------
+// Interfaces
+// -----------------------------------------------------------------------------
+
+struct IWbemContext : IUnknown {};
+DMITIGR_WINCOM_FAKE_INTERFACE(IWbemContext, IUnknown);
+
+struct IWbemCallResult : IUnknown {};
+DMITIGR_WINCOM_FAKE_INTERFACE(IWbemCallResult, IUnknown);
+
+struct IWbemClassObject : IUnknown {
+  virtual HRESULT Get(LPCWSTR name, long flags, VARIANT* value,
+    CIMTYPE* type, long* flavor) = 0;
+  virtual HRESULT Put(LPCWSTR name, long flags, VARIANT* value,
+    CIMTYPE type) = 0;
+  virtual HRESULT BeginEnumeration(long flags) = 0;
+  virtual HRESULT Next(long flags, BSTR* name, VARIANT* value,
+    CIMTYPE* type, long* flavor) = 0;
+  virtual HRESULT EndEnumeration() = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IWbemClassObject, IUnknown);
+
+struct IEnumWbemClassObject : IUnknown {
+  virtual HRESULT Reset() = 0;
+  virtual HRESULT Next(long timeout, ULONG count, IWbemClassObject** objects,
+    ULONG* returned) = 0;
+  virtual HRESULT Skip(long timeout, ULONG count) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IEnumWbemClassObject, IUnknown);
+
+struct IWbemServices : IUnknown {
+  virtual HRESULT GetObject(const BSTR path, long flags, IWbemContext* ctx,
+    IWbemClassObject** object, IWbemCallResult** call_result) = 0;
+  virtual HRESULT ExecQuery(const BSTR language, const BSTR query,
+    long flags, IWbemContext* ctx, IEnumWbemClassObject** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IWbemServices, IUnknown);
+
+struct IWbemLocator : IUnknown {
+  virtual HRESULT ConnectServer(const BSTR network_resource, const BSTR user,
+    const BSTR password, const BSTR locale, long security_flags,
+    const BSTR authority, IWbemContext* ctx, IWbemServices** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IWbemLocator, IUnknown);
+
+// -----------------------------------------------------------------------------
+// Classes
+// -----------------------------------------------------------------------------
+
+class WbemLocator;
+DMITIGR_WINCOM_FAKE_UUID(WbemLocator);
+
+inline constexpr CLSID CLSID_WbemLocator{__uuidof(WbemLocator)};
+inline constexpr IID IID_IWbemLocator{__uuidof(IWbemLocator)};
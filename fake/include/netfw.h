@@ -0,0 +1,219 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+ * The stand-in of the SDK header of the same name: the subset of the Windows
+ * Firewall interfaces used by the wrappers (see ../firewall.hpp).
+ */
+
+#include "../runtime.hpp"
+
+// -----------------------------------------------------------------------------
+// Enumerations
+// -----------------------------------------------------------------------------
+
+enum NET_FW_ACTION {
+  NET_FW_ACTION_BLOCK = 0,
+  NET_FW_ACTION_ALLOW = 1,
+  NET_FW_ACTION_MAX = 2
+};
+
+enum NET_FW_IP_PROTOCOL {
+  NET_FW_IP_PROTOCOL_TCP = 6,
+  NET_FW_IP_PROTOCOL_UDP = 17,
+  NET_FW_IP_PROTOCOL_ANY = 256
+};
+
+enum NET_FW_IP_VERSION {
+  NET_FW_IP_VERSION_V4 = 0,
+  NET_FW_IP_VERSION_V6 = 1,
+  NET_FW_IP_VERSION_ANY = 2,
+  NET_FW_IP_VERSION_MAX = 3
+};
+
+enum NET_FW_MODIFY_STATE {
+  NET_FW_MODIFY_STATE_OK = 0,
+  NET_FW_MODIFY_STATE_GP_OVERRIDE = 1,
+  NET_FW_MODIFY_STATE_INBOUND_BLOCKED = 2
+};
+
+enum NET_FW_PROFILE_TYPE {
+  NET_FW_PROFILE_DOMAIN = 0,
+  NET_FW_PROFILE_STANDARD = 1,
+  NET_FW_PROFILE_CURRENT = 2,
+  NET_FW_PROFILE_TYPE_MAX = 3
+};
+
+enum NET_FW_PROFILE_TYPE2 {
+  NET_FW_PROFILE2_DOMAIN = 0x1,
+  NET_FW_PROFILE2_PRIVATE = 0x2,
+  NET_FW_PROFILE2_PUBLIC = 0x4,
+  NET_FW_PROFILE2_ALL = 0x7FFFFFFF
+};
+
+enum NET_FW_RULE_DIRECTION {
+  NET_FW_RULE_DIR_IN = 1,
+  NET_FW_RULE_DIR_OUT = 2,
+  NET_FW_RULE_DIR_MAX = 3
+};
+
+enum NET_FW_SCOPE {
+  NET_FW_SCOPE_ALL = 0,
+  NET_FW_SCOPE_LOCAL_SUBNET = 1,
+  NET_FW_SCOPE_CUSTOM = 2,
+  NET_FW_SCOPE_MAX = 3
+};
+
+enum NET_FW_SERVICE_TYPE {
+  NET_FW_SERVICE_FILE_AND_PRINT = 0,
+  NET_FW_SERVICE_UPNP = 1,
+  NET_FW_SERVICE_REMOTE_DESKTOP = 2,
+  NET_FW_SERVICE_NONE = 3,
+  NET_FW_SERVICE_TYPE_MAX = 4
+};
+
+// -----------------------------------------------------------------------------
+// Interfaces
+// -----------------------------------------------------------------------------
+
+struct INetFwAuthorizedApplication : IDispatch {
+  virtual HRESULT get_Name(BSTR* name) = 0;
+  virtual HRESULT put_Name(BSTR name) = 0;
+  virtual HRESULT get_ProcessImageFileName(BSTR* image_file_name) = 0;
+  virtual HRESULT put_ProcessImageFileName(BSTR image_file_name) = 0;
+  virtual HRESULT get_IpVersion(NET_FW_IP_VERSION* ip_version) = 0;
+  virtual HRESULT put_IpVersion(NET_FW_IP_VERSION ip_version) = 0;
+  virtual HRESULT get_Scope(NET_FW_SCOPE* scope) = 0;
+  virtual HRESULT put_Scope(NET_FW_SCOPE scope) = 0;
+  virtual HRESULT get_RemoteAddresses(BSTR* addresses) = 0;
+  virtual HRESULT put_RemoteAddresses(BSTR addresses) = 0;
+  virtual HRESULT get_Enabled(VARIANT_BOOL* enabled) = 0;
+  virtual HRESULT put_Enabled(VARIANT_BOOL enabled) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(INetFwAuthorizedApplication, IDispatch);
+
+struct INetFwAuthorizedApplications : IDispatch {
+  virtual HRESULT get_Count(long* count) = 0;
+  virtual HRESULT Add(INetFwAuthorizedApplication* app) = 0;
+  virtual HRESULT Remove(BSTR image_file_name) = 0;
+  virtual HRESULT Item(BSTR image_file_name,
+    INetFwAuthorizedApplication** app) = 0;
+  virtual HRESULT get__NewEnum(IUnknown** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(INetFwAuthorizedApplications, IDispatch);
+
+struct INetFwProfile : IDispatch {
+  virtual HRESULT get_Type(NET_FW_PROFILE_TYPE* type) = 0;
+  virtual HRESULT get_FirewallEnabled(VARIANT_BOOL* enabled) = 0;
+  virtual HRESULT put_FirewallEnabled(VARIANT_BOOL enabled) = 0;
+  virtual HRESULT get_AuthorizedApplications(
+    INetFwAuthorizedApplications** apps) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(INetFwProfile, IDispatch);
+
+struct INetFwPolicy : IDispatch {
+  virtual HRESULT get_CurrentProfile(INetFwProfile** profile) = 0;
+  virtual HRESULT GetProfileByType(NET_FW_PROFILE_TYPE type,
+    INetFwProfile** profile) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(INetFwPolicy, IDispatch);
+
+struct INetFwMgr : IDispatch {
+  virtual HRESULT get_LocalPolicy(INetFwPolicy** policy) = 0;
+  virtual HRESULT get_CurrentProfileType(NET_FW_PROFILE_TYPE* type) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(INetFwMgr, IDispatch);
+
+struct INetFwRule : IDispatch {
+  virtual HRESULT get_Name(BSTR* name) = 0;
+  virtual HRESULT put_Name(BSTR name) = 0;
+  virtual HRESULT get_Description(BSTR* desc) = 0;
+  virtual HRESULT put_Description(BSTR desc) = 0;
+  virtual HRESULT get_ApplicationName(BSTR* image_file_name) = 0;
+  virtual HRESULT put_ApplicationName(BSTR image_file_name) = 0;
+  virtual HRESULT get_ServiceName(BSTR* service_name) = 0;
+  virtual HRESULT put_ServiceName(BSTR service_name) = 0;
+  virtual HRESULT get_Protocol(LONG* protocol) = 0;
+  virtual HRESULT put_Protocol(LONG protocol) = 0;
+  virtual HRESULT get_LocalPorts(BSTR* port_numbers) = 0;
+  virtual HRESULT put_LocalPorts(BSTR port_numbers) = 0;
+  virtual HRESULT get_RemotePorts(BSTR* port_numbers) = 0;
+  virtual HRESULT put_RemotePorts(BSTR port_numbers) = 0;
+  virtual HRESULT get_LocalAddresses(BSTR* addresses) = 0;
+  virtual HRESULT put_LocalAddresses(BSTR addresses) = 0;
+  virtual HRESULT get_RemoteAddresses(BSTR* addresses) = 0;
+  virtual HRESULT put_RemoteAddresses(BSTR addresses) = 0;
+  virtual HRESULT get_Direction(NET_FW_RULE_DIRECTION* dir) = 0;
+  virtual HRESULT put_Direction(NET_FW_RULE_DIRECTION dir) = 0;
+  virtual HRESULT get_InterfaceTypes(BSTR* interface_types) = 0;
+  virtual HRESULT put_InterfaceTypes(BSTR interface_types) = 0;
+  virtual HRESULT get_Enabled(VARIANT_BOOL* enabled) = 0;
+  virtual HRESULT put_Enabled(VARIANT_BOOL enabled) = 0;
+  virtual HRESULT get_Grouping(BSTR* context) = 0;
+  virtual HRESULT put_Grouping(BSTR context) = 0;
+  virtual HRESULT get_Profiles(long* profile_types) = 0;
+  virtual HRESULT put_Profiles(long profile_types) = 0;
+  virtual HRESULT get_EdgeTraversal(VARIANT_BOOL* enabled) = 0;
+  virtual HRESULT put_EdgeTraversal(VARIANT_BOOL enabled) = 0;
+  virtual HRESULT get_Action(NET_FW_ACTION* action) = 0;
+  virtual HRESULT put_Action(NET_FW_ACTION action) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(INetFwRule, IDispatch);
+
+struct INetFwRules : IDispatch {
+  virtual HRESULT get_Count(long* count) = 0;
+  virtual HRESULT Add(INetFwRule* rule) = 0;
+  virtual HRESULT Remove(BSTR name) = 0;
+  virtual HRESULT Item(BSTR name, INetFwRule** rule) = 0;
+  virtual HRESULT get__NewEnum(IUnknown** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(INetFwRules, IDispatch);
+
+struct INetFwPolicy2 : IDispatch {
+  virtual HRESULT get_CurrentProfileTypes(long* profile_types) = 0;
+  virtual HRESULT get_FirewallEnabled(NET_FW_PROFILE_TYPE2 profile_type,
+    VARIANT_BOOL* enabled) = 0;
+  virtual HRESULT put_FirewallEnabled(NET_FW_PROFILE_TYPE2 profile_type,
+    VARIANT_BOOL enabled) = 0;
+  virtual HRESULT get_Rules(INetFwRules** rules) = 0;
+  virtual HRESULT EnableRuleGroup(long profile_types, BSTR group,
+    VARIANT_BOOL enable) = 0;
+  virtual HRESULT IsRuleGroupEnabled(long profile_types, BSTR group,
+    VARIANT_BOOL* enabled) = 0;
+  virtual HRESULT get_LocalPolicyModifyState(
+    NET_FW_MODIFY_STATE* modify_state) = 0;
+  virtual HRESULT get_IsRuleGroupCurrentlyEnabled(BSTR group,
+    VARIANT_BOOL* enabled) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(INetFwPolicy2, IDispatch);
+
+// -----------------------------------------------------------------------------
+// Classes
+// -----------------------------------------------------------------------------
+
+class NetFwAuthorizedApplication;
+DMITIGR_WINCOM_FAKE_UUID(NetFwAuthorizedApplication);
+
+class NetFwMgr;
+DMITIGR_WINCOM_FAKE_UUID(NetFwMgr);
+
+class NetFwRule;
+DMITIGR_WINCOM_FAKE_UUID(NetFwRule);
+
+class NetFwPolicy2;
+DMITIGR_WINCOM_FAKE_UUID(NetFwPolicy2);
@@ -0,0 +1,448 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+ * The stand-in of the SDK header of the same name: the subset of the Task
+ * Scheduler 2.0 interfaces used by the wrappers (see ../tasc.hpp).
+ */
+
+#include "../runtime.hpp"
+
+// -----------------------------------------------------------------------------
+// Enumerations
+// -----------------------------------------------------------------------------
+
+enum TASK_ACTION_TYPE {
+  TASK_ACTION_EXEC = 0,
+  TASK_ACTION_COM_HANDLER = 5,
+  TASK_ACTION_SEND_EMAIL = 6,
+  TASK_ACTION_SHOW_MESSAGE = 7
+};
+
+enum TASK_COMPATIBILITY {
+  TASK_COMPATIBILITY_AT = 0,
+  TASK_COMPATIBILITY_V1 = 1,
+  TASK_COMPATIBILITY_V2 = 2,
+  TASK_COMPATIBILITY_V2_1 = 3,
+  TASK_COMPATIBILITY_V2_2 = 4,
+  TASK_COMPATIBILITY_V2_3 = 5,
+  TASK_COMPATIBILITY_V2_4 = 6
+};
+
+enum TASK_CREATION {
+  TASK_VALIDATE_ONLY = 0x1,
+  TASK_CREATE = 0x2,
+  TASK_UPDATE = 0x4,
+  TASK_CREATE_OR_UPDATE = TASK_CREATE | TASK_UPDATE,
+  TASK_DISABLE = 0x8,
+  TASK_DONT_ADD_PRINCIPAL_ACE = 0x10,
+  TASK_IGNORE_REGISTRATION_TRIGGERS = 0x20
+};
+
+enum TASK_ENUM_FLAGS {
+  TASK_ENUM_HIDDEN = 0x1
+};
+
+enum TASK_INSTANCES_POLICY {
+  TASK_INSTANCES_PARALLEL = 0,
+  TASK_INSTANCES_QUEUE = 1,
+  TASK_INSTANCES_IGNORE_NEW = 2,
+  TASK_INSTANCES_STOP_EXISTING = 3
+};
+
+enum TASK_LOGON_TYPE {
+  TASK_LOGON_NONE = 0,
+  TASK_LOGON_PASSWORD = 1,
+  TASK_LOGON_S4U = 2,
+  TASK_LOGON_INTERACTIVE_TOKEN = 3,
+  TASK_LOGON_GROUP = 4,
+  TASK_LOGON_SERVICE_ACCOUNT = 5,
+  TASK_LOGON_INTERACTIVE_TOKEN_OR_PASSWORD = 6
+};
+
+enum TASK_RUN_FLAGS {
+  TASK_RUN_NO_FLAGS = 0,
+  TASK_RUN_AS_SELF = 0x1,
+  TASK_RUN_IGNORE_CONSTRAINTS = 0x2,
+  TASK_RUN_USE_SESSION_ID = 0x4,
+  TASK_RUN_USER_SID = 0x8
+};
+
+enum TASK_RUNLEVEL_TYPE {
+  TASK_RUNLEVEL_LUA = 0,
+  TASK_RUNLEVEL_HIGHEST = 1
+};
+
+enum TASK_STATE {
+  TASK_STATE_UNKNOWN = 0,
+  TASK_STATE_DISABLED = 1,
+  TASK_STATE_QUEUED = 2,
+  TASK_STATE_READY = 3,
+  TASK_STATE_RUNNING = 4
+};
+
+enum TASK_TRIGGER_TYPE2 {
+  TASK_TRIGGER_EVENT = 0,
+  TASK_TRIGGER_TIME = 1,
+  TASK_TRIGGER_DAILY = 2,
+  TASK_TRIGGER_WEEKLY = 3,
+  TASK_TRIGGER_MONTHLY = 4,
+  TASK_TRIGGER_MONTHLYDOW = 5,
+  TASK_TRIGGER_IDLE = 6,
+  TASK_TRIGGER_REGISTRATION = 7,
+  TASK_TRIGGER_BOOT = 8,
+  TASK_TRIGGER_LOGON = 9,
+  TASK_TRIGGER_SESSION_STATE_CHANGE = 11,
+  TASK_TRIGGER_CUSTOM_TRIGGER_01 = 12
+};
+
+// -----------------------------------------------------------------------------
+// Error codes
+// -----------------------------------------------------------------------------
+
+DMITIGR_WINCOM_FAKE_HRESULT(SCHED_S_TASK_RUNNING, 0x00041301);
+DMITIGR_WINCOM_FAKE_HRESULT(SCHED_S_TASK_HAS_NOT_RUN, 0x00041303);
+DMITIGR_WINCOM_FAKE_HRESULT(SCHED_S_TASK_TERMINATED, 0x00041306);
+DMITIGR_WINCOM_FAKE_HRESULT(SCHED_E_TASK_NOT_RUNNING, 0x8004130B);
+DMITIGR_WINCOM_FAKE_HRESULT(SCHED_E_SERVICE_NOT_RUNNING, 0x80041315);
+DMITIGR_WINCOM_FAKE_HRESULT(SCHED_E_MALFORMEDXML, 0x8004131A);
+DMITIGR_WINCOM_FAKE_HRESULT(SCHED_E_TASK_DISABLED, 0x80041326);
+
+// -----------------------------------------------------------------------------
+// Definition
+// -----------------------------------------------------------------------------
+
+struct IRegistrationInfo : IDispatch {
+  virtual HRESULT get_Description(BSTR* description) = 0;
+  virtual HRESULT put_Description(BSTR description) = 0;
+  virtual HRESULT get_Author(BSTR* author) = 0;
+  virtual HRESULT put_Author(BSTR author) = 0;
+  virtual HRESULT get_Version(BSTR* version) = 0;
+  virtual HRESULT put_Version(BSTR version) = 0;
+  virtual HRESULT get_Date(BSTR* date) = 0;
+  virtual HRESULT put_Date(BSTR date) = 0;
+  virtual HRESULT get_Documentation(BSTR* documentation) = 0;
+  virtual HRESULT put_Documentation(BSTR documentation) = 0;
+  virtual HRESULT get_XmlText(BSTR* text) = 0;
+  virtual HRESULT put_XmlText(BSTR text) = 0;
+  virtual HRESULT get_URI(BSTR* uri) = 0;
+  virtual HRESULT put_URI(BSTR uri) = 0;
+  virtual HRESULT get_Source(BSTR* source) = 0;
+  virtual HRESULT put_Source(BSTR source) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRegistrationInfo, IDispatch);
+
+struct IRepetitionPattern : IDispatch {
+  virtual HRESULT get_Interval(BSTR* interval) = 0;
+  virtual HRESULT put_Interval(BSTR interval) = 0;
+  virtual HRESULT get_Duration(BSTR* duration) = 0;
+  virtual HRESULT put_Duration(BSTR duration) = 0;
+  virtual HRESULT get_StopAtDurationEnd(VARIANT_BOOL* stop) = 0;
+  virtual HRESULT put_StopAtDurationEnd(VARIANT_BOOL stop) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRepetitionPattern, IDispatch);
+
+struct ITrigger : IDispatch {
+  virtual HRESULT get_Type(TASK_TRIGGER_TYPE2* type) = 0;
+  virtual HRESULT get_Id(BSTR* id) = 0;
+  virtual HRESULT put_Id(BSTR id) = 0;
+  virtual HRESULT get_Repetition(IRepetitionPattern** repeat) = 0;
+  virtual HRESULT put_Repetition(IRepetitionPattern* repeat) = 0;
+  virtual HRESULT get_ExecutionTimeLimit(BSTR* time_limit) = 0;
+  virtual HRESULT put_ExecutionTimeLimit(BSTR time_limit) = 0;
+  virtual HRESULT get_StartBoundary(BSTR* start) = 0;
+  virtual HRESULT put_StartBoundary(BSTR start) = 0;
+  virtual HRESULT get_EndBoundary(BSTR* end) = 0;
+  virtual HRESULT put_EndBoundary(BSTR end) = 0;
+  virtual HRESULT get_Enabled(VARIANT_BOOL* enabled) = 0;
+  virtual HRESULT put_Enabled(VARIANT_BOOL enabled) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(ITrigger, IDispatch);
+
+struct ITimeTrigger : ITrigger {
+  virtual HRESULT get_RandomDelay(BSTR* delay) = 0;
+  virtual HRESULT put_RandomDelay(BSTR delay) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(ITimeTrigger, ITrigger);
+
+struct IDailyTrigger : ITrigger {
+  virtual HRESULT get_DaysInterval(short* days) = 0;
+  virtual HRESULT put_DaysInterval(short days) = 0;
+  virtual HRESULT get_RandomDelay(BSTR* delay) = 0;
+  virtual HRESULT put_RandomDelay(BSTR delay) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IDailyTrigger, ITrigger);
+
+struct IWeeklyTrigger : ITrigger {
+  virtual HRESULT get_DaysOfWeek(short* days) = 0;
+  virtual HRESULT put_DaysOfWeek(short days) = 0;
+  virtual HRESULT get_WeeksInterval(short* weeks) = 0;
+  virtual HRESULT put_WeeksInterval(short weeks) = 0;
+  virtual HRESULT get_RandomDelay(BSTR* delay) = 0;
+  virtual HRESULT put_RandomDelay(BSTR delay) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IWeeklyTrigger, ITrigger);
+
+struct IMonthlyTrigger : ITrigger {
+  virtual HRESULT get_DaysOfMonth(long* days) = 0;
+  virtual HRESULT put_DaysOfMonth(long days) = 0;
+  virtual HRESULT get_MonthsOfYear(short* months) = 0;
+  virtual HRESULT put_MonthsOfYear(short months) = 0;
+  virtual HRESULT get_RunOnLastDayOfMonth(VARIANT_BOOL* last_day) = 0;
+  virtual HRESULT put_RunOnLastDayOfMonth(VARIANT_BOOL last_day) = 0;
+  virtual HRESULT get_RandomDelay(BSTR* delay) = 0;
+  virtual HRESULT put_RandomDelay(BSTR delay) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IMonthlyTrigger, ITrigger);
+
+struct IMonthlyDOWTrigger : ITrigger {
+  virtual HRESULT get_DaysOfWeek(short* days) = 0;
+  virtual HRESULT put_DaysOfWeek(short days) = 0;
+  virtual HRESULT get_WeeksOfMonth(short* weeks) = 0;
+  virtual HRESULT put_WeeksOfMonth(short weeks) = 0;
+  virtual HRESULT get_MonthsOfYear(short* months) = 0;
+  virtual HRESULT put_MonthsOfYear(short months) = 0;
+  virtual HRESULT get_RunOnLastWeekOfMonth(VARIANT_BOOL* last_week) = 0;
+  virtual HRESULT put_RunOnLastWeekOfMonth(VARIANT_BOOL last_week) = 0;
+  virtual HRESULT get_RandomDelay(BSTR* delay) = 0;
+  virtual HRESULT put_RandomDelay(BSTR delay) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IMonthlyDOWTrigger, ITrigger);
+
+struct ITriggerCollection : IDispatch {
+  virtual HRESULT get_Count(long* count) = 0;
+  virtual HRESULT get_Item(long index, ITrigger** trigger) = 0;
+  virtual HRESULT get__NewEnum(IUnknown** result) = 0;
+  virtual HRESULT Create(TASK_TRIGGER_TYPE2 type, ITrigger** trigger) = 0;
+  virtual HRESULT Remove(VARIANT index) = 0;
+  virtual HRESULT Clear() = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(ITriggerCollection, IDispatch);
+
+struct IAction : IDispatch {
+  virtual HRESULT get_Id(BSTR* id) = 0;
+  virtual HRESULT put_Id(BSTR id) = 0;
+  virtual HRESULT get_Type(TASK_ACTION_TYPE* type) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IAction, IDispatch);
+
+struct IExecAction : IAction {
+  virtual HRESULT get_Path(BSTR* path) = 0;
+  virtual HRESULT put_Path(BSTR path) = 0;
+  virtual HRESULT get_Arguments(BSTR* arguments) = 0;
+  virtual HRESULT put_Arguments(BSTR arguments) = 0;
+  virtual HRESULT get_WorkingDirectory(BSTR* directory) = 0;
+  virtual HRESULT put_WorkingDirectory(BSTR directory) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IExecAction, IAction);
+
+struct IComHandlerAction : IAction {
+  virtual HRESULT get_ClassId(BSTR* class_id) = 0;
+  virtual HRESULT put_ClassId(BSTR class_id) = 0;
+  virtual HRESULT get_Data(BSTR* data) = 0;
+  virtual HRESULT put_Data(BSTR data) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IComHandlerAction, IAction);
+
+struct IActionCollection : IDispatch {
+  virtual HRESULT get_Count(long* count) = 0;
+  virtual HRESULT get_Item(long index, IAction** action) = 0;
+  virtual HRESULT get__NewEnum(IUnknown** result) = 0;
+  virtual HRESULT get_XmlText(BSTR* text) = 0;
+  virtual HRESULT put_XmlText(BSTR text) = 0;
+  virtual HRESULT Create(TASK_ACTION_TYPE type, IAction** action) = 0;
+  virtual HRESULT Remove(VARIANT index) = 0;
+  virtual HRESULT Clear() = 0;
+  virtual HRESULT get_Context(BSTR* context) = 0;
+  virtual HRESULT put_Context(BSTR context) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IActionCollection, IDispatch);
+
+struct ITaskSettings : IDispatch {
+  virtual HRESULT get_AllowDemandStart(VARIANT_BOOL* allow) = 0;
+  virtual HRESULT put_AllowDemandStart(VARIANT_BOOL allow) = 0;
+  virtual HRESULT get_RestartInterval(BSTR* interval) = 0;
+  virtual HRESULT put_RestartInterval(BSTR interval) = 0;
+  virtual HRESULT get_RestartCount(int* count) = 0;
+  virtual HRESULT put_RestartCount(int count) = 0;
+  virtual HRESULT get_MultipleInstances(TASK_INSTANCES_POLICY* policy) = 0;
+  virtual HRESULT put_MultipleInstances(TASK_INSTANCES_POLICY policy) = 0;
+  virtual HRESULT get_StopIfGoingOnBatteries(VARIANT_BOOL* stop) = 0;
+  virtual HRESULT put_StopIfGoingOnBatteries(VARIANT_BOOL stop) = 0;
+  virtual HRESULT get_DisallowStartIfOnBatteries(VARIANT_BOOL* disallow) = 0;
+  virtual HRESULT put_DisallowStartIfOnBatteries(VARIANT_BOOL disallow) = 0;
+  virtual HRESULT get_AllowHardTerminate(VARIANT_BOOL* allow) = 0;
+  virtual HRESULT put_AllowHardTerminate(VARIANT_BOOL allow) = 0;
+  virtual HRESULT get_StartWhenAvailable(VARIANT_BOOL* start) = 0;
+  virtual HRESULT put_StartWhenAvailable(VARIANT_BOOL start) = 0;
+  virtual HRESULT get_XmlText(BSTR* text) = 0;
+  virtual HRESULT put_XmlText(BSTR text) = 0;
+  virtual HRESULT get_RunOnlyIfNetworkAvailable(VARIANT_BOOL* run) = 0;
+  virtual HRESULT put_RunOnlyIfNetworkAvailable(VARIANT_BOOL run) = 0;
+  virtual HRESULT get_ExecutionTimeLimit(BSTR* time_limit) = 0;
+  virtual HRESULT put_ExecutionTimeLimit(BSTR time_limit) = 0;
+  virtual HRESULT get_Enabled(VARIANT_BOOL* enabled) = 0;
+  virtual HRESULT put_Enabled(VARIANT_BOOL enabled) = 0;
+  virtual HRESULT get_DeleteExpiredTaskAfter(BSTR* expiration_delay) = 0;
+  virtual HRESULT put_DeleteExpiredTaskAfter(BSTR expiration_delay) = 0;
+  virtual HRESULT get_Priority(int* priority) = 0;
+  virtual HRESULT put_Priority(int priority) = 0;
+  virtual HRESULT get_Compatibility(TASK_COMPATIBILITY* level) = 0;
+  virtual HRESULT put_Compatibility(TASK_COMPATIBILITY level) = 0;
+  virtual HRESULT get_Hidden(VARIANT_BOOL* hidden) = 0;
+  virtual HRESULT put_Hidden(VARIANT_BOOL hidden) = 0;
+  virtual HRESULT get_RunOnlyIfIdle(VARIANT_BOOL* run) = 0;
+  virtual HRESULT put_RunOnlyIfIdle(VARIANT_BOOL run) = 0;
+  virtual HRESULT get_WakeToRun(VARIANT_BOOL* wake) = 0;
+  virtual HRESULT put_WakeToRun(VARIANT_BOOL wake) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(ITaskSettings, IDispatch);
+
+struct IPrincipal : IDispatch {
+  virtual HRESULT get_Id(BSTR* id) = 0;
+  virtual HRESULT put_Id(BSTR id) = 0;
+  virtual HRESULT get_DisplayName(BSTR* name) = 0;
+  virtual HRESULT put_DisplayName(BSTR name) = 0;
+  virtual HRESULT get_UserId(BSTR* user) = 0;
+  virtual HRESULT put_UserId(BSTR user) = 0;
+  virtual HRESULT get_LogonType(TASK_LOGON_TYPE* logon) = 0;
+  virtual HRESULT put_LogonType(TASK_LOGON_TYPE logon) = 0;
+  virtual HRESULT get_GroupId(BSTR* group) = 0;
+  virtual HRESULT put_GroupId(BSTR group) = 0;
+  virtual HRESULT get_RunLevel(TASK_RUNLEVEL_TYPE* run_level) = 0;
+  virtual HRESULT put_RunLevel(TASK_RUNLEVEL_TYPE run_level) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IPrincipal, IDispatch);
+
+struct ITaskDefinition : IDispatch {
+  virtual HRESULT get_RegistrationInfo(IRegistrationInfo** info) = 0;
+  virtual HRESULT put_RegistrationInfo(IRegistrationInfo* info) = 0;
+  virtual HRESULT get_Triggers(ITriggerCollection** triggers) = 0;
+  virtual HRESULT put_Triggers(ITriggerCollection* triggers) = 0;
+  virtual HRESULT get_Settings(ITaskSettings** settings) = 0;
+  virtual HRESULT put_Settings(ITaskSettings* settings) = 0;
+  virtual HRESULT get_Data(BSTR* data) = 0;
+  virtual HRESULT put_Data(BSTR data) = 0;
+  virtual HRESULT get_Principal(IPrincipal** principal) = 0;
+  virtual HRESULT put_Principal(IPrincipal* principal) = 0;
+  virtual HRESULT get_Actions(IActionCollection** actions) = 0;
+  virtual HRESULT put_Actions(IActionCollection* actions) = 0;
+  virtual HRESULT get_XmlText(BSTR* xml) = 0;
+  virtual HRESULT put_XmlText(BSTR xml) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(ITaskDefinition, IDispatch);
+
+// -----------------------------------------------------------------------------
+// Tasks
+// -----------------------------------------------------------------------------
+
+struct IRunningTask : IDispatch {
+  virtual HRESULT get_Name(BSTR* name) = 0;
+  virtual HRESULT get_InstanceGuid(BSTR* guid) = 0;
+  virtual HRESULT get_Path(BSTR* path) = 0;
+  virtual HRESULT get_State(TASK_STATE* state) = 0;
+  virtual HRESULT get_CurrentAction(BSTR* name) = 0;
+  virtual HRESULT Stop() = 0;
+  virtual HRESULT Refresh() = 0;
+  virtual HRESULT get_EnginePID(DWORD* pid) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRunningTask, IDispatch);
+
+struct IRunningTaskCollection : IDispatch {
+  virtual HRESULT get_Count(LONG* count) = 0;
+  virtual HRESULT get_Item(VARIANT index, IRunningTask** task) = 0;
+  virtual HRESULT get__NewEnum(IUnknown** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRunningTaskCollection, IDispatch);
+
+struct IRegisteredTask : IDispatch {
+  virtual HRESULT get_Name(BSTR* name) = 0;
+  virtual HRESULT get_Path(BSTR* path) = 0;
+  virtual HRESULT get_State(TASK_STATE* state) = 0;
+  virtual HRESULT get_Enabled(VARIANT_BOOL* enabled) = 0;
+  virtual HRESULT put_Enabled(VARIANT_BOOL enabled) = 0;
+  virtual HRESULT Run(VARIANT params, IRunningTask** task) = 0;
+  virtual HRESULT RunEx(VARIANT params, LONG flags, LONG session_id,
+    BSTR user, IRunningTask** task) = 0;
+  virtual HRESULT GetInstances(LONG flags,
+    IRunningTaskCollection** tasks) = 0;
+  virtual HRESULT get_LastRunTime(DATE* time) = 0;
+  virtual HRESULT get_LastTaskResult(LONG* result) = 0;
+  virtual HRESULT get_NumberOfMissedRuns(LONG* count) = 0;
+  virtual HRESULT get_NextRunTime(DATE* time) = 0;
+  virtual HRESULT get_Definition(ITaskDefinition** definition) = 0;
+  virtual HRESULT get_Xml(BSTR* xml) = 0;
+  virtual HRESULT Stop(LONG flags) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRegisteredTask, IDispatch);
+
+struct IRegisteredTaskCollection : IDispatch {
+  virtual HRESULT get_Count(LONG* count) = 0;
+  virtual HRESULT get_Item(VARIANT index, IRegisteredTask** task) = 0;
+  virtual HRESULT get__NewEnum(IUnknown** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(IRegisteredTaskCollection, IDispatch);
+
+struct ITaskFolder;
+
+struct ITaskFolderCollection : IDispatch {
+  virtual HRESULT get_Count(LONG* count) = 0;
+  virtual HRESULT get_Item(VARIANT index, ITaskFolder** folder) = 0;
+  virtual HRESULT get__NewEnum(IUnknown** result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(ITaskFolderCollection, IDispatch);
+
+struct ITaskFolder : IDispatch {
+  virtual HRESULT get_Name(BSTR* name) = 0;
+  virtual HRESULT get_Path(BSTR* path) = 0;
+  virtual HRESULT GetFolder(BSTR path, ITaskFolder** folder) = 0;
+  virtual HRESULT GetFolders(LONG flags, ITaskFolderCollection** folders) = 0;
+  virtual HRESULT CreateFolder(BSTR name, VARIANT sddl,
+    ITaskFolder** folder) = 0;
+  virtual HRESULT DeleteFolder(BSTR name, LONG flags) = 0;
+  virtual HRESULT GetTask(BSTR path, IRegisteredTask** task) = 0;
+  virtual HRESULT GetTasks(LONG flags, IRegisteredTaskCollection** tasks) = 0;
+  virtual HRESULT DeleteTask(BSTR name, LONG flags) = 0;
+  virtual HRESULT RegisterTask(BSTR path, BSTR xml, LONG flags,
+    VARIANT user_id, VARIANT password, TASK_LOGON_TYPE logon_type,
+    VARIANT sddl, IRegisteredTask** task) = 0;
+  virtual HRESULT RegisterTaskDefinition(BSTR path,
+    ITaskDefinition* definition, LONG flags, VARIANT user_id,
+    VARIANT password, TASK_LOGON_TYPE logon_type, VARIANT sddl,
+    IRegisteredTask** task) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(ITaskFolder, IDispatch);
+
+struct ITaskService : IDispatch {
+  virtual HRESULT GetFolder(BSTR path, ITaskFolder** folder) = 0;
+  virtual HRESULT GetRunningTasks(LONG flags,
+    IRunningTaskCollection** tasks) = 0;
+  virtual HRESULT NewTask(DWORD flags, ITaskDefinition** definition) = 0;
+  virtual HRESULT Connect(VARIANT server_name, VARIANT user, VARIANT domain,
+    VARIANT password) = 0;
+  virtual HRESULT get_Connected(VARIANT_BOOL* connected) = 0;
+  virtual HRESULT get_TargetServer(BSTR* server) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(ITaskService, IDispatch);
+
+// -----------------------------------------------------------------------------
+// Classes
+// -----------------------------------------------------------------------------
+
+class TaskScheduler;
+DMITIGR_WINCOM_FAKE_UUID(TaskScheduler);
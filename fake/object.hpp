@@ -0,0 +1,667 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "runtime.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cwctype>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom::fake {
+
+namespace detail {
+
+/// @returns `true` if `lhs` and `rhs` are equal case-insensitively.
+inline bool iequals(const std::wstring_view lhs,
+  const std::wstring_view rhs) noexcept
+{
+  if (lhs.size() != rhs.size())
+    return false;
+  for (std::size_t i{}; i < lhs.size(); ++i) {
+    if (std::towlower(lhs[i]) != std::towlower(rhs[i]))
+      return false;
+  }
+  return true;
+}
+
+/// The case-insensitive ordering of strings.
+struct Iless final {
+  using is_transparent = void;
+
+  bool operator()(const std::wstring_view lhs,
+    const std::wstring_view rhs) const noexcept
+  {
+    const auto size = std::min(lhs.size(), rhs.size());
+    for (std::size_t i{}; i < size; ++i) {
+      const auto l = std::towlower(lhs[i]);
+      const auto r = std::towlower(rhs[i]);
+      if (l != r)
+        return l < r;
+    }
+    return lhs.size() < rhs.size();
+  }
+};
+
+} // namespace detail
+
+/// The number of the fake objects alive.
+inline std::atomic_int64_t object_count;
+
+// -----------------------------------------------------------------------------
+// Ref
+// -----------------------------------------------------------------------------
+
+/// The owning reference to the COM object.
+template<class T>
+class Ref final {
+public:
+  /// Releases the object.
+  ~Ref()
+  {
+    if (object_)
+      object_->Release();
+  }
+
+  /// Constructs the null reference.
+  Ref() noexcept = default;
+
+  /// Adopts the reference of `object`.
+  explicit Ref(T* const object) noexcept
+    : object_{object}
+  {}
+
+  Ref(const Ref& rhs) noexcept
+    : object_{rhs.object_}
+  {
+    if (object_)
+      object_->AddRef();
+  }
+
+  Ref& operator=(const Ref& rhs) noexcept
+  {
+    if (this != &rhs) {
+      Ref tmp{rhs};
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  Ref(Ref&& rhs) noexcept
+    : object_{rhs.object_}
+  {
+    rhs.object_ = nullptr;
+  }
+
+  Ref& operator=(Ref&& rhs) noexcept
+  {
+    if (this != &rhs) {
+      Ref tmp{std::move(rhs)};
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  void swap(Ref& other) noexcept
+  {
+    using std::swap;
+    swap(object_, other.object_);
+  }
+
+  /// @returns The new reference to the object (to be released by caller).
+  T* copy() const noexcept
+  {
+    if (object_)
+      object_->AddRef();
+    return object_;
+  }
+
+  T* get() const noexcept
+  {
+    return object_;
+  }
+
+  T* operator->() const noexcept
+  {
+    return object_;
+  }
+
+  T& operator*() const noexcept
+  {
+    return *object_;
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return object_;
+  }
+
+private:
+  T* object_{};
+};
+
+/// @returns The new object of type `T`.
+template<class T, typename ... Types>
+Ref<T> make(Types&& ... args)
+{
+  return Ref<T>{new T(std::forward<Types>(args)...)};
+}
+
+// -----------------------------------------------------------------------------
+// Object
+// -----------------------------------------------------------------------------
+
+/// The authentication settings of the proxy.
+struct Blanket final {
+  DWORD authn{RPC_C_AUTHN_DEFAULT};
+  DWORD authz{RPC_C_AUTHZ_DEFAULT};
+  DWORD authn_level{RPC_C_AUTHN_LEVEL_DEFAULT};
+  DWORD imp_level{RPC_C_IMP_LEVEL_DEFAULT};
+  DWORD capabilities{EOAC_DEFAULT};
+  /// The number of `IClientSecurity::SetBlanket()` calls.
+  std::uint64_t set_count{};
+};
+
+/**
+ * @brief The fake COM object with the reference counting and
+ * `QueryInterface()` of `Interfaces` and their bases.
+ *
+ * @details Implements `IDispatch` without the type information for the
+ * interfaces derived from it, and `IClientSecurity` which records the
+ * blanket if it's one of `Interfaces`.
+ *
+ * @remarks The first reference is owned by the creator (see `make()`).
+ */
+template<class ... Interfaces>
+class Object : public Interfaces... {
+public:
+  /// The destructor.
+  virtual ~Object()
+  {
+    object_count.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  Object(const Object&) = delete;
+  Object& operator=(const Object&) = delete;
+  Object(Object&&) = delete;
+  Object& operator=(Object&&) = delete;
+
+  // IUnknown overrides
+
+  HRESULT QueryInterface(REFIID id, void** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (!(query<Interfaces>(id, result) || ...))
+      return E_NOINTERFACE;
+    AddRef();
+    return S_OK;
+  }
+
+  ULONG AddRef() override
+  {
+    return ref_count_.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  ULONG Release() override
+  {
+    const auto result = ref_count_.fetch_sub(1,
+      std::memory_order_acq_rel) - 1;
+    if (!result)
+      delete this;
+    return result;
+  }
+
+  // IDispatch overrides (if any)
+
+  HRESULT GetTypeInfoCount(UINT* const count)
+  {
+    if (!count)
+      return E_POINTER;
+    *count = 0;
+    return S_OK;
+  }
+
+  HRESULT GetTypeInfo(UINT, LCID, ITypeInfo** const result)
+  {
+    if (result)
+      *result = nullptr;
+    return E_NOTIMPL;
+  }
+
+  HRESULT GetIDsOfNames(REFIID, LPOLESTR*, UINT, LCID, DISPID*)
+  {
+    return E_NOTIMPL;
+  }
+
+  HRESULT Invoke(DISPID, REFIID, LCID, WORD, DISPPARAMS*, VARIANT*,
+    EXCEPINFO*, UINT*)
+  {
+    return E_NOTIMPL;
+  }
+
+  // IClientSecurity overrides (if any)
+
+  HRESULT QueryBlanket(IUnknown*, DWORD* const authn, DWORD* const authz,
+    OLECHAR** const server_princ_name, DWORD* const authn_level,
+    DWORD* const imp_level, void** const auth_info,
+    DWORD* const capabilities)
+  {
+    const std::lock_guard lg{blanket_mutex_};
+    const auto set = [](auto* const dest, const auto value) noexcept
+    {
+      if (dest)
+        *dest = value;
+    };
+    set(authn, blanket_.authn);
+    set(authz, blanket_.authz);
+    set(server_princ_name, nullptr);
+    set(authn_level, blanket_.authn_level);
+    set(imp_level, blanket_.imp_level);
+    set(auth_info, nullptr);
+    set(capabilities, blanket_.capabilities);
+    return S_OK;
+  }
+
+  HRESULT SetBlanket(IUnknown*, const DWORD authn, const DWORD authz,
+    OLECHAR*, const DWORD authn_level, const DWORD imp_level, void*,
+    const DWORD capabilities)
+  {
+    const std::lock_guard lg{blanket_mutex_};
+    blanket_ = Blanket{authn, authz, authn_level, imp_level, capabilities,
+      blanket_.set_count + 1};
+    return S_OK;
+  }
+
+  HRESULT CopyProxy(IUnknown* const proxy, IUnknown** const result)
+  {
+    if (!proxy || !result)
+      return E_INVALIDARG;
+    proxy->AddRef();
+    *result = proxy;
+    return S_OK;
+  }
+
+  /// @returns The blanket set by `SetBlanket()`.
+  Blanket blanket() const
+  {
+    const std::lock_guard lg{blanket_mutex_};
+    return blanket_;
+  }
+
+protected:
+  /// The constructor.
+  Object() noexcept
+  {
+    object_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<ULONG> ref_count_{1};
+  mutable std::mutex blanket_mutex_;
+  Blanket blanket_;
+
+  template<class Root, class I = Root>
+  bool query(REFIID id, void** const result) noexcept
+  {
+    if (id == __uuidof(I)) {
+      *result = static_cast<I*>(static_cast<Root*>(this));
+      return true;
+    }
+    using Base = typename detail::Interface_base<I>::Type;
+    if constexpr (!std::is_void_v<Base>)
+      return query<Root, Base>(id, result);
+    else
+      return false;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Property helpers
+// -----------------------------------------------------------------------------
+
+/// Stores the copy of `value` to `result`.
+inline HRESULT get(const std::wstring_view value, BSTR* const result)
+{
+  if (!result)
+    return E_POINTER;
+  *result = SysAllocStringLen(value.data(), static_cast<UINT>(value.size()));
+  return *result ? S_OK : E_OUTOFMEMORY;
+}
+
+/// @overload
+inline HRESULT get(const bool value, VARIANT_BOOL* const result) noexcept
+{
+  if (!result)
+    return E_POINTER;
+  *result = value ? VARIANT_TRUE : VARIANT_FALSE;
+  return S_OK;
+}
+
+/// @overload
+template<class T, class U>
+requires (std::is_arithmetic_v<T> || std::is_enum_v<T>)
+  && (std::is_arithmetic_v<U> || std::is_enum_v<U>)
+  && (!std::is_same_v<T, bool>)
+HRESULT get(const T value, U* const result) noexcept
+{
+  if (!result)
+    return E_POINTER;
+  *result = static_cast<U>(value);
+  return S_OK;
+}
+
+/// @overload
+template<class T, class I>
+requires std::is_base_of_v<I, T>
+HRESULT get(const Ref<T>& value, I** const result) noexcept
+{
+  if (!result)
+    return E_POINTER;
+  *result = value.copy();
+  return S_OK;
+}
+
+/// Stores `value` to `dest`.
+inline HRESULT put(std::wstring& dest, const BSTR value)
+{
+  dest.assign(value ? value : L"", value ? SysStringLen(value) : 0);
+  return S_OK;
+}
+
+/// @overload
+inline HRESULT put(bool& dest, const VARIANT_BOOL value) noexcept
+{
+  dest = value != VARIANT_FALSE;
+  return S_OK;
+}
+
+/// @overload
+template<class T, class U>
+requires (std::is_arithmetic_v<T> || std::is_enum_v<T>)
+  && (!std::is_same_v<T, bool>)
+HRESULT put(T& dest, const U value) noexcept
+{
+  dest = static_cast<T>(value);
+  return S_OK;
+}
+
+/// @overload
+template<class T, class I>
+requires std::is_base_of_v<I, T>
+HRESULT put(Ref<T>& dest, I* const value)
+{
+  auto* const object = dynamic_cast<T*>(value);
+  if (!object)
+    return E_INVALIDARG;
+  object->AddRef();
+  dest = Ref<T>{object};
+  return S_OK;
+}
+
+/// @returns The string of `value`, or empty string if it's not a `VT_BSTR`.
+inline std::wstring to_wstring(const VARIANT& value)
+{
+  return value.vt == VT_BSTR && value.bstrVal ?
+    std::wstring{value.bstrVal, SysStringLen(value.bstrVal)} :
+    std::wstring{};
+}
+
+/**
+ * @brief The data of the fake object guarded by the mutex, with the getters
+ * and setters of its members to implement the properties.
+ *
+ * @details Both `get()` and `put()` call `enter(method)` before accessing the
+ * data.
+ */
+template<class Data>
+class Property_store final {
+public:
+  /// The constructor.
+  explicit Property_store(Data data = {})
+    : data_{std::move(data)}
+  {}
+
+  /// Implements the getter of `member`.
+  template<class T, class U>
+  HRESULT get(const std::string_view method, T Data::* const member,
+    U* const result) const
+  {
+    if (const auto err = enter(method); err != S_OK)
+      return err;
+    const std::lock_guard lg{mutex_};
+    return fake::get(data_.*member, result);
+  }
+
+  /// Implements the setter of `member`.
+  template<class T, class U>
+  HRESULT put(const std::string_view method, T Data::* const member,
+    const U value)
+  {
+    if (const auto err = enter(method); err != S_OK)
+      return err;
+    const std::lock_guard lg{mutex_};
+    return fake::put(data_.*member, value);
+  }
+
+  /// @returns The copy of the data.
+  Data data() const
+  {
+    const std::lock_guard lg{mutex_};
+    return data_;
+  }
+
+  /// @returns The result of `f(data)` called under the lock.
+  template<class F>
+  decltype(auto) with(F&& f)
+  {
+    const std::lock_guard lg{mutex_};
+    return std::forward<F>(f)(data_);
+  }
+
+private:
+  mutable std::mutex mutex_;
+  Data data_;
+};
+
+// -----------------------------------------------------------------------------
+// Enum_variant
+// -----------------------------------------------------------------------------
+
+/// The enumerator of the snapshot of the collection of `IDispatch`.
+class Enum_variant final : public Object<IEnumVARIANT> {
+public:
+  using Items = std::vector<Ref<IDispatch>>;
+
+  /// The constructor.
+  explicit Enum_variant(std::shared_ptr<const Items> items,
+    const std::size_t position = 0)
+    : items_{std::move(items)}
+    , position_{position}
+  {}
+
+  /// Calls `enter("IEnumVARIANT::Next")` before fetching.
+  HRESULT Next(const ULONG count, VARIANT* const result,
+    ULONG* const fetched) override
+  {
+    if (!result || (!fetched && count != 1))
+      return E_POINTER;
+    if (const auto err = enter("IEnumVARIANT::Next"); err != S_OK)
+      return err;
+
+    ULONG n{};
+    for (; n < count && position_ < items_->size(); ++n, ++position_) {
+      VariantInit(&result[n]);
+      result[n].vt = VT_DISPATCH;
+      result[n].pdispVal = (*items_)[position_].copy();
+    }
+    if (fetched)
+      *fetched = n;
+    return n == count ? S_OK : S_FALSE;
+  }
+
+  HRESULT Skip(const ULONG count) override
+  {
+    const auto rest = items_->size() - position_;
+    position_ += std::min<std::size_t>(rest, count);
+    return count <= rest ? S_OK : S_FALSE;
+  }
+
+  HRESULT Reset() override
+  {
+    position_ = 0;
+    return S_OK;
+  }
+
+  HRESULT Clone(IEnumVARIANT** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = new(std::nothrow) Enum_variant{items_, position_};
+    return *result ? S_OK : E_OUTOFMEMORY;
+  }
+
+private:
+  std::shared_ptr<const Items> items_;
+  std::size_t position_{};
+};
+
+/// @returns The new enumerator of the copy of `items`.
+template<class T>
+HRESULT new_enum(const std::vector<Ref<T>>& items, IUnknown** const result)
+{
+  if (!result)
+    return E_POINTER;
+  auto snapshot = std::make_shared<Enum_variant::Items>();
+  snapshot->reserve(items.size());
+  for (const auto& item : items)
+    snapshot->emplace_back(item.copy());
+  *result = new(std::nothrow) Enum_variant{std::move(snapshot)};
+  return *result ? S_OK : E_OUTOFMEMORY;
+}
+
+// -----------------------------------------------------------------------------
+// Connection_point
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief The connection point of the dispatch interface `Events`.
+ *
+ * @remarks The references to the point must not outlive the container.
+ */
+template<class Events>
+class Connection_point final : public Object<IConnectionPoint> {
+public:
+  /// The constructor.
+  explicit Connection_point(IConnectionPointContainer& container) noexcept
+    : container_{&container}
+  {}
+
+  HRESULT GetConnectionInterface(IID* const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = __uuidof(Events);
+    return S_OK;
+  }
+
+  HRESULT GetConnectionPointContainer(
+    IConnectionPointContainer** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    container_->AddRef();
+    *result = container_;
+    return S_OK;
+  }
+
+  HRESULT Advise(IUnknown* const sink, DWORD* const cookie) override
+  {
+    if (!sink || !cookie)
+      return E_POINTER;
+    IDispatch* events{};
+    if (sink->QueryInterface(__uuidof(Events),
+        reinterpret_cast<void**>(&events)) != S_OK)
+      return CONNECT_E_CANNOTCONNECT;
+    const std::lock_guard lg{mutex_};
+    *cookie = ++last_cookie_;
+    sinks_.emplace(*cookie, Ref<IDispatch>{events});
+    return S_OK;
+  }
+
+  HRESULT Unadvise(const DWORD cookie) override
+  {
+    const std::lock_guard lg{mutex_};
+    return sinks_.erase(cookie) ? S_OK : CONNECT_E_NOCONNECTION;
+  }
+
+  HRESULT EnumConnections(IEnumConnections** const result) override
+  {
+    if (result)
+      *result = nullptr;
+    return E_NOTIMPL;
+  }
+
+  /**
+   * @brief Calls the event `id` of all the sinks with `args` (in the reverse
+   * order as `DISPPARAMS` requires).
+   *
+   * @returns The number of sinks called.
+   */
+  std::size_t fire(const DISPID id, std::vector<VARIANT> args = {})
+  {
+    std::vector<Ref<IDispatch>> sinks;
+    {
+      const std::lock_guard lg{mutex_};
+      for (const auto& [cookie, sink] : sinks_)
+        sinks.push_back(sink);
+    }
+    DISPPARAMS params{args.data(), nullptr, static_cast<UINT>(args.size()),
+      0};
+    for (const auto& sink : sinks)
+      sink->Invoke(id, GUID_NULL, 0, DISPATCH_METHOD, &params, nullptr,
+        nullptr, nullptr);
+    return sinks.size();
+  }
+
+  /// @returns The number of sinks.
+  std::size_t sink_count() const
+  {
+    const std::lock_guard lg{mutex_};
+    return sinks_.size();
+  }
+
+private:
+  IConnectionPointContainer* container_{};
+  mutable std::mutex mutex_;
+  DWORD last_cookie_{};
+  std::map<DWORD, Ref<IDispatch>> sinks_;
+};
+
+} // namespace dmitigr::wincom::fake
@@ -0,0 +1,1175 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "comdef.hpp"
+#include "object.hpp"
+
+#include <Rdpencomapi.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cwchar>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom::fake::rdp {
+
+namespace detail {
+
+using fake::detail::iequals;
+using fake::detail::Iless;
+
+/// @returns The value of the first attribute `name` in `text`, or empty string.
+inline std::wstring_view attribute(const std::wstring_view text,
+  const std::wstring_view name)
+{
+  const auto prefix = std::wstring{L" "}.append(name).append(L"=\"");
+  const auto pos = text.find(prefix);
+  if (pos == std::wstring_view::npos)
+    return {};
+  const auto begin = pos + prefix.size();
+  const auto end = text.find(L'"', begin);
+  return end != std::wstring_view::npos ?
+    text.substr(begin, end - begin) : std::wstring_view{};
+}
+
+/// @returns The `VT_DISPATCH` variant which doesn't own `value`.
+inline VARIANT dispatch(IDispatch* const value) noexcept
+{
+  VARIANT result{};
+  result.vt = VT_DISPATCH;
+  result.pdispVal = value;
+  return result;
+}
+
+} // namespace detail
+
+/// The connection point of the events of the session and the viewer.
+using Events = Connection_point<_IRDPSessionEvents>;
+
+// -----------------------------------------------------------------------------
+// Invitation
+// -----------------------------------------------------------------------------
+
+/// The data of invitation.
+struct Invitation_data final {
+  /// The identifier of the invitation in the connection string.
+  std::wstring ticket;
+  std::wstring connection_string;
+  std::wstring group_name;
+  std::wstring password;
+  long attendee_limit{};
+  bool is_revoked{};
+};
+
+/// The fake of `IRDPSRAPIInvitation`.
+class Invitation final : public Object<IRDPSRAPIInvitation> {
+public:
+  explicit Invitation(Invitation_data data)
+    : properties_{std::move(data)}
+  {}
+
+  HRESULT get_ConnectionString(BSTR* const result) override
+  {
+    return properties_.get("IRDPSRAPIInvitation::get_ConnectionString",
+      &Invitation_data::connection_string, result);
+  }
+
+  HRESULT get_GroupName(BSTR* const result) override
+  {
+    return properties_.get("IRDPSRAPIInvitation::get_GroupName",
+      &Invitation_data::group_name, result);
+  }
+
+  HRESULT get_Password(BSTR* const result) override
+  {
+    return properties_.get("IRDPSRAPIInvitation::get_Password",
+      &Invitation_data::password, result);
+  }
+
+  HRESULT get_AttendeeLimit(long* const result) override
+  {
+    return properties_.get("IRDPSRAPIInvitation::get_AttendeeLimit",
+      &Invitation_data::attendee_limit, result);
+  }
+
+  HRESULT put_AttendeeLimit(const long value) override
+  {
+    return properties_.put("IRDPSRAPIInvitation::put_AttendeeLimit",
+      &Invitation_data::attendee_limit, value);
+  }
+
+  HRESULT get_Revoked(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("IRDPSRAPIInvitation::get_Revoked",
+      &Invitation_data::is_revoked, result);
+  }
+
+  HRESULT put_Revoked(const VARIANT_BOOL value) override
+  {
+    return properties_.put("IRDPSRAPIInvitation::put_Revoked",
+      &Invitation_data::is_revoked, value);
+  }
+
+  /// @returns The copy of the data.
+  Invitation_data data() const
+  {
+    return properties_.data();
+  }
+
+private:
+  Property_store<Invitation_data> properties_;
+};
+
+// -----------------------------------------------------------------------------
+// Tcp_connection_info
+// -----------------------------------------------------------------------------
+
+/// The data of TCP connection of attendee.
+struct Tcp_data final {
+  long protocol{2}; // AF_INET
+  long local_port{};
+  std::wstring local_ip{L"127.0.0.1"};
+  long peer_port{};
+  std::wstring peer_ip{L"127.0.0.1"};
+};
+
+/// The fake of `IRDPSRAPITcpConnectionInfo`.
+class Tcp_connection_info final : public Object<IRDPSRAPITcpConnectionInfo> {
+public:
+  explicit Tcp_connection_info(Tcp_data data)
+    : properties_{std::move(data)}
+  {}
+
+  HRESULT get_Protocol(long* const result) override
+  {
+    return properties_.get("IRDPSRAPITcpConnectionInfo::get_Protocol",
+      &Tcp_data::protocol, result);
+  }
+
+  HRESULT get_LocalPort(long* const result) override
+  {
+    return properties_.get("IRDPSRAPITcpConnectionInfo::get_LocalPort",
+      &Tcp_data::local_port, result);
+  }
+
+  HRESULT get_LocalIP(BSTR* const result) override
+  {
+    return properties_.get("IRDPSRAPITcpConnectionInfo::get_LocalIP",
+      &Tcp_data::local_ip, result);
+  }
+
+  HRESULT get_PeerPort(long* const result) override
+  {
+    return properties_.get("IRDPSRAPITcpConnectionInfo::get_PeerPort",
+      &Tcp_data::peer_port, result);
+  }
+
+  HRESULT get_PeerIP(BSTR* const result) override
+  {
+    return properties_.get("IRDPSRAPITcpConnectionInfo::get_PeerIP",
+      &Tcp_data::peer_ip, result);
+  }
+
+private:
+  Property_store<Tcp_data> properties_;
+};
+
+// -----------------------------------------------------------------------------
+// Session_properties
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief The fake of `IRDPSRAPISessionProperties`.
+ *
+ * @details Any property can be set. Getting the property which was not set
+ * results in `E_INVALIDARG`.
+ */
+class Session_properties final : public Object<IRDPSRAPISessionProperties> {
+public:
+  HRESULT get_Property(const BSTR name, VARIANT* const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    if (const auto err = enter("IRDPSRAPISessionProperties::get_Property");
+      err != S_OK)
+      return err;
+    const std::lock_guard lg{mutex_};
+    const auto i = properties_.find(std::wstring_view{name ? name : L""});
+    return i != properties_.end() ? VariantCopy(result, &i->second) :
+      E_INVALIDARG;
+  }
+
+  HRESULT put_Property(const BSTR name, const VARIANT value) override
+  {
+    if (const auto err = enter("IRDPSRAPISessionProperties::put_Property");
+      err != S_OK)
+      return err;
+    else if (!SysStringLen(name))
+      return E_INVALIDARG;
+    _variant_t replaced{value};
+    const std::lock_guard lg{mutex_};
+    std::swap(properties_[std::wstring{name, SysStringLen(name)}], replaced);
+    return S_OK;
+  }
+
+  /// @returns The copy of the property `name`, or `std::nullopt`.
+  std::optional<_variant_t> property(const std::wstring_view name) const
+  {
+    const std::lock_guard lg{mutex_};
+    const auto i = properties_.find(name);
+    return i != properties_.end() ?
+      std::optional<_variant_t>{i->second} : std::nullopt;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::map<std::wstring, _variant_t, detail::Iless> properties_;
+};
+
+// -----------------------------------------------------------------------------
+// Viewer
+// -----------------------------------------------------------------------------
+
+/// The data of the viewer.
+struct Viewer_data final {
+  bool is_smart_sizing{};
+  std::wstring disconnected_text;
+  long color_depth{24};
+};
+
+/**
+ * @brief The fake of `IRDPSRAPIViewer` connectable to the open
+ * `Sharing_session` by the connection string of its invitation.
+ *
+ * @details `Connect()` succeeds for any well-formed connection string. The
+ * result is reported by the events (fired synchronously on the calling
+ * thread): `OnViewerConnected` and `OnViewerAuthenticated` on success,
+ * `OnViewerConnectFailed` if there is no such a session, the invitation is
+ * revoked, the password is wrong or the attendee limit is reached.
+ */
+class Viewer final : public Object<IRDPSRAPIViewer,
+  IConnectionPointContainer> {
+public:
+  /// The constructor.
+  Viewer()
+    : events_{make<Events>(*this)}
+  {}
+
+  HRESULT Connect(BSTR connection_string, BSTR name, BSTR password) override;
+
+  HRESULT Disconnect() override;
+
+  HRESULT get_Attendees(IRDPSRAPIAttendeeManager** const result) override
+  {
+    if (result)
+      *result = nullptr;
+    return E_NOTIMPL;
+  }
+
+  HRESULT get_Invitations(IRDPSRAPIInvitationManager** const result) override
+  {
+    if (result)
+      *result = nullptr;
+    return E_NOTIMPL;
+  }
+
+  HRESULT put_SmartSizing(const VARIANT_BOOL value) override
+  {
+    return properties_.put("IRDPSRAPIViewer::put_SmartSizing",
+      &Viewer_data::is_smart_sizing, value);
+  }
+
+  HRESULT get_SmartSizing(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("IRDPSRAPIViewer::get_SmartSizing",
+      &Viewer_data::is_smart_sizing, result);
+  }
+
+  /// Fires `OnControlLevelChangeRequest` of the session.
+  HRESULT RequestControl(CTRL_LEVEL level) override;
+
+  HRESULT put_DisconnectedText(const BSTR value) override
+  {
+    return properties_.put("IRDPSRAPIViewer::put_DisconnectedText",
+      &Viewer_data::disconnected_text, value);
+  }
+
+  HRESULT get_DisconnectedText(BSTR* const result) override
+  {
+    return properties_.get("IRDPSRAPIViewer::get_DisconnectedText",
+      &Viewer_data::disconnected_text, result);
+  }
+
+  HRESULT RequestColorDepthChange(const long bpp) override
+  {
+    if (bpp != 8 && bpp != 15 && bpp != 16 && bpp != 24 && bpp != 32)
+      return E_INVALIDARG;
+    return properties_.put("IRDPSRAPIViewer::RequestColorDepthChange",
+      &Viewer_data::color_depth, bpp);
+  }
+
+  HRESULT get_Properties(IRDPSRAPISessionProperties** const result) override
+  {
+    if (const auto err = enter("IRDPSRAPIViewer::get_Properties");
+      err != S_OK)
+      return err;
+    return get(session_properties_, result);
+  }
+
+  // IConnectionPointContainer overrides
+
+  HRESULT EnumConnectionPoints(IEnumConnectionPoints** const result) override
+  {
+    if (result)
+      *result = nullptr;
+    return E_NOTIMPL;
+  }
+
+  HRESULT FindConnectionPoint(REFIID id,
+    IConnectionPoint** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    return id == __uuidof(_IRDPSessionEvents) ? get(events_, result) :
+      CONNECT_E_NOCONNECTION;
+  }
+
+  /// @returns The connection point of the events.
+  Events& events() const noexcept
+  {
+    return *events_;
+  }
+
+  /// @returns The identifier of the attendee if connected.
+  std::optional<long> attendee_id() const
+  {
+    const std::lock_guard lg{mutex_};
+    return connection_ ?
+      std::optional<long>{connection_->attendee_id} : std::nullopt;
+  }
+
+  /// Fires `OnViewerDisconnected` if connected.
+  void disconnected()
+  {
+    if (reset_connection())
+      events_->fire(DISPID_RDPSRAPI_EVENT_ON_VIEWER_DISCONNECTED);
+  }
+
+private:
+  struct Connection final {
+    long port{};
+    long attendee_id{};
+  };
+
+  const Ref<Events> events_;
+  const Ref<Session_properties> session_properties_{
+    make<Session_properties>()};
+  Property_store<Viewer_data> properties_;
+  mutable std::mutex mutex_;
+  std::optional<Connection> connection_;
+
+  std::optional<Connection> reset_connection()
+  {
+    const std::lock_guard lg{mutex_};
+    return std::exchange(connection_, std::nullopt);
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Attendee
+// -----------------------------------------------------------------------------
+
+/// The data of attendee.
+struct Attendee_data final {
+  long id{};
+  std::wstring remote_name;
+  CTRL_LEVEL control_level{CTRL_LEVEL_VIEW};
+  Ref<Invitation> invitation;
+  long flags{};
+  Ref<Tcp_connection_info> connectivity_info;
+};
+
+/// The fake of `IRDPSRAPIAttendee` which is the connected `Viewer`.
+class Attendee final : public Object<IRDPSRAPIAttendee> {
+public:
+  /// @param port The port of the session.
+  Attendee(const long port, Attendee_data data, Ref<Viewer> viewer)
+    : port_{port}
+    , id_{data.id}
+    , viewer_{std::move(viewer)}
+    , properties_{std::move(data)}
+  {}
+
+  HRESULT get_Id(long* const result) override
+  {
+    return properties_.get("IRDPSRAPIAttendee::get_Id", &Attendee_data::id,
+      result);
+  }
+
+  HRESULT get_RemoteName(BSTR* const result) override
+  {
+    return properties_.get("IRDPSRAPIAttendee::get_RemoteName",
+      &Attendee_data::remote_name, result);
+  }
+
+  HRESULT get_ControlLevel(CTRL_LEVEL* const result) override
+  {
+    return properties_.get("IRDPSRAPIAttendee::get_ControlLevel",
+      &Attendee_data::control_level, result);
+  }
+
+  HRESULT put_ControlLevel(const CTRL_LEVEL value) override
+  {
+    if (value < CTRL_LEVEL_MIN || value > CTRL_LEVEL_MAX)
+      return E_INVALIDARG;
+    return properties_.put("IRDPSRAPIAttendee::put_ControlLevel",
+      &Attendee_data::control_level, value);
+  }
+
+  HRESULT get_Invitation(IRDPSRAPIInvitation** const result) override
+  {
+    return properties_.get("IRDPSRAPIAttendee::get_Invitation",
+      &Attendee_data::invitation, result);
+  }
+
+  /// Disconnects the attendee with `ATTENDEE_DISCONNECT_REASON_APP`.
+  HRESULT TerminateConnection() override;
+
+  HRESULT get_Flags(long* const result) override
+  {
+    return properties_.get("IRDPSRAPIAttendee::get_Flags",
+      &Attendee_data::flags, result);
+  }
+
+  HRESULT get_ConnectivityInfo(IUnknown** const result) override
+  {
+    return properties_.get("IRDPSRAPIAttendee::get_ConnectivityInfo",
+      &Attendee_data::connectivity_info, result);
+  }
+
+  /// @returns The identifier.
+  long id() const noexcept
+  {
+    return id_;
+  }
+
+  /// @returns The viewer.
+  Viewer& viewer() const noexcept
+  {
+    return *viewer_;
+  }
+
+  /// @returns The copy of the data.
+  Attendee_data data() const
+  {
+    return properties_.data();
+  }
+
+private:
+  const long port_{};
+  const long id_{};
+  const Ref<Viewer> viewer_;
+  Property_store<Attendee_data> properties_;
+};
+
+/// The data of disconnected attendee.
+struct Disconnect_data final {
+  Ref<Attendee> attendee;
+  ATTENDEE_DISCONNECT_REASON reason{};
+  long code{};
+};
+
+/// The fake of `IRDPSRAPIAttendeeDisconnectInfo`.
+class Attendee_disconnect_info final :
+  public Object<IRDPSRAPIAttendeeDisconnectInfo> {
+public:
+  explicit Attendee_disconnect_info(Disconnect_data data)
+    : properties_{std::move(data)}
+  {}
+
+  HRESULT get_Attendee(IRDPSRAPIAttendee** const result) override
+  {
+    return properties_.get("IRDPSRAPIAttendeeDisconnectInfo::get_Attendee",
+      &Disconnect_data::attendee, result);
+  }
+
+  HRESULT get_Reason(ATTENDEE_DISCONNECT_REASON* const result) override
+  {
+    return properties_.get("IRDPSRAPIAttendeeDisconnectInfo::get_Reason",
+      &Disconnect_data::reason, result);
+  }
+
+  HRESULT get_Code(long* const result) override
+  {
+    return properties_.get("IRDPSRAPIAttendeeDisconnectInfo::get_Code",
+      &Disconnect_data::code, result);
+  }
+
+private:
+  Property_store<Disconnect_data> properties_;
+};
+
+// -----------------------------------------------------------------------------
+// Sharing_session
+// -----------------------------------------------------------------------------
+
+/// The data of the sharing session.
+struct Session_data final {
+  bool is_open{};
+  bool is_paused{};
+  /// The port assigned by `store()` when opened.
+  long port{};
+  long color_depth{24};
+  long left{};
+  long top{};
+  long right{1920};
+  long bottom{1080};
+  std::vector<Ref<Invitation>> invitations;
+  std::vector<Ref<Attendee>> attendees;
+  long next_attendee_id{1};
+  long next_peer_port{50000};
+};
+
+/**
+ * @brief The fake of `IRDPSRAPISharingSession`.
+ *
+ * @details The events are fired synchronously on the calling thread. The
+ * open session is referenced by `store()` until closed.
+ */
+class Sharing_session final : public Object<IRDPSRAPISharingSession,
+  IConnectionPointContainer> {
+public:
+  /// The constructor.
+  Sharing_session()
+    : events_{make<Events>(*this)}
+  {}
+
+  HRESULT Open() override;
+
+  /// Disconnects the attendees with `ATTENDEE_DISCONNECT_REASON_SRV`.
+  HRESULT Close() override;
+
+  HRESULT put_ColorDepth(const long value) override
+  {
+    if (value != 8 && value != 16 && value != 24 && value != 32)
+      return E_INVALIDARG;
+    return properties_.put("IRDPSRAPISharingSession::put_ColorDepth",
+      &Session_data::color_depth, value);
+  }
+
+  HRESULT get_ColorDepth(long* const result) override
+  {
+    return properties_.get("IRDPSRAPISharingSession::get_ColorDepth",
+      &Session_data::color_depth, result);
+  }
+
+  HRESULT get_Properties(IRDPSRAPISessionProperties** const result) override
+  {
+    if (const auto err = enter("IRDPSRAPISharingSession::get_Properties");
+      err != S_OK)
+      return err;
+    return get(session_properties_, result);
+  }
+
+  HRESULT get_Attendees(IRDPSRAPIAttendeeManager** result) override;
+
+  HRESULT get_Invitations(IRDPSRAPIInvitationManager** result) override;
+
+  HRESULT Pause() override
+  {
+    return set_paused("IRDPSRAPISharingSession::Pause", true);
+  }
+
+  HRESULT Resume() override
+  {
+    return set_paused("IRDPSRAPISharingSession::Resume", false);
+  }
+
+  HRESULT ConnectToClient(BSTR) override
+  {
+    return E_NOTIMPL;
+  }
+
+  HRESULT SetDesktopSharedRect(const long left, const long top,
+    const long right, const long bottom) override
+  {
+    if (const auto err = enter(
+        "IRDPSRAPISharingSession::SetDesktopSharedRect"); err != S_OK)
+      return err;
+    else if (left >= right || top >= bottom)
+      return E_INVALIDARG;
+    properties_.with([=](auto& data)
+    {
+      data.left = left;
+      data.top = top;
+      data.right = right;
+      data.bottom = bottom;
+    });
+    return S_OK;
+  }
+
+  HRESULT GetDesktopSharedRect(long* const left, long* const top,
+    long* const right, long* const bottom) override
+  {
+    if (!left || !top || !right || !bottom)
+      return E_POINTER;
+    if (const auto err = enter(
+        "IRDPSRAPISharingSession::GetDesktopSharedRect"); err != S_OK)
+      return err;
+    properties_.with([=](const auto& data)
+    {
+      *left = data.left;
+      *top = data.top;
+      *right = data.right;
+      *bottom = data.bottom;
+    });
+    return S_OK;
+  }
+
+  // IConnectionPointContainer overrides
+
+  HRESULT EnumConnectionPoints(IEnumConnectionPoints** const result) override
+  {
+    if (result)
+      *result = nullptr;
+    return E_NOTIMPL;
+  }
+
+  HRESULT FindConnectionPoint(REFIID id,
+    IConnectionPoint** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    return id == __uuidof(_IRDPSessionEvents) ? get(events_, result) :
+      CONNECT_E_NOCONNECTION;
+  }
+
+  /// @returns The connection point of the events.
+  Events& events() const noexcept
+  {
+    return *events_;
+  }
+
+  /**
+   * @brief Creates the invitation of the open session.
+   *
+   * @returns `E_UNEXPECTED` if the session is not open.
+   */
+  HRESULT create_invitation(std::wstring group_name, std::wstring password,
+    const long attendee_limit, Ref<Invitation>& result)
+  {
+    if (attendee_limit < 0)
+      return E_INVALIDARG;
+    return properties_.with([&](auto& data)
+    {
+      if (!data.is_open)
+        return E_UNEXPECTED;
+      auto ticket = L"Ticket" + std::to_wstring(data.invitations.size() + 1);
+      auto connection_string = std::wstring{L"<E><A KH=\"fake\" ID=\""}
+        .append(ticket).append(L"\"/><C><T ID=\"1\" SID=\"0\"><L P=\"")
+        .append(std::to_wstring(data.port))
+        .append(L"\" N=\"127.0.0.1\"/></T></C></E>");
+      result = make<Invitation>(Invitation_data{std::move(ticket),
+        std::move(connection_string), std::move(group_name),
+        std::move(password), attendee_limit, false});
+      data.invitations.push_back(result);
+      return S_OK;
+    });
+  }
+
+  /// @returns The snapshot of the invitations.
+  std::vector<Ref<Invitation>> invitations() const
+  {
+    return properties_.data().invitations;
+  }
+
+  /// @returns The snapshot of the attendees.
+  std::vector<Ref<Attendee>> attendees() const
+  {
+    return properties_.data().attendees;
+  }
+
+  /**
+   * @brief Connects `viewer` as the new attendee by using the invitation
+   * identified by `ticket` and fires `OnAttendeeConnected`.
+   *
+   * @returns `E_ACCESSDENIED` if the invitation is not found or revoked, the
+   * password is wrong or the attendee limit is reached.
+   */
+  HRESULT connect(Ref<Viewer> viewer, const std::wstring_view ticket,
+    std::wstring name, const std::wstring_view password,
+    Ref<Attendee>& result)
+  {
+    const auto err = properties_.with([&](auto& data)
+    {
+      if (!data.is_open)
+        return E_UNEXPECTED;
+      const auto invitation = std::find_if(data.invitations.begin(),
+        data.invitations.end(),
+        [ticket](const auto& i){return i->data().ticket == ticket;});
+      if (invitation == data.invitations.end())
+        return E_ACCESSDENIED;
+      const auto invitation_data = (*invitation)->data();
+      const auto attendee_count = std::count_if(data.attendees.begin(),
+        data.attendees.end(), [&invitation](const auto& attendee)
+        {
+          return attendee->data().invitation.get() == invitation->get();
+        });
+      if (invitation_data.is_revoked || invitation_data.password != password
+        || attendee_count >= invitation_data.attendee_limit)
+        return E_ACCESSDENIED;
+
+      auto connectivity_info = make<Tcp_connection_info>(Tcp_data{2,
+        data.port, L"127.0.0.1", data.next_peer_port++, L"127.0.0.1"});
+      result = make<Attendee>(data.port, Attendee_data{
+        data.next_attendee_id++, std::move(name), CTRL_LEVEL_VIEW,
+        *invitation, 0, std::move(connectivity_info)}, std::move(viewer));
+      data.attendees.push_back(result);
+      return S_OK;
+    });
+    if (err == S_OK)
+      events_->fire(DISPID_RDPSRAPI_EVENT_ON_ATTENDEE_CONNECTED,
+        {detail::dispatch(result.get())});
+    return err;
+  }
+
+  /**
+   * @brief Disconnects the attendee `id`, fires `OnAttendeeDisconnected`
+   * and notifies the viewer.
+   *
+   * @returns `false` if there is no such an attendee.
+   */
+  bool disconnect(const long id, const ATTENDEE_DISCONNECT_REASON reason,
+    const long code = 0)
+  {
+    Ref<Attendee> attendee;
+    properties_.with([id, &attendee](auto& data)
+    {
+      const auto i = std::find_if(data.attendees.begin(),
+        data.attendees.end(), [id](const auto& a){return a->id() == id;});
+      if (i != data.attendees.end()) {
+        attendee = std::move(*i);
+        data.attendees.erase(i);
+      }
+    });
+    if (!attendee)
+      return false;
+
+    const auto info = make<Attendee_disconnect_info>(Disconnect_data{
+      attendee, reason, code});
+    events_->fire(DISPID_RDPSRAPI_EVENT_ON_ATTENDEE_DISCONNECTED,
+      {detail::dispatch(info.get())});
+    attendee->viewer().disconnected();
+    return true;
+  }
+
+  /**
+   * @brief Fires `OnControlLevelChangeRequest` of the attendee `id`.
+   *
+   * @returns `false` if there is no such an attendee.
+   */
+  bool request_control(const long id, const CTRL_LEVEL level)
+  {
+    Ref<Attendee> attendee;
+    for (auto& a : attendees()) {
+      if (a->id() == id)
+        attendee = std::move(a);
+    }
+    if (!attendee)
+      return false;
+
+    VARIANT requested_level{};
+    requested_level.vt = VT_I4;
+    requested_level.lVal = level;
+    events_->fire(DISPID_RDPSRAPI_EVENT_ON_CTRLLEVEL_CHANGE_REQUEST,
+      {requested_level, detail::dispatch(attendee.get())});
+    return true;
+  }
+
+private:
+  const Ref<Events> events_;
+  const Ref<Session_properties> session_properties_{
+    make<Session_properties>()};
+  Property_store<Session_data> properties_;
+
+  HRESULT set_paused(const std::string_view method, const bool value)
+  {
+    if (const auto err = enter(method); err != S_OK)
+      return err;
+    const auto err = properties_.with([value](auto& data)
+    {
+      if (!data.is_open)
+        return E_UNEXPECTED;
+      data.is_paused = value;
+      return S_OK;
+    });
+    if (err == S_OK)
+      events_->fire(value ? DISPID_RDPSRAPI_EVENT_ON_GRAPHICS_STREAM_PAUSED :
+        DISPID_RDPSRAPI_EVENT_ON_GRAPHICS_STREAM_RESUMED);
+    return err;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Managers
+// -----------------------------------------------------------------------------
+
+/// The fake of `IRDPSRAPIInvitationManager` which is the view of session.
+class Invitation_manager final : public Object<IRDPSRAPIInvitationManager> {
+public:
+  explicit Invitation_manager(Ref<Sharing_session> session)
+    : session_{std::move(session)}
+  {}
+
+  HRESULT get__NewEnum(IUnknown** const result) override
+  {
+    return new_enum(session_->invitations(), result);
+  }
+
+  /// @param item Either 0-based index or group name.
+  HRESULT get_Item(const VARIANT item,
+    IRDPSRAPIInvitation** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("IRDPSRAPIInvitationManager::get_Item");
+      err != S_OK)
+      return err;
+
+    const auto invitations = session_->invitations();
+    if (item.vt == VT_BSTR) {
+      const auto group_name = to_wstring(item);
+      const auto i = std::find_if(invitations.begin(), invitations.end(),
+        [&group_name](const auto& invitation)
+        {
+          return invitation->data().group_name == group_name;
+        });
+      return i != invitations.end() ? get(*i, result) : E_INVALIDARG;
+    }
+
+    VARIANT index{};
+    if (VariantChangeType(&index, &item, 0, VT_I4) != S_OK
+      || index.lVal < 0
+      || static_cast<std::size_t>(index.lVal) >= invitations.size())
+      return E_INVALIDARG;
+    return get(invitations[index.lVal], result);
+  }
+
+  HRESULT get_Count(long* const result) override
+  {
+    if (const auto err = enter("IRDPSRAPIInvitationManager::get_Count");
+      err != S_OK)
+      return err;
+    return get(session_->invitations().size(), result);
+  }
+
+  HRESULT CreateInvitation(BSTR, const BSTR group_name, const BSTR password,
+    const long attendee_limit, IRDPSRAPIInvitation** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter(
+        "IRDPSRAPIInvitationManager::CreateInvitation"); err != S_OK)
+      return err;
+    Ref<Invitation> invitation;
+    const auto err = session_->create_invitation(
+      {group_name ? group_name : L"", SysStringLen(group_name)},
+      {password ? password : L"", SysStringLen(password)},
+      attendee_limit, invitation);
+    return err == S_OK ? get(invitation, result) : err;
+  }
+
+private:
+  const Ref<Sharing_session> session_;
+};
+
+/// The fake of `IRDPSRAPIAttendeeManager` which is the view of session.
+class Attendee_manager final : public Object<IRDPSRAPIAttendeeManager> {
+public:
+  explicit Attendee_manager(Ref<Sharing_session> session)
+    : session_{std::move(session)}
+  {}
+
+  HRESULT get__NewEnum(IUnknown** const result) override
+  {
+    return new_enum(session_->attendees(), result);
+  }
+
+  /// @param id The identifier of attendee.
+  HRESULT get_Item(const long id, IRDPSRAPIAttendee** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("IRDPSRAPIAttendeeManager::get_Item");
+      err != S_OK)
+      return err;
+    for (const auto& attendee : session_->attendees()) {
+      if (attendee->id() == id)
+        return get(attendee, result);
+    }
+    return E_INVALIDARG;
+  }
+
+  HRESULT get_Count(long* const result) override
+  {
+    if (const auto err = enter("IRDPSRAPIAttendeeManager::get_Count");
+      err != S_OK)
+      return err;
+    return get(session_->attendees().size(), result);
+  }
+
+private:
+  const Ref<Sharing_session> session_;
+};
+
+// -----------------------------------------------------------------------------
+// Store
+// -----------------------------------------------------------------------------
+
+/// The open sharing sessions by their ports.
+class Store final {
+public:
+  /// Forgets all the sessions.
+  void clear()
+  {
+    std::map<long, Ref<Sharing_session>> sessions;
+    const std::lock_guard lg{mutex_};
+    sessions.swap(sessions_);
+  }
+
+  /// @returns The port assigned to the opened `session`.
+  long open(Ref<Sharing_session> session)
+  {
+    const std::lock_guard lg{mutex_};
+    const auto result = next_port_++;
+    sessions_.emplace(result, std::move(session));
+    return result;
+  }
+
+  /// @returns The closed session, or null reference.
+  Ref<Sharing_session> close(const long port)
+  {
+    const std::lock_guard lg{mutex_};
+    auto node = sessions_.extract(port);
+    return node ? std::move(node.mapped()) : Ref<Sharing_session>{};
+  }
+
+  /// @returns The open session, or null reference.
+  Ref<Sharing_session> session(const long port) const
+  {
+    const std::lock_guard lg{mutex_};
+    const auto i = sessions_.find(port);
+    return i != sessions_.end() ? i->second : Ref<Sharing_session>{};
+  }
+
+  /// @returns The number of the open sessions.
+  std::size_t session_count() const
+  {
+    const std::lock_guard lg{mutex_};
+    return sessions_.size();
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::map<long, Ref<Sharing_session>> sessions_;
+  long next_port_{3389};
+};
+
+/// @returns The instance of the store.
+inline Store& store()
+{
+  static Store result;
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Viewer, Attendee and Sharing_session implementation
+// -----------------------------------------------------------------------------
+
+inline HRESULT Viewer::Connect(const BSTR connection_string, const BSTR name,
+  const BSTR password)
+{
+  if (const auto err = enter("IRDPSRAPIViewer::Connect"); err != S_OK)
+    return err;
+
+  const std::wstring_view str{connection_string ? connection_string : L"",
+    SysStringLen(connection_string)};
+  const std::wstring port_text{detail::attribute(str, L"P")};
+  const auto ticket = detail::attribute(str, L"ID");
+  wchar_t* end{};
+  const auto port = std::wcstol(port_text.c_str(), &end, 10);
+  if (port_text.empty() || *end || ticket.empty())
+    return E_INVALIDARG;
+
+  {
+    const std::lock_guard lg{mutex_};
+    if (connection_)
+      return E_UNEXPECTED;
+  }
+
+  AddRef();
+  Ref<Viewer> self{this};
+  Ref<Attendee> attendee;
+  const auto session = store().session(port);
+  const auto err = session ? session->connect(std::move(self), ticket,
+    {name ? name : L"", SysStringLen(name)},
+    {password ? password : L"", SysStringLen(password)},
+    attendee) : E_UNEXPECTED;
+  if (err == S_OK) {
+    {
+      const std::lock_guard lg{mutex_};
+      connection_ = Connection{port, attendee->id()};
+    }
+    events_->fire(DISPID_RDPSRAPI_EVENT_ON_VIEWER_CONNECTED);
+    events_->fire(DISPID_RDPSRAPI_EVENT_ON_VIEWER_AUTHENTICATED);
+  } else
+    events_->fire(DISPID_RDPSRAPI_EVENT_ON_VIEWER_CONNECTFAILED);
+  return S_OK;
+}
+
+inline HRESULT Viewer::Disconnect()
+{
+  if (const auto err = enter("IRDPSRAPIViewer::Disconnect"); err != S_OK)
+    return err;
+
+  std::optional<Connection> connection;
+  {
+    const std::lock_guard lg{mutex_};
+    connection = connection_;
+  }
+  if (connection) {
+    const auto session = store().session(connection->port);
+    if (!session || !session->disconnect(connection->attendee_id,
+        ATTENDEE_DISCONNECT_REASON_CLI))
+      disconnected();
+  }
+  return S_OK;
+}
+
+inline HRESULT Viewer::RequestControl(const CTRL_LEVEL level)
+{
+  if (const auto err = enter("IRDPSRAPIViewer::RequestControl"); err != S_OK)
+    return err;
+  else if (level < CTRL_LEVEL_MIN || level > CTRL_LEVEL_MAX)
+    return E_INVALIDARG;
+
+  std::optional<Connection> connection;
+  {
+    const std::lock_guard lg{mutex_};
+    connection = connection_;
+  }
+  const auto session = connection ?
+    store().session(connection->port) : Ref<Sharing_session>{};
+  return session && session->request_control(connection->attendee_id,
+    level) ? S_OK : E_UNEXPECTED;
+}
+
+inline HRESULT Attendee::TerminateConnection()
+{
+  if (const auto err = enter("IRDPSRAPIAttendee::TerminateConnection");
+    err != S_OK)
+    return err;
+  const auto session = store().session(port_);
+  return session && session->disconnect(id_, ATTENDEE_DISCONNECT_REASON_APP) ?
+    S_OK : E_UNEXPECTED;
+}
+
+inline HRESULT Sharing_session::Open()
+{
+  if (const auto err = enter("IRDPSRAPISharingSession::Open"); err != S_OK)
+    return err;
+  else if (properties_.with([](const auto& data){return data.is_open;}))
+    return S_OK;
+
+  AddRef();
+  const auto port = store().open(Ref<Sharing_session>{this});
+  properties_.with([port](auto& data)
+  {
+    data.is_open = true;
+    data.port = port;
+  });
+  return S_OK;
+}
+
+inline HRESULT Sharing_session::Close()
+{
+  if (const auto err = enter("IRDPSRAPISharingSession::Close"); err != S_OK)
+    return err;
+
+  for (const auto& attendee : attendees())
+    disconnect(attendee->id(), ATTENDEE_DISCONNECT_REASON_SRV);
+  const auto port = properties_.with([](auto& data)
+  {
+    data.is_open = false;
+    data.is_paused = false;
+    return std::exchange(data.port, 0);
+  });
+  // The caller owns another reference, so this one is not the last.
+  store().close(port);
+  return S_OK;
+}
+
+inline HRESULT
+Sharing_session::get_Attendees(IRDPSRAPIAttendeeManager** const result)
+{
+  if (const auto err = enter("IRDPSRAPISharingSession::get_Attendees");
+    err != S_OK)
+    return err;
+  AddRef();
+  return get(make<Attendee_manager>(Ref<Sharing_session>{this}), result);
+}
+
+inline HRESULT
+Sharing_session::get_Invitations(IRDPSRAPIInvitationManager** const result)
+{
+  if (const auto err = enter("IRDPSRAPISharingSession::get_Invitations");
+    err != S_OK)
+    return err;
+  AddRef();
+  return get(make<Invitation_manager>(Ref<Sharing_session>{this}), result);
+}
+
+// -----------------------------------------------------------------------------
+// Registration
+// -----------------------------------------------------------------------------
+
+/// Registers the classes of the fake Remote Desktop Sharing.
+inline void register_classes()
+{
+  register_class(__uuidof(RDPViewer), [](REFIID id, void** const result)
+  {
+    return make<Viewer>()->QueryInterface(id, result);
+  });
+  register_class(__uuidof(RDPSession), [](REFIID id, void** const result)
+  {
+    return make<Sharing_session>()->QueryInterface(id, result);
+  });
+}
+
+} // namespace dmitigr::wincom::fake::rdp
@@ -0,0 +1,906 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "com.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * The portable subset of the COM runtime and of Win32 used by the wrappers:
+ * the apartments, the class registry (`CoCreateInstance()`), the call
+ * cancellation, the message filters, the events and the waits. The calls
+ * of the fake objects are delayed and failed as configured by
+ * `dmitigr::wincom::fake::configure_fault()`.
+ *
+ * There are no message queues and no marshaling: the objects are called
+ * directly on the calling thread.
+ */
+
+// -----------------------------------------------------------------------------
+// Win32
+// -----------------------------------------------------------------------------
+
+inline constexpr DWORD INFINITE{0xFFFFFFFF};
+inline constexpr DWORD WAIT_OBJECT_0{0};
+inline constexpr DWORD WAIT_ABANDONED_0{0x80};
+inline constexpr DWORD WAIT_TIMEOUT{258};
+inline constexpr DWORD WAIT_FAILED{0xFFFFFFFF};
+inline constexpr DWORD MAXIMUM_WAIT_OBJECTS{64};
+inline constexpr DWORD QS_ALLINPUT{0x04FF};
+inline constexpr DWORD MWMO_WAITALL{1};
+inline constexpr DWORD MWMO_ALERTABLE{2};
+inline constexpr DWORD MWMO_INPUTAVAILABLE{4};
+inline constexpr UINT PM_NOREMOVE{0};
+inline constexpr UINT PM_REMOVE{1};
+
+struct POINT final {
+  LONG x;
+  LONG y;
+};
+
+struct MSG final {
+  HWND hwnd;
+  UINT message;
+  WPARAM wParam;
+  LPARAM lParam;
+  DWORD time;
+  POINT pt;
+};
+using LPMSG = MSG*;
+
+struct SECURITY_ATTRIBUTES;
+using LPSECURITY_ATTRIBUTES = SECURITY_ATTRIBUTES*;
+using PSECURITY_DESCRIPTOR = void*;
+
+namespace dmitigr::wincom::fake::detail {
+
+inline thread_local DWORD last_error;
+
+/// The event of `CreateEventW()`.
+struct Event final {
+  bool is_manual_reset{};
+  bool is_signaled{};
+};
+
+/// The lock and the condition of all the events.
+struct Event_hub final {
+  std::mutex mutex;
+  std::condition_variable cond;
+};
+
+inline Event_hub& event_hub()
+{
+  static Event_hub result;
+  return result;
+}
+
+/**
+ * @returns The index of the signaled event of `handles` (or `0` if
+ * `wait_all`), or `count` if none (or not all). The signaled auto-reset
+ * events are reset.
+ *
+ * @par Requires
+ * The lock of `event_hub()`.
+ */
+inline DWORD consume_signaled(const DWORD count, const HANDLE* const handles,
+  const bool wait_all) noexcept
+{
+  const auto event = [handles](const DWORD i) noexcept
+  {
+    return static_cast<Event*>(handles[i]);
+  };
+  const auto consume = [](Event* const e) noexcept
+  {
+    if (!e->is_manual_reset)
+      e->is_signaled = false;
+  };
+
+  if (wait_all) {
+    for (DWORD i{}; i < count; ++i) {
+      if (!event(i)->is_signaled)
+        return count;
+    }
+    for (DWORD i{}; i < count; ++i)
+      consume(event(i));
+    return count ? 0 : count;
+  }
+
+  for (DWORD i{}; i < count; ++i) {
+    if (event(i)->is_signaled) {
+      consume(event(i));
+      return i;
+    }
+  }
+  return count;
+}
+
+/// @returns `WAIT_OBJECT_0 + index`, `WAIT_TIMEOUT` or `WAIT_FAILED`.
+inline DWORD wait_events(const DWORD count, const HANDLE* const handles,
+  const bool wait_all, const DWORD milliseconds)
+{
+  if (count > MAXIMUM_WAIT_OBJECTS || (count && !handles)) {
+    last_error = ERROR_INVALID_PARAMETER;
+    return WAIT_FAILED;
+  }
+  for (DWORD i{}; i < count; ++i) {
+    if (!handles[i]) {
+      last_error = ERROR_INVALID_HANDLE;
+      return WAIT_FAILED;
+    }
+  }
+
+  auto& hub = event_hub();
+  DWORD index{count};
+  std::unique_lock lk{hub.mutex};
+  const auto is_ready = [&]
+  {
+    index = consume_signaled(count, handles, wait_all);
+    return index < count;
+  };
+  if (milliseconds == INFINITE) {
+    if (!count) {
+      last_error = ERROR_INVALID_PARAMETER;
+      return WAIT_FAILED;
+    }
+    hub.cond.wait(lk, is_ready);
+  } else if (!hub.cond.wait_for(lk, std::chrono::milliseconds{milliseconds},
+      is_ready))
+    return WAIT_TIMEOUT;
+  return WAIT_OBJECT_0 + index;
+}
+
+} // namespace dmitigr::wincom::fake::detail
+
+inline DWORD GetLastError() noexcept
+{
+  return dmitigr::wincom::fake::detail::last_error;
+}
+
+inline void SetLastError(const DWORD code) noexcept
+{
+  dmitigr::wincom::fake::detail::last_error = code;
+}
+
+inline DWORD GetCurrentThreadId() noexcept
+{
+  static std::atomic<DWORD> counter;
+  thread_local const DWORD result{counter.fetch_add(1,
+      std::memory_order_relaxed) + 1};
+  return result;
+}
+
+inline void Sleep(const DWORD milliseconds)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds{milliseconds});
+}
+
+inline HANDLE CreateEventW(LPSECURITY_ATTRIBUTES, const BOOL manual_reset,
+  const BOOL initial_state, LPCWSTR)
+{
+  using dmitigr::wincom::fake::detail::Event;
+  return new(std::nothrow) Event{manual_reset != FALSE,
+    initial_state != FALSE};
+}
+
+inline BOOL CloseHandle(const HANDLE handle) noexcept
+{
+  using namespace dmitigr::wincom::fake::detail;
+  if (!handle) {
+    last_error = ERROR_INVALID_HANDLE;
+    return FALSE;
+  }
+  delete static_cast<Event*>(handle);
+  return TRUE;
+}
+
+inline BOOL SetEvent(const HANDLE handle)
+{
+  using namespace dmitigr::wincom::fake::detail;
+  if (!handle) {
+    last_error = ERROR_INVALID_HANDLE;
+    return FALSE;
+  }
+  auto& hub = event_hub();
+  {
+    const std::lock_guard lg{hub.mutex};
+    static_cast<Event*>(handle)->is_signaled = true;
+  }
+  hub.cond.notify_all();
+  return TRUE;
+}
+
+inline BOOL ResetEvent(const HANDLE handle)
+{
+  using namespace dmitigr::wincom::fake::detail;
+  if (!handle) {
+    last_error = ERROR_INVALID_HANDLE;
+    return FALSE;
+  }
+  const std::lock_guard lg{event_hub().mutex};
+  static_cast<Event*>(handle)->is_signaled = false;
+  return TRUE;
+}
+
+inline DWORD WaitForMultipleObjects(const DWORD count,
+  const HANDLE* const handles, const BOOL wait_all, const DWORD milliseconds)
+{
+  return dmitigr::wincom::fake::detail::wait_events(count, handles,
+    wait_all != FALSE, milliseconds);
+}
+
+inline DWORD WaitForSingleObject(const HANDLE handle,
+  const DWORD milliseconds)
+{
+  return WaitForMultipleObjects(1, &handle, FALSE, milliseconds);
+}
+
+/// @remarks There are no messages, so `wake_mask` is ignored.
+inline DWORD MsgWaitForMultipleObjectsEx(const DWORD count,
+  const HANDLE* const handles, const DWORD milliseconds, DWORD,
+  const DWORD flags)
+{
+  if (!count && milliseconds != INFINITE) {
+    Sleep(milliseconds);
+    return WAIT_TIMEOUT;
+  }
+  return dmitigr::wincom::fake::detail::wait_events(count, handles,
+    flags & MWMO_WAITALL, milliseconds);
+}
+
+inline BOOL PeekMessageW(const LPMSG, HWND, UINT, UINT, UINT) noexcept
+{
+  return FALSE;
+}
+
+inline BOOL TranslateMessage(const MSG*) noexcept
+{
+  return FALSE;
+}
+
+inline LRESULT DispatchMessageW(const MSG*) noexcept
+{
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+// COM constants
+// -----------------------------------------------------------------------------
+
+enum COINIT {
+  COINIT_MULTITHREADED = 0,
+  COINIT_APARTMENTTHREADED = 2,
+  COINIT_DISABLE_OLE1DDE = 4,
+  COINIT_SPEED_OVER_MEMORY = 8
+};
+
+enum CLSCTX {
+  CLSCTX_INPROC_SERVER = 1,
+  CLSCTX_INPROC_HANDLER = 2,
+  CLSCTX_LOCAL_SERVER = 4,
+  CLSCTX_REMOTE_SERVER = 16,
+  CLSCTX_ALL = CLSCTX_INPROC_SERVER | CLSCTX_INPROC_HANDLER
+    | CLSCTX_LOCAL_SERVER | CLSCTX_REMOTE_SERVER
+};
+
+enum COWAIT_FLAGS {
+  COWAIT_DEFAULT = 0,
+  COWAIT_WAITALL = 1,
+  COWAIT_ALERTABLE = 2,
+  COWAIT_INPUTAVAILABLE = 4,
+  COWAIT_DISPATCH_CALLS = 8,
+  COWAIT_DISPATCH_WINDOW_MESSAGES = 0x10
+};
+
+inline constexpr DWORD RPC_C_AUTHN_NONE{0};
+inline constexpr DWORD RPC_C_AUTHN_WINNT{10};
+inline constexpr DWORD RPC_C_AUTHN_GSS_KERBEROS{16};
+inline constexpr DWORD RPC_C_AUTHN_DEFAULT{0xFFFFFFFF};
+inline constexpr DWORD RPC_C_AUTHZ_NONE{0};
+inline constexpr DWORD RPC_C_AUTHZ_NAME{1};
+inline constexpr DWORD RPC_C_AUTHZ_DEFAULT{0xFFFFFFFF};
+inline constexpr DWORD RPC_C_AUTHN_LEVEL_DEFAULT{0};
+inline constexpr DWORD RPC_C_AUTHN_LEVEL_NONE{1};
+inline constexpr DWORD RPC_C_AUTHN_LEVEL_CONNECT{2};
+inline constexpr DWORD RPC_C_AUTHN_LEVEL_CALL{3};
+inline constexpr DWORD RPC_C_AUTHN_LEVEL_PKT{4};
+inline constexpr DWORD RPC_C_AUTHN_LEVEL_PKT_INTEGRITY{5};
+inline constexpr DWORD RPC_C_AUTHN_LEVEL_PKT_PRIVACY{6};
+inline constexpr DWORD RPC_C_IMP_LEVEL_DEFAULT{0};
+inline constexpr DWORD RPC_C_IMP_LEVEL_ANONYMOUS{1};
+inline constexpr DWORD RPC_C_IMP_LEVEL_IDENTIFY{2};
+inline constexpr DWORD RPC_C_IMP_LEVEL_IMPERSONATE{3};
+inline constexpr DWORD RPC_C_IMP_LEVEL_DELEGATE{4};
+inline constexpr DWORD EOAC_NONE{0};
+inline constexpr DWORD EOAC_DEFAULT{0x800};
+inline OLECHAR* const COLE_DEFAULT_PRINCIPAL{
+  reinterpret_cast<OLECHAR*>(static_cast<std::intptr_t>(-1))};
+
+struct SOLE_AUTHENTICATION_SERVICE final {
+  DWORD dwAuthnSvc;
+  DWORD dwAuthzSvc;
+  OLECHAR* pPrincipalName;
+  HRESULT hr;
+};
+
+struct SOLE_AUTHENTICATION_LIST final {
+  DWORD cAuthInfo;
+  void* aAuthInfo;
+};
+
+// -----------------------------------------------------------------------------
+// Fault injection
+// -----------------------------------------------------------------------------
+
+namespace dmitigr::wincom::fake {
+
+/// The behavior of the calls of a fake method.
+struct Fault final {
+  /// The delay of every call.
+  std::chrono::microseconds latency{};
+  /// The probability in [0, 1] of the failure of a call.
+  double failure_rate{};
+  /// The maximum number of failures, or zero for no limit.
+  std::uint64_t max_failures{};
+  /// The result of the failed calls.
+  HRESULT failure{HRESULT_FROM_WIN32(RPC_S_SERVER_UNAVAILABLE)};
+};
+
+namespace detail {
+
+/// The faults and the counters of the methods.
+class Fault_registry final {
+public:
+  void configure(std::string method, std::optional<Fault> fault)
+  {
+    const std::lock_guard lg{mutex_};
+    if (method == "*")
+      default_ = std::move(fault);
+    else
+      methods_[std::move(method)].fault = std::move(fault);
+  }
+
+  void reset()
+  {
+    const std::lock_guard lg{mutex_};
+    methods_.clear();
+    default_.reset();
+  }
+
+  std::uint64_t call_count(const std::string_view method) const
+  {
+    const std::lock_guard lg{mutex_};
+    const auto i = methods_.find(method);
+    return i != methods_.end() ? i->second.call_count : 0;
+  }
+
+  /// @returns The latency and the result of the call.
+  std::pair<std::chrono::microseconds, HRESULT>
+  enter(const std::string_view method)
+  {
+    thread_local std::minstd_rand engine{std::random_device{}()};
+    const std::lock_guard lg{mutex_};
+    auto i = methods_.find(method);
+    if (i == methods_.end())
+      i = methods_.emplace(std::string{method}, Method{}).first;
+    auto& state = i->second;
+    ++state.call_count;
+    const auto& fault = state.fault ? state.fault : default_;
+    if (!fault)
+      return {};
+
+    const bool is_failed = fault->failure_rate > 0 &&
+      (!fault->max_failures || state.failure_count < fault->max_failures) &&
+      std::uniform_real_distribution<>{}(engine) < fault->failure_rate;
+    if (is_failed)
+      ++state.failure_count;
+    return {fault->latency, is_failed ? fault->failure : S_OK};
+  }
+
+private:
+  struct Method final {
+    std::optional<Fault> fault;
+    std::uint64_t call_count{};
+    std::uint64_t failure_count{};
+  };
+
+  mutable std::mutex mutex_;
+  std::map<std::string, Method, std::less<>> methods_;
+  std::optional<Fault> default_;
+};
+
+inline Fault_registry& fault_registry()
+{
+  static Fault_registry result;
+  return result;
+}
+
+} // namespace detail
+
+/**
+ * @brief Configures the behavior of the calls of `method`.
+ *
+ * @param method The method name such as `"IWbemServices::ExecQuery"`, or
+ * `"*"` for the methods without own configuration.
+ * @param fault The behavior, or `std::nullopt` to reset it.
+ */
+inline void configure_fault(std::string method, std::optional<Fault> fault)
+{
+  detail::fault_registry().configure(std::move(method), std::move(fault));
+}
+
+/// Resets the behaviors and the counters of all the methods.
+inline void reset_faults()
+{
+  detail::fault_registry().reset();
+}
+
+/// @returns The number of calls of `method` since the last `reset_faults()`.
+inline std::uint64_t call_count(const std::string_view method)
+{
+  return detail::fault_registry().call_count(method);
+}
+
+// -----------------------------------------------------------------------------
+// Apartments
+// -----------------------------------------------------------------------------
+
+namespace detail {
+
+/// The COM state of a thread.
+struct Thread_state final {
+  /// The number of successful `CoInitializeEx()` not yet uninitialized.
+  unsigned init_count{};
+  bool is_sta{};
+  /// The number of `CoEnableCallCancellation()` not yet disabled.
+  unsigned cancel_count{};
+  IMessageFilter* message_filter{};
+};
+
+// Constant-initialized to be usable by the destructors of thread-locals.
+constinit inline thread_local Thread_state thread_state_instance;
+
+inline Thread_state& thread_state() noexcept
+{
+  return thread_state_instance;
+}
+
+/// The outgoing calls which can be cancelled by `CoCancelCall()`.
+class Call_registry final {
+public:
+  /// The call in progress.
+  struct Call final {
+    bool is_cancellable{};
+    bool is_cancelled{};
+  };
+
+  /// @returns `S_OK`, or `RPC_E_CALL_CANCELED` if cancelled.
+  HRESULT sleep(const std::chrono::microseconds duration)
+  {
+    const auto thread_id = GetCurrentThreadId();
+    std::unique_lock lk{mutex_};
+    auto& call = calls_[thread_id];
+    call = Call{thread_state().cancel_count > 0};
+    const bool is_cancelled = cond_.wait_for(lk, duration, [&call]
+    {
+      return call.is_cancelled;
+    });
+    calls_.erase(thread_id);
+    return is_cancelled ? RPC_E_CALL_CANCELED : S_OK;
+  }
+
+  HRESULT cancel(const DWORD thread_id)
+  {
+    {
+      const std::lock_guard lg{mutex_};
+      const auto i = calls_.find(thread_id);
+      if (i == calls_.end())
+        return RPC_E_CALL_COMPLETE;
+      else if (!i->second.is_cancellable)
+        return CO_E_CANCEL_DISABLED;
+      i->second.is_cancelled = true;
+    }
+    cond_.notify_all();
+    return S_OK;
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::map<DWORD, Call> calls_;
+};
+
+inline Call_registry& call_registry()
+{
+  static Call_registry result;
+  return result;
+}
+
+inline bool is_rejection(const HRESULT hr) noexcept
+{
+  return hr == RPC_E_SERVERCALL_RETRYLATER || hr == RPC_E_CALL_REJECTED;
+}
+
+} // namespace detail
+
+/**
+ * @brief Simulates the call of `method` of a fake object: delays it (the
+ * delay is cancellable by `CoCancelCall()`), and consults the message filter
+ * of the thread if the call is rejected.
+ *
+ * @returns `S_OK`, the configured failure, or `RPC_E_CALL_CANCELED`.
+ *
+ * @see configure_fault().
+ */
+inline HRESULT enter(const std::string_view method)
+{
+  const auto start = std::chrono::steady_clock::now();
+  while (true) {
+    const auto [latency, result] = detail::fault_registry().enter(method);
+    if (latency.count()) {
+      if (const auto err = detail::call_registry().sleep(latency); err != S_OK)
+        return err;
+    }
+
+    auto* const filter = detail::thread_state().message_filter;
+    if (!detail::is_rejection(result) || !filter)
+      return result;
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start);
+    const auto delay = filter->RetryRejectedCall(nullptr,
+      static_cast<DWORD>(elapsed.count()),
+      result == RPC_E_SERVERCALL_RETRYLATER ?
+      SERVERCALL_RETRYLATER : SERVERCALL_REJECTED);
+    if (delay == static_cast<DWORD>(-1))
+      return RPC_E_CALL_REJECTED;
+    else if (delay >= 100)
+      Sleep(delay);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Class registry
+// -----------------------------------------------------------------------------
+
+/// The factory of the instances of a class.
+using Class_factory = std::function<HRESULT(REFIID, void**)>;
+
+namespace detail {
+
+struct Guid_less final {
+  bool operator()(const GUID& lhs, const GUID& rhs) const noexcept
+  {
+    return std::memcmp(&lhs, &rhs, sizeof(GUID)) < 0;
+  }
+};
+
+class Class_registry final {
+public:
+  void add(const CLSID& id, Class_factory factory)
+  {
+    const std::lock_guard lg{mutex_};
+    if (factory)
+      factories_[id] = std::move(factory);
+    else
+      factories_.erase(id);
+  }
+
+  Class_factory find(const CLSID& id) const
+  {
+    const std::lock_guard lg{mutex_};
+    const auto i = factories_.find(id);
+    return i != factories_.end() ? i->second : Class_factory{};
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::map<CLSID, Class_factory, Guid_less> factories_;
+};
+
+inline Class_registry& class_registry()
+{
+  static Class_registry result;
+  return result;
+}
+
+} // namespace detail
+
+/**
+ * @brief Registers the class `id` to be created by `CoCreateInstance()`.
+ *
+ * @param factory The factory, or empty function to unregister the class.
+ */
+inline void register_class(const CLSID& id, Class_factory factory)
+{
+  detail::class_registry().add(id, std::move(factory));
+}
+
+} // namespace dmitigr::wincom::fake
+
+// -----------------------------------------------------------------------------
+// COM functions
+// -----------------------------------------------------------------------------
+
+inline HRESULT CoInitializeEx(LPVOID, const DWORD coinit)
+{
+  if (const auto err = dmitigr::wincom::fake::enter("CoInitializeEx");
+    err != S_OK)
+    return err;
+
+  auto& state = dmitigr::wincom::fake::detail::thread_state();
+  const bool is_sta = coinit & COINIT_APARTMENTTHREADED;
+  if (state.init_count && state.is_sta != is_sta)
+    return RPC_E_CHANGED_MODE;
+  state.is_sta = is_sta;
+  return state.init_count++ ? S_FALSE : S_OK;
+}
+
+inline HRESULT CoInitialize(const LPVOID reserved)
+{
+  return CoInitializeEx(reserved, COINIT_APARTMENTTHREADED);
+}
+
+inline void CoUninitialize()
+{
+  auto& state = dmitigr::wincom::fake::detail::thread_state();
+  if (state.init_count && !--state.init_count && state.message_filter) {
+    state.message_filter->Release();
+    state.message_filter = {};
+  }
+}
+
+inline HRESULT CoInitializeSecurity(PSECURITY_DESCRIPTOR, LONG,
+  SOLE_AUTHENTICATION_SERVICE*, void*, DWORD, DWORD, void*, DWORD, void*)
+{
+  static std::atomic_flag is_initialized;
+  if (!dmitigr::wincom::fake::detail::thread_state().init_count)
+    return CO_E_NOTINITIALIZED;
+  return is_initialized.test_and_set() ? RPC_E_TOO_LATE : S_OK;
+}
+
+inline HRESULT CoCreateInstance(REFCLSID id, const LPUNKNOWN outer, DWORD,
+  REFIID iid, LPVOID* const result)
+{
+  namespace fake = dmitigr::wincom::fake;
+  if (!result)
+    return E_POINTER;
+  *result = nullptr;
+  if (!fake::detail::thread_state().init_count)
+    return CO_E_NOTINITIALIZED;
+  else if (outer)
+    return CLASS_E_NOAGGREGATION;
+  const auto factory = fake::detail::class_registry().find(id);
+  return factory ? factory(iid, result) : REGDB_E_CLASSNOTREG;
+}
+
+inline HRESULT CoSetProxyBlanket(IUnknown* const proxy, const DWORD authn,
+  const DWORD authz, OLECHAR* const server_princ_name,
+  const DWORD authn_level, const DWORD imp_level,
+  const RPC_AUTH_IDENTITY_HANDLE auth_info, const DWORD capabilities)
+{
+  if (!proxy)
+    return E_INVALIDARG;
+  IClientSecurity* security{};
+  if (const auto err = proxy->QueryInterface(&security); err != S_OK)
+    return err;
+  const auto result = security->SetBlanket(proxy, authn, authz,
+    server_princ_name, authn_level, imp_level, auth_info, capabilities);
+  security->Release();
+  return result;
+}
+
+inline HRESULT CoRegisterMessageFilter(const LPMESSAGEFILTER filter,
+  LPMESSAGEFILTER* const previous)
+{
+  auto& state = dmitigr::wincom::fake::detail::thread_state();
+  if (!state.init_count || !state.is_sta)
+    return CO_E_NOT_SUPPORTED;
+  if (filter)
+    filter->AddRef();
+  if (previous)
+    *previous = state.message_filter;
+  else if (state.message_filter)
+    state.message_filter->Release();
+  state.message_filter = filter;
+  return S_OK;
+}
+
+inline HRESULT CoEnableCallCancellation(LPVOID)
+{
+  ++dmitigr::wincom::fake::detail::thread_state().cancel_count;
+  return S_OK;
+}
+
+inline HRESULT CoDisableCallCancellation(LPVOID)
+{
+  auto& state = dmitigr::wincom::fake::detail::thread_state();
+  if (!state.cancel_count)
+    return CO_E_CANCEL_DISABLED;
+  --state.cancel_count;
+  return S_OK;
+}
+
+/// @remarks The `timeout` is ignored: the cancellation is immediate.
+inline HRESULT CoCancelCall(const DWORD thread_id, ULONG)
+{
+  if (const auto err = dmitigr::wincom::fake::enter("CoCancelCall");
+    err != S_OK)
+    return err;
+  return dmitigr::wincom::fake::detail::call_registry().cancel(thread_id);
+}
+
+inline HRESULT CoWaitForMultipleHandles(const DWORD flags,
+  const DWORD milliseconds, const ULONG count, const HANDLE* const handles,
+  LPDWORD const index)
+{
+  if (!index)
+    return E_INVALIDARG;
+  else if (!count || !handles)
+    return E_INVALIDARG;
+  const auto result = dmitigr::wincom::fake::detail::wait_events(count,
+    handles, flags & COWAIT_WAITALL, milliseconds);
+  if (result == WAIT_TIMEOUT)
+    return RPC_S_CALLPENDING;
+  else if (result == WAIT_FAILED)
+    return HRESULT_FROM_WIN32(GetLastError());
+  *index = result - WAIT_OBJECT_0;
+  return S_OK;
+}
+
+namespace dmitigr::wincom::fake::detail {
+
+/**
+ * @brief The stream of `CoMarshalInterThreadInterfaceInStream()`.
+ *
+ * @details Like the real one, the stream holds the reference to the marshaled
+ * object (the marshal data) until it's unmarshaled or released by
+ * `CoReleaseMarshalData()`, but not until the stream is released.
+ */
+class Marshal_stream final : public IStream {
+public:
+  explicit Marshal_stream(IUnknown* const object) noexcept
+    : object_{object}
+  {}
+
+  HRESULT QueryInterface(REFIID id, void** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    else if (id == __uuidof(IStream) || id == __uuidof(IUnknown)) {
+      AddRef();
+      *result = static_cast<IStream*>(this);
+      return S_OK;
+    }
+    *result = nullptr;
+    return E_NOINTERFACE;
+  }
+
+  ULONG AddRef() override
+  {
+    return ++ref_count_;
+  }
+
+  ULONG Release() override
+  {
+    const auto result = --ref_count_;
+    if (!result)
+      delete this;
+    return result;
+  }
+
+  /// @returns The marshaled object.
+  IUnknown* object() const noexcept
+  {
+    return object_.load();
+  }
+
+  /// Releases the marshal data.
+  HRESULT release_object() noexcept
+  {
+    if (auto* const object = object_.exchange(nullptr)) {
+      object->Release();
+      return S_OK;
+    }
+    return E_UNEXPECTED;
+  }
+
+private:
+  std::atomic<ULONG> ref_count_{1};
+  std::atomic<IUnknown*> object_{};
+};
+
+} // namespace dmitigr::wincom::fake::detail
+
+/// @remarks The object is not marshaled but shared.
+inline HRESULT CoMarshalInterThreadInterfaceInStream(REFIID id,
+  const LPUNKNOWN object, LPSTREAM* const result)
+{
+  using dmitigr::wincom::fake::detail::Marshal_stream;
+  if (!object || !result)
+    return E_INVALIDARG;
+  *result = nullptr;
+  IUnknown* unknown{};
+  if (const auto err = object->QueryInterface(id,
+      reinterpret_cast<void**>(&unknown)); err != S_OK)
+    return err;
+  *result = new(std::nothrow) Marshal_stream{unknown};
+  if (!*result) {
+    unknown->Release();
+    return E_OUTOFMEMORY;
+  }
+  return S_OK;
+}
+
+inline HRESULT CoGetInterfaceAndReleaseStream(const LPSTREAM stream,
+  REFIID id, LPVOID* const result)
+{
+  using dmitigr::wincom::fake::detail::Marshal_stream;
+  if (!stream || !result)
+    return E_INVALIDARG;
+  *result = nullptr;
+  auto* const marshal_stream = static_cast<Marshal_stream*>(stream);
+  auto* const object = marshal_stream->object();
+  const auto err = object ? object->QueryInterface(id, result) : E_UNEXPECTED;
+  marshal_stream->release_object();
+  stream->Release();
+  return err;
+}
+
+inline HRESULT CoReleaseMarshalData(const LPSTREAM stream)
+{
+  using dmitigr::wincom::fake::detail::Marshal_stream;
+  if (!stream)
+    return E_INVALIDARG;
+  return static_cast<Marshal_stream*>(stream)->release_object();
+}
+
+/// @remarks Not supported by the fake runtime.
+inline HRESULT CoGetStandardMarshal(REFIID, IUnknown*, DWORD, LPVOID, DWORD,
+  IMarshal** const result)
+{
+  if (result)
+    *result = nullptr;
+  return E_NOTIMPL;
+}
+
+inline LPVOID CoTaskMemAlloc(const SIZE_T size) noexcept
+{
+  return std::malloc(size);
+}
+
+inline void CoTaskMemFree(const LPVOID memory) noexcept
+{
+  std::free(memory);
+}
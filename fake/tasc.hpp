@@ -0,0 +1,3325 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "object.hpp"
+
+#include <taskschd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cwchar>
+#include <cwctype>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom::fake::tasc {
+
+namespace detail {
+
+using fake::detail::iequals;
+using fake::detail::Iless;
+
+// -----------------------------------------------------------------------------
+// XML
+// -----------------------------------------------------------------------------
+
+/// The XML element.
+struct Element final {
+  std::wstring_view name;
+  std::wstring_view attributes;
+  std::wstring_view content;
+};
+
+/**
+ * @returns The top-level elements of `xml`, or `std::nullopt` if `xml` is
+ * malformed.
+ *
+ * @remarks Declarations, comments and the text between elements are skipped.
+ */
+inline std::optional<std::vector<Element>> children(const std::wstring_view xml)
+{
+  std::vector<Element> result;
+  std::size_t pos{};
+  while ((pos = xml.find(L'<', pos)) != std::wstring_view::npos) {
+    const auto rest = xml.substr(pos);
+    if (rest.starts_with(L"<?") || rest.starts_with(L"<!--")) {
+      const auto end = xml.find(rest[1] == L'?' ? L"?>" : L"-->", pos);
+      if (end == std::wstring_view::npos)
+        return std::nullopt;
+      pos = end + 2;
+      continue;
+    }
+
+    const auto tag_end = xml.find(L'>', pos);
+    if (tag_end == std::wstring_view::npos || rest.starts_with(L"</"))
+      return std::nullopt;
+    const bool is_empty = xml[tag_end - 1] == L'/';
+    const auto tag = xml.substr(pos + 1, tag_end - pos - 1 - is_empty);
+    const auto name_end = std::min(tag.find_first_of(L" \t\r\n"), tag.size());
+    Element element{tag.substr(0, name_end), tag.substr(name_end), {}};
+    if (element.name.empty())
+      return std::nullopt;
+    pos = tag_end + 1;
+
+    if (!is_empty) {
+      // Find the matching end tag, taking into account the nested elements
+      // of the same name.
+      const std::wstring open{L"<" + std::wstring{element.name}};
+      const std::wstring close{L"</" + std::wstring{element.name} + L">"};
+      std::size_t depth{1}, end{pos};
+      while (depth) {
+        const auto next_close = xml.find(close, end);
+        if (next_close == std::wstring_view::npos)
+          return std::nullopt;
+        auto next_open = xml.find(open, end);
+        while (next_open < next_close) {
+          const auto ch = xml[next_open + open.size()];
+          if (ch == L'>' || ch == L' ' || ch == L'/')
+            break;
+          next_open = xml.find(open, next_open + 1);
+        }
+        if (next_open < next_close) {
+          ++depth;
+          end = next_open + open.size();
+        } else {
+          --depth;
+          end = next_close + close.size();
+        }
+      }
+      element.content = xml.substr(pos, end - close.size() - pos);
+      pos = end;
+    }
+    result.push_back(element);
+  }
+  return result;
+}
+
+/// @returns The first element named `name`, or `std::nullopt`.
+inline std::optional<Element> find(const std::vector<Element>& elements,
+  const std::wstring_view name)
+{
+  for (const auto& element : elements) {
+    if (element.name == name)
+      return element;
+  }
+  return std::nullopt;
+}
+
+/// @returns The value of attribute `name` of `element`, or empty string.
+inline std::wstring_view attribute(const Element& element,
+  const std::wstring_view name)
+{
+  const auto& attrs = element.attributes;
+  for (auto pos = attrs.find(name); pos != std::wstring_view::npos;
+       pos = attrs.find(name, pos + 1)) {
+    const auto eq = attrs.find_first_not_of(L" \t\r\n", pos + name.size());
+    if ((pos && !std::iswspace(attrs[pos - 1])) || eq == std::wstring_view::npos
+      || attrs[eq] != L'=')
+      continue;
+    const auto open = attrs.find_first_of(L"\"'", eq);
+    const auto close = open != std::wstring_view::npos ?
+      attrs.find(attrs[open], open + 1) : std::wstring_view::npos;
+    if (close != std::wstring_view::npos)
+      return attrs.substr(open + 1, close - open - 1);
+  }
+  return {};
+}
+
+/// @returns The text with the predefined entities replaced.
+inline std::wstring unescape(const std::wstring_view text)
+{
+  static constexpr std::pair<std::wstring_view, wchar_t> entities[]{
+    {L"&lt;", L'<'}, {L"&gt;", L'>'}, {L"&amp;", L'&'}, {L"&quot;", L'"'},
+    {L"&apos;", L'\''}};
+  std::wstring result;
+  result.reserve(text.size());
+  for (std::size_t i{}; i < text.size(); ++i) {
+    if (text[i] == L'&') {
+      const auto rest = text.substr(i);
+      const auto e = std::find_if(std::begin(entities), std::end(entities),
+        [rest](const auto& entity){return rest.starts_with(entity.first);});
+      if (e != std::end(entities)) {
+        result += e->second;
+        i += e->first.size() - 1;
+        continue;
+      }
+    }
+    result += text[i];
+  }
+  return result;
+}
+
+/// @returns The text with the special characters replaced with entities.
+inline std::wstring escape(const std::wstring_view text)
+{
+  std::wstring result;
+  result.reserve(text.size());
+  for (const auto ch : text) {
+    switch (ch) {
+    case L'<': result += L"&lt;"; break;
+    case L'>': result += L"&gt;"; break;
+    case L'&': result += L"&amp;"; break;
+    case L'"': result += L"&quot;"; break;
+    default: result += ch;
+    }
+  }
+  return result;
+}
+
+/// @returns The text of the first element named `name`, or `std::nullopt`.
+inline std::optional<std::wstring> text(const std::vector<Element>& elements,
+  const std::wstring_view name)
+{
+  if (const auto element = find(elements, name))
+    return unescape(element->content);
+  return std::nullopt;
+}
+
+/// Appends `<name>value</name>` to `xml` unless `value` is empty.
+inline void append(std::wstring& xml, const std::wstring_view name,
+  const std::wstring_view value)
+{
+  if (!value.empty())
+    xml.append(L"<").append(name).append(L">").append(escape(value))
+      .append(L"</").append(name).append(L">");
+}
+
+/// Appends `<name>true</name>` or `<name>false</name>` to `xml`.
+inline void append_flag(std::wstring& xml, const std::wstring_view name,
+  const bool value)
+{
+  append(xml, name, value ? L"true" : L"false");
+}
+
+/// The table of the names of enumeration values in the XML of task.
+template<typename E, std::size_t N>
+using Names = std::pair<E, std::wstring_view>[N];
+
+/// @returns The name of `value` in `names`, or empty string.
+template<typename E, std::size_t N>
+std::wstring_view name_of(const Names<E, N>& names, const E value) noexcept
+{
+  for (const auto& [v, name] : names) {
+    if (v == value)
+      return name;
+  }
+  return {};
+}
+
+/// @returns The value named `name` in `names`, or `std::nullopt`.
+template<typename E, std::size_t N>
+std::optional<E> value_of(const Names<E, N>& names,
+  const std::wstring_view name) noexcept
+{
+  for (const auto& [value, n] : names) {
+    if (n == name)
+      return value;
+  }
+  return std::nullopt;
+}
+
+inline constexpr Names<TASK_LOGON_TYPE, 7> logon_types{
+  {TASK_LOGON_NONE, L"None"},
+  {TASK_LOGON_PASSWORD, L"Password"},
+  {TASK_LOGON_S4U, L"S4U"},
+  {TASK_LOGON_INTERACTIVE_TOKEN, L"InteractiveToken"},
+  {TASK_LOGON_GROUP, L"Group"},
+  {TASK_LOGON_SERVICE_ACCOUNT, L"ServiceAccount"},
+  {TASK_LOGON_INTERACTIVE_TOKEN_OR_PASSWORD, L"InteractiveTokenOrPassword"}};
+
+inline constexpr Names<TASK_RUNLEVEL_TYPE, 2> run_levels{
+  {TASK_RUNLEVEL_LUA, L"LeastPrivilege"},
+  {TASK_RUNLEVEL_HIGHEST, L"HighestAvailable"}};
+
+inline constexpr Names<TASK_INSTANCES_POLICY, 4> instances_policies{
+  {TASK_INSTANCES_PARALLEL, L"Parallel"},
+  {TASK_INSTANCES_QUEUE, L"Queue"},
+  {TASK_INSTANCES_IGNORE_NEW, L"IgnoreNew"},
+  {TASK_INSTANCES_STOP_EXISTING, L"StopExisting"}};
+
+inline constexpr Names<TASK_COMPATIBILITY, 7> compatibilities{
+  {TASK_COMPATIBILITY_AT, L"1.0"},
+  {TASK_COMPATIBILITY_V1, L"1.1"},
+  {TASK_COMPATIBILITY_V2, L"1.2"},
+  {TASK_COMPATIBILITY_V2_1, L"1.3"},
+  {TASK_COMPATIBILITY_V2_2, L"1.4"},
+  {TASK_COMPATIBILITY_V2_3, L"1.5"},
+  {TASK_COMPATIBILITY_V2_4, L"1.6"}};
+
+inline constexpr Names<TASK_TRIGGER_TYPE2, 8> trigger_elements{
+  {TASK_TRIGGER_EVENT, L"EventTrigger"},
+  {TASK_TRIGGER_TIME, L"TimeTrigger"},
+  {TASK_TRIGGER_IDLE, L"IdleTrigger"},
+  {TASK_TRIGGER_REGISTRATION, L"RegistrationTrigger"},
+  {TASK_TRIGGER_BOOT, L"BootTrigger"},
+  {TASK_TRIGGER_LOGON, L"LogonTrigger"},
+  {TASK_TRIGGER_SESSION_STATE_CHANGE, L"SessionStateChangeTrigger"},
+  {TASK_TRIGGER_CUSTOM_TRIGGER_01, L"CustomTrigger"}};
+
+inline constexpr Names<TASK_TRIGGER_TYPE2, 4> schedule_elements{
+  {TASK_TRIGGER_DAILY, L"ScheduleByDay"},
+  {TASK_TRIGGER_WEEKLY, L"ScheduleByWeek"},
+  {TASK_TRIGGER_MONTHLY, L"ScheduleByMonth"},
+  {TASK_TRIGGER_MONTHLYDOW, L"ScheduleByMonthDayOfWeek"}};
+
+/// The names of the bits of the bitmask in the XML of task.
+inline constexpr std::wstring_view day_names[]{L"Sunday", L"Monday",
+  L"Tuesday", L"Wednesday", L"Thursday", L"Friday", L"Saturday"};
+inline constexpr std::wstring_view month_names[]{L"January", L"February",
+  L"March", L"April", L"May", L"June", L"July", L"August", L"September",
+  L"October", L"November", L"December"};
+
+/// Appends the bitmask as the list of `<name/>` elements.
+template<std::size_t N>
+void append_bits(std::wstring& xml, const std::wstring_view name,
+  const std::wstring_view(&names)[N], const unsigned long mask)
+{
+  if (!mask)
+    return;
+  xml.append(L"<").append(name).append(L">");
+  for (std::size_t i{}; i < N; ++i) {
+    if (mask & (1ul << i))
+      xml.append(L"<").append(names[i]).append(L" />");
+  }
+  xml.append(L"</").append(name).append(L">");
+}
+
+/// @returns The bitmask of the elements named by `names`.
+template<std::size_t N>
+unsigned long bits(const std::vector<Element>& elements,
+  const std::wstring_view(&names)[N])
+{
+  unsigned long result{};
+  for (const auto& element : elements) {
+    const auto i = std::find(std::begin(names), std::end(names), element.name);
+    if (i != std::end(names))
+      result |= 1ul << (i - std::begin(names));
+  }
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Miscellaneous
+// -----------------------------------------------------------------------------
+
+/// @returns The current time as `DATE`.
+inline DATE now() noexcept
+{
+  using namespace std::chrono;
+  const duration<double, days::period> since_epoch{system_clock::now()
+    .time_since_epoch()};
+  return since_epoch.count() + 25569; // 1970-01-01 - 1899-12-30
+}
+
+/// @returns The new GUID string like `{00000000-0000-0000-0000-000000000001}`.
+inline std::wstring new_guid()
+{
+  static std::atomic_uint64_t counter;
+  wchar_t result[39]{};
+  std::swprintf(result, std::size(result),
+    L"{00000000-0000-0000-0000-%012llX}",
+    static_cast<unsigned long long>(++counter));
+  return result;
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// Registration_info
+// -----------------------------------------------------------------------------
+
+/// The data of the registration information of task.
+struct Registration_data final {
+  std::wstring description;
+  std::wstring author;
+  std::wstring version;
+  std::wstring date;
+  std::wstring documentation;
+  std::wstring uri;
+  std::wstring source;
+};
+
+/// The fake of `IRegistrationInfo`.
+class Registration_info final : public Object<IRegistrationInfo> {
+public:
+  explicit Registration_info(Registration_data data = {})
+    : properties_{std::move(data)}
+  {}
+
+  HRESULT get_Description(BSTR* const result) override
+  {
+    return properties_.get("IRegistrationInfo::get_Description",
+      &Registration_data::description, result);
+  }
+
+  HRESULT put_Description(const BSTR value) override
+  {
+    return properties_.put("IRegistrationInfo::put_Description",
+      &Registration_data::description, value);
+  }
+
+  HRESULT get_Author(BSTR* const result) override
+  {
+    return properties_.get("IRegistrationInfo::get_Author",
+      &Registration_data::author, result);
+  }
+
+  HRESULT put_Author(const BSTR value) override
+  {
+    return properties_.put("IRegistrationInfo::put_Author",
+      &Registration_data::author, value);
+  }
+
+  HRESULT get_Version(BSTR* const result) override
+  {
+    return properties_.get("IRegistrationInfo::get_Version",
+      &Registration_data::version, result);
+  }
+
+  HRESULT put_Version(const BSTR value) override
+  {
+    return properties_.put("IRegistrationInfo::put_Version",
+      &Registration_data::version, value);
+  }
+
+  HRESULT get_Date(BSTR* const result) override
+  {
+    return properties_.get("IRegistrationInfo::get_Date",
+      &Registration_data::date, result);
+  }
+
+  HRESULT put_Date(const BSTR value) override
+  {
+    return properties_.put("IRegistrationInfo::put_Date",
+      &Registration_data::date, value);
+  }
+
+  HRESULT get_Documentation(BSTR* const result) override
+  {
+    return properties_.get("IRegistrationInfo::get_Documentation",
+      &Registration_data::documentation, result);
+  }
+
+  HRESULT put_Documentation(const BSTR value) override
+  {
+    return properties_.put("IRegistrationInfo::put_Documentation",
+      &Registration_data::documentation, value);
+  }
+
+  HRESULT get_XmlText(BSTR* const result) override
+  {
+    if (result)
+      *result = nullptr;
+    return E_NOTIMPL;
+  }
+
+  HRESULT put_XmlText(BSTR) override
+  {
+    return E_NOTIMPL;
+  }
+
+  HRESULT get_URI(BSTR* const result) override
+  {
+    return properties_.get("IRegistrationInfo::get_URI",
+      &Registration_data::uri, result);
+  }
+
+  HRESULT put_URI(const BSTR value) override
+  {
+    return properties_.put("IRegistrationInfo::put_URI",
+      &Registration_data::uri, value);
+  }
+
+  HRESULT get_Source(BSTR* const result) override
+  {
+    return properties_.get("IRegistrationInfo::get_Source",
+      &Registration_data::source, result);
+  }
+
+  HRESULT put_Source(const BSTR value) override
+  {
+    return properties_.put("IRegistrationInfo::put_Source",
+      &Registration_data::source, value);
+  }
+
+  /// @returns The copy of the data.
+  Registration_data data() const
+  {
+    return properties_.data();
+  }
+
+private:
+  Property_store<Registration_data> properties_;
+};
+
+// -----------------------------------------------------------------------------
+// Trigger
+// -----------------------------------------------------------------------------
+
+/// The data of the repetition pattern of trigger.
+struct Repetition_data final {
+  std::wstring interval;
+  std::wstring duration;
+  bool is_stopped_at_duration_end{};
+};
+
+/// The fake of `IRepetitionPattern`.
+class Repetition_pattern final : public Object<IRepetitionPattern> {
+public:
+  explicit Repetition_pattern(Repetition_data data = {})
+    : properties_{std::move(data)}
+  {}
+
+  HRESULT get_Interval(BSTR* const result) override
+  {
+    return properties_.get("IRepetitionPattern::get_Interval",
+      &Repetition_data::interval, result);
+  }
+
+  HRESULT put_Interval(const BSTR value) override
+  {
+    return properties_.put("IRepetitionPattern::put_Interval",
+      &Repetition_data::interval, value);
+  }
+
+  HRESULT get_Duration(BSTR* const result) override
+  {
+    return properties_.get("IRepetitionPattern::get_Duration",
+      &Repetition_data::duration, result);
+  }
+
+  HRESULT put_Duration(const BSTR value) override
+  {
+    return properties_.put("IRepetitionPattern::put_Duration",
+      &Repetition_data::duration, value);
+  }
+
+  HRESULT get_StopAtDurationEnd(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("IRepetitionPattern::get_StopAtDurationEnd",
+      &Repetition_data::is_stopped_at_duration_end, result);
+  }
+
+  HRESULT put_StopAtDurationEnd(const VARIANT_BOOL value) override
+  {
+    return properties_.put("IRepetitionPattern::put_StopAtDurationEnd",
+      &Repetition_data::is_stopped_at_duration_end, value);
+  }
+
+  /// @returns The copy of the data.
+  Repetition_data data() const
+  {
+    return properties_.data();
+  }
+
+private:
+  Property_store<Repetition_data> properties_;
+};
+
+/// The data of trigger of any type.
+struct Trigger_data final {
+  std::wstring id;
+  Ref<Repetition_pattern> repetition{make<Repetition_pattern>()};
+  std::wstring execution_time_limit;
+  std::wstring start_boundary;
+  std::wstring end_boundary;
+  bool is_enabled{true};
+  std::wstring random_delay;
+  short days_interval{1};
+  short weeks_interval{1};
+  short days_of_week{};
+  long days_of_month{};
+  short weeks_of_month{};
+  short months_of_year{};
+  bool is_run_on_last_day_of_month{};
+  bool is_run_on_last_week_of_month{};
+};
+
+/**
+ * @brief The fake of `ITrigger` and the derived interface `I`.
+ *
+ * @details Implements the properties of all the derived interfaces, so that
+ * only those of `I` are overrides.
+ */
+template<class I>
+class Trigger final : public Object<I> {
+public:
+  explicit Trigger(const TASK_TRIGGER_TYPE2 type, Trigger_data data = {})
+    : type_{type}
+    , properties_{std::move(data)}
+  {}
+
+  HRESULT get_Type(TASK_TRIGGER_TYPE2* const result) override
+  {
+    return get(type_, result);
+  }
+
+  HRESULT get_Id(BSTR* const result) override
+  {
+    return properties_.get("ITrigger::get_Id", &Trigger_data::id, result);
+  }
+
+  HRESULT put_Id(const BSTR value) override
+  {
+    return properties_.put("ITrigger::put_Id", &Trigger_data::id, value);
+  }
+
+  HRESULT get_Repetition(IRepetitionPattern** const result) override
+  {
+    return properties_.get("ITrigger::get_Repetition",
+      &Trigger_data::repetition, result);
+  }
+
+  HRESULT put_Repetition(IRepetitionPattern* const value) override
+  {
+    return properties_.put("ITrigger::put_Repetition",
+      &Trigger_data::repetition, value);
+  }
+
+  HRESULT get_ExecutionTimeLimit(BSTR* const result) override
+  {
+    return properties_.get("ITrigger::get_ExecutionTimeLimit",
+      &Trigger_data::execution_time_limit, result);
+  }
+
+  HRESULT put_ExecutionTimeLimit(const BSTR value) override
+  {
+    return properties_.put("ITrigger::put_ExecutionTimeLimit",
+      &Trigger_data::execution_time_limit, value);
+  }
+
+  HRESULT get_StartBoundary(BSTR* const result) override
+  {
+    return properties_.get("ITrigger::get_StartBoundary",
+      &Trigger_data::start_boundary, result);
+  }
+
+  HRESULT put_StartBoundary(const BSTR value) override
+  {
+    return properties_.put("ITrigger::put_StartBoundary",
+      &Trigger_data::start_boundary, value);
+  }
+
+  HRESULT get_EndBoundary(BSTR* const result) override
+  {
+    return properties_.get("ITrigger::get_EndBoundary",
+      &Trigger_data::end_boundary, result);
+  }
+
+  HRESULT put_EndBoundary(const BSTR value) override
+  {
+    return properties_.put("ITrigger::put_EndBoundary",
+      &Trigger_data::end_boundary, value);
+  }
+
+  HRESULT get_Enabled(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("ITrigger::get_Enabled",
+      &Trigger_data::is_enabled, result);
+  }
+
+  HRESULT put_Enabled(const VARIANT_BOOL value) override
+  {
+    return properties_.put("ITrigger::put_Enabled",
+      &Trigger_data::is_enabled, value);
+  }
+
+  // Overrides of the derived interfaces (if any)
+
+  HRESULT get_RandomDelay(BSTR* const result)
+  {
+    return properties_.get("ITrigger::get_RandomDelay",
+      &Trigger_data::random_delay, result);
+  }
+
+  HRESULT put_RandomDelay(const BSTR value)
+  {
+    return properties_.put("ITrigger::put_RandomDelay",
+      &Trigger_data::random_delay, value);
+  }
+
+  HRESULT get_DaysInterval(short* const result)
+  {
+    return properties_.get("ITrigger::get_DaysInterval",
+      &Trigger_data::days_interval, result);
+  }
+
+  HRESULT put_DaysInterval(const short value)
+  {
+    return properties_.put("ITrigger::put_DaysInterval",
+      &Trigger_data::days_interval, value);
+  }
+
+  HRESULT get_WeeksInterval(short* const result)
+  {
+    return properties_.get("ITrigger::get_WeeksInterval",
+      &Trigger_data::weeks_interval, result);
+  }
+
+  HRESULT put_WeeksInterval(const short value)
+  {
+    return properties_.put("ITrigger::put_WeeksInterval",
+      &Trigger_data::weeks_interval, value);
+  }
+
+  HRESULT get_DaysOfWeek(short* const result)
+  {
+    return properties_.get("ITrigger::get_DaysOfWeek",
+      &Trigger_data::days_of_week, result);
+  }
+
+  HRESULT put_DaysOfWeek(const short value)
+  {
+    return properties_.put("ITrigger::put_DaysOfWeek",
+      &Trigger_data::days_of_week, value);
+  }
+
+  HRESULT get_DaysOfMonth(long* const result)
+  {
+    return properties_.get("ITrigger::get_DaysOfMonth",
+      &Trigger_data::days_of_month, result);
+  }
+
+  HRESULT put_DaysOfMonth(const long value)
+  {
+    return properties_.put("ITrigger::put_DaysOfMonth",
+      &Trigger_data::days_of_month, value);
+  }
+
+  HRESULT get_WeeksOfMonth(short* const result)
+  {
+    return properties_.get("ITrigger::get_WeeksOfMonth",
+      &Trigger_data::weeks_of_month, result);
+  }
+
+  HRESULT put_WeeksOfMonth(const short value)
+  {
+    return properties_.put("ITrigger::put_WeeksOfMonth",
+      &Trigger_data::weeks_of_month, value);
+  }
+
+  HRESULT get_MonthsOfYear(short* const result)
+  {
+    return properties_.get("ITrigger::get_MonthsOfYear",
+      &Trigger_data::months_of_year, result);
+  }
+
+  HRESULT put_MonthsOfYear(const short value)
+  {
+    return properties_.put("ITrigger::put_MonthsOfYear",
+      &Trigger_data::months_of_year, value);
+  }
+
+  HRESULT get_RunOnLastDayOfMonth(VARIANT_BOOL* const result)
+  {
+    return properties_.get("ITrigger::get_RunOnLastDayOfMonth",
+      &Trigger_data::is_run_on_last_day_of_month, result);
+  }
+
+  HRESULT put_RunOnLastDayOfMonth(const VARIANT_BOOL value)
+  {
+    return properties_.put("ITrigger::put_RunOnLastDayOfMonth",
+      &Trigger_data::is_run_on_last_day_of_month, value);
+  }
+
+  HRESULT get_RunOnLastWeekOfMonth(VARIANT_BOOL* const result)
+  {
+    return properties_.get("ITrigger::get_RunOnLastWeekOfMonth",
+      &Trigger_data::is_run_on_last_week_of_month, result);
+  }
+
+  HRESULT put_RunOnLastWeekOfMonth(const VARIANT_BOOL value)
+  {
+    return properties_.put("ITrigger::put_RunOnLastWeekOfMonth",
+      &Trigger_data::is_run_on_last_week_of_month, value);
+  }
+
+  /// @returns The copy of the data.
+  Trigger_data data() const
+  {
+    return properties_.data();
+  }
+
+private:
+  TASK_TRIGGER_TYPE2 type_{};
+  Property_store<Trigger_data> properties_;
+};
+
+/// @returns The new trigger of `type`.
+inline Ref<ITrigger> make_trigger(const TASK_TRIGGER_TYPE2 type,
+  Trigger_data data = {})
+{
+  switch (type) {
+  case TASK_TRIGGER_TIME:
+    return Ref<ITrigger>{make<Trigger<ITimeTrigger>>(type,
+        std::move(data)).copy()};
+  case TASK_TRIGGER_DAILY:
+    return Ref<ITrigger>{make<Trigger<IDailyTrigger>>(type,
+        std::move(data)).copy()};
+  case TASK_TRIGGER_WEEKLY:
+    return Ref<ITrigger>{make<Trigger<IWeeklyTrigger>>(type,
+        std::move(data)).copy()};
+  case TASK_TRIGGER_MONTHLY:
+    return Ref<ITrigger>{make<Trigger<IMonthlyTrigger>>(type,
+        std::move(data)).copy()};
+  case TASK_TRIGGER_MONTHLYDOW:
+    return Ref<ITrigger>{make<Trigger<IMonthlyDOWTrigger>>(type,
+        std::move(data)).copy()};
+  default:
+    return Ref<ITrigger>{make<Trigger<ITrigger>>(type,
+        std::move(data)).copy()};
+  }
+}
+
+/// @returns The data of `trigger` created by `make_trigger()`.
+inline Trigger_data trigger_data(ITrigger& trigger)
+{
+  TASK_TRIGGER_TYPE2 type{};
+  trigger.get_Type(&type);
+  switch (type) {
+  case TASK_TRIGGER_TIME:
+    return dynamic_cast<Trigger<ITimeTrigger>&>(trigger).data();
+  case TASK_TRIGGER_DAILY:
+    return dynamic_cast<Trigger<IDailyTrigger>&>(trigger).data();
+  case TASK_TRIGGER_WEEKLY:
+    return dynamic_cast<Trigger<IWeeklyTrigger>&>(trigger).data();
+  case TASK_TRIGGER_MONTHLY:
+    return dynamic_cast<Trigger<IMonthlyTrigger>&>(trigger).data();
+  case TASK_TRIGGER_MONTHLYDOW:
+    return dynamic_cast<Trigger<IMonthlyDOWTrigger>&>(trigger).data();
+  default:
+    return dynamic_cast<Trigger<ITrigger>&>(trigger).data();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Action
+// -----------------------------------------------------------------------------
+
+/// The data of action of any type.
+struct Action_data final {
+  std::wstring id;
+  std::wstring path;
+  std::wstring arguments;
+  std::wstring working_directory;
+  std::wstring class_id;
+  std::wstring data;
+};
+
+/**
+ * @brief The fake of `IAction` and the derived interface `I`.
+ *
+ * @details Implements the properties of all the derived interfaces, so that
+ * only those of `I` are overrides.
+ */
+template<class I>
+class Action final : public Object<I> {
+public:
+  explicit Action(const TASK_ACTION_TYPE type, Action_data data = {})
+    : type_{type}
+    , properties_{std::move(data)}
+  {}
+
+  HRESULT get_Id(BSTR* const result) override
+  {
+    return properties_.get("IAction::get_Id", &Action_data::id, result);
+  }
+
+  HRESULT put_Id(const BSTR value) override
+  {
+    return properties_.put("IAction::put_Id", &Action_data::id, value);
+  }
+
+  HRESULT get_Type(TASK_ACTION_TYPE* const result) override
+  {
+    return get(type_, result);
+  }
+
+  // Overrides of the derived interfaces (if any)
+
+  HRESULT get_Path(BSTR* const result)
+  {
+    return properties_.get("IExecAction::get_Path", &Action_data::path,
+      result);
+  }
+
+  HRESULT put_Path(const BSTR value)
+  {
+    return properties_.put("IExecAction::put_Path", &Action_data::path,
+      value);
+  }
+
+  HRESULT get_Arguments(BSTR* const result)
+  {
+    return properties_.get("IExecAction::get_Arguments",
+      &Action_data::arguments, result);
+  }
+
+  HRESULT put_Arguments(const BSTR value)
+  {
+    return properties_.put("IExecAction::put_Arguments",
+      &Action_data::arguments, value);
+  }
+
+  HRESULT get_WorkingDirectory(BSTR* const result)
+  {
+    return properties_.get("IExecAction::get_WorkingDirectory",
+      &Action_data::working_directory, result);
+  }
+
+  HRESULT put_WorkingDirectory(const BSTR value)
+  {
+    return properties_.put("IExecAction::put_WorkingDirectory",
+      &Action_data::working_directory, value);
+  }
+
+  HRESULT get_ClassId(BSTR* const result)
+  {
+    return properties_.get("IComHandlerAction::get_ClassId",
+      &Action_data::class_id, result);
+  }
+
+  HRESULT put_ClassId(const BSTR value)
+  {
+    return properties_.put("IComHandlerAction::put_ClassId",
+      &Action_data::class_id, value);
+  }
+
+  HRESULT get_Data(BSTR* const result)
+  {
+    return properties_.get("IComHandlerAction::get_Data",
+      &Action_data::data, result);
+  }
+
+  HRESULT put_Data(const BSTR value)
+  {
+    return properties_.put("IComHandlerAction::put_Data",
+      &Action_data::data, value);
+  }
+
+  /// @returns The copy of the data.
+  Action_data data() const
+  {
+    return properties_.data();
+  }
+
+private:
+  TASK_ACTION_TYPE type_{};
+  Property_store<Action_data> properties_;
+};
+
+/**
+ * @returns The new action of `type`, or null reference if `type` is neither
+ * `TASK_ACTION_EXEC` nor `TASK_ACTION_COM_HANDLER`.
+ */
+inline Ref<IAction> make_action(const TASK_ACTION_TYPE type,
+  Action_data data = {})
+{
+  switch (type) {
+  case TASK_ACTION_EXEC:
+    return Ref<IAction>{make<Action<IExecAction>>(type,
+        std::move(data)).copy()};
+  case TASK_ACTION_COM_HANDLER:
+    return Ref<IAction>{make<Action<IComHandlerAction>>(type,
+        std::move(data)).copy()};
+  default:
+    return Ref<IAction>{};
+  }
+}
+
+/// @returns The data of `action` created by `make_action()`.
+inline Action_data action_data(IAction& action)
+{
+  TASK_ACTION_TYPE type{};
+  action.get_Type(&type);
+  return type == TASK_ACTION_EXEC ?
+    dynamic_cast<Action<IExecAction>&>(action).data() :
+    dynamic_cast<Action<IComHandlerAction>&>(action).data();
+}
+
+// -----------------------------------------------------------------------------
+// Collections of definition
+// -----------------------------------------------------------------------------
+
+/// The fake of `ITriggerCollection`.
+class Trigger_collection final : public Object<ITriggerCollection> {
+public:
+  HRESULT get_Count(long* const result) override
+  {
+    if (const auto err = enter("ITriggerCollection::get_Count"); err != S_OK)
+      return err;
+    return get(items().size(), result);
+  }
+
+  /// @param index 1-based index.
+  HRESULT get_Item(const long index, ITrigger** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("ITriggerCollection::get_Item"); err != S_OK)
+      return err;
+    const auto triggers = items();
+    if (index < 1 || static_cast<std::size_t>(index) > triggers.size())
+      return E_INVALIDARG;
+    return get(triggers[index - 1], result);
+  }
+
+  HRESULT get__NewEnum(IUnknown** const result) override
+  {
+    return new_enum(items(), result);
+  }
+
+  HRESULT Create(const TASK_TRIGGER_TYPE2 type,
+    ITrigger** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("ITriggerCollection::Create"); err != S_OK)
+      return err;
+    auto trigger = make_trigger(type);
+    *result = trigger.copy();
+    const std::lock_guard lg{mutex_};
+    items_.push_back(std::move(trigger));
+    return S_OK;
+  }
+
+  HRESULT Remove(const VARIANT index) override
+  {
+    VARIANT i{};
+    if (VariantChangeType(&i, &index, 0, VT_I4) != S_OK)
+      return E_INVALIDARG;
+    Ref<ITrigger> removed;
+    const std::lock_guard lg{mutex_};
+    if (i.lVal < 1 || static_cast<std::size_t>(i.lVal) > items_.size())
+      return E_INVALIDARG;
+    removed = std::move(items_[i.lVal - 1]);
+    items_.erase(items_.begin() + (i.lVal - 1));
+    return S_OK;
+  }
+
+  HRESULT Clear() override
+  {
+    std::vector<Ref<ITrigger>> removed;
+    const std::lock_guard lg{mutex_};
+    removed.swap(items_);
+    return S_OK;
+  }
+
+  /// @returns The snapshot of the triggers.
+  std::vector<Ref<ITrigger>> items() const
+  {
+    const std::lock_guard lg{mutex_};
+    return items_;
+  }
+
+  /// Appends `trigger`.
+  void add(Ref<ITrigger> trigger)
+  {
+    const std::lock_guard lg{mutex_};
+    items_.push_back(std::move(trigger));
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::vector<Ref<ITrigger>> items_;
+};
+
+/// The fake of `IActionCollection`.
+class Action_collection final : public Object<IActionCollection> {
+public:
+  HRESULT get_Count(long* const result) override
+  {
+    if (const auto err = enter("IActionCollection::get_Count"); err != S_OK)
+      return err;
+    return get(items().size(), result);
+  }
+
+  /// @param index 1-based index.
+  HRESULT get_Item(const long index, IAction** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("IActionCollection::get_Item"); err != S_OK)
+      return err;
+    const auto actions = items();
+    if (index < 1 || static_cast<std::size_t>(index) > actions.size())
+      return E_INVALIDARG;
+    return get(actions[index - 1], result);
+  }
+
+  HRESULT get__NewEnum(IUnknown** const result) override
+  {
+    return new_enum(items(), result);
+  }
+
+  HRESULT get_XmlText(BSTR* const result) override
+  {
+    if (result)
+      *result = nullptr;
+    return E_NOTIMPL;
+  }
+
+  HRESULT put_XmlText(BSTR) override
+  {
+    return E_NOTIMPL;
+  }
+
+  /// Creates `TASK_ACTION_EXEC` or `TASK_ACTION_COM_HANDLER` action.
+  HRESULT Create(const TASK_ACTION_TYPE type, IAction** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("IActionCollection::Create"); err != S_OK)
+      return err;
+    auto action = make_action(type);
+    if (!action)
+      return E_INVALIDARG;
+    *result = action.copy();
+    add(std::move(action));
+    return S_OK;
+  }
+
+  HRESULT Remove(const VARIANT index) override
+  {
+    VARIANT i{};
+    if (VariantChangeType(&i, &index, 0, VT_I4) != S_OK)
+      return E_INVALIDARG;
+    Ref<IAction> removed;
+    const std::lock_guard lg{mutex_};
+    if (i.lVal < 1 || static_cast<std::size_t>(i.lVal) > items_.size())
+      return E_INVALIDARG;
+    removed = std::move(items_[i.lVal - 1]);
+    items_.erase(items_.begin() + (i.lVal - 1));
+    return S_OK;
+  }
+
+  HRESULT Clear() override
+  {
+    std::vector<Ref<IAction>> removed;
+    const std::lock_guard lg{mutex_};
+    removed.swap(items_);
+    return S_OK;
+  }
+
+  HRESULT get_Context(BSTR* const result) override
+  {
+    const std::lock_guard lg{mutex_};
+    return get(context_, result);
+  }
+
+  HRESULT put_Context(const BSTR value) override
+  {
+    const std::lock_guard lg{mutex_};
+    return put(context_, value);
+  }
+
+  /// @returns The snapshot of the actions.
+  std::vector<Ref<IAction>> items() const
+  {
+    const std::lock_guard lg{mutex_};
+    return items_;
+  }
+
+  /// Appends `action`.
+  void add(Ref<IAction> action)
+  {
+    const std::lock_guard lg{mutex_};
+    items_.push_back(std::move(action));
+  }
+
+  /// @returns The context (the principal) of the actions.
+  std::wstring context() const
+  {
+    const std::lock_guard lg{mutex_};
+    return context_;
+  }
+
+  /// Sets the context of the actions.
+  void set_context(std::wstring value)
+  {
+    const std::lock_guard lg{mutex_};
+    context_ = std::move(value);
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::vector<Ref<IAction>> items_;
+  std::wstring context_{L"Author"};
+};
+
+// -----------------------------------------------------------------------------
+// Task_settings
+// -----------------------------------------------------------------------------
+
+/// The data of the settings of task (with the defaults of Task Scheduler).
+struct Settings_data final {
+  bool is_demand_start_allowed{true};
+  std::wstring restart_interval;
+  int restart_count{};
+  TASK_INSTANCES_POLICY multiple_instances{TASK_INSTANCES_IGNORE_NEW};
+  bool is_stop_if_going_on_batteries{true};
+  bool is_start_disallowed_on_batteries{true};
+  bool is_hard_terminate_allowed{true};
+  bool is_start_when_available{};
+  bool is_run_only_if_network_available{};
+  std::wstring execution_time_limit{L"PT72H"};
+  bool is_enabled{true};
+  std::wstring delete_expired_task_after;
+  int priority{7};
+  TASK_COMPATIBILITY compatibility{TASK_COMPATIBILITY_V2};
+  bool is_hidden{};
+  bool is_run_only_if_idle{};
+  bool is_wake_to_run{};
+};
+
+/// The fake of `ITaskSettings`.
+class Task_settings final : public Object<ITaskSettings> {
+public:
+  explicit Task_settings(Settings_data data = {})
+    : properties_{std::move(data)}
+  {}
+
+  HRESULT get_AllowDemandStart(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("ITaskSettings::get_AllowDemandStart",
+      &Settings_data::is_demand_start_allowed, result);
+  }
+
+  HRESULT put_AllowDemandStart(const VARIANT_BOOL value) override
+  {
+    return properties_.put("ITaskSettings::put_AllowDemandStart",
+      &Settings_data::is_demand_start_allowed, value);
+  }
+
+  HRESULT get_RestartInterval(BSTR* const result) override
+  {
+    return properties_.get("ITaskSettings::get_RestartInterval",
+      &Settings_data::restart_interval, result);
+  }
+
+  HRESULT put_RestartInterval(const BSTR value) override
+  {
+    return properties_.put("ITaskSettings::put_RestartInterval",
+      &Settings_data::restart_interval, value);
+  }
+
+  HRESULT get_RestartCount(int* const result) override
+  {
+    return properties_.get("ITaskSettings::get_RestartCount",
+      &Settings_data::restart_count, result);
+  }
+
+  HRESULT put_RestartCount(const int value) override
+  {
+    return properties_.put("ITaskSettings::put_RestartCount",
+      &Settings_data::restart_count, value);
+  }
+
+  HRESULT get_MultipleInstances(TASK_INSTANCES_POLICY* const result) override
+  {
+    return properties_.get("ITaskSettings::get_MultipleInstances",
+      &Settings_data::multiple_instances, result);
+  }
+
+  HRESULT put_MultipleInstances(const TASK_INSTANCES_POLICY value) override
+  {
+    return properties_.put("ITaskSettings::put_MultipleInstances",
+      &Settings_data::multiple_instances, value);
+  }
+
+  HRESULT get_StopIfGoingOnBatteries(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("ITaskSettings::get_StopIfGoingOnBatteries",
+      &Settings_data::is_stop_if_going_on_batteries, result);
+  }
+
+  HRESULT put_StopIfGoingOnBatteries(const VARIANT_BOOL value) override
+  {
+    return properties_.put("ITaskSettings::put_StopIfGoingOnBatteries",
+      &Settings_data::is_stop_if_going_on_batteries, value);
+  }
+
+  HRESULT get_DisallowStartIfOnBatteries(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("ITaskSettings::get_DisallowStartIfOnBatteries",
+      &Settings_data::is_start_disallowed_on_batteries, result);
+  }
+
+  HRESULT put_DisallowStartIfOnBatteries(const VARIANT_BOOL value) override
+  {
+    return properties_.put("ITaskSettings::put_DisallowStartIfOnBatteries",
+      &Settings_data::is_start_disallowed_on_batteries, value);
+  }
+
+  HRESULT get_AllowHardTerminate(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("ITaskSettings::get_AllowHardTerminate",
+      &Settings_data::is_hard_terminate_allowed, result);
+  }
+
+  HRESULT put_AllowHardTerminate(const VARIANT_BOOL value) override
+  {
+    return properties_.put("ITaskSettings::put_AllowHardTerminate",
+      &Settings_data::is_hard_terminate_allowed, value);
+  }
+
+  HRESULT get_StartWhenAvailable(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("ITaskSettings::get_StartWhenAvailable",
+      &Settings_data::is_start_when_available, result);
+  }
+
+  HRESULT put_StartWhenAvailable(const VARIANT_BOOL value) override
+  {
+    return properties_.put("ITaskSettings::put_StartWhenAvailable",
+      &Settings_data::is_start_when_available, value);
+  }
+
+  HRESULT get_XmlText(BSTR* const result) override
+  {
+    if (result)
+      *result = nullptr;
+    return E_NOTIMPL;
+  }
+
+  HRESULT put_XmlText(BSTR) override
+  {
+    return E_NOTIMPL;
+  }
+
+  HRESULT get_RunOnlyIfNetworkAvailable(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("ITaskSettings::get_RunOnlyIfNetworkAvailable",
+      &Settings_data::is_run_only_if_network_available, result);
+  }
+
+  HRESULT put_RunOnlyIfNetworkAvailable(const VARIANT_BOOL value) override
+  {
+    return properties_.put("ITaskSettings::put_RunOnlyIfNetworkAvailable",
+      &Settings_data::is_run_only_if_network_available, value);
+  }
+
+  HRESULT get_ExecutionTimeLimit(BSTR* const result) override
+  {
+    return properties_.get("ITaskSettings::get_ExecutionTimeLimit",
+      &Settings_data::execution_time_limit, result);
+  }
+
+  HRESULT put_ExecutionTimeLimit(const BSTR value) override
+  {
+    return properties_.put("ITaskSettings::put_ExecutionTimeLimit",
+      &Settings_data::execution_time_limit, value);
+  }
+
+  HRESULT get_Enabled(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("ITaskSettings::get_Enabled",
+      &Settings_data::is_enabled, result);
+  }
+
+  HRESULT put_Enabled(const VARIANT_BOOL value) override
+  {
+    return properties_.put("ITaskSettings::put_Enabled",
+      &Settings_data::is_enabled, value);
+  }
+
+  HRESULT get_DeleteExpiredTaskAfter(BSTR* const result) override
+  {
+    return properties_.get("ITaskSettings::get_DeleteExpiredTaskAfter",
+      &Settings_data::delete_expired_task_after, result);
+  }
+
+  HRESULT put_DeleteExpiredTaskAfter(const BSTR value) override
+  {
+    return properties_.put("ITaskSettings::put_DeleteExpiredTaskAfter",
+      &Settings_data::delete_expired_task_after, value);
+  }
+
+  HRESULT get_Priority(int* const result) override
+  {
+    return properties_.get("ITaskSettings::get_Priority",
+      &Settings_data::priority, result);
+  }
+
+  HRESULT put_Priority(const int value) override
+  {
+    return properties_.put("ITaskSettings::put_Priority",
+      &Settings_data::priority, value);
+  }
+
+  HRESULT get_Compatibility(TASK_COMPATIBILITY* const result) override
+  {
+    return properties_.get("ITaskSettings::get_Compatibility",
+      &Settings_data::compatibility, result);
+  }
+
+  HRESULT put_Compatibility(const TASK_COMPATIBILITY value) override
+  {
+    return properties_.put("ITaskSettings::put_Compatibility",
+      &Settings_data::compatibility, value);
+  }
+
+  HRESULT get_Hidden(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("ITaskSettings::get_Hidden",
+      &Settings_data::is_hidden, result);
+  }
+
+  HRESULT put_Hidden(const VARIANT_BOOL value) override
+  {
+    return properties_.put("ITaskSettings::put_Hidden",
+      &Settings_data::is_hidden, value);
+  }
+
+  HRESULT get_RunOnlyIfIdle(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("ITaskSettings::get_RunOnlyIfIdle",
+      &Settings_data::is_run_only_if_idle, result);
+  }
+
+  HRESULT put_RunOnlyIfIdle(const VARIANT_BOOL value) override
+  {
+    return properties_.put("ITaskSettings::put_RunOnlyIfIdle",
+      &Settings_data::is_run_only_if_idle, value);
+  }
+
+  HRESULT get_WakeToRun(VARIANT_BOOL* const result) override
+  {
+    return properties_.get("ITaskSettings::get_WakeToRun",
+      &Settings_data::is_wake_to_run, result);
+  }
+
+  HRESULT put_WakeToRun(const VARIANT_BOOL value) override
+  {
+    return properties_.put("ITaskSettings::put_WakeToRun",
+      &Settings_data::is_wake_to_run, value);
+  }
+
+  /// @returns The copy of the data.
+  Settings_data data() const
+  {
+    return properties_.data();
+  }
+
+  /// @returns The result of `f(data)` called under the lock of the settings.
+  template<class F>
+  decltype(auto) with(F&& f)
+  {
+    return properties_.with(std::forward<F>(f));
+  }
+
+private:
+  Property_store<Settings_data> properties_;
+};
+
+// -----------------------------------------------------------------------------
+// Principal
+// -----------------------------------------------------------------------------
+
+/// The data of the principal of task.
+struct Principal_data final {
+  std::wstring id{L"Author"};
+  std::wstring display_name;
+  std::wstring user_id;
+  TASK_LOGON_TYPE logon_type{TASK_LOGON_NONE};
+  std::wstring group_id;
+  TASK_RUNLEVEL_TYPE run_level{TASK_RUNLEVEL_LUA};
+};
+
+/// The fake of `IPrincipal`.
+class Principal final : public Object<IPrincipal> {
+public:
+  explicit Principal(Principal_data data = {})
+    : properties_{std::move(data)}
+  {}
+
+  HRESULT get_Id(BSTR* const result) override
+  {
+    return properties_.get("IPrincipal::get_Id", &Principal_data::id, result);
+  }
+
+  HRESULT put_Id(const BSTR value) override
+  {
+    return properties_.put("IPrincipal::put_Id", &Principal_data::id, value);
+  }
+
+  HRESULT get_DisplayName(BSTR* const result) override
+  {
+    return properties_.get("IPrincipal::get_DisplayName",
+      &Principal_data::display_name, result);
+  }
+
+  HRESULT put_DisplayName(const BSTR value) override
+  {
+    return properties_.put("IPrincipal::put_DisplayName",
+      &Principal_data::display_name, value);
+  }
+
+  HRESULT get_UserId(BSTR* const result) override
+  {
+    return properties_.get("IPrincipal::get_UserId",
+      &Principal_data::user_id, result);
+  }
+
+  HRESULT put_UserId(const BSTR value) override
+  {
+    return properties_.put("IPrincipal::put_UserId",
+      &Principal_data::user_id, value);
+  }
+
+  HRESULT get_LogonType(TASK_LOGON_TYPE* const result) override
+  {
+    return properties_.get("IPrincipal::get_LogonType",
+      &Principal_data::logon_type, result);
+  }
+
+  HRESULT put_LogonType(const TASK_LOGON_TYPE value) override
+  {
+    return properties_.put("IPrincipal::put_LogonType",
+      &Principal_data::logon_type, value);
+  }
+
+  HRESULT get_GroupId(BSTR* const result) override
+  {
+    return properties_.get("IPrincipal::get_GroupId",
+      &Principal_data::group_id, result);
+  }
+
+  HRESULT put_GroupId(const BSTR value) override
+  {
+    return properties_.put("IPrincipal::put_GroupId",
+      &Principal_data::group_id, value);
+  }
+
+  HRESULT get_RunLevel(TASK_RUNLEVEL_TYPE* const result) override
+  {
+    return properties_.get("IPrincipal::get_RunLevel",
+      &Principal_data::run_level, result);
+  }
+
+  HRESULT put_RunLevel(const TASK_RUNLEVEL_TYPE value) override
+  {
+    return properties_.put("IPrincipal::put_RunLevel",
+      &Principal_data::run_level, value);
+  }
+
+  /// @returns The copy of the data.
+  Principal_data data() const
+  {
+    return properties_.data();
+  }
+
+  /// @returns The result of `f(data)` called under the lock of the principal.
+  template<class F>
+  decltype(auto) with(F&& f)
+  {
+    return properties_.with(std::forward<F>(f));
+  }
+
+private:
+  Property_store<Principal_data> properties_;
+};
+
+// -----------------------------------------------------------------------------
+// Task_definition
+// -----------------------------------------------------------------------------
+
+/// The data of task definition.
+struct Definition_data final {
+  Ref<Registration_info> registration_info{make<Registration_info>()};
+  Ref<Trigger_collection> triggers{make<Trigger_collection>()};
+  Ref<Task_settings> settings{make<Task_settings>()};
+  std::wstring data;
+  Ref<Principal> principal{make<Principal>()};
+  Ref<Action_collection> actions{make<Action_collection>()};
+};
+
+namespace detail {
+
+/// Assigns the text of the element `name` (if any) to `dest`.
+inline bool parse(const std::vector<Element>& elements,
+  const std::wstring_view name, std::wstring& dest)
+{
+  if (auto value = text(elements, name))
+    dest = std::move(*value);
+  return true;
+}
+
+/// @overload
+inline bool parse(const std::vector<Element>& elements,
+  const std::wstring_view name, bool& dest)
+{
+  if (const auto value = text(elements, name)) {
+    if (*value == L"true" || *value == L"1")
+      dest = true;
+    else if (*value == L"false" || *value == L"0")
+      dest = false;
+    else
+      return false;
+  }
+  return true;
+}
+
+/// @overload
+template<typename T>
+requires (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+bool parse(const std::vector<Element>& elements,
+  const std::wstring_view name, T& dest)
+{
+  if (const auto value = text(elements, name)) {
+    wchar_t* end{};
+    const auto number = std::wcstol(value->c_str(), &end, 10);
+    if (value->empty() || *end)
+      return false;
+    dest = static_cast<T>(number);
+  }
+  return true;
+}
+
+/// @overload
+template<typename E, std::size_t N>
+bool parse(const std::vector<Element>& elements,
+  const std::wstring_view name, const Names<E, N>& names, E& dest)
+{
+  if (const auto value = text(elements, name)) {
+    const auto v = value_of(names, *value);
+    if (!v)
+      return false;
+    dest = *v;
+  }
+  return true;
+}
+
+/// Appends the XML of `trigger` to `xml`.
+inline void append_trigger(std::wstring& xml, ITrigger& trigger)
+{
+  TASK_TRIGGER_TYPE2 type{};
+  trigger.get_Type(&type);
+  const auto data = trigger_data(trigger);
+  const auto schedule = name_of(schedule_elements, type);
+  const auto element = schedule.empty() ?
+    name_of(trigger_elements, type) : std::wstring_view{L"CalendarTrigger"};
+  xml.append(L"<").append(element);
+  if (!data.id.empty())
+    xml.append(L" id=\"").append(escape(data.id)).append(L"\"");
+  xml.append(L">");
+
+  if (const auto repetition = data.repetition->data();
+    !repetition.interval.empty()) {
+    xml.append(L"<Repetition>");
+    append(xml, L"Interval", repetition.interval);
+    append(xml, L"Duration", repetition.duration);
+    append_flag(xml, L"StopAtDurationEnd",
+      repetition.is_stopped_at_duration_end);
+    xml.append(L"</Repetition>");
+  }
+  append(xml, L"StartBoundary", data.start_boundary);
+  append(xml, L"EndBoundary", data.end_boundary);
+  append(xml, L"ExecutionTimeLimit", data.execution_time_limit);
+  append_flag(xml, L"Enabled", data.is_enabled);
+  if (type == TASK_TRIGGER_TIME || !schedule.empty())
+    append(xml, L"RandomDelay", data.random_delay);
+
+  if (!schedule.empty())
+    xml.append(L"<").append(schedule).append(L">");
+  switch (type) {
+  case TASK_TRIGGER_DAILY:
+    append(xml, L"DaysInterval", std::to_wstring(data.days_interval));
+    break;
+  case TASK_TRIGGER_WEEKLY:
+    append(xml, L"WeeksInterval", std::to_wstring(data.weeks_interval));
+    append_bits(xml, L"DaysOfWeek", day_names, data.days_of_week);
+    break;
+  case TASK_TRIGGER_MONTHLY:
+    xml.append(L"<DaysOfMonth>");
+    for (int i{}; i < 31; ++i) {
+      if (data.days_of_month & (1l << i))
+        append(xml, L"Day", std::to_wstring(i + 1));
+    }
+    if (data.is_run_on_last_day_of_month)
+      append(xml, L"Day", L"Last");
+    xml.append(L"</DaysOfMonth>");
+    append_bits(xml, L"Months", month_names, data.months_of_year);
+    break;
+  case TASK_TRIGGER_MONTHLYDOW:
+    xml.append(L"<Weeks>");
+    for (int i{}; i < 4; ++i) {
+      if (data.weeks_of_month & (1 << i))
+        append(xml, L"Week", std::to_wstring(i + 1));
+    }
+    if (data.is_run_on_last_week_of_month)
+      append(xml, L"Week", L"Last");
+    xml.append(L"</Weeks>");
+    append_bits(xml, L"DaysOfWeek", day_names, data.days_of_week);
+    append_bits(xml, L"Months", month_names, data.months_of_year);
+    break;
+  default:
+    break;
+  }
+  if (!schedule.empty())
+    xml.append(L"</").append(schedule).append(L">");
+  xml.append(L"</").append(element).append(L">");
+}
+
+/// @returns The trigger parsed from `element`, or `std::nullopt` on error.
+inline std::optional<Ref<ITrigger>> parse_trigger(const Element& element)
+{
+  const auto items = children(element.content);
+  if (!items)
+    return std::nullopt;
+
+  auto type = value_of(trigger_elements, element.name);
+  std::vector<Element> schedule;
+  if (element.name == L"CalendarTrigger") {
+    for (const auto& [t, name] : schedule_elements) {
+      if (const auto e = find(*items, name)) {
+        auto elements = children(e->content);
+        if (!elements)
+          return std::nullopt;
+        type = t;
+        schedule = std::move(*elements);
+        break;
+      }
+    }
+  }
+  if (!type)
+    return std::nullopt;
+
+  Trigger_data data;
+  data.id = unescape(attribute(element, L"id"));
+  if (!(parse(*items, L"StartBoundary", data.start_boundary)
+      && parse(*items, L"EndBoundary", data.end_boundary)
+      && parse(*items, L"ExecutionTimeLimit", data.execution_time_limit)
+      && parse(*items, L"Enabled", data.is_enabled)
+      && parse(*items, L"RandomDelay", data.random_delay)
+      && parse(schedule, L"DaysInterval", data.days_interval)
+      && parse(schedule, L"WeeksInterval", data.weeks_interval)))
+    return std::nullopt;
+
+  if (const auto e = find(*items, L"Repetition")) {
+    const auto elements = children(e->content);
+    Repetition_data repetition;
+    if (!elements
+      || !(parse(*elements, L"Interval", repetition.interval)
+        && parse(*elements, L"Duration", repetition.duration)
+        && parse(*elements, L"StopAtDurationEnd",
+          repetition.is_stopped_at_duration_end)))
+      return std::nullopt;
+    data.repetition = make<Repetition_pattern>(std::move(repetition));
+  }
+
+  // Parses the bitmask of days of week or months of year.
+  const auto parse_bits = [&schedule](const std::wstring_view name,
+    const auto& names, short& dest)
+  {
+    if (const auto e = find(schedule, name)) {
+      const auto elements = children(e->content);
+      if (!elements)
+        return false;
+      dest = static_cast<short>(bits(*elements, names));
+    }
+    return true;
+  };
+
+  // Parses the list of numbers (or "Last") of days of month or weeks.
+  const auto parse_numbers = [&schedule](const std::wstring_view name,
+    const std::wstring_view item, const int max, auto& dest, bool& is_last)
+  {
+    if (const auto e = find(schedule, name)) {
+      const auto elements = children(e->content);
+      if (!elements)
+        return false;
+      for (const auto& element : *elements) {
+        if (element.name != item)
+          return false;
+        const auto value = unescape(element.content);
+        if (value == L"Last") {
+          is_last = true;
+          continue;
+        }
+        wchar_t* end{};
+        const auto number = std::wcstol(value.c_str(), &end, 10);
+        if (value.empty() || *end || number < 1 || number > max)
+          return false;
+        dest |= static_cast<std::decay_t<decltype(dest)>>(1l << (number - 1));
+      }
+    }
+    return true;
+  };
+
+  if (!(parse_bits(L"DaysOfWeek", day_names, data.days_of_week)
+      && parse_bits(L"Months", month_names, data.months_of_year)
+      && parse_numbers(L"DaysOfMonth", L"Day", 31, data.days_of_month,
+        data.is_run_on_last_day_of_month)
+      && parse_numbers(L"Weeks", L"Week", 4, data.weeks_of_month,
+        data.is_run_on_last_week_of_month)))
+    return std::nullopt;
+
+  return make_trigger(*type, std::move(data));
+}
+
+} // namespace detail
+
+/**
+ * @returns The XML of the task definition in the format of Task Scheduler
+ * schema.
+ *
+ * @remarks Only the elements which are represented by the fake objects of
+ * definition are written.
+ */
+inline std::wstring to_xml(const Definition_data& definition)
+{
+  using namespace detail;
+  const auto registration = definition.registration_info->data();
+  const auto settings = definition.settings->data();
+  const auto principal = definition.principal->data();
+
+  std::wstring result{L"<?xml version=\"1.0\" encoding=\"UTF-16\"?>"};
+  result.append(L"<Task version=\"")
+    .append(name_of(compatibilities, settings.compatibility))
+    .append(L"\" xmlns=\"http://schemas.microsoft.com/windows/2004/02/mit/")
+    .append(L"task\">");
+
+  result.append(L"<RegistrationInfo>");
+  append(result, L"Date", registration.date);
+  append(result, L"Author", registration.author);
+  append(result, L"Version", registration.version);
+  append(result, L"Description", registration.description);
+  append(result, L"URI", registration.uri);
+  append(result, L"Source", registration.source);
+  append(result, L"Documentation", registration.documentation);
+  result.append(L"</RegistrationInfo>");
+
+  result.append(L"<Triggers>");
+  for (const auto& trigger : definition.triggers->items())
+    append_trigger(result, *trigger);
+  result.append(L"</Triggers>");
+
+  result.append(L"<Principals><Principal id=\"")
+    .append(escape(principal.id)).append(L"\">");
+  append(result, L"UserId", principal.user_id);
+  append(result, L"GroupId", principal.group_id);
+  append(result, L"DisplayName", principal.display_name);
+  if (principal.logon_type != TASK_LOGON_NONE)
+    append(result, L"LogonType", name_of(logon_types, principal.logon_type));
+  append(result, L"RunLevel", name_of(run_levels, principal.run_level));
+  result.append(L"</Principal></Principals>");
+
+  result.append(L"<Settings>");
+  append(result, L"MultipleInstancesPolicy",
+    name_of(instances_policies, settings.multiple_instances));
+  append_flag(result, L"DisallowStartIfOnBatteries",
+    settings.is_start_disallowed_on_batteries);
+  append_flag(result, L"StopIfGoingOnBatteries",
+    settings.is_stop_if_going_on_batteries);
+  append_flag(result, L"AllowHardTerminate",
+    settings.is_hard_terminate_allowed);
+  append_flag(result, L"StartWhenAvailable", settings.is_start_when_available);
+  append_flag(result, L"RunOnlyIfNetworkAvailable",
+    settings.is_run_only_if_network_available);
+  append_flag(result, L"AllowStartOnDemand", settings.is_demand_start_allowed);
+  append_flag(result, L"Enabled", settings.is_enabled);
+  append_flag(result, L"Hidden", settings.is_hidden);
+  append_flag(result, L"RunOnlyIfIdle", settings.is_run_only_if_idle);
+  append_flag(result, L"WakeToRun", settings.is_wake_to_run);
+  append(result, L"ExecutionTimeLimit", settings.execution_time_limit);
+  append(result, L"DeleteExpiredTaskAfter",
+    settings.delete_expired_task_after);
+  append(result, L"Priority", std::to_wstring(settings.priority));
+  if (!settings.restart_interval.empty()) {
+    result.append(L"<RestartOnFailure>");
+    append(result, L"Interval", settings.restart_interval);
+    append(result, L"Count", std::to_wstring(settings.restart_count));
+    result.append(L"</RestartOnFailure>");
+  }
+  result.append(L"</Settings>");
+
+  append(result, L"Data", definition.data);
+
+  result.append(L"<Actions Context=\"")
+    .append(escape(definition.actions->context())).append(L"\">");
+  for (const auto& action : definition.actions->items()) {
+    TASK_ACTION_TYPE type{};
+    action->get_Type(&type);
+    const auto data = action_data(*action);
+    const std::wstring_view element{type == TASK_ACTION_EXEC ?
+      L"Exec" : L"ComHandler"};
+    result.append(L"<").append(element);
+    if (!data.id.empty())
+      result.append(L" id=\"").append(escape(data.id)).append(L"\"");
+    result.append(L">");
+    if (type == TASK_ACTION_EXEC) {
+      append(result, L"Command", data.path);
+      append(result, L"Arguments", data.arguments);
+      append(result, L"WorkingDirectory", data.working_directory);
+    } else {
+      append(result, L"ClassId", data.class_id);
+      append(result, L"Data", data.data);
+    }
+    result.append(L"</").append(element).append(L">");
+  }
+  result.append(L"</Actions></Task>");
+  return result;
+}
+
+/**
+ * @returns The task definition parsed from `xml`, or `std::nullopt` if
+ * `xml` is malformed, contains unsupported triggers or actions, or contains
+ * no actions.
+ *
+ * @see to_xml().
+ */
+inline std::optional<Definition_data> from_xml(const std::wstring_view xml)
+{
+  using namespace detail;
+  const auto top = children(xml);
+  const auto task = top ? find(*top, L"Task") : std::nullopt;
+  const auto sections = task ? children(task->content) : std::nullopt;
+  if (!sections)
+    return std::nullopt;
+
+  Definition_data result;
+  Registration_data registration;
+  Settings_data settings;
+  Principal_data principal;
+  if (const auto version = attribute(*task, L"version"); !version.empty()) {
+    const auto compatibility = value_of(compatibilities, version);
+    if (!compatibility)
+      return std::nullopt;
+    settings.compatibility = *compatibility;
+  }
+
+  if (const auto e = find(*sections, L"RegistrationInfo")) {
+    const auto items = children(e->content);
+    if (!items
+      || !(parse(*items, L"Date", registration.date)
+        && parse(*items, L"Author", registration.author)
+        && parse(*items, L"Version", registration.version)
+        && parse(*items, L"Description", registration.description)
+        && parse(*items, L"URI", registration.uri)
+        && parse(*items, L"Source", registration.source)
+        && parse(*items, L"Documentation", registration.documentation)))
+      return std::nullopt;
+  }
+
+  if (const auto e = find(*sections, L"Triggers")) {
+    const auto items = children(e->content);
+    if (!items)
+      return std::nullopt;
+    for (const auto& item : *items) {
+      auto trigger = parse_trigger(item);
+      if (!trigger)
+        return std::nullopt;
+      result.triggers->add(std::move(*trigger));
+    }
+  }
+
+  if (const auto e = find(*sections, L"Principals")) {
+    const auto items = children(e->content);
+    if (!items)
+      return std::nullopt;
+    if (const auto p = find(*items, L"Principal")) {
+      if (const auto id = attribute(*p, L"id"); !id.empty())
+        principal.id = unescape(id);
+      const auto props = children(p->content);
+      if (!props
+        || !(parse(*props, L"UserId", principal.user_id)
+          && parse(*props, L"GroupId", principal.group_id)
+          && parse(*props, L"DisplayName", principal.display_name)
+          && parse(*props, L"LogonType", logon_types, principal.logon_type)
+          && parse(*props, L"RunLevel", run_levels, principal.run_level)))
+        return std::nullopt;
+    }
+  }
+
+  if (const auto e = find(*sections, L"Settings")) {
+    const auto items = children(e->content);
+    if (!items
+      || !(parse(*items, L"MultipleInstancesPolicy", instances_policies,
+          settings.multiple_instances)
+        && parse(*items, L"DisallowStartIfOnBatteries",
+          settings.is_start_disallowed_on_batteries)
+        && parse(*items, L"StopIfGoingOnBatteries",
+          settings.is_stop_if_going_on_batteries)
+        && parse(*items, L"AllowHardTerminate",
+          settings.is_hard_terminate_allowed)
+        && parse(*items, L"StartWhenAvailable",
+          settings.is_start_when_available)
+        && parse(*items, L"RunOnlyIfNetworkAvailable",
+          settings.is_run_only_if_network_available)
+        && parse(*items, L"AllowStartOnDemand",
+          settings.is_demand_start_allowed)
+        && parse(*items, L"Enabled", settings.is_enabled)
+        && parse(*items, L"Hidden", settings.is_hidden)
+        && parse(*items, L"RunOnlyIfIdle", settings.is_run_only_if_idle)
+        && parse(*items, L"WakeToRun", settings.is_wake_to_run)
+        && parse(*items, L"ExecutionTimeLimit",
+          settings.execution_time_limit)
+        && parse(*items, L"DeleteExpiredTaskAfter",
+          settings.delete_expired_task_after)
+        && parse(*items, L"Priority", settings.priority)))
+      return std::nullopt;
+    if (const auto r = find(*items, L"RestartOnFailure")) {
+      const auto props = children(r->content);
+      if (!props
+        || !(parse(*props, L"Interval", settings.restart_interval)
+          && parse(*props, L"Count", settings.restart_count)))
+        return std::nullopt;
+    }
+  }
+
+  if (!parse(*sections, L"Data", result.data))
+    return std::nullopt;
+
+  const auto actions = find(*sections, L"Actions");
+  const auto items = actions ? children(actions->content) : std::nullopt;
+  if (!items || items->empty())
+    return std::nullopt;
+  if (const auto context = attribute(*actions, L"Context"); !context.empty())
+    result.actions->set_context(unescape(context));
+  for (const auto& item : *items) {
+    const bool is_exec{item.name == L"Exec"};
+    if (!is_exec && item.name != L"ComHandler")
+      return std::nullopt;
+    const auto props = children(item.content);
+    Action_data data;
+    data.id = unescape(attribute(item, L"id"));
+    if (!props
+      || !(parse(*props, L"Command", data.path)
+        && parse(*props, L"Arguments", data.arguments)
+        && parse(*props, L"WorkingDirectory", data.working_directory)
+        && parse(*props, L"ClassId", data.class_id)
+        && parse(*props, L"Data", data.data)))
+      return std::nullopt;
+    result.actions->add(make_action(is_exec ? TASK_ACTION_EXEC :
+        TASK_ACTION_COM_HANDLER, std::move(data)));
+  }
+
+  result.registration_info = make<Registration_info>(std::move(registration));
+  result.settings = make<Task_settings>(std::move(settings));
+  result.principal = make<Principal>(std::move(principal));
+  return result;
+}
+
+/// The fake of `ITaskDefinition`.
+class Task_definition final : public Object<ITaskDefinition> {
+public:
+  explicit Task_definition(Definition_data data = {})
+    : properties_{std::move(data)}
+  {}
+
+  HRESULT get_RegistrationInfo(IRegistrationInfo** const result) override
+  {
+    return properties_.get("ITaskDefinition::get_RegistrationInfo",
+      &Definition_data::registration_info, result);
+  }
+
+  HRESULT put_RegistrationInfo(IRegistrationInfo* const value) override
+  {
+    return properties_.put("ITaskDefinition::put_RegistrationInfo",
+      &Definition_data::registration_info, value);
+  }
+
+  HRESULT get_Triggers(ITriggerCollection** const result) override
+  {
+    return properties_.get("ITaskDefinition::get_Triggers",
+      &Definition_data::triggers, result);
+  }
+
+  HRESULT put_Triggers(ITriggerCollection* const value) override
+  {
+    return properties_.put("ITaskDefinition::put_Triggers",
+      &Definition_data::triggers, value);
+  }
+
+  HRESULT get_Settings(ITaskSettings** const result) override
+  {
+    return properties_.get("ITaskDefinition::get_Settings",
+      &Definition_data::settings, result);
+  }
+
+  HRESULT put_Settings(ITaskSettings* const value) override
+  {
+    return properties_.put("ITaskDefinition::put_Settings",
+      &Definition_data::settings, value);
+  }
+
+  HRESULT get_Data(BSTR* const result) override
+  {
+    return properties_.get("ITaskDefinition::get_Data",
+      &Definition_data::data, result);
+  }
+
+  HRESULT put_Data(const BSTR value) override
+  {
+    return properties_.put("ITaskDefinition::put_Data",
+      &Definition_data::data, value);
+  }
+
+  HRESULT get_Principal(IPrincipal** const result) override
+  {
+    return properties_.get("ITaskDefinition::get_Principal",
+      &Definition_data::principal, result);
+  }
+
+  HRESULT put_Principal(IPrincipal* const value) override
+  {
+    return properties_.put("ITaskDefinition::put_Principal",
+      &Definition_data::principal, value);
+  }
+
+  HRESULT get_Actions(IActionCollection** const result) override
+  {
+    return properties_.get("ITaskDefinition::get_Actions",
+      &Definition_data::actions, result);
+  }
+
+  HRESULT put_Actions(IActionCollection* const value) override
+  {
+    return properties_.put("ITaskDefinition::put_Actions",
+      &Definition_data::actions, value);
+  }
+
+  HRESULT get_XmlText(BSTR* const result) override
+  {
+    if (const auto err = enter("ITaskDefinition::get_XmlText"); err != S_OK)
+      return err;
+    return get(to_xml(properties_.data()), result);
+  }
+
+  HRESULT put_XmlText(const BSTR value) override
+  {
+    if (const auto err = enter("ITaskDefinition::put_XmlText"); err != S_OK)
+      return err;
+    auto data = from_xml({value ? value : L"", SysStringLen(value)});
+    if (!data)
+      return SCHED_E_MALFORMEDXML;
+    properties_.with([&data](auto& d){std::swap(d, *data);});
+    return S_OK;
+  }
+
+  /// @returns The copy of the data.
+  Definition_data data() const
+  {
+    return properties_.data();
+  }
+
+private:
+  Property_store<Definition_data> properties_;
+};
+
+/**
+ * @returns The deep copy of `definition` made by round trip through XML, or
+ * null reference if `definition` cannot be represented in XML.
+ */
+inline Ref<Task_definition> clone(const Task_definition& definition)
+{
+  auto data = from_xml(to_xml(definition.data()));
+  return data ? make<Task_definition>(std::move(*data)) :
+    Ref<Task_definition>{};
+}
+
+// -----------------------------------------------------------------------------
+// Collection
+// -----------------------------------------------------------------------------
+
+namespace detail {
+
+/// @returns The non-empty components of the `\`-separated `path`.
+inline std::vector<std::wstring_view> split(const std::wstring_view path)
+{
+  std::vector<std::wstring_view> result;
+  for (std::size_t pos{}; pos < path.size();) {
+    const auto end = std::min(path.find(L'\\', pos), path.size());
+    if (end > pos)
+      result.push_back(path.substr(pos, end - pos));
+    pos = end + 1;
+  }
+  return result;
+}
+
+/// @returns The absolute path of `path` relative to folder `base`.
+inline std::wstring resolve(const std::wstring_view base,
+  const std::wstring_view path)
+{
+  std::wstring result;
+  const auto append_names = [&result](const std::wstring_view p)
+  {
+    for (const auto name : split(p))
+      result.append(L"\\").append(name);
+  };
+  if (path.empty() || path.front() != L'\\')
+    append_names(base);
+  append_names(path);
+  return result.empty() ? L"\\" : result;
+}
+
+/// @returns The last component of the absolute `path`.
+inline std::wstring_view leaf(const std::wstring_view path) noexcept
+{
+  return path.size() > 1 ? path.substr(path.find_last_of(L'\\') + 1) : path;
+}
+
+} // namespace detail
+
+/**
+ * @brief The fake of the read-only snapshot collection `I` of `Item`.
+ *
+ * @details The items can be retrieved either by 1-based index or by name
+ * (`T::name()`).
+ */
+template<class I, class Item, class T>
+class Collection final : public Object<I> {
+public:
+  /// @param interface The name of `I` to report the calls.
+  Collection(const std::string_view interface, std::vector<Ref<T>> items)
+    : count_method_{std::string{interface}.append("::get_Count")}
+    , item_method_{std::string{interface}.append("::get_Item")}
+    , items_{std::move(items)}
+  {}
+
+  HRESULT get_Count(LONG* const result) override
+  {
+    if (const auto err = enter(count_method_); err != S_OK)
+      return err;
+    return get(items_.size(), result);
+  }
+
+  HRESULT get_Item(const VARIANT index, Item** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter(item_method_); err != S_OK)
+      return err;
+
+    if (index.vt == VT_BSTR) {
+      const auto name = to_wstring(index);
+      const auto i = std::find_if(items_.begin(), items_.end(),
+        [&name](const auto& item){return detail::iequals(item->name(), name);});
+      return i != items_.end() ? get(*i, result) :
+        HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    }
+
+    VARIANT i{};
+    if (VariantChangeType(&i, &index, 0, VT_I4) != S_OK
+      || i.lVal < 1 || static_cast<std::size_t>(i.lVal) > items_.size())
+      return E_INVALIDARG;
+    return get(items_[i.lVal - 1], result);
+  }
+
+  HRESULT get__NewEnum(IUnknown** const result) override
+  {
+    return new_enum(items_, result);
+  }
+
+private:
+  std::string count_method_;
+  std::string item_method_;
+  std::vector<Ref<T>> items_;
+};
+
+// -----------------------------------------------------------------------------
+// Tasks
+// -----------------------------------------------------------------------------
+
+/// The data of running instance of task.
+struct Instance_data final {
+  std::wstring guid;
+  std::wstring path;
+  std::wstring current_action;
+  DWORD pid{};
+  bool is_hidden{};
+};
+
+/// The fake of `IRunningTask` which is the view of the instance in `store()`.
+class Running_task final : public Object<IRunningTask> {
+public:
+  explicit Running_task(Instance_data data)
+    : data_{std::move(data)}
+  {}
+
+  HRESULT get_Name(BSTR* const result) override
+  {
+    if (const auto err = enter("IRunningTask::get_Name"); err != S_OK)
+      return err;
+    return get(name(), result);
+  }
+
+  HRESULT get_InstanceGuid(BSTR* const result) override
+  {
+    if (const auto err = enter("IRunningTask::get_InstanceGuid"); err != S_OK)
+      return err;
+    return get(data_.guid, result);
+  }
+
+  HRESULT get_Path(BSTR* const result) override
+  {
+    if (const auto err = enter("IRunningTask::get_Path"); err != S_OK)
+      return err;
+    return get(data_.path, result);
+  }
+
+  /// @returns `TASK_STATE_UNKNOWN` if the instance is no longer running.
+  HRESULT get_State(TASK_STATE* result) override;
+
+  HRESULT get_CurrentAction(BSTR* const result) override
+  {
+    if (const auto err = enter("IRunningTask::get_CurrentAction");
+      err != S_OK)
+      return err;
+    return get(data_.current_action, result);
+  }
+
+  /// Stops the instance with `SCHED_S_TASK_TERMINATED`.
+  HRESULT Stop() override;
+
+  /// @returns `SCHED_E_TASK_NOT_RUNNING` if the instance is no longer running.
+  HRESULT Refresh() override;
+
+  HRESULT get_EnginePID(DWORD* const result) override
+  {
+    if (const auto err = enter("IRunningTask::get_EnginePID"); err != S_OK)
+      return err;
+    return get(data_.pid, result);
+  }
+
+  /// @returns The name of the task.
+  std::wstring_view name() const noexcept
+  {
+    return detail::leaf(data_.path);
+  }
+
+  /// @returns The data.
+  const Instance_data& data() const noexcept
+  {
+    return data_;
+  }
+
+private:
+  const Instance_data data_;
+};
+
+/// The data of registered task.
+struct Task_data final {
+  Ref<Task_definition> definition;
+  DATE last_run_time{};
+  LONG last_task_result{SCHED_S_TASK_HAS_NOT_RUN};
+  LONG number_of_missed_runs{};
+  DATE next_run_time{};
+};
+
+/// The fake of `IRegisteredTask`.
+class Registered_task final : public Object<IRegisteredTask> {
+public:
+  /// @param path The absolute path.
+  Registered_task(std::wstring path, Ref<Task_definition> definition)
+    : path_{std::move(path)}
+    , properties_{Task_data{std::move(definition)}}
+  {}
+
+  HRESULT get_Name(BSTR* const result) override
+  {
+    if (const auto err = enter("IRegisteredTask::get_Name"); err != S_OK)
+      return err;
+    return get(name(), result);
+  }
+
+  HRESULT get_Path(BSTR* const result) override
+  {
+    if (const auto err = enter("IRegisteredTask::get_Path"); err != S_OK)
+      return err;
+    return get(path_, result);
+  }
+
+  /**
+   * @returns `TASK_STATE_RUNNING` if there are running instances, or either
+   * `TASK_STATE_READY` or `TASK_STATE_DISABLED` otherwise.
+   */
+  HRESULT get_State(TASK_STATE* result) override;
+
+  HRESULT get_Enabled(VARIANT_BOOL* const result) override
+  {
+    if (const auto err = enter("IRegisteredTask::get_Enabled"); err != S_OK)
+      return err;
+    return get(settings().is_enabled, result);
+  }
+
+  HRESULT put_Enabled(const VARIANT_BOOL value) override
+  {
+    if (const auto err = enter("IRegisteredTask::put_Enabled"); err != S_OK)
+      return err;
+    definition()->data().settings->with([value](auto& data)
+    {
+      data.is_enabled = value != VARIANT_FALSE;
+    });
+    return S_OK;
+  }
+
+  HRESULT Run(VARIANT, IRunningTask** const result) override
+  {
+    return run("IRegisteredTask::Run", TASK_RUN_NO_FLAGS, result);
+  }
+
+  HRESULT RunEx(VARIANT, const LONG flags, LONG, BSTR,
+    IRunningTask** const result) override
+  {
+    return run("IRegisteredTask::RunEx", flags, result);
+  }
+
+  HRESULT GetInstances(LONG flags, IRunningTaskCollection** result) override;
+
+  HRESULT get_LastRunTime(DATE* const result) override
+  {
+    return properties_.get("IRegisteredTask::get_LastRunTime",
+      &Task_data::last_run_time, result);
+  }
+
+  HRESULT get_LastTaskResult(LONG* const result) override
+  {
+    return properties_.get("IRegisteredTask::get_LastTaskResult",
+      &Task_data::last_task_result, result);
+  }
+
+  HRESULT get_NumberOfMissedRuns(LONG* const result) override
+  {
+    return properties_.get("IRegisteredTask::get_NumberOfMissedRuns",
+      &Task_data::number_of_missed_runs, result);
+  }
+
+  HRESULT get_NextRunTime(DATE* const result) override
+  {
+    return properties_.get("IRegisteredTask::get_NextRunTime",
+      &Task_data::next_run_time, result);
+  }
+
+  /// Provides the copy of the definition, as does Task Scheduler.
+  HRESULT get_Definition(ITaskDefinition** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("IRegisteredTask::get_Definition");
+      err != S_OK)
+      return err;
+    const auto copy = clone(*definition());
+    return copy ? get(copy, result) : E_UNEXPECTED;
+  }
+
+  HRESULT get_Xml(BSTR* const result) override
+  {
+    if (const auto err = enter("IRegisteredTask::get_Xml"); err != S_OK)
+      return err;
+    return get(to_xml(definition()->data()), result);
+  }
+
+  /// Stops all the running instances with `SCHED_S_TASK_TERMINATED`.
+  HRESULT Stop(LONG flags) override;
+
+  /// @returns The absolute path.
+  const std::wstring& path() const noexcept
+  {
+    return path_;
+  }
+
+  /// @returns The name.
+  std::wstring_view name() const noexcept
+  {
+    return detail::leaf(path_);
+  }
+
+  /// @returns The definition.
+  Ref<Task_definition> definition() const
+  {
+    return properties_.data().definition;
+  }
+
+  /// @returns The copy of the settings of the definition.
+  Settings_data settings() const
+  {
+    return definition()->data().settings->data();
+  }
+
+  /// Replaces the definition.
+  /// @returns The replaced definition.
+  Ref<Task_definition> set_definition(Ref<Task_definition> value)
+  {
+    properties_.with([&value](auto& data){data.definition.swap(value);});
+    return value;
+  }
+
+  /// Sets the time of the last run and its result.
+  void set_last_run(const DATE time, const LONG result)
+  {
+    properties_.with([time, result](auto& data)
+    {
+      data.last_run_time = time;
+      data.last_task_result = result;
+    });
+  }
+
+  /// Sets the result of the last run.
+  void set_last_task_result(const LONG value)
+  {
+    properties_.with([value](auto& data){data.last_task_result = value;});
+  }
+
+  /// Sets the time of the next scheduled run.
+  void set_next_run_time(const DATE value)
+  {
+    properties_.with([value](auto& data){data.next_run_time = value;});
+  }
+
+  /// Sets the number of the missed runs.
+  void set_number_of_missed_runs(const LONG value)
+  {
+    properties_.with([value](auto& data)
+    {
+      data.number_of_missed_runs = value;
+    });
+  }
+
+private:
+  const std::wstring path_;
+  Property_store<Task_data> properties_;
+
+  HRESULT run(std::string_view method, LONG flags, IRunningTask** result);
+};
+
+// -----------------------------------------------------------------------------
+// Store
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief The state of the fake Task Scheduler: the tree of folders with the
+ * registered tasks and the running instances.
+ *
+ * @details The instances run until stopped or finished explicitly unless
+ * the run duration is set, in which case they finish successfully when it
+ * elapses.
+ */
+class Store final {
+public:
+  /// Removes all the folders, tasks and running instances.
+  void clear()
+  {
+    Folder root;
+    std::vector<Instance> instances;
+    const std::lock_guard lg{mutex_};
+    std::swap(root, root_);
+    instances.swap(instances_);
+  }
+
+  /**
+   * @brief Creates the folder at the absolute `path` and the missing folders
+   * above it.
+   *
+   * @returns `HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS)` if it already exists.
+   */
+  HRESULT create_folder(const std::wstring_view path)
+  {
+    const auto names = detail::split(path);
+    bool is_created{};
+    const std::lock_guard lg{mutex_};
+    auto* folder = &root_;
+    for (const auto name : names) {
+      auto i = folder->folders.find(name);
+      if (i == folder->folders.end()) {
+        i = folder->folders.emplace(std::wstring{name},
+          std::make_unique<Folder>()).first;
+        is_created = true;
+      }
+      folder = i->second.get();
+    }
+    return is_created ? S_OK : HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS);
+  }
+
+  /// @returns `true` if the folder at the absolute `path` exists.
+  bool has_folder(const std::wstring_view path) const
+  {
+    const auto names = detail::split(path);
+    const std::lock_guard lg{mutex_};
+    return find_folder(root_, names);
+  }
+
+  /**
+   * @returns The absolute path of the folder at the absolute `path` in the
+   * letter case of its creation, or `std::nullopt` if there is no such a
+   * folder.
+   */
+  std::optional<std::wstring> folder_path(const std::wstring_view path) const
+  {
+    const auto names = detail::split(path);
+    std::wstring result;
+    const std::lock_guard lg{mutex_};
+    const auto* folder = &root_;
+    for (const auto name : names) {
+      const auto i = folder->folders.find(name);
+      if (i == folder->folders.end())
+        return std::nullopt;
+      result.append(L"\\").append(i->first);
+      folder = i->second.get();
+    }
+    return result.empty() ? std::wstring{L"\\"} : result;
+  }
+
+  /**
+   * @brief Deletes the empty folder at the absolute `path`.
+   *
+   * @returns `HRESULT_FROM_WIN32(ERROR_DIR_NOT_EMPTY)` if it's not empty.
+   */
+  HRESULT delete_folder(const std::wstring_view path)
+  {
+    const auto names = detail::split(path);
+    if (names.empty())
+      return E_INVALIDARG;
+
+    std::unique_ptr<Folder> removed;
+    const std::lock_guard lg{mutex_};
+    auto* const parent = find_folder(root_,
+      std::span{names}.first(names.size() - 1));
+    if (!parent)
+      return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    const auto i = parent->folders.find(names.back());
+    if (i == parent->folders.end())
+      return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    else if (!i->second->folders.empty() || !i->second->tasks.empty())
+      return HRESULT_FROM_WIN32(ERROR_DIR_NOT_EMPTY);
+    removed = std::move(i->second);
+    parent->folders.erase(i);
+    return S_OK;
+  }
+
+  /**
+   * @returns The absolute paths of the subfolders of the folder at the
+   * absolute `path`, or `std::nullopt` if there is no such a folder.
+   */
+  std::optional<std::vector<std::wstring>>
+  folders(const std::wstring_view path) const
+  {
+    const auto names = detail::split(path);
+    const std::lock_guard lg{mutex_};
+    const auto* const folder = find_folder(root_, names);
+    if (!folder)
+      return std::nullopt;
+    std::vector<std::wstring> result;
+    for (const auto& [name, _] : folder->folders)
+      result.push_back(detail::resolve(path, name));
+    return result;
+  }
+
+  /// @returns The task at the absolute `path`, or null reference.
+  Ref<Registered_task> task(const std::wstring_view path) const
+  {
+    const auto names = detail::split(path);
+    if (names.empty())
+      return Ref<Registered_task>{};
+    const std::lock_guard lg{mutex_};
+    const auto* const folder = find_folder(root_,
+      std::span{names}.first(names.size() - 1));
+    if (!folder)
+      return Ref<Registered_task>{};
+    const auto i = folder->tasks.find(names.back());
+    return i != folder->tasks.end() ? i->second : Ref<Registered_task>{};
+  }
+
+  /**
+   * @returns The tasks of the folder at the absolute `path`, or
+   * `std::nullopt` if there is no such a folder.
+   */
+  std::optional<std::vector<Ref<Registered_task>>>
+  tasks(const std::wstring_view path, const bool is_hidden_included) const
+  {
+    const auto names = detail::split(path);
+    const std::lock_guard lg{mutex_};
+    const auto* const folder = find_folder(root_, names);
+    if (!folder)
+      return std::nullopt;
+    std::vector<Ref<Registered_task>> result;
+    for (const auto& [_, task] : folder->tasks) {
+      if (is_hidden_included || !task->settings().is_hidden)
+        result.push_back(task);
+    }
+    return result;
+  }
+
+  /// Deletes the task at the absolute `path`.
+  HRESULT delete_task(const std::wstring_view path)
+  {
+    const auto names = detail::split(path);
+    if (names.empty())
+      return E_INVALIDARG;
+
+    Ref<Registered_task> removed;
+    const std::lock_guard lg{mutex_};
+    auto* const folder = find_folder(root_,
+      std::span{names}.first(names.size() - 1));
+    if (!folder)
+      return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    const auto i = folder->tasks.find(names.back());
+    if (i == folder->tasks.end())
+      return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    removed = std::move(i->second);
+    folder->tasks.erase(i);
+    return S_OK;
+  }
+
+  /**
+   * @brief Registers `definition` at the absolute `path` according to
+   * `flags` (a combination of `TASK_CREATION`). Creates the missing folders.
+   *
+   * @param[out] result The registered task, or null reference if
+   * `TASK_VALIDATE_ONLY` is specified.
+   *
+   * @returns `HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS)` if the task exists
+   * and `TASK_UPDATE` is not specified, or
+   * `HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND)` if the task doesn't exist and
+   * `TASK_CREATE` is not specified.
+   */
+  HRESULT register_task(const std::wstring_view path,
+    Ref<Task_definition> definition, const LONG flags,
+    Ref<Registered_task>& result)
+  {
+    const auto names = detail::split(path);
+    if (names.empty() || !definition)
+      return E_INVALIDARG;
+    else if (flags & TASK_VALIDATE_ONLY)
+      return S_OK;
+    else if (flags & TASK_DISABLE)
+      definition->data().settings->with([](auto& s){s.is_enabled = false;});
+
+    std::wstring task_path;
+    const std::lock_guard lg{mutex_};
+    auto* folder = &root_;
+    for (const auto name : std::span{names}.first(names.size() - 1)) {
+      auto i = folder->folders.find(name);
+      if (i == folder->folders.end())
+        i = folder->folders.emplace(std::wstring{name},
+          std::make_unique<Folder>()).first;
+      task_path.append(L"\\").append(i->first);
+      folder = i->second.get();
+    }
+
+    auto i = folder->tasks.find(names.back());
+    if (i == folder->tasks.end()) {
+      if (!(flags & TASK_CREATE))
+        return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+      task_path.append(L"\\").append(names.back());
+      i = folder->tasks.emplace(std::wstring{names.back()},
+        make<Registered_task>(std::move(task_path),
+          std::move(definition))).first;
+    } else {
+      if (!(flags & TASK_UPDATE))
+        return HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS);
+      // The old definition is released outside the lock.
+      definition = i->second->set_definition(std::move(definition));
+    }
+    result = i->second;
+    return S_OK;
+  }
+
+  /**
+   * @brief Sets the duration of the instances started after this call.
+   *
+   * @param value The duration, or `std::nullopt` (the default) to run the
+   * instances until they are stopped or finished explicitly.
+   */
+  void set_run_duration(const std::optional<std::chrono::microseconds> value)
+  {
+    const std::lock_guard lg{mutex_};
+    run_duration_ = value;
+  }
+
+  /**
+   * @brief Starts the instance of `task` according to `policy`.
+   *
+   * @param data The data of the instance without GUID and PID.
+   *
+   * @returns The started instance, or the running one if `policy` is
+   * `TASK_INSTANCES_IGNORE_NEW`.
+   */
+  Ref<Running_task> run(Registered_task& task, Instance_data data,
+    const TASK_INSTANCES_POLICY policy)
+  {
+    const std::lock_guard lg{mutex_};
+    expire();
+    const auto is_task = [&path = task.path()](const Instance& instance)
+    {
+      return instance.data.path == path;
+    };
+    if (policy == TASK_INSTANCES_IGNORE_NEW) {
+      const auto i = std::find_if(instances_.begin(), instances_.end(),
+        is_task);
+      if (i != instances_.end())
+        return make<Running_task>(i->data);
+    } else if (policy == TASK_INSTANCES_STOP_EXISTING)
+      finish_if(is_task, SCHED_S_TASK_TERMINATED);
+
+    data.guid = detail::new_guid();
+    data.pid = next_pid_++;
+    auto& instance = instances_.emplace_back(Instance{std::move(data), {}});
+    if (run_duration_)
+      instance.deadline = std::chrono::steady_clock::now() + *run_duration_;
+    task.set_last_run(detail::now(), SCHED_S_TASK_RUNNING);
+    return make<Running_task>(instance.data);
+  }
+
+  /**
+   * @returns The running instances of the task at the absolute `path`, or of
+   * all the tasks if `path` is empty.
+   */
+  std::vector<Ref<Running_task>> running(const std::wstring_view path,
+    const bool is_hidden_included)
+  {
+    const std::lock_guard lg{mutex_};
+    expire();
+    std::vector<Ref<Running_task>> result;
+    for (const auto& instance : instances_) {
+      if ((path.empty() || detail::iequals(instance.data.path, path))
+        && (is_hidden_included || !instance.data.is_hidden))
+        result.push_back(make<Running_task>(instance.data));
+    }
+    return result;
+  }
+
+  /// @returns `true` if the instance identified by `guid` is running.
+  bool is_running(const std::wstring_view guid)
+  {
+    const std::lock_guard lg{mutex_};
+    expire();
+    return std::any_of(instances_.begin(), instances_.end(),
+      [guid](const auto& instance){return instance.data.guid == guid;});
+  }
+
+  /// @returns `true` if there are running instances of task at `path`.
+  bool is_task_running(const std::wstring_view path)
+  {
+    const std::lock_guard lg{mutex_};
+    expire();
+    return std::any_of(instances_.begin(), instances_.end(),
+      [path](const auto& instance)
+      {
+        return detail::iequals(instance.data.path, path);
+      });
+  }
+
+  /**
+   * @brief Finishes the instance identified by `guid` with `result`.
+   *
+   * @returns `false` if there is no such a running instance.
+   */
+  bool finish(const std::wstring_view guid, const LONG result = S_OK)
+  {
+    const std::lock_guard lg{mutex_};
+    expire();
+    return finish_if([guid](const auto& instance)
+    {
+      return instance.data.guid == guid;
+    }, result);
+  }
+
+  /**
+   * @brief Finishes the instances of the task at the absolute `path` (or all
+   * the instances if `path` is empty) with `result`.
+   *
+   * @returns The number of finished instances.
+   */
+  std::size_t finish_all(const std::wstring_view path = {},
+    const LONG result = S_OK)
+  {
+    const std::lock_guard lg{mutex_};
+    expire();
+    return finish_if([path](const auto& instance)
+    {
+      return path.empty() || detail::iequals(instance.data.path, path);
+    }, result);
+  }
+
+private:
+  struct Folder final {
+    std::map<std::wstring, std::unique_ptr<Folder>, detail::Iless> folders;
+    std::map<std::wstring, Ref<Registered_task>, detail::Iless> tasks;
+  };
+
+  struct Instance final {
+    Instance_data data;
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+  };
+
+  mutable std::mutex mutex_;
+  Folder root_;
+  std::vector<Instance> instances_;
+  std::optional<std::chrono::microseconds> run_duration_;
+  DWORD next_pid_{1000};
+
+  template<class F>
+  static F* find_folder(F& root, const std::span<const std::wstring_view> names)
+  {
+    F* result{&root};
+    for (const auto name : names) {
+      const auto i = result->folders.find(name);
+      if (i == result->folders.end())
+        return nullptr;
+      result = i->second.get();
+    }
+    return result;
+  }
+
+  /// Finishes the instances which satisfy `pred` with `result`.
+  template<class Predicate>
+  std::size_t finish_if(const Predicate& pred, const LONG result)
+  {
+    std::size_t count{};
+    for (const auto& instance : instances_) {
+      if (pred(instance)) {
+        const auto names = detail::split(instance.data.path);
+        if (auto* const folder = find_folder(root_,
+            std::span{names}.first(names.size() - 1))) {
+          if (const auto i = folder->tasks.find(names.back());
+            i != folder->tasks.end())
+            i->second->set_last_task_result(result);
+        }
+        ++count;
+      }
+    }
+    std::erase_if(instances_, pred);
+    return count;
+  }
+
+  /// Finishes the instances which run longer than the run duration.
+  void expire()
+  {
+    const auto now = std::chrono::steady_clock::now();
+    finish_if([now](const auto& instance)
+    {
+      return instance.deadline && *instance.deadline <= now;
+    }, S_OK);
+  }
+};
+
+/// @returns The instance of the store.
+inline Store& store()
+{
+  static Store result;
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Running_task and Registered_task implementation
+// -----------------------------------------------------------------------------
+
+inline HRESULT Running_task::get_State(TASK_STATE* const result)
+{
+  if (const auto err = enter("IRunningTask::get_State"); err != S_OK)
+    return err;
+  return get(store().is_running(data_.guid) ? TASK_STATE_RUNNING :
+    TASK_STATE_UNKNOWN, result);
+}
+
+inline HRESULT Running_task::Stop()
+{
+  if (const auto err = enter("IRunningTask::Stop"); err != S_OK)
+    return err;
+  return store().finish(data_.guid, SCHED_S_TASK_TERMINATED) ? S_OK :
+    SCHED_E_TASK_NOT_RUNNING;
+}
+
+inline HRESULT Running_task::Refresh()
+{
+  if (const auto err = enter("IRunningTask::Refresh"); err != S_OK)
+    return err;
+  return store().is_running(data_.guid) ? S_OK : SCHED_E_TASK_NOT_RUNNING;
+}
+
+inline HRESULT Registered_task::get_State(TASK_STATE* const result)
+{
+  if (const auto err = enter("IRegisteredTask::get_State"); err != S_OK)
+    return err;
+  return get(store().is_task_running(path_) ? TASK_STATE_RUNNING :
+    settings().is_enabled ? TASK_STATE_READY : TASK_STATE_DISABLED, result);
+}
+
+inline HRESULT Registered_task::GetInstances(const LONG flags,
+  IRunningTaskCollection** const result)
+{
+  if (!result)
+    return E_POINTER;
+  *result = nullptr;
+  if (const auto err = enter("IRegisteredTask::GetInstances"); err != S_OK)
+    return err;
+  else if (flags)
+    return E_INVALIDARG;
+  return get(make<Collection<IRunningTaskCollection, IRunningTask,
+    Running_task>>("IRunningTaskCollection", store().running(path_, true)),
+    result);
+}
+
+inline HRESULT Registered_task::Stop(LONG)
+{
+  if (const auto err = enter("IRegisteredTask::Stop"); err != S_OK)
+    return err;
+  store().finish_all(path_, SCHED_S_TASK_TERMINATED);
+  return S_OK;
+}
+
+inline HRESULT Registered_task::run(const std::string_view method,
+  const LONG flags, IRunningTask** const result)
+{
+  if (!result)
+    return E_POINTER;
+  *result = nullptr;
+  if (const auto err = enter(method); err != S_OK)
+    return err;
+
+  const auto data = definition()->data();
+  const auto settings = data.settings->data();
+  if (!(flags & TASK_RUN_IGNORE_CONSTRAINTS)) {
+    if (!settings.is_enabled)
+      return SCHED_E_TASK_DISABLED;
+    else if (!settings.is_demand_start_allowed)
+      return E_ACCESSDENIED;
+  }
+
+  Instance_data instance{{}, path_, {}, {}, settings.is_hidden};
+  if (const auto actions = data.actions->items(); !actions.empty())
+    instance.current_action = action_data(*actions.front()).path;
+  return get(store().run(*this, std::move(instance),
+    settings.multiple_instances), result);
+}
+
+// -----------------------------------------------------------------------------
+// Task_folder
+// -----------------------------------------------------------------------------
+
+/// The fake of `ITaskFolder` which is the view of the folder in `store()`.
+class Task_folder final : public Object<ITaskFolder> {
+public:
+  /// @param path The absolute path.
+  explicit Task_folder(std::wstring path)
+    : path_{std::move(path)}
+  {}
+
+  HRESULT get_Name(BSTR* const result) override
+  {
+    if (const auto err = enter("ITaskFolder::get_Name"); err != S_OK)
+      return err;
+    return get(name(), result);
+  }
+
+  HRESULT get_Path(BSTR* const result) override
+  {
+    if (const auto err = enter("ITaskFolder::get_Path"); err != S_OK)
+      return err;
+    return get(path_, result);
+  }
+
+  HRESULT GetFolder(const BSTR path, ITaskFolder** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("ITaskFolder::GetFolder"); err != S_OK)
+      return err;
+    const auto resolved = resolve(path);
+    auto folder_path = store().folder_path(resolved);
+    if (!folder_path)
+      return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    return get(make<Task_folder>(std::move(*folder_path)), result);
+  }
+
+  HRESULT GetFolders(const LONG flags,
+    ITaskFolderCollection** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("ITaskFolder::GetFolders"); err != S_OK)
+      return err;
+    else if (flags)
+      return E_INVALIDARG;
+    const auto paths = store().folders(path_);
+    if (!paths)
+      return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    std::vector<Ref<Task_folder>> folders;
+    for (const auto& path : *paths)
+      folders.push_back(make<Task_folder>(path));
+    return get(make<Collection<ITaskFolderCollection, ITaskFolder,
+      Task_folder>>("ITaskFolderCollection", std::move(folders)), result);
+  }
+
+  HRESULT CreateFolder(const BSTR name, VARIANT,
+    ITaskFolder** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("ITaskFolder::CreateFolder"); err != S_OK)
+      return err;
+    const auto resolved = resolve(name);
+    if (const auto err = store().create_folder(resolved); err != S_OK)
+      return err;
+    auto folder_path = store().folder_path(resolved);
+    return folder_path ? get(make<Task_folder>(std::move(*folder_path)),
+      result) : HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+  }
+
+  HRESULT DeleteFolder(const BSTR name, LONG) override
+  {
+    if (const auto err = enter("ITaskFolder::DeleteFolder"); err != S_OK)
+      return err;
+    return store().delete_folder(resolve(name));
+  }
+
+  HRESULT GetTask(const BSTR path, IRegisteredTask** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("ITaskFolder::GetTask"); err != S_OK)
+      return err;
+    const auto task = store().task(resolve(path));
+    return task ? get(task, result) : HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+  }
+
+  HRESULT GetTasks(const LONG flags,
+    IRegisteredTaskCollection** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("ITaskFolder::GetTasks"); err != S_OK)
+      return err;
+    auto tasks = store().tasks(path_, flags & TASK_ENUM_HIDDEN);
+    if (!tasks)
+      return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    return get(make<Collection<IRegisteredTaskCollection, IRegisteredTask,
+      Registered_task>>("IRegisteredTaskCollection", std::move(*tasks)),
+      result);
+  }
+
+  HRESULT DeleteTask(const BSTR name, LONG) override
+  {
+    if (const auto err = enter("ITaskFolder::DeleteTask"); err != S_OK)
+      return err;
+    return store().delete_task(resolve(name));
+  }
+
+  /**
+   * @details The principal is updated with `user_id` and `logon_type`
+   * (if they are specified). The other credentials and `sddl` are ignored.
+   * The task is named by the new GUID if `path` is empty.
+   */
+  HRESULT RegisterTask(const BSTR path, const BSTR xml, const LONG flags,
+    const VARIANT user_id, VARIANT, const TASK_LOGON_TYPE logon_type, VARIANT,
+    IRegisteredTask** const result) override
+  {
+    if (result)
+      *result = nullptr;
+    if (const auto err = enter("ITaskFolder::RegisterTask"); err != S_OK)
+      return err;
+    return register_task(path, {xml ? xml : L"", SysStringLen(xml)}, flags,
+      to_wstring(user_id), logon_type, result);
+  }
+
+  /// @see RegisterTask().
+  HRESULT RegisterTaskDefinition(const BSTR path,
+    ITaskDefinition* const definition, const LONG flags,
+    const VARIANT user_id, VARIANT, const TASK_LOGON_TYPE logon_type, VARIANT,
+    IRegisteredTask** const result) override
+  {
+    if (result)
+      *result = nullptr;
+    if (const auto err = enter("ITaskFolder::RegisterTaskDefinition");
+      err != S_OK)
+      return err;
+    const auto* const object = dynamic_cast<Task_definition*>(definition);
+    if (!object)
+      return E_INVALIDARG;
+    return register_task(path, to_xml(object->data()), flags,
+      to_wstring(user_id), logon_type, result);
+  }
+
+  /// @returns The name.
+  std::wstring_view name() const noexcept
+  {
+    return detail::leaf(path_);
+  }
+
+private:
+  const std::wstring path_;
+
+  std::wstring resolve(const BSTR path) const
+  {
+    return detail::resolve(path_, {path ? path : L"", SysStringLen(path)});
+  }
+
+  HRESULT register_task(const BSTR path, const std::wstring_view xml,
+    const LONG flags, const std::wstring& user_id,
+    const TASK_LOGON_TYPE logon_type, IRegisteredTask** const result) const
+  {
+    auto data = from_xml(xml);
+    if (!data)
+      return SCHED_E_MALFORMEDXML;
+    data->principal->with([&user_id, logon_type](auto& principal)
+    {
+      if (!user_id.empty())
+        principal.user_id = user_id;
+      if (logon_type != TASK_LOGON_NONE)
+        principal.logon_type = logon_type;
+    });
+
+    const auto resolved = SysStringLen(path) ?
+      resolve(path) : detail::resolve(path_, detail::new_guid());
+    Ref<Registered_task> task;
+    const auto err = store().register_task(resolved,
+      make<Task_definition>(std::move(*data)), flags, task);
+    if (err == S_OK && result && task)
+      *result = task.copy();
+    return err;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Task_service
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief The fake of `ITaskService`.
+ *
+ * @details The methods except `Connect()` and `get_Connected()` return
+ * `HRESULT_FROM_WIN32(ERROR_ONLY_IF_CONNECTED)` until connected.
+ */
+class Task_service final : public Object<ITaskService> {
+public:
+  HRESULT GetFolder(const BSTR path, ITaskFolder** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("ITaskService::GetFolder"); err != S_OK)
+      return err;
+    else if (!is_connected())
+      return HRESULT_FROM_WIN32(ERROR_ONLY_IF_CONNECTED);
+    const auto resolved = detail::resolve(L"\\",
+      {path ? path : L"", SysStringLen(path)});
+    auto folder_path = store().folder_path(resolved);
+    if (!folder_path)
+      return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    return get(make<Task_folder>(std::move(*folder_path)), result);
+  }
+
+  HRESULT GetRunningTasks(const LONG flags,
+    IRunningTaskCollection** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("ITaskService::GetRunningTasks"); err != S_OK)
+      return err;
+    else if (!is_connected())
+      return HRESULT_FROM_WIN32(ERROR_ONLY_IF_CONNECTED);
+    return get(make<Collection<IRunningTaskCollection, IRunningTask,
+      Running_task>>("IRunningTaskCollection",
+        store().running({}, flags & TASK_ENUM_HIDDEN)), result);
+  }
+
+  HRESULT NewTask(const DWORD flags, ITaskDefinition** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (const auto err = enter("ITaskService::NewTask"); err != S_OK)
+      return err;
+    else if (!is_connected())
+      return HRESULT_FROM_WIN32(ERROR_ONLY_IF_CONNECTED);
+    else if (flags)
+      return E_INVALIDARG;
+    return get(make<Task_definition>(), result);
+  }
+
+  /// Connects to any server with any credentials.
+  HRESULT Connect(const VARIANT server_name, VARIANT, VARIANT,
+    VARIANT) override
+  {
+    if (const auto err = enter("ITaskService::Connect"); err != S_OK)
+      return err;
+    const std::lock_guard lg{mutex_};
+    server_ = to_wstring(server_name);
+    if (server_.empty())
+      server_ = L"localhost";
+    return S_OK;
+  }
+
+  HRESULT get_Connected(VARIANT_BOOL* const result) override
+  {
+    if (const auto err = enter("ITaskService::get_Connected"); err != S_OK)
+      return err;
+    return get(is_connected(), result);
+  }
+
+  HRESULT get_TargetServer(BSTR* const result) override
+  {
+    if (const auto err = enter("ITaskService::get_TargetServer"); err != S_OK)
+      return err;
+    else if (!is_connected())
+      return HRESULT_FROM_WIN32(ERROR_ONLY_IF_CONNECTED);
+    const std::lock_guard lg{mutex_};
+    return get(server_, result);
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::wstring server_;
+
+  bool is_connected() const
+  {
+    const std::lock_guard lg{mutex_};
+    return !server_.empty();
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Registration
+// -----------------------------------------------------------------------------
+
+/// Registers the classes of the fake Task Scheduler.
+inline void register_classes()
+{
+  register_class(__uuidof(TaskScheduler), [](REFIID id, void** const result)
+  {
+    return make<Task_service>()->QueryInterface(id, result);
+  });
+}
+
+} // namespace dmitigr::wincom::fake::tasc
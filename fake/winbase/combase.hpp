@@ -0,0 +1,170 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+ * The stand-in of the subset of winbase/combase.hpp used by the wrappers
+ * (see windows.hpp).
+ */
+
+#include "../comdef.hpp"
+#include "../runtime.hpp"
+
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace dmitigr::winbase {
+
+/// @returns The UTF-8 representation of `str`.
+inline std::string utf16_to_utf8(const std::wstring_view str)
+{
+  return wincom::fake::detail::to_utf8(str);
+}
+
+} // namespace dmitigr::winbase
+
+namespace dmitigr::winbase::com {
+
+/// @returns The UTF-8 representation of `str`.
+inline std::string to_string(const BSTR str)
+{
+  return str ? utf16_to_utf8({str, SysStringLen(str)}) : std::string{};
+}
+
+/// The owning `VARIANT`.
+class Variant final {
+public:
+  /// The destructor.
+  ~Variant()
+  {
+    VariantClear(&data_);
+  }
+
+  /// Constructs `VT_EMPTY`.
+  Variant() noexcept
+  {
+    VariantInit(&data_);
+  }
+
+  /// Constructs `VT_BSTR`.
+  Variant(const wchar_t* const value)
+    : Variant{}
+  {
+    if (value) {
+      data_.vt = VT_BSTR;
+      data_.bstrVal = _bstr_t{value}.Detach();
+    }
+  }
+
+  /// @overload
+  Variant(const std::wstring& value)
+    : Variant{value.c_str()}
+  {}
+
+  /// @overload
+  Variant(const char* const value)
+    : Variant{}
+  {
+    if (value) {
+      data_.vt = VT_BSTR;
+      data_.bstrVal = _bstr_t{value}.Detach();
+    }
+  }
+
+  /// @overload
+  Variant(const std::string& value)
+    : Variant{value.c_str()}
+  {}
+
+  /// Constructs `VT_I4`.
+  Variant(const long value) noexcept
+    : Variant{}
+  {
+    data_.vt = VT_I4;
+    data_.lVal = value;
+  }
+
+  /// Constructs `VT_BOOL`.
+  Variant(const bool value) noexcept
+    : Variant{}
+  {
+    data_.vt = VT_BOOL;
+    data_.boolVal = value ? VARIANT_TRUE : VARIANT_FALSE;
+  }
+
+  /// The copy constructor.
+  Variant(const Variant& rhs)
+    : Variant{}
+  {
+    if (const auto err = VariantCopy(&data_, &rhs.data_); err != S_OK)
+      _com_issue_error(err);
+  }
+
+  /// The copy assignment.
+  Variant& operator=(const Variant& rhs)
+  {
+    if (this != &rhs) {
+      Variant tmp{rhs};
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  /// The move constructor.
+  Variant(Variant&& rhs) noexcept
+    : data_{rhs.data_}
+  {
+    VariantInit(&rhs.data_);
+  }
+
+  /// The move assignment.
+  Variant& operator=(Variant&& rhs) noexcept
+  {
+    if (this != &rhs) {
+      Variant tmp{std::move(rhs)};
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  /// The swap operation.
+  void swap(Variant& other) noexcept
+  {
+    std::swap(data_, other.data_);
+  }
+
+  /// @returns The underlying data.
+  VARIANT& data() noexcept
+  {
+    return data_;
+  }
+
+  /// @overload
+  const VARIANT& data() const noexcept
+  {
+    return data_;
+  }
+
+private:
+  VARIANT data_;
+};
+
+/// The owning `VARIANT` which is not modified.
+using Const_variant = const Variant;
+
+} // namespace dmitigr::winbase::com
@@ -0,0 +1,531 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "comdef.hpp"
+#include "object.hpp"
+
+#include <Wbemidl.h>
+
+#include <cstddef>
+#include <cwchar>
+#include <cwctype>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom::fake::wmi {
+
+/// The properties of WMI object.
+using Properties = std::vector<std::pair<std::wstring, _variant_t>>;
+
+/// The instance of WMI class.
+struct Instance final {
+  std::wstring class_name;
+  Properties properties;
+};
+
+namespace detail {
+
+using fake::detail::iequals;
+using fake::detail::Iless;
+
+/// @returns The `CIMTYPE` of `vt`.
+inline CIMTYPE cim_type(const VARTYPE vt) noexcept
+{
+  CIMTYPE result{};
+  switch (vt & VT_TYPEMASK) {
+  case VT_I1: result = CIM_SINT8; break;
+  case VT_UI1: result = CIM_UINT8; break;
+  case VT_I2: result = CIM_SINT16; break;
+  case VT_UI2: result = CIM_UINT16; break;
+  case VT_I4: case VT_INT: result = CIM_SINT32; break;
+  case VT_UI4: case VT_UINT: result = CIM_UINT32; break;
+  case VT_I8: result = CIM_SINT64; break;
+  case VT_UI8: result = CIM_UINT64; break;
+  case VT_R4: result = CIM_REAL32; break;
+  case VT_R8: result = CIM_REAL64; break;
+  case VT_BOOL: result = CIM_BOOLEAN; break;
+  case VT_BSTR: result = CIM_STRING; break;
+  case VT_UNKNOWN: case VT_DISPATCH: result = CIM_OBJECT; break;
+  default: result = CIM_EMPTY;
+  }
+  return vt & VT_ARRAY ? result | CIM_FLAG_ARRAY : result;
+}
+
+/// The WQL query `SELECT {* | property, ...} FROM class [WHERE condition
+/// [AND condition ...]]` with conditions `property = literal`.
+struct Query final {
+  struct Condition final {
+    std::wstring property;
+    std::wstring literal;
+    bool is_string{};
+  };
+
+  std::vector<std::wstring> properties; // empty means all
+  std::wstring class_name;
+  std::vector<Condition> conditions;
+
+  /// @returns The parsed `query`, or `std::nullopt` if it's not supported.
+  static std::optional<Query> parse(const std::wstring_view query)
+  {
+    std::vector<std::pair<std::wstring, bool>> tokens; // {token, is_string}
+    for (std::size_t i{}; i < query.size();) {
+      const auto ch = query[i];
+      if (std::iswspace(ch))
+        ++i;
+      else if (ch == L'\'' || ch == L'"') {
+        const auto end = query.find(ch, i + 1);
+        if (end == std::wstring_view::npos)
+          return std::nullopt;
+        tokens.emplace_back(query.substr(i + 1, end - i - 1), true);
+        i = end + 1;
+      } else if (ch == L'*' || ch == L',' || ch == L'=') {
+        tokens.emplace_back(std::wstring(1, ch), false);
+        ++i;
+      } else {
+        auto end = i;
+        while (end < query.size() && (std::iswalnum(query[end])
+            || query[end] == L'_' || query[end] == L'.' || query[end] == L'-'))
+          ++end;
+        if (end == i)
+          return std::nullopt;
+        tokens.emplace_back(query.substr(i, end - i), false);
+        i = end;
+      }
+    }
+
+    std::size_t pos{};
+    const auto keyword = [&](const std::wstring_view word)
+    {
+      if (pos < tokens.size() && !tokens[pos].second
+        && iequals(tokens[pos].first, word)) {
+        ++pos;
+        return true;
+      }
+      return false;
+    };
+    const auto identifier = [&]() -> const std::wstring*
+    {
+      if (pos < tokens.size() && !tokens[pos].second
+        && std::iswalpha(tokens[pos].first.front()))
+        return &tokens[pos++].first;
+      return nullptr;
+    };
+
+    Query result;
+    if (!keyword(L"SELECT"))
+      return std::nullopt;
+    if (!keyword(L"*")) {
+      do {
+        const auto* const property = identifier();
+        if (!property)
+          return std::nullopt;
+        result.properties.push_back(*property);
+      } while (keyword(L","));
+    }
+    if (!keyword(L"FROM"))
+      return std::nullopt;
+    if (const auto* const name = identifier())
+      result.class_name = *name;
+    else
+      return std::nullopt;
+    if (keyword(L"WHERE")) {
+      do {
+        const auto* const property = identifier();
+        if (!property || !keyword(L"=") || pos == tokens.size())
+          return std::nullopt;
+        const auto& [literal, is_string] = tokens[pos++];
+        result.conditions.push_back(Condition{*property, literal, is_string});
+      } while (keyword(L"AND"));
+    }
+    return pos == tokens.size() ? std::optional{std::move(result)} :
+      std::nullopt;
+  }
+
+  /// @returns `true` if `instance` satisfies the conditions.
+  bool is_matched(const Instance& instance) const
+  {
+    for (const auto& condition : conditions) {
+      const auto* const value = find(instance.properties, condition.property);
+      if (!value)
+        return false;
+      _variant_t converted;
+      if (condition.is_string) {
+        if (VariantChangeType(&converted, value, 0, VT_BSTR) != S_OK
+          || !iequals(to_wstring(converted), condition.literal))
+          return false;
+      } else if (iequals(condition.literal, L"TRUE")
+        || iequals(condition.literal, L"FALSE")) {
+        if (VariantChangeType(&converted, value, 0, VT_BOOL) != S_OK
+          || (converted.boolVal != VARIANT_FALSE)
+          != iequals(condition.literal, L"TRUE"))
+          return false;
+      } else {
+        wchar_t* end{};
+        const auto number = std::wcstod(condition.literal.c_str(), &end);
+        if (*end || VariantChangeType(&converted, value, 0, VT_R8) != S_OK
+          || converted.dblVal != number)
+          return false;
+      }
+    }
+    return true;
+  }
+
+  /// @returns The property `name` of `properties`, or `nullptr`.
+  static const VARIANT* find(const Properties& properties,
+    const std::wstring_view name) noexcept
+  {
+    for (const auto& [property, value] : properties) {
+      if (iequals(property, name))
+        return &value;
+    }
+    return nullptr;
+  }
+};
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// Repository
+// -----------------------------------------------------------------------------
+
+/// The repository of the WMI objects of all the hosts.
+class Repository final {
+public:
+  using Instances = std::vector<std::shared_ptr<const Instance>>;
+
+  /// Adds the namespace `name_space` (like `ROOT\\CIMV2`).
+  void add_namespace(const std::wstring_view name_space)
+  {
+    const std::lock_guard lg{mutex_};
+    namespaces_[std::wstring{name_space}];
+  }
+
+  /// Adds the instance to `name_space`.
+  void add(const std::wstring_view name_space, Instance instance)
+  {
+    const std::lock_guard lg{mutex_};
+    namespaces_[std::wstring{name_space}].push_back(
+      std::make_shared<const Instance>(std::move(instance)));
+  }
+
+  /// Removes all the namespaces.
+  void clear()
+  {
+    const std::lock_guard lg{mutex_};
+    namespaces_.clear();
+  }
+
+  /// @returns `true` if there is `name_space`.
+  bool has_namespace(const std::wstring_view name_space) const
+  {
+    const std::lock_guard lg{mutex_};
+    return namespaces_.find(name_space) != namespaces_.end();
+  }
+
+  /// @returns The instances of `name_space` matching `predicate`.
+  template<class Predicate>
+  Instances instances(const std::wstring_view name_space,
+    const Predicate& predicate) const
+  {
+    Instances result;
+    const std::lock_guard lg{mutex_};
+    if (const auto i = namespaces_.find(name_space); i != namespaces_.end()) {
+      for (const auto& instance : i->second) {
+        if (predicate(*instance))
+          result.push_back(instance);
+      }
+    }
+    return result;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::map<std::wstring, Instances, detail::Iless> namespaces_;
+};
+
+/// @returns The repository of the fake WMI.
+inline Repository& repository()
+{
+  static Repository result;
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Objects
+// -----------------------------------------------------------------------------
+
+/// The fake of `IWbemClassObject`.
+class Class_object final : public Object<IWbemClassObject> {
+public:
+  explicit Class_object(std::shared_ptr<const Instance> instance) noexcept
+    : instance_{std::move(instance)}
+  {}
+
+  HRESULT Get(const LPCWSTR name, long, VARIANT* const value,
+    CIMTYPE* const type, long* const flavor) override
+  {
+    if (!name)
+      return WBEM_E_INVALID_PARAMETER;
+    if (const auto err = enter("IWbemClassObject::Get"); err != S_OK)
+      return err;
+
+    const _variant_t class_name{instance_->class_name.c_str()};
+    const auto* const property = detail::iequals(name, L"__CLASS") ?
+      &class_name : detail::Query::find(instance_->properties, name);
+    if (!property)
+      return WBEM_E_NOT_FOUND;
+    if (value) {
+      VariantInit(value);
+      if (const auto err = VariantCopy(value, property); err != S_OK)
+        return err;
+    }
+    if (type)
+      *type = detail::cim_type(property->vt);
+    if (flavor)
+      *flavor = 0;
+    return WBEM_S_NO_ERROR;
+  }
+
+  HRESULT Put(const LPCWSTR name, long, VARIANT* const value,
+    CIMTYPE) override
+  {
+    if (!name)
+      return WBEM_E_INVALID_PARAMETER;
+    auto instance = std::make_shared<Instance>(*instance_);
+    _variant_t copy;
+    if (value)
+      copy = _variant_t{*value};
+    bool is_found{};
+    for (auto& [property, v] : instance->properties) {
+      if (detail::iequals(property, name)) {
+        v = std::move(copy);
+        is_found = true;
+        break;
+      }
+    }
+    if (!is_found)
+      instance->properties.emplace_back(name, std::move(copy));
+    instance_ = std::move(instance);
+    return WBEM_S_NO_ERROR;
+  }
+
+  HRESULT BeginEnumeration(long) override
+  {
+    position_ = 0;
+    return WBEM_S_NO_ERROR;
+  }
+
+  HRESULT Next(long, BSTR* const name, VARIANT* const value,
+    CIMTYPE* const type, long* const flavor) override
+  {
+    if (position_ >= instance_->properties.size())
+      return WBEM_S_NO_MORE_DATA;
+    const auto& [property, v] = instance_->properties[position_++];
+    if (name && get(property, name) != S_OK)
+      return E_OUTOFMEMORY;
+    if (value) {
+      VariantInit(value);
+      if (const auto err = VariantCopy(value, &v); err != S_OK)
+        return err;
+    }
+    if (type)
+      *type = detail::cim_type(v.vt);
+    if (flavor)
+      *flavor = 0;
+    return WBEM_S_NO_ERROR;
+  }
+
+  HRESULT EndEnumeration() override
+  {
+    position_ = instance_->properties.size();
+    return WBEM_S_NO_ERROR;
+  }
+
+private:
+  std::shared_ptr<const Instance> instance_;
+  std::size_t position_{};
+};
+
+/// The fake of `IEnumWbemClassObject`.
+class Enum_class_object final :
+    public Object<IEnumWbemClassObject, IClientSecurity> {
+public:
+  explicit Enum_class_object(Repository::Instances instances) noexcept
+    : instances_{std::move(instances)}
+  {}
+
+  HRESULT Reset() override
+  {
+    position_ = 0;
+    return WBEM_S_NO_ERROR;
+  }
+
+  /// Calls `enter("IEnumWbemClassObject::Next")` before fetching.
+  HRESULT Next(long, const ULONG count, IWbemClassObject** const objects,
+    ULONG* const returned) override
+  {
+    if (!objects || !returned)
+      return WBEM_E_INVALID_PARAMETER;
+    *returned = 0;
+    if (const auto err = enter("IEnumWbemClassObject::Next"); err != S_OK)
+      return err;
+    for (; *returned < count && position_ < instances_.size(); ++*returned)
+      objects[*returned] = new Class_object{instances_[position_++]};
+    return *returned == count ? WBEM_S_NO_ERROR : WBEM_S_FALSE;
+  }
+
+  HRESULT Skip(long, const ULONG count) override
+  {
+    const auto rest = instances_.size() - position_;
+    position_ += std::min<std::size_t>(rest, count);
+    return count <= rest ? WBEM_S_NO_ERROR : WBEM_S_FALSE;
+  }
+
+private:
+  Repository::Instances instances_;
+  std::size_t position_{};
+};
+
+/// The fake of `IWbemServices` of a namespace.
+class Services final : public Object<IWbemServices, IClientSecurity> {
+public:
+  explicit Services(std::wstring name_space)
+    : name_space_{std::move(name_space)}
+  {}
+
+  /**
+   * @brief Gets the instance by the path like `Class.Key="value"`, or the
+   * first instance of the class by the path like `Class`.
+   */
+  HRESULT GetObject(const BSTR path, long, IWbemContext*,
+    IWbemClassObject** const object, IWbemCallResult**) override
+  {
+    if (!path || !object)
+      return WBEM_E_INVALID_PARAMETER;
+    *object = nullptr;
+    if (const auto err = enter("IWbemServices::GetObject"); err != S_OK)
+      return err;
+
+    std::wstring_view spec{path, SysStringLen(path)};
+    std::wstring query{L"SELECT * FROM "};
+    const auto dot = spec.find(L'.');
+    query.append(spec.substr(0, dot));
+    if (dot != std::wstring_view::npos)
+      query.append(L" WHERE ").append(spec.substr(dot + 1));
+    const auto parsed = detail::Query::parse(query);
+    if (!parsed)
+      return WBEM_E_INVALID_OBJECT_PATH;
+    const auto instances = select(*parsed);
+    if (instances.empty())
+      return WBEM_E_NOT_FOUND;
+    *object = new Class_object{instances.front()};
+    return WBEM_S_NO_ERROR;
+  }
+
+  HRESULT ExecQuery(const BSTR language, const BSTR query, long,
+    IWbemContext*, IEnumWbemClassObject** const result) override
+  {
+    if (!language || !query || !result)
+      return WBEM_E_INVALID_PARAMETER;
+    *result = nullptr;
+    if (const auto err = enter("IWbemServices::ExecQuery"); err != S_OK)
+      return err;
+    else if (!detail::iequals(language, L"WQL"))
+      return WBEM_E_INVALID_QUERY_TYPE;
+
+    const auto parsed = detail::Query::parse({query, SysStringLen(query)});
+    if (!parsed)
+      return WBEM_E_INVALID_QUERY;
+    auto instances = select(*parsed);
+    if (!parsed->properties.empty()) {
+      for (auto& instance : instances) {
+        auto projected = std::make_shared<Instance>();
+        projected->class_name = instance->class_name;
+        for (const auto& property : parsed->properties) {
+          if (const auto* const value = detail::Query::find(
+              instance->properties, property))
+            projected->properties.emplace_back(property, _variant_t{*value});
+        }
+        instance = std::move(projected);
+      }
+    }
+    *result = new Enum_class_object{std::move(instances)};
+    return WBEM_S_NO_ERROR;
+  }
+
+private:
+  std::wstring name_space_;
+
+  Repository::Instances select(const detail::Query& query) const
+  {
+    return repository().instances(name_space_,
+      [&query](const Instance& instance)
+      {
+        return detail::iequals(instance.class_name, query.class_name)
+          && query.is_matched(instance);
+      });
+  }
+};
+
+/// The fake of `IWbemLocator` (the class `WbemLocator`).
+class Locator final : public Object<IWbemLocator> {
+public:
+  /**
+   * @brief Connects to the namespace of `network_resource` like
+   * `ROOT\\CIMV2` or `\\\\host\\ROOT\\CIMV2` (the host is ignored).
+   */
+  HRESULT ConnectServer(const BSTR network_resource, BSTR, BSTR, BSTR, long,
+    BSTR, IWbemContext*, IWbemServices** const result) override
+  {
+    if (!network_resource || !result)
+      return WBEM_E_INVALID_PARAMETER;
+    *result = nullptr;
+    if (const auto err = enter("IWbemLocator::ConnectServer"); err != S_OK)
+      return err;
+
+    std::wstring_view name_space{network_resource,
+      SysStringLen(network_resource)};
+    if (name_space.starts_with(L"\\\\") || name_space.starts_with(L"//")) {
+      name_space.remove_prefix(2);
+      const auto pos = name_space.find_first_of(L"\\/");
+      name_space.remove_prefix(pos == std::wstring_view::npos ?
+        name_space.size() : pos + 1);
+    }
+    if (!repository().has_namespace(name_space))
+      return WBEM_E_INVALID_NAMESPACE;
+    *result = new Services{std::wstring{name_space}};
+    return WBEM_S_NO_ERROR;
+  }
+};
+
+/// Registers the class `WbemLocator`.
+inline void register_classes()
+{
+  register_class(__uuidof(WbemLocator), [](REFIID id, void** const result)
+  {
+    return make<Locator>()->QueryInterface(id, result);
+  });
+}
+
+} // namespace dmitigr::wincom::fake::wmi
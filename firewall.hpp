@@ -18,12 +18,99 @@
 // #pragma comment(lib, "FirewallAPI")
 // #pragma comment(lib, "Hnetcfg")
 
+#include "enumerator.hpp"
+#include "literal.hpp"
 #include "object.hpp"
+#include "tracing.hpp"
+
+#include <optional>
+#include <string_view>
 
 #include <netfw.h>
 
+namespace dmitigr::wincom {
+
+template<>
+inline constexpr auto literal_map<NET_FW_ACTION> =
+  make_literal_map<NET_FW_ACTION>({
+  {NET_FW_ACTION_BLOCK, "NET_FW_ACTION_BLOCK"},
+  {NET_FW_ACTION_ALLOW, "NET_FW_ACTION_ALLOW"}
+});
+
+template<>
+inline constexpr auto literal_map<NET_FW_IP_PROTOCOL> =
+  make_literal_map<NET_FW_IP_PROTOCOL>({
+  {NET_FW_IP_PROTOCOL_TCP, "NET_FW_IP_PROTOCOL_TCP"},
+  {NET_FW_IP_PROTOCOL_UDP, "NET_FW_IP_PROTOCOL_UDP"},
+  {NET_FW_IP_PROTOCOL_ANY, "NET_FW_IP_PROTOCOL_ANY"}
+});
+
+template<>
+inline constexpr auto literal_map<NET_FW_IP_VERSION> =
+  make_literal_map<NET_FW_IP_VERSION>({
+  {NET_FW_IP_VERSION_V4, "NET_FW_IP_VERSION_V4"},
+  {NET_FW_IP_VERSION_V6, "NET_FW_IP_VERSION_V6"},
+  {NET_FW_IP_VERSION_ANY, "NET_FW_IP_VERSION_ANY"}
+});
+
+template<>
+inline constexpr auto literal_map<NET_FW_MODIFY_STATE> =
+  make_literal_map<NET_FW_MODIFY_STATE>({
+  {NET_FW_MODIFY_STATE_OK, "NET_FW_MODIFY_STATE_OK"},
+  {NET_FW_MODIFY_STATE_GP_OVERRIDE, "NET_FW_MODIFY_STATE_GP_OVERRIDE"},
+  {NET_FW_MODIFY_STATE_INBOUND_BLOCKED, "NET_FW_MODIFY_STATE_INBOUND_BLOCKED"}
+});
+
+template<>
+inline constexpr auto literal_map<NET_FW_PROFILE_TYPE> =
+  make_literal_map<NET_FW_PROFILE_TYPE>({
+  {NET_FW_PROFILE_DOMAIN, "NET_FW_PROFILE_DOMAIN"},
+  {NET_FW_PROFILE_STANDARD, "NET_FW_PROFILE_STANDARD"},
+  {NET_FW_PROFILE_CURRENT, "NET_FW_PROFILE_CURRENT"}
+});
+
+template<>
+inline constexpr auto literal_map<NET_FW_PROFILE_TYPE2> =
+  make_literal_map<NET_FW_PROFILE_TYPE2>({
+  {NET_FW_PROFILE2_DOMAIN, "NET_FW_PROFILE2_DOMAIN"},
+  {NET_FW_PROFILE2_PRIVATE, "NET_FW_PROFILE2_PRIVATE"},
+  {NET_FW_PROFILE2_PUBLIC, "NET_FW_PROFILE2_PUBLIC"},
+  {NET_FW_PROFILE2_ALL, "NET_FW_PROFILE2_ALL"}
+});
+
+template<>
+inline constexpr auto literal_map<NET_FW_RULE_DIRECTION> =
+  make_literal_map<NET_FW_RULE_DIRECTION>({
+  {NET_FW_RULE_DIR_IN, "NET_FW_RULE_DIR_IN"},
+  {NET_FW_RULE_DIR_OUT, "NET_FW_RULE_DIR_OUT"}
+});
+
+template<>
+inline constexpr auto literal_map<NET_FW_SCOPE> =
+  make_literal_map<NET_FW_SCOPE>({
+  {NET_FW_SCOPE_ALL, "NET_FW_SCOPE_ALL"},
+  {NET_FW_SCOPE_LOCAL_SUBNET, "NET_FW_SCOPE_LOCAL_SUBNET"},
+  {NET_FW_SCOPE_CUSTOM, "NET_FW_SCOPE_CUSTOM"}
+});
+
+template<>
+inline constexpr auto literal_map<NET_FW_SERVICE_TYPE> =
+  make_literal_map<NET_FW_SERVICE_TYPE>({
+  {NET_FW_SERVICE_FILE_AND_PRINT, "NET_FW_SERVICE_FILE_AND_PRINT"},
+  {NET_FW_SERVICE_UPNP, "NET_FW_SERVICE_UPNP"},
+  {NET_FW_SERVICE_REMOTE_DESKTOP, "NET_FW_SERVICE_REMOTE_DESKTOP"},
+  {NET_FW_SERVICE_NONE, "NET_FW_SERVICE_NONE"}
+});
+
+} // namespace dmitigr::wincom
+
 namespace dmitigr::wincom::firewall {
 
+using wincom::from_literal;
+using wincom::to_literal;
+
+// -----------------------------------------------------------------------------
+
 class Authorized_application final : public
   Basic_com_object<NetFwAuthorizedApplication, INetFwAuthorizedApplication> {
   using Bco = Basic_com_object<NetFwAuthorizedApplication, INetFwAuthorizedApplication>;
@@ -33,53 +120,55 @@ public:
   bool is_enabled() const
   {
     VARIANT_BOOL result{VARIANT_FALSE};
-    detail::api(*this).get_Enabled(&result);
+    detail::call<&Api::get_Enabled>(*this, "get_Enabled", &result);
     return result == VARIANT_TRUE;
   }
 
   Authorized_application& set_enabled(const bool value)
   {
     const VARIANT_BOOL val{value ? VARIANT_TRUE : VARIANT_FALSE};
-    api().put_Enabled(val);
+    detail::call<&Api::put_Enabled>(*this, "put_Enabled", val);
     return *this;
   }
 
   NET_FW_IP_VERSION ip_version() const
   {
     NET_FW_IP_VERSION result{};
-    detail::api(*this).get_IpVersion(&result);
+    detail::call<&Api::get_IpVersion>(*this, "get_IpVersion", &result);
     return result;
   }
 
   Authorized_application& set_ip_version(const NET_FW_IP_VERSION value)
   {
-    api().put_IpVersion(value);
+    detail::call<&Api::put_IpVersion>(*this, "put_IpVersion", value);
     return *this;
   }
 
   template<class String>
   String name() const
   {
-    return detail::str<String>(*this, &Api::get_Name);
+    return detail::str<String, &Api::get_Name>(*this, "get_Name");
   }
 
   template<class String>
   Authorized_application& set_name(const String& value)
   {
-    api().put_Name(detail::bstr(value));
+    detail::call<&Api::put_Name>(*this, "put_Name", detail::bstr(value));
     return *this;
   }
 
   template<class String>
   String process_image_file_name() const
   {
-    return detail::str<String>(*this, &Api::get_ProcessImageFileName);
+    return detail::str<String, &Api::get_ProcessImageFileName>(*this,
+      "get_ProcessImageFileName");
   }
 
   template<class String>
   Authorized_application& set_process_image_file_name(const String& value)
   {
-    api().put_ProcessImageFileName(detail::bstr(value));
+    detail::call<&Api::put_ProcessImageFileName>(*this,
+      "put_ProcessImageFileName", detail::bstr(value));
     return *this;
   }
 };
@@ -94,18 +183,20 @@ public:
 
   Authorized_applications& add(const Authorized_application& app)
   {
-    const auto err = api().Add(&detail::api(app));
+    const auto err = detail::call<&Api::Add>(*this, "Add", &detail::api(app));
     if (err != S_OK)
       throw Win_error{"cannot add application to firewall collection", err};
     return *this;
   }
 
   template<class String>
-  Authorized_application& remove(const String& image_file_name)
+  Authorized_applications& remove(const String& image_file_name)
   {
-    const auto err = api().Remove(detail::bstr(image_file_name));
+    const auto err = detail::call<&Api::Remove>(*this, "Remove",
+      detail::bstr(image_file_name));
     if (err != S_OK)
-      throw Win_error{"cannot add application to firewall collection", err};
+      throw Win_error{"cannot remove application from firewall collection",
+        err};
     return *this;
   }
 };
@@ -120,7 +211,8 @@ public:
   Authorized_applications authorized_applications() const
   {
     INetFwAuthorizedApplications* apps{};
-    detail::api(*this).get_AuthorizedApplications(&apps);
+    detail::call<&Api::get_AuthorizedApplications>(*this,
+      "get_AuthorizedApplications", &apps);
     return Authorized_applications{apps};
   }
 };
@@ -135,14 +227,16 @@ public:
   Profile current_profile() const
   {
     INetFwProfile* profile{};
-    detail::api(*this).get_CurrentProfile(&profile);
+    detail::call<&Api::get_CurrentProfile>(*this, "get_CurrentProfile",
+      &profile);
     return Profile{profile};
   }
 
   Profile profile(const NET_FW_PROFILE_TYPE value) const
   {
     INetFwProfile* profile{};
-    detail::api(*this).GetProfileByType(value, &profile);
+    detail::call<&Api::GetProfileByType>(*this, "GetProfileByType", value,
+      &profile);
     return Profile{profile};
   }
 };
@@ -157,14 +251,15 @@ public:
   NET_FW_PROFILE_TYPE current_profile_type() const
   {
     NET_FW_PROFILE_TYPE result{};
-    detail::api(*this).get_CurrentProfileType(&result);
+    detail::call<&Api::get_CurrentProfileType>(*this, "get_CurrentProfileType",
+      &result);
     return result;
   }
 
   Policy local_policy() const
   {
     INetFwPolicy* policy{};
-    detail::api(*this).get_LocalPolicy(&policy);
+    detail::call<&Api::get_LocalPolicy>(*this, "get_LocalPolicy", &policy);
     return Policy{policy};
   }
 };
@@ -179,131 +274,140 @@ public:
   template<class String>
   String name() const
   {
-    return detail::str<String>(*this, &Api::get_Name);
+    return detail::str<String, &Api::get_Name>(*this, "get_Name");
   }
 
   template<class String>
   Rule& set_name(const String& value)
   {
-    api().put_Name(detail::bstr(value));
+    detail::call<&Api::put_Name>(*this, "put_Name", detail::bstr(value));
     return *this;
   }
 
   template<class String>
   String application_name() const
   {
-    return detail::str<String>(*this, &Api::get_ApplicationName);
+    return detail::str<String, &Api::get_ApplicationName>(*this,
+      "get_ApplicationName");
   }
 
   template<class String>
   Rule& set_application_name(const String& image_file_name)
   {
-    api().put_ApplicationName(detail::bstr(image_file_name));
+    detail::call<&Api::put_ApplicationName>(*this, "put_ApplicationName",
+      detail::bstr(image_file_name));
     return *this;
   }
 
   template<class String>
   String description() const
   {
-    return detail::str<String>(*this, &Api::get_Description);
+    return detail::str<String, &Api::get_Description>(*this, "get_Description");
   }
 
   template<class String>
   Rule& set_description(const String& value)
   {
-    api().put_Description(detail::bstr(value));
+    detail::call<&Api::put_Description>(*this, "put_Description",
+      detail::bstr(value));
     return *this;
   }
 
   template<class String>
   String grouping() const
   {
-    return detail::str<String>(*this, &Api::get_Grouping);
+    return detail::str<String, &Api::get_Grouping>(*this, "get_Grouping");
   }
 
   template<class String>
   Rule& set_grouping(const String& context)
   {
-    api().put_Grouping(detail::bstr(context));
+    detail::call<&Api::put_Grouping>(*this, "put_Grouping",
+      detail::bstr(context));
     return *this;
   }
 
   template<class String>
   String interface_types() const
   {
-    return detail::str<String>(*this, &Api::get_InterfaceTypes);
+    return detail::str<String, &Api::get_InterfaceTypes>(*this,
+      "get_InterfaceTypes");
   }
 
   template<class String>
   Rule& set_interface_types(const String& value)
   {
-    api().put_InterfaceTypes(detail::bstr(value));
+    detail::call<&Api::put_InterfaceTypes>(*this, "put_InterfaceTypes",
+      detail::bstr(value));
     return *this;
   }
 
   template<class String>
   String remote_addresses() const
   {
-    return detail::str<String>(*this, &Api::get_RemoteAddresses);
+    return detail::str<String, &Api::get_RemoteAddresses>(*this,
+      "get_RemoteAddresses");
   }
 
   template<class String>
   Rule& set_remote_addresses(const String& value)
   {
-    api().put_RemoteAddresses(detail::bstr(value));
+    detail::call<&Api::put_RemoteAddresses>(*this, "put_RemoteAddresses",
+      detail::bstr(value));
     return *this;
   }
 
   template<class String>
   String remote_ports() const
   {
-    return detail::str<String>(*this, &Api::get_RemotePorts);
+    return detail::str<String, &Api::get_RemotePorts>(*this, "get_RemotePorts");
   }
 
   template<class String>
   Rule& set_remote_ports(const String& value)
   {
-    api().put_RemotePorts(detail::bstr(value));
+    detail::call<&Api::put_RemotePorts>(*this, "put_RemotePorts",
+      detail::bstr(value));
     return *this;
   }
 
   long profiles() const
   {
     long result{};
-    detail::api(*this).get_Profiles(&result);
+    detail::call<&Api::get_Profiles>(*this, "get_Profiles", &result);
     return result;
   }
 
   Rule& set_profiles(const long value)
   {
-    api().put_Profiles(value);
+    detail::call<&Api::put_Profiles>(*this, "put_Profiles", value);
     return *this;
   }
 
   long protocol() const
   {
     long result{};
-    detail::api(*this).get_Protocol(&result);
+    detail::call<&Api::get_Protocol>(*this, "get_Protocol", &result);
     return result;
   }
 
   Rule& set_protocol(const long value)
   {
-    api().put_Protocol(value);
+    detail::call<&Api::put_Protocol>(*this, "put_Protocol", value);
     return *this;
   }
 
   bool is_enabled() const
   {
     VARIANT_BOOL result{VARIANT_FALSE};
-    detail::api(*this).get_Enabled(&result);
+    detail::call<&Api::get_Enabled>(*this, "get_Enabled", &result);
     return result == VARIANT_TRUE;
   }
 
   Rule& set_enabled(const bool value)
   {
     const VARIANT_BOOL val{value ? VARIANT_TRUE : VARIANT_FALSE};
-    api().put_Enabled(val);
+    detail::call<&Api::put_Enabled>(*this, "put_Enabled", val);
     return *this;
   }
 };
@@ -317,7 +421,12 @@ public:
 
   Rules& add(const Rule& rule)
   {
-    const auto err = api().Add(&detail::api(rule));
+    Trace_scope trace{"firewall::Rules", "add", [&rule]
+    {
+      return rule.name<std::wstring>();
+    }};
+    const auto err = detail::call<&Api::Add>(*this, "Add", &detail::api(rule));
+    trace.set_result(err);
     if (err != S_OK)
       throw Win_error{"cannot add firewall rule", err};
     return *this;
@@ -326,7 +435,8 @@ public:
   template<class String>
   Rules& remove(const String& name)
   {
-    const auto err = api().Remove(detail::bstr(name));
+    const auto err = detail::call<&Api::Remove>(*this, "Remove",
+      detail::bstr(name));
     if (err != S_OK)
       throw Win_error{"cannot remove firewall rule", err};
     return *this;
@@ -335,7 +445,7 @@ public:
   long count() const
   {
     long result{};
-    detail::api(*this).get_Count(&result);
+    detail::call<&Api::get_Count>(*this, "get_Count", &result);
     return result;
   }
 
@@ -343,11 +453,23 @@ public:
   Rule rule(const String& name)
   {
     INetFwRule* rul{};
-    const auto err = api().Item(detail::bstr(name), &rul);
+    const auto err = detail::call<&Api::Item>(*this, "Item", detail::bstr(name),
+      &rul);
     if (err != HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND) && err != S_OK)
       throw Win_error{"cannot retrieve firewall rule", err};
     return Rule{rul};
   }
+
+  /// @see Enumerator_range.
+  Enumerator enumerator() const
+  {
+    IUnknown* result{};
+    const auto err = detail::call<&Api::get__NewEnum>(*this, "get__NewEnum",
+      &result);
+    throw_if_error(err, "cannot get enumerator of firewall rules");
+    const Ptr<IUnknown> guard{result};
+    return Enumerator{result};
+  }
 };
 
 // -----------------------------------------------------------------------------
@@ -365,17 +487,18 @@ public:
     const bool is_enabled)
   {
     const VARIANT_BOOL enable{is_enabled ? VARIANT_TRUE : VARIANT_FALSE};
-    const auto err = api().EnableRuleGroup(profiles, detail::bstr(group), enable);
+    const auto err = detail::call<&Api::EnableRuleGroup>(*this,
+      "EnableRuleGroup", profiles, detail::bstr(group), enable);
     if (err != S_OK)
-      throw Win_error{L"cannot toggle specified group of firewall rules", err};
+      throw Win_error{"cannot toggle specified group of firewall rules", err};
   }
 
   template<typename String>
   bool is_rule_group_currently_enabled(const String& group) const
   {
     VARIANT_BOOL result{VARIANT_FALSE};
-    const auto err = detail::api(*this)
-      .get_IsRuleGroupCurrentlyEnabled(detail::bstr(group), &result);
+    const auto err = detail::call<&Api::get_IsRuleGroupCurrentlyEnabled>(*this,
+      "get_IsRuleGroupCurrentlyEnabled", detail::bstr(group), &result);
     if (err != S_OK)
       throw Win_error{"cannot get firewall rule group status of current profile", err};
     return result == VARIANT_TRUE;
@@ -385,8 +508,8 @@ public:
   bool is_rule_group_enabled(const long profile, const String& group) const
   {
     VARIANT_BOOL result{VARIANT_FALSE};
-    const auto err = detail::api(*this)
-      .IsRuleGroupEnabled(profile, detail::bstr(group), &result);
+    const auto err = detail::call<&Api::IsRuleGroupEnabled>(*this,
+      "IsRuleGroupEnabled", profile, detail::bstr(group), &result);
     if (err != S_OK)
       throw Win_error{"cannot get firewall rule group status", err};
     return result == VARIANT_TRUE;
@@ -395,28 +518,31 @@ public:
   long current_profile_types() const
   {
     long result{};
-    detail::api(*this).get_CurrentProfileTypes(&result);
+    detail::call<&Api::get_CurrentProfileTypes>(*this,
+      "get_CurrentProfileTypes", &result);
     return result;
   }
 
   bool is_firewall_enabled(const NET_FW_PROFILE_TYPE2 profile) const
   {
     VARIANT_BOOL result{VARIANT_FALSE};
-    detail::api(*this).get_FirewallEnabled(profile, &result);
+    detail::call<&Api::get_FirewallEnabled>(*this, "get_FirewallEnabled",
+      profile, &result);
     return result == VARIANT_TRUE;
   }
 
   NET_FW_MODIFY_STATE local_policy_modify_state() const
   {
     NET_FW_MODIFY_STATE result{};
-    detail::api(*this).get_LocalPolicyModifyState(&result);
+    detail::call<&Api::get_LocalPolicyModifyState>(*this,
+      "get_LocalPolicyModifyState", &result);
     return result;
   }
 
   Rules rules() const
   {
     INetFwRules* rules{};
-    detail::api(*this).get_Rules(&rules);
+    detail::call<&Api::get_Rules>(*this, "get_Rules", &rules);
     return Rules{rules};
   }
 };
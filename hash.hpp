@@ -0,0 +1,101 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace dmitigr::wincom {
+
+/**
+ * @brief 64-bit FNV-1a hash.
+ *
+ * @details Stable across processes and platforms, so the results can be
+ * persisted and compared between hosts.
+ */
+class Fnv1a final {
+public:
+  static constexpr std::uint64_t offset_basis{0xcbf29ce484222325};
+  static constexpr std::uint64_t prime{0x100000001b3};
+
+  constexpr Fnv1a& add(const void* const data, const std::size_t size) noexcept
+  {
+    const auto* const bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i{}; i < size; ++i)
+      value_ = (value_ ^ bytes[i]) * prime;
+    return *this;
+  }
+
+  /**
+   * @brief Adds `str` as a sequence of UTF-16 code units in little-endian.
+   *
+   * @details The characters of the types wider than 16 bits are encoded as
+   * UTF-16 (so `wchar_t` strings hash the same on Windows and elsewhere), and
+   * the characters of the narrow types are widened as is (so ASCII strings
+   * hash the same regardless of the character type).
+   */
+  template<typename CharT>
+  constexpr Fnv1a& add(const std::basic_string_view<CharT> str) noexcept
+  {
+    for (const auto ch : str) {
+      if constexpr (sizeof(CharT) == 1) {
+        add_code_unit(static_cast<unsigned char>(ch));
+      } else {
+        const auto code = static_cast<std::uint32_t>(ch);
+        if (code > 0xffff && code <= 0x10ffff) {
+          add_code_unit(0xd800 + ((code - 0x10000) >> 10));
+          add_code_unit(0xdc00 + ((code - 0x10000) & 0x3ff));
+        } else
+          add_code_unit(code & 0xffff);
+      }
+    }
+    return *this;
+  }
+
+  template<typename T>
+  constexpr Fnv1a& add_integer(const T value) noexcept
+  {
+    auto code = static_cast<std::uint64_t>(value);
+    for (std::size_t i{}; i < sizeof(T); ++i, code >>= 8)
+      value_ = (value_ ^ (code & 0xff)) * prime;
+    return *this;
+  }
+
+  constexpr std::uint64_t value() const noexcept
+  {
+    return value_;
+  }
+
+private:
+  std::uint64_t value_{offset_basis};
+
+  constexpr void add_code_unit(const std::uint32_t unit) noexcept
+  {
+    value_ = (value_ ^ (unit & 0xff)) * prime;
+    value_ = (value_ ^ (unit >> 8 & 0xff)) * prime;
+  }
+};
+
+/// @returns The FNV-1a hash of `str`.
+template<typename CharT>
+constexpr std::uint64_t fnv1a(const std::basic_string_view<CharT> str) noexcept
+{
+  return Fnv1a{}.add(str).value();
+}
+
+} // namespace dmitigr::wincom
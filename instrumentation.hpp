@@ -0,0 +1,499 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#ifdef DMITIGR_WINCOM_INSTRUMENTATION
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <vector>
+#if __has_include(<cxxabi.h>)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace dmitigr::wincom {
+
+#ifdef DMITIGR_WINCOM_INSTRUMENTATION
+
+// -----------------------------------------------------------------------------
+// Call_stats
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief The log-linear histogram of durations: the powers of two are split
+ * into 8 linear sub-buckets, so the relative error is at most 12.5%.
+ */
+class Call_histogram final {
+public:
+  /// The number of buckets (the durations up to 2^40 ticks are exact).
+  static constexpr std::size_t bucket_count{8 + 38*8};
+
+  /// @returns The index of the bucket of `value`.
+  static constexpr std::size_t bucket(const std::uint64_t value) noexcept
+  {
+    if (value < 8)
+      return static_cast<std::size_t>(value);
+    const auto e = static_cast<std::size_t>(std::bit_width(value) - 1);
+    if (e > 40)
+      return bucket_count - 1;
+    return 8 + (e - 3)*8 + static_cast<std::size_t>((value >> (e - 3)) & 7);
+  }
+
+  /// @returns The lower bound of the values of bucket `index`.
+  static constexpr std::uint64_t lower_bound(const std::size_t index) noexcept
+  {
+    if (index < 8)
+      return index;
+    const auto e = (index - 8)/8 + 3;
+    return (std::uint64_t{8} + (index - 8) % 8) << (e - 3);
+  }
+};
+
+/**
+ * @brief The aggregated statistics of calls of a COM method.
+ *
+ * @details Every call is counted, but only the durations of the sampled calls
+ * (see `call_sample_period`) are measured.
+ */
+struct Call_stats final {
+  std::string interface_name;
+  std::string method_name;
+  std::uint64_t count{};
+  /// The number of calls which returned failure `HRESULT`.
+  std::uint64_t failure_count{};
+  /// The last failure `HRESULT`.
+  std::int32_t last_failure{};
+  /// The number of calls whose durations are measured.
+  std::uint64_t sampled_count{};
+  /// The total duration of all the calls estimated by the sampled ones.
+  std::chrono::nanoseconds total_duration{};
+  /// The maximum duration of the sampled calls.
+  std::chrono::nanoseconds max_duration{};
+  /// The counts of durations of the sampled calls (see `Call_histogram`).
+  std::array<std::uint64_t, Call_histogram::bucket_count> histogram{};
+  /// The duration of one tick of histogram in nanoseconds.
+  double tick_duration{1};
+
+  /// @returns The approximate `q`-quantile of durations, `q` in [0, 1].
+  std::chrono::nanoseconds quantile(const double q) const noexcept
+  {
+    const auto rank = static_cast<std::uint64_t>(
+      std::clamp(q, 0., 1.) * static_cast<double>(sampled_count));
+    std::uint64_t seen{};
+    for (std::size_t i{}; i < histogram.size(); ++i) {
+      seen += histogram[i];
+      if (seen > rank || (seen == sampled_count && histogram[i]))
+        return std::chrono::nanoseconds{static_cast<std::int64_t>(
+            static_cast<double>(Call_histogram::lower_bound(i)) * tick_duration)};
+    }
+    return max_duration;
+  }
+};
+
+/**
+ * @brief The period of timing of calls: every `call_sample_period`-th call
+ * of a method on a thread is timed, starting from the first one.
+ *
+ * @details Two reads of the clock cost most of the instrumentation overhead
+ * (e.g. 20-30 ns each where the TSC reads are trapped by the hypervisor), so
+ * the rest of the calls are just counted.
+ */
+inline constexpr std::uint64_t call_sample_period{16};
+
+namespace detail {
+
+/// The clock of the instrumentation. (The TSC on x86.)
+struct Call_clock final {
+  static std::uint64_t now() noexcept
+  {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+  }
+};
+
+/// The counters of calls of a method made by a thread (single writer).
+struct Call_counters final {
+  std::atomic_uint64_t count{};
+  std::atomic_uint64_t failure_count{};
+  std::atomic<std::int32_t> last_failure{};
+  std::atomic_uint64_t sampled_count{};
+  std::atomic_uint64_t total_ticks{};
+  std::atomic_uint64_t max_ticks{};
+  std::array<std::atomic_uint64_t, Call_histogram::bucket_count> histogram{};
+
+  template<class T>
+  static void increase(std::atomic<T>& counter, const T value) noexcept
+  {
+    // The only writer doesn't need a read-modify-write operation.
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+      std::memory_order_relaxed);
+  }
+
+  /// @returns `true` if the next call must be timed.
+  bool is_sampled() const noexcept
+  {
+    return !(count.load(std::memory_order_relaxed) % call_sample_period);
+  }
+
+  /// Records the call which is not timed.
+  void record(const std::int32_t hresult) noexcept
+  {
+    increase(count, std::uint64_t{1});
+    if (hresult < 0) {
+      increase(failure_count, std::uint64_t{1});
+      last_failure.store(hresult, std::memory_order_relaxed);
+    }
+  }
+
+  /// Records the timed call.
+  void record(const std::int32_t hresult, const std::uint64_t ticks) noexcept
+  {
+    record(hresult);
+    increase(sampled_count, std::uint64_t{1});
+    increase(total_ticks, ticks);
+    if (ticks > max_ticks.load(std::memory_order_relaxed))
+      max_ticks.store(ticks, std::memory_order_relaxed);
+    increase(histogram[Call_histogram::bucket(ticks)], std::uint64_t{1});
+  }
+};
+
+/// The registry of call sites and per-thread counters.
+class Call_registry final {
+public:
+  /// The maximum number of the distinct methods.
+  static constexpr std::size_t max_site_count{1024};
+
+  /// The counters of a thread.
+  struct Block final {
+    std::array<std::atomic<Call_counters*>, max_site_count> sites{};
+    std::vector<std::unique_ptr<Call_counters>> storage; // guarded by mutex_
+
+    Call_counters& counters(const std::uint32_t site)
+    {
+      if (auto* const result = sites[site].load(std::memory_order_relaxed))
+        return *result;
+      return Call_registry::instance().allocate(*this, site);
+    }
+  };
+
+  /// @returns The instance (which is never destroyed).
+  static Call_registry& instance()
+  {
+    static auto* const result = new Call_registry;
+    return *result;
+  }
+
+  /// @returns The identifier of the new call site.
+  std::uint32_t add_site(std::string interface_name, std::string method_name)
+  {
+    const std::lock_guard lg{mutex_};
+    if (sites_.size() == max_site_count)
+      throw std::length_error{"too many instrumented COM methods"};
+    sites_.push_back(Site{std::move(interface_name), std::move(method_name)});
+    return static_cast<std::uint32_t>(sites_.size() - 1);
+  }
+
+  /// @returns The block of the current thread.
+  static Block& block()
+  {
+    if (!current_block_)
+      acquire_block();
+    return *current_block_;
+  }
+
+  /// @returns The statistics aggregated over all the threads.
+  std::vector<Call_stats> snapshot() const
+  {
+    const auto [now_ticks, now_time] = clock_pair();
+    const auto elapsed_time = now_time - start_time_;
+    const auto tick_duration = now_ticks > start_ticks_ && elapsed_time.count() ?
+      static_cast<double>(elapsed_time.count()) /
+      static_cast<double>(now_ticks - start_ticks_) : 1.;
+    const auto to_ns = [tick_duration](const std::uint64_t ticks)
+    {
+      return std::chrono::nanoseconds{static_cast<std::int64_t>(
+          static_cast<double>(ticks) * tick_duration)};
+    };
+
+    const std::lock_guard lg{mutex_};
+    std::vector<Call_stats> result(sites_.size());
+    for (std::size_t i{}; i < sites_.size(); ++i) {
+      auto& stats = result[i];
+      stats.interface_name = sites_[i].interface_name;
+      stats.method_name = sites_[i].method_name;
+      stats.tick_duration = tick_duration;
+      std::uint64_t total_ticks{};
+      std::uint64_t max_ticks{};
+      for (const auto& block : blocks_) {
+        const auto* const c = block->sites[i].load(std::memory_order_acquire);
+        if (!c)
+          continue;
+        stats.count += c->count.load(std::memory_order_relaxed);
+        stats.failure_count += c->failure_count.load(std::memory_order_relaxed);
+        if (const auto f = c->last_failure.load(std::memory_order_relaxed))
+          stats.last_failure = f;
+        stats.sampled_count += c->sampled_count.load(std::memory_order_relaxed);
+        total_ticks += c->total_ticks.load(std::memory_order_relaxed);
+        max_ticks = std::max(max_ticks, c->max_ticks.load(std::memory_order_relaxed));
+        for (std::size_t j{}; j < stats.histogram.size(); ++j)
+          stats.histogram[j] += c->histogram[j].load(std::memory_order_relaxed);
+      }
+      if (stats.sampled_count)
+        stats.total_duration = to_ns(static_cast<std::uint64_t>(
+            static_cast<double>(total_ticks) *
+            static_cast<double>(stats.count) /
+            static_cast<double>(stats.sampled_count)));
+      stats.max_duration = to_ns(max_ticks);
+    }
+    std::erase_if(result, [](const auto& s){return !s.count;});
+    return result;
+  }
+
+private:
+  struct Site final {
+    std::string interface_name;
+    std::string method_name;
+  };
+
+  /// Returns the block to the registry at the thread exit.
+  struct Block_holder final {
+    ~Block_holder()
+    {
+      if (current_block_) {
+        auto& registry = instance();
+        const std::lock_guard lg{registry.mutex_};
+        registry.free_blocks_.push_back(current_block_);
+        current_block_ = nullptr;
+      }
+    }
+  };
+
+  mutable std::mutex mutex_;
+  std::vector<Site> sites_;
+  std::vector<std::unique_ptr<Block>> blocks_;
+  std::vector<Block*> free_blocks_;
+  std::uint64_t start_ticks_{};
+  std::chrono::steady_clock::time_point start_time_;
+  constinit static inline thread_local Block* current_block_{};
+
+  Call_registry()
+  {
+    std::tie(start_ticks_, start_time_) = clock_pair();
+  }
+
+  static std::pair<std::uint64_t, std::chrono::steady_clock::time_point>
+  clock_pair() noexcept
+  {
+    return {Call_clock::now(), std::chrono::steady_clock::now()};
+  }
+
+  static void acquire_block()
+  {
+    thread_local Block_holder holder;
+    auto& registry = instance();
+    const std::lock_guard lg{registry.mutex_};
+    if (!registry.free_blocks_.empty()) {
+      current_block_ = registry.free_blocks_.back();
+      registry.free_blocks_.pop_back();
+    } else {
+      registry.blocks_.push_back(std::make_unique<Block>());
+      current_block_ = registry.blocks_.back().get();
+    }
+  }
+
+  Call_counters& allocate(Block& block, const std::uint32_t site)
+  {
+    const std::lock_guard lg{mutex_};
+    block.storage.push_back(std::make_unique<Call_counters>());
+    auto* const result = block.storage.back().get();
+    block.sites[site].store(result, std::memory_order_release);
+    return *result;
+  }
+};
+
+/// @returns The name of type `T` without the class-key.
+template<class T>
+std::string type_name()
+{
+#if __has_include(<cxxabi.h>)
+  int status{};
+  const std::unique_ptr<char, void(*)(void*)> demangled{
+    abi::__cxa_demangle(typeid(T).name(), nullptr, nullptr, &status),
+    std::free};
+  if (demangled)
+    return demangled.get();
+#endif
+  std::string_view result{typeid(T).name()};
+  for (const std::string_view key : {"struct ", "class "}) {
+    if (result.starts_with(key))
+      result.remove_prefix(key.size());
+  }
+  return std::string{result};
+}
+
+} // namespace detail
+
+/// @returns The statistics of the instrumented calls made so far.
+inline std::vector<Call_stats> call_stats()
+{
+  return detail::Call_registry::instance().snapshot();
+}
+
+/**
+ * @returns The JSON array of the statistics of `stats`, with the durations
+ * (including 50th, 90th and 99th percentiles) in nanoseconds.
+ */
+inline std::string to_json(const std::vector<Call_stats>& stats)
+{
+  std::string result{"["};
+  for (const auto& s : stats) {
+    if (result.size() > 1)
+      result += ',';
+    result.append("{\"interface\":\"").append(s.interface_name)
+      .append("\",\"method\":\"").append(s.method_name)
+      .append("\",\"count\":").append(std::to_string(s.count))
+      .append(",\"failures\":").append(std::to_string(s.failure_count))
+      .append(",\"last_failure\":").append(std::to_string(s.last_failure))
+      .append(",\"sampled\":").append(std::to_string(s.sampled_count))
+      .append(",\"total_ns\":").append(std::to_string(s.total_duration.count()))
+      .append(",\"max_ns\":").append(std::to_string(s.max_duration.count()))
+      .append(",\"p50_ns\":").append(std::to_string(s.quantile(.5).count()))
+      .append(",\"p90_ns\":").append(std::to_string(s.quantile(.9).count()))
+      .append(",\"p99_ns\":").append(std::to_string(s.quantile(.99).count()))
+      .append("}");
+  }
+  result += ']';
+  return result;
+}
+
+#endif // DMITIGR_WINCOM_INSTRUMENTATION
+
+// -----------------------------------------------------------------------------
+// call
+// -----------------------------------------------------------------------------
+
+namespace detail {
+
+template<auto Method, class = decltype(Method)>
+struct Call;
+
+/// The recorder of calls of the method `Method` of interface `C`.
+template<auto Method, class C, class R>
+struct Call_recorder final {
+  template<class F>
+  static R invoke([[maybe_unused]] const char* const name, F&& f)
+  {
+#ifdef DMITIGR_WINCOM_INSTRUMENTATION
+    static const std::uint32_t site{Call_registry::instance().add_site(
+        type_name<C>(), name)};
+    const auto to_hresult = [](const R& result) noexcept
+    {
+      if constexpr (std::is_same_v<R, long>)
+        return static_cast<std::int32_t>(result);
+      else
+        return std::int32_t{};
+    };
+    auto& counters = Call_registry::block().counters(site);
+    if (!counters.is_sampled()) {
+      R result = f();
+      counters.record(to_hresult(result));
+      return result;
+    }
+    const auto start = Call_clock::now();
+    R result = f();
+    const auto ticks = Call_clock::now() - start;
+    counters.record(to_hresult(result), ticks);
+    return result;
+#else
+    return f();
+#endif
+  }
+};
+
+/**
+ * @brief The caller of the COM method `Method` of the wrapped interface.
+ *
+ * @details If `DMITIGR_WINCOM_INSTRUMENTATION` is defined, records the
+ * `HRESULT` of each call and the duration of the sampled ones (see
+ * `call_stats()`). Otherwise, it's just the call.
+ */
+template<auto Method, class C, class R, class ... P>
+struct Call<Method, R(C::*)(P...)> final {
+  template<class Com>
+  R operator()(const Com& com, const char* const name, P ... args) const
+  {
+    auto& api = const_cast<Com&>(com).api();
+    return Call_recorder<Method, C, R>::invoke(name, [&]
+    {
+      return (api.*Method)(std::forward<P>(args)...);
+    });
+  }
+};
+
+#if defined(_M_IX86)
+template<auto Method, class C, class R, class ... P>
+struct Call<Method, R(__stdcall C::*)(P...)> final {
+  template<class Com>
+  R operator()(const Com& com, const char* const name, P ... args) const
+  {
+    auto& api = const_cast<Com&>(com).api();
+    return Call_recorder<Method, C, R>::invoke(name, [&]
+    {
+      return (api.*Method)(std::forward<P>(args)...);
+    });
+  }
+};
+#endif
+
+/**
+ * @brief Calls the COM method `Method` of the interface wrapped by `com`.
+ *
+ * @par Example
+ * @code
+ * const auto err = detail::call<&Api::GetTask>(*this, "GetTask", path, &task);
+ * @endcode
+ */
+template<auto Method>
+inline constexpr Call<Method> call{};
+
+} // namespace detail
+
+} // namespace dmitigr::wincom
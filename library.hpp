@@ -19,16 +19,66 @@
 
 #include "../base/noncopymove.hpp"
 #include "../winbase/windows.hpp"
+#include "apartment_pool.hpp"
+#include "circuit_breaker.hpp"
 #include "exceptions.hpp"
+#include "retry.hpp"
+#include "sta_executor.hpp"
+#include "timer_wheel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include <Objbase.h>
 
 namespace dmitigr::wincom {
 
+namespace detail {
+
+/**
+ * @brief The apartment of the current thread as recorded by `Library` or
+ * `ensure_library()`.
+ */
+enum class Thread_apartment : unsigned char {
+  none,
+  multithreaded,
+  apartment_threaded
+};
+
+constinit inline thread_local Thread_apartment thread_apartment;
+
+/// `true` if the COM library of the thread is initialized by
+/// `ensure_library()`.
+constinit inline thread_local bool is_thread_library_owner;
+
+} // namespace detail
+
+/**
+ * @brief The scope of the COM library of the current thread.
+ *
+ * @details The outermost instance on the thread records the apartment model
+ * unless it's already recorded by `ensure_library()`, so `current_apartment()`
+ * costs a load of thread-local variable while it's alive.
+ *
+ * @remarks The instance must be destroyed on the thread it's created on.
+ */
 class Library final : private Noncopymove {
 public:
   ~Library()
   {
+    if (is_recorder_)
+      detail::thread_apartment = detail::Thread_apartment::none;
     CoUninitialize();
   }
 
@@ -41,9 +91,196 @@ public:
     const auto err = CoInitializeEx(nullptr, concurrency_model);
     if (err != S_OK && err != S_FALSE)
       throw Win_error{"cannot initialize COM library", err};
+
+    if (detail::thread_apartment == detail::Thread_apartment::none) {
+      detail::thread_apartment = concurrency_model & COINIT_APARTMENTTHREADED ?
+        detail::Thread_apartment::apartment_threaded :
+        detail::Thread_apartment::multithreaded;
+      is_recorder_ = true;
+    }
+  }
+
+  /// @overload
+  explicit Library(const Apartment_model model)
+    : Library{model == Apartment_model::apartment_threaded ?
+      COINIT_APARTMENTTHREADED : COINIT_MULTITHREADED}
+  {}
+
+private:
+  bool is_recorder_{};
+};
+
+/**
+ * @returns The apartment model of the current thread as recorded by the
+ * enclosing `Library` or by `ensure_library()`, or `std::nullopt` if there
+ * is neither.
+ */
+inline std::optional<Apartment_model> current_apartment() noexcept
+{
+  switch (detail::thread_apartment) {
+  case detail::Thread_apartment::multithreaded:
+    return Apartment_model::multithreaded;
+  case detail::Thread_apartment::apartment_threaded:
+    return Apartment_model::apartment_threaded;
+  case detail::Thread_apartment::none:
+    break;
+  }
+  return std::nullopt;
+}
+
+/**
+ * @brief Initializes the COM library for the current thread, unless it's
+ * already initialized by `Library` or by this function.
+ *
+ * @details The first call on the thread calls `CoInitializeEx()`. If the
+ * thread is already in the other apartment (initialized by someone else)
+ * that one is just recorded. The subsequent calls cost a load of thread-local
+ * variable.
+ *
+ * @param preferred The apartment model to initialize the thread with.
+ *
+ * @returns The apartment model of the current thread.
+ *
+ * @remarks The library is not uninitialized at the thread exit, since the
+ * destructors of thread-locals run under the loader lock. Call
+ * `release_library()` on the thread to uninitialize it earlier.
+ */
+inline Apartment_model ensure_library(const Apartment_model preferred =
+  Apartment_model::multithreaded)
+{
+  if (const auto current = current_apartment())
+    return *current;
+
+  const bool is_sta{preferred == Apartment_model::apartment_threaded};
+  const auto err = CoInitializeEx(nullptr,
+    is_sta ? COINIT_APARTMENTTHREADED : COINIT_MULTITHREADED);
+  if (err == S_OK || err == S_FALSE)
+    detail::is_thread_library_owner = true;
+  else if (err != RPC_E_CHANGED_MODE)
+    throw Win_error{"cannot initialize COM library", err};
+
+  // RPC_E_CHANGED_MODE means the thread is already in the other apartment.
+  const bool is_sta_actual{detail::is_thread_library_owner ? is_sta : !is_sta};
+  detail::thread_apartment = is_sta_actual ?
+    detail::Thread_apartment::apartment_threaded :
+    detail::Thread_apartment::multithreaded;
+  return is_sta_actual ? Apartment_model::apartment_threaded :
+    Apartment_model::multithreaded;
+}
+
+/**
+ * @brief Uninitializes the COM library of the current thread initialized by
+ * `ensure_library()`, if any.
+ *
+ * @remarks The COM objects created on the thread since the initialization
+ * must be released before the call.
+ */
+inline void release_library() noexcept
+{
+  if (detail::is_thread_library_owner) {
+    detail::is_thread_library_owner = false;
+    detail::thread_apartment = detail::Thread_apartment::none;
+    CoUninitialize();
+  }
+}
+
+/**
+ * @brief Ensures the COM library is initialized for the current thread
+ * with `model`.
+ *
+ * @throws `Win_error` with `RPC_E_CHANGED_MODE` if the thread is in the
+ * other apartment.
+ *
+ * @see ensure_library().
+ */
+inline void require_apartment(const Apartment_model model)
+{
+  if (ensure_library(model) != model)
+    throw Win_error{"cannot use COM apartment of current thread",
+      RPC_E_CHANGED_MODE};
+}
+
+/// The COM apartment of the workers of `Apartment_pool`.
+class Pool_apartment final : private Noncopymove {
+public:
+  explicit Pool_apartment(const Apartment_model model)
+    : library_{model}
+  {}
+
+private:
+  Library library_;
+};
+
+/**
+ * @brief A pool of threads with initialized COM apartments.
+ *
+ * @remarks The STA workers don't pump messages while idle, so they are not
+ * suitable for the objects which fire events.
+ */
+using Apartment_pool = Basic_apartment_pool<Pool_apartment>;
+
+/// The message pump of `Sta_executor`.
+class Sta_message_pump final : private Noncopymove {
+public:
+  ~Sta_message_pump()
+  {
+    CloseHandle(event_);
+  }
+
+  Sta_message_pump()
+    : event_{CreateEventW(nullptr, false, false, nullptr)}
+  {
+    if (!event_)
+      throw Win_error{"cannot create event of STA message pump",
+        HRESULT_FROM_WIN32(GetLastError())};
+  }
+
+  /// Waits for wake up or messages and dispatches the messages.
+  void wait()
+  {
+    const auto result = MsgWaitForMultipleObjectsEx(1, &event_, INFINITE,
+      QS_ALLINPUT, MWMO_ALERTABLE | MWMO_INPUTAVAILABLE);
+    if (result == WAIT_FAILED)
+      throw Win_error{"cannot wait for messages of STA",
+        HRESULT_FROM_WIN32(GetLastError())};
+
+    poll();
+  }
+
+  /// Dispatches the pending messages without waiting.
+  void poll()
+  {
+    MSG msg;
+    while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+      TranslateMessage(&msg);
+      DispatchMessageW(&msg);
+    }
+  }
+
+  /// Wakes up the waiting thread.
+  void wake() noexcept
+  {
+    SetEvent(event_);
   }
+
+private:
+  Library library_{COINIT_APARTMENTTHREADED};
+  HANDLE event_{};
 };
 
+/**
+ * @brief An executor which runs the tasks and the coroutines on the thread
+ * of single-threaded apartment pumping the messages.
+ *
+ * @par Example
+ * @code
+ * co_await sta.schedule(); // now on the STA
+ * // ...
+ * co_await other.schedule(); // back to the other executor
+ * @endcode
+ */
+using Sta_executor = Basic_sta_executor<Sta_message_pump>;
+
 /**
  * @param auth A value of `-1` tells COM to choose authentication services
  * to register.
@@ -57,6 +294,7 @@ inline void initialize_security(const PSECURITY_DESCRIPTOR sec_desc = {},
   SOLE_AUTHENTICATION_LIST* const auth_list = {},
   const DWORD capabilities = EOAC_NONE)
 {
+  ensure_library();
   const auto err = CoInitializeSecurity(sec_desc, auth, auth_services,
     nullptr/*reserved*/, auth_level, imperson_level, auth_list, capabilities,
     nullptr/*reserved*/);
@@ -92,4 +330,613 @@ inline void set_proxy_blanket(IUnknown* const proxy,
     " to make calls on the specified proxy");
 }
 
+/// The authentication settings of proxies (see `set_proxy_blanket()`).
+struct Proxy_blanket final {
+  DWORD authn{RPC_C_AUTHN_DEFAULT};
+  DWORD authz{RPC_C_AUTHZ_DEFAULT};
+  /// The server principal name, or empty string to pass `nullptr`.
+  std::wstring server_princ_name;
+  DWORD authn_level{RPC_C_AUTHN_LEVEL_DEFAULT};
+  DWORD imperson_level{RPC_C_IMP_LEVEL_DEFAULT};
+  /// The client identity. Must outlive the proxies the blanket applied to.
+  RPC_AUTH_IDENTITY_HANDLE auth_info{};
+  DWORD capabilities{EOAC_DEFAULT};
+
+  /**
+   * @brief Sets this blanket on `proxy`, and on its `IUnknown` if the client
+   * identity is specified.
+   *
+   * @remarks Does nothing if `proxy` is not a proxy.
+   */
+  void apply(IUnknown* const proxy) const
+  {
+    if (!proxy)
+      throw std::invalid_argument{"cannot set proxy blanket: null proxy"};
+
+    const auto set = [this](IUnknown* const p)
+    {
+      const auto err = CoSetProxyBlanket(p, authn, authz,
+        server_princ_name.empty() ? nullptr :
+        const_cast<OLECHAR*>(server_princ_name.c_str()),
+        authn_level, imperson_level, auth_info, capabilities);
+      if (err != E_NOINTERFACE) // not a proxy
+        throw_if_error(err, "cannot set proxy blanket");
+    };
+
+    set(proxy);
+    if (auth_info) {
+      IUnknown* unknown{};
+      proxy->QueryInterface(&unknown);
+      if (unknown) {
+        try {
+          set(unknown);
+        } catch (...) {
+          unknown->Release();
+          throw;
+        }
+        unknown->Release();
+      }
+    }
+  }
+};
+
+/// The statistics of `apply_proxy_blanket()`.
+struct Proxy_blanket_stats final {
+  /// The number of proxies the blanket was set on.
+  std::uint64_t applied{};
+  /// The number of proxies the blanket was not set on since already applied.
+  std::uint64_t skipped{};
+  /// The number of proxies in the cache of applied blankets.
+  std::size_t cached{};
+};
+
+namespace detail {
+
+inline std::mutex proxy_blanket_mutex;
+inline std::shared_ptr<const Proxy_blanket> proxy_blanket;
+/// Incremented by every change of `proxy_blanket`.
+inline std::atomic_uint64_t proxy_blanket_version;
+inline std::atomic_uint64_t proxy_blanket_applied;
+inline std::atomic_uint64_t proxy_blanket_skipped;
+
+/**
+ * @brief The versions of the blankets applied to the proxies, keyed on the
+ * identities of the proxies.
+ *
+ * @details No references to the proxies are held. The entries are evicted
+ * by the wrappers when they release the proxies (see `forget_proxy_blanket()`)
+ * so the addresses of the released proxies can't be taken for the new ones.
+ */
+inline std::mutex proxy_blanket_cache_mutex;
+inline std::unordered_map<IUnknown*, std::uint64_t> proxy_blanket_cache;
+
+/// The blanket configured for the current thread.
+struct Proxy_blanket_snapshot final {
+  std::uint64_t version{};
+  std::shared_ptr<const Proxy_blanket> blanket;
+};
+
+/// @returns The configured blanket without locking unless it's changed.
+inline const Proxy_blanket_snapshot& configured_proxy_blanket()
+{
+  thread_local Proxy_blanket_snapshot snapshot;
+  if (const auto version = proxy_blanket_version.load();
+    version != snapshot.version) {
+    const std::lock_guard lg{proxy_blanket_mutex};
+    snapshot.blanket = proxy_blanket;
+    snapshot.version = proxy_blanket_version.load();
+  }
+  return snapshot;
+}
+
+/// @returns The canonical `IUnknown` of `proxy` without holding a reference.
+inline IUnknown* proxy_identity(IUnknown* const proxy) noexcept
+{
+  IUnknown* result{};
+  proxy->QueryInterface(&result);
+  if (!result)
+    return proxy;
+  result->Release();
+  return result;
+}
+
+/**
+ * @brief Evicts `proxy` from the cache of applied blankets.
+ *
+ * @details Called by the wrappers which apply the blanket before they
+ * release the proxy.
+ */
+inline void forget_proxy_blanket(IUnknown* const proxy) noexcept
+{
+  {
+    const std::lock_guard lg{proxy_blanket_cache_mutex};
+    if (proxy_blanket_cache.empty())
+      return;
+  }
+  const auto identity = proxy_identity(proxy);
+  const std::lock_guard lg{proxy_blanket_cache_mutex};
+  proxy_blanket_cache.erase(identity);
+}
+
+} // namespace detail
+
+/**
+ * @brief Sets the blanket applied by `apply_proxy_blanket()`.
+ *
+ * @param blanket The blanket, or `std::nullopt` to disable the application.
+ *
+ * @remarks The proxies the previous blanket was applied to are not touched
+ * until `apply_proxy_blanket()` is called for them again.
+ */
+inline void configure_proxy_blanket(std::optional<Proxy_blanket> blanket)
+{
+  auto value = blanket ?
+    std::make_shared<const Proxy_blanket>(std::move(*blanket)) : nullptr;
+  const std::lock_guard lg{detail::proxy_blanket_mutex};
+  detail::proxy_blanket.swap(value);
+  ++detail::proxy_blanket_version;
+}
+
+/**
+ * @brief Sets the configured blanket on `proxy` unless it's already set.
+ *
+ * @details The wrappers call this function for every proxy they obtain (e.g.
+ * `wmi::Locator::connect_server()` for the services and
+ * `wmi::Services::exec_query()` for the enumerators), so the callers don't
+ * need to set it. The proxies are tracked by identity in a cache which holds
+ * no references, so the blanket is set once per proxy, and once again only
+ * if the configuration is changed.
+ *
+ * @returns `true` if the blanket has been set, or `false` if it's already
+ * set or not configured.
+ *
+ * @see configure_proxy_blanket().
+ */
+inline bool apply_proxy_blanket(IUnknown* const proxy)
+{
+  const auto& snapshot = detail::configured_proxy_blanket();
+  if (!snapshot.blanket)
+    return false;
+  else if (!proxy)
+    throw std::invalid_argument{"cannot set proxy blanket: null proxy"};
+
+  const auto identity = detail::proxy_identity(proxy);
+  {
+    const std::lock_guard lg{detail::proxy_blanket_cache_mutex};
+    if (const auto i = detail::proxy_blanket_cache.find(identity);
+      i != detail::proxy_blanket_cache.end() && i->second == snapshot.version) {
+      detail::proxy_blanket_skipped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  }
+  snapshot.blanket->apply(proxy);
+  {
+    const std::lock_guard lg{detail::proxy_blanket_cache_mutex};
+    detail::proxy_blanket_cache[identity] = snapshot.version;
+  }
+  detail::proxy_blanket_applied.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+/// @returns The statistics of `apply_proxy_blanket()` of all threads.
+inline Proxy_blanket_stats proxy_blanket_stats()
+{
+  const std::lock_guard lg{detail::proxy_blanket_cache_mutex};
+  return Proxy_blanket_stats{
+    detail::proxy_blanket_applied.load(std::memory_order_relaxed),
+    detail::proxy_blanket_skipped.load(std::memory_order_relaxed),
+    detail::proxy_blanket_cache.size()};
+}
+
+// -----------------------------------------------------------------------------
+// Retry
+// -----------------------------------------------------------------------------
+
+namespace detail {
+
+inline std::mutex retry_policy_mutex;
+inline std::shared_ptr<const Retry_policy> retry_policy;
+
+} // namespace detail
+
+/**
+ * @brief Sets the policy used by the wrappers of remote calls (e.g.
+ * `wmi::Services::exec_query()` and `tasc::v2::Task_service::connect()`).
+ *
+ * @param policy The policy, or `std::nullopt` to disable retries.
+ */
+inline void configure_retry_policy(std::optional<Retry_policy> policy)
+{
+  auto value = policy ?
+    std::make_shared<const Retry_policy>(std::move(*policy)) : nullptr;
+  const std::lock_guard lg{detail::retry_policy_mutex};
+  detail::retry_policy.swap(value);
+}
+
+/**
+ * @brief Calls `f` until it succeeds, throws an error which is not transient
+ * according to `policy`, or `policy` is exhausted.
+ *
+ * @returns The result of `f`.
+ *
+ * @see basic_with_retry(), retry_stats().
+ */
+template<class F>
+decltype(auto) with_retry(const Retry_policy& policy, F&& f)
+{
+  return basic_with_retry<Win_error>(policy, std::forward<F>(f),
+    System_retry_clock{});
+}
+
+namespace detail {
+
+/// Calls `f` with the configured retry policy, if any.
+template<class F>
+decltype(auto) with_configured_retry(F&& f)
+{
+  std::shared_ptr<const Retry_policy> policy;
+  {
+    const std::lock_guard lg{retry_policy_mutex};
+    policy = retry_policy;
+  }
+  if (policy)
+    return with_retry(*policy, std::forward<F>(f));
+  return f();
+}
+
+} // namespace detail
+
+/**
+ * @brief The message filter which repeats the calls rejected by the servers
+ * according to the retry policy.
+ *
+ * @remarks Used by the single-threaded apartments only.
+ *
+ * @see Message_filter_registration.
+ */
+class Message_filter final : public IMessageFilter, private Noncopymove {
+public:
+  /// The constructor.
+  explicit Message_filter(Retry_policy policy = {}) noexcept
+    : policy_{std::move(policy)}
+  {}
+
+  /// @returns The policy.
+  const Retry_policy& policy() const noexcept
+  {
+    return policy_;
+  }
+
+  // IUnknown overrides
+
+  HRESULT QueryInterface(REFIID id, void** const object) override
+  {
+    if (!object)
+      return E_POINTER;
+
+    if (id == __uuidof(IMessageFilter))
+      *object = static_cast<IMessageFilter*>(this);
+    else if (id == __uuidof(IUnknown))
+      *object = static_cast<IUnknown*>(this);
+    else {
+      *object = nullptr;
+      return E_NOINTERFACE;
+    }
+
+    AddRef();
+    return S_OK;
+  }
+
+  ULONG AddRef() override
+  {
+    return ++ref_count_;
+  }
+
+  ULONG Release() override
+  {
+    return ref_count_ ? --ref_count_ : 0;
+  }
+
+  // IMessageFilter overrides
+
+  DWORD HandleInComingCall(const DWORD, const HTASK, const DWORD,
+    const LPINTERFACEINFO) override
+  {
+    return SERVERCALL_ISHANDLED;
+  }
+
+  DWORD RetryRejectedCall(const HTASK, const DWORD tick_count,
+    const DWORD reject_type) override
+  {
+    constexpr auto cancel = static_cast<DWORD>(-1);
+    if (reject_type != SERVERCALL_RETRYLATER)
+      return cancel;
+
+    const auto delay = rejection_delay(policy_,
+      std::chrono::milliseconds{tick_count}, detail::retry_random());
+    if (!delay) {
+      detail::retry_exhausted.fetch_add(1, std::memory_order_relaxed);
+      return cancel;
+    }
+    const auto result = std::chrono::ceil<std::chrono::milliseconds>(*delay);
+    detail::record_retry(result);
+    // The values below 100 mean "retry immediately".
+    return static_cast<DWORD>(result.count());
+  }
+
+  DWORD MessagePending(const HTASK, const DWORD, const DWORD) override
+  {
+    return PENDINGMSG_WAITDEFPROCESS;
+  }
+
+private:
+  Retry_policy policy_;
+  ULONG ref_count_{};
+};
+
+/// The registration of `Message_filter` on the current thread.
+class Message_filter_registration final : private Noncopymove {
+public:
+  /// Restores the previously registered message filter.
+  ~Message_filter_registration()
+  {
+    IMessageFilter* current{};
+    CoRegisterMessageFilter(previous_, &current);
+    if (current)
+      current->Release();
+    if (previous_)
+      previous_->Release();
+  }
+
+  /**
+   * @brief Registers the message filter with `policy`.
+   *
+   * @par Requires
+   * The current thread is in the single-threaded apartment.
+   */
+  explicit Message_filter_registration(Retry_policy policy = {})
+    : filter_{std::make_unique<Message_filter>(std::move(policy))}
+  {
+    require_apartment(Apartment_model::apartment_threaded);
+    const auto err = CoRegisterMessageFilter(filter_.get(), &previous_);
+    throw_if_error(err, "cannot register message filter");
+  }
+
+  /// @returns The registered filter.
+  const Message_filter& filter() const noexcept
+  {
+    return *filter_;
+  }
+
+private:
+  std::unique_ptr<Message_filter> filter_;
+  IMessageFilter* previous_{};
+};
+
+// -----------------------------------------------------------------------------
+// Circuit breaker
+// -----------------------------------------------------------------------------
+
+using Circuit_breakers = Basic_circuit_breakers<System_retry_clock>;
+
+namespace detail {
+
+inline std::mutex circuit_breakers_mutex;
+inline std::shared_ptr<Circuit_breakers> circuit_breakers;
+
+/**
+ * @brief Calls `f` through the configured circuit breaker of `host`, if any.
+ *
+ * @param host The host name, or empty string or `.` for the local host,
+ * which is never short-circuited.
+ */
+template<class F>
+decltype(auto) with_configured_circuit_breaker(const std::wstring_view host,
+  F&& f)
+{
+  std::shared_ptr<Circuit_breakers> breakers;
+  if (!host.empty() && host != L".") {
+    const std::lock_guard lg{circuit_breakers_mutex};
+    breakers = circuit_breakers;
+  }
+  if (breakers)
+    return breakers->call<Win_error, Timeout_error>(host, std::forward<F>(f));
+  return f();
+}
+
+} // namespace detail
+
+/**
+ * @brief Sets the options of the circuit breakers of the remote hosts used
+ * by the wrappers of connections (e.g. `wmi::Locator::connect_server()` and
+ * `tasc::v2::Task_service::connect()`).
+ *
+ * @param options The options, or `std::nullopt` to disable the breakers.
+ *
+ * @remarks The states of the breakers are reset.
+ */
+inline void configure_circuit_breaker(
+  const std::optional<Circuit_breaker_options>& options)
+{
+  auto value = options ? std::make_shared<Circuit_breakers>(*options) : nullptr;
+  const std::lock_guard lg{detail::circuit_breakers_mutex};
+  detail::circuit_breakers.swap(value);
+}
+
+/// @returns The statistics of the configured circuit breakers.
+inline Circuit_breaker_stats circuit_breaker_stats()
+{
+  std::shared_ptr<Circuit_breakers> breakers;
+  {
+    const std::lock_guard lg{detail::circuit_breakers_mutex};
+    breakers = detail::circuit_breakers;
+  }
+  return breakers ? breakers->stats() : Circuit_breaker_stats{};
+}
+
+// -----------------------------------------------------------------------------
+// Deadline
+// -----------------------------------------------------------------------------
+
+namespace detail {
+
+/// The state of `Deadline` shared with the timer thread of deadlines.
+struct Deadline_state final : std::enable_shared_from_this<Deadline_state> {
+  explicit Deadline_state(const DWORD thread_id) noexcept
+    : thread_id{thread_id}
+    , timer{&Deadline_state::expire, this}
+  {}
+
+  const DWORD thread_id;
+  std::atomic_bool is_expired{};
+  /// The delay of the next cancellation (used by the timer thread only).
+  std::chrono::milliseconds backoff{};
+  std::mutex mutex;
+  /// `false` once the deadline is released (guarded by `mutex`).
+  bool is_active{true};
+  Timer_thread::Wheel::Timer timer;
+
+  static bool expire(void* data) noexcept;
+};
+
+/**
+ * @brief The deadlines expired on the last tick of the timer thread of
+ * deadlines (used by that thread only).
+ */
+inline std::vector<std::shared_ptr<Deadline_state>> expired_deadlines;
+
+/**
+ * @brief Records the expired deadline to cancel the calls of its thread after
+ * the wheel is unlocked.
+ *
+ * @returns `true` to retry on the next tick if the deadline can't be recorded.
+ */
+inline bool Deadline_state::expire(void* const data) noexcept
+{
+  auto* const self = static_cast<Deadline_state*>(data);
+  self->is_expired.store(true, std::memory_order_release);
+  try {
+    expired_deadlines.push_back(self->shared_from_this());
+    return false;
+  } catch (...) {
+    return true;
+  }
+}
+
+/**
+ * @brief Cancels the calls of the threads of the expired deadlines, and
+ * re-arms the deadlines to cancel the calls made after the cancellation.
+ *
+ * @details The delay of re-arming is doubled every time up to 320 ms.
+ */
+inline void cancel_expired_calls(Timer_thread::Wheel& wheel) noexcept
+{
+  constexpr std::chrono::milliseconds max_backoff{320};
+  for (const auto& state : expired_deadlines) {
+    const std::lock_guard lg{state->mutex};
+    if (!state->is_active)
+      continue;
+    CoCancelCall(state->thread_id, 0);
+    state->backoff = std::min(max_backoff, state->backoff.count() ?
+      2*state->backoff : std::chrono::duration_cast<std::chrono::milliseconds>(
+        wheel.tick()));
+    try {
+      wheel.arm(state->timer,
+        std::chrono::steady_clock::now() + state->backoff);
+    } catch (...) {}
+  }
+  expired_deadlines.clear();
+}
+
+/// @returns The timer thread of deadlines (which is never destroyed).
+inline Timer_thread& deadline_timer()
+{
+  static auto* const result = new Timer_thread{std::chrono::milliseconds{10},
+    1024, &cancel_expired_calls};
+  return *result;
+}
+
+/**
+ * @brief The deadline of the outgoing calls of the current thread.
+ *
+ * @details Once expired, the pending call is cancelled by the timer thread
+ * outside of the lock of its wheel. The cancellation is repeated with
+ * backoff, so the calls made after the expiration are cancelled as well.
+ */
+class Deadline final : private Noncopymove {
+public:
+  ~Deadline()
+  {
+    {
+      const std::lock_guard lg{state_->mutex};
+      state_->is_active = false;
+    }
+    deadline_timer().wheel().disarm(state_->timer);
+    CoDisableCallCancellation(nullptr);
+  }
+
+  explicit Deadline(const std::chrono::steady_clock::time_point deadline)
+    : state_{std::make_shared<Deadline_state>(GetCurrentThreadId())}
+  {
+    const auto err = CoEnableCallCancellation(nullptr);
+    throw_if_error(err, "cannot enable call cancellation");
+    try {
+      deadline_timer().wheel().arm(state_->timer, deadline);
+    } catch (...) {
+      CoDisableCallCancellation(nullptr);
+      throw;
+    }
+  }
+
+  bool is_expired() const noexcept
+  {
+    return state_->is_expired.load(std::memory_order_acquire);
+  }
+
+private:
+  std::shared_ptr<Deadline_state> state_;
+};
+
+} // namespace detail
+
+/**
+ * @brief Calls `f` cancelling its outgoing COM calls pending at `deadline`
+ * by `CoCancelCall()`.
+ *
+ * @details The deadline is checked by the shared timer with the resolution
+ * of 10 ms.
+ *
+ * @returns The result of `f`.
+ *
+ * @throws `Timeout_error` instead of `Win_error` with `RPC_E_CALL_CANCELED`
+ * thrown by `f` after the deadline.
+ *
+ * @remarks Only the calls to out-of-process servers made through proxies
+ * (e.g. `wmi::Locator::connect_server()` and
+ * `tasc::v2::Task_service::connect()` to remote hosts) can be cancelled.
+ */
+template<class F>
+decltype(auto) with_deadline(
+  const std::chrono::steady_clock::time_point deadline, F&& f)
+{
+  const detail::Deadline dl{deadline};
+  try {
+    return f();
+  } catch (const Win_error& e) {
+    if (e.code() == RPC_E_CALL_CANCELED && dl.is_expired())
+      throw Timeout_error{std::string{"deadline exceeded: "}.append(e.what())};
+    throw;
+  }
+}
+
+/// @overload
+template<class Rep, class Period, class F>
+decltype(auto) with_deadline(const std::chrono::duration<Rep, Period> timeout,
+  F&& f)
+{
+  return with_deadline(std::chrono::steady_clock::now() +
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout),
+    std::forward<F>(f));
+}
+
 } // namespace dmitigr::wincom
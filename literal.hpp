@@ -0,0 +1,224 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "hash.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace dmitigr::wincom {
+
+/// A value of enumeration and its literal.
+template<typename E>
+struct Literal final {
+  E value;
+  const char* literal;
+};
+
+/**
+ * @brief A bidirectional map between the values of enumeration and their
+ * literals.
+ *
+ * @details The literals are looked up with a perfect hash generated at
+ * compile time, so `from_literal()` costs one hash of the input, one table
+ * load and at most one string comparison. Only the length and the shortest
+ * suffix which distinguishes the literals are hashed, since the literals of
+ * the same enumeration usually share a long prefix. Since the enumerations
+ * are small, `to_literal()` is a linear scan over contiguous values.
+ *
+ * @see make_literal_map().
+ */
+template<typename E, std::size_t N>
+class Literal_map final {
+  static_assert(N > 0);
+public:
+  /// The number of slots of the hash table.
+  static constexpr std::size_t slot_count{std::bit_ceil(2*N)};
+
+  /// @returns The literal of `value`, or `nullptr` if there is no such value.
+  constexpr const char* to_literal(const E value) const noexcept
+  {
+    for (std::size_t i{}; i < N; ++i) {
+      if (values_[i] == value)
+        return literals_[i].data();
+    }
+    return nullptr;
+  }
+
+  /// @returns The value of `literal`, or `std::nullopt` if there is no such one.
+  constexpr std::optional<E> from_literal(const std::string_view literal)
+    const noexcept
+  {
+    if (const auto index = slots_[slot(seed_, suffix_size_, literal)]) {
+      if (literal == literals_[index - 1])
+        return values_[index - 1];
+    }
+    return std::nullopt;
+  }
+
+  /// @returns The number of entries.
+  static constexpr std::size_t size() noexcept
+  {
+    return N;
+  }
+
+private:
+  template<typename T, std::size_t S>
+  friend consteval Literal_map<T, S> make_literal_map(const Literal<T>(&)[S]);
+
+  std::array<E, N> values_{};
+  std::array<std::string_view, N> literals_{};
+  /// The 1-based indexes of entries (or zeros for empty slots).
+  std::array<std::uint16_t, slot_count> slots_{};
+  std::uint64_t seed_{};
+  std::size_t suffix_size_{};
+
+  constexpr Literal_map() = default;
+
+  static constexpr std::size_t slot(const std::uint64_t seed,
+    const std::size_t suffix_size, const std::string_view literal) noexcept
+  {
+    const auto suffix = literal.substr(literal.size()
+      - std::min(suffix_size, literal.size()));
+    auto hash = (Fnv1a::offset_basis ^ seed) * Fnv1a::prime;
+    hash = (hash ^ literal.size()) * Fnv1a::prime;
+    for (const auto ch : suffix)
+      hash = (hash ^ static_cast<unsigned char>(ch)) * Fnv1a::prime;
+    // Fibonacci hashing: the high bits are the best mixed ones.
+    return static_cast<std::size_t>((hash * 0x9e3779b97f4a7c15)
+      >> (64 - std::countr_zero(slot_count)));
+  }
+};
+
+/**
+ * @returns The literal map of `entries`.
+ *
+ * @par Requires
+ * Both values and literals of `entries` are unique.
+ *
+ * @remarks The evaluation fails to compile if the requirement isn't met.
+ */
+template<typename E, std::size_t N>
+consteval Literal_map<E, N> make_literal_map(const Literal<E>(&entries)[N])
+{
+  static_assert(N < 0xffff);
+
+  Literal_map<E, N> result;
+  for (std::size_t i{}; i < N; ++i) {
+    if (!entries[i].literal)
+      throw std::invalid_argument{"null literal"};
+    for (std::size_t j{}; j < i; ++j) {
+      if (entries[i].value == entries[j].value
+        || std::string_view{entries[i].literal} == entries[j].literal)
+        throw std::invalid_argument{"duplicate literal map entry"};
+    }
+    result.values_[i] = entries[i].value;
+    result.literals_[i] = entries[i].literal;
+  }
+
+  // Find the shortest suffix which (along with the length) is unique.
+  const auto is_unique = [&result](const std::size_t suffix_size)
+  {
+    const auto key = [suffix_size](const std::string_view literal)
+    {
+      return literal.substr(literal.size()
+        - std::min(suffix_size, literal.size()));
+    };
+    for (std::size_t i{}; i < N; ++i) {
+      const auto lhs = result.literals_[i];
+      for (std::size_t j{}; j < i; ++j) {
+        const auto rhs = result.literals_[j];
+        if (lhs.size() == rhs.size() && key(lhs) == key(rhs))
+          return false;
+      }
+    }
+    return true;
+  };
+  while (!is_unique(result.suffix_size_))
+    ++result.suffix_size_;
+
+  for (std::uint64_t seed{}; seed < 0x10000; ++seed) {
+    decltype(result.slots_) slots{};
+    bool is_perfect{true};
+    for (std::size_t i{}; i < N && is_perfect; ++i) {
+      auto& index = slots[result.slot(seed, result.suffix_size_,
+          result.literals_[i])];
+      if (index)
+        is_perfect = false;
+      else
+        index = static_cast<std::uint16_t>(i + 1);
+    }
+    if (is_perfect) {
+      result.slots_ = slots;
+      result.seed_ = seed;
+      return result;
+    }
+  }
+  throw std::logic_error{"cannot generate perfect hash of literals"};
+}
+
+// -----------------------------------------------------------------------------
+// Literals of enumerations
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief The literal map of enumeration `E`.
+ *
+ * @details To provide `to_literal()` and `from_literal()` for `E`, this
+ * template is specialized (in this namespace) by the result of
+ * make_literal_map(). The literals are the upper-case names of enumerators
+ * as spelled in Windows SDK (e.g. `TASK_STATE_READY`), or in the same style
+ * (the name of enumeration followed by the name of enumerator) for the
+ * enumerations defined by this library.
+ */
+template<typename E>
+inline constexpr auto literal_map = nullptr;
+
+namespace detail {
+template<typename E>
+inline constexpr bool has_literal_map = std::is_enum_v<E>
+  && !std::is_null_pointer_v<std::remove_cv_t<decltype(literal_map<E>)>>;
+} // namespace detail
+
+/// @returns The literal of `value`, or `nullptr` if there is no such value.
+template<typename E>
+constexpr const char* to_literal(const E value) noexcept
+  requires detail::has_literal_map<E>
+{
+  return literal_map<E>.to_literal(value);
+}
+
+/**
+ * @returns The value of enumeration `E` which literal is `literal`, or
+ * `std::nullopt` if there is no such value.
+ */
+template<typename E>
+constexpr std::optional<E> from_literal(const std::string_view literal) noexcept
+  requires detail::has_literal_map<E>
+{
+  return literal_map<E>.from_literal(literal);
+}
+
+} // namespace dmitigr::wincom
@@ -18,7 +18,11 @@
 #pragma comment(lib, "ole32")
 
 #include "../base/noncopymove.hpp"
+#include "async_queue.hpp"
 #include "exceptions.hpp"
+#include "instrumentation.hpp"
+#include "library.hpp"
+#include "variant_batch.hpp"
 
 #include <comdef.h> // avoid LNK2019
 #include <ocidl.h>
@@ -27,11 +31,18 @@
 #include <WTypes.h> // MSHCTX, MSHLFLAGS
 
 #include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <span>
+#include <string_view>
 #include <typeinfo>
 #include <type_traits>
+#include <vector>
 
 namespace dmitigr::wincom {
 
@@ -39,6 +50,12 @@ namespace dmitigr::wincom {
 // Unknown_api
 // -----------------------------------------------------------------------------
 
+/**
+ * @brief The base of the wrappers of COM interfaces.
+ *
+ * @details If `DerivedType::is_proxy_blanket_applied` is `true` the wrapper
+ * evicts the proxy from the cache of `apply_proxy_blanket()` on release.
+ */
 template<class DerivedType, class ApiType>
 class Unknown_api {
 public:
@@ -72,6 +89,8 @@ public:
   virtual ~Unknown_api()
   {
     if (api_) {
+      if constexpr (requires {requires Derived::is_proxy_blanket_applied;})
+        detail::forget_proxy_blanket(api_);
       api_->Release();
       api_ = nullptr;
     }
@@ -118,7 +137,10 @@ public:
 
   const Api& api() const
   {
-    check(api_, "invalid "+std::string{typeid(Derived).name()}+" instance used");
+    // The message is built only on failure since it's the hot path.
+    if (!api_)
+      throw std::logic_error{"invalid " + std::string{typeid(Derived).name()}
+        + " instance used"};
     return *api_;
   }
 
@@ -194,6 +216,7 @@ public:
   explicit Basic_com_object(const DWORD context_mask,
     IUnknown* const aggregate = {})
   {
+    ensure_library();
     if (const auto err = CoCreateInstance(
         __uuidof(Object),
         aggregate,
@@ -415,6 +438,229 @@ public:
   }
 };
 
+// -----------------------------------------------------------------------------
+// Async_call
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief The asynchronous call of the method of the asynchronous interface
+ * (the one generated by MIDL from the interface with `async_uuid`) made
+ * through the call object of the proxy.
+ *
+ * @details The call object is created by `ICallFactory::CreateCall()` of the
+ * proxy. Its completion is detected by `ISynchronize` of the call object and
+ * its cancellation is requested by `ICancelMethodCalls`.
+ *
+ * @tparam AsyncApi The asynchronous interface, such as `AsyncIUnknown`.
+ * @tparam R The type of the result (possibly `void`).
+ *
+ * @see Async_queue.
+ */
+template<class AsyncApi, class R>
+class Async_call final {
+public:
+  using Api = AsyncApi;
+  using Result = R;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param proxy The proxy of the synchronous interface.
+   * @param begin The function of `Api&` which calls `Begin_*` method and
+   * returns its `HRESULT`.
+   * @param finish The function of `Api&` which calls `Finish_*` method and
+   * returns the result or throws.
+   */
+  Async_call(IUnknown* const proxy,
+    std::function<HRESULT(Api&)> begin,
+    std::function<Result(Api&)> finish)
+    : begin_{std::move(begin)}
+    , finish_{std::move(finish)}
+  {
+    if (!begin_ || !finish_)
+      throw std::invalid_argument{"cannot create async call: invalid"
+        " begin or finish function"};
+    const auto factory = Ptr<ICallFactory>::query(proxy);
+    IUnknown* unknown{};
+    const auto err = factory->CreateCall(__uuidof(Api), nullptr, IID_IUnknown,
+      &unknown);
+    throw_if_error(err, "cannot create async call object");
+    const Ptr<IUnknown> call{unknown};
+    api_ = call.to<Api>();
+    sync_ = call.to<ISynchronize>();
+    cancel_ = call.to<ICancelMethodCalls>();
+    const auto sync_handle = call.to<ISynchronizeHandle>();
+    const auto err2 = sync_handle->GetHandle(&handle_);
+    throw_if_error(err2, "cannot get handle of async call object");
+  }
+
+  /// Begins the call.
+  void begin()
+  {
+    const auto err = begin_(*api_.get());
+    throw_if_error(err, "cannot begin async call");
+  }
+
+  /// @returns `true` if the call is completed.
+  bool is_completed()
+  {
+    return sync_->Wait(0, 0) == S_OK;
+  }
+
+  /// @returns The result of the completed call.
+  Result finish()
+  {
+    return finish_(*api_.get());
+  }
+
+  /// Requests the cancellation of the call.
+  void cancel() noexcept
+  {
+    cancel_->Cancel(0);
+  }
+
+  /**
+   * @brief Waits for the completion of any of `calls` by
+   * `CoWaitForMultipleHandles()` (which dispatches the messages in STA).
+   *
+   * @returns The index of the completed call, or `calls.size()` on timeout.
+   */
+  static std::size_t wait_any(const std::span<Async_call* const> calls,
+    const std::chrono::milliseconds timeout)
+  {
+    // The completion of the calls beyond the limit is noticed by polling.
+    constexpr std::size_t max_handle_count{MAXIMUM_WAIT_OBJECTS - 1};
+    constexpr std::chrono::milliseconds poll_interval{10};
+    const auto count = std::min(calls.size(), max_handle_count);
+    if (!count)
+      return calls.size();
+
+    std::vector<HANDLE> handles(count);
+    for (std::size_t i{}; i < count; ++i)
+      handles[i] = calls[i]->handle_;
+    const auto wait = count < calls.size() ?
+      std::min(timeout, poll_interval) : timeout;
+    const auto max_wait = static_cast<std::chrono::milliseconds::rep>(
+      std::numeric_limits<DWORD>::max() - 1);
+    const auto wait_ms = wait.count() > max_wait ? INFINITE :
+      static_cast<DWORD>(std::max<std::chrono::milliseconds::rep>(
+          wait.count(), 0));
+    DWORD index{};
+    const auto err = CoWaitForMultipleHandles(0, wait_ms,
+      static_cast<ULONG>(count), handles.data(), &index);
+    if (err == S_OK && index < count)
+      return index;
+    else if (err == RPC_S_CALLPENDING)
+      return calls.size();
+    throw_if_error(err, "cannot wait for async calls");
+    return calls.size();
+  }
+
+private:
+  std::function<HRESULT(Api&)> begin_;
+  std::function<Result(Api&)> finish_;
+  Ptr<Api> api_;
+  Ptr<ISynchronize> sync_;
+  Ptr<ICancelMethodCalls> cancel_;
+  HANDLE handle_{}; // owned by the call object
+};
+
+/**
+ * @brief The queue of the asynchronous calls of `AsyncApi`.
+ *
+ * @par Example
+ * @code
+ * // AsyncIFoo is generated by MIDL for IFoo with async_uuid.
+ * Async_queue<AsyncIFoo, LONG> queue{Async_queue_options{8}};
+ * auto future = queue.submit({foo.get(),
+ *   [](AsyncIFoo& api) { return api.Begin_Bar(42); },
+ *   [](AsyncIFoo& api)
+ *   {
+ *     LONG result{};
+ *     throw_if_error(api.Finish_Bar(&result), "cannot call Bar");
+ *     return result;
+ *   }}, std::chrono::seconds{5});
+ * queue.wait_all();
+ * const auto value = future.get();
+ * @endcode
+ */
+template<class AsyncApi, class Result>
+using Async_queue = Basic_async_queue<Async_call<AsyncApi, Result>>;
+
+// -----------------------------------------------------------------------------
+// Variant_batch
+// -----------------------------------------------------------------------------
+
+/// The traits of `VARIANT` for `Basic_variant_batch`.
+struct Variant_traits final {
+  using Variant = VARIANT;
+
+  static void clear(VARIANT& variant) noexcept
+  {
+    VariantClear(&variant);
+  }
+
+  static bool is_empty(const VARIANT& variant) noexcept
+  {
+    return variant.vt == VT_EMPTY;
+  }
+
+  /**
+   * @tparam T One of `bool`, `LONG`, `double`, `std::wstring_view` (which
+   * refers to `BSTR`), `IUnknown*` and `IDispatch*`.
+   */
+  template<class T>
+  static std::optional<T> get(const VARIANT& variant) noexcept
+  {
+    const auto vt = variant.vt;
+    if constexpr (std::is_same_v<T, bool>) {
+      if (vt == VT_BOOL)
+        return variant.boolVal != VARIANT_FALSE;
+    } else if constexpr (std::is_same_v<T, LONG>) {
+      if (vt == VT_I4)
+        return variant.lVal;
+    } else if constexpr (std::is_same_v<T, double>) {
+      if (vt == VT_R8)
+        return variant.dblVal;
+    } else if constexpr (std::is_same_v<T, std::wstring_view>) {
+      if (vt == VT_BSTR)
+        return variant.bstrVal ? std::wstring_view{variant.bstrVal,
+          SysStringLen(variant.bstrVal)} : std::wstring_view{};
+    } else if constexpr (std::is_same_v<T, IDispatch*>) {
+      if (vt == VT_DISPATCH)
+        return variant.pdispVal;
+    } else if constexpr (std::is_same_v<T, IUnknown*>) {
+      if (vt == VT_UNKNOWN)
+        return variant.punkVal;
+      else if (vt == VT_DISPATCH)
+        return variant.pdispVal;
+    } else
+      static_assert(sizeof(T) && false, "unsupported type of VARIANT value");
+    return std::nullopt;
+  }
+};
+
+/**
+ * @brief A reusable array of `VARIANT`s.
+ *
+ * @par Example
+ * @code
+ * Variant_batch batch{64};
+ * HRESULT err{S_OK};
+ * while (err == S_OK) {
+ *   const auto slots = batch.prepare();
+ *   ULONG fetched{};
+ *   err = enumerator.Next(slots.size(), slots.data(), &fetched);
+ *   // ...
+ *   batch.commit(fetched);
+ *   for (std::size_t i{}; i < batch.size(); ++i)
+ *     if (const auto disp = batch.get<IDispatch*>(i))
+ *       // ...
+ * }
+ * @endcode
+ */
+using Variant_batch = Basic_variant_batch<Variant_traits>;
+
 // -----------------------------------------------------------------------------
 
 namespace detail {
@@ -432,11 +678,13 @@ template<typename T>
   return const_cast<T&>(obj);
 }
 
-template<class String, class Wrapper, class Api>
-String str(const Wrapper& wrapper, HRESULT(Api::* getter)(BSTR*))
+template<class String, auto Getter, class Wrapper>
+String str(const Wrapper& wrapper, const char* const name)
 {
-  BSTR value;
-  (detail::api(wrapper).*getter)(&value);
+  BSTR value{};
+  call<Getter>(wrapper, name, &value);
+  if (!value)
+    return String{};
   _bstr_t tmp{value, false}; // take ownership
   return String(tmp);
 }
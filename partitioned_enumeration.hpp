@@ -0,0 +1,220 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "apartment_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom {
+
+/// The options of the partitioned enumeration.
+struct Partition_options final {
+  /// The maximum number of partitions, or `0` for the number of workers.
+  std::size_t partition_count{};
+  /// The minimum number of elements per partition.
+  std::size_t min_partition_size{256};
+  /// The number of elements requested per fetch.
+  std::size_t batch_size{64};
+};
+
+namespace detail {
+
+/**
+ * @brief Enumerates at most `limit` elements of `fetcher`.
+ *
+ * @returns The number of elements enumerated.
+ */
+template<class Fetcher, class F>
+std::size_t enumerate_partition(Fetcher& fetcher, std::size_t limit,
+  const std::size_t batch_size, F& sink)
+{
+  using Slot = typename Fetcher::Slot;
+  std::vector<Slot> slots(batch_size);
+  std::size_t result{};
+  while (limit) {
+    const auto requested = std::min(batch_size, limit);
+    const auto fetched = fetcher.fetch(std::span{slots}.first(requested));
+    try {
+      for (std::size_t i{}; i < fetched; ++i)
+        sink(fetcher.convert(slots[i]));
+    } catch (...) {
+      for (std::size_t i{}; i < fetched; ++i)
+        Fetcher::clear(slots[i]);
+      throw;
+    }
+    for (std::size_t i{}; i < fetched; ++i)
+      Fetcher::clear(slots[i]);
+    result += fetched;
+    limit -= fetched;
+    if (fetched < requested)
+      break;
+  }
+  return result;
+}
+
+/**
+ * @brief Enumerates `source` by partitions on the workers of `pool`.
+ *
+ * @param make_sink The function of partition index which returns the
+ * function of value.
+ */
+template<class Fetcher, class Pool, class MakeSink>
+void enumerate_partitioned(Fetcher& source, const std::size_t count,
+  Pool& pool, const Partition_options& options, MakeSink&& make_sink)
+{
+  constexpr auto unlimited = std::numeric_limits<std::size_t>::max();
+  if (!options.batch_size)
+    throw std::invalid_argument{"cannot enumerate partitioned: zero batch size"};
+
+  const auto partition_count = std::clamp<std::size_t>(
+    count / std::max<std::size_t>(options.min_partition_size, 1), 1,
+    options.partition_count ? options.partition_count : pool.worker_count());
+
+  // Clone the cursors on the calling thread, since the source lives there.
+  std::vector<Fetcher> cursors;
+  if (partition_count > 1) {
+    cursors.reserve(partition_count);
+    for (std::size_t i{}; i < partition_count; ++i) {
+      if (auto cursor = source.clone())
+        cursors.push_back(std::move(*cursor));
+      else {
+        cursors.clear();
+        break;
+      }
+    }
+  }
+  if (cursors.empty()) {
+    auto sink = make_sink(std::size_t{});
+    enumerate_partition(source, unlimited, options.batch_size, sink);
+    return;
+  }
+
+  std::vector<std::future<void>> futures;
+  futures.reserve(partition_count);
+  std::exception_ptr error;
+  for (std::size_t i{}; i < partition_count; ++i) {
+    const auto offset = count * i / partition_count;
+    // The last partition takes the elements added since `count` was taken.
+    const auto limit = i + 1 < partition_count ?
+      count * (i + 1) / partition_count - offset : unlimited;
+    try {
+      futures.push_back(pool.submit([&, i, offset, limit](auto&)
+      {
+        auto& cursor = cursors[i];
+        cursor.skip(offset);
+        auto sink = make_sink(i);
+        enumerate_partition(cursor, limit, options.batch_size, sink);
+      }, Affinity::prefer(i % pool.worker_count())));
+    } catch (...) {
+      error = std::current_exception();
+      break;
+    }
+  }
+
+  for (auto& future : futures) {
+    try {
+      future.get();
+    } catch (...) {
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+} // namespace detail
+
+/**
+ * @brief Enumerates `count` elements of `source` split into disjoint
+ * partitions, each of which is consumed on a worker of `pool`.
+ *
+ * @details The partitions are enumerated by the clones of `source` positioned
+ * by `skip()`. If `source` can't be cloned, it's enumerated sequentially on
+ * the calling thread.
+ *
+ * @tparam Fetcher The fetcher of `Basic_batch_range` which also has:
+ *   - `std::optional<Fetcher> clone()`, which returns `std::nullopt` if
+ *   cloning is not supported;
+ *   - `void skip(std::size_t count)`.
+ *
+ * @param count The (expected) number of elements of `source`.
+ * @param f The function of `typename Fetcher::Value&&` which is called
+ * concurrently from the workers in unspecified order.
+ *
+ * @par Requires
+ * The caller is not a worker of `pool`. The cursors of `source` are usable
+ * on the workers of `pool` (e.g. both are in the MTA).
+ *
+ * @see collect_partitioned().
+ */
+template<class Fetcher, class Pool, class F>
+void for_each_partitioned(Fetcher& source, const std::size_t count,
+  Pool& pool, F&& f, const Partition_options& options = {})
+{
+  detail::enumerate_partitioned(source, count, pool, options,
+    [&f](std::size_t){return [&f](auto&& value){f(std::move(value));};});
+}
+
+/**
+ * @returns The elements of `source` in order of enumeration.
+ *
+ * @see for_each_partitioned().
+ */
+template<class Fetcher, class Pool>
+std::vector<typename Fetcher::Value> collect_partitioned(Fetcher& source,
+  const std::size_t count, Pool& pool, const Partition_options& options = {})
+{
+  using Value = typename Fetcher::Value;
+  std::vector<std::vector<Value>> partitions(std::max<std::size_t>(
+      options.partition_count ? options.partition_count : pool.worker_count(),
+      1));
+  detail::enumerate_partitioned(source, count, pool, options,
+    [&partitions](const std::size_t i)
+    {
+      return [&part = partitions[i]](Value&& value)
+      {
+        part.push_back(std::move(value));
+      };
+    });
+
+  if (partitions.size() == 1 || std::all_of(partitions.begin() + 1,
+      partitions.end(), [](const auto& p){return p.empty();}))
+    return std::move(partitions.front());
+
+  std::size_t size{};
+  for (const auto& part : partitions)
+    size += part.size();
+  std::vector<Value> result;
+  result.reserve(size);
+  for (auto& part : partitions)
+    std::move(part.begin(), part.end(), std::back_inserter(result));
+  return result;
+}
+
+} // namespace dmitigr::wincom
@@ -41,20 +41,21 @@ public:
   template<class String>
   String connection() const
   {
-    return detail::str<String>(*this, &Api::get_ConnectionString);
+    return detail::str<String, &Api::get_ConnectionString>(*this,
+      "get_ConnectionString");
   }
 
   bool is_revoked() const
   {
     VARIANT_BOOL result{VARIANT_FALSE};
-    detail::api(*this).get_Revoked(&result);
+    detail::call<&Api::get_Revoked>(*this, "get_Revoked", &result);
     return result == VARIANT_TRUE;
   }
 
   void revoke(const bool value = true)
   {
     const VARIANT_BOOL val{value ? VARIANT_TRUE : VARIANT_FALSE};
-    api().put_Revoked(val);
+    detail::call<&Api::put_Revoked>(*this, "put_Revoked", val);
   }
 };
 
@@ -69,7 +70,8 @@ public:
     const PasswordString& password, const long limit)
   {
     IRDPSRAPIInvitation* invitation{};
-    const auto err = api().CreateInvitation(
+    const auto err = detail::call<&Api::CreateInvitation>(*this,
+      "CreateInvitation",
       nullptr,
       detail::bstr(group),
       detail::bstr(password),
@@ -83,7 +85,7 @@ public:
   long invitation_count() const
   {
     long result{};
-    detail::api(*this).get_Count(&result);
+    detail::call<&Api::get_Count>(*this, "get_Count", &result);
     return result;
   }
 
@@ -93,11 +95,7 @@ public:
       throw std::out_of_range{"invitation index out of range"};
 
     IRDPSRAPIInvitation* raw{};
-    VARIANT idx{};
-    VariantInit(&idx);
-    idx.vt = VT_I4;
-    idx.lVal = index;
-    detail::api(*this).get_Item(idx, &raw);
+    detail::call<&Api::get_Item>(*this, "get_Item", _variant_t(index), &raw);
     check(raw, "invalid invitation retrieved from invitation manager");
     return Invitation{raw};
   }
@@ -112,33 +110,33 @@ public:
   template<class String>
   String local_address() const
   {
-    return detail::str<String>(*this, &Api::get_LocalIP);
+    return detail::str<String, &Api::get_LocalIP>(*this, "get_LocalIP");
   }
 
   long local_port() const
   {
     long result{};
-    detail::api(*this).get_LocalPort(&result);
+    detail::call<&Api::get_LocalPort>(*this, "get_LocalPort", &result);
     return result;
   }
 
   template<class String>
   String remote_address() const
   {
-    return detail::str<String>(*this, &Api::get_PeerIP);
+    return detail::str<String, &Api::get_PeerIP>(*this, "get_PeerIP");
   }
 
   long remote_port() const
   {
     long result{};
-    detail::api(*this).get_PeerPort(&result);
+    detail::call<&Api::get_PeerPort>(*this, "get_PeerPort", &result);
     return result;
   }
 
   long protocol() const
   {
     long result{};
-    detail::api(*this).get_Protocol(&result);
+    detail::call<&Api::get_Protocol>(*this, "get_Protocol", &result);
     return result;
   }
 };
@@ -159,35 +157,38 @@ public:
   long id() const
   {
     long result{};
-    detail::api(*this).get_Id(&result);
+    detail::call<&Api::get_Id>(*this, "get_Id", &result);
     return result;
   }
 
   Tcp_connection_info tcp_connection_info() const
   {
     IUnknown* info{};
-    detail::api(*this).get_ConnectivityInfo(&info);
+    detail::call<&Api::get_ConnectivityInfo>(*this, "get_ConnectivityInfo",
+      &info);
     check(info, "invalid attendee connectivity info retrieved from attendee");
+    Tcp_connection_info result;
     try {
-      return Tcp_connection_info::query(info);
+      result = Tcp_connection_info::query(info);
     } catch (const std::runtime_error&) {}
-    return Tcp_connection_info{};
+    info->Release(); // query() doesn't take ownership
+    return result;
   }
 
   void set_control_level(const CTRL_LEVEL level)
   {
-    api().put_ControlLevel(level);
+    detail::call<&Api::put_ControlLevel>(*this, "put_ControlLevel", level);
   }
 
   void terminate_connection()
   {
-    api().TerminateConnection();
+    detail::call<&Api::TerminateConnection>(*this, "TerminateConnection");
   }
 
   Invitation invitation() const
   {
     IRDPSRAPIInvitation* raw{};
-    detail::api(*this).get_Invitation(&raw);
+    detail::call<&Api::get_Invitation>(*this, "get_Invitation", &raw);
     check(raw, "invalid invitation retrieved from attendee instance");
     return Invitation{raw};
   }
@@ -202,7 +203,7 @@ public:
   Attendee attendee() const
   {
     IRDPSRAPIAttendee* raw{};
-    detail::api(*this).get_Attendee(&raw);
+    detail::call<&Api::get_Attendee>(*this, "get_Attendee", &raw);
     check(raw, "invalid attendee retrieved from attendee disconnect info");
     return Attendee{raw};
   }
@@ -210,14 +211,14 @@ public:
   long code() const
   {
     long val{};
-    detail::api(*this).get_Code(&val);
+    detail::call<&Api::get_Code>(*this, "get_Code", &val);
     return val;
   }
 
   ATTENDEE_DISCONNECT_REASON reason() const
   {
     ATTENDEE_DISCONNECT_REASON val{};
-    detail::api(*this).get_Reason(&val);
+    detail::call<&Api::get_Reason>(*this, "get_Reason", &val);
     return val;
   }
 };
@@ -231,22 +232,17 @@ public:
   Session_properties&
   set_clipboard_redirect_enabled(const bool value)
   {
-    VARIANT val{};
-    VariantInit(&val);
-    val.vt = VT_BOOL;
-    val.boolVal = value ? VARIANT_TRUE : VARIANT_FALSE;
-    api().put_Property(_bstr_t{"EnableClipboardRedirect"}, val);
+    detail::call<&Api::put_Property>(*this, "put_Property",
+      _bstr_t{"EnableClipboardRedirect"}, _variant_t(value));
     return *this;
   }
 
   Session_properties&
   set_clipboard_redirect_callback(IRDPSRAPIClipboardUseEvents* const value)
   {
-    VARIANT val{};
-    VariantInit(&val);
-    val.vt = VT_UNKNOWN;
-    val.punkVal = value;
-    api().put_Property(_bstr_t{"SetClipboardRedirectCallback"}, val);
+    detail::call<&Api::put_Property>(*this, "put_Property",
+      _bstr_t{"SetClipboardRedirectCallback"},
+      _variant_t(static_cast<IUnknown*>(value)));
     return *this;
   }
 };
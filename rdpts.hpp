@@ -18,9 +18,12 @@
 
 #include "../winbase/windows.hpp"
 #include "exceptions.hpp"
+#include "literal.hpp"
 #include "object.hpp"
 
 #include <chrono>
+#include <optional>
+#include <string_view>
 #include <type_traits>
 
 #import "libid:8C11EFA1-92C3-11D1-BC1E-00C04FA31489"
@@ -66,83 +69,93 @@ public:
 
   void set_rdp_port(const LONG value)
   {
-    const auto err = api().put_RDPPort(value);
+    const auto err = detail::call<&Api::put_RDPPort>(*this, "put_RDPPort",
+      value);
     throw_if_error(err, "cannot set RDP port");
   }
 
   LONG rdp_port() const
   {
     LONG result{};
-    detail::api(*this).get_RDPPort(&result);
+    detail::call<&Api::get_RDPPort>(*this, "get_RDPPort", &result);
     return result;
   }
 
   void set_smart_sizing_enabled(const bool value)
   {
     const VARIANT_BOOL val{value ? VARIANT_TRUE : VARIANT_FALSE};
-    const auto err = api().put_SmartSizing(val);
+    const auto err = detail::call<&Api::put_SmartSizing>(*this,
+      "put_SmartSizing", val);
     throw_if_error(err, "cannot set smart sizing enabled");
   }
 
   bool is_smart_sizing_enabled() const noexcept
   {
     VARIANT_BOOL result{VARIANT_FALSE};
-    detail::api(*this).get_SmartSizing(&result);
+    detail::call<&Api::get_SmartSizing>(*this, "get_SmartSizing", &result);
     return result == VARIANT_TRUE;
   }
 
   void set_overall_connection_timeout(const std::chrono::seconds value)
   {
-    const auto err = api().put_overallConnectionTimeout(value.count());
+    const auto err = detail::call<&Api::put_overallConnectionTimeout>(*this,
+      "put_overallConnectionTimeout", value.count());
     throw_if_error(err, "cannot set overall connection timeout");
   }
 
   std::chrono::seconds overall_connection_timeout() const
   {
     LONG result{};
-    const auto err = detail::api(*this).get_overallConnectionTimeout(&result);
+    const auto err = detail::call<&Api::get_overallConnectionTimeout>(*this,
+      "get_overallConnectionTimeout", &result);
     throw_if_error(err, "cannot get overall connection timeout");
     return std::chrono::seconds{result};
   }
 
   void set_single_connection_timeout(const std::chrono::seconds value)
   {
-    const auto err = api().put_singleConnectionTimeout(value.count());
+    const auto err = detail::call<&Api::put_singleConnectionTimeout>(*this,
+      "put_singleConnectionTimeout", value.count());
     throw_if_error(err, "cannot set single connection timeout");
   }
 
   std::chrono::seconds single_connection_timeout() const
   {
     LONG result{};
-    const auto err = detail::api(*this).get_singleConnectionTimeout(&result);
+    const auto err = detail::call<&Api::get_singleConnectionTimeout>(*this,
+      "get_singleConnectionTimeout", &result);
     throw_if_error(err, "cannot get single connection timeout");
     return std::chrono::seconds{result};
   }
 
   void set_shutdown_timeout(const std::chrono::seconds value)
   {
-    const auto err = api().put_shutdownTimeout(value.count());
+    const auto err = detail::call<&Api::put_shutdownTimeout>(*this,
+      "put_shutdownTimeout", value.count());
     throw_if_error(err, "cannot set shutdown timeout");
   }
 
   std::chrono::seconds shutdown_timeout() const
   {
     LONG result{};
-    const auto err = detail::api(*this).get_shutdownTimeout(&result);
+    const auto err = detail::call<&Api::get_shutdownTimeout>(*this,
+      "get_shutdownTimeout", &result);
     throw_if_error(err, "cannot get shutdown timeout");
     return std::chrono::seconds{result};
   }
 
   void set_idle_timeout(const std::chrono::minutes value)
   {
-    const auto err = api().put_MinutesToIdleTimeout(value.count());
+    const auto err = detail::call<&Api::put_MinutesToIdleTimeout>(*this,
+      "put_MinutesToIdleTimeout", value.count());
     throw_if_error(err, "cannot set idle timeout");
   }
 
   std::chrono::minutes idle_timeout() const
   {
     LONG result{};
-    const auto err = detail::api(*this).get_MinutesToIdleTimeout(&result);
+    const auto err = detail::call<&Api::get_MinutesToIdleTimeout>(*this,
+      "get_MinutesToIdleTimeout", &result);
     throw_if_error(err, "cannot get idle timeout");
     return std::chrono::minutes{result};
   }
@@ -150,14 +163,16 @@ public:
   /// @param value The minimum valid value is `10000`.
   void set_keep_alive_interval(const std::chrono::milliseconds value)
   {
-    const auto err = api().put_keepAliveInterval(value.count());
+    const auto err = detail::call<&Api::put_keepAliveInterval>(*this,
+      "put_keepAliveInterval", value.count());
     throw_if_error(err, "cannot set keep-alive interval");
   }
 
   std::chrono::milliseconds keep_alive_interval() const
   {
     LONG result{};
-    const auto err = detail::api(*this).get_keepAliveInterval(&result);
+    const auto err = detail::call<&Api::get_keepAliveInterval>(*this,
+      "get_keepAliveInterval", &result);
     throw_if_error(err, "cannot get keep-alive interval");
     return std::chrono::milliseconds{result};
   }
@@ -167,28 +182,32 @@ public:
   void set_auto_reconnect_enabled(const bool value)
   {
     const VARIANT_BOOL val{value ? VARIANT_TRUE : VARIANT_FALSE};
-    const auto err = api().put_EnableAutoReconnect(val);
+    const auto err = detail::call<&Api::put_EnableAutoReconnect>(*this,
+      "put_EnableAutoReconnect", val);
     throw_if_error(err, "cannot set auto reconnect enabled");
   }
 
   bool is_auto_reconnect_enabled() const
   {
     VARIANT_BOOL result{VARIANT_FALSE};
-    const auto err = detail::api(*this).get_EnableAutoReconnect(&result);
+    const auto err = detail::call<&Api::get_EnableAutoReconnect>(*this,
+      "get_EnableAutoReconnect", &result);
     throw_if_error(err, "cannot get auto reconnect enabled");
     return result == VARIANT_TRUE;
   }
 
   void set_max_reconnect_attempts(const LONG value)
   {
-    const auto err = detail::api(*this).put_MaxReconnectAttempts(value);
+    const auto err = detail::call<&Api::put_MaxReconnectAttempts>(*this,
+      "put_MaxReconnectAttempts", value);
     throw_if_error(err, "cannot set max reconnect attempts");
   }
 
   LONG max_reconnect_attempts() const
   {
     LONG result{};
-    const auto err = detail::api(*this).get_MaxReconnectAttempts(&result);
+    const auto err = detail::call<&Api::get_MaxReconnectAttempts>(*this,
+      "get_MaxReconnectAttempts", &result);
     throw_if_error(err, "cannot get max reconnect attempts");
     return result;
   }
@@ -197,7 +216,8 @@ public:
 
   void set_authentication_level(const Server_authentication value)
   {
-    const auto err = api().put_AuthenticationLevel(
+    const auto err = detail::call<&Api::put_AuthenticationLevel>(*this,
+      "put_AuthenticationLevel",
       static_cast<std::underlying_type_t<Server_authentication>>(value));
     throw_if_error(err, "cannot set authentication level");
   }
@@ -210,7 +230,8 @@ public:
   Server_authentication authentication_level() const
   {
     UINT result{};
-    detail::api(*this).get_AuthenticationLevel(&result);
+    detail::call<&Api::get_AuthenticationLevel>(*this,
+      "get_AuthenticationLevel", &result);
     return Server_authentication{result};
   }
 
@@ -219,14 +240,16 @@ public:
   void set_redirect_clipboard_enabled(const bool value)
   {
     const VARIANT_BOOL val{value ? VARIANT_TRUE : VARIANT_FALSE};
-    const auto err = api().put_RedirectClipboard(val);
+    const auto err = detail::call<&Api::put_RedirectClipboard>(*this,
+      "put_RedirectClipboard", val);
     throw_if_error(err, "cannot set redirect clipboard enabled");
   }
 
   bool is_redirect_clipboard_enabled() const
   {
     VARIANT_BOOL result{VARIANT_FALSE};
-    const auto err = detail::api(*this).get_RedirectClipboard(&result);
+    const auto err = detail::call<&Api::get_RedirectClipboard>(*this,
+      "get_RedirectClipboard", &result);
     throw_if_error(err, "cannot get redirect clipboard enabled");
     return result == VARIANT_TRUE;
   }
@@ -235,7 +258,8 @@ public:
 
   void set_network_connection_type(const Network_connection_type value)
   {
-    const auto err = api().put_NetworkConnectionType(
+    const auto err = detail::call<&Api::put_NetworkConnectionType>(*this,
+      "put_NetworkConnectionType",
       static_cast<std::underlying_type_t<Network_connection_type>>(value));
     throw_if_error(err, "cannot set network connection type");
   }
@@ -248,11 +272,53 @@ public:
   Network_connection_type network_connection_type() const
   {
     UINT result{};
-    detail::api(*this).get_NetworkConnectionType(&result);
+    detail::call<&Api::get_NetworkConnectionType>(*this,
+      "get_NetworkConnectionType", &result);
     return Network_connection_type{result};
   }
 };
 
+} // namespace dmitigr::wincom::rdpts
+
+namespace dmitigr::wincom {
+
+template<>
+inline constexpr auto
+literal_map<rdpts::Advanced_settings::Server_authentication> =
+  make_literal_map<rdpts::Advanced_settings::Server_authentication>({
+  {rdpts::Advanced_settings::Server_authentication::disabled,
+   "SERVER_AUTHENTICATION_DISABLED"},
+  {rdpts::Advanced_settings::Server_authentication::required,
+   "SERVER_AUTHENTICATION_REQUIRED"},
+  {rdpts::Advanced_settings::Server_authentication::prompted,
+   "SERVER_AUTHENTICATION_PROMPTED"}
+});
+
+template<>
+inline constexpr auto
+literal_map<rdpts::Advanced_settings::Network_connection_type> =
+  make_literal_map<rdpts::Advanced_settings::Network_connection_type>({
+  {rdpts::Advanced_settings::Network_connection_type::modem,
+   "NETWORK_CONNECTION_TYPE_MODEM"},
+  {rdpts::Advanced_settings::Network_connection_type::low,
+   "NETWORK_CONNECTION_TYPE_LOW"},
+  {rdpts::Advanced_settings::Network_connection_type::satellite,
+   "NETWORK_CONNECTION_TYPE_SATELLITE"},
+  {rdpts::Advanced_settings::Network_connection_type::broadband_high,
+   "NETWORK_CONNECTION_TYPE_BROADBAND_HIGH"},
+  {rdpts::Advanced_settings::Network_connection_type::wan,
+   "NETWORK_CONNECTION_TYPE_WAN"},
+  {rdpts::Advanced_settings::Network_connection_type::lan,
+   "NETWORK_CONNECTION_TYPE_LAN"}
+});
+
+} // namespace dmitigr::wincom
+
+namespace dmitigr::wincom::rdpts {
+
+using wincom::from_literal;
+using wincom::to_literal;
+
 // -----------------------------------------------------------------------------
 // Client
 // -----------------------------------------------------------------------------
@@ -283,13 +349,14 @@ public:
      * releasing it, which causes failure upon of calling api().Release()
      * from ~Bco(). Thus, api.AddRef() call is required here.
      */
-    api().AddRef();
+    detail::call<&Api::AddRef>(*this, "AddRef");
   }
 
   Advanced_settings advanced_settings() const
   {
     MSTSCLib::IMsRdpClientAdvancedSettings8* result{};
-    detail::api(*this).get_AdvancedSettings9(&result);
+    detail::call<&Api::get_AdvancedSettings9>(*this, "get_AdvancedSettings9",
+      &result);
     return Advanced_settings{result};
   }
 
@@ -298,7 +365,7 @@ public:
   template<class String>
   String version() const
   {
-    return detail::str<String>(*this, &Api::get_Version);
+    return detail::str<String, &Api::get_Version>(*this, "get_Version");
   }
 
   /**
@@ -309,27 +376,29 @@ public:
   template<class String>
   void set_server(const String& value)
   {
-    const auto err = api().put_Server(detail::bstr(value));
+    const auto err = detail::call<&Api::put_Server>(*this, "put_Server",
+      detail::bstr(value));
     throw_if_error(err, "cannot set Server property of RDP client");
   }
 
   template<class String>
   String server() const
   {
-    return detail::str<String>(*this, &Api::get_Server);
+    return detail::str<String, &Api::get_Server>(*this, "get_Server");
   }
 
   template<class String>
   void set_user_name(const String& value)
   {
-    const auto err = api().put_UserName(detail::bstr(value));
+    const auto err = detail::call<&Api::put_UserName>(*this, "put_UserName",
+      detail::bstr(value));
     throw_if_error(err, "cannot set UserName property of RDP client");
   }
 
   template<class String>
   String user_name() const
   {
-    return detail::str<String>(*this, &Api::get_UserName);
+    return detail::str<String, &Api::get_UserName>(*this, "get_UserName");
   }
 
   void set_prompt_for_credentials_enabled(const bool value)
@@ -366,52 +435,54 @@ public:
 
   void set_desktop_height(const LONG value)
   {
-    const auto err = api().put_DesktopHeight(value);
+    const auto err = detail::call<&Api::put_DesktopHeight>(*this,
+      "put_DesktopHeight", value);
     throw_if_error(err, "cannot set DesktopHeight property of RDP client");
   }
 
   LONG desktop_height() const
   {
     LONG result{};
-    detail::api(*this).get_DesktopHeight(&result);
+    detail::call<&Api::get_DesktopHeight>(*this, "get_DesktopHeight", &result);
     return result;
   }
 
   void set_desktop_width(const LONG value)
   {
-    const auto err = api().put_DesktopWidth(value);
+    const auto err = detail::call<&Api::put_DesktopWidth>(*this,
+      "put_DesktopWidth", value);
     throw_if_error(err, "cannot set DesktopWidth property of RDP client");
   }
 
   LONG desktop_width() const
   {
     LONG result{};
-    detail::api(*this).get_DesktopWidth(&result);
+    detail::call<&Api::get_DesktopWidth>(*this, "get_DesktopWidth", &result);
     return result;
   }
 
   short connection_state() const
   {
     short result{};
-    detail::api(*this).get_Connected(&result);
+    detail::call<&Api::get_Connected>(*this, "get_Connected", &result);
     return result;
   }
 
   void connect()
   {
-    const auto err = api().Connect();
+    const auto err = detail::call<&Api::Connect>(*this, "Connect");
     throw_if_error(err, "cannot initiate connection to remote RDP server");
   }
 
   void disconnect()
   {
-    const auto err = api().Disconnect();
+    const auto err = detail::call<&Api::Disconnect>(*this, "Disconnect");
     throw_if_error(err, "cannot disconnect from remote RDP server");
   }
 
   MSTSCLib::ControlReconnectStatus reconnect(const ULONG width, const ULONG height)
   {
-    return api().Reconnect(width, height);
+    return detail::call<&Api::Reconnect>(*this, "Reconnect", width, height);
   }
 
   // MsRdpClient9NotSafeForScripting
@@ -431,9 +502,10 @@ public:
     {
       try {
         // UpdateSessionDisplaySettings() throws exception if no login complete.
-        return api().UpdateSessionDisplaySettings(desktop_width,
-          desktop_height, physical_width, physical_height, orientation,
-          desktop_scale_factor, device_scale_factor);
+        return detail::call<&Api::UpdateSessionDisplaySettings>(*this,
+          "UpdateSessionDisplaySettings", desktop_width, desktop_height,
+          physical_width, physical_height, orientation, desktop_scale_factor,
+          device_scale_factor);
       } catch (...) {
         throw std::runtime_error{"cannot update RDP session display settings"};
       }
@@ -443,7 +515,8 @@ public:
 
   void sync_session_display_settings()
   {
-    const auto err = api().SyncSessionDisplaySettings();
+    const auto err = detail::call<&Api::SyncSessionDisplaySettings>(*this,
+      "SyncSessionDisplaySettings");
     throw_if_error(err, "cannot synchronize RDP session display settings");
   }
 
@@ -452,7 +525,8 @@ public:
   template<class String>
   String status_text(const UINT status_code) const
   {
-    return String(detail::api(*this).GetStatusText(status_code));
+    return String(detail::call<&Api::GetStatusText>(*this, "GetStatusText",
+      status_code));
   }
 
   // IMsRdpExtendedSettings
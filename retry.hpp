@@ -0,0 +1,244 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <thread>
+
+namespace dmitigr::wincom {
+
+// -----------------------------------------------------------------------------
+// Retry_policy
+// -----------------------------------------------------------------------------
+
+/**
+ * @returns `true` if `hresult` denotes the failure of a remote call which is
+ * likely to succeed if the call is repeated later, that is one of:
+ *   - `RPC_E_CALL_REJECTED`;
+ *   - `RPC_E_SERVERCALL_RETRYLATER`;
+ *   - `RPC_S_SERVER_UNAVAILABLE` (either as is or as `HRESULT`);
+ *   - `WBEM_E_TRANSPORT_FAILURE`.
+ */
+constexpr bool is_transient_error(const std::int32_t hresult) noexcept
+{
+  switch (static_cast<std::uint32_t>(hresult)) {
+  case 0x80010001: // RPC_E_CALL_REJECTED
+  case 0x8001010A: // RPC_E_SERVERCALL_RETRYLATER
+  case 0x800706BA: // HRESULT_FROM_WIN32(RPC_S_SERVER_UNAVAILABLE)
+  case 1722: // RPC_S_SERVER_UNAVAILABLE
+  case 0x80041015: // WBEM_E_TRANSPORT_FAILURE
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// The policy of repeating the calls failed with transient errors.
+struct Retry_policy final {
+  /// The maximum number of attempts including the first one.
+  std::size_t max_attempts{4};
+  /// The delay before the first retry.
+  std::chrono::milliseconds initial_delay{100};
+  /// The maximum delay between the attempts.
+  std::chrono::milliseconds max_delay{5000};
+  /// The factor the delay is multiplied by after each retry.
+  double multiplier{2};
+  /// The randomized fraction of the delay, in [0, 1].
+  double jitter{.5};
+  /// The maximum total duration of the attempts, or zero for no limit.
+  std::chrono::milliseconds timeout{};
+  /// The classifier of `HRESULT`s.
+  bool (*is_transient)(std::int32_t) noexcept{is_transient_error};
+};
+
+/**
+ * @returns The delay before the retry number `retry` (counting from zero).
+ *
+ * @param random The uniformly distributed random number in [0, 1) which
+ * reduces the delay by up to `policy.jitter` fraction.
+ */
+inline std::chrono::nanoseconds backoff_delay(const Retry_policy& policy,
+  const std::size_t retry, const double random = 0) noexcept
+{
+  using Ns = std::chrono::nanoseconds;
+  const auto max = static_cast<double>(Ns{policy.max_delay}.count());
+  const auto base = std::min(max,
+    static_cast<double>(Ns{policy.initial_delay}.count()) *
+    std::pow(std::max(policy.multiplier, 1.), static_cast<double>(retry)));
+  const auto jitter = std::clamp(policy.jitter, 0., 1.)
+    * std::clamp(random, 0., 1.);
+  return Ns{static_cast<Ns::rep>(base * (1 - jitter))};
+}
+
+/**
+ * @returns The delay before repeating the call which has been rejected for
+ * `elapsed`, or `std::nullopt` if the call should be cancelled.
+ *
+ * @details Used by the callers which don't count the attempts, such as the
+ * message filter. The delay grows with `elapsed` as the exponential backoff
+ * does. If `policy.timeout` is zero, the call is cancelled after the total
+ * delay of `policy.max_attempts` attempts.
+ */
+inline std::optional<std::chrono::nanoseconds>
+rejection_delay(const Retry_policy& policy,
+  const std::chrono::nanoseconds elapsed, const double random = 0) noexcept
+{
+  auto limit = std::chrono::nanoseconds{policy.timeout};
+  if (!limit.count()) {
+    for (std::size_t i{}; i + 1 < policy.max_attempts; ++i)
+      limit += backoff_delay(policy, i);
+  }
+  if (elapsed >= limit)
+    return std::nullopt;
+
+  using Ns = std::chrono::nanoseconds;
+  const auto base = std::min(
+    static_cast<double>(Ns{policy.initial_delay}.count()) +
+    static_cast<double>(elapsed.count()) *
+    (std::max(policy.multiplier, 1.) - 1),
+    static_cast<double>(Ns{policy.max_delay}.count()));
+  const auto jitter = std::clamp(policy.jitter, 0., 1.)
+    * std::clamp(random, 0., 1.);
+  return std::min(Ns{static_cast<Ns::rep>(base * (1 - jitter))},
+    limit - elapsed);
+}
+
+// -----------------------------------------------------------------------------
+// Retry_stats
+// -----------------------------------------------------------------------------
+
+/// The statistics of retries.
+struct Retry_stats final {
+  /// The number of calls made with retry policy.
+  std::uint64_t calls{};
+  /// The number of repeated attempts.
+  std::uint64_t retries{};
+  /// The number of calls failed with transient errors after all attempts.
+  std::uint64_t exhausted{};
+  /// The total delay added by retries.
+  std::chrono::nanoseconds added_latency{};
+};
+
+namespace detail {
+
+inline std::atomic_uint64_t retry_calls;
+inline std::atomic_uint64_t retry_retries;
+inline std::atomic_uint64_t retry_exhausted;
+inline std::atomic_int64_t retry_added_latency;
+
+/// @returns The random number in [0, 1) for jitter.
+inline double retry_random()
+{
+  thread_local std::minstd_rand engine{std::random_device{}()};
+  return std::uniform_real_distribution<>{}(engine);
+}
+
+/// Records the retry after `delay`.
+inline void record_retry(const std::chrono::nanoseconds delay) noexcept
+{
+  retry_retries.fetch_add(1, std::memory_order_relaxed);
+  retry_added_latency.fetch_add(delay.count(), std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+/// @returns The statistics of retries.
+inline Retry_stats retry_stats() noexcept
+{
+  return Retry_stats{
+    detail::retry_calls.load(std::memory_order_relaxed),
+    detail::retry_retries.load(std::memory_order_relaxed),
+    detail::retry_exhausted.load(std::memory_order_relaxed),
+    std::chrono::nanoseconds{
+      detail::retry_added_latency.load(std::memory_order_relaxed)}};
+}
+
+// -----------------------------------------------------------------------------
+// with_retry
+// -----------------------------------------------------------------------------
+
+/// The clock of retries.
+struct System_retry_clock final {
+  std::chrono::steady_clock::time_point now() const noexcept
+  {
+    return std::chrono::steady_clock::now();
+  }
+
+  void sleep_for(const std::chrono::nanoseconds duration) const
+  {
+    std::this_thread::sleep_for(duration);
+  }
+};
+
+/**
+ * @brief Calls `f` until it succeeds, throws an error which is not transient
+ * according to `policy`, or `policy` is exhausted.
+ *
+ * @details The attempts are delayed by `backoff_delay()`. The retry is not
+ * made if the delay would exceed `policy.timeout`.
+ *
+ * @tparam Error The type of exceptions with `code()` which returns
+ * `HRESULT`. (Other exceptions are propagated as is.)
+ * @tparam Clock The type with `now()` and
+ * `sleep_for(std::chrono::nanoseconds)`. (See `System_retry_clock`.)
+ *
+ * @returns The result of `f`.
+ *
+ * @remarks `f` must be idempotent.
+ */
+template<class Error, class F, class Clock>
+decltype(auto) basic_with_retry(const Retry_policy& policy, F&& f,
+  Clock&& clock)
+{
+  detail::retry_calls.fetch_add(1, std::memory_order_relaxed);
+  const auto start = clock.now();
+  for (std::size_t attempt{1};; ++attempt) {
+    try {
+      return f();
+    } catch (const Error& e) {
+      const auto code = static_cast<std::int32_t>(e.code());
+      if (!policy.is_transient || !policy.is_transient(code))
+        throw;
+      const bool is_exhausted = [&]
+      {
+        if (attempt >= policy.max_attempts)
+          return true;
+        else if (!policy.timeout.count())
+          return false;
+        const auto delay = backoff_delay(policy, attempt - 1);
+        return clock.now() + delay - start > policy.timeout;
+      }();
+      if (is_exhausted) {
+        detail::retry_exhausted.fetch_add(1, std::memory_order_relaxed);
+        throw;
+      }
+    }
+    const auto delay = backoff_delay(policy, attempt - 1,
+      detail::retry_random());
+    detail::record_retry(delay);
+    clock.sleep_for(delay);
+  }
+}
+
+} // namespace dmitigr::wincom
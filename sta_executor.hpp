@@ -0,0 +1,370 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "../base/noncopymove.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom {
+
+/**
+ * @brief An executor which runs the tasks on its own thread with the message
+ * pump (in particular, in a single-threaded COM apartment).
+ *
+ * @details The thread waits for both the tasks and the window messages by
+ * `Pump::wait()`, so the ActiveX controls living on the thread receive
+ * their messages while the executor is idle. The queue is drained in
+ * batches, and the pending messages are dispatched by `Pump::poll()` after
+ * every batch, so a busy queue doesn't starve the messages. The tasks
+ * posted while a batch is running are run with the next batch. If the pump
+ * throws, it's considered broken (see `pump_error()`): it's no longer used,
+ * and the thread keeps running the tasks by waiting for them only.
+ *
+ * @tparam Pump The default-constructible type which is constructed and
+ * destroyed on the executor thread (e.g. initializes the apartment) and has
+ * the following member functions:
+ *   - `void wait()`, which blocks until there are messages or `wake()` is
+ *   called (or has been called since the previous wait) and dispatches the
+ *   messages;
+ *   - `void poll()`, which dispatches the pending messages without blocking;
+ *   - `void wake() noexcept`, which may be called from any thread.
+ * (See `Sta_executor`.)
+ *
+ * @remarks The destructor must not be called on the executor thread.
+ */
+template<class Pump, class Clock = std::chrono::steady_clock>
+class Basic_sta_executor final : private Noncopymove {
+public:
+  using Duration = typename Clock::duration;
+
+  /// The statistics of the queue.
+  struct Stats final {
+    /// The number of tasks run.
+    std::size_t executed{};
+    /// The number of tasks queued by `post()` which threw.
+    std::size_t failed{};
+    /// The number of tasks queued at the moment.
+    std::size_t queued{};
+    /// The total time the run tasks spent in the queue.
+    Duration total_latency{};
+    /// The maximum time a task spent in the queue.
+    Duration max_latency{};
+
+    /// @returns The mean time a task spent in the queue.
+    Duration mean_latency() const noexcept
+    {
+      return executed ? total_latency / static_cast<
+        typename Duration::rep>(executed) : Duration{};
+    }
+  };
+
+  /// The awaitable which resumes the coroutine on the executor thread.
+  class Schedule_awaitable final {
+  public:
+    bool await_ready() const noexcept
+    {
+      return false;
+    }
+
+    void await_suspend(const std::coroutine_handle<> handle)
+    {
+      executor_->post([handle]{handle.resume();});
+    }
+
+    void await_resume() const noexcept
+    {}
+
+  private:
+    friend Basic_sta_executor;
+
+    Basic_sta_executor* executor_{};
+
+    explicit Schedule_awaitable(Basic_sta_executor& executor) noexcept
+      : executor_{&executor}
+    {}
+  };
+
+  /// Runs the queued tasks and stops the thread.
+  ~Basic_sta_executor()
+  {
+    {
+      const std::lock_guard lg{mutex_};
+      is_stopping_ = true;
+      if (pump_)
+        pump_->wake();
+    }
+    cond_.notify_one();
+    thread_.join();
+  }
+
+  /**
+   * @brief Starts the thread.
+   *
+   * @throws The exception thrown by the constructor of `Pump`.
+   */
+  Basic_sta_executor()
+  {
+    std::promise<void> started;
+    auto future = started.get_future();
+    thread_ = std::thread{&Basic_sta_executor::run, this, std::move(started)};
+    try {
+      future.get();
+    } catch (...) {
+      thread_.join();
+      throw;
+    }
+  }
+
+  /**
+   * @returns The awaitable which resumes the awaiting coroutine on the
+   * executor thread (even if it's already running on it).
+   *
+   * @par Example
+   * @code
+   * co_await executor.schedule(); // now on the STA
+   * client.connect();
+   * @endcode
+   */
+  Schedule_awaitable schedule() noexcept
+  {
+    return Schedule_awaitable{*this};
+  }
+
+  /**
+   * @brief Queues the task.
+   *
+   * @param task The callable of signature `void()`. If it throws, the
+   * exception is ignored, since there is no one to rethrow it to, and only
+   * counted in `Stats::failed`. (Use `submit()` to get the exception.)
+   */
+  template<class F>
+  void post(F&& task)
+  {
+    enqueue(Task{std::forward<F>(task)});
+  }
+
+  /**
+   * @brief Queues the task.
+   *
+   * @returns The future of the result of `task`.
+   */
+  template<class F>
+  auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>&>>
+  {
+    using R = std::invoke_result_t<std::decay_t<F>&>;
+    std::packaged_task<R()> packaged{std::forward<F>(task)};
+    auto result = packaged.get_future();
+    enqueue(Task{std::move(packaged)});
+    return result;
+  }
+
+  /// @returns `true` if called on the executor thread.
+  bool is_current() const noexcept
+  {
+    return std::this_thread::get_id() == thread_id_.load();
+  }
+
+  /// @returns The statistics of the queue.
+  Stats stats() const
+  {
+    Stats result;
+    {
+      const std::lock_guard lg{mutex_};
+      result.queued = queue_.size();
+    }
+    result.executed = executed_.load(std::memory_order_relaxed);
+    result.failed = failed_.load(std::memory_order_relaxed);
+    result.total_latency =
+      Duration{total_latency_.load(std::memory_order_relaxed)};
+    result.max_latency = Duration{max_latency_.load(std::memory_order_relaxed)};
+    return result;
+  }
+
+  /// @returns The exception thrown by the pump, or `nullptr` if none.
+  std::exception_ptr pump_error() const
+  {
+    const std::lock_guard lg{mutex_};
+    return pump_error_;
+  }
+
+private:
+  using Time_point = typename Clock::time_point;
+
+  class Task final {
+  public:
+    template<class F>
+    explicit Task(F&& f)
+      : impl_{std::make_unique<Impl<std::decay_t<F>>>(std::forward<F>(f))}
+    {}
+
+    void operator()()
+    {
+      impl_->run();
+    }
+
+  private:
+    struct Base {
+      virtual ~Base() = default;
+      virtual void run() = 0;
+    };
+
+    template<class F>
+    struct Impl final : Base {
+      explicit Impl(F&& f)
+        : f{std::move(f)}
+      {}
+
+      explicit Impl(const F& f)
+        : f{f}
+      {}
+
+      void run() override
+      {
+        f();
+      }
+
+      F f;
+    };
+
+    std::unique_ptr<Base> impl_;
+  };
+
+  struct Item final {
+    Task task;
+    Time_point queued_at;
+  };
+
+  mutable std::mutex mutex_;
+  std::condition_variable cond_; // used instead of the broken pump
+  std::vector<Item> queue_;
+  std::optional<Pump> pump_;
+  std::exception_ptr pump_error_;
+  bool is_idle_{};
+  bool is_stopping_{};
+  std::atomic<std::thread::id> thread_id_{};
+  std::atomic_size_t executed_{};
+  std::atomic_size_t failed_{};
+  std::atomic<typename Duration::rep> total_latency_{};
+  std::atomic<typename Duration::rep> max_latency_{};
+  std::thread thread_;
+
+  void enqueue(Task&& task)
+  {
+    const std::lock_guard lg{mutex_};
+    if (is_stopping_)
+      throw std::logic_error{"cannot post task to stopped STA executor"};
+    queue_.push_back(Item{std::move(task), Clock::now()});
+    if (pump_error_)
+      cond_.notify_one();
+    else if (is_idle_) {
+      is_idle_ = false;
+      pump_->wake();
+    }
+  }
+
+  void run(std::promise<void> started)
+  {
+    try {
+      const std::lock_guard lg{mutex_};
+      pump_.emplace();
+    } catch (...) {
+      started.set_exception(std::current_exception());
+      return;
+    }
+    thread_id_ = std::this_thread::get_id();
+    started.set_value();
+
+    std::vector<Item> batch;
+    bool is_pump_broken{};
+    const auto break_pump = [this, &is_pump_broken]
+    {
+      const std::lock_guard lg{mutex_};
+      pump_error_ = std::current_exception();
+      is_pump_broken = true;
+    };
+    while (true) {
+      {
+        std::unique_lock lk{mutex_};
+        if (is_pump_broken)
+          cond_.wait(lk, [this]{return !queue_.empty() || is_stopping_;});
+        if (queue_.empty()) {
+          if (is_stopping_)
+            break;
+          is_idle_ = true;
+        } else
+          batch.swap(queue_);
+      }
+
+      if (batch.empty()) {
+        try {
+          pump_->wait();
+        } catch (...) {
+          break_pump();
+        }
+        continue;
+      }
+
+      for (auto& item : batch) {
+        record(Clock::now() - item.queued_at);
+        try {
+          item.task();
+        } catch (...) {
+          failed_.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      batch.clear();
+
+      if (!is_pump_broken) {
+        try {
+          pump_->poll();
+        } catch (...) {
+          break_pump();
+        }
+      }
+    }
+
+    const std::lock_guard lg{mutex_};
+    pump_.reset();
+  }
+
+  void record(const Duration latency) noexcept
+  {
+    const auto count = latency.count();
+    executed_.fetch_add(1, std::memory_order_relaxed);
+    total_latency_.fetch_add(count, std::memory_order_relaxed);
+    auto max = max_latency_.load(std::memory_order_relaxed);
+    while (max < count && !max_latency_.compare_exchange_weak(max, count,
+        std::memory_order_relaxed));
+  }
+};
+
+} // namespace dmitigr::wincom
@@ -20,64 +20,71 @@
 
 #include "../base/noncopymove.hpp"
 #include "../winbase/combase.hpp"
+#include "enumerator.hpp"
 #include "exceptions.hpp"
+#include "library.hpp"
+#include "literal.hpp"
 #include "object.hpp"
+#include "tasc_completion.hpp"
+#include "tasc_monitor.hpp"
+#include "tasc_schedule.hpp"
+#include "tasc_snapshot.hpp"
+#include "tasc_sync.hpp"
+#include "tracing.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <optional>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <variant>
+#include <vector>
 
 #include <taskschd.h>
 
-namespace dmitigr::wincom::tasc::v2 {
+namespace dmitigr::wincom {
 
-inline const char* to_literal(const TASK_STATE value) noexcept
-{
-  switch (value) {
-  case TASK_STATE_UNKNOWN:
-    return "TASK_STATE_UNKNOWN";
-  case TASK_STATE_DISABLED:
-    return "TASK_STATE_DISABLED";
-  case TASK_STATE_QUEUED:
-    return "TASK_STATE_QUEUED";
-  case TASK_STATE_READY:
-    return "TASK_STATE_READY";
-  case TASK_STATE_RUNNING:
-    return "TASK_STATE_RUNNING";
-  }
-  return nullptr;
-}
+template<>
+inline constexpr auto literal_map<TASK_STATE> = make_literal_map<TASK_STATE>({
+  {TASK_STATE_UNKNOWN, "TASK_STATE_UNKNOWN"},
+  {TASK_STATE_DISABLED, "TASK_STATE_DISABLED"},
+  {TASK_STATE_QUEUED, "TASK_STATE_QUEUED"},
+  {TASK_STATE_READY, "TASK_STATE_READY"},
+  {TASK_STATE_RUNNING, "TASK_STATE_RUNNING"}
+});
 
-inline const char* to_literal(const TASK_TRIGGER_TYPE2 value) noexcept
-{
-  switch (value) {
-  case TASK_TRIGGER_EVENT:
-    return "TASK_TRIGGER_EVENT";
-  case TASK_TRIGGER_TIME:
-    return "TASK_TRIGGER_TIME";
-  case TASK_TRIGGER_DAILY:
-    return "TASK_TRIGGER_DAILY";
-  case TASK_TRIGGER_WEEKLY:
-    return "TASK_TRIGGER_WEEKLY";
-  case TASK_TRIGGER_MONTHLY:
-    return "TASK_TRIGGER_MONTHLY";
-  case TASK_TRIGGER_MONTHLYDOW:
-    return "TASK_TRIGGER_MONTHLYDOW";
-  case TASK_TRIGGER_IDLE:
-    return "TASK_TRIGGER_IDLE";
-  case TASK_TRIGGER_REGISTRATION:
-    return "TASK_TRIGGER_REGISTRATION";
-  case TASK_TRIGGER_BOOT:
-    return "TASK_TRIGGER_BOOT";
-  case TASK_TRIGGER_LOGON:
-    return "TASK_TRIGGER_LOGON";
-  case TASK_TRIGGER_SESSION_STATE_CHANGE:
-    return "TASK_TRIGGER_SESSION_STATE_CHANGE";
-  case TASK_TRIGGER_CUSTOM_TRIGGER_01:
-    return "TASK_TRIGGER_CUSTOM_TRIGGER_01";
-  }
-  return nullptr;
-}
+template<>
+inline constexpr auto literal_map<TASK_TRIGGER_TYPE2> =
+  make_literal_map<TASK_TRIGGER_TYPE2>({
+  {TASK_TRIGGER_EVENT, "TASK_TRIGGER_EVENT"},
+  {TASK_TRIGGER_TIME, "TASK_TRIGGER_TIME"},
+  {TASK_TRIGGER_DAILY, "TASK_TRIGGER_DAILY"},
+  {TASK_TRIGGER_WEEKLY, "TASK_TRIGGER_WEEKLY"},
+  {TASK_TRIGGER_MONTHLY, "TASK_TRIGGER_MONTHLY"},
+  {TASK_TRIGGER_MONTHLYDOW, "TASK_TRIGGER_MONTHLYDOW"},
+  {TASK_TRIGGER_IDLE, "TASK_TRIGGER_IDLE"},
+  {TASK_TRIGGER_REGISTRATION, "TASK_TRIGGER_REGISTRATION"},
+  {TASK_TRIGGER_BOOT, "TASK_TRIGGER_BOOT"},
+  {TASK_TRIGGER_LOGON, "TASK_TRIGGER_LOGON"},
+  {TASK_TRIGGER_SESSION_STATE_CHANGE, "TASK_TRIGGER_SESSION_STATE_CHANGE"},
+  {TASK_TRIGGER_CUSTOM_TRIGGER_01, "TASK_TRIGGER_CUSTOM_TRIGGER_01"}
+});
+
+} // namespace dmitigr::wincom
+
+namespace dmitigr::wincom::tasc::v2 {
+
+using wincom::from_literal;
+using wincom::to_literal;
 
 class Registration_info final :
   public Unknown_api<Registration_info, IRegistrationInfo> {
@@ -88,49 +95,50 @@ public:
   template<class String>
   String author() const
   {
-    return detail::str<String>(*this, &Api::get_Author);
+    return detail::str<String, &Api::get_Author>(*this, "get_Author");
   }
 
   template<class String>
   String date() const
   {
-    return detail::str<String>(*this, &Api::get_Date);
+    return detail::str<String, &Api::get_Date>(*this, "get_Date");
   }
 
   template<class String>
   String description() const
   {
-    return detail::str<String>(*this, &Api::get_Description);
+    return detail::str<String, &Api::get_Description>(*this, "get_Description");
   }
 
   template<class String>
   String documentation() const
   {
-    return detail::str<String>(*this, &Api::get_Documentation);
+    return detail::str<String, &Api::get_Documentation>(*this,
+      "get_Documentation");
   }
 
   template<class String>
   String source() const
   {
-    return detail::str<String>(*this, &Api::get_Source);
+    return detail::str<String, &Api::get_Source>(*this, "get_Source");
   }
 
   template<class String>
   String uri() const
   {
-    return detail::str<String>(*this, &Api::get_URI);
+    return detail::str<String, &Api::get_URI>(*this, "get_URI");
   }
 
   template<class String>
   String version() const
   {
-    return detail::str<String>(*this, &Api::get_Version);
+    return detail::str<String, &Api::get_Version>(*this, "get_Version");
   }
 
   template<class String>
   String xml_text() const
   {
-    return detail::str<String>(*this, &Api::get_XmlText);
+    return detail::str<String, &Api::get_XmlText>(*this, "get_XmlText");
   }
 };
 
@@ -143,19 +151,20 @@ public:
   template<class String>
   String duration() const
   {
-    return detail::str<String>(*this, &Api::get_Duration);
+    return detail::str<String, &Api::get_Duration>(*this, "get_Duration");
   }
 
   template<class String>
   String interval() const
   {
-    return detail::str<String>(*this, &Api::get_Interval);
+    return detail::str<String, &Api::get_Interval>(*this, "get_Interval");
   }
 
   bool is_stopped_at_the_end_of_duration() const
   {
     VARIANT_BOOL result{VARIANT_FALSE};
-    detail::api(*this).get_StopAtDurationEnd(&result);
+    detail::call<&Api::get_StopAtDurationEnd>(*this, "get_StopAtDurationEnd",
+      &result);
     return result == VARIANT_TRUE;
   }
 };
@@ -169,47 +178,126 @@ public:
   TASK_TRIGGER_TYPE2 type() const
   {
     TASK_TRIGGER_TYPE2 result{};
-    detail::api(*this).get_Type(&result);
+    detail::call<&Api::get_Type>(*this, "get_Type", &result);
     return result;
   }
 
   bool is_enabled() const
   {
     VARIANT_BOOL result{VARIANT_FALSE};
-    detail::api(*this).get_Enabled(&result);
+    detail::call<&Api::get_Enabled>(*this, "get_Enabled", &result);
     return result == VARIANT_TRUE;
   }
 
   template<class String>
   String id() const
   {
-    return detail::str<String>(*this, &Api::get_Id);
+    return detail::str<String, &Api::get_Id>(*this, "get_Id");
   }
 
   template<class String>
   String start_boundary() const
   {
-    return detail::str<String>(*this, &Api::get_StartBoundary);
+    return detail::str<String, &Api::get_StartBoundary>(*this,
+      "get_StartBoundary");
   }
 
   template<class String>
   String end_boundary() const
   {
-    return detail::str<String>(*this, &Api::get_EndBoundary);
+    return detail::str<String, &Api::get_EndBoundary>(*this, "get_EndBoundary");
   }
 
   template<class String>
   String execution_time_limit() const
   {
-    return detail::str<String>(*this, &Api::get_ExecutionTimeLimit);
+    return detail::str<String, &Api::get_ExecutionTimeLimit>(*this,
+      "get_ExecutionTimeLimit");
   }
 
   Repetition_pattern repetition_pattern() const
   {
     IRepetitionPattern* result{};
-    detail::api(*this).get_Repetition(&result);
+    detail::call<&Api::get_Repetition>(*this, "get_Repetition", &result);
     return Repetition_pattern{result};
   }
+
+  /**
+   * @returns The plain value snapshot of this trigger suitable for offline
+   * schedule expansion.
+   *
+   * @see Fire_time_generator.
+   */
+  Trigger_snapshot snapshot() const
+  {
+    Trigger_snapshot result;
+    result.type = static_cast<Trigger_type>(type());
+    result.is_enabled = is_enabled();
+    if (const auto value = start_boundary<std::wstring>(); !value.empty())
+      result.start_boundary = to_schedule_time(parse_boundary(value));
+    if (const auto value = end_boundary<std::wstring>(); !value.empty())
+      result.end_boundary = to_schedule_time(parse_boundary(value));
+
+    if (const auto rep = repetition_pattern()) {
+      result.repetition.interval = parse_duration(rep.interval<std::wstring>());
+      result.repetition.duration = parse_duration(rep.duration<std::wstring>());
+      result.repetition.is_stopped_at_the_end_of_duration =
+        rep.is_stopped_at_the_end_of_duration();
+    }
+
+    const auto random_delay = [](const auto& trigger)
+    {
+      using Api = typename std::decay_t<decltype(trigger)>::Api;
+      return parse_duration(detail::str<std::wstring, &Api::get_RandomDelay>(
+          trigger, "get_RandomDelay"));
+    };
+    auto* const api = &detail::api(*this);
+    VARIANT_BOOL flag{VARIANT_FALSE};
+    switch (result.type) {
+    case Trigger_type::time: {
+      const auto trigger = Ptr<ITimeTrigger>::query(api);
+      result.random_delay = random_delay(trigger);
+      break;
+    }
+    case Trigger_type::daily: {
+      const auto trigger = Ptr<IDailyTrigger>::query(api);
+      trigger->get_DaysInterval(&result.days_interval);
+      result.random_delay = random_delay(trigger);
+      break;
+    }
+    case Trigger_type::weekly: {
+      const auto trigger = Ptr<IWeeklyTrigger>::query(api);
+      trigger->get_DaysOfWeek(&result.days_of_week);
+      trigger->get_WeeksInterval(&result.weeks_interval);
+      result.random_delay = random_delay(trigger);
+      break;
+    }
+    case Trigger_type::monthly: {
+      const auto trigger = Ptr<IMonthlyTrigger>::query(api);
+      long days{};
+      trigger->get_DaysOfMonth(&days);
+      result.days_of_month = static_cast<std::int32_t>(days);
+      trigger->get_MonthsOfYear(&result.months_of_year);
+      trigger->get_RunOnLastDayOfMonth(&flag);
+      result.is_run_on_last_day_of_month = flag == VARIANT_TRUE;
+      result.random_delay = random_delay(trigger);
+      break;
+    }
+    case Trigger_type::monthly_dow: {
+      const auto trigger = Ptr<IMonthlyDOWTrigger>::query(api);
+      trigger->get_DaysOfWeek(&result.days_of_week);
+      trigger->get_WeeksOfMonth(&result.weeks_of_month);
+      trigger->get_MonthsOfYear(&result.months_of_year);
+      trigger->get_RunOnLastWeekOfMonth(&flag);
+      result.is_run_on_last_week_of_month = flag == VARIANT_TRUE;
+      result.random_delay = random_delay(trigger);
+      break;
+    }
+    default:
+      break;
+    }
+    return result;
+  }
 };
 
 class Trigger_collection final :
@@ -221,7 +309,7 @@ public:
   LONG count() const
   {
     LONG result{};
-    detail::api(*this).get_Count(&result);
+    detail::call<&Api::get_Count>(*this, "get_Count", &result);
     return result;
   }
 
@@ -231,9 +319,286 @@ public:
   Trigger item(const LONG index) const
   {
     ITrigger* result{};
-    detail::api(*this).get_Item(index, &result);
+    detail::call<&Api::get_Item>(*this, "get_Item", index, &result);
     return Trigger{result};
   }
+
+  /// @returns The snapshots of all the triggers of the collection.
+  std::vector<Trigger_snapshot> snapshot() const
+  {
+    std::vector<Trigger_snapshot> result;
+    const auto size = count();
+    result.reserve(size);
+    for (LONG i{1}; i <= size; ++i)
+      result.push_back(item(i).snapshot());
+    return result;
+  }
+};
+
+class Action final : public Unknown_api<Action, IAction> {
+  using Ua = Unknown_api<Action, IAction>;
+public:
+  using Ua::Ua;
+
+  TASK_ACTION_TYPE type() const
+  {
+    TASK_ACTION_TYPE result{};
+    detail::call<&Api::get_Type>(*this, "get_Type", &result);
+    return result;
+  }
+
+  template<class String>
+  String id() const
+  {
+    return detail::str<String, &Api::get_Id>(*this, "get_Id");
+  }
+};
+
+class Exec_action final : public Unknown_api<Exec_action, IExecAction> {
+  using Ua = Unknown_api<Exec_action, IExecAction>;
+public:
+  using Ua::Ua;
+
+  template<class String>
+  String path() const
+  {
+    return detail::str<String, &Api::get_Path>(*this, "get_Path");
+  }
+
+  template<class String>
+  Exec_action& set_path(const String& value)
+  {
+    const auto err = detail::call<&Api::put_Path>(*this, "put_Path",
+      detail::bstr(value));
+    throw_if_error(err, "cannot set path of exec action");
+    return *this;
+  }
+
+  template<class String>
+  String arguments() const
+  {
+    return detail::str<String, &Api::get_Arguments>(*this, "get_Arguments");
+  }
+
+  template<class String>
+  Exec_action& set_arguments(const String& value)
+  {
+    const auto err = detail::call<&Api::put_Arguments>(*this, "put_Arguments",
+      detail::bstr(value));
+    throw_if_error(err, "cannot set arguments of exec action");
+    return *this;
+  }
+
+  template<class String>
+  String working_directory() const
+  {
+    return detail::str<String, &Api::get_WorkingDirectory>(*this,
+      "get_WorkingDirectory");
+  }
+
+  template<class String>
+  Exec_action& set_working_directory(const String& value)
+  {
+    const auto err = detail::call<&Api::put_WorkingDirectory>(*this,
+      "put_WorkingDirectory", detail::bstr(value));
+    throw_if_error(err, "cannot set working directory of exec action");
+    return *this;
+  }
+};
+
+class Action_collection final :
+  public Unknown_api<Action_collection, IActionCollection> {
+  using Ua = Unknown_api<Action_collection, IActionCollection>;
+public:
+  using Ua::Ua;
+
+  LONG count() const
+  {
+    LONG result{};
+    detail::call<&Api::get_Count>(*this, "get_Count", &result);
+    return result;
+  }
+
+  /**
+   * @param index 1-based index.
+   */
+  Action item(const LONG index) const
+  {
+    IAction* result{};
+    detail::call<&Api::get_Item>(*this, "get_Item", index, &result);
+    return Action{result};
+  }
+
+  /// @returns The new action added to the collection.
+  Action create(const TASK_ACTION_TYPE type)
+  {
+    IAction* result{};
+    const auto err = detail::call<&Api::Create>(*this, "Create", type, &result);
+    throw_if_error(err, "cannot create action");
+    return Action{result};
+  }
+};
+
+class Task_settings final :
+  public Unknown_api<Task_settings, ITaskSettings> {
+  using Ua = Unknown_api<Task_settings, ITaskSettings>;
+public:
+  using Ua::Ua;
+
+  bool is_enabled() const
+  {
+    return flag<&Api::get_Enabled>("get_Enabled");
+  }
+
+  bool is_hidden() const
+  {
+    return flag<&Api::get_Hidden>("get_Hidden");
+  }
+
+  bool is_demand_start_allowed() const
+  {
+    return flag<&Api::get_AllowDemandStart>("get_AllowDemandStart");
+  }
+
+  bool is_hard_terminate_allowed() const
+  {
+    return flag<&Api::get_AllowHardTerminate>("get_AllowHardTerminate");
+  }
+
+  bool is_start_when_available() const
+  {
+    return flag<&Api::get_StartWhenAvailable>("get_StartWhenAvailable");
+  }
+
+  bool is_run_only_if_network_available() const
+  {
+    return flag<&Api::get_RunOnlyIfNetworkAvailable>(
+      "get_RunOnlyIfNetworkAvailable");
+  }
+
+  bool is_run_only_if_idle() const
+  {
+    return flag<&Api::get_RunOnlyIfIdle>("get_RunOnlyIfIdle");
+  }
+
+  bool is_wake_to_run() const
+  {
+    return flag<&Api::get_WakeToRun>("get_WakeToRun");
+  }
+
+  bool is_start_disallowed_on_batteries() const
+  {
+    return flag<&Api::get_DisallowStartIfOnBatteries>(
+      "get_DisallowStartIfOnBatteries");
+  }
+
+  bool is_stop_if_going_on_batteries() const
+  {
+    return flag<&Api::get_StopIfGoingOnBatteries>("get_StopIfGoingOnBatteries");
+  }
+
+  int priority() const
+  {
+    int result{};
+    detail::call<&Api::get_Priority>(*this, "get_Priority", &result);
+    return result;
+  }
+
+  int restart_count() const
+  {
+    int result{};
+    detail::call<&Api::get_RestartCount>(*this, "get_RestartCount", &result);
+    return result;
+  }
+
+  template<class String>
+  String restart_interval() const
+  {
+    return detail::str<String, &Api::get_RestartInterval>(*this,
+      "get_RestartInterval");
+  }
+
+  template<class String>
+  String execution_time_limit() const
+  {
+    return detail::str<String, &Api::get_ExecutionTimeLimit>(*this,
+      "get_ExecutionTimeLimit");
+  }
+
+  template<class String>
+  String delete_expired_task_after() const
+  {
+    return detail::str<String, &Api::get_DeleteExpiredTaskAfter>(*this,
+      "get_DeleteExpiredTaskAfter");
+  }
+
+  TASK_INSTANCES_POLICY multiple_instances() const
+  {
+    TASK_INSTANCES_POLICY result{};
+    detail::call<&Api::get_MultipleInstances>(*this, "get_MultipleInstances",
+      &result);
+    return result;
+  }
+
+  TASK_COMPATIBILITY compatibility() const
+  {
+    TASK_COMPATIBILITY result{};
+    detail::call<&Api::get_Compatibility>(*this, "get_Compatibility", &result);
+    return result;
+  }
+
+private:
+  template<auto Getter>
+  bool flag(const char* const name) const
+  {
+    VARIANT_BOOL result{VARIANT_FALSE};
+    detail::call<Getter>(*this, name, &result);
+    return result == VARIANT_TRUE;
+  }
+};
+
+class Principal final : public Unknown_api<Principal, IPrincipal> {
+  using Ua = Unknown_api<Principal, IPrincipal>;
+public:
+  using Ua::Ua;
+
+  template<class String>
+  String id() const
+  {
+    return detail::str<String, &Api::get_Id>(*this, "get_Id");
+  }
+
+  template<class String>
+  String display_name() const
+  {
+    return detail::str<String, &Api::get_DisplayName>(*this, "get_DisplayName");
+  }
+
+  template<class String>
+  String user_id() const
+  {
+    return detail::str<String, &Api::get_UserId>(*this, "get_UserId");
+  }
+
+  template<class String>
+  String group_id() const
+  {
+    return detail::str<String, &Api::get_GroupId>(*this, "get_GroupId");
+  }
+
+  TASK_LOGON_TYPE logon_type() const
+  {
+    TASK_LOGON_TYPE result{};
+    detail::call<&Api::get_LogonType>(*this, "get_LogonType", &result);
+    return result;
+  }
+
+  TASK_RUNLEVEL_TYPE run_level() const
+  {
+    TASK_RUNLEVEL_TYPE result{};
+    detail::call<&Api::get_RunLevel>(*this, "get_RunLevel", &result);
+    return result;
+  }
 };
 
 class Task_definition final :
@@ -245,16 +610,271 @@ public:
   Trigger_collection triggers() const
   {
     ITriggerCollection* result{};
-    detail::api(*this).get_Triggers(&result);
+    detail::call<&Api::get_Triggers>(*this, "get_Triggers", &result);
     return Trigger_collection{result};
   }
 
   Registration_info registration_info() const
   {
     IRegistrationInfo* result{};
-    detail::api(*this).get_RegistrationInfo(&result);
+    detail::call<&Api::get_RegistrationInfo>(*this, "get_RegistrationInfo",
+      &result);
     return Registration_info{result};
   }
+
+  template<class String>
+  String xml_text() const
+  {
+    return detail::str<String, &Api::get_XmlText>(*this, "get_XmlText");
+  }
+
+  template<class String>
+  void set_xml_text(const String& value)
+  {
+    const auto err = detail::call<&Api::put_XmlText>(*this, "put_XmlText",
+      detail::bstr(value));
+    throw_if_error(err, "cannot set XML text of task definition");
+  }
+
+  Action_collection actions() const
+  {
+    IActionCollection* result{};
+    detail::call<&Api::get_Actions>(*this, "get_Actions", &result);
+    return Action_collection{result};
+  }
+
+  Task_settings settings() const
+  {
+    ITaskSettings* result{};
+    detail::call<&Api::get_Settings>(*this, "get_Settings", &result);
+    return Task_settings{result};
+  }
+
+  Principal principal() const
+  {
+    IPrincipal* result{};
+    detail::call<&Api::get_Principal>(*this, "get_Principal", &result);
+    return Principal{result};
+  }
+
+  /**
+   * @returns The plain value snapshot of this definition. Each sub-object
+   * is read exactly once.
+   */
+  Task_definition_snapshot snapshot() const
+  {
+    Task_definition_snapshot result;
+    const auto text = [&result](const std::wstring& value)
+    {
+      return result.intern(value);
+    };
+
+    if (const auto reg = registration_info()) {
+      auto& r = result.registration;
+      r.author = text(reg.author<std::wstring>());
+      r.date = text(reg.date<std::wstring>());
+      r.description = text(reg.description<std::wstring>());
+      r.documentation = text(reg.documentation<std::wstring>());
+      r.source = text(reg.source<std::wstring>());
+      r.uri = text(reg.uri<std::wstring>());
+      r.version = text(reg.version<std::wstring>());
+    }
+
+    if (const auto prn = principal()) {
+      auto& p = result.principal;
+      p.id = text(prn.id<std::wstring>());
+      p.display_name = text(prn.display_name<std::wstring>());
+      p.user_id = text(prn.user_id<std::wstring>());
+      p.group_id = text(prn.group_id<std::wstring>());
+      p.logon_type = static_cast<Logon_type>(prn.logon_type());
+      p.run_level = static_cast<Run_level>(prn.run_level());
+    }
+
+    if (const auto set = settings()) {
+      auto& s = result.settings;
+      s.is_enabled = set.is_enabled();
+      s.is_hidden = set.is_hidden();
+      s.is_demand_start_allowed = set.is_demand_start_allowed();
+      s.is_hard_terminate_allowed = set.is_hard_terminate_allowed();
+      s.is_start_when_available = set.is_start_when_available();
+      s.is_run_only_if_network_available = set.is_run_only_if_network_available();
+      s.is_run_only_if_idle = set.is_run_only_if_idle();
+      s.is_wake_to_run = set.is_wake_to_run();
+      s.is_start_disallowed_on_batteries = set.is_start_disallowed_on_batteries();
+      s.is_stop_if_going_on_batteries = set.is_stop_if_going_on_batteries();
+      s.priority = set.priority();
+      s.restart_count = set.restart_count();
+      s.restart_interval = parse_duration(set.restart_interval<std::wstring>());
+      s.execution_time_limit =
+        parse_duration(set.execution_time_limit<std::wstring>());
+      s.delete_expired_task_after =
+        parse_duration(set.delete_expired_task_after<std::wstring>());
+      s.multiple_instances =
+        static_cast<Instances_policy>(set.multiple_instances());
+      s.compatibility = static_cast<Compatibility>(set.compatibility());
+    }
+
+    if (const auto acts = actions()) {
+      const auto count = acts.count();
+      result.actions.reserve(static_cast<std::size_t>(std::max<LONG>(count, 0)));
+      for (LONG i{1}; i <= count; ++i) {
+        const auto act = acts.item(i);
+        auto& a = result.actions.emplace_back();
+        a.type = static_cast<Action_type>(act.type());
+        a.id = text(act.id<std::wstring>());
+        if (a.type == Action_type::exec) {
+          const auto exec = Exec_action::query(&detail::api(act));
+          a.path = text(exec.path<std::wstring>());
+          a.arguments = text(exec.arguments<std::wstring>());
+          a.working_directory = text(exec.working_directory<std::wstring>());
+        } else if (a.type == Action_type::com_handler) {
+          const auto handler = Ptr<IComHandlerAction>::query(&detail::api(act));
+          a.class_id = text(detail::str<std::wstring,
+            &IComHandlerAction::get_ClassId>(handler, "get_ClassId"));
+          a.data = text(detail::str<std::wstring,
+            &IComHandlerAction::get_Data>(handler, "get_Data"));
+        }
+      }
+    }
+
+    if (const auto trgs = triggers())
+      result.triggers = trgs.snapshot();
+
+    return result;
+  }
+};
+
+class Running_task final :
+  public Unknown_api<Running_task, IRunningTask> {
+  using Ua = Unknown_api<Running_task, IRunningTask>;
+public:
+  using Ua::Ua;
+
+  template<class String>
+  String name() const
+  {
+    return detail::str<String, &Api::get_Name>(*this, "get_Name");
+  }
+
+  template<class String>
+  String instance_guid() const
+  {
+    return detail::str<String, &Api::get_InstanceGuid>(*this,
+      "get_InstanceGuid");
+  }
+
+  template<class String>
+  String path() const
+  {
+    return detail::str<String, &Api::get_Path>(*this, "get_Path");
+  }
+
+  TASK_STATE state() const
+  {
+    TASK_STATE result{};
+    detail::call<&Api::get_State>(*this, "get_State", &result);
+    return result;
+  }
+
+  template<class String>
+  String current_action() const
+  {
+    return detail::str<String, &Api::get_CurrentAction>(*this,
+      "get_CurrentAction");
+  }
+
+  DWORD engine_pid() const
+  {
+    DWORD result{};
+    detail::call<&Api::get_EnginePID>(*this, "get_EnginePID", &result);
+    return result;
+  }
+
+  void stop()
+  {
+    const auto err = detail::call<&Api::Stop>(*this, "Stop");
+    throw_if_error(err, "cannot stop running task");
+  }
+
+  void refresh()
+  {
+    const auto err = detail::call<&Api::Refresh>(*this, "Refresh");
+    throw_if_error(err, "cannot refresh running task");
+  }
+
+  /// @returns The plain value snapshot of this instance.
+  Running_task_sample sample() const
+  {
+    return Running_task_sample{instance_guid<std::wstring>(),
+      path<std::wstring>(),
+      static_cast<Task_state>(state()),
+      static_cast<std::uint32_t>(engine_pid())};
+  }
+};
+
+class Running_task_collection final :
+  public Unknown_api<Running_task_collection, IRunningTaskCollection> {
+  using Ua = Unknown_api<Running_task_collection, IRunningTaskCollection>;
+public:
+  using Ua::Ua;
+
+  LONG count() const
+  {
+    LONG result{};
+    detail::call<&Api::get_Count>(*this, "get_Count", &result);
+    return result;
+  }
+
+  /**
+   * @param index 1-based index.
+   */
+  Running_task item(const LONG index) const
+  {
+    IRunningTask* result{};
+    detail::call<&Api::get_Item>(*this, "get_Item", _variant_t(index), &result);
+    return Running_task{result};
+  }
+
+  Enumerator enumerator() const
+  {
+    IUnknown* result{};
+    const auto err = detail::call<&Api::get__NewEnum>(*this, "get__NewEnum",
+      &result);
+    throw_if_error(err, "cannot get enumerator of running tasks");
+    const Ptr<IUnknown> guard{result};
+    return Enumerator{result};
+  }
+
+  /**
+   * @returns The samples of all the instances of the collection.
+   *
+   * @param batch_size The number of instances fetched per
+   * `IEnumVARIANT::Next()` call.
+   */
+  std::vector<Running_task_sample> samples(const ULONG batch_size = 64) const
+  {
+    auto enumer = enumerator();
+    std::vector<Running_task_sample> result;
+    result.reserve(static_cast<std::size_t>(std::max<LONG>(count(), 0)));
+    Variant_batch batch{std::max<ULONG>(batch_size, 1)};
+
+    HRESULT err{S_OK};
+    while (err == S_OK) {
+      const auto slots = batch.prepare();
+      ULONG fetched{};
+      err = detail::call<&IEnumVARIANT::Next>(enumer, "Next",
+        static_cast<ULONG>(slots.size()), slots.data(), &fetched);
+      if (FAILED(err))
+        throw Win_error{"cannot enumerate running tasks", err};
+
+      batch.commit(fetched);
+      for (std::size_t i{}; i < batch.size(); ++i) {
+        if (const auto disp = batch.get<IDispatch*>(i); disp && *disp)
+          result.push_back(Running_task::query(*disp).sample());
+      }
+    }
+    return result;
+  }
 };
 
 class Registered_task final :
@@ -266,42 +886,123 @@ public:
   template<class String>
   String name() const
   {
-    return detail::str<String>(*this, &Api::get_Name);
+    return detail::str<String, &Api::get_Name>(*this, "get_Name");
   }
 
   template<class String>
   String path() const
   {
-    return detail::str<String>(*this, &Api::get_Path);
+    return detail::str<String, &Api::get_Path>(*this, "get_Path");
   }
 
   TASK_STATE state() const
   {
     TASK_STATE result{};
-    detail::api(*this).get_State(&result);
+    detail::call<&Api::get_State>(*this, "get_State", &result);
     return result;
   }
 
   DATE last_run_time() const
   {
     DATE result{};
-    detail::api(*this).get_LastRunTime(&result);
+    detail::call<&Api::get_LastRunTime>(*this, "get_LastRunTime", &result);
     return result;
   }
 
   DATE next_run_time() const
   {
     DATE result{};
-    detail::api(*this).get_NextRunTime(&result);
+    detail::call<&Api::get_NextRunTime>(*this, "get_NextRunTime", &result);
     return result;
   }
 
   Task_definition task_definition() const
   {
     ITaskDefinition* result{};
-    detail::api(*this).get_Definition(&result);
+    detail::call<&Api::get_Definition>(*this, "get_Definition", &result);
     return Task_definition{result};
   }
+
+  template<class String>
+  String xml() const
+  {
+    return detail::str<String, &Api::get_Xml>(*this, "get_Xml");
+  }
+
+  /**
+   * @brief Runs this task immediately.
+   *
+   * @param params The values of `$(Arg0)`...`$(Arg32)` variables of the
+   * actions: either a string or a `SAFEARRAY` of strings, or empty.
+   *
+   * @returns The started instance.
+   */
+  Running_task run(const winbase::com::Const_variant& params = {})
+  {
+    IRunningTask* result{};
+    const auto err = detail::call<&Api::Run>(*this, "Run", params.data(),
+      &result);
+    throw_if_error(err, "cannot run registered task");
+    return Running_task{result};
+  }
+
+  /**
+   * @overload
+   *
+   * @param flags A combination of TASK_RUN_FLAGS.
+   * @param session_id The terminal server session in which to run the task.
+   * @param user The user for which the task runs.
+   */
+  template<class String>
+  Running_task run(const winbase::com::Const_variant& params,
+    const LONG flags, const LONG session_id, const String& user)
+  {
+    IRunningTask* result{};
+    const auto err = detail::call<&Api::RunEx>(*this, "RunEx", params.data(),
+      flags, session_id, detail::bstr(user), &result);
+    throw_if_error(err, "cannot run registered task");
+    return Running_task{result};
+  }
+
+  /**
+   * @brief Runs this task immediately and awaits its completion by using
+   * the shared `poller`.
+   *
+   * @returns The future which is ready when the started instance is no
+   * longer running.
+   *
+   * @see Completion_poller, Task_service_sampler.
+   */
+  template<class Sampler, class Clock>
+  auto run(Completion_poller<Sampler, Clock>& poller,
+    const winbase::com::Const_variant& params = {})
+  {
+    return poller.wait(run(params).template instance_guid<std::wstring>());
+  }
+
+  /// @returns The currently running instances of this task.
+  Running_task_collection instances() const
+  {
+    IRunningTaskCollection* result{};
+    const auto err = detail::call<&Api::GetInstances>(*this, "GetInstances", 0,
+      &result);
+    throw_if_error(err, "cannot get running instances of registered task");
+    return Running_task_collection{result};
+  }
+
+  /**
+   * @returns The signature of this task for change detection.
+   *
+   * @see Inventory_sync.
+   */
+  Task_signature signature() const
+  {
+    const auto xml_text = xml<std::wstring>();
+    return Task_signature{path<std::wstring>(),
+      static_cast<Task_state>(state()),
+      last_run_time(),
+      xml_hash(std::wstring_view{xml_text})};
+  }
 };
 
 class Registered_task_collection final :
@@ -313,7 +1014,7 @@ public:
   LONG count() const
   {
     LONG result{};
-    detail::api(*this).get_Count(&result);
+    detail::call<&Api::get_Count>(*this, "get_Count", &result);
     return result;
   }
 
@@ -323,9 +1024,34 @@ public:
   Registered_task item(const LONG index) const
   {
     IRegisteredTask* result{};
-    detail::api(*this).get_Item(_variant_t(index), &result);
+    detail::call<&Api::get_Item>(*this, "get_Item", _variant_t(index), &result);
     return Registered_task{result};
   }
+
+  /// @see Enumerator_range.
+  Enumerator enumerator() const
+  {
+    IUnknown* result{};
+    const auto err = detail::call<&Api::get__NewEnum>(*this, "get__NewEnum",
+      &result);
+    throw_if_error(err, "cannot get enumerator of registered tasks");
+    const Ptr<IUnknown> guard{result};
+    return Enumerator{result};
+  }
+};
+
+/// A specification of a task to register.
+struct Task_registration final {
+  /// Path to the task relative to the folder which registers it.
+  std::wstring path;
+  /// The definition or its XML representation.
+  std::variant<Task_definition, std::wstring> definition;
+  /// A combination of TASK_CREATION flags.
+  LONG flags{TASK_CREATE_OR_UPDATE};
+  TASK_LOGON_TYPE logon_type{TASK_LOGON_INTERACTIVE_TOKEN};
+  std::wstring user;
+  std::wstring password;
+  std::wstring sddl;
 };
 
 class Task_folder;
@@ -339,7 +1065,7 @@ public:
   LONG count() const
   {
     LONG result{};
-    detail::api(*this).get_Count(&result);
+    detail::call<&Api::get_Count>(*this, "get_Count", &result);
     return result;
   }
 
@@ -358,7 +1084,8 @@ public:
   Task_folder_collection folders() const
   {
     ITaskFolderCollection* result{};
-    const auto err = detail::api(*this).GetFolders(0, &result);
+    const auto err = detail::call<&Api::GetFolders>(*this, "GetFolders", 0,
+      &result);
     throw_if_error(err, "cannot get all the subfolders in the folder of"
       " registered tasks");
     return Task_folder_collection{result};
@@ -373,16 +1100,279 @@ public:
   Registered_task_collection tasks(const LONG flags) const
   {
     IRegisteredTaskCollection* result{};
-    const auto err = detail::api(*this).GetTasks(flags, &result);
+    const auto err = detail::call<&Api::GetTasks>(*this, "GetTasks", flags,
+      &result);
     throw_if_error(err, "cannot get all the tasks in the folder");
     return Registered_task_collection{result};
   }
+
+  /// @param path Path to the folder relative to this folder.
+  template<class String>
+  Task_folder folder(const String& path) const
+  {
+    ITaskFolder* result{};
+    const auto err = detail::call<&Api::GetFolder>(*this, "GetFolder",
+      detail::bstr(path), &result);
+    throw_if_error(err, "cannot get folder of registered tasks");
+    return Task_folder{result};
+  }
+
+  /**
+   * @returns The created folder, or the existing one.
+   *
+   * @param path Path to the folder relative to this folder.
+   */
+  template<class String>
+  Task_folder create_folder(const String& path,
+    const winbase::com::Const_variant& sddl = {})
+  {
+    ITaskFolder* result{};
+    const auto err = detail::call<&Api::CreateFolder>(*this, "CreateFolder",
+      detail::bstr(path), sddl.data(), &result);
+    if (err == HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS))
+      return folder(path);
+    throw_if_error(err, "cannot create folder of registered tasks");
+    return Task_folder{result};
+  }
+
+  /// Registers (or updates) the task in this folder.
+  Registered_task register_task(const Task_registration& spec)
+  {
+    const auto xml = to_xml(spec);
+    IRegisteredTask* result{};
+    const auto err = register_task(*this, spec, xml, &result);
+    throw_if_error(err, "cannot register task");
+    return Registered_task{result};
+  }
+
+  /**
+   * @brief Registers (or updates) the tasks in this folder.
+   *
+   * @details All the specifications are validated first. Then the missing
+   * folders are created (once per folder). Finally, the tasks are registered
+   * by up to `concurrency` worker threads each of which initializes COM for
+   * the multithreaded apartment and uses its own marshaled proxy of this
+   * folder. Task definitions are converted to XML on the calling thread, so
+   * no proxies of definitions are shared with the workers.
+   *
+   * @returns The result of registration of each task, that is `S_OK` on
+   * success, `E_INVALIDARG` if the specification is invalid, `E_ABORT` if
+   * the task was not attempted to register (e.g. a worker failed to
+   * initialize) or the error code returned by Task Scheduler.
+   */
+  std::vector<HRESULT> register_tasks(const std::span<const Task_registration> specs,
+    std::size_t concurrency = 1)
+  {
+    std::vector<HRESULT> result(specs.size(), E_ABORT);
+    if (specs.empty())
+      return result;
+
+    // Validate and serialize.
+    std::vector<std::wstring> xmls(specs.size());
+    for (std::size_t i{}; i < specs.size(); ++i) {
+      try {
+        xmls[i] = to_xml(specs[i]);
+      } catch (const Win_error& e) {
+        result[i] = e.code();
+      } catch (const std::invalid_argument&) {
+        result[i] = E_INVALIDARG;
+      }
+    }
+
+    // Create the missing folders.
+    std::map<std::wstring_view, HRESULT> dirs;
+    for (std::size_t i{}; i < specs.size(); ++i) {
+      if (result[i] != E_ABORT)
+        continue;
+
+      const std::wstring_view path{specs[i].path};
+      for (auto pos = path.find(L'\\', 1); pos != std::wstring_view::npos;
+           pos = path.find(L'\\', pos + 1)) {
+        const auto [dir, is_new] = dirs.try_emplace(path.substr(0, pos), S_OK);
+        if (is_new) {
+          try {
+            create_folder(std::wstring{dir->first});
+          } catch (const Win_error& e) {
+            dir->second = e.code();
+          }
+        }
+        if (dir->second != S_OK) {
+          result[i] = dir->second;
+          break;
+        }
+      }
+    }
+
+    // Register.
+    std::atomic_size_t next{};
+    const auto register_pending = [&](Task_folder& folder)
+    {
+      for (auto i = next++; i < specs.size(); i = next++) {
+        if (result[i] == E_ABORT) {
+          IRegisteredTask* task{};
+          result[i] = register_task(folder, specs[i], xmls[i], &task);
+          if (task)
+            task->Release();
+        }
+      }
+    };
+
+    concurrency = std::clamp<std::size_t>(concurrency, 1, specs.size());
+    if (concurrency == 1) {
+      register_pending(*this);
+      return result;
+    }
+
+    // The stream holds a reference to the marshaled folder until unmarshaled.
+    const auto release_stream = [](IStream* const stream) noexcept
+    {
+      CoReleaseMarshalData(stream);
+      stream->Release();
+    };
+
+    std::vector<IStream*> streams(concurrency);
+    for (std::size_t i{}; i < streams.size(); ++i) {
+      const auto err = CoMarshalInterThreadInterfaceInStream(
+        __uuidof(ITaskFolder), &api(), &streams[i]);
+      if (err != S_OK) {
+        for (std::size_t j{}; j < i; ++j)
+          release_stream(streams[j]);
+        throw Win_error{"cannot marshal folder of registered tasks", err};
+      }
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(concurrency);
+    for (std::size_t i{}; i < streams.size(); ++i) {
+      auto* const stream = streams[i];
+      try {
+        workers.emplace_back([&register_pending, release_stream, stream]
+        {
+          bool is_stream_released{};
+          try {
+            const Library library{COINIT_MULTITHREADED};
+            ITaskFolder* api{};
+            is_stream_released = true; // even on failure
+            if (CoGetInterfaceAndReleaseStream(stream, __uuidof(ITaskFolder),
+                reinterpret_cast<void**>(&api)) == S_OK) {
+              Task_folder folder{api};
+              register_pending(folder);
+            }
+          } catch (...) {
+            if (!is_stream_released)
+              release_stream(stream);
+          }
+        });
+      } catch (...) {
+        // Proceed with the workers started so far.
+        for (auto j = i; j < streams.size(); ++j)
+          release_stream(streams[j]);
+        break;
+      }
+    }
+    if (workers.empty())
+      register_pending(*this);
+    for (auto& worker : workers)
+      worker.join();
+
+    return result;
+  }
+
+  /// @param path Path to the task relative to this folder.
+  template<class String>
+  Registered_task task(const String& path) const
+  {
+    IRegisteredTask* result{};
+    const auto err = detail::call<&Api::GetTask>(*this, "GetTask",
+      detail::bstr(path), &result);
+    throw_if_error(err, "cannot get registered task from the folder");
+    return Registered_task{result};
+  }
+
+  /**
+   * @returns The signatures of the tasks of this folder, and of the tasks of
+   * all the subfolders if `is_recursive`.
+   *
+   * @param flags See tasks().
+   *
+   * @see Inventory_sync.
+   */
+  std::vector<Task_signature> signatures(const LONG flags,
+    const bool is_recursive = true) const
+  {
+    std::vector<Task_signature> result;
+    collect_signatures(result, flags, is_recursive);
+    return result;
+  }
+
+private:
+  /**
+   * @returns XML representation of the task specified by `spec`.
+   *
+   * @throws `std::invalid_argument` if `spec` is invalid.
+   */
+  static std::wstring to_xml(const Task_registration& spec)
+  {
+    const std::wstring_view path{spec.path};
+    const auto name = path.substr(path.find_last_of(L'\\') + 1);
+    if (name.empty() || path.find(L"\\\\") != std::wstring_view::npos
+      || path.find_first_of(L"<>:\"/|?*") != std::wstring_view::npos)
+      throw std::invalid_argument{"invalid path of task to register"};
+
+    std::wstring result;
+    if (const auto* const definition = std::get_if<Task_definition>(&spec.definition)) {
+      if (!*definition)
+        throw std::invalid_argument{"invalid definition of task to register"};
+      result = definition->xml_text<std::wstring>();
+    } else
+      result = std::get<std::wstring>(spec.definition);
+
+    const auto pos = result.find_first_not_of(L" \t\r\n\uFEFF");
+    if (pos == std::wstring::npos || result[pos] != L'<')
+      throw std::invalid_argument{"invalid XML of task to register"};
+    return result;
+  }
+
+  static HRESULT register_task(const Task_folder& folder,
+    const Task_registration& spec, const std::wstring& xml,
+    IRegisteredTask** const result)
+  {
+    const auto variant = [](const std::wstring& value)
+    {
+      return value.empty() ? _variant_t{} : _variant_t{value.c_str()};
+    };
+    return detail::call<&Api::RegisterTask>(folder, "RegisterTask",
+      _bstr_t{spec.path.c_str()},
+      _bstr_t{xml.c_str()},
+      spec.flags,
+      variant(spec.user),
+      variant(spec.password),
+      spec.logon_type,
+      variant(spec.sddl),
+      result);
+  }
+
+  void collect_signatures(std::vector<Task_signature>& result,
+    const LONG flags, const bool is_recursive) const
+  {
+    const auto tsks = tasks(flags);
+    const auto tsk_count = tsks.count();
+    for (LONG i{1}; i <= tsk_count; ++i)
+      result.push_back(tsks.item(i).signature());
+
+    if (is_recursive) {
+      const auto dirs = folders();
+      const auto dir_count = dirs.count();
+      for (LONG i{1}; i <= dir_count; ++i)
+        dirs.item(i).collect_signatures(result, flags, is_recursive);
+    }
+  }
 };
 
 Task_folder Task_folder_collection::item(const LONG index) const
 {
   ITaskFolder* result{};
-  detail::api(*this).get_Item(_variant_t(index), &result);
+  detail::call<&Api::get_Item>(*this, "get_Item", _variant_t(index), &result);
   return Task_folder{result};
 }
 
@@ -396,20 +1386,34 @@ public:
     const winbase::com::Const_variant& domain = {},
     const winbase::com::Const_variant& password = {})
   {
-    const auto err = api().Connect(
-      server_name.data(),
-      user.data(),
-      domain.data(),
-      password.data());
-    throw_if_error(err, "cannot connect to remote computer and associate all"
-      " subsequent calls on "+std::string{"ITaskService"}
-      +" interface with a local (remote) session");
+    const auto host = [&server_name]
+    {
+      const auto& name = server_name.data();
+      return std::wstring_view{name.vt == VT_BSTR && name.bstrVal ?
+        name.bstrVal : L""};
+    };
+    Trace_scope trace{"tasc::Task_service", "connect", host};
+    detail::with_configured_circuit_breaker(host(), [&]
+    {
+      detail::with_configured_retry([&]
+      {
+        const auto err = detail::call<&Api::Connect>(*this, "Connect",
+          server_name.data(),
+          user.data(),
+          domain.data(),
+          password.data());
+        trace.set_result(err);
+        throw_if_error(err, "cannot connect to remote computer and associate"
+          " all subsequent calls on "+std::string{"ITaskService"}
+          +" interface with a local (remote) session");
+      });
+    });
   }
 
   bool is_connected() const
   {
     VARIANT_BOOL result{VARIANT_FALSE};
-    detail::api(*this).get_Connected(&result);
+    detail::call<&Api::get_Connected>(*this, "get_Connected", &result);
     return result == VARIANT_TRUE;
   }
 
@@ -417,10 +1421,87 @@ public:
   Task_folder folder(const String& path) const
   {
     ITaskFolder* result{};
-    const auto err = detail::api(*this).GetFolder(_bstr_t(path.c_str()), &result);
+    const auto err = detail::call<&Api::GetFolder>(*this, "GetFolder",
+      _bstr_t(path.c_str()), &result);
     throw_if_error(err, "cannot get folder of registered tasks");
     return Task_folder{result};
   }
+
+  /**
+   * @returns The running tasks.
+   *
+   * @param flags Value of `TASK_ENUM_HIDDEN` should be used to retrieve all
+   * running tasks including hidden tasks. Value of `0` should be used to
+   * retrieve all the running tasks excluding the hidden tasks.
+   *
+   * @see Running_task_monitor.
+   */
+  Running_task_collection running_tasks(const LONG flags) const
+  {
+    IRunningTaskCollection* result{};
+    const auto err = detail::call<&Api::GetRunningTasks>(*this,
+      "GetRunningTasks", flags, &result);
+    throw_if_error(err, "cannot get running tasks");
+    return Running_task_collection{result};
+  }
+
+  /// @returns The new empty task definition to be registered.
+  Task_definition new_task() const
+  {
+    ITaskDefinition* result{};
+    const auto err = detail::call<&Api::NewTask>(*this, "NewTask", 0, &result);
+    throw_if_error(err, "cannot create new task definition");
+    return Task_definition{result};
+  }
+};
+
+/**
+ * @brief The sampler of running task instances for `Completion_poller`.
+ *
+ * @details Initializes COM and connects to Task Scheduler lazily, so that
+ * everything is done on the poller thread. The COM library is uninitialized
+ * when the sampler is destroyed (on the poller thread too).
+ */
+class Task_service_sampler final {
+public:
+  /**
+   * @param connect The function which returns the connected service.
+   * @param flags See `Task_service::running_tasks()`.
+   */
+  explicit Task_service_sampler(std::function<Task_service()> connect = {},
+    const LONG flags = TASK_ENUM_HIDDEN)
+    : connect_{std::move(connect)}
+    , flags_{flags}
+  {}
+
+  /// @remarks The service is reconnected on the next call after a failure.
+  std::vector<std::wstring> operator()()
+  {
+    try {
+      if (!service_) {
+        if (!library_)
+          library_.emplace(COINIT_MULTITHREADED);
+        if (connect_)
+          service_.emplace(connect_());
+        else
+          service_.emplace().connect();
+      }
+
+      std::vector<std::wstring> result;
+      for (auto& sample : service_->running_tasks(flags_).samples())
+        result.push_back(std::move(sample.instance_guid));
+      return result;
+    } catch (...) {
+      service_.reset();
+      throw;
+    }
+  }
+
+private:
+  std::function<Task_service()> connect_;
+  LONG flags_{};
+  std::optional<Library> library_;
+  std::optional<Task_service> service_;
 };
 
 } // namespace dmitigr::wincom::tasc::v2
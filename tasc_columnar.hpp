@@ -0,0 +1,855 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "../base/noncopymove.hpp"
+#include "date.hpp"
+#include "tasc_schedule.hpp"
+#include "tasc_snapshot.hpp"
+#include "tasc_sync.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * The columnar format of task inventories.
+ *
+ * All integers are little-endian. The layout is:
+ *
+ *   header    := magic("WTCI") u16(version) u16(column_count) u32(row_count)
+ *                u32(action_count) u32(trigger_count)
+ *   directory := column_count * (u64(offset) u64(size))
+ *   columns   := the column data referenced by the directory
+ *
+ * The columns are stored in the order of `Inventory_column`. The kinds of
+ * columns are:
+ *
+ *   - strings: u32(count) (count + 1)*u32(offset) UTF-8 data. This is the
+ *     dictionary shared by all the string columns. The string 0 is empty;
+ *   - ids: the varint (LEB128) indexes of the dictionary strings;
+ *   - counts: the varint numbers of actions or triggers per task;
+ *   - bits: u8(width) followed by the values packed into `width` bits each,
+ *     padded with a zero byte;
+ *   - deltas: the varint zigzag-encoded differences between consecutive values.
+ */
+
+namespace dmitigr::wincom::tasc::v2 {
+
+/// The columns of the inventory.
+enum class Inventory_column : std::uint16_t {
+  strings,
+  path,
+  state,
+  last_run_time,
+  author,
+  uri,
+  user_id,
+  logon_type,
+  run_level,
+  task_flags,
+  action_count,
+  action_type,
+  action_path,
+  action_arguments,
+  action_working_directory,
+  trigger_count,
+  trigger_type,
+  trigger_has_start,
+  trigger_start,
+  trigger_repetition_interval
+};
+
+namespace detail::columnar {
+
+inline constexpr std::array<std::uint8_t, 4> magic{'W', 'T', 'C', 'I'};
+inline constexpr std::uint16_t version{1};
+inline constexpr std::size_t column_count{20};
+inline constexpr std::size_t header_size{20};
+inline constexpr std::size_t directory_entry_size{16};
+inline constexpr std::size_t bits_padding{1};
+
+/// The bits of the task flags column.
+enum Task_flag : std::uint8_t {
+  enabled = 0x1,
+  hidden = 0x2
+};
+
+inline void put_fixed(std::vector<std::uint8_t>& out, std::uint64_t value,
+  const std::size_t size)
+{
+  for (std::size_t i{}; i < size; ++i, value >>= 8)
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+inline std::uint64_t get_fixed(const std::uint8_t* const data,
+  const std::size_t size) noexcept
+{
+  std::uint64_t result{};
+  for (std::size_t i{}; i < size; ++i)
+    result |= std::uint64_t{data[i]} << 8*i;
+  return result;
+}
+
+inline void put_varint(std::vector<std::uint8_t>& out, std::uint64_t value)
+{
+  while (value >= 0x80) {
+    out.push_back(static_cast<std::uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<std::uint8_t>(value));
+}
+
+constexpr std::uint64_t zigzag(const std::int64_t value) noexcept
+{
+  return (static_cast<std::uint64_t>(value) << 1)
+    ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+constexpr std::int64_t unzigzag(const std::uint64_t value) noexcept
+{
+  return static_cast<std::int64_t>(value >> 1)
+    ^ -static_cast<std::int64_t>(value & 1);
+}
+
+[[noreturn]] inline void throw_malformed(const char* const what)
+{
+  throw std::runtime_error{std::string{"malformed task inventory: "} + what};
+}
+
+/// Appends `value` (UTF-16 or UTF-32 depending on `wchar_t`) as UTF-8.
+inline void append_utf8(std::string& out, const std::wstring_view value)
+{
+  const auto put = [&out](const char32_t code)
+  {
+    if (code < 0x80)
+      out.push_back(static_cast<char>(code));
+    else if (code < 0x800) {
+      out.push_back(static_cast<char>(0xc0 | code >> 6));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else if (code < 0x10000) {
+      out.push_back(static_cast<char>(0xe0 | code >> 12));
+      out.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3f)));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else {
+      out.push_back(static_cast<char>(0xf0 | code >> 18));
+      out.push_back(static_cast<char>(0x80 | (code >> 12 & 0x3f)));
+      out.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3f)));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    }
+  };
+  constexpr char32_t replacement{0xfffd};
+  const auto size = value.size();
+  out.reserve(out.size() + size);
+  for (std::size_t i{}; i < size; ++i) {
+    auto code = static_cast<char32_t>(value[i]);
+    if (code >= 0xd800 && code < 0xdc00 && i + 1 < size) {
+      const auto low = static_cast<char32_t>(value[i + 1]);
+      if (low >= 0xdc00 && low < 0xe000) {
+        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+        ++i;
+      }
+    }
+    if ((code >= 0xd800 && code < 0xe000) || code > 0x10ffff)
+      code = replacement;
+    put(code);
+  }
+}
+
+/// A sequential reader of varints.
+class Varint_cursor final {
+public:
+  Varint_cursor() = default;
+
+  explicit Varint_cursor(const std::span<const std::uint8_t> data) noexcept
+    : pos_{data.data()}
+    , end_{data.data() + data.size()}
+  {}
+
+  std::uint64_t next()
+  {
+    std::uint64_t result{};
+    for (unsigned shift{}; shift < 64; shift += 7) {
+      if (pos_ == end_)
+        throw_malformed("truncated varint column");
+      const auto byte = *pos_++;
+      result |= std::uint64_t{byte & 0x7fu} << shift;
+      if (!(byte & 0x80))
+        return result;
+    }
+    throw_malformed("invalid varint");
+  }
+
+private:
+  const std::uint8_t* pos_{};
+  const std::uint8_t* end_{};
+};
+
+/// A random access reader of bit-packed values.
+class Bit_column final {
+public:
+  Bit_column() = default;
+
+  Bit_column(const std::span<const std::uint8_t> data, const std::size_t count)
+  {
+    if (data.empty())
+      throw_malformed("empty bit column");
+    width_ = data[0];
+    if (!width_ || width_ > 8)
+      throw_malformed("invalid width of bit column");
+    if (data.size() < 1 + (count*width_ + 7) / 8 + bits_padding)
+      throw_malformed("truncated bit column");
+    data_ = data.data() + 1;
+  }
+
+  /// @par Requires
+  /// `index` is less than the count the column is constructed with.
+  std::uint8_t operator[](const std::size_t index) const noexcept
+  {
+    const auto bit = index * width_;
+    const auto word = get_fixed(data_ + bit/8, 2);
+    return static_cast<std::uint8_t>(word >> bit % 8 & ((1u << width_) - 1));
+  }
+
+private:
+  const std::uint8_t* data_{};
+  unsigned width_{};
+};
+
+/// The widths of the bit columns.
+inline constexpr unsigned state_width{3};
+inline constexpr unsigned logon_type_width{3};
+inline constexpr unsigned run_level_width{1};
+inline constexpr unsigned task_flags_width{2};
+inline constexpr unsigned action_type_width{3};
+inline constexpr unsigned trigger_type_width{4};
+inline constexpr unsigned trigger_has_start_width{1};
+
+/**
+ * @returns The `value` to be packed into `width` bits.
+ *
+ * @throws `std::invalid_argument` if `value` doesn't fit into `width` bits.
+ */
+template<typename T>
+std::uint8_t to_bits(const T value, const unsigned width,
+  const char* const what)
+{
+  const auto result = static_cast<std::uint64_t>(value);
+  if (result >> width)
+    throw std::invalid_argument{what};
+  return static_cast<std::uint8_t>(result);
+}
+
+/**
+ * @brief Appends the bit column of `values` packed into `width` bits each.
+ *
+ * @details The bits of `values` beyond `width` are discarded.
+ */
+inline void put_bits(std::vector<std::uint8_t>& out,
+  const std::vector<std::uint8_t>& values, const unsigned width)
+{
+  if (!width || width > 8)
+    throw std::invalid_argument{"invalid width of bit column"};
+
+  out.push_back(static_cast<std::uint8_t>(width));
+  const auto offset = out.size();
+  out.resize(offset + (values.size()*width + 7) / 8 + bits_padding);
+  const auto mask = (1u << width) - 1;
+  std::size_t bit{};
+  for (const auto value : values) {
+    const auto word = (value & mask) << bit % 8;
+    out[offset + bit/8] |= static_cast<std::uint8_t>(word);
+    out[offset + bit/8 + 1] |= static_cast<std::uint8_t>(word >> 8);
+    bit += width;
+  }
+}
+
+} // namespace detail::columnar
+
+// -----------------------------------------------------------------------------
+// Inventory_writer
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief A writer of task inventories in the columnar format.
+ *
+ * @details Strings are converted to UTF-8 and stored once in the dictionary,
+ * so repeated paths, authors and command lines cost a varint per reference.
+ * The last run times are stored as deltas of milliseconds, and the
+ * enumerations are packed into the bits they need.
+ *
+ * @see Inventory_reader.
+ */
+class Inventory_writer final : private Noncopy {
+public:
+  Inventory_writer()
+  {
+    dictionary_.emplace(strings_.emplace_back(), 0);
+  }
+
+  /**
+   * @brief Appends the task.
+   *
+   * @details Invalid `DATE` values of `signature.last_run_time` are stored
+   * as zeros (task has not run yet).
+   *
+   * @throws `std::invalid_argument` if an enumeration value of the task
+   * doesn't fit into its bit column.
+   *
+   * @par Exception safety guarantee
+   * Strong (with respect to the rows).
+   */
+  void add(const Task_signature& signature,
+    const Task_definition_snapshot& definition)
+  {
+    namespace col = detail::columnar;
+    if (row_count_ == std::numeric_limits<std::uint32_t>::max()
+      || actions_.size() + definition.actions.size()
+        > std::numeric_limits<std::uint32_t>::max()
+      || triggers_.size() + definition.triggers.size()
+        > std::numeric_limits<std::uint32_t>::max())
+      throw std::length_error{"task inventory is too large"};
+
+    const auto sizes = column_sizes();
+    try {
+      const auto text = [&definition](const Snapshot_text value)
+      {
+        return definition.text(value);
+      };
+      col::put_varint(columns_[id(Inventory_column::path)], intern(signature.path));
+      states_.push_back(col::to_bits(signature.state, col::state_width,
+          "invalid task state"));
+
+      const auto date = is_ole_date_valid(signature.last_run_time) ?
+        signature.last_run_time : 0;
+      const auto time =
+        wincom::detail::ole_date_to_ticks<std::chrono::milliseconds>(date);
+      col::put_varint(columns_[id(Inventory_column::last_run_time)],
+        col::zigzag(time - last_run_time_));
+
+      col::put_varint(columns_[id(Inventory_column::author)],
+        intern(text(definition.registration.author)));
+      col::put_varint(columns_[id(Inventory_column::uri)],
+        intern(text(definition.registration.uri)));
+      col::put_varint(columns_[id(Inventory_column::user_id)],
+        intern(text(definition.principal.user_id)));
+      logon_types_.push_back(col::to_bits(definition.principal.logon_type,
+          col::logon_type_width, "invalid logon type"));
+      run_levels_.push_back(col::to_bits(definition.principal.run_level,
+          col::run_level_width, "invalid run level"));
+      task_flags_.push_back(static_cast<std::uint8_t>(
+          (definition.settings.is_enabled ? col::enabled : 0)
+          | (definition.settings.is_hidden ? col::hidden : 0)));
+
+      col::put_varint(columns_[id(Inventory_column::action_count)],
+        definition.actions.size());
+      for (const auto& action : definition.actions) {
+        actions_.push_back(col::to_bits(action.type, col::action_type_width,
+            "invalid action type"));
+        col::put_varint(columns_[id(Inventory_column::action_path)],
+          intern(text(action.path)));
+        col::put_varint(columns_[id(Inventory_column::action_arguments)],
+          intern(text(action.arguments)));
+        col::put_varint(columns_[id(Inventory_column::action_working_directory)],
+          intern(text(action.working_directory)));
+      }
+
+      col::put_varint(columns_[id(Inventory_column::trigger_count)],
+        definition.triggers.size());
+      auto trigger_start = trigger_start_;
+      for (const auto& trigger : definition.triggers) {
+        triggers_.push_back(col::to_bits(trigger.type,
+            col::trigger_type_width, "invalid trigger type"));
+        trigger_has_start_.push_back(trigger.start_boundary.has_value());
+        if (trigger.start_boundary) {
+          const auto start = trigger.start_boundary->time_since_epoch().count();
+          col::put_varint(columns_[id(Inventory_column::trigger_start)],
+            col::zigzag(start - trigger_start));
+          trigger_start = start;
+        }
+        col::put_varint(columns_[id(Inventory_column::trigger_repetition_interval)],
+          static_cast<std::uint64_t>(trigger.repetition.interval.count()));
+      }
+
+      last_run_time_ = time;
+      trigger_start_ = trigger_start;
+      ++row_count_;
+    } catch (...) {
+      restore(sizes);
+      throw;
+    }
+  }
+
+  /// @returns The number of tasks.
+  std::size_t size() const noexcept
+  {
+    return row_count_;
+  }
+
+  /// @returns The number of distinct strings.
+  std::size_t string_count() const noexcept
+  {
+    return strings_.size();
+  }
+
+  /// @returns The inventory in the columnar format.
+  std::vector<std::uint8_t> serialize() const
+  {
+    namespace col = detail::columnar;
+    std::array<std::vector<std::uint8_t>, col::column_count> packed;
+
+    auto& strings = packed[id(Inventory_column::strings)];
+    col::put_fixed(strings, strings_.size(), 4);
+    std::uint64_t offset{};
+    col::put_fixed(strings, offset, 4);
+    for (const auto& str : strings_) {
+      offset += str.size();
+      if (offset > std::numeric_limits<std::uint32_t>::max())
+        throw std::length_error{"task inventory dictionary is too large"};
+      col::put_fixed(strings, offset, 4);
+    }
+    for (const auto& str : strings_)
+      strings.insert(strings.end(), str.begin(), str.end());
+
+    col::put_bits(packed[id(Inventory_column::state)], states_,
+      col::state_width);
+    col::put_bits(packed[id(Inventory_column::logon_type)], logon_types_,
+      col::logon_type_width);
+    col::put_bits(packed[id(Inventory_column::run_level)], run_levels_,
+      col::run_level_width);
+    col::put_bits(packed[id(Inventory_column::task_flags)], task_flags_,
+      col::task_flags_width);
+    col::put_bits(packed[id(Inventory_column::action_type)], actions_,
+      col::action_type_width);
+    col::put_bits(packed[id(Inventory_column::trigger_type)], triggers_,
+      col::trigger_type_width);
+    col::put_bits(packed[id(Inventory_column::trigger_has_start)],
+      trigger_has_start_, col::trigger_has_start_width);
+
+    std::size_t total{col::header_size
+      + col::column_count*col::directory_entry_size};
+    for (std::size_t i{}; i < col::column_count; ++i)
+      total += column(packed, i).size();
+
+    std::vector<std::uint8_t> result(col::magic.begin(), col::magic.end());
+    result.reserve(total);
+    col::put_fixed(result, col::version, 2);
+    col::put_fixed(result, col::column_count, 2);
+    col::put_fixed(result, row_count_, 4);
+    col::put_fixed(result, actions_.size(), 4);
+    col::put_fixed(result, triggers_.size(), 4);
+    offset = col::header_size + col::column_count*col::directory_entry_size;
+    for (std::size_t i{}; i < col::column_count; ++i) {
+      const auto size = column(packed, i).size();
+      col::put_fixed(result, offset, 8);
+      col::put_fixed(result, size, 8);
+      offset += size;
+    }
+    for (std::size_t i{}; i < col::column_count; ++i) {
+      const auto& data = column(packed, i);
+      result.insert(result.end(), data.begin(), data.end());
+    }
+    return result;
+  }
+
+  /// Removes all the tasks.
+  void clear()
+  {
+    *this = Inventory_writer{};
+  }
+
+private:
+  using Sizes = std::array<std::size_t, detail::columnar::column_count + 7>;
+
+  std::deque<std::string> strings_; // stable references
+  std::unordered_map<std::string_view, std::uint32_t> dictionary_;
+  std::string utf8_;
+  std::array<std::vector<std::uint8_t>, detail::columnar::column_count> columns_;
+  std::vector<std::uint8_t> states_;
+  std::vector<std::uint8_t> logon_types_;
+  std::vector<std::uint8_t> run_levels_;
+  std::vector<std::uint8_t> task_flags_;
+  std::vector<std::uint8_t> actions_;
+  std::vector<std::uint8_t> triggers_;
+  std::vector<std::uint8_t> trigger_has_start_;
+  std::int64_t last_run_time_{};
+  std::int64_t trigger_start_{};
+  std::uint32_t row_count_{};
+
+  static constexpr std::size_t id(const Inventory_column column) noexcept
+  {
+    return static_cast<std::size_t>(column);
+  }
+
+  const std::vector<std::uint8_t>& column(
+    const std::array<std::vector<std::uint8_t>,
+      detail::columnar::column_count>& packed, const std::size_t index) const
+  {
+    return packed[index].empty() ? columns_[index] : packed[index];
+  }
+
+  std::uint32_t intern(const std::wstring_view value)
+  {
+    utf8_.clear();
+    detail::columnar::append_utf8(utf8_, value);
+    if (const auto i = dictionary_.find(utf8_); i != dictionary_.end())
+      return i->second;
+
+    if (strings_.size() == std::numeric_limits<std::uint32_t>::max())
+      throw std::length_error{"task inventory dictionary is too large"};
+    const auto result = static_cast<std::uint32_t>(strings_.size());
+    strings_.push_back(utf8_);
+    try {
+      dictionary_.emplace(strings_.back(), result);
+    } catch (...) {
+      strings_.pop_back();
+      throw;
+    }
+    return result;
+  }
+
+  Sizes column_sizes() const noexcept
+  {
+    Sizes result{};
+    for (std::size_t i{}; i < columns_.size(); ++i)
+      result[i] = columns_[i].size();
+    auto* const extra = result.data() + columns_.size();
+    extra[0] = states_.size();
+    extra[1] = logon_types_.size();
+    extra[2] = run_levels_.size();
+    extra[3] = task_flags_.size();
+    extra[4] = actions_.size();
+    extra[5] = triggers_.size();
+    extra[6] = trigger_has_start_.size();
+    return result;
+  }
+
+  void restore(const Sizes& sizes) noexcept
+  {
+    for (std::size_t i{}; i < columns_.size(); ++i)
+      columns_[i].resize(sizes[i]);
+    const auto* const extra = sizes.data() + columns_.size();
+    states_.resize(extra[0]);
+    logon_types_.resize(extra[1]);
+    run_levels_.resize(extra[2]);
+    task_flags_.resize(extra[3]);
+    actions_.resize(extra[4]);
+    triggers_.resize(extra[5]);
+    trigger_has_start_.resize(extra[6]);
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Inventory_reader
+// -----------------------------------------------------------------------------
+
+/// An action of the task read from the inventory.
+struct Inventory_action final {
+  Action_type type{Action_type::exec};
+  std::string_view path;
+  std::string_view arguments;
+  std::string_view working_directory;
+};
+
+/// A trigger of the task read from the inventory.
+struct Inventory_trigger final {
+  Trigger_type type{Trigger_type::time};
+  std::optional<Schedule_time> start_boundary;
+  std::chrono::seconds repetition_interval{};
+};
+
+/**
+ * @brief A task read from the inventory.
+ *
+ * @details The strings refer to the inventory data, while the spans refer
+ * to the buffers of the cursor which are valid until the next row is read.
+ */
+struct Inventory_task final {
+  std::string_view path;
+  Task_state state{Task_state::unknown};
+  /// The last run time in local time of the host.
+  std::chrono::local_time<std::chrono::milliseconds> last_run_time;
+  std::string_view author;
+  std::string_view uri;
+  std::string_view user_id;
+  Logon_type logon_type{Logon_type::none};
+  Run_level run_level{Run_level::lua};
+  bool is_enabled{};
+  bool is_hidden{};
+  std::span<const Inventory_action> actions;
+  std::span<const Inventory_trigger> triggers;
+};
+
+/**
+ * @brief A zero-copy reader of task inventories in the columnar format.
+ *
+ * @details The reader refers to the data it's constructed with, which must
+ * outlive both the reader and its cursors. The strings are never copied.
+ *
+ * @see Inventory_writer.
+ */
+class Inventory_reader final {
+public:
+  /// A sequential reader of tasks.
+  class Cursor final {
+  public:
+    /**
+     * @brief Reads the next task into `task`.
+     *
+     * @returns `false` if there are no more tasks.
+     *
+     * @throws `std::runtime_error` if the data is malformed.
+     */
+    bool next(Inventory_task& task)
+    {
+      namespace col = detail::columnar;
+      if (row_ == reader_->row_count_)
+        return false;
+
+      task.path = string(path_.next());
+      task.state = static_cast<Task_state>(reader_->states_[row_]);
+      last_run_time_ += col::unzigzag(last_run_time_deltas_.next());
+      task.last_run_time = std::chrono::local_time<std::chrono::milliseconds>{
+        std::chrono::milliseconds{last_run_time_}};
+      task.author = string(author_.next());
+      task.uri = string(uri_.next());
+      task.user_id = string(user_id_.next());
+      task.logon_type = static_cast<Logon_type>(reader_->logon_types_[row_]);
+      task.run_level = static_cast<Run_level>(reader_->run_levels_[row_]);
+      const auto flags = reader_->task_flags_[row_];
+      task.is_enabled = flags & col::enabled;
+      task.is_hidden = flags & col::hidden;
+
+      const auto action_count = action_counts_.next();
+      if (action_count > reader_->action_count_ - action_)
+        col::throw_malformed("action count out of range");
+      actions_.resize(static_cast<std::size_t>(action_count));
+      for (auto& action : actions_) {
+        action.type = static_cast<Action_type>(reader_->action_types_[action_++]);
+        action.path = string(action_paths_.next());
+        action.arguments = string(action_arguments_.next());
+        action.working_directory = string(action_working_directories_.next());
+      }
+      task.actions = actions_;
+
+      const auto trigger_count = trigger_counts_.next();
+      if (trigger_count > reader_->trigger_count_ - trigger_)
+        col::throw_malformed("trigger count out of range");
+      triggers_.resize(static_cast<std::size_t>(trigger_count));
+      for (auto& trigger : triggers_) {
+        trigger.type = static_cast<Trigger_type>(
+          reader_->trigger_types_[trigger_]);
+        if (reader_->trigger_has_start_[trigger_]) {
+          trigger_start_ += col::unzigzag(trigger_starts_.next());
+          trigger.start_boundary = Schedule_time{
+            std::chrono::seconds{trigger_start_}};
+        } else
+          trigger.start_boundary.reset();
+        trigger.repetition_interval = std::chrono::seconds{
+          static_cast<std::int64_t>(trigger_repetition_intervals_.next())};
+        ++trigger_;
+      }
+      task.triggers = triggers_;
+
+      ++row_;
+      return true;
+    }
+
+  private:
+    friend Inventory_reader;
+
+    const Inventory_reader* reader_{};
+    std::size_t row_{};
+    std::size_t action_{};
+    std::size_t trigger_{};
+    std::int64_t last_run_time_{};
+    std::int64_t trigger_start_{};
+    detail::columnar::Varint_cursor path_;
+    detail::columnar::Varint_cursor last_run_time_deltas_;
+    detail::columnar::Varint_cursor author_;
+    detail::columnar::Varint_cursor uri_;
+    detail::columnar::Varint_cursor user_id_;
+    detail::columnar::Varint_cursor action_counts_;
+    detail::columnar::Varint_cursor action_paths_;
+    detail::columnar::Varint_cursor action_arguments_;
+    detail::columnar::Varint_cursor action_working_directories_;
+    detail::columnar::Varint_cursor trigger_counts_;
+    detail::columnar::Varint_cursor trigger_starts_;
+    detail::columnar::Varint_cursor trigger_repetition_intervals_;
+    std::vector<Inventory_action> actions_;
+    std::vector<Inventory_trigger> triggers_;
+
+    explicit Cursor(const Inventory_reader& reader)
+      : reader_{&reader}
+      , path_{reader.column(Inventory_column::path)}
+      , last_run_time_deltas_{reader.column(Inventory_column::last_run_time)}
+      , author_{reader.column(Inventory_column::author)}
+      , uri_{reader.column(Inventory_column::uri)}
+      , user_id_{reader.column(Inventory_column::user_id)}
+      , action_counts_{reader.column(Inventory_column::action_count)}
+      , action_paths_{reader.column(Inventory_column::action_path)}
+      , action_arguments_{reader.column(Inventory_column::action_arguments)}
+      , action_working_directories_{
+          reader.column(Inventory_column::action_working_directory)}
+      , trigger_counts_{reader.column(Inventory_column::trigger_count)}
+      , trigger_starts_{reader.column(Inventory_column::trigger_start)}
+      , trigger_repetition_intervals_{
+          reader.column(Inventory_column::trigger_repetition_interval)}
+    {}
+
+    std::string_view string(const std::uint64_t index) const
+    {
+      if (index >= reader_->string_count())
+        detail::columnar::throw_malformed("string index out of range");
+      return reader_->string(static_cast<std::uint32_t>(index));
+    }
+  };
+
+  /**
+   * @brief Validates the header, the directory and the dictionary of `data`.
+   *
+   * @throws `std::runtime_error` if the data is malformed.
+   */
+  explicit Inventory_reader(const std::span<const std::uint8_t> data)
+  {
+    namespace col = detail::columnar;
+    if (data.size() < col::header_size
+      || !std::equal(col::magic.begin(), col::magic.end(), data.begin()))
+      col::throw_malformed("invalid header");
+    if (col::get_fixed(data.data() + 4, 2) != col::version)
+      col::throw_malformed("unsupported version");
+    const auto column_count = col::get_fixed(data.data() + 6, 2);
+    if (column_count < col::column_count)
+      col::throw_malformed("too few columns");
+    row_count_ = col::get_fixed(data.data() + 8, 4);
+    action_count_ = col::get_fixed(data.data() + 12, 4);
+    trigger_count_ = col::get_fixed(data.data() + 16, 4);
+
+    if (data.size() - col::header_size
+      < column_count*col::directory_entry_size)
+      col::throw_malformed("truncated directory");
+    for (std::size_t i{}; i < col::column_count; ++i) {
+      const auto* const entry = data.data() + col::header_size
+        + i*col::directory_entry_size;
+      const auto offset = col::get_fixed(entry, 8);
+      const auto size = col::get_fixed(entry + 8, 8);
+      if (offset > data.size() || size > data.size() - offset)
+        col::throw_malformed("column out of range");
+      columns_[i] = data.subspan(static_cast<std::size_t>(offset),
+        static_cast<std::size_t>(size));
+    }
+
+    const auto strings = column(Inventory_column::strings);
+    if (strings.size() < 4)
+      col::throw_malformed("truncated dictionary");
+    string_count_ = col::get_fixed(strings.data(), 4);
+    if (!string_count_ || (strings.size() - 4)/4 < string_count_ + 1)
+      col::throw_malformed("truncated dictionary");
+    offsets_ = strings.data() + 4;
+    chars_ = reinterpret_cast<const char*>(offsets_ + 4*(string_count_ + 1));
+    const auto chars_size = strings.size() - 4*(string_count_ + 2);
+    std::uint64_t prev{};
+    for (std::size_t i{}; i <= string_count_; ++i) {
+      const auto offset = col::get_fixed(offsets_ + 4*i, 4);
+      if (offset < prev || offset > chars_size)
+        col::throw_malformed("invalid dictionary offset");
+      prev = offset;
+    }
+
+    states_ = {column(Inventory_column::state), row_count_};
+    logon_types_ = {column(Inventory_column::logon_type), row_count_};
+    run_levels_ = {column(Inventory_column::run_level), row_count_};
+    task_flags_ = {column(Inventory_column::task_flags), row_count_};
+    action_types_ = {column(Inventory_column::action_type), action_count_};
+    trigger_types_ = {column(Inventory_column::trigger_type), trigger_count_};
+    trigger_has_start_ = {column(Inventory_column::trigger_has_start),
+      trigger_count_};
+  }
+
+  /// @returns The number of tasks.
+  std::size_t size() const noexcept
+  {
+    return row_count_;
+  }
+
+  /// @returns The number of strings of the dictionary.
+  std::size_t string_count() const noexcept
+  {
+    return string_count_;
+  }
+
+  /**
+   * @returns The string of the dictionary.
+   *
+   * @par Requires
+   * `index < string_count()`.
+   */
+  std::string_view string(const std::uint32_t index) const noexcept
+  {
+    const auto begin = detail::columnar::get_fixed(offsets_ + 4*index, 4);
+    const auto end = detail::columnar::get_fixed(offsets_ + 4*(index + 1), 4);
+    return {chars_ + begin, static_cast<std::size_t>(end - begin)};
+  }
+
+  /// @returns The task state of the row without decoding the other columns.
+  Task_state state(const std::size_t row) const
+  {
+    if (row >= row_count_)
+      throw std::out_of_range{"cannot get task state of inventory: invalid row"};
+    return static_cast<Task_state>(states_[row]);
+  }
+
+  /// @returns The raw data of `column`.
+  std::span<const std::uint8_t> column(const Inventory_column column) const noexcept
+  {
+    return columns_[static_cast<std::size_t>(column)];
+  }
+
+  /// @returns The cursor positioned before the first task.
+  Cursor cursor() const
+  {
+    return Cursor{*this};
+  }
+
+private:
+  std::array<std::span<const std::uint8_t>, detail::columnar::column_count> columns_;
+  std::size_t row_count_{};
+  std::size_t action_count_{};
+  std::size_t trigger_count_{};
+  std::size_t string_count_{};
+  const std::uint8_t* offsets_{};
+  const char* chars_{};
+  detail::columnar::Bit_column states_;
+  detail::columnar::Bit_column logon_types_;
+  detail::columnar::Bit_column run_levels_;
+  detail::columnar::Bit_column task_flags_;
+  detail::columnar::Bit_column action_types_;
+  detail::columnar::Bit_column trigger_types_;
+  detail::columnar::Bit_column trigger_has_start_;
+};
+
+} // namespace dmitigr::wincom::tasc::v2
@@ -0,0 +1,272 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "../base/noncopymove.hpp"
+#include "exceptions.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom::tasc::v2 {
+
+/**
+ * @brief A shared waiter of completion of task instances.
+ *
+ * @details A single thread samples the GUIDs of running task instances by
+ * calling the `Sampler` and completes the waits of instances which are no
+ * longer running. Thus, the cost of sampling doesn't depend on the number of
+ * pending waits. The poll interval is reset to the minimum when a wait is
+ * added or completed and grows exponentially (up to the maximum) otherwise.
+ *
+ * If the `Sampler` throws, the waits are kept pending and the sampling is
+ * retried with the growing interval. The waits are completed with the error
+ * only after `Options::max_failures` consecutive failures or at their own
+ * deadlines.
+ *
+ * @tparam Sampler The callable of signature `std::vector<std::wstring>()`
+ * which returns the GUIDs of running instances. It's invoked and destroyed
+ * on the poller thread only, so it can initialize COM for that thread and
+ * own the proxies it uses.
+ */
+template<class Sampler, class Clock = std::chrono::steady_clock>
+class Completion_poller final : private Noncopymove {
+public:
+  using Duration = typename Clock::duration;
+  using Time_point = typename Clock::time_point;
+
+  /// The options of the poll interval.
+  struct Options final {
+    Duration min_interval{std::chrono::milliseconds{50}};
+    Duration max_interval{std::chrono::seconds{2}};
+    unsigned backoff_factor{2};
+    /// The number of consecutive failures of the sampler to give up after.
+    unsigned max_failures{5};
+  };
+
+  /// Stops the poller. The pending waits are completed with exception.
+  ~Completion_poller()
+  {
+    {
+      const std::lock_guard lg{mutex_};
+      is_stopping_ = true;
+    }
+    changed_.notify_one();
+    thread_.join();
+
+    const auto error = std::make_exception_ptr(
+      std::runtime_error{"completion poller stopped"});
+    for (auto& wait : pending_)
+      wait.promise.set_exception(error);
+  }
+
+  explicit Completion_poller(Sampler sampler, const Options options = {})
+    : options_{options}
+    , interval_{options.min_interval}
+    , sampler_{std::move(sampler)}
+  {
+    if (options_.min_interval <= Duration{}
+      || options_.max_interval < options_.min_interval
+      || !options_.backoff_factor || !options_.max_failures)
+      throw std::invalid_argument{"invalid options of completion poller"};
+    thread_ = std::thread{&Completion_poller::run, this};
+  }
+
+  /**
+   * @returns The future which is ready when the instance with `instance_guid`
+   * is no longer running. Its value is the time elapsed since this call.
+   */
+  std::future<Duration> wait(std::wstring instance_guid)
+  {
+    return wait(std::move(instance_guid), Time_point::max());
+  }
+
+  /**
+   * @returns The future as by `wait(instance_guid)`, but which is completed
+   * with `Timeout_error` (or with the error of the sampler if it's failing)
+   * if the instance is still running after `timeout`.
+   */
+  std::future<Duration> wait(std::wstring instance_guid,
+    const Duration timeout)
+  {
+    const auto now = Clock::now();
+    return wait(std::move(instance_guid),
+      timeout < Time_point::max() - now ? now + timeout : Time_point::max());
+  }
+
+  /// @returns The number of pending waits.
+  std::size_t pending_count() const
+  {
+    const std::lock_guard lg{mutex_};
+    return pending_.size();
+  }
+
+private:
+  struct Wait final {
+    std::wstring instance_guid;
+    Time_point since;
+    Time_point deadline;
+    std::promise<Duration> promise;
+  };
+
+  Options options_;
+  Duration interval_{};
+  Time_point next_sample_at_{Time_point::max()};
+  std::optional<Sampler> sampler_;
+  std::vector<Wait> pending_;
+  std::exception_ptr last_error_;
+  unsigned failure_count_{};
+  bool is_stopping_{};
+  mutable std::mutex mutex_;
+  std::condition_variable changed_;
+  std::thread thread_;
+
+  void run()
+  {
+    std::unique_lock lk{mutex_};
+    while (!is_stopping_) {
+      if (pending_.empty()) {
+        next_sample_at_ = Time_point::max();
+        changed_.wait(lk, [this]{return is_stopping_ || !pending_.empty();});
+        continue;
+      } else if (const auto now = Clock::now(); now < next_sample_at_) {
+        if (const auto deadline = earliest_deadline(); deadline <= now)
+          expire(now);
+        else
+          changed_.wait_until(lk, std::min(next_sample_at_, deadline));
+        continue;
+      }
+
+      lk.unlock();
+      std::vector<std::wstring> running;
+      std::exception_ptr error;
+      try {
+        running = (*sampler_)();
+        std::sort(running.begin(), running.end());
+      } catch (...) {
+        error = std::current_exception();
+      }
+      lk.lock();
+
+      const auto now = Clock::now();
+      std::size_t completed{};
+      if (error) {
+        last_error_ = error;
+        if (++failure_count_ >= options_.max_failures) {
+          failure_count_ = 0;
+          erase_pending_if([&error](Wait& wait)
+          {
+            wait.promise.set_exception(error);
+            return true;
+          });
+        }
+      } else {
+        last_error_ = nullptr;
+        failure_count_ = 0;
+        completed = erase_pending_if([&running, now](Wait& wait)
+        {
+          if (std::binary_search(running.begin(), running.end(),
+              wait.instance_guid))
+            return false;
+          wait.promise.set_value(now - wait.since);
+          return true;
+        });
+      }
+      expire(now);
+
+      interval_ = completed ? options_.min_interval :
+        std::min(interval_ * options_.backoff_factor, options_.max_interval);
+      next_sample_at_ = now + interval_;
+    }
+    lk.unlock();
+    sampler_.reset();
+  }
+
+  std::future<Duration> wait(std::wstring instance_guid,
+    const Time_point deadline)
+  {
+    std::promise<Duration> promise;
+    auto result = promise.get_future();
+    {
+      const std::lock_guard lg{mutex_};
+      if (is_stopping_)
+        throw std::logic_error{"cannot wait with stopped completion poller"};
+      const auto now = Clock::now();
+      pending_.push_back(Wait{std::move(instance_guid), now, deadline,
+        std::move(promise)});
+      interval_ = options_.min_interval;
+      if (now + interval_ < next_sample_at_ || deadline < next_sample_at_) {
+        next_sample_at_ = std::min(next_sample_at_, now + interval_);
+        changed_.notify_one();
+      }
+    }
+    return result;
+  }
+
+  /// @returns The earliest deadline of the pending waits.
+  Time_point earliest_deadline() const noexcept
+  {
+    Time_point result{Time_point::max()};
+    for (const auto& wait : pending_)
+      result = std::min(result, wait.deadline);
+    return result;
+  }
+
+  /// Completes the pending waits which deadlines are expired as of `now`.
+  void expire(const Time_point now)
+  {
+    erase_pending_if([this, now](Wait& wait)
+    {
+      if (now < wait.deadline)
+        return false;
+      wait.promise.set_exception(last_error_ ? last_error_ :
+        std::make_exception_ptr(Timeout_error{"timed out waiting for"
+            " completion of task instance"}));
+      return true;
+    });
+  }
+
+  /// Removes the pending waits for which `complete(wait)` returns `true`.
+  template<class F>
+  std::size_t erase_pending_if(F&& complete)
+  {
+    std::size_t result{};
+    for (std::size_t i{}; i < pending_.size();) {
+      if (!complete(pending_[i])) {
+        ++i;
+        continue;
+      }
+      ++result;
+      if (i + 1 != pending_.size())
+        pending_[i] = std::move(pending_.back());
+      pending_.pop_back();
+    }
+    return result;
+  }
+};
+
+} // namespace dmitigr::wincom::tasc::v2
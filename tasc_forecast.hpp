@@ -0,0 +1,248 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "hash.hpp"
+#include "tasc_schedule.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace dmitigr::wincom::tasc::v2 {
+
+/// @returns The key which identifies the task with `path` across hosts.
+template<typename CharT>
+std::uint64_t task_key(const std::basic_string_view<CharT> path) noexcept
+{
+  return fnv1a(path);
+}
+
+/**
+ * @brief A forecaster of scheduled task starts over many hosts.
+ *
+ * @details Inventories are merged in a streaming fashion: each call of add()
+ * expands the triggers of a task within the horizon in local time of the host
+ * and accumulates the number of starts per minute in UTC, so the hosts in
+ * different time zones which start the task at the same instant are counted
+ * in the same minute. The task is counted at most once per minute and host
+ * even if several of its triggers fire within the minute. The frequent tasks
+ * of each minute are tracked
+ * by the space-saving algorithm with a fixed number of slots, so the memory
+ * usage depends only on the horizon and the number of slots, but not on the
+ * number of hosts and tasks. The counts of tracked tasks may be overestimated
+ * by at most the smallest count of the minute, but never underestimated.
+ */
+class Load_forecaster final {
+public:
+  /// A thundering-herd window.
+  struct Herd final {
+    std::chrono::sys_seconds minute;
+    std::uint64_t task_key{};
+    std::uint64_t count{};
+  };
+
+  /**
+   * @param origin The beginning of the forecast in UTC.
+   * @param horizon The length of the forecast.
+   * @param slot_count The number of tasks tracked per minute.
+   */
+  Load_forecaster(const std::chrono::sys_seconds origin,
+    const std::chrono::minutes horizon, const std::size_t slot_count = 8)
+    : origin_{std::chrono::floor<std::chrono::minutes>(origin)}
+    , slot_count_{slot_count}
+  {
+    if (horizon <= std::chrono::minutes{})
+      throw std::invalid_argument{"invalid horizon of load forecaster"};
+    else if (!slot_count_)
+      throw std::invalid_argument{"invalid slot count of load forecaster"};
+
+    const auto size = static_cast<std::size_t>(horizon.count());
+    histogram_.resize(size);
+    slots_.resize(size * slot_count_);
+  }
+
+  std::chrono::sys_seconds origin() const noexcept
+  {
+    return origin_;
+  }
+
+  std::chrono::minutes horizon() const noexcept
+  {
+    return std::chrono::minutes{histogram_.size()};
+  }
+
+  /**
+   * @brief Accounts the starts of the task identified by `key` on one host.
+   *
+   * @param utc_offset The UTC offset of the host (its local time minus UTC)
+   * over the horizon.
+   */
+  void add(const std::uint64_t key,
+    const std::span<const Trigger_snapshot> triggers,
+    const std::chrono::seconds utc_offset)
+  {
+    const Schedule_time local_origin{origin_.time_since_epoch() + utc_offset};
+    const auto local_end = local_origin + horizon();
+    minutes_.clear();
+    for (const auto& trigger : triggers) {
+      Fire_time_generator gen{trigger, local_origin};
+      while (const auto t = gen.next()) {
+        if (*t >= local_end)
+          break;
+        minutes_.push_back(minute_index(*t - local_origin));
+      }
+    }
+    std::sort(minutes_.begin(), minutes_.end());
+    const auto last = std::unique(minutes_.begin(), minutes_.end());
+    for (auto i = minutes_.begin(); i != last; ++i)
+      account(*i, key, 1);
+  }
+
+  /// @overload
+  template<typename CharT>
+  void add(const std::basic_string_view<CharT> path,
+    const std::span<const Trigger_snapshot> triggers,
+    const std::chrono::seconds utc_offset)
+  {
+    add(task_key(path), triggers, utc_offset);
+  }
+
+  /**
+   * @brief Merges `other` into this instance.
+   *
+   * @par Requires
+   * `other` has the same origin and horizon.
+   */
+  void merge(const Load_forecaster& other)
+  {
+    if (other.origin_ != origin_ ||
+      other.histogram_.size() != histogram_.size())
+      throw std::invalid_argument{"cannot merge load forecasters with"
+        " different origins or horizons"};
+
+    for (std::size_t m{}; m < histogram_.size(); ++m) {
+      histogram_[m] += other.histogram_[m];
+      for (const auto& slot : other.slots_of(m)) {
+        if (slot.count)
+          track(m, slot.key, slot.count);
+      }
+    }
+  }
+
+  /// @returns The number of starts per minute since origin().
+  std::span<const std::uint64_t> histogram() const noexcept
+  {
+    return histogram_;
+  }
+
+  /// @returns The maximum number of starts in a minute.
+  std::uint64_t peak() const noexcept
+  {
+    return histogram_.empty() ? 0 :
+      *std::max_element(histogram_.begin(), histogram_.end());
+  }
+
+  /**
+   * @returns The minutes at which at least `threshold` starts of the same
+   * task are forecast, ordered by time and then by count descending.
+   */
+  std::vector<Herd> herds(const std::uint64_t threshold) const
+  {
+    std::vector<Herd> result;
+    for (std::size_t m{}; m < histogram_.size(); ++m) {
+      if (histogram_[m] < threshold)
+        continue;
+
+      const auto first = result.size();
+      for (const auto& slot : slots_of(m)) {
+        if (slot.count >= threshold)
+          result.push_back({origin_ + std::chrono::minutes{m}, slot.key,
+            slot.count});
+      }
+      std::sort(result.begin() + first, result.end(),
+        [](const auto& lhs, const auto& rhs){return lhs.count > rhs.count;});
+    }
+    return result;
+  }
+
+  /// Resets all the counters.
+  void clear() noexcept
+  {
+    std::fill(histogram_.begin(), histogram_.end(), 0);
+    std::fill(slots_.begin(), slots_.end(), Slot{});
+  }
+
+private:
+  struct Slot final {
+    std::uint64_t key{};
+    std::uint64_t count{};
+  };
+
+  std::chrono::sys_seconds origin_;
+  std::size_t slot_count_{};
+  std::vector<std::uint64_t> histogram_;
+  std::vector<Slot> slots_;
+  std::vector<std::size_t> minutes_; // of add()
+
+  static std::size_t minute_index(const std::chrono::seconds since) noexcept
+  {
+    return static_cast<std::size_t>(
+      std::chrono::floor<std::chrono::minutes>(since).count());
+  }
+
+  std::span<Slot> slots_of(const std::size_t minute) noexcept
+  {
+    return std::span{slots_}.subspan(minute * slot_count_, slot_count_);
+  }
+
+  std::span<const Slot> slots_of(const std::size_t minute) const noexcept
+  {
+    return std::span{slots_}.subspan(minute * slot_count_, slot_count_);
+  }
+
+  void account(const std::size_t minute, const std::uint64_t key,
+    const std::uint64_t count) noexcept
+  {
+    histogram_[minute] += count;
+    track(minute, key, count);
+  }
+
+  void track(const std::size_t minute, const std::uint64_t key,
+    const std::uint64_t count) noexcept
+  {
+    const auto slots = slots_of(minute);
+    Slot* min{&slots.front()};
+    for (auto& slot : slots) {
+      if (slot.key == key && slot.count) {
+        slot.count += count;
+        return;
+      } else if (slot.count < min->count)
+        min = &slot;
+    }
+    // Replace the least frequent (or a free) slot.
+    min->key = key;
+    min->count += count;
+  }
+};
+
+} // namespace dmitigr::wincom::tasc::v2
@@ -0,0 +1,503 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "tasc_columnar.hpp"
+#include "tasc_snapshot.hpp"
+#include "tasc_sync.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom::tasc::v2 {
+
+// -----------------------------------------------------------------------------
+// Task_query
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief A boolean query over the task index.
+ *
+ * @details The leaves match either a substring of the command lines of the
+ * exec actions of the task, or the exact author, URI or path of the task.
+ * All the matches are ASCII case-insensitive. The leaves are combined with
+ * `&&`, `||` and `!`.
+ *
+ * @par Example
+ * @code
+ * const auto query = Task_query::command_line(L"powershell.exe")
+ *   && Task_query::command_line(L"-enc") && !Task_query::author(L"Microsoft");
+ * @endcode
+ */
+class Task_query final {
+public:
+  /// Matches the tasks which command lines contain `substring`.
+  static Task_query command_line(const std::wstring_view substring)
+  {
+    return Task_query{Kind::command_line, substring};
+  }
+
+  /// Matches the tasks which author is `value`.
+  static Task_query author(const std::wstring_view value)
+  {
+    return Task_query{Kind::author, value};
+  }
+
+  /// Matches the tasks which URI is `value`.
+  static Task_query uri(const std::wstring_view value)
+  {
+    return Task_query{Kind::uri, value};
+  }
+
+  /// Matches the task which path is `value`.
+  static Task_query path(const std::wstring_view value)
+  {
+    return Task_query{Kind::path, value};
+  }
+
+  friend Task_query operator&&(Task_query lhs, Task_query rhs)
+  {
+    return combine(Kind::all_of, std::move(lhs), std::move(rhs));
+  }
+
+  friend Task_query operator||(Task_query lhs, Task_query rhs)
+  {
+    return combine(Kind::any_of, std::move(lhs), std::move(rhs));
+  }
+
+  friend Task_query operator!(Task_query query)
+  {
+    if (query.kind_ == Kind::negation)
+      return std::move(query.operands_.front());
+    Task_query result{Kind::negation, {}};
+    result.operands_.push_back(std::move(query));
+    return result;
+  }
+
+private:
+  friend class Task_index;
+
+  enum class Kind {
+    command_line,
+    author,
+    uri,
+    path,
+    all_of,
+    any_of,
+    negation
+  };
+
+  Kind kind_{Kind::all_of};
+  std::wstring value_;
+  std::vector<Task_query> operands_;
+
+  Task_query(const Kind kind, const std::wstring_view value)
+    : kind_{kind}
+    , value_{value}
+  {}
+
+  static Task_query combine(const Kind kind, Task_query lhs, Task_query rhs)
+  {
+    Task_query result{kind, {}};
+    for (auto* const operand : {&lhs, &rhs}) {
+      if (operand->kind_ == kind) {
+        for (auto& op : operand->operands_)
+          result.operands_.push_back(std::move(op));
+      } else
+        result.operands_.push_back(std::move(*operand));
+    }
+    return result;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Task_index
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief An in-memory inverted index of task inventory.
+ *
+ * @details The command lines (the path and the arguments of every exec
+ * action) are indexed by trigrams of their case-folded UTF-8 representation.
+ * A substring query intersects the posting lists of the trigrams of the
+ * substring and then verifies the candidates, so the results are exact.
+ * Authors, URIs and paths are indexed by exact case-folded values.
+ *
+ * Updates are incremental: a changed task gets the new identifier and the
+ * old one becomes a tombstone which is skipped by the queries. The postings
+ * are rebuilt without the tombstones when they outnumber the live tasks.
+ *
+ * @remarks Not thread-safe. Concurrent queries without updates are safe.
+ */
+class Task_index final {
+public:
+  /// Adds the task at `path`, or replaces the task if it's already indexed.
+  void add(const std::wstring_view path, const Task_definition_snapshot& definition)
+  {
+    std::string text;
+    for (const auto& action : definition.actions) {
+      if (action.type != Action_type::exec)
+        continue;
+      if (!text.empty())
+        text.push_back('\n');
+      append_folded(text, definition.text(action.path));
+      text.push_back(' ');
+      append_folded(text, definition.text(action.arguments));
+    }
+    add(Document{std::wstring{path}, fold(definition.text(
+      definition.registration.author)), fold(definition.text(
+      definition.registration.uri)), std::move(text), true});
+  }
+
+  /**
+   * @brief Removes the task at `path`.
+   *
+   * @returns `true` if the task was indexed.
+   */
+  bool remove(const std::wstring_view path)
+  {
+    const auto i = paths_.find(fold(path));
+    if (i == paths_.end())
+      return false;
+    kill(i->second);
+    paths_.erase(i);
+    compact_if_needed();
+    return true;
+  }
+
+  /**
+   * @brief Applies the change emitted by `Inventory_sync::sync()`.
+   *
+   * @details Modified tasks without the definition (which XML is unchanged)
+   * are left as is.
+   */
+  void apply(const Task_delta<Task_definition_snapshot>& delta)
+  {
+    if (delta.change == Task_change::removed)
+      remove(delta.signature.path);
+    else if (delta.task_definition)
+      add(delta.signature.path, *delta.task_definition);
+  }
+
+  /// @returns The number of indexed tasks.
+  std::size_t size() const noexcept
+  {
+    return paths_.size();
+  }
+
+  /**
+   * @returns The paths of the tasks matching `query` in the order of
+   * indexing.
+   *
+   * @remarks The views are valid until the next modification of the index.
+   */
+  std::vector<std::wstring_view> search(const Task_query& query) const
+  {
+    const auto ids = evaluate(query);
+    std::vector<std::wstring_view> result;
+    result.reserve(ids.size());
+    for (const auto id : ids)
+      result.emplace_back(documents_[id].path);
+    return result;
+  }
+
+  /// Rebuilds the postings without the tombstones.
+  void compact()
+  {
+    std::vector<Document> documents;
+    documents.reserve(paths_.size());
+    for (auto& document : documents_) {
+      if (document.is_live)
+        documents.push_back(std::move(document));
+    }
+    documents_.clear();
+    dead_count_ = 0;
+    trigrams_.clear();
+    authors_.clear();
+    uris_.clear();
+    paths_.clear();
+    for (auto& document : documents)
+      add(std::move(document));
+  }
+
+  /// Removes all the tasks.
+  void clear() noexcept
+  {
+    documents_.clear();
+    dead_count_ = 0;
+    trigrams_.clear();
+    authors_.clear();
+    uris_.clear();
+    paths_.clear();
+  }
+
+private:
+  using Id = std::uint32_t;
+  using Ids = std::vector<Id>;
+
+  struct Document final {
+    std::wstring path;
+    std::wstring author;
+    std::wstring uri;
+    std::string text;
+    bool is_live{};
+  };
+
+  std::vector<Document> documents_;
+  std::size_t dead_count_{};
+  std::unordered_map<std::uint32_t, Ids> trigrams_;
+  std::unordered_map<std::wstring, Ids> authors_;
+  std::unordered_map<std::wstring, Ids> uris_;
+  std::unordered_map<std::wstring, Id> paths_;
+
+  static wchar_t fold(const wchar_t ch) noexcept
+  {
+    return L'A' <= ch && ch <= L'Z' ? static_cast<wchar_t>(ch - L'A' + L'a') : ch;
+  }
+
+  static std::wstring fold(const std::wstring_view value)
+  {
+    std::wstring result{value};
+    for (auto& ch : result)
+      ch = fold(ch);
+    return result;
+  }
+
+  static void append_folded(std::string& out, const std::wstring_view value)
+  {
+    const auto offset = out.size();
+    detail::columnar::append_utf8(out, value);
+    for (auto i = out.begin() + static_cast<std::ptrdiff_t>(offset);
+         i != out.end(); ++i) {
+      if ('A' <= *i && *i <= 'Z')
+        *i = static_cast<char>(*i - 'A' + 'a');
+    }
+  }
+
+  static std::uint32_t trigram(const char* const data) noexcept
+  {
+    return std::uint32_t{static_cast<unsigned char>(data[0])} << 16
+      | std::uint32_t{static_cast<unsigned char>(data[1])} << 8
+      | std::uint32_t{static_cast<unsigned char>(data[2])};
+  }
+
+  /// @returns The sorted unique trigrams of `text`.
+  static std::vector<std::uint32_t> trigrams(const std::string_view text)
+  {
+    std::vector<std::uint32_t> result;
+    if (text.size() >= 3) {
+      result.reserve(text.size() - 2);
+      for (std::size_t i{}; i + 2 < text.size(); ++i)
+        result.push_back(trigram(text.data() + i));
+      std::sort(result.begin(), result.end());
+      result.erase(std::unique(result.begin(), result.end()), result.end());
+    }
+    return result;
+  }
+
+  void add(Document document)
+  {
+    if (documents_.size() == std::numeric_limits<Id>::max())
+      throw std::length_error{"task index is too large"};
+
+    auto key = fold(document.path);
+    if (const auto i = paths_.find(key); i != paths_.end())
+      kill(i->second);
+
+    // Postings are appended with increasing ids, so they are kept sorted.
+    const auto id = static_cast<Id>(documents_.size());
+    documents_.push_back(std::move(document));
+    const auto& doc = documents_.back();
+    for (const auto tri : trigrams(doc.text))
+      trigrams_[tri].push_back(id);
+    authors_[doc.author].push_back(id);
+    uris_[doc.uri].push_back(id);
+    paths_.insert_or_assign(std::move(key), id);
+    compact_if_needed();
+  }
+
+  void kill(const Id id) noexcept
+  {
+    auto& document = documents_[id];
+    document.is_live = false;
+    document.text = {};
+    ++dead_count_;
+  }
+
+  void compact_if_needed()
+  {
+    if (dead_count_ > 1024 && dead_count_ > paths_.size())
+      compact();
+  }
+
+  Ids live(const Ids& ids) const
+  {
+    Ids result;
+    result.reserve(ids.size());
+    for (const auto id : ids) {
+      if (documents_[id].is_live)
+        result.push_back(id);
+    }
+    return result;
+  }
+
+  Ids all() const
+  {
+    Ids result;
+    result.reserve(paths_.size());
+    for (std::size_t id{}; id < documents_.size(); ++id) {
+      if (documents_[id].is_live)
+        result.push_back(static_cast<Id>(id));
+    }
+    return result;
+  }
+
+  Ids exact(const std::unordered_map<std::wstring, Ids>& index,
+    const std::wstring_view value) const
+  {
+    const auto i = index.find(fold(value));
+    return i != index.end() ? live(i->second) : Ids{};
+  }
+
+  Ids command_line(const std::wstring_view substring) const
+  {
+    std::string needle;
+    append_folded(needle, substring);
+    const auto contains = [this, &needle](const Id id)
+    {
+      const auto& document = documents_[id];
+      return document.is_live
+        && document.text.find(needle) != std::string::npos;
+    };
+
+    Ids result;
+    if (needle.size() < 3) {
+      for (std::size_t id{}; id < documents_.size(); ++id) {
+        if (contains(static_cast<Id>(id)))
+          result.push_back(static_cast<Id>(id));
+      }
+      return result;
+    }
+
+    std::vector<const Ids*> postings;
+    for (const auto tri : trigrams(needle)) {
+      const auto i = trigrams_.find(tri);
+      if (i == trigrams_.end())
+        return result;
+      postings.push_back(&i->second);
+    }
+    std::sort(postings.begin(), postings.end(),
+      [](const auto* lhs, const auto* rhs){return lhs->size() < rhs->size();});
+
+    Ids candidates{*postings.front()};
+    Ids tmp;
+    for (auto i = postings.begin() + 1;
+         i != postings.end() && !candidates.empty(); ++i) {
+      tmp.clear();
+      std::set_intersection(candidates.begin(), candidates.end(),
+        (*i)->begin(), (*i)->end(), std::back_inserter(tmp));
+      candidates.swap(tmp);
+    }
+    for (const auto id : candidates) {
+      if (contains(id))
+        result.push_back(id);
+    }
+    return result;
+  }
+
+  Ids evaluate(const Task_query& query) const
+  {
+    using Kind = Task_query::Kind;
+    switch (query.kind_) {
+    case Kind::command_line:
+      return command_line(query.value_);
+    case Kind::author:
+      return exact(authors_, query.value_);
+    case Kind::uri:
+      return exact(uris_, query.value_);
+    case Kind::path:
+      if (const auto i = paths_.find(fold(query.value_)); i != paths_.end())
+        return Ids{i->second};
+      return Ids{};
+    case Kind::negation:
+      return difference(all(), evaluate(query.operands_.front()));
+    case Kind::any_of: {
+      Ids result;
+      Ids tmp;
+      for (const auto& operand : query.operands_) {
+        const auto ids = evaluate(operand);
+        tmp.clear();
+        std::set_union(result.begin(), result.end(), ids.begin(), ids.end(),
+          std::back_inserter(tmp));
+        result.swap(tmp);
+      }
+      return result;
+    }
+    case Kind::all_of: {
+      // The negated operands are subtracted rather than complemented.
+      bool has_positive{};
+      Ids result;
+      Ids tmp;
+      for (const auto& operand : query.operands_) {
+        if (operand.kind_ == Kind::negation)
+          continue;
+        auto ids = evaluate(operand);
+        if (!has_positive) {
+          result = std::move(ids);
+          has_positive = true;
+        } else {
+          tmp.clear();
+          std::set_intersection(result.begin(), result.end(),
+            ids.begin(), ids.end(), std::back_inserter(tmp));
+          result.swap(tmp);
+        }
+        if (result.empty())
+          return result;
+      }
+      if (!has_positive)
+        result = all();
+      for (const auto& operand : query.operands_) {
+        if (operand.kind_ == Kind::negation && !result.empty())
+          result = difference(std::move(result),
+            evaluate(operand.operands_.front()));
+      }
+      return result;
+    }
+    }
+    return Ids{};
+  }
+
+  static Ids difference(Ids lhs, const Ids& rhs)
+  {
+    Ids result;
+    result.reserve(lhs.size());
+    std::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+      std::back_inserter(result));
+    return result;
+  }
+};
+
+} // namespace dmitigr::wincom::tasc::v2
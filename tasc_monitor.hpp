@@ -0,0 +1,173 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "tasc_sync.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom::tasc::v2 {
+
+/// The plain value counterpart of `Running_task`.
+struct Running_task_sample final {
+  /// The GUID of the task instance.
+  std::wstring instance_guid;
+  std::wstring path;
+  Task_state state{Task_state::unknown};
+  std::uint32_t engine_pid{};
+};
+
+/// A transition of a running task.
+template<class Duration>
+struct Running_task_event final {
+  enum class Kind {
+    started,
+    stopped
+  };
+
+  Kind kind{Kind::started};
+  Running_task_sample task;
+  /// The time elapsed since the instance was first observed.
+  Duration elapsed{};
+};
+
+/**
+ * @brief A monitor of running tasks.
+ *
+ * @details Consecutive samples of the running tasks (as returned by
+ * `Task_service::running_tasks()`) are compared by the task instance GUIDs
+ * and only the transitions are emitted. The recommended interval before the
+ * next sample is reset to the minimum after any transition and is doubled
+ * (up to the maximum) after each quiet sample.
+ *
+ * @remarks The start time of an instance is the time of the sample at which
+ * it was first observed, so the elapsed time is accurate up to the poll
+ * interval.
+ */
+template<class Clock = std::chrono::steady_clock>
+class Running_task_monitor final {
+public:
+  using Duration = typename Clock::duration;
+  using Time_point = typename Clock::time_point;
+  using Event = Running_task_event<Duration>;
+
+  /// The options of adaptive poll interval.
+  struct Options final {
+    Duration min_interval{std::chrono::milliseconds{250}};
+    Duration max_interval{std::chrono::seconds{8}};
+  };
+
+  /// A running task instance.
+  struct Instance final {
+    Running_task_sample task;
+    Time_point started_at;
+  };
+
+  Running_task_monitor()
+    : Running_task_monitor{Options{}}
+  {}
+
+  explicit Running_task_monitor(const Options options)
+    : options_{options}
+    , interval_{options.min_interval}
+  {
+    if (options_.min_interval <= Duration{}
+      || options_.max_interval < options_.min_interval)
+      throw std::invalid_argument{"invalid intervals of running task monitor"};
+  }
+
+  /**
+   * @brief Consumes the sample taken at `now`.
+   *
+   * @param emit The callable of signature `void(Event&&)`.
+   *
+   * @returns The number of transitions emitted.
+   */
+  template<class Emit>
+  std::size_t update(std::vector<Running_task_sample> sample,
+    const Time_point now, Emit&& emit)
+  {
+    std::sort(sample.begin(), sample.end(), &less);
+    sample.erase(std::unique(sample.begin(), sample.end(),
+        [](const auto& lhs, const auto& rhs)
+        {
+          return lhs.instance_guid == rhs.instance_guid;
+        }), sample.end());
+
+    std::vector<Instance> running;
+    running.reserve(sample.size());
+    std::size_t result{};
+    auto prev = running_.begin();
+    auto curr = sample.begin();
+    while (prev != running_.end() || curr != sample.end()) {
+      if (curr == sample.end()
+        || (prev != running_.end()
+          && prev->task.instance_guid < curr->instance_guid)) {
+        emit(Event{Event::Kind::stopped, prev->task,
+          now - prev->started_at});
+        ++prev;
+        ++result;
+      } else if (prev == running_.end()
+        || curr->instance_guid < prev->task.instance_guid) {
+        emit(Event{Event::Kind::started, *curr, Duration{}});
+        running.push_back(Instance{std::move(*curr), now});
+        ++curr;
+        ++result;
+      } else {
+        running.push_back(Instance{std::move(*curr), prev->started_at});
+        ++prev;
+        ++curr;
+      }
+    }
+    running_ = std::move(running);
+
+    interval_ = result ? options_.min_interval :
+      std::min(interval_ * 2, options_.max_interval);
+    return result;
+  }
+
+  /// @returns The recommended interval before the next sample.
+  Duration interval() const noexcept
+  {
+    return interval_;
+  }
+
+  /// @returns The instances running as of the last sample ordered by GUID.
+  const std::vector<Instance>& running() const noexcept
+  {
+    return running_;
+  }
+
+private:
+  Options options_;
+  Duration interval_{};
+  std::vector<Instance> running_;
+
+  static bool less(const Running_task_sample& lhs,
+    const Running_task_sample& rhs) noexcept
+  {
+    return lhs.instance_guid < rhs.instance_guid;
+  }
+};
+
+} // namespace dmitigr::wincom::tasc::v2
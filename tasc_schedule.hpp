@@ -0,0 +1,778 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+/*
+ * This header is portable: it doesn't depend on Windows SDK and is intended
+ * for offline processing of the trigger snapshots produced by tasc.hpp.
+ */
+
+namespace dmitigr::wincom::tasc::v2 {
+
+/// The counterpart of TASK_TRIGGER_TYPE2.
+enum class Trigger_type : int {
+  event = 0,
+  time = 1,
+  daily = 2,
+  weekly = 3,
+  monthly = 4,
+  monthly_dow = 5,
+  idle = 6,
+  registration = 7,
+  boot = 8,
+  logon = 9,
+  session_state_change = 11,
+  custom_trigger_01 = 12
+};
+
+/**
+ * @brief The time scale of the schedule.
+ *
+ * @details Task Scheduler interprets boundaries without a zone designator in
+ * local time of the host, and so does `IRegisteredTask::get_NextRunTime()`.
+ * Thus, the schedule is expanded in the civil time of the host. Daylight
+ * saving time transitions are not taken into account. The boundaries with a
+ * zone designator are converted to this time scale explicitly (see
+ * `to_schedule_time()`).
+ */
+using Schedule_time = std::chrono::local_seconds;
+
+// -----------------------------------------------------------------------------
+// Parsing
+// -----------------------------------------------------------------------------
+
+} // namespace dmitigr::wincom::tasc::v2
+
+// The parser lives in wincom::detail, since the namespace tasc::v2::detail
+// would hide wincom::detail (the helpers of calls) for the users of tasc::v2.
+namespace dmitigr::wincom::detail {
+
+template<typename CharT>
+class Iso_parser final {
+public:
+  explicit Iso_parser(const std::basic_string_view<CharT> input) noexcept
+    : input_{input}
+  {}
+
+  bool is_end() const noexcept
+  {
+    return pos_ == input_.size();
+  }
+
+  bool skip(const char ch) noexcept
+  {
+    if (!is_end() && input_[pos_] == static_cast<CharT>(ch)) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  std::optional<char> peek() const noexcept
+  {
+    if (is_end() || input_[pos_] > 0x7f)
+      return std::nullopt;
+    return static_cast<char>(input_[pos_]);
+  }
+
+  /// @returns The number of `digits` digits, or the digits up to non-digit.
+  std::optional<std::int64_t> number(const std::size_t digits = 0) noexcept
+  {
+    std::int64_t result{};
+    std::size_t count{};
+    for (; !is_end() && (!digits || count < digits); ++pos_, ++count) {
+      const auto ch = input_[pos_];
+      if (ch < CharT('0') || ch > CharT('9'))
+        break;
+      else if (result > (std::numeric_limits<std::int64_t>::max() - 9) / 10)
+        return std::nullopt;
+      result = result*10 + (ch - CharT('0'));
+    }
+    if (!count || (digits && count != digits))
+      return std::nullopt;
+    return result;
+  }
+
+private:
+  std::basic_string_view<CharT> input_;
+  std::size_t pos_{};
+};
+
+} // namespace dmitigr::wincom::detail
+
+namespace dmitigr::wincom::tasc::v2 {
+
+/**
+ * @brief The trigger boundary.
+ *
+ * @details The boundary without a zone designator is in local time of the
+ * host (`Schedule_time`), and the boundary with one is in UTC.
+ *
+ * @see to_schedule_time().
+ */
+using Boundary = std::variant<Schedule_time, std::chrono::sys_seconds>;
+
+/**
+ * @returns The parsed boundary in form of `YYYY-MM-DDTHH:MM:SS[.fff][Z|±HH:MM]`
+ * as used by `ITrigger::get_StartBoundary()` and `ITrigger::get_EndBoundary()`.
+ * If the zone designator is present it is applied, and the result is
+ * `std::chrono::sys_seconds`, or `Schedule_time` otherwise.
+ *
+ * @throws `std::invalid_argument` on parse error.
+ */
+template<typename CharT>
+Boundary parse_boundary(const std::basic_string_view<CharT> input)
+{
+  using namespace std::chrono;
+  detail::Iso_parser<CharT> p{input};
+  const auto invalid = [input]
+  {
+    return std::invalid_argument{"cannot parse trigger boundary: invalid"
+      " format (" + std::to_string(input.size()) + " characters)"};
+  };
+
+  const auto yy = p.number(4);
+  if (!yy || !p.skip('-'))
+    throw invalid();
+  const auto mm = p.number(2);
+  if (!mm || !p.skip('-'))
+    throw invalid();
+  const auto dd = p.number(2);
+  if (!dd || !p.skip('T'))
+    throw invalid();
+  const auto hh = p.number(2);
+  if (!hh || !p.skip(':'))
+    throw invalid();
+  const auto mi = p.number(2);
+  if (!mi || !p.skip(':'))
+    throw invalid();
+  const auto ss = p.number(2);
+  if (!ss || *hh > 23 || *mi > 59 || *ss > 59)
+    throw invalid();
+  if (p.skip('.') && !p.number())
+    throw invalid();
+
+  const year_month_day ymd{year{static_cast<int>(*yy)},
+    month{static_cast<unsigned>(*mm)}, day{static_cast<unsigned>(*dd)}};
+  if (!ymd.ok())
+    throw invalid();
+
+  const auto time = hours{*hh} + minutes{*mi} + seconds{*ss};
+  Boundary result{local_days{ymd} + time};
+  if (p.skip('Z')) {
+    result = sys_days{ymd} + time;
+  } else if (const auto sign = p.peek(); sign == '+' || sign == '-') {
+    p.skip(*sign);
+    const auto oh = p.number(2);
+    if (!oh || !p.skip(':'))
+      throw invalid();
+    const auto om = p.number(2);
+    if (!om)
+      throw invalid();
+    const auto offset = hours{*oh} + minutes{*om};
+    result = sys_days{ymd} + time + (sign == '+' ? -offset : offset);
+  }
+  if (!p.is_end())
+    throw invalid();
+  return result;
+}
+
+/// @overload
+template<typename CharT>
+Boundary parse_boundary(const std::basic_string<CharT>& input)
+{
+  return parse_boundary(std::basic_string_view<CharT>{input});
+}
+
+/// @overload
+template<typename CharT>
+Boundary parse_boundary(const CharT* const input)
+{
+  return parse_boundary(std::basic_string_view<CharT>{input});
+}
+
+/**
+ * @returns The schedule time of `boundary`, assuming that the UTC offset of
+ * the host is `utc_offset`.
+ */
+constexpr Schedule_time to_schedule_time(const Boundary& boundary,
+  const std::chrono::seconds utc_offset) noexcept
+{
+  if (const auto* const local = std::get_if<Schedule_time>(&boundary))
+    return *local;
+  return Schedule_time{
+    std::get<std::chrono::sys_seconds>(boundary).time_since_epoch()
+    + utc_offset};
+}
+
+/**
+ * @returns The schedule time of `boundary`. The boundary in UTC is converted
+ * to local time of the host by using the time zone rules of the host at the
+ * instant of the boundary.
+ *
+ * @throws `std::out_of_range` if the boundary in UTC is not representable in
+ * local time of the host.
+ */
+inline Schedule_time to_schedule_time(const Boundary& boundary)
+{
+  using namespace std::chrono;
+  const auto* const utc = std::get_if<sys_seconds>(&boundary);
+  if (!utc)
+    return std::get<Schedule_time>(boundary);
+
+  const auto time = static_cast<std::time_t>(utc->time_since_epoch().count());
+  std::tm tm{};
+#ifdef _WIN32
+  const bool is_ok = !localtime_s(&tm, &time);
+#else
+  const bool is_ok = localtime_r(&time, &tm);
+#endif
+  if (!is_ok)
+    throw std::out_of_range{"cannot convert trigger boundary to local time"};
+  return local_days{year{tm.tm_year + 1900}/(tm.tm_mon + 1)/tm.tm_mday}
+    + hours{tm.tm_hour} + minutes{tm.tm_min} + seconds{tm.tm_sec};
+}
+
+/**
+ * @returns The parsed duration in form of `PnYnMnDTnHnMnS` as used by
+ * `IRepetitionPattern::get_Interval()`, `IRepetitionPattern::get_Duration()`
+ * and alike. Years and months are treated as 365 and 30 days respectively.
+ * Empty input denotes zero duration.
+ *
+ * @throws `std::invalid_argument` on parse error.
+ */
+template<typename CharT>
+std::chrono::seconds parse_duration(const std::basic_string_view<CharT> input)
+{
+  using namespace std::chrono;
+  if (input.empty())
+    return seconds{};
+
+  detail::Iso_parser<CharT> p{input};
+  const auto invalid = []
+  {
+    return std::invalid_argument{"cannot parse duration: invalid format"};
+  };
+
+  if (!p.skip('P'))
+    throw invalid();
+
+  seconds result{};
+  bool is_time{};
+  bool is_empty{true};
+  while (!p.is_end()) {
+    if (p.skip('T')) {
+      if (is_time)
+        throw invalid();
+      is_time = true;
+      continue;
+    }
+    const auto value = p.number();
+    const auto unit = p.peek();
+    if (!value || !unit)
+      throw invalid();
+    p.skip(*unit);
+    if (!is_time) {
+      switch (*unit) {
+      case 'Y': result += days{365 * *value}; break;
+      case 'M': result += days{30 * *value}; break;
+      case 'W': result += days{7 * *value}; break;
+      case 'D': result += days{*value}; break;
+      default: throw invalid();
+      }
+    } else {
+      switch (*unit) {
+      case 'H': result += hours{*value}; break;
+      case 'M': result += minutes{*value}; break;
+      case 'S': result += seconds{*value}; break;
+      default: throw invalid();
+      }
+    }
+    is_empty = false;
+  }
+  if (is_empty)
+    throw invalid();
+  return result;
+}
+
+/// @overload
+template<typename CharT>
+std::chrono::seconds parse_duration(const std::basic_string<CharT>& input)
+{
+  return parse_duration(std::basic_string_view<CharT>{input});
+}
+
+/// @overload
+template<typename CharT>
+std::chrono::seconds parse_duration(const CharT* const input)
+{
+  return parse_duration(std::basic_string_view<CharT>{input});
+}
+
+// -----------------------------------------------------------------------------
+// Trigger_snapshot
+// -----------------------------------------------------------------------------
+
+/// The plain value counterpart of `Repetition_pattern`.
+struct Repetition_snapshot final {
+  /// The zero value denotes no repetition.
+  std::chrono::seconds interval{};
+  /// The zero value denotes indefinite repetition.
+  std::chrono::seconds duration{};
+  bool is_stopped_at_the_end_of_duration{};
+
+  bool operator==(const Repetition_snapshot&) const = default;
+};
+
+/**
+ * @brief The plain value counterpart of `Trigger` and its time-based
+ * subtypes (`IDailyTrigger`, `IWeeklyTrigger`, `IMonthlyTrigger`,
+ * `IMonthlyDOWTrigger` and `ITimeTrigger`).
+ *
+ * @details Bit masks have the same layout as in Task Scheduler API, i.e. bit 0
+ * of `days_of_week` denotes Sunday, bit 0 of `months_of_year` denotes January,
+ * bit 0 of `days_of_month` denotes the first day of month and bit 0 of
+ * `weeks_of_month` denotes the first week of month.
+ */
+struct Trigger_snapshot final {
+  Trigger_type type{Trigger_type::time};
+  bool is_enabled{true};
+  std::optional<Schedule_time> start_boundary;
+  std::optional<Schedule_time> end_boundary;
+  std::chrono::seconds random_delay{};
+  Repetition_snapshot repetition;
+  std::int16_t days_interval{1};
+  std::int16_t weeks_interval{1};
+  std::int16_t days_of_week{};
+  std::int16_t months_of_year{};
+  std::int32_t days_of_month{};
+  std::int16_t weeks_of_month{};
+  bool is_run_on_last_day_of_month{};
+  bool is_run_on_last_week_of_month{};
+
+  /// @returns `true` if the trigger fires at the calendar-based times.
+  bool is_time_based() const noexcept
+  {
+    switch (type) {
+    case Trigger_type::time:
+    case Trigger_type::daily:
+    case Trigger_type::weekly:
+    case Trigger_type::monthly:
+    case Trigger_type::monthly_dow:
+      return is_enabled && start_boundary.has_value();
+    default:
+      return false;
+    }
+  }
+
+  bool operator==(const Trigger_snapshot&) const = default;
+};
+
+// -----------------------------------------------------------------------------
+// Fire_time_generator
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief A generator of the fire times of a trigger in ascending order.
+ *
+ * @details Each base occurrence (the trigger schedule itself) starts a chain
+ * of repetitions limited by the repetition duration. Indefinite repetition
+ * chains are limited by the next base occurrence. Overlapping chains are
+ * merged and duplicates are suppressed. Random delays are not applied.
+ */
+class Fire_time_generator final {
+public:
+  /// Constructs the generator of fire times not earlier than `from`.
+  explicit Fire_time_generator(const Trigger_snapshot& trigger,
+    const Schedule_time from = Schedule_time::min())
+    : trigger_{trigger}
+    , from_{from}
+  {
+    using namespace std::chrono;
+    if (!trigger_.is_time_based())
+      return;
+
+    if (trigger_.type == Trigger_type::daily && trigger_.days_interval < 1)
+      throw std::invalid_argument{"invalid days interval of daily trigger"};
+    else if (trigger_.type == Trigger_type::weekly
+      && trigger_.weeks_interval < 1)
+      throw std::invalid_argument{"invalid weeks interval of weekly trigger"};
+    else if (trigger_.repetition.interval < seconds{})
+      throw std::invalid_argument{"invalid repetition interval of trigger"};
+
+    const auto start = *trigger_.start_boundary;
+    start_day_ = floor<days>(start);
+    time_of_day_ = start - start_day_;
+
+    /*
+     * The base occurrences are sought from the one whose repetition chain
+     * may contain `from`. The single base of time trigger is never skipped,
+     * since its indefinite chain has no end.
+     */
+    const auto lookback = [this]() -> std::optional<seconds>
+    {
+      if (trigger_.repetition.interval == seconds{})
+        return seconds{};
+      else if (trigger_.repetition.duration > seconds{})
+        return trigger_.repetition.duration;
+
+      switch (trigger_.type) {
+      case Trigger_type::time: return std::nullopt;
+      case Trigger_type::daily: return days{trigger_.days_interval};
+      case Trigger_type::weekly: return weeks{trigger_.weeks_interval};
+      default: return days{366};
+      }
+    }();
+    seek(lookback && from_ > Schedule_time::min() + *lookback ?
+      from_ - *lookback : Schedule_time::min());
+    pending_ = next_base().value_or(Schedule_time::max());
+  }
+
+  /// @returns The next fire time, or `std::nullopt` if there are no more.
+  std::optional<Schedule_time> next()
+  {
+    while (true) {
+      // Admit chains starting not later than the earliest active one.
+      while (pending_ != Schedule_time::max() &&
+        (heap_.empty() || pending_ <= heap_.front().next)) {
+        const auto base = pending_;
+        pending_ = next_base().value_or(Schedule_time::max());
+        const auto& rep = trigger_.repetition;
+        Chain chain{base, rep.interval == std::chrono::seconds{}
+          ? base + std::chrono::seconds{1}
+          : rep.duration > std::chrono::seconds{} ? base + rep.duration
+          : pending_};
+        if (rep.interval > std::chrono::seconds{} && chain.next < from_) {
+          // Skip to the first repetition not earlier than `from`.
+          const auto n = (from_ - chain.next + rep.interval
+            - std::chrono::seconds{1}) / rep.interval;
+          chain.next += n * rep.interval;
+        }
+        if (chain.next < chain.end)
+          push(chain);
+      }
+      if (heap_.empty())
+        return std::nullopt;
+
+      auto chain = pop();
+      const auto result = chain.next;
+      if (trigger_.end_boundary && result > *trigger_.end_boundary) {
+        heap_.clear();
+        pending_ = Schedule_time::max();
+        return std::nullopt;
+      }
+
+      if (trigger_.repetition.interval > std::chrono::seconds{}) {
+        chain.next += trigger_.repetition.interval;
+        if (chain.next < chain.end)
+          push(chain);
+      }
+
+      if (result < from_ || result <= last_)
+        continue;
+
+      last_ = result;
+      return result;
+    }
+  }
+
+private:
+  struct Chain final {
+    Schedule_time next;
+    Schedule_time end;
+  };
+
+  static constexpr int max_empty_periods_{120};
+
+  Trigger_snapshot trigger_;
+  Schedule_time from_;
+  std::chrono::local_days start_day_;
+  std::chrono::seconds time_of_day_{};
+
+  // Base occurrence cursor.
+  std::chrono::local_days period_start_;
+  std::uint32_t period_mask_{};
+  Schedule_time floor_;
+  bool is_exhausted_{};
+
+  // The next base occurrence, or `Schedule_time::max()` if none.
+  Schedule_time pending_{Schedule_time::max()};
+  std::vector<Chain> heap_;
+  // The last fire time returned, or `Schedule_time::min()` if none.
+  Schedule_time last_{Schedule_time::min()};
+
+  static bool greater(const Chain& lhs, const Chain& rhs) noexcept
+  {
+    return lhs.next > rhs.next;
+  }
+
+  void push(const Chain& chain)
+  {
+    heap_.push_back(chain);
+    std::push_heap(heap_.begin(), heap_.end(), &greater);
+  }
+
+  Chain pop()
+  {
+    std::pop_heap(heap_.begin(), heap_.end(), &greater);
+    const auto result = heap_.back();
+    heap_.pop_back();
+    return result;
+  }
+
+  /// Positions the cursor to the period containing `t`.
+  void seek(const Schedule_time t)
+  {
+    using namespace std::chrono;
+    const auto start = *trigger_.start_boundary;
+    floor_ = std::max(start, t);
+    const auto day = floor<days>(floor_);
+    switch (trigger_.type) {
+    case Trigger_type::time:
+      period_start_ = start_day_;
+      break;
+    case Trigger_type::daily: {
+      const auto n = (day - start_day_).count() / trigger_.days_interval;
+      period_start_ = start_day_ + days{n * trigger_.days_interval};
+      break;
+    }
+    case Trigger_type::weekly: {
+      const auto week0 = start_day_ - (weekday{start_day_} - Sunday);
+      const auto len = 7 * trigger_.weeks_interval;
+      period_start_ = week0 + days{(day - week0).count() / len * len};
+      break;
+    }
+    case Trigger_type::monthly:
+    case Trigger_type::monthly_dow: {
+      const year_month_day ymd{day};
+      period_start_ = local_days{ymd.year()/ymd.month()/1};
+      break;
+    }
+    default:
+      is_exhausted_ = true;
+      return;
+    }
+    period_mask_ = mask(period_start_);
+  }
+
+  /// @returns The bit mask of days of the period started at `start`.
+  std::uint32_t mask(const std::chrono::local_days start) const
+  {
+    using namespace std::chrono;
+    switch (trigger_.type) {
+    case Trigger_type::time:
+      return start == start_day_;
+    case Trigger_type::daily:
+      return 1;
+    case Trigger_type::weekly:
+      return static_cast<std::uint32_t>(trigger_.days_of_week) & 0x7f;
+    case Trigger_type::monthly:
+    case Trigger_type::monthly_dow: {
+      const year_month_day ymd{start};
+      const auto mon = static_cast<unsigned>(ymd.month());
+      if (!(static_cast<std::uint32_t>(trigger_.months_of_year) & (1u << (mon - 1))))
+        return 0;
+
+      const auto last = static_cast<unsigned>(
+        (ymd.year()/ymd.month()/std::chrono::last).day());
+      const auto valid = static_cast<std::uint32_t>((std::uint64_t{1} << last) - 1);
+      std::uint32_t result{};
+      if (trigger_.type == Trigger_type::monthly) {
+        result = static_cast<std::uint32_t>(trigger_.days_of_month);
+        if (trigger_.is_run_on_last_day_of_month)
+          result |= 1u << (last - 1);
+      } else {
+        const auto first_wd = weekday{start};
+        const auto wdays = static_cast<unsigned>(trigger_.days_of_week) & 0x7f;
+        const auto wmonth = static_cast<unsigned>(trigger_.weeks_of_month) & 0xf;
+        for (unsigned wd{}; wd < 7; ++wd) {
+          if (!(wdays & (1u << wd)))
+            continue;
+          // 0-based day of month of the first occurrence of weekday `wd`.
+          const auto first = (weekday{wd} - first_wd).count();
+          for (unsigned w{}; w < 4; ++w) {
+            if (wmonth & (1u << w))
+              result |= 1u << (first + 7*w);
+          }
+          if (trigger_.is_run_on_last_week_of_month) {
+            const auto offset = (last - 1 - first) / 7 * 7;
+            result |= 1u << (first + offset);
+          }
+        }
+      }
+      return result & valid;
+    }
+    default:
+      return 0;
+    }
+  }
+
+  void advance_period()
+  {
+    using namespace std::chrono;
+    switch (trigger_.type) {
+    case Trigger_type::time:
+      is_exhausted_ = true;
+      return;
+    case Trigger_type::daily:
+      period_start_ += days{trigger_.days_interval};
+      break;
+    case Trigger_type::weekly:
+      period_start_ += weeks{trigger_.weeks_interval};
+      break;
+    case Trigger_type::monthly:
+    case Trigger_type::monthly_dow: {
+      const year_month_day ymd{period_start_};
+      period_start_ = local_days{(ymd.year()/ymd.month() + months{1})/1};
+      break;
+    }
+    default:
+      is_exhausted_ = true;
+      return;
+    }
+    period_mask_ = mask(period_start_);
+  }
+
+  std::optional<Schedule_time> next_base()
+  {
+    int empty_periods{};
+    while (!is_exhausted_) {
+      if (!period_mask_) {
+        if (++empty_periods > max_empty_periods_)
+          is_exhausted_ = true;
+        else
+          advance_period();
+        continue;
+      }
+      empty_periods = 0;
+
+      const auto bit = std::countr_zero(period_mask_);
+      period_mask_ &= period_mask_ - 1;
+      const auto result = period_start_ + std::chrono::days{bit} + time_of_day_;
+      if (result < floor_)
+        continue;
+      else if (trigger_.end_boundary && result > *trigger_.end_boundary)
+        is_exhausted_ = true;
+      else
+        return result;
+    }
+    return std::nullopt;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Batch expansion
+// -----------------------------------------------------------------------------
+
+/// The fire times of many triggers stored contiguously.
+struct Fire_times final {
+  /// Fire times in seconds since the epoch of `Schedule_time`.
+  std::vector<std::int64_t> seconds;
+  /// `seconds[offsets[i], offsets[i + 1])` are the fire times of trigger `i`.
+  std::vector<std::size_t> offsets;
+
+  /// @returns The fire times of trigger `index`.
+  std::span<const std::int64_t> of(const std::size_t index) const
+  {
+    return std::span{seconds}.subspan(offsets.at(index),
+      offsets.at(index + 1) - offsets[index]);
+  }
+};
+
+/**
+ * @returns Up to `count` fire times of each of `triggers` which are not
+ * earlier than `from`.
+ *
+ * @remarks The daily triggers without repetition (the most common case) are
+ * expanded by the straight-line loop the compiler is able to vectorize.
+ */
+inline Fire_times expand(const std::span<const Trigger_snapshot> triggers,
+  const Schedule_time from, const std::size_t count)
+{
+  using namespace std::chrono;
+  Fire_times result;
+  result.offsets.reserve(triggers.size() + 1);
+  result.offsets.push_back(0);
+  for (const auto& trigger : triggers) {
+    if (trigger.type == Trigger_type::daily && trigger.is_time_based()
+      && trigger.repetition.interval == seconds{} && trigger.days_interval > 0) {
+      const auto start = trigger.start_boundary->time_since_epoch().count();
+      const std::int64_t period = days{trigger.days_interval} / seconds{1};
+      const auto origin = from.time_since_epoch().count();
+      const std::int64_t k = origin > start ? (origin - start + period - 1) / period : 0;
+      const auto first = start + k*period;
+      auto n = static_cast<std::int64_t>(count);
+      if (trigger.end_boundary) {
+        const auto end = trigger.end_boundary->time_since_epoch().count();
+        n = end < first ? 0 : std::min(n, (end - first) / period + 1);
+      }
+      const auto offset = result.seconds.size();
+      result.seconds.resize(offset + static_cast<std::size_t>(n));
+      auto* const out = result.seconds.data() + offset;
+      for (std::int64_t i{}; i < n; ++i)
+        out[i] = first + i*period;
+    } else {
+      Fire_time_generator gen{trigger, from};
+      for (std::size_t i{}; i < count; ++i) {
+        if (const auto t = gen.next())
+          result.seconds.push_back(t->time_since_epoch().count());
+        else
+          break;
+      }
+    }
+    result.offsets.push_back(result.seconds.size());
+  }
+  return result;
+}
+
+/**
+ * @returns The earliest fire time of `triggers` not earlier than `from`.
+ *
+ * @remarks The result is comparable with `Registered_task::next_run_time()`
+ * recorded at `from` (see `to_local_time()` of date.hpp) and thus can be used
+ * to validate the snapshots.
+ */
+inline std::optional<Schedule_time>
+next_fire_time(const std::span<const Trigger_snapshot> triggers,
+  const Schedule_time from)
+{
+  std::optional<Schedule_time> result;
+  for (const auto& trigger : triggers) {
+    if (const auto t = Fire_time_generator{trigger, from}.next()) {
+      if (!result || *t < *result)
+        result = t;
+    }
+  }
+  return result;
+}
+
+} // namespace dmitigr::wincom::tasc::v2
@@ -0,0 +1,270 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "hash.hpp"
+#include "tasc_schedule.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dmitigr::wincom::tasc::v2 {
+
+/// The counterpart of TASK_ACTION_TYPE.
+enum class Action_type : int {
+  exec = 0,
+  com_handler = 5,
+  send_email = 6,
+  show_message = 7
+};
+
+/// The counterpart of TASK_LOGON_TYPE.
+enum class Logon_type : int {
+  none = 0,
+  password = 1,
+  s4u = 2,
+  interactive_token = 3,
+  group = 4,
+  service_account = 5,
+  interactive_token_or_password = 6
+};
+
+/// The counterpart of TASK_RUNLEVEL_TYPE.
+enum class Run_level : int {
+  lua = 0,
+  highest = 1
+};
+
+/// The counterpart of TASK_INSTANCES_POLICY.
+enum class Instances_policy : int {
+  parallel = 0,
+  queue = 1,
+  ignore_new = 2,
+  stop_existing = 3
+};
+
+/// The counterpart of TASK_COMPATIBILITY.
+enum class Compatibility : int {
+  at = 0,
+  v1 = 1,
+  v2 = 2,
+  v2_1 = 3,
+  v2_2 = 4,
+  v2_3 = 5,
+  v2_4 = 6
+};
+
+/// A reference to the text stored in the arena of snapshot.
+struct Snapshot_text final {
+  std::uint32_t offset{};
+  std::uint32_t size{};
+
+  bool operator==(const Snapshot_text&) const = default;
+};
+
+/// The plain value counterpart of `Registration_info`.
+struct Registration_snapshot final {
+  Snapshot_text author;
+  Snapshot_text date;
+  Snapshot_text description;
+  Snapshot_text documentation;
+  Snapshot_text source;
+  Snapshot_text uri;
+  Snapshot_text version;
+
+  bool operator==(const Registration_snapshot&) const = default;
+};
+
+/// The plain value counterpart of `Principal`.
+struct Principal_snapshot final {
+  Snapshot_text id;
+  Snapshot_text display_name;
+  Snapshot_text user_id;
+  Snapshot_text group_id;
+  Logon_type logon_type{Logon_type::none};
+  Run_level run_level{Run_level::lua};
+
+  bool operator==(const Principal_snapshot&) const = default;
+};
+
+/// The plain value counterpart of `Task_settings`.
+struct Settings_snapshot final {
+  bool is_enabled{};
+  bool is_hidden{};
+  bool is_demand_start_allowed{};
+  bool is_hard_terminate_allowed{};
+  bool is_start_when_available{};
+  bool is_run_only_if_network_available{};
+  bool is_run_only_if_idle{};
+  bool is_wake_to_run{};
+  bool is_start_disallowed_on_batteries{};
+  bool is_stop_if_going_on_batteries{};
+  int priority{};
+  int restart_count{};
+  std::chrono::seconds restart_interval{};
+  /// The zero value denotes no limit.
+  std::chrono::seconds execution_time_limit{};
+  std::chrono::seconds delete_expired_task_after{};
+  Instances_policy multiple_instances{Instances_policy::parallel};
+  Compatibility compatibility{Compatibility::v2};
+
+  bool operator==(const Settings_snapshot&) const = default;
+};
+
+/**
+ * @brief The plain value counterpart of `Action` and its subtypes.
+ *
+ * @details `path`, `arguments` and `working_directory` are set for exec
+ * actions only, while `class_id` and `data` are set for COM handler actions
+ * only.
+ */
+struct Action_snapshot final {
+  Action_type type{Action_type::exec};
+  Snapshot_text id;
+  Snapshot_text path;
+  Snapshot_text arguments;
+  Snapshot_text working_directory;
+  Snapshot_text class_id;
+  Snapshot_text data;
+
+  bool operator==(const Action_snapshot&) const = default;
+};
+
+/**
+ * @brief The plain value counterpart of `Task_definition`.
+ *
+ * @details All the texts are stored in the single arena and are referenced by
+ * offsets, so the snapshot contains neither COM proxies nor pointers and
+ * is safe to copy and move across threads. Since `Task_definition::snapshot()`
+ * always fills the arena in the same order, the snapshots it produces are
+ * equal if and only if their contents are equal.
+ */
+class Task_definition_snapshot final {
+public:
+  Registration_snapshot registration;
+  Principal_snapshot principal;
+  Settings_snapshot settings;
+  std::vector<Action_snapshot> actions;
+  std::vector<Trigger_snapshot> triggers;
+
+  /// Stores `value` in the arena.
+  Snapshot_text intern(const std::wstring_view value)
+  {
+    if (arena_.size() + value.size() > std::numeric_limits<std::uint32_t>::max())
+      throw std::length_error{"snapshot arena overflow"};
+    const Snapshot_text result{static_cast<std::uint32_t>(arena_.size()),
+      static_cast<std::uint32_t>(value.size())};
+    arena_.append(value);
+    return result;
+  }
+
+  /// @returns The text referenced by `value`.
+  std::wstring_view text(const Snapshot_text value) const noexcept
+  {
+    return std::wstring_view{arena_}.substr(value.offset, value.size);
+  }
+
+  /// @returns The arena.
+  std::wstring_view arena() const noexcept
+  {
+    return arena_;
+  }
+
+  /// @returns The hash of the contents.
+  std::uint64_t hash() const noexcept
+  {
+    Fnv1a result;
+    result.add(std::wstring_view{arena_});
+    const auto add_text = [&result](const Snapshot_text& text)
+    {
+      result.add_integer(text.offset).add_integer(text.size);
+    };
+    const auto add_duration = [&result](const std::chrono::seconds value)
+    {
+      result.add_integer(value.count());
+    };
+    const auto add_time = [&result](const std::optional<Schedule_time>& value)
+    {
+      result.add_integer(value.has_value())
+        .add_integer(value ? value->time_since_epoch().count() : 0);
+    };
+
+    for (const auto* const text : {&registration.author, &registration.date,
+        &registration.description, &registration.documentation,
+        &registration.source, &registration.uri, &registration.version,
+        &principal.id, &principal.display_name, &principal.user_id,
+        &principal.group_id})
+      add_text(*text);
+    result.add_integer(static_cast<int>(principal.logon_type))
+      .add_integer(static_cast<int>(principal.run_level));
+
+    const auto& s = settings;
+    for (const bool flag : {s.is_enabled, s.is_hidden, s.is_demand_start_allowed,
+        s.is_hard_terminate_allowed, s.is_start_when_available,
+        s.is_run_only_if_network_available, s.is_run_only_if_idle,
+        s.is_wake_to_run, s.is_start_disallowed_on_batteries,
+        s.is_stop_if_going_on_batteries})
+      result.add_integer(flag);
+    result.add_integer(s.priority).add_integer(s.restart_count);
+    add_duration(s.restart_interval);
+    add_duration(s.execution_time_limit);
+    add_duration(s.delete_expired_task_after);
+    result.add_integer(static_cast<int>(s.multiple_instances))
+      .add_integer(static_cast<int>(s.compatibility));
+
+    result.add_integer(actions.size());
+    for (const auto& a : actions) {
+      result.add_integer(static_cast<int>(a.type));
+      for (const auto* const text : {&a.id, &a.path, &a.arguments,
+          &a.working_directory, &a.class_id, &a.data})
+        add_text(*text);
+    }
+
+    result.add_integer(triggers.size());
+    for (const auto& t : triggers) {
+      result.add_integer(static_cast<int>(t.type)).add_integer(t.is_enabled);
+      add_time(t.start_boundary);
+      add_time(t.end_boundary);
+      add_duration(t.random_delay);
+      add_duration(t.repetition.interval);
+      add_duration(t.repetition.duration);
+      result.add_integer(t.repetition.is_stopped_at_the_end_of_duration)
+        .add_integer(t.days_interval)
+        .add_integer(t.weeks_interval)
+        .add_integer(t.days_of_week)
+        .add_integer(t.months_of_year)
+        .add_integer(t.days_of_month)
+        .add_integer(t.weeks_of_month)
+        .add_integer(t.is_run_on_last_day_of_month)
+        .add_integer(t.is_run_on_last_week_of_month);
+    }
+    return result.value();
+  }
+
+  bool operator==(const Task_definition_snapshot&) const = default;
+
+private:
+  std::wstring arena_;
+};
+
+} // namespace dmitigr::wincom::tasc::v2
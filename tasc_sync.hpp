@@ -0,0 +1,207 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "hash.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom::tasc::v2 {
+
+/// The counterpart of TASK_STATE.
+enum class Task_state : int {
+  unknown = 0,
+  disabled = 1,
+  queued = 2,
+  ready = 3,
+  running = 4
+};
+
+/// The cheap signature of a registered task used for change detection.
+struct Task_signature final {
+  std::wstring path;
+  Task_state state{Task_state::unknown};
+  /// The `DATE` value as returned by `Registered_task::last_run_time()`.
+  double last_run_time{};
+  /// The hash of XML representation of the task definition.
+  std::uint64_t xml_hash{};
+
+  bool operator==(const Task_signature&) const = default;
+};
+
+/// @returns The hash of XML representation of the task definition.
+template<typename CharT>
+std::uint64_t xml_hash(const std::basic_string_view<CharT> xml) noexcept
+{
+  return fnv1a(xml);
+}
+
+/// A kind of change of a task.
+enum class Task_change {
+  added,
+  removed,
+  modified
+};
+
+/// A change of a task.
+template<class Definition>
+struct Task_delta final {
+  /// Bits of `changed` of modified task.
+  enum Field : unsigned {
+    state = 0x1,
+    last_run_time = 0x2,
+    definition = 0x4
+  };
+
+  Task_change change{Task_change::added};
+  /// The field mask of modified task.
+  unsigned changed{};
+  /// The signature. (The previous one for removed task.)
+  Task_signature signature;
+  /// The definition of added task, or of modified task with changed definition.
+  std::optional<Definition> task_definition;
+};
+
+/// The statistics of a synchronization.
+struct Sync_stats final {
+  std::size_t added{};
+  std::size_t removed{};
+  std::size_t modified{};
+  std::size_t unchanged{};
+  /// The number of definitions fetched.
+  std::size_t fetched{};
+};
+
+/**
+ * @brief An incremental synchronizer of task inventory.
+ *
+ * @details The synchronizer keeps the signatures seen by the last successful
+ * call of sync(). The full definitions are fetched only for tasks which are
+ * added or which XML hash is changed.
+ */
+class Inventory_sync final {
+public:
+  /**
+   * @brief Compares `current` with the signatures of the previous sync and
+   * emits the deltas.
+   *
+   * @param current The signatures of the current inventory.
+   * @param fetch The callable of signature `Definition(const Task_signature&)`
+   * which fetches the definition of the task.
+   * @param emit The callable of signature `void(Task_delta<Definition>&&)`.
+   *
+   * @returns The statistics of the synchronization.
+   *
+   * @remarks If either `fetch` or `emit` throws, the previous state is kept,
+   * so the next call emits the same deltas again.
+   */
+  template<class Fetch, class Emit>
+  Sync_stats sync(std::vector<Task_signature> current, Fetch&& fetch,
+    Emit&& emit)
+  {
+    using Definition = std::decay_t<std::invoke_result_t<Fetch&,
+      const Task_signature&>>;
+    using Delta = Task_delta<Definition>;
+
+    std::sort(current.begin(), current.end(), &less);
+    current.erase(std::unique(current.begin(), current.end(),
+        [](const auto& lhs, const auto& rhs){return lhs.path == rhs.path;}),
+      current.end());
+
+    Sync_stats stats;
+    const auto added = [&](const Task_signature& sig)
+    {
+      emit(Delta{Task_change::added, 0, sig, fetch(sig)});
+      ++stats.added;
+      ++stats.fetched;
+    };
+    const auto removed = [&](const Task_signature& sig)
+    {
+      emit(Delta{Task_change::removed, 0, sig, std::nullopt});
+      ++stats.removed;
+    };
+
+    auto prev = previous_.cbegin();
+    auto curr = current.cbegin();
+    while (prev != previous_.cend() || curr != current.cend()) {
+      if (prev == previous_.cend())
+        added(*curr++);
+      else if (curr == current.cend())
+        removed(*prev++);
+      else if (const auto cmp = prev->path.compare(curr->path); cmp > 0)
+        added(*curr++);
+      else if (cmp < 0)
+        removed(*prev++);
+      else {
+        unsigned changed{};
+        if (prev->state != curr->state)
+          changed |= Delta::state;
+        if (prev->last_run_time != curr->last_run_time)
+          changed |= Delta::last_run_time;
+        if (prev->xml_hash != curr->xml_hash)
+          changed |= Delta::definition;
+
+        if (changed) {
+          std::optional<Definition> definition;
+          if (changed & Delta::definition) {
+            definition.emplace(fetch(*curr));
+            ++stats.fetched;
+          }
+          emit(Delta{Task_change::modified, changed, *curr,
+            std::move(definition)});
+          ++stats.modified;
+        } else
+          ++stats.unchanged;
+        ++prev;
+        ++curr;
+      }
+    }
+
+    previous_ = std::move(current);
+    return stats;
+  }
+
+  /// @returns The signatures of the last successful sync ordered by path.
+  const std::vector<Task_signature>& signatures() const noexcept
+  {
+    return previous_;
+  }
+
+  /// Forgets the previous state, so the next sync() emits all tasks as added.
+  void reset() noexcept
+  {
+    previous_.clear();
+  }
+
+private:
+  std::vector<Task_signature> previous_;
+
+  static bool less(const Task_signature& lhs, const Task_signature& rhs) noexcept
+  {
+    return lhs.path < rhs.path;
+  }
+};
+
+} // namespace dmitigr::wincom::tasc::v2
@@ -0,0 +1,277 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../apartment_pool.hpp"
+#include "unit.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace w = dmitigr::wincom;
+
+namespace {
+
+/// The log of the events of the stub apartments.
+class Log final {
+public:
+  void add(std::string event)
+  {
+    const std::lock_guard lg{mutex_};
+    events_.push_back(std::move(event));
+  }
+
+  std::vector<std::string> events() const
+  {
+    const std::lock_guard lg{mutex_};
+    return events_;
+  }
+
+  static Log& instance()
+  {
+    static Log result;
+    return result;
+  }
+
+  void clear()
+  {
+    const std::lock_guard lg{mutex_};
+    events_.clear();
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::vector<std::string> events_;
+};
+
+inline std::atomic_int apartment_failures;
+
+/// The stub of the COM apartment.
+struct Apartment final {
+  explicit Apartment(const w::Apartment_model model)
+  {
+    if (apartment_failures > 0 && apartment_failures-- > 0)
+      throw std::runtime_error{"CoInitializeEx failed"};
+    Log::instance().add(model == w::Apartment_model::multithreaded ?
+      "init mta" : "init sta");
+  }
+
+  ~Apartment()
+  {
+    Log::instance().add("uninit");
+  }
+};
+
+/// The stub of a proxy owned by the apartment.
+struct Proxy final {
+  ~Proxy()
+  {
+    if (is_owner)
+      Log::instance().add("release");
+  }
+
+  Proxy() = default;
+  Proxy(Proxy&& rhs) noexcept
+    : is_owner{rhs.is_owner}
+  {
+    rhs.is_owner = false;
+  }
+
+  bool is_owner{true};
+};
+
+using Pool = w::Basic_apartment_pool<Apartment>;
+
+Pool::Options options(const std::size_t worker_count,
+  const w::Apartment_model model = w::Apartment_model::multithreaded)
+{
+  Pool::Options result;
+  result.worker_count = worker_count;
+  result.model = model;
+  return result;
+}
+
+void test_submit()
+{
+  DMITIGR_WINCOM_CHECK(!w::Apartment_context::current());
+  Pool pool{options(4)};
+  DMITIGR_WINCOM_CHECK(pool.worker_count() == 4);
+
+  std::vector<std::future<int>> results;
+  for (int i{}; i < 100; ++i)
+    results.push_back(pool.submit([i](w::Apartment_context& ctx)
+    {
+      DMITIGR_WINCOM_CHECK(w::Apartment_context::current() == &ctx);
+      return i * 2;
+    }));
+  for (int i{}; i < 100; ++i)
+    DMITIGR_WINCOM_CHECK(results[i].get() == i * 2);
+
+  auto error = pool.submit([](w::Apartment_context&)
+  {
+    throw std::runtime_error{"task failed"};
+  });
+  DMITIGR_WINCOM_CHECK_THROW(std::runtime_error, error.get());
+
+  DMITIGR_WINCOM_CHECK_THROW(std::out_of_range,
+    pool.submit([](w::Apartment_context&){}, w::Affinity::require(4)));
+  DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument, Pool{options(0)});
+}
+
+void test_affinity()
+{
+  Pool pool{options(3, w::Apartment_model::apartment_threaded)};
+  std::vector<std::future<std::size_t>> results;
+  for (std::size_t i{}; i < 300; ++i)
+    results.push_back(pool.submit([](w::Apartment_context& ctx)
+    {
+      DMITIGR_WINCOM_CHECK(ctx.model()
+        == w::Apartment_model::apartment_threaded);
+      return ctx.worker_index();
+    }, w::Affinity::require(i % 3)));
+  for (std::size_t i{}; i < results.size(); ++i)
+    DMITIGR_WINCOM_CHECK(results[i].get() == i % 3);
+
+  // The tasks submitted by a worker are queued to that worker (the other
+  // workers are blocked so they cannot steal).
+  std::promise<void> unblock;
+  std::shared_future<void> unblocked{unblock.get_future()};
+  std::vector<std::future<void>> blockers;
+  for (const std::size_t index : {0, 2})
+    blockers.push_back(pool.submit([unblocked](w::Apartment_context&)
+    {
+      unblocked.wait();
+    }, w::Affinity::require(index)));
+  auto nested = pool.submit([&pool](w::Apartment_context&)
+  {
+    return pool.submit([](w::Apartment_context& ctx)
+    {
+      return ctx.worker_index();
+    });
+  }, w::Affinity::require(1));
+  DMITIGR_WINCOM_CHECK(nested.get().get() == 1);
+  unblock.set_value();
+  for (auto& blocker : blockers)
+    blocker.get();
+}
+
+void test_stealing()
+{
+  Pool pool{options(2)};
+  std::promise<void> unblock;
+  std::shared_future<void> unblocked{unblock.get_future()};
+  std::promise<void> blocked;
+  auto blocker = pool.submit([&blocked, unblocked](w::Apartment_context&)
+  {
+    blocked.set_value();
+    unblocked.wait();
+  }, w::Affinity::require(0));
+  blocked.get_future().wait();
+
+  // Worker 0 is busy, so its tasks are stolen by worker 1.
+  std::vector<std::future<std::size_t>> results;
+  for (int i{}; i < 50; ++i)
+    results.push_back(pool.submit([](w::Apartment_context& ctx)
+    {
+      return ctx.worker_index();
+    }, w::Affinity::prefer(0)));
+  for (auto& result : results)
+    DMITIGR_WINCOM_CHECK(result.get() == 1);
+  DMITIGR_WINCOM_CHECK(pool.stats(1).stolen == 50);
+
+  // The strict tasks wait for their worker.
+  auto pinned = pool.submit([](w::Apartment_context& ctx)
+  {
+    return ctx.worker_index();
+  }, w::Affinity::require(0));
+  DMITIGR_WINCOM_CHECK(pinned.wait_for(std::chrono::milliseconds{50})
+    == std::future_status::timeout);
+  unblock.set_value();
+  DMITIGR_WINCOM_CHECK(pinned.get() == 0);
+  blocker.get();
+  DMITIGR_WINCOM_CHECK(!pool.stats(0).stolen);
+}
+
+void test_shutdown_order()
+{
+  Log::instance().clear();
+  std::atomic_int completed{};
+  {
+    Pool pool{options(1)};
+    pool.submit([](w::Apartment_context& ctx)
+    {
+      ctx.local<Proxy>();
+      DMITIGR_WINCOM_CHECK(&ctx.local<Proxy>() == &ctx.local<Proxy>());
+    }).get();
+    for (int i{}; i < 1000; ++i)
+      pool.submit([&completed](w::Apartment_context&){++completed;});
+  }
+  // The queued tasks are completed, and the proxies are released before
+  // the apartment is destroyed.
+  DMITIGR_WINCOM_CHECK(completed == 1000);
+  DMITIGR_WINCOM_CHECK(Log::instance().events()
+    == std::vector<std::string>{"init mta", "release", "uninit"});
+}
+
+void test_start_failures()
+{
+  Log::instance().clear();
+  apartment_failures = 1;
+  DMITIGR_WINCOM_CHECK_THROW(std::runtime_error, Pool{options(3)});
+  apartment_failures = 0;
+
+  // The started workers are stopped with their apartments destroyed.
+  auto events = Log::instance().events();
+  DMITIGR_WINCOM_CHECK(events.size() == 4);
+  DMITIGR_WINCOM_CHECK(std::count(events.begin(), events.end(), "uninit")
+    == 2);
+
+  Log::instance().clear();
+  auto opts = options(2);
+  opts.on_start = [](w::Apartment_context& ctx)
+  {
+    ctx.local<Proxy>();
+    if (ctx.worker_index() == 1)
+      throw std::runtime_error{"on_start failed"};
+  };
+  DMITIGR_WINCOM_CHECK_THROW(std::runtime_error, Pool{opts});
+  events = Log::instance().events();
+  DMITIGR_WINCOM_CHECK(std::count(events.begin(), events.end(), "release")
+    == 2);
+  DMITIGR_WINCOM_CHECK(std::count(events.begin(), events.end(), "uninit")
+    == 2);
+}
+
+} // namespace
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    test_submit();
+    test_affinity();
+    test_stealing();
+    test_shutdown_order();
+    test_start_failures();
+  });
+}
@@ -0,0 +1,551 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../async_queue.hpp"
+#include "../fake/object.hpp"
+#include "../object.hpp"
+#include "unit.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// The asynchronous interface generated by MIDL for `IFoo` with `async_uuid`.
+struct AsyncIFoo : IUnknown {
+  virtual HRESULT Begin_Bar(LONG value) = 0;
+  virtual HRESULT Finish_Bar(LONG* result) = 0;
+};
+DMITIGR_WINCOM_FAKE_INTERFACE(AsyncIFoo, IUnknown);
+
+namespace fake = dmitigr::wincom::fake;
+namespace test = dmitigr::wincom::test;
+namespace w = dmitigr::wincom;
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// Basic_async_queue
+// -----------------------------------------------------------------------------
+
+/// The state of the call shared with the test.
+struct State final {
+  Clock::time_point completion;
+  int value{};
+  bool is_begin_failed{};
+  bool is_finish_failed{};
+  bool is_begun{};
+  bool is_cancelled{};
+  bool is_finished{};
+};
+
+/// The number of the calls begun and not finished.
+int in_flight;
+
+/// The call completed by the clock.
+template<class R>
+class Call final {
+public:
+  using Result = R;
+
+  explicit Call(std::shared_ptr<State> state)
+    : state_{std::move(state)}
+  {}
+
+  void begin()
+  {
+    if (state_->is_begin_failed)
+      throw std::runtime_error{"cannot begin"};
+    state_->is_begun = true;
+    ++in_flight;
+  }
+
+  bool is_completed()
+  {
+    return Clock::now() >= state_->completion;
+  }
+
+  Result finish()
+  {
+    DMITIGR_WINCOM_CHECK(is_completed() && !state_->is_finished);
+    state_->is_finished = true;
+    --in_flight;
+    if (state_->is_cancelled)
+      throw std::runtime_error{"cancelled"};
+    else if (state_->is_finish_failed)
+      throw std::runtime_error{"failed"};
+    if constexpr (!std::is_void_v<Result>)
+      return state_->value;
+  }
+
+  void cancel() noexcept
+  {
+    state_->is_cancelled = true;
+    state_->completion = std::min(state_->completion, Clock::now());
+  }
+
+  static std::size_t wait_any(const std::span<Call* const> calls,
+    const milliseconds timeout)
+  {
+    DMITIGR_WINCOM_CHECK(!calls.empty());
+    const auto i = std::min_element(calls.begin(), calls.end(),
+      [](const Call* const lhs, const Call* const rhs)
+      {
+        return lhs->state_->completion < rhs->state_->completion;
+      });
+    const auto completion = (*i)->state_->completion;
+    if (completion - Clock::now() > timeout) {
+      std::this_thread::sleep_for(timeout);
+      return calls.size();
+    }
+    std::this_thread::sleep_until(completion);
+    return static_cast<std::size_t>(i - calls.begin());
+  }
+
+private:
+  std::shared_ptr<State> state_;
+};
+
+using Queue = w::Basic_async_queue<Call<int>>;
+using Void_queue = w::Basic_async_queue<Call<void>>;
+
+/// @returns The state of the call completed after `latency`.
+std::shared_ptr<State> state(const milliseconds latency, const int value = {})
+{
+  auto result = std::make_shared<State>();
+  result->completion = Clock::now() + latency;
+  result->value = value;
+  return result;
+}
+
+void test_futures()
+{
+  DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+    Queue{w::Async_queue_options{0}});
+
+  // The calls in flight are bounded.
+  Queue queue{w::Async_queue_options{4}};
+  std::vector<std::future<int>> futures;
+  for (int i{}; i < 10; ++i) {
+    futures.push_back(queue.submit(Call<int>{state(milliseconds{i % 3 * 5},
+      i)}));
+    DMITIGR_WINCOM_CHECK(queue.size() <= 4);
+    DMITIGR_WINCOM_CHECK(in_flight == static_cast<int>(queue.size()));
+  }
+  queue.wait_all();
+  DMITIGR_WINCOM_CHECK(!queue.size() && !in_flight);
+  for (int i{}; i < 10; ++i)
+    DMITIGR_WINCOM_CHECK(futures[i].get() == i);
+  DMITIGR_WINCOM_CHECK(queue.stats().begun == 10);
+  DMITIGR_WINCOM_CHECK(queue.stats().finished == 10);
+  DMITIGR_WINCOM_CHECK(queue.stats().max_in_flight == 4);
+  DMITIGR_WINCOM_CHECK(!queue.stats().cancelled);
+
+  // The futures are ready only after the calls are finished by poll().
+  auto slow = queue.submit(Call<int>{state(milliseconds{30}, 1)});
+  auto fast = queue.submit(Call<int>{state(milliseconds{}, 2)});
+  DMITIGR_WINCOM_CHECK(fast.wait_for(seconds{}) == std::future_status::timeout);
+  DMITIGR_WINCOM_CHECK(queue.poll() == 1);
+  DMITIGR_WINCOM_CHECK(fast.get() == 2);
+  DMITIGR_WINCOM_CHECK(!queue.poll());
+  DMITIGR_WINCOM_CHECK(slow.wait_for(seconds{}) == std::future_status::timeout);
+  DMITIGR_WINCOM_CHECK(queue.poll(milliseconds::max()) == 1);
+  DMITIGR_WINCOM_CHECK(slow.get() == 1);
+}
+
+void test_errors()
+{
+  Void_queue queue;
+
+  // The failed begin leaves the queue intact.
+  const auto failed = state(milliseconds{});
+  failed->is_begin_failed = true;
+  DMITIGR_WINCOM_CHECK_THROW(std::runtime_error,
+    queue.submit(Call<void>{failed}));
+  DMITIGR_WINCOM_CHECK(!queue.size() && !queue.stats().begun);
+
+  // The failed finish is delivered through the future.
+  const auto broken = state(milliseconds{});
+  broken->is_finish_failed = true;
+  auto error = queue.submit(Call<void>{broken});
+  auto success = queue.submit(Call<void>{state(milliseconds{})});
+  queue.wait_all();
+  DMITIGR_WINCOM_CHECK_THROW(std::runtime_error, error.get());
+  success.get();
+  DMITIGR_WINCOM_CHECK(queue.stats().finished == 2);
+}
+
+void test_cancellation()
+{
+  const auto start = Clock::now();
+  {
+    Queue queue;
+
+    // The call timed out is cancelled.
+    const auto hung = state(seconds{10});
+    auto timed_out = queue.submit(Call<int>{hung}, milliseconds{20});
+    auto in_time = queue.submit(Call<int>{state(milliseconds{5}, 1)},
+      milliseconds{1000});
+    queue.wait_all();
+    DMITIGR_WINCOM_CHECK(hung->is_cancelled && hung->is_finished);
+    DMITIGR_WINCOM_CHECK_THROW(std::runtime_error, timed_out.get());
+    DMITIGR_WINCOM_CHECK(in_time.get() == 1);
+    DMITIGR_WINCOM_CHECK(queue.stats().cancelled == 1);
+
+    // All the calls are cancelled.
+    const auto first = state(seconds{10});
+    const auto second = state(seconds{10});
+    auto f1 = queue.submit(Call<int>{first});
+    auto f2 = queue.submit(Call<int>{second});
+    queue.cancel_all();
+    queue.cancel_all();
+    DMITIGR_WINCOM_CHECK(queue.poll() == 2);
+    DMITIGR_WINCOM_CHECK_THROW(std::runtime_error, f1.get());
+    DMITIGR_WINCOM_CHECK_THROW(std::runtime_error, f2.get());
+    DMITIGR_WINCOM_CHECK(queue.stats().cancelled == 3);
+
+    // The calls in flight are cancelled and finished on destruction.
+    auto abandoned = queue.submit(Call<int>{state(seconds{10})});
+  }
+  DMITIGR_WINCOM_CHECK(!in_flight);
+  DMITIGR_WINCOM_CHECK(Clock::now() - start < seconds{5});
+}
+
+// -----------------------------------------------------------------------------
+// Coroutines
+// -----------------------------------------------------------------------------
+
+/// The coroutine started eagerly.
+class Task final {
+public:
+  struct promise_type final {
+    Task get_return_object() noexcept
+    {
+      return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+
+    std::suspend_never initial_suspend() noexcept
+    {
+      return {};
+    }
+
+    std::suspend_always final_suspend() noexcept
+    {
+      return {};
+    }
+
+    void return_void() noexcept
+    {}
+
+    void unhandled_exception() noexcept
+    {
+      std::terminate();
+    }
+  };
+
+  ~Task()
+  {
+    handle_.destroy();
+  }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  bool is_done() const noexcept
+  {
+    return handle_.done();
+  }
+
+private:
+  std::coroutine_handle<promise_type> handle_;
+
+  explicit Task(const std::coroutine_handle<promise_type> handle) noexcept
+    : handle_{handle}
+  {}
+};
+
+/// Sums the results of the sequential calls.
+Task sum(Queue& queue, const int n, int& result)
+{
+  for (int i{1}; i <= n; ++i)
+    result += co_await queue.async(Call<int>{state(milliseconds{i}, i)});
+}
+
+/// Catches the error of the call.
+Task catch_error(Queue& queue, bool& is_caught)
+{
+  const auto broken = state(milliseconds{});
+  broken->is_finish_failed = true;
+  try {
+    co_await queue.async(Call<int>{broken});
+  } catch (const std::runtime_error&) {
+    is_caught = true;
+  }
+}
+
+/// Awaits the call without the result timed out.
+Task await_void(Void_queue& queue, bool& is_cancelled)
+{
+  try {
+    co_await queue.async(Call<void>{state(seconds{10})}, milliseconds{10});
+  } catch (const std::runtime_error&) {
+    is_cancelled = true;
+  }
+}
+
+void test_coroutines()
+{
+  // The concurrent coroutines are resumed by the queue.
+  Queue queue{w::Async_queue_options{2}};
+  int r1{}, r2{}, r3{};
+  bool is_caught{};
+  const Task t1{sum(queue, 3, r1)};
+  const Task t2{sum(queue, 4, r2)};
+  const Task t3{sum(queue, 5, r3)};
+  const Task t4{catch_error(queue, is_caught)};
+  queue.wait_all();
+  DMITIGR_WINCOM_CHECK(t1.is_done() && t2.is_done() && t3.is_done());
+  DMITIGR_WINCOM_CHECK(t4.is_done() && is_caught);
+  DMITIGR_WINCOM_CHECK(r1 == 6 && r2 == 10 && r3 == 15);
+  DMITIGR_WINCOM_CHECK(queue.stats().begun == 13);
+  DMITIGR_WINCOM_CHECK(queue.stats().max_in_flight == 2);
+
+  Void_queue void_queue;
+  bool is_cancelled{};
+  const Task t5{await_void(void_queue, is_cancelled)};
+  void_queue.wait_all();
+  DMITIGR_WINCOM_CHECK(t5.is_done() && is_cancelled);
+}
+
+// -----------------------------------------------------------------------------
+// Async_call
+// -----------------------------------------------------------------------------
+
+/// The call object of `Bar` completed by the server thread after latency.
+class Call_object final : public fake::Object<AsyncIFoo, ISynchronize,
+  ISynchronizeHandle, ICancelMethodCalls> {
+public:
+  ~Call_object() override
+  {
+    if (server_.joinable())
+      server_.join();
+    CloseHandle(event_);
+  }
+
+  explicit Call_object(const milliseconds latency)
+    : latency_{latency}
+    , event_{CreateEventW(nullptr, TRUE, FALSE, nullptr)}
+  {}
+
+  // AsyncIFoo overrides
+
+  HRESULT Begin_Bar(const LONG value) override
+  {
+    if (server_.joinable())
+      return E_UNEXPECTED;
+    server_ = std::thread{[this, value]
+    {
+      {
+        std::unique_lock lk{mutex_};
+        const bool is_cancelled = cond_.wait_for(lk, latency_,
+          [this]{return is_cancelled_;});
+        result_ = is_cancelled ? RPC_E_CALL_CANCELED : S_OK;
+        value_ = value * 2;
+      }
+      SetEvent(event_);
+    }};
+    return S_OK;
+  }
+
+  HRESULT Finish_Bar(LONG* const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    else if (!server_.joinable())
+      return E_UNEXPECTED;
+    server_.join();
+    if (result_ == S_OK)
+      *result = value_;
+    return result_;
+  }
+
+  // ISynchronize overrides
+
+  HRESULT Wait(DWORD, const DWORD timeout) override
+  {
+    return WaitForSingleObject(event_, timeout) == WAIT_OBJECT_0 ?
+      S_OK : RPC_S_CALLPENDING;
+  }
+
+  HRESULT Signal() override
+  {
+    return SetEvent(event_) ? S_OK : E_FAIL;
+  }
+
+  HRESULT Reset() override
+  {
+    return ResetEvent(event_) ? S_OK : E_FAIL;
+  }
+
+  // ISynchronizeHandle overrides
+
+  HRESULT GetHandle(HANDLE* const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = event_;
+    return S_OK;
+  }
+
+  // ICancelMethodCalls overrides
+
+  HRESULT Cancel(ULONG) override
+  {
+    {
+      const std::lock_guard lg{mutex_};
+      is_cancelled_ = true;
+    }
+    cond_.notify_all();
+    return S_OK;
+  }
+
+  HRESULT TestCancel() override
+  {
+    const std::lock_guard lg{mutex_};
+    return is_cancelled_ ? RPC_E_CALL_CANCELED : RPC_S_CALLPENDING;
+  }
+
+private:
+  milliseconds latency_{};
+  HANDLE event_{};
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool is_cancelled_{};
+  HRESULT result_{};
+  LONG value_{};
+  std::thread server_;
+};
+
+/// The proxy of `IFoo` which creates the call objects.
+class Foo final : public fake::Object<ICallFactory> {
+public:
+  explicit Foo(const milliseconds latency) noexcept
+    : latency_{latency}
+  {}
+
+  HRESULT CreateCall(REFIID async_id, IUnknown* const outer, REFIID id,
+    IUnknown** const result) override
+  {
+    if (!result)
+      return E_POINTER;
+    *result = nullptr;
+    if (outer)
+      return CLASS_E_NOAGGREGATION;
+    else if (!(async_id == __uuidof(AsyncIFoo)))
+      return E_NOINTERFACE;
+    const auto call = fake::make<Call_object>(latency_);
+    return call->QueryInterface(id, reinterpret_cast<void**>(result));
+  }
+
+private:
+  milliseconds latency_{};
+};
+
+using Bar = w::Async_call<AsyncIFoo, LONG>;
+using Bar_queue = w::Async_queue<AsyncIFoo, LONG>;
+
+/// @returns The call of `Bar` with `value` through `proxy`.
+Bar bar(const fake::Ref<Foo>& proxy, const LONG value)
+{
+  return {proxy.get(),
+    [value](AsyncIFoo& api){return api.Begin_Bar(value);},
+    [](AsyncIFoo& api)
+    {
+      LONG result{};
+      w::throw_if_error(api.Finish_Bar(&result), "cannot call Bar");
+      return result;
+    }};
+}
+
+void test_async_call()
+{
+  {
+    // The calls are made concurrently.
+    const auto proxy = fake::make<Foo>(milliseconds{20});
+    Bar_queue queue{w::Async_queue_options{4}};
+    std::vector<std::future<LONG>> futures;
+    const auto start = Clock::now();
+    for (LONG i{}; i < 16; ++i)
+      futures.push_back(queue.submit(bar(proxy, i)));
+    queue.wait_all();
+    const auto elapsed = Clock::now() - start;
+    for (LONG i{}; i < 16; ++i)
+      DMITIGR_WINCOM_CHECK(futures[i].get() == 2*i);
+    DMITIGR_WINCOM_CHECK(queue.stats().max_in_flight == 4);
+    DMITIGR_WINCOM_CHECK(elapsed >= milliseconds{4*20});
+    DMITIGR_WINCOM_CHECK(elapsed < milliseconds{16*20});
+
+    // The call timed out is cancelled by ICancelMethodCalls.
+    const auto hung = fake::make<Foo>(seconds{10});
+    auto timed_out = queue.submit(bar(hung, 1), milliseconds{20});
+    auto in_time = queue.submit(bar(proxy, 2), seconds{10});
+    queue.wait_all();
+    DMITIGR_WINCOM_CHECK(in_time.get() == 4);
+    try {
+      timed_out.get();
+      DMITIGR_WINCOM_CHECK(false);
+    } catch (const w::Win_error& e) {
+      DMITIGR_WINCOM_CHECK(e.code() == RPC_E_CALL_CANCELED);
+    }
+    DMITIGR_WINCOM_CHECK(Clock::now() - start < seconds{5});
+
+    // The proxy without the asynchronous interface.
+    struct Bare final : fake::Object<IDispatch> {};
+    const auto bare = fake::make<Bare>();
+    DMITIGR_WINCOM_CHECK_THROW(std::exception,
+      Bar(bare.get(), [](AsyncIFoo&){return S_OK;},
+        [](AsyncIFoo&){return LONG{};}));
+  }
+  DMITIGR_WINCOM_CHECK(!fake::object_count);
+}
+
+} // namespace
+
+int main()
+{
+  return test::run([]
+  {
+    test_futures();
+    test_errors();
+    test_cancellation();
+    test_coroutines();
+    test_async_call();
+  });
+}
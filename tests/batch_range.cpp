@@ -0,0 +1,216 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../batch_range.hpp"
+#include "unit.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace w = dmitigr::wincom;
+
+namespace {
+
+/// The state shared by the copies of `Fetcher`.
+struct Source final {
+  std::size_t size{};
+  std::size_t position{};
+  /// The number of the fetch to fail, or zero.
+  std::size_t failing_fetch{};
+  std::size_t fetch_count{};
+  /// The number of filled slots which are not cleared yet.
+  std::ptrdiff_t live_count{};
+};
+
+/// The fetcher of the consecutive integers.
+class Fetcher final {
+public:
+  struct Slot final {
+    int value{};
+    Source* source{};
+  };
+  using Value = int;
+
+  explicit Fetcher(Source& source) noexcept
+    : source_{&source}
+  {}
+
+  std::size_t fetch(const std::span<Slot> slots)
+  {
+    if (++source_->fetch_count == source_->failing_fetch)
+      throw std::runtime_error{"fetch failed"};
+    std::size_t result{};
+    for (; result < slots.size() && source_->position < source_->size;
+         ++result, ++source_->position) {
+      slots[result] = {static_cast<int>(source_->position), source_};
+      ++source_->live_count;
+    }
+    return result;
+  }
+
+  int convert(Slot& slot) const
+  {
+    DMITIGR_WINCOM_CHECK(slot.source);
+    return slot.value;
+  }
+
+  static void clear(Slot& slot) noexcept
+  {
+    if (slot.source) {
+      --slot.source->live_count;
+      slot = {};
+    }
+  }
+
+private:
+  Source* source_{};
+};
+
+using Range = w::Basic_batch_range<Fetcher>;
+
+/// The scope which marks the thread it's alive on.
+struct Marking_scope final {
+  inline static thread_local bool is_alive;
+  inline static bool is_failing;
+
+  Marking_scope()
+  {
+    if (is_failing)
+      throw std::runtime_error{"scope failed"};
+    is_alive = true;
+  }
+
+  ~Marking_scope()
+  {
+    is_alive = false;
+  }
+};
+
+/// The fetcher which requires `Marking_scope` to be alive.
+struct Scoped_fetcher final {
+  using Slot = int;
+  using Value = int;
+  using Thread_scope = Marking_scope;
+
+  std::size_t fetch(const std::span<int> slots)
+  {
+    DMITIGR_WINCOM_CHECK(Marking_scope::is_alive);
+    std::size_t result{};
+    for (; result < slots.size() && count < 10; ++result)
+      slots[result] = ++count;
+    return result;
+  }
+
+  int convert(const int slot) const noexcept
+  {
+    return slot;
+  }
+
+  static void clear(int&) noexcept
+  {}
+
+  int count{};
+};
+
+void test_iteration()
+{
+  for (const bool is_prefetching : {false, true}) {
+    for (const std::size_t batch_size : {1, 3, 7, 20, 64}) {
+      Source source{.size = 20};
+      {
+        Range range{Fetcher{source}, {batch_size, is_prefetching}};
+        int expected{};
+        for (const int value : range) {
+          DMITIGR_WINCOM_CHECK(value == expected++);
+          DMITIGR_WINCOM_CHECK(source.live_count > 0);
+        }
+        DMITIGR_WINCOM_CHECK(expected == 20);
+        // The last fetch is the one which returns less than requested.
+        DMITIGR_WINCOM_CHECK(range.fetch_count() == 20 / batch_size + 1);
+      }
+      DMITIGR_WINCOM_CHECK(!source.live_count);
+    }
+  }
+}
+
+void test_early_destruction()
+{
+  for (const bool is_prefetching : {false, true}) {
+    Source source{.size = 100};
+    {
+      Range range{Fetcher{source}, {8, is_prefetching}};
+      auto i = range.begin();
+      ++i;
+      DMITIGR_WINCOM_CHECK(*i == 1);
+    }
+    // Both the current and the prefetched batches are cleared.
+    DMITIGR_WINCOM_CHECK(!source.live_count);
+  }
+}
+
+void test_errors()
+{
+  for (const bool is_prefetching : {false, true}) {
+    Source source{.size = 100, .failing_fetch = 2};
+    {
+      Range range{Fetcher{source}, {10, is_prefetching}};
+      int count{};
+      DMITIGR_WINCOM_CHECK_THROW(std::runtime_error,
+        for ([[maybe_unused]] const int value : range) ++count);
+      DMITIGR_WINCOM_CHECK(count == 10);
+      DMITIGR_WINCOM_CHECK_THROW(std::logic_error, range.begin());
+    }
+    DMITIGR_WINCOM_CHECK(!source.live_count);
+  }
+
+  Source source;
+  DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+    Range(Fetcher{source}, {0, false}));
+}
+
+void test_thread_scope()
+{
+  using Scoped_range = w::Basic_batch_range<Scoped_fetcher>;
+  Scoped_range range{Scoped_fetcher{}, {2, true}};
+  int count{};
+  for ([[maybe_unused]] const int value : range)
+    ++count;
+  DMITIGR_WINCOM_CHECK(count == 10);
+  DMITIGR_WINCOM_CHECK(!Marking_scope::is_alive);
+
+  // The error of the scope is reported by the iteration.
+  Marking_scope::is_failing = true;
+  Scoped_range failing{Scoped_fetcher{}, {2, true}};
+  DMITIGR_WINCOM_CHECK_THROW(std::runtime_error, failing.begin());
+  Marking_scope::is_failing = false;
+}
+
+} // namespace
+
+int main()
+{
+  return w::test::run([]
+  {
+    test_iteration();
+    test_early_destruction();
+    test_errors();
+    test_thread_scope();
+  });
+}
@@ -0,0 +1,98 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../apartment_pool.hpp"
+#include "unit.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace test = dmitigr::wincom::test;
+namespace w = dmitigr::wincom;
+
+namespace {
+
+/// The stub of COM apartment.
+struct Apartment final {
+  explicit Apartment(w::Apartment_model) noexcept
+  {}
+};
+
+using Pool = w::Basic_apartment_pool<Apartment>;
+
+} // namespace
+
+int main(const int argc, const char* const argv[])
+{
+  return test::run([argc, argv]
+  {
+    const auto count = test::workload(argc, argv, 1'000'000, 10'000);
+    for (const std::size_t workers : {1, 2, 4, 8}) {
+      Pool::Options options;
+      options.worker_count = workers;
+      Pool pool{std::move(options)};
+      const auto suffix = " (" + std::to_string(workers) + " workers)";
+
+      std::atomic_size_t sum{};
+      test::measure(("submit any" + suffix).c_str(), count, [&]
+      {
+        std::future<void> last;
+        for (std::size_t i{}; i < count; ++i)
+          last = pool.submit([&sum, i](w::Apartment_context&)
+          {
+            sum.fetch_add(i, std::memory_order_relaxed);
+          });
+        last.get();
+      });
+
+      test::measure(("submit require" + suffix).c_str(), count, [&]
+      {
+        std::vector<std::future<void>> last(workers);
+        for (std::size_t i{}; i < count; ++i)
+          last[i % workers] = pool.submit([&sum, i](w::Apartment_context&)
+          {
+            sum.fetch_add(i, std::memory_order_relaxed);
+          }, w::Affinity::require(i % workers));
+        for (auto& future : last) {
+          if (future.valid())
+            future.get();
+        }
+      });
+
+      // The fan-out from a worker stays on that worker unless stolen.
+      test::measure(("fan-out from worker" + suffix).c_str(), count, [&]
+      {
+        pool.submit([&](w::Apartment_context&)
+        {
+          std::vector<std::future<void>> futures;
+          futures.reserve(count);
+          for (std::size_t i{}; i < count; ++i)
+            futures.push_back(pool.submit([&sum, i](w::Apartment_context&)
+            {
+              sum.fetch_add(i, std::memory_order_relaxed);
+            }));
+          return futures;
+        }).get().back().get();
+      });
+      test::do_not_optimize(sum.load());
+    }
+  });
+}
@@ -0,0 +1,106 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../enumerator.hpp"
+#include "../fake/object.hpp"
+#include "../library.hpp"
+#include "unit.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace fake = dmitigr::wincom::fake;
+namespace test = dmitigr::wincom::test;
+namespace w = dmitigr::wincom;
+
+namespace {
+
+struct Item final : fake::Object<IDispatch> {};
+
+class Element final : public w::Unknown_api<Element, IDispatch> {
+  using Ua = w::Unknown_api<Element, IDispatch>;
+public:
+  using Ua::Ua;
+};
+
+/// Simulates the processing of the element by the caller.
+void process(const Element& element, const std::chrono::nanoseconds work)
+{
+  const auto until = std::chrono::steady_clock::now() + work;
+  while (std::chrono::steady_clock::now() < until)
+    test::do_not_optimize(element);
+}
+
+} // namespace
+
+int main(const int argc, const char* const argv[])
+{
+  return test::run([argc, argv]
+  {
+    using std::chrono::microseconds;
+    const auto count = test::workload(argc, argv, 20'000, 500);
+    const w::Library library;
+    auto items = std::make_shared<fake::Enum_variant::Items>();
+    for (std::size_t i{}; i < count; ++i)
+      items->emplace_back(new Item);
+    const auto enumerator = [&items]
+    {
+      return w::Enumerator{
+        static_cast<IEnumVARIANT*>(new fake::Enum_variant{items})};
+    };
+
+    for (const auto latency : {microseconds{0}, microseconds{20}}) {
+      fake::configure_fault("IEnumVARIANT::Next", fake::Fault{latency});
+      for (const auto work : {microseconds{0}, microseconds{5}}) {
+        const auto suffix = " (latency " + std::to_string(latency.count())
+          + "us, work " + std::to_string(work.count()) + "us)";
+
+        // The baseline: the hand-written loop of one element per call.
+        test::measure(("Next(1) loop" + suffix).c_str(), count, [&]
+        {
+          auto e = enumerator();
+          VARIANT slot;
+          VariantInit(&slot);
+          ULONG fetched{};
+          while (e.api().Next(1, &slot, &fetched) == S_OK) {
+            const auto element = Element::query(slot.pdispVal);
+            process(element, work);
+            VariantClear(&slot);
+          }
+        });
+
+        for (const std::size_t batch_size : {1, 64}) {
+          for (const bool is_prefetching : {false, true}) {
+            const auto name = "range (batch " + std::to_string(batch_size)
+              + (is_prefetching ? ", prefetching" : "") + ")" + suffix;
+            test::measure(name.c_str(), count, [&]
+            {
+              w::Enumerator_range<Element> range{
+                w::Enumerator_fetcher<Element>{enumerator()},
+                {batch_size, is_prefetching}};
+              for (const auto& element : range)
+                process(element, work);
+            });
+          }
+        }
+      }
+    }
+    fake::reset_faults();
+  });
+}
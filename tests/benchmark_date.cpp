@@ -0,0 +1,57 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../date.hpp"
+#include "unit.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace w = dmitigr::wincom;
+namespace test = dmitigr::wincom::test;
+using namespace std::chrono;
+
+int main(const int argc, const char* const argv[])
+{
+  return test::run([argc, argv]
+  {
+    const auto count = test::workload(argc, argv, 10'000'000, 100'000);
+    std::vector<double> dates(count);
+    for (std::size_t i{}; i < count; ++i)
+      dates[i] = 45000 + static_cast<double>(i % 100'000) / 977;
+    std::vector<sys_time<milliseconds>> times(count);
+
+    test::measure("to_sys_time (scalar)", count, [&]
+    {
+      for (std::size_t i{}; i < count; ++i)
+        times[i] = w::to_sys_time(dates[i]);
+    });
+    test::do_not_optimize(times.back());
+
+    test::measure("to_sys_time (span)", count, [&]
+    {
+      w::to_sys_time<milliseconds>(dates, times);
+    });
+    test::do_not_optimize(times.back());
+
+    test::measure("to_ole_date (span)", count, [&]
+    {
+      w::to_ole_date<system_clock, milliseconds>(times, dates);
+    });
+    test::do_not_optimize(dates.back());
+  });
+}
@@ -0,0 +1,95 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../enumerator.hpp"
+#include "../fake/object.hpp"
+#include "../instrumentation.hpp"
+#include "unit.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+
+namespace fake = dmitigr::wincom::fake;
+namespace test = dmitigr::wincom::test;
+namespace w = dmitigr::wincom;
+
+namespace {
+
+/// The maximum overhead of instrumented call in nanoseconds.
+constexpr double budget{50};
+
+// The overhead is meaningful only for optimized builds without sanitizers.
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define DMITIGR_WINCOM_SANITIZED
+#endif
+#endif
+#if !defined(NDEBUG) || defined(__SANITIZE_ADDRESS__) || \
+  defined(DMITIGR_WINCOM_SANITIZED)
+constexpr bool is_budget_enforced{false};
+#else
+constexpr bool is_budget_enforced{true};
+#endif
+
+} // namespace
+
+int main(const int argc, const char* const argv[])
+{
+  return test::run([argc, argv]
+  {
+    const auto count = test::workload(argc, argv, 50'000'000, 100'000);
+    const w::Enumerator enumerator{static_cast<IEnumVARIANT*>(
+        new fake::Enum_variant{std::make_shared<fake::Enum_variant::Items>()})};
+
+    // The cheapest method of the fake: IEnumVARIANT::Skip(0).
+    HRESULT sum{};
+    const auto direct = test::measure("direct call", count, [&]
+    {
+      auto& api = w::detail::api(enumerator);
+      for (std::size_t i{}; i < count; ++i) {
+        sum += api.Skip(0);
+        test::do_not_optimize(api);
+      }
+    });
+    const auto instrumented = test::measure("instrumented call", count, [&]
+    {
+      for (std::size_t i{}; i < count; ++i) {
+        sum += w::detail::call<&IEnumVARIANT::Skip>(enumerator, "Skip", 0);
+        test::do_not_optimize(enumerator);
+      }
+    });
+    test::do_not_optimize(sum);
+
+    // The two reads of the clock are made only for the sampled calls.
+    std::uint64_t ticks{};
+    const auto clock = test::measure("clock read", count, [&]
+    {
+      for (std::size_t i{}; i < count; ++i)
+        ticks += w::detail::Call_clock::now();
+    });
+    test::do_not_optimize(ticks);
+
+    const auto overhead = instrumented - direct;
+    std::printf("instrumentation overhead: %.1f ns/call, of which clock reads"
+      " %.1f ns (budget %.0f ns)\n", overhead,
+      2*clock / w::call_sample_period, budget);
+    if (is_budget_enforced && overhead > budget)
+      throw std::runtime_error{"instrumentation overhead is over budget"};
+  });
+}
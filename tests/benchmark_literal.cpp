@@ -0,0 +1,68 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../fake/tasc.hpp"
+#include "../tasc.hpp"
+#include "unit.hpp"
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace ts = dmitigr::wincom::tasc::v2;
+namespace test = dmitigr::wincom::test;
+
+int main(const int argc, const char* const argv[])
+{
+  return test::run([argc, argv]
+  {
+    const auto count = test::workload(argc, argv, 10'000'000, 100'000);
+    const std::vector<TASK_TRIGGER_TYPE2> values{TASK_TRIGGER_EVENT,
+      TASK_TRIGGER_TIME, TASK_TRIGGER_DAILY, TASK_TRIGGER_WEEKLY,
+      TASK_TRIGGER_MONTHLY, TASK_TRIGGER_MONTHLYDOW, TASK_TRIGGER_IDLE,
+      TASK_TRIGGER_REGISTRATION, TASK_TRIGGER_BOOT, TASK_TRIGGER_LOGON,
+      TASK_TRIGGER_SESSION_STATE_CHANGE, TASK_TRIGGER_CUSTOM_TRIGGER_01};
+    std::vector<std::string_view> literals;
+    for (const auto value : values)
+      literals.emplace_back(ts::to_literal(value));
+
+    test::measure("from_literal (perfect hash)", count, [&]
+    {
+      for (std::size_t i{}; i < count; ++i)
+        test::do_not_optimize(ts::from_literal<TASK_TRIGGER_TYPE2>(
+            literals[i % literals.size()]));
+    });
+
+    test::measure("from_literal (linear scan)", count, [&]
+    {
+      for (std::size_t i{}; i < count; ++i) {
+        const auto literal = literals[i % literals.size()];
+        for (const auto value : values) {
+          if (literal == ts::to_literal(value)) {
+            test::do_not_optimize(value);
+            break;
+          }
+        }
+      }
+    });
+
+    test::measure("to_literal", count, [&]
+    {
+      for (std::size_t i{}; i < count; ++i)
+        test::do_not_optimize(ts::to_literal(values[i % values.size()]));
+    });
+  });
+}
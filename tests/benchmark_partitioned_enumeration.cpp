@@ -0,0 +1,122 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../enumerator.hpp"
+#include "../fake/object.hpp"
+#include "../library.hpp"
+#include "../partitioned_enumeration.hpp"
+#include "unit.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fake = dmitigr::wincom::fake;
+namespace test = dmitigr::wincom::test;
+namespace w = dmitigr::wincom;
+
+namespace {
+
+struct Item final : fake::Object<IDispatch> {};
+
+class Element final : public w::Unknown_api<Element, IDispatch> {
+  using Ua = w::Unknown_api<Element, IDispatch>;
+public:
+  using Ua::Ua;
+};
+
+/// Simulates the processing of the element by the caller.
+void process(const Element& element, const std::chrono::nanoseconds work)
+{
+  const auto until = std::chrono::steady_clock::now() + work;
+  while (std::chrono::steady_clock::now() < until)
+    test::do_not_optimize(element);
+}
+
+} // namespace
+
+int main(const int argc, const char* const argv[])
+{
+  return test::run([argc, argv]
+  {
+    using std::chrono::microseconds;
+    const auto count = test::workload(argc, argv, 100'000, 2'000);
+    const w::Library library;
+    auto items = std::make_shared<fake::Enum_variant::Items>();
+    for (std::size_t i{}; i < count; ++i)
+      items->emplace_back(new Item);
+    // The enumeration consumes the source if it's not partitioned.
+    const auto make_source = [&items]
+    {
+      return w::Enumerator_fetcher<Element>{w::Enumerator{
+          static_cast<IEnumVARIANT*>(new fake::Enum_variant{items})}};
+    };
+
+    // The latency of the in-proc call and the work per element.
+    fake::configure_fault("IEnumVARIANT::Next", fake::Fault{microseconds{5}});
+    const microseconds work{2};
+
+    // The baseline: the single cursor.
+    test::measure("sequential for each", count, [&]
+    {
+      w::Enumerator_range<Element> range{make_source()};
+      for (const auto& element : range)
+        process(element, work);
+    });
+    test::measure("sequential collect", count, [&]
+    {
+      w::Enumerator_range<Element> range{make_source()};
+      std::vector<Element> elements;
+      for (auto& element : range)
+        elements.push_back(std::move(element));
+      test::do_not_optimize(elements);
+    });
+
+    for (const std::size_t workers : {1, 2, 4, 8, 16}) {
+      w::Apartment_pool::Options pool_options;
+      pool_options.worker_count = workers;
+      w::Apartment_pool pool{std::move(pool_options)};
+      const auto suffix = " (" + std::to_string(workers) + " threads)";
+
+      std::atomic_size_t processed{};
+      test::measure(("for_each_partitioned" + suffix).c_str(), count, [&]
+      {
+        auto source = make_source();
+        w::for_each_partitioned(source, count, pool, [&](Element&& element)
+        {
+          process(element, work);
+          processed.fetch_add(1, std::memory_order_relaxed);
+        });
+      });
+      test::measure(("collect_partitioned" + suffix).c_str(), count, [&]
+      {
+        auto source = make_source();
+        const auto elements = w::collect_partitioned(source, count, pool);
+        if (elements.size() != count)
+          throw std::logic_error{"unexpected number of elements"};
+      });
+      if (processed != count)
+        throw std::logic_error{"unexpected number of elements"};
+    }
+    fake::reset_faults();
+  });
+}
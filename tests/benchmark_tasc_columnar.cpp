@@ -0,0 +1,158 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../tasc_columnar.hpp"
+#include "unit.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace test = dmitigr::wincom::test;
+namespace ts = dmitigr::wincom::tasc::v2;
+using namespace std::chrono;
+
+namespace {
+
+struct Task final {
+  ts::Task_signature signature;
+  ts::Task_definition_snapshot definition;
+};
+
+std::vector<Task> fleet(const std::size_t count)
+{
+  std::vector<Task> result(count);
+  for (std::size_t i{}; i < count; ++i) {
+    auto& [sig, def] = result[i];
+    const auto n = std::to_wstring(i % 500);
+    sig.path = L"\\Vendor" + std::to_wstring(i % 20) + L"\\Task" + n;
+    sig.state = i % 7 ? ts::Task_state::ready : ts::Task_state::running;
+    sig.last_run_time = 45000 + static_cast<double>(i) / 1000;
+    def.registration.author = def.intern(L"Vendor" + std::to_wstring(i % 20));
+    def.registration.uri = def.intern(sig.path);
+    def.principal.user_id = def.intern(i % 3 ? L"SYSTEM" : L"Administrator");
+    def.principal.logon_type = ts::Logon_type::service_account;
+    def.settings.is_enabled = true;
+    ts::Action_snapshot action;
+    action.path = def.intern(L"C:\\Program Files\\Vendor\\updater.exe");
+    action.arguments = def.intern(L"/silent /task " + n);
+    def.actions.push_back(action);
+    ts::Trigger_snapshot trigger;
+    trigger.type = ts::Trigger_type::daily;
+    trigger.start_boundary = ts::Schedule_time{seconds{1'700'000'000 + i}};
+    trigger.repetition.interval = hours{1};
+    def.triggers.push_back(trigger);
+  }
+  return result;
+}
+
+void append_json(std::string& out, const std::wstring_view value)
+{
+  out += '"';
+  ts::detail::columnar::append_utf8(out, value);
+  out += '"';
+}
+
+/// The row-wise JSON the columnar format is compared with.
+std::string to_json(const std::vector<Task>& tasks)
+{
+  std::string result{"["};
+  for (const auto& [sig, def] : tasks) {
+    result += "{\"path\":";
+    append_json(result, sig.path);
+    result += ",\"state\":" + std::to_string(static_cast<int>(sig.state));
+    result += ",\"lastRunTime\":" + std::to_string(sig.last_run_time);
+    result += ",\"author\":";
+    append_json(result, def.text(def.registration.author));
+    result += ",\"uri\":";
+    append_json(result, def.text(def.registration.uri));
+    result += ",\"userId\":";
+    append_json(result, def.text(def.principal.user_id));
+    result += ",\"logonType\":" + std::to_string(
+      static_cast<int>(def.principal.logon_type));
+    result += ",\"enabled\":true,\"actions\":[";
+    for (const auto& action : def.actions) {
+      result += "{\"path\":";
+      append_json(result, def.text(action.path));
+      result += ",\"arguments\":";
+      append_json(result, def.text(action.arguments));
+      result += "}";
+    }
+    result += "],\"triggers\":[";
+    for (const auto& trigger : def.triggers) {
+      result += "{\"type\":" + std::to_string(static_cast<int>(trigger.type));
+      result += ",\"start\":" + std::to_string(
+        trigger.start_boundary->time_since_epoch().count());
+      result += ",\"interval\":" + std::to_string(
+        trigger.repetition.interval.count());
+      result += "}";
+    }
+    result += "]},";
+  }
+  result.back() = ']';
+  return result;
+}
+
+} // namespace
+
+int main(const int argc, const char* const argv[])
+{
+  return test::run([argc, argv]
+  {
+    const auto count = test::workload(argc, argv, 200'000, 2'000);
+    const auto tasks = fleet(count);
+
+    std::string json;
+    test::measure("encode JSON", count, [&]
+    {
+      json = to_json(tasks);
+    });
+
+    std::vector<std::uint8_t> data;
+    test::measure("encode columnar", count, [&]
+    {
+      ts::Inventory_writer writer;
+      for (const auto& [sig, def] : tasks)
+        writer.add(sig, def);
+      data = writer.serialize();
+    });
+    std::printf("size: JSON %zu bytes, columnar %zu bytes (%.1fx)\n",
+      json.size(), data.size(),
+      static_cast<double>(json.size()) / static_cast<double>(data.size()));
+
+    std::size_t running{};
+    test::measure("decode columnar", count, [&]
+    {
+      const ts::Inventory_reader reader{data};
+      auto cursor = reader.cursor();
+      ts::Inventory_task task;
+      while (cursor.next(task))
+        running += task.state == ts::Task_state::running;
+    });
+    test::do_not_optimize(running);
+
+    test::measure("scan state column", count, [&]
+    {
+      const ts::Inventory_reader reader{data};
+      for (std::size_t i{}; i < reader.size(); ++i)
+        running += reader.state(i) == ts::Task_state::running;
+    });
+    test::do_not_optimize(running);
+  });
+}
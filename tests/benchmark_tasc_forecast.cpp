@@ -0,0 +1,63 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../tasc_forecast.hpp"
+#include "unit.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ts = dmitigr::wincom::tasc::v2;
+namespace test = dmitigr::wincom::test;
+using namespace std::chrono;
+
+int main(const int argc, const char* const argv[])
+{
+  return test::run([argc, argv]
+  {
+    const auto trigger_count = test::workload(argc, argv, 1'000'000, 10'000);
+    const sys_seconds origin{sys_days{2024y/June/1}};
+
+    // A synthetic inventory of daily and hourly triggers of 100 tasks.
+    std::vector<ts::Trigger_snapshot> triggers(trigger_count);
+    for (std::size_t i{}; i < trigger_count; ++i) {
+      auto& t = triggers[i];
+      t.type = ts::Trigger_type::daily;
+      t.start_boundary = local_days{2024y/January/1}
+        + minutes{static_cast<int>(i % 97 * 15)};
+      if (i % 10 == 0)
+        t.repetition.interval = hours{1};
+    }
+
+    ts::Load_forecaster forecaster{origin, hours{24}};
+    test::measure("add (daily, 24h horizon)", trigger_count, [&]
+    {
+      for (std::size_t i{}; i < trigger_count; ++i)
+        forecaster.add(std::uint64_t{i % 100}, std::span{&triggers[i], 1},
+          seconds{});
+    });
+    test::do_not_optimize(forecaster.peak());
+
+    ts::Load_forecaster other{origin, hours{24}};
+    test::measure("merge (24h horizon)", 1, [&]
+    {
+      other.merge(forecaster);
+    });
+    test::do_not_optimize(other.herds(1000).size());
+  });
+}
@@ -0,0 +1,104 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../tasc_index.hpp"
+#include "unit.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace test = dmitigr::wincom::test;
+namespace ts = dmitigr::wincom::tasc::v2;
+
+namespace {
+
+using Q = ts::Task_query;
+
+ts::Task_definition_snapshot definition(const std::size_t i)
+{
+  static const wchar_t* const commands[]{
+    L"C:\\Windows\\System32\\WindowsPowerShell\\v1.0\\powershell.exe",
+    L"C:\\Windows\\System32\\cmd.exe",
+    L"C:\\Program Files\\Vendor\\updater.exe",
+    L"C:\\Windows\\System32\\rundll32.exe"};
+  ts::Task_definition_snapshot result;
+  result.registration.author = result.intern(L"Vendor"
+    + std::to_wstring(i % 100));
+  result.registration.uri = result.intern(L"\\Task" + std::to_wstring(i));
+  ts::Action_snapshot action;
+  action.path = result.intern(commands[i % 4]);
+  action.arguments = result.intern(i % 1000 ? L"/silent /id "
+    + std::to_wstring(i % 5000) : L"-nop -enc SQBFAFgA");
+  result.actions.push_back(action);
+  return result;
+}
+
+} // namespace
+
+int main(const int argc, const char* const argv[])
+{
+  return test::run([argc, argv]
+  {
+    const auto count = test::workload(argc, argv, 1'000'000, 10'000);
+    const auto queries = test::workload(argc, argv, 20, 5);
+
+    ts::Task_index index;
+    test::measure("add", count, [&]
+    {
+      for (std::size_t i{}; i < count; ++i)
+        index.add(L"\\Host" + std::to_wstring(i / 100) + L"\\Task"
+          + std::to_wstring(i), definition(i));
+    });
+
+    const auto run = [&](const char* const name, const Q& query)
+    {
+      std::size_t found{};
+      test::measure(name, queries, [&]
+      {
+        for (std::size_t i{}; i < queries; ++i)
+          found += index.search(query).size();
+      });
+      test::do_not_optimize(found);
+    };
+    run("query command_line (selective)", Q::command_line(L"powershell.exe")
+      && Q::command_line(L"-enc"));
+    run("query command_line (broad)", Q::command_line(L"system32"));
+    run("query author", Q::author(L"vendor42"));
+    run("query author && !command_line", Q::author(L"vendor42")
+      && !Q::command_line(L"cmd.exe"));
+    run("query path", Q::path(L"\\Host7\\Task777"));
+
+    // The baseline: the scan of the command lines without the index.
+    std::vector<std::wstring> command_lines(count);
+    for (std::size_t i{}; i < count; ++i) {
+      const auto def = definition(i);
+      command_lines[i].append(def.text(def.actions[0].path)).append(L" ")
+        .append(def.text(def.actions[0].arguments));
+    }
+    std::size_t found{};
+    test::measure("scan command_line (selective)", queries, [&]
+    {
+      for (std::size_t q{}; q < queries; ++q) {
+        for (const auto& line : command_lines)
+          found += line.find(L"powershell.exe") != std::wstring::npos
+            && line.find(L"-enc") != std::wstring::npos;
+      }
+    });
+    test::do_not_optimize(found);
+  });
+}
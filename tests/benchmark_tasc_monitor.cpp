@@ -0,0 +1,106 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../fake/tasc.hpp"
+#include "../tasc.hpp"
+#include "../tasc_monitor.hpp"
+#include "unit.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace fake = dmitigr::wincom::fake;
+namespace test = dmitigr::wincom::test;
+namespace ts = dmitigr::wincom::tasc::v2;
+
+int main(const int argc, const char* const argv[])
+{
+  return test::run([argc, argv]
+  {
+    const auto instance_count = test::workload(argc, argv, 1'000, 50);
+    const auto poll_count = test::workload(argc, argv, 100, 5);
+    CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    fake::tasc::register_classes();
+    {
+      ts::Task_service service;
+      service.connect();
+      auto root = service.folder(std::wstring{L"\\"});
+      ts::Task_registration spec;
+      spec.path = L"\\Busy";
+      spec.definition = std::wstring{LR"(<Task><Settings>
+        <MultipleInstancesPolicy>Parallel</MultipleInstancesPolicy>
+        </Settings><Actions><Exec><Command>cmd.exe</Command></Exec></Actions>
+        </Task>)"};
+      spec.flags = TASK_CREATE;
+      auto task = root.register_task(spec);
+      for (std::size_t i{}; i < instance_count; ++i)
+        task.run();
+
+      const auto ops = instance_count * poll_count;
+      const auto calls = []
+      {
+        return fake::call_count("IRunningTaskCollection::get_Item")
+          + fake::call_count("IEnumVARIANT::Next");
+      };
+
+      auto calls_before = calls();
+      test::measure("poll by get_Item", ops, [&]
+      {
+        for (std::size_t p{}; p < poll_count; ++p) {
+          const auto tasks = service.running_tasks(0);
+          const auto count = tasks.count();
+          std::vector<ts::Running_task_sample> sample;
+          for (LONG i{1}; i <= count; ++i)
+            sample.push_back(tasks.item(i).sample());
+          test::do_not_optimize(sample.data());
+        }
+      });
+      std::printf("  %zu collection calls per poll\n",
+        static_cast<std::size_t>(calls() - calls_before) / poll_count);
+
+      for (const ULONG batch_size : {1, 16, 64}) {
+        calls_before = calls();
+        const auto name = "poll by Next (batch of "
+          + std::to_string(batch_size) + ")";
+        test::measure(name.c_str(), ops, [&]
+        {
+          for (std::size_t p{}; p < poll_count; ++p)
+            test::do_not_optimize(
+              service.running_tasks(0).samples(batch_size).data());
+        });
+        std::printf("  %zu collection calls per poll\n",
+          static_cast<std::size_t>(calls() - calls_before) / poll_count);
+      }
+
+      // The monitor without transitions (the steady state).
+      const auto sample = service.running_tasks(0).samples();
+      ts::Running_task_monitor monitor;
+      const auto now = std::chrono::steady_clock::now();
+      monitor.update(sample, now, [](auto&&){});
+      test::measure("Running_task_monitor::update", ops, [&]
+      {
+        for (std::size_t p{}; p < poll_count; ++p)
+          test::do_not_optimize(monitor.update(sample, now, [](auto&&){}));
+      });
+      fake::tasc::store().finish_all();
+    }
+    fake::tasc::store().clear();
+    CoUninitialize();
+  });
+}
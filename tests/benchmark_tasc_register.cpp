@@ -0,0 +1,73 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../fake/tasc.hpp"
+#include "../tasc.hpp"
+#include "unit.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace fake = dmitigr::wincom::fake;
+namespace test = dmitigr::wincom::test;
+namespace ts = dmitigr::wincom::tasc::v2;
+
+int main(const int argc, const char* const argv[])
+{
+  return test::run([argc, argv]
+  {
+    const auto task_count = test::workload(argc, argv, 2'000, 100);
+    CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    fake::tasc::register_classes();
+    {
+      ts::Task_service service;
+      service.connect();
+      auto root = service.folder(std::wstring{L"\\"});
+
+      std::vector<ts::Task_registration> specs(task_count);
+      for (std::size_t i{}; i < task_count; ++i) {
+        specs[i].path = L"\\App" + std::to_wstring(i % 10) + L"\\T"
+          + std::to_wstring(i);
+        specs[i].definition = std::wstring{LR"(<Task><Actions>
+          <Exec><Command>cmd.exe</Command></Exec></Actions></Task>)"};
+        specs[i].flags = TASK_CREATE_OR_UPDATE;
+      }
+
+      // The round trip to the service.
+      fake::configure_fault("ITaskFolder::RegisterTask",
+        fake::Fault{.latency = std::chrono::microseconds{500}});
+
+      test::measure("register_task (sequential)", task_count, [&]
+      {
+        for (const auto& spec : specs)
+          test::do_not_optimize(root.register_task(spec).api());
+      });
+      for (const std::size_t concurrency : {1, 4, 16}) {
+        const auto name = "register_tasks (" + std::to_string(concurrency)
+          + " workers)";
+        test::measure(name.c_str(), task_count, [&]
+        {
+          test::do_not_optimize(root.register_tasks(specs, concurrency));
+        });
+      }
+      fake::reset_faults();
+    }
+    fake::tasc::store().clear();
+    CoUninitialize();
+  });
+}
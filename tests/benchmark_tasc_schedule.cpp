@@ -0,0 +1,84 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../tasc_schedule.hpp"
+#include "unit.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace ts = dmitigr::wincom::tasc::v2;
+namespace test = dmitigr::wincom::test;
+using namespace std::chrono;
+
+int main(const int argc, const char* const argv[])
+{
+  return test::run([argc, argv]
+  {
+    const auto trigger_count = test::workload(argc, argv, 100'000, 1'000);
+    constexpr std::size_t fire_count{16};
+    const ts::Schedule_time from{local_days{2024y/June/1}};
+
+    std::vector<ts::Trigger_snapshot> daily;
+    std::vector<ts::Trigger_snapshot> mixed;
+    daily.reserve(trigger_count);
+    mixed.reserve(trigger_count);
+    for (std::size_t i{}; i < trigger_count; ++i) {
+      ts::Trigger_snapshot t;
+      t.type = ts::Trigger_type::daily;
+      t.start_boundary = local_days{2020y/January/1}
+        + minutes{static_cast<int>(i % 1440)};
+      t.days_interval = static_cast<std::int16_t>(1 + i % 7);
+      daily.push_back(t);
+
+      switch (i % 4) {
+      case 0:
+        t.type = ts::Trigger_type::time;
+        t.repetition.interval = minutes{15};
+        break;
+      case 1:
+        t.repetition.interval = hours{1};
+        t.repetition.duration = hours{8};
+        break;
+      case 2:
+        t.type = ts::Trigger_type::weekly;
+        t.days_of_week = 0b0111110;
+        break;
+      default:
+        t.type = ts::Trigger_type::monthly;
+        t.months_of_year = 0xfff;
+        t.days_of_month = 1 | (1 << 14);
+        t.is_run_on_last_day_of_month = true;
+      }
+      mixed.push_back(t);
+    }
+
+    const auto ops = trigger_count * fire_count;
+    test::measure("expand (daily)", ops, [&]
+    {
+      test::do_not_optimize(ts::expand(daily, from, fire_count));
+    });
+    test::measure("expand (mixed)", ops, [&]
+    {
+      test::do_not_optimize(ts::expand(mixed, from, fire_count));
+    });
+    test::measure("next_fire_time (mixed)", trigger_count, [&]
+    {
+      test::do_not_optimize(ts::next_fire_time(mixed, from));
+    });
+  });
+}
@@ -0,0 +1,296 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../circuit_breaker.hpp"
+#include "../fake/wmi.hpp"
+#include "../library.hpp"
+#include "../wmi.hpp"
+#include "unit.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace fake = dmitigr::wincom::fake;
+namespace test = dmitigr::wincom::test;
+namespace w = dmitigr::wincom;
+
+using std::chrono::milliseconds;
+using Breaker = w::Basic_circuit_breaker<test::Fake_clock>;
+using Breakers = w::Basic_circuit_breakers<test::Fake_clock>;
+
+namespace {
+
+/// The error with `HRESULT`.
+class Error final : public std::runtime_error {
+public:
+  Error(const std::string& message, const std::int32_t code)
+    : std::runtime_error{message}
+    , code_{code}
+  {}
+
+  std::int32_t code() const noexcept
+  {
+    return code_;
+  }
+
+private:
+  std::int32_t code_{};
+};
+
+constexpr std::int32_t unavailable{
+  static_cast<std::int32_t>(0x800706BA)}; // RPC_S_SERVER_UNAVAILABLE
+constexpr std::int32_t canceled{
+  static_cast<std::int32_t>(0x80010002)}; // RPC_E_CALL_CANCELED
+
+/// Makes the allowed call with the outcome `is_failure`.
+void call(Breaker& breaker, const bool is_failure)
+{
+  DMITIGR_WINCOM_CHECK(breaker.try_acquire());
+  breaker.record(is_failure);
+}
+
+void test_opening()
+{
+  const test::Fake_clock clock;
+  Breaker breaker{{}, clock};
+  DMITIGR_WINCOM_CHECK(breaker.state() == w::Circuit_state::closed);
+
+  // Not opened until the minimum number of calls is made.
+  call(breaker, false);
+  call(breaker, true);
+  call(breaker, true);
+  call(breaker, true);
+  DMITIGR_WINCOM_CHECK(breaker.state() == w::Circuit_state::closed);
+  // Opened by the failure rate 4/5.
+  call(breaker, true);
+  DMITIGR_WINCOM_CHECK(breaker.state() == w::Circuit_state::open);
+  DMITIGR_WINCOM_CHECK(breaker.open_count() == 1);
+  DMITIGR_WINCOM_CHECK(!breaker.try_acquire());
+
+  // Not opened by the rate below the threshold.
+  Breaker healthy{{}, clock};
+  for (int i{}; i < 100; ++i)
+    call(healthy, i % 3 == 0);
+  DMITIGR_WINCOM_CHECK(healthy.state() == w::Circuit_state::closed);
+}
+
+void test_window()
+{
+  const test::Fake_clock clock;
+  Breaker breaker{{}, clock};
+  for (int i{}; i < 4; ++i)
+    call(breaker, true);
+
+  // The failures beyond the window are forgotten.
+  clock.advance(breaker.options().window);
+  call(breaker, true);
+  DMITIGR_WINCOM_CHECK(breaker.state() == w::Circuit_state::closed);
+
+  // The failures within the window are counted over the buckets.
+  for (int i{}; i < 3; ++i) {
+    clock.advance(breaker.options().window / 10);
+    call(breaker, true);
+  }
+  DMITIGR_WINCOM_CHECK(breaker.state() == w::Circuit_state::closed);
+  clock.advance(breaker.options().window / 10);
+  call(breaker, true);
+  DMITIGR_WINCOM_CHECK(breaker.state() == w::Circuit_state::open);
+}
+
+void test_half_open()
+{
+  const test::Fake_clock clock;
+  w::Circuit_breaker_options options;
+  options.min_call_count = 1;
+  options.trial_call_count = 2;
+  Breaker breaker{options, clock};
+  call(breaker, true);
+  DMITIGR_WINCOM_CHECK(breaker.state() == w::Circuit_state::open);
+
+  // Half-open after the open duration.
+  clock.advance(options.open_duration - milliseconds{1});
+  DMITIGR_WINCOM_CHECK(breaker.state() == w::Circuit_state::open);
+  DMITIGR_WINCOM_CHECK(!breaker.try_acquire());
+  clock.advance(milliseconds{1});
+  DMITIGR_WINCOM_CHECK(breaker.state() == w::Circuit_state::half_open);
+
+  // The limited number of trial calls at a time.
+  DMITIGR_WINCOM_CHECK(breaker.try_acquire());
+  DMITIGR_WINCOM_CHECK(breaker.try_acquire());
+  DMITIGR_WINCOM_CHECK(!breaker.try_acquire());
+  breaker.record(false);
+  DMITIGR_WINCOM_CHECK(breaker.state() == w::Circuit_state::half_open);
+  // Opened again by the failed trial.
+  breaker.record(true);
+  DMITIGR_WINCOM_CHECK(breaker.state() == w::Circuit_state::open);
+  DMITIGR_WINCOM_CHECK(breaker.open_count() == 2);
+
+  // Closed by the successful trials.
+  clock.advance(options.open_duration);
+  call(breaker, false);
+  DMITIGR_WINCOM_CHECK(breaker.state() == w::Circuit_state::half_open);
+  call(breaker, false);
+  DMITIGR_WINCOM_CHECK(breaker.state() == w::Circuit_state::closed);
+
+  // The failures before the closing are forgotten.
+  options.min_call_count = 2;
+  Breaker other{options, clock};
+  call(other, false);
+  call(other, true);
+  clock.advance(options.open_duration);
+  call(other, false);
+  call(other, false);
+  call(other, true);
+  DMITIGR_WINCOM_CHECK(other.state() == w::Circuit_state::closed);
+}
+
+void test_breakers()
+{
+  const test::Fake_clock clock;
+  w::Circuit_breaker_options options;
+  options.min_call_count = 2;
+  Breakers breakers{options, clock};
+  DMITIGR_WINCOM_CHECK(
+    &breakers.breaker(L"Host") == &breakers.breaker(L"hOST"));
+  DMITIGR_WINCOM_CHECK(&breakers.breaker(L"a") != &breakers.breaker(L"b"));
+
+  // The non-failure errors and other exceptions are not counted as failures.
+  for (int i{}; i < 3; ++i) {
+    DMITIGR_WINCOM_CHECK_THROW(Error, breakers.call<Error>(L"host", []
+    {
+      throw Error{"denied", static_cast<std::int32_t>(0x80070005)};
+    }));
+    DMITIGR_WINCOM_CHECK_THROW(std::logic_error, breakers.call<Error>(L"host",
+      []{throw std::logic_error{"bug"};}));
+  }
+  DMITIGR_WINCOM_CHECK(breakers.call<Error>(L"host", []{return 1;}) == 1);
+  DMITIGR_WINCOM_CHECK(breakers.breaker(L"host").state()
+    == w::Circuit_state::closed);
+
+  // The unreachable host is short-circuited.
+  for (int i{}; i < 2; ++i) {
+    DMITIGR_WINCOM_CHECK_THROW(Error, breakers.call<Error>(L"down", []
+    {
+      throw Error{"unavailable", unavailable};
+    }));
+  }
+  int count{};
+  try {
+    breakers.call<Error>(L"DOWN", [&count]{++count;});
+  } catch (const Error& e) {
+    DMITIGR_WINCOM_CHECK(e.code() == unavailable);
+  }
+  DMITIGR_WINCOM_CHECK(!count);
+  breakers.call<Error>(L"host", [&count]{++count;});
+  DMITIGR_WINCOM_CHECK(count == 1);
+  const auto stats = breakers.stats();
+  DMITIGR_WINCOM_CHECK(stats.opened == 1);
+  DMITIGR_WINCOM_CHECK(stats.short_circuited == 1);
+
+  // The cancelled calls are counted as failures.
+  for (int i{}; i < 2; ++i) {
+    DMITIGR_WINCOM_CHECK_THROW(Error, breakers.call<Error>(L"slow", []
+    {
+      throw Error{"cancelled", canceled};
+    }));
+  }
+  DMITIGR_WINCOM_CHECK(breakers.breaker(L"slow").state()
+    == w::Circuit_state::open);
+
+  // The timed out calls are counted as failures.
+  for (int i{}; i < 2; ++i) {
+    DMITIGR_WINCOM_CHECK_THROW(std::runtime_error,
+      (breakers.call<Error, std::runtime_error>(L"hung", []
+      {
+        throw std::runtime_error{"timeout"};
+      })));
+  }
+  DMITIGR_WINCOM_CHECK(breakers.breaker(L"hung").state()
+    == w::Circuit_state::open);
+  DMITIGR_WINCOM_CHECK(breakers.stats().opened == 3);
+}
+
+void test_wrapper()
+{
+  fake::wmi::register_classes();
+  fake::wmi::repository().add_namespace(L"ROOT\\CIMV2");
+  {
+    const w::Library library;
+    w::wmi::Locator locator;
+    const auto connect = [&locator](const wchar_t* const resource)
+    {
+      locator.connect_server(_bstr_t{resource}, nullptr, nullptr, nullptr, 0,
+        nullptr);
+    };
+
+    w::Circuit_breaker_options options;
+    options.min_call_count = 2;
+    w::configure_circuit_breaker(options);
+    fake::configure_fault("IWbemLocator::ConnectServer", fake::Fault{{}, 1});
+    for (int i{}; i < 2; ++i) {
+      DMITIGR_WINCOM_CHECK_THROW(w::Win_error,
+        connect(L"\\\\down\\root\\cimv2"));
+    }
+    fake::reset_faults();
+
+    // Short-circuited without the call.
+    const auto call_count = fake::call_count("IWbemLocator::ConnectServer");
+    DMITIGR_WINCOM_CHECK_THROW(w::Win_error, connect(L"\\\\DOWN\\root\\cimv2"));
+    DMITIGR_WINCOM_CHECK(fake::call_count("IWbemLocator::ConnectServer")
+      == call_count);
+    DMITIGR_WINCOM_CHECK(w::circuit_breaker_stats().opened == 1);
+    DMITIGR_WINCOM_CHECK(w::circuit_breaker_stats().short_circuited == 1);
+
+    // The other hosts and the local host are not affected.
+    connect(L"\\\\up\\root\\cimv2");
+    connect(L"root\\cimv2");
+    w::configure_circuit_breaker(std::nullopt);
+    connect(L"\\\\down\\root\\cimv2");
+
+    // The calls timed out by the deadline are counted as failures.
+    options.min_call_count = 1;
+    w::configure_circuit_breaker(options);
+    fake::configure_fault("IWbemLocator::ConnectServer",
+      fake::Fault{milliseconds{500}});
+    DMITIGR_WINCOM_CHECK_THROW(w::Timeout_error, w::with_deadline(
+      milliseconds{50}, [&connect]{connect(L"\\\\hung\\root\\cimv2");}));
+    fake::reset_faults();
+    DMITIGR_WINCOM_CHECK_THROW(w::Win_error,
+      connect(L"\\\\hung\\root\\cimv2"));
+    DMITIGR_WINCOM_CHECK(w::circuit_breaker_stats().short_circuited == 1);
+    w::configure_circuit_breaker(std::nullopt);
+  }
+  fake::wmi::repository().clear();
+  DMITIGR_WINCOM_CHECK(!fake::object_count);
+}
+
+} // namespace
+
+int main()
+{
+  return test::run([]
+  {
+    test_opening();
+    test_window();
+    test_half_open();
+    test_breakers();
+    test_wrapper();
+  });
+}
@@ -0,0 +1,105 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../date.hpp"
+#include "unit.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace w = dmitigr::wincom;
+using namespace std::chrono;
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    using Ms = sys_time<milliseconds>;
+    constexpr Ms epoch{sys_days{1899y/December/30}};
+
+    // Validity.
+    DMITIGR_WINCOM_CHECK(w::is_ole_date_valid(w::ole_date_min));
+    DMITIGR_WINCOM_CHECK(!w::is_ole_date_valid(w::ole_date_max));
+    DMITIGR_WINCOM_CHECK(!w::is_ole_date_valid(w::ole_date_min - 1));
+    DMITIGR_WINCOM_CHECK(
+      !w::is_ole_date_valid(std::numeric_limits<double>::quiet_NaN()));
+    DMITIGR_WINCOM_CHECK_THROW(std::out_of_range,
+      w::to_sys_time(w::ole_date_max));
+
+    // Known values.
+    DMITIGR_WINCOM_CHECK(w::to_sys_time(0.0) == epoch);
+    DMITIGR_WINCOM_CHECK(w::to_sys_time(25569.0) == Ms{});
+    DMITIGR_WINCOM_CHECK(w::to_sys_time(2.5) == epoch + days{2} + hours{12});
+    DMITIGR_WINCOM_CHECK(w::to_sys_time(-1.25) == epoch - days{1} + hours{6});
+    DMITIGR_WINCOM_CHECK(w::to_sys_time<seconds>(w::ole_date_min)
+      == sys_days{100y/January/1});
+    DMITIGR_WINCOM_CHECK(w::to_local_time(-1.25)
+      == local_days{1899y/December/29} + hours{6});
+    DMITIGR_WINCOM_CHECK(w::to_ole_date(epoch - days{1} + hours{6}) == -1.25);
+    DMITIGR_WINCOM_CHECK(w::to_ole_date(epoch - days{2} + hours{18}) == -2.75);
+    DMITIGR_WINCOM_CHECK(w::to_ole_date(local_days{1900y/January/1} + 12h)
+      == 2.5);
+
+    // Rounding to the nearest tick.
+    DMITIGR_WINCOM_CHECK(w::to_sys_time<seconds>(1.0 + 0.4/86400)
+      == epoch + days{1});
+    DMITIGR_WINCOM_CHECK(w::to_sys_time<seconds>(1.0 + 0.6/86400)
+      == epoch + days{1} + seconds{1});
+
+    // Round trips over the valid range.
+    {
+      const auto first = w::to_sys_time(w::ole_date_min);
+      const auto last = w::to_sys_time(std::nextafter(w::ole_date_max, 0.0));
+      const milliseconds step{(last - first) / 1'000'003};
+      for (auto t = first; t <= last; t += step) {
+        DMITIGR_WINCOM_CHECK(w::to_sys_time(w::to_ole_date(t)) == t);
+        const auto s = floor<seconds>(t);
+        DMITIGR_WINCOM_CHECK(w::to_sys_time<seconds>(w::to_ole_date(s)) == s);
+      }
+    }
+
+    // Batches.
+    {
+      const std::vector<double> dates{-2.75, -1.25, 0, 0.5, 45000.123456, 1e6};
+      std::vector<Ms> sys(dates.size());
+      std::vector<local_time<milliseconds>> local(dates.size());
+      w::to_sys_time<milliseconds>(dates, sys);
+      w::to_local_time<milliseconds>(dates, local);
+      std::vector<double> back(dates.size());
+      w::to_ole_date<system_clock, milliseconds>(sys, back);
+      for (std::size_t i{}; i < dates.size(); ++i) {
+        DMITIGR_WINCOM_CHECK(sys[i] == w::to_sys_time(dates[i]));
+        DMITIGR_WINCOM_CHECK(local[i].time_since_epoch()
+          == sys[i].time_since_epoch());
+        DMITIGR_WINCOM_CHECK(std::fabs(back[i] - dates[i]) < 1e-8);
+      }
+
+      auto invalid = dates;
+      invalid.back() = w::ole_date_max;
+      std::vector<Ms> result(dates.size());
+      DMITIGR_WINCOM_CHECK_THROW(std::out_of_range,
+        w::to_sys_time<milliseconds>(invalid, result));
+      DMITIGR_WINCOM_CHECK(result.front() == Ms{});
+      std::vector<Ms> small(1);
+      DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+        w::to_sys_time<milliseconds>(dates, small));
+    }
+  });
+}
@@ -0,0 +1,92 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../enumerator.hpp"
+#include "../fake/firewall.hpp"
+#include "../firewall.hpp"
+#include "unit.hpp"
+
+#include <string>
+
+namespace fake = dmitigr::wincom::fake;
+namespace fw = dmitigr::wincom::firewall;
+using dmitigr::wincom::Enumerator_fetcher;
+using dmitigr::wincom::Enumerator_range;
+using dmitigr::wincom::Win_error;
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    fake::firewall::register_classes();
+    {
+      fw::Policy2 policy;
+      auto rules = policy.rules();
+      for (int i{}; i < 5; ++i) {
+        fw::Rule rule;
+        rule.set_name(L"r" + std::to_wstring(i));
+        rule.set_grouping(std::wstring{L"G"});
+        rule.set_enabled(i % 2);
+        rules.add(rule);
+      }
+      DMITIGR_WINCOM_CHECK(rules.count() == 5);
+      DMITIGR_WINCOM_CHECK(
+        rules.rule(std::wstring{L"R3"}).name<std::string>() == "r3");
+
+      // Rule groups (case-insensitively).
+      DMITIGR_WINCOM_CHECK(!policy.is_rule_group_enabled(NET_FW_PROFILE2_ALL,
+          std::wstring{L"G"}));
+      policy.enable_rule_group(NET_FW_PROFILE2_ALL, std::wstring{L"g"}, true);
+      DMITIGR_WINCOM_CHECK(
+        policy.is_rule_group_currently_enabled(std::wstring{L"G"}));
+
+      // Enumeration.
+      rules.remove(std::wstring{L"r0"});
+      Enumerator_range<fw::Rule> range{
+        Enumerator_fetcher<fw::Rule>{rules.enumerator()}};
+      int count{};
+      for (auto& rule : range) {
+        DMITIGR_WINCOM_CHECK(rule.is_enabled());
+        ++count;
+      }
+      DMITIGR_WINCOM_CHECK(count == 4);
+      DMITIGR_WINCOM_CHECK(policy.is_firewall_enabled(NET_FW_PROFILE2_PUBLIC));
+
+      // Authorized applications of the legacy API.
+      fw::Manager manager;
+      auto profile = manager.local_policy().current_profile();
+      fw::Authorized_application app;
+      app.set_name(std::wstring{L"App"});
+      app.set_process_image_file_name(std::wstring{L"C:\\app.exe"});
+      auto apps = profile.authorized_applications();
+      apps.add(app);
+      DMITIGR_WINCOM_CHECK(fake::firewall::store().applications(
+          NET_FW_PROFILE_STANDARD).size() == 1);
+      apps.remove(std::wstring{L"c:\\APP.exe"});
+      DMITIGR_WINCOM_CHECK(fake::firewall::store().applications(
+          NET_FW_PROFILE_STANDARD).empty());
+
+      // Failure injection.
+      fake::configure_fault("INetFwRules::Add", fake::Fault{{}, 1});
+      DMITIGR_WINCOM_CHECK_THROW(Win_error, rules.add(fw::Rule{}));
+      fake::reset_faults();
+    }
+    fake::firewall::store().clear();
+    DMITIGR_WINCOM_CHECK(fake::object_count == 0);
+    CoUninitialize();
+  });
+}
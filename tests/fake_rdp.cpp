@@ -0,0 +1,154 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../fake/rdp.hpp"
+#include "../rdp.hpp"
+#include "unit.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+
+namespace fake = dmitigr::wincom::fake;
+namespace rdp = dmitigr::wincom::rdp;
+
+namespace {
+
+struct Events final {
+  std::map<DISPID, int> counts;
+  long requested_level{};
+};
+
+/*
+ * The state is kept outside of the sink, since the sinks are deleted via
+ * the pointer to rdp::Event_dispatcher.
+ */
+std::map<const void*, Events> events;
+
+class Event_counter final : public rdp::Event_dispatcher {
+public:
+  void set_owner(void*) override
+  {}
+
+  HRESULT Invoke(const DISPID id, REFIID, LCID, WORD,
+    DISPPARAMS* const params, VARIANT*, EXCEPINFO*, UINT*) override
+  {
+    auto& e = events[this];
+    ++e.counts[id];
+    if (id == DISPID_RDPSRAPI_EVENT_ON_CTRLLEVEL_CHANGE_REQUEST) {
+      // The arguments are in the reverse order.
+      DMITIGR_WINCOM_CHECK(params->cArgs == 2);
+      e.requested_level = params->rgvarg[0].lVal;
+      IRDPSRAPIAttendee* attendee{};
+      DMITIGR_WINCOM_CHECK(params->rgvarg[1].pdispVal->QueryInterface(
+          __uuidof(IRDPSRAPIAttendee),
+          reinterpret_cast<void**>(&attendee)) == S_OK);
+      attendee->put_ControlLevel(static_cast<CTRL_LEVEL>(e.requested_level));
+      attendee->Release();
+    }
+    return S_OK;
+  }
+};
+
+/// @returns The sink and its events.
+std::pair<std::unique_ptr<rdp::Event_dispatcher>, Events*> make_sink()
+{
+  auto result = std::make_unique<Event_counter>();
+  auto* const e = &events[result.get()];
+  return {std::move(result), e};
+}
+
+} // namespace
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    fake::rdp::register_classes();
+    {
+      auto [server_sink, server_events] = make_sink();
+      rdp::Server server{std::make_unique<rdp::Sharer>(),
+        std::move(server_sink)};
+      server.open();
+      auto invitations = server.invitation_manager();
+      auto invitation = invitations.create_invitation(std::wstring{L"group"},
+        std::wstring{L"password"}, 1);
+      const auto connection = invitation.connection<std::wstring>();
+      DMITIGR_WINCOM_CHECK(invitations.invitation_count() == 1);
+      DMITIGR_WINCOM_CHECK(
+        invitations.invitation(0).connection<std::wstring>() == connection);
+      server.session_properties().set_clipboard_redirect_enabled(true);
+
+      {
+        auto [client_sink, client_events] = make_sink();
+        rdp::Client client{std::make_unique<rdp::Viewer>(),
+          std::move(client_sink)};
+        client.open(connection, std::wstring{L"me"},
+          std::wstring{L"password"});
+        DMITIGR_WINCOM_CHECK(client_events->counts[
+            DISPID_RDPSRAPI_EVENT_ON_VIEWER_CONNECTED] == 1);
+        DMITIGR_WINCOM_CHECK(client_events->counts[
+            DISPID_RDPSRAPI_EVENT_ON_VIEWER_AUTHENTICATED] == 1);
+        DMITIGR_WINCOM_CHECK(server_events->counts[
+            DISPID_RDPSRAPI_EVENT_ON_ATTENDEE_CONNECTED] == 1);
+
+        // The attendee limit is reached.
+        auto [other_sink, other_events] = make_sink();
+        rdp::Client other{std::make_unique<rdp::Viewer>(),
+          std::move(other_sink)};
+        other.open(connection, std::wstring{L"you"},
+          std::wstring{L"password"});
+        DMITIGR_WINCOM_CHECK(other_events->counts[
+            DISPID_RDPSRAPI_EVENT_ON_VIEWER_CONNECTFAILED] == 1);
+
+        // Control level request.
+        client.set_control_level(CTRL_LEVEL_INTERACTIVE);
+        DMITIGR_WINCOM_CHECK(
+          server_events->requested_level == CTRL_LEVEL_INTERACTIVE);
+        client.set_smart_sizing_enabled(true);
+        DMITIGR_WINCOM_CHECK(client.is_smart_sizing_enabled());
+
+        // Attendee.
+        const auto session = fake::rdp::store().session(3389);
+        DMITIGR_WINCOM_CHECK(session && session->attendees().size() == 1);
+        auto* const raw = session->attendees()[0].get();
+        raw->AddRef();
+        rdp::Attendee attendee{raw};
+        DMITIGR_WINCOM_CHECK(attendee.id() == 1);
+        const auto info = attendee.tcp_connection_info();
+        DMITIGR_WINCOM_CHECK(info.local_port() == 3389);
+        attendee.terminate_connection();
+        DMITIGR_WINCOM_CHECK(client_events->counts[
+            DISPID_RDPSRAPI_EVENT_ON_VIEWER_DISCONNECTED] == 1);
+        DMITIGR_WINCOM_CHECK(server_events->counts[
+            DISPID_RDPSRAPI_EVENT_ON_ATTENDEE_DISCONNECTED] == 1);
+        invitation.revoke();
+        DMITIGR_WINCOM_CHECK(invitation.is_revoked());
+      }
+
+      server.pause();
+      server.resume();
+      DMITIGR_WINCOM_CHECK(server_events->counts[
+          DISPID_RDPSRAPI_EVENT_ON_GRAPHICS_STREAM_PAUSED] == 1);
+      server.close();
+      DMITIGR_WINCOM_CHECK(!fake::rdp::store().session_count());
+    }
+    fake::rdp::store().clear();
+    DMITIGR_WINCOM_CHECK(fake::object_count == 0);
+    CoUninitialize();
+  });
+}
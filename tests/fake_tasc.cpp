@@ -0,0 +1,144 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../fake/tasc.hpp"
+#include "../tasc.hpp"
+#include "unit.hpp"
+
+#include <string>
+#include <vector>
+
+namespace fake = dmitigr::wincom::fake;
+namespace ts = dmitigr::wincom::tasc::v2;
+
+namespace {
+
+const std::wstring task_xml{LR"(<?xml version="1.0" encoding="UTF-16"?>
+<Task version="1.2"
+  xmlns="http://schemas.microsoft.com/windows/2004/02/mit/task">
+  <RegistrationInfo><Author>me &amp; you</Author></RegistrationInfo>
+  <Triggers>
+    <CalendarTrigger>
+      <StartBoundary>2024-01-01T10:00:00</StartBoundary>
+      <ScheduleByMonthDayOfWeek>
+        <Weeks><Week>2</Week><Week>Last</Week></Weeks>
+        <DaysOfWeek><Monday /><Friday/></DaysOfWeek>
+        <Months><January/><March/></Months>
+      </ScheduleByMonthDayOfWeek>
+    </CalendarTrigger>
+    <TimeTrigger>
+      <StartBoundary>2024-01-01T10:00:00</StartBoundary>
+      <Repetition><Interval>PT5M</Interval></Repetition>
+    </TimeTrigger>
+    <BootTrigger/>
+  </Triggers>
+  <Settings>
+    <MultipleInstancesPolicy>Parallel</MultipleInstancesPolicy>
+  </Settings>
+  <!-- comment -->
+  <Actions Context="Author">
+    <Exec><Command>cmd.exe</Command><Arguments>/c echo</Arguments></Exec>
+  </Actions>
+</Task>)"};
+
+} // namespace
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    fake::tasc::register_classes();
+    {
+      ts::Task_service service;
+      service.connect();
+      DMITIGR_WINCOM_CHECK(service.is_connected());
+      auto root = service.folder(std::wstring{L"\\"});
+      root.create_folder(std::wstring{L"App"});
+      auto folder = service.folder(std::wstring{L"\\app"});
+
+      // XML round trip.
+      auto definition = service.new_task();
+      definition.set_xml_text(task_xml);
+      const auto xml = definition.xml_text<std::wstring>();
+      DMITIGR_WINCOM_CHECK(xml.find(L"<Week>Last</Week>") != xml.npos);
+      DMITIGR_WINCOM_CHECK(xml.find(L"me &amp; you") != xml.npos);
+      DMITIGR_WINCOM_CHECK(definition.triggers().snapshot().size() == 3);
+
+      // Registration and instances.
+      ts::Task_registration spec;
+      spec.path = L"T";
+      spec.definition = definition;
+      spec.flags = TASK_CREATE;
+      auto task = folder.register_task(spec);
+      DMITIGR_WINCOM_CHECK(
+        folder.task(std::wstring{L"t"}).path<std::wstring>() == L"\\App\\T");
+      auto instance = task.run();
+      task.run();
+      DMITIGR_WINCOM_CHECK(task.instances().count() == 2);
+      DMITIGR_WINCOM_CHECK(service.running_tasks(0).count() == 2);
+      DMITIGR_WINCOM_CHECK(task.state() == TASK_STATE_RUNNING);
+      instance.stop();
+      DMITIGR_WINCOM_CHECK(task.instances().count() == 1);
+      fake::tasc::store().finish_all();
+      DMITIGR_WINCOM_CHECK(task.state() == TASK_STATE_READY);
+
+      // Bulk registration.
+      {
+        DMITIGR_WINCOM_CHECK(root.register_tasks({}, 4).empty());
+
+        std::vector<ts::Task_registration> specs(21);
+        for (std::size_t i{}; i < specs.size(); ++i) {
+          specs[i].path = L"\\App\\Sub" + std::to_wstring(i % 3) + L"\\T"
+            + std::to_wstring(i);
+          specs[i].definition = task_xml;
+          specs[i].flags = TASK_CREATE_OR_UPDATE;
+        }
+        specs[5].definition = std::wstring{L"<Task><Actions/></Task>"};
+        specs[6].path = L"\\App\\T|6";
+        const auto call_count = fake::call_count("ITaskFolder::RegisterTask");
+        const auto results = root.register_tasks(specs, 4);
+        for (std::size_t i{}; i < results.size(); ++i) {
+          DMITIGR_WINCOM_CHECK(results[i] == (i == 5 ? SCHED_E_MALFORMEDXML :
+              i == 6 ? E_INVALIDARG : S_OK));
+        }
+        DMITIGR_WINCOM_CHECK(fake::call_count("ITaskFolder::RegisterTask")
+          == call_count + 20);
+        DMITIGR_WINCOM_CHECK(
+          service.folder(std::wstring{L"\\App\\Sub1"}).tasks(0).count() == 7);
+
+        // The workers which cannot initialize COM don't leak the proxies.
+        fake::configure_fault("CoInitializeEx",
+          fake::Fault{.failure_rate = 1, .failure = E_OUTOFMEMORY});
+        const auto aborted = root.register_tasks(specs, 4);
+        fake::reset_faults();
+        for (std::size_t i{}; i < aborted.size(); ++i) {
+          DMITIGR_WINCOM_CHECK(aborted[i] == (i == 6 ? E_INVALIDARG : E_ABORT));
+        }
+      }
+
+      // Failure injection.
+      fake::configure_fault("ITaskFolder::GetTask",
+        fake::Fault{.failure_rate = 1, .failure = E_ACCESSDENIED});
+      DMITIGR_WINCOM_CHECK_THROW(std::exception,
+        folder.task(std::wstring{L"T"}));
+      fake::reset_faults();
+    }
+    fake::tasc::store().clear();
+    DMITIGR_WINCOM_CHECK(fake::object_count == 0);
+    CoUninitialize();
+  });
+}
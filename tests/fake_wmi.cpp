@@ -0,0 +1,142 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../fake/wmi.hpp"
+#include "../library.hpp"
+#include "../wmi.hpp"
+#include "unit.hpp"
+
+#include <optional>
+#include <string>
+
+namespace fake = dmitigr::wincom::fake;
+namespace wmi = dmitigr::wincom::wmi;
+using dmitigr::wincom::apply_proxy_blanket;
+using dmitigr::wincom::configure_proxy_blanket;
+using dmitigr::wincom::Library;
+using dmitigr::wincom::Proxy_blanket;
+using dmitigr::wincom::proxy_blanket_stats;
+using dmitigr::wincom::Win_error;
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    fake::wmi::register_classes();
+    auto& repository = fake::wmi::repository();
+    repository.add_namespace(L"ROOT\\CIMV2");
+    for (long i{}; i < 100; ++i)
+      repository.add(L"root\\cimv2", {L"Win32_Process", {
+        {L"Name", _variant_t{(L"p" + std::to_wstring(i)).c_str()}},
+        {L"ProcessId", _variant_t{i}}}});
+
+    {
+      const Library library;
+      wmi::Locator locator;
+      auto services = locator.connect_server(_bstr_t{L"\\\\host\\root\\cimv2"},
+        nullptr, nullptr, nullptr, 0, nullptr);
+
+      // WQL with condition.
+      auto e = services.exec_query(std::wstring{
+        L"SELECT Name FROM Win32_Process WHERE ProcessId = 7"});
+      int count{};
+      while (auto object = e.next()) {
+        const auto value = object.value(L"Name");
+        DMITIGR_WINCOM_CHECK(value.type == CIM_STRING);
+        DMITIGR_WINCOM_CHECK(std::wstring{value.data.data().bstrVal} == L"p7");
+        ++count;
+      }
+      DMITIGR_WINCOM_CHECK(count == 1);
+
+      // Case-insensitive WQL without condition.
+      e = services.exec_query(std::string{"select * from win32_process"});
+      for (count = 0; e.next(); ++count);
+      DMITIGR_WINCOM_CHECK(count == 100);
+      DMITIGR_WINCOM_CHECK(fake::call_count("IEnumWbemClassObject::Next") > 0);
+
+      // Object path.
+      const auto object = services.object(
+        _bstr_t{L"Win32_Process.ProcessId=5"});
+      DMITIGR_WINCOM_CHECK(
+        std::wstring{object.value(L"Name").data.data().bstrVal} == L"p5");
+
+      // Proxy blanket.
+      const auto authn_level = [](IUnknown* const proxy)
+      {
+        IClientSecurity* security{};
+        proxy->QueryInterface(&security);
+        DMITIGR_WINCOM_CHECK(security);
+        DWORD result{};
+        security->QueryBlanket(proxy, nullptr, nullptr, nullptr, &result,
+          nullptr, nullptr, nullptr);
+        security->Release();
+        return result;
+      };
+      const auto stats = proxy_blanket_stats();
+      Proxy_blanket blanket;
+      blanket.authn_level = RPC_C_AUTHN_LEVEL_PKT_PRIVACY;
+      configure_proxy_blanket(blanket);
+      {
+        auto secured = locator.connect_server(
+          _bstr_t{L"\\\\host\\root\\cimv2"}, nullptr, nullptr, nullptr, 0,
+          nullptr);
+        DMITIGR_WINCOM_CHECK(authn_level(&secured.api())
+          == RPC_C_AUTHN_LEVEL_PKT_PRIVACY);
+        for (int i{}; i < 2; ++i) {
+          auto enumerator = secured.exec_query(std::wstring{
+            L"SELECT * FROM Win32_Process"});
+          DMITIGR_WINCOM_CHECK(authn_level(&enumerator.api())
+            == RPC_C_AUTHN_LEVEL_PKT_PRIVACY);
+        }
+        // The enumerators are evicted on release.
+        DMITIGR_WINCOM_CHECK(proxy_blanket_stats().cached == stats.cached + 1);
+
+        // Set once per proxy identity.
+        const auto copy = secured;
+        DMITIGR_WINCOM_CHECK(!apply_proxy_blanket(&secured.api()));
+        IUnknown* unknown{};
+        secured.api().QueryInterface(&unknown);
+        DMITIGR_WINCOM_CHECK(!apply_proxy_blanket(unknown));
+        unknown->Release();
+        DMITIGR_WINCOM_CHECK(proxy_blanket_stats().applied
+          == stats.applied + 3);
+        DMITIGR_WINCOM_CHECK(proxy_blanket_stats().skipped
+          == stats.skipped + 2);
+
+        // Set again once the configuration is changed.
+        configure_proxy_blanket(blanket);
+        DMITIGR_WINCOM_CHECK(apply_proxy_blanket(&secured.api()));
+        DMITIGR_WINCOM_CHECK(!apply_proxy_blanket(&secured.api()));
+      }
+      DMITIGR_WINCOM_CHECK(proxy_blanket_stats().cached == stats.cached);
+      configure_proxy_blanket(std::nullopt);
+      services.exec_query(std::wstring{L"SELECT * FROM Win32_Process"});
+      DMITIGR_WINCOM_CHECK(proxy_blanket_stats().applied
+        == stats.applied + 4);
+      DMITIGR_WINCOM_CHECK(proxy_blanket_stats().skipped
+        == stats.skipped + 3);
+
+      // Failure injection.
+      fake::configure_fault("IWbemLocator::ConnectServer", fake::Fault{{}, 1});
+      DMITIGR_WINCOM_CHECK_THROW(Win_error, locator.connect_server(
+          _bstr_t{L"\\\\down\\root\\cimv2"}, nullptr, nullptr, nullptr, 0,
+          nullptr));
+      fake::reset_faults();
+    }
+    repository.clear();
+    DMITIGR_WINCOM_CHECK(fake::object_count == 0);
+  });
+}
@@ -0,0 +1,130 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../enumerator.hpp"
+#include "../fake/object.hpp"
+#include "../instrumentation.hpp"
+#include "../library.hpp"
+#include "unit.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fake = dmitigr::wincom::fake;
+namespace w = dmitigr::wincom;
+
+namespace {
+
+struct Item final : fake::Object<IDispatch> {};
+
+class Element final : public w::Unknown_api<Element, IDispatch> {
+  using Ua = w::Unknown_api<Element, IDispatch>;
+public:
+  using Ua::Ua;
+};
+
+/// @returns The statistics of `IEnumVARIANT::<method>`.
+w::Call_stats stats(const std::string& method)
+{
+  const auto all = w::call_stats();
+  const auto i = std::find_if(all.begin(), all.end(), [&](const auto& s)
+  {
+    return s.interface_name == "IEnumVARIANT" && s.method_name == method;
+  });
+  return i != all.end() ? *i : w::Call_stats{};
+}
+
+void test_histogram()
+{
+  using H = w::Call_histogram;
+  for (std::uint64_t value{}; value < 100'000; value = value * 3 / 2 + 1) {
+    const auto bucket = H::bucket(value);
+    DMITIGR_WINCOM_CHECK(bucket < H::bucket_count);
+    DMITIGR_WINCOM_CHECK(H::lower_bound(bucket) <= value);
+    DMITIGR_WINCOM_CHECK(value < H::lower_bound(bucket + 1));
+  }
+  DMITIGR_WINCOM_CHECK(H::bucket(~std::uint64_t{}) == H::bucket_count - 1);
+}
+
+void test_enumerator()
+{
+  const w::Library library;
+  {
+    auto items = std::make_shared<fake::Enum_variant::Items>();
+    for (int i{}; i < 10; ++i)
+      items->emplace_back(new Item);
+    w::Enumerator_fetcher<Element> source{w::Enumerator{
+        static_cast<IEnumVARIANT*>(new fake::Enum_variant{items})}};
+
+    // The calls made by the fetcher.
+    auto cursor = source.clone();
+    DMITIGR_WINCOM_CHECK(cursor);
+    cursor->skip(4);
+    w::Enumerator_range<Element> range{std::move(*cursor), {4, false}};
+    int count{};
+    for ([[maybe_unused]] const auto& element : range)
+      ++count;
+    DMITIGR_WINCOM_CHECK(count == 6);
+    DMITIGR_WINCOM_CHECK(stats("Clone").count == 1);
+    DMITIGR_WINCOM_CHECK(stats("Skip").count == 1);
+    DMITIGR_WINCOM_CHECK(stats("Next").count == 2);
+
+    // The calls of the other threads and the failures.
+    fake::configure_fault("IEnumVARIANT::Next", fake::Fault{{}, 1});
+    std::thread{[&source]
+    {
+      DMITIGR_WINCOM_CHECK_THROW(w::Win_error, w::Enumerator_range<Element>{
+          std::move(*source.clone())}.begin());
+    }}.join();
+    fake::reset_faults();
+    const auto next = stats("Next");
+    DMITIGR_WINCOM_CHECK(next.count == 3);
+    DMITIGR_WINCOM_CHECK(next.failure_count == 1);
+    DMITIGR_WINCOM_CHECK(next.last_failure ==
+      HRESULT_FROM_WIN32(RPC_S_SERVER_UNAVAILABLE));
+    DMITIGR_WINCOM_CHECK(next.sampled_count == 2); // the first on each thread
+    DMITIGR_WINCOM_CHECK(next.quantile(1) <= next.max_duration);
+    DMITIGR_WINCOM_CHECK(w::to_json(w::call_stats()).find(
+        "\"interface\":\"IEnumVARIANT\",\"method\":\"Next\",\"count\":3")
+      != std::string::npos);
+
+    // Every call is counted, but only the sampled ones are timed.
+    auto other = source.clone();
+    for (std::uint64_t i{}; i < 2*w::call_sample_period; ++i)
+      other->skip(1);
+    const auto skip = stats("Skip");
+    DMITIGR_WINCOM_CHECK(skip.count == 1 + 2*w::call_sample_period);
+    DMITIGR_WINCOM_CHECK(skip.sampled_count == 3);
+    DMITIGR_WINCOM_CHECK(skip.total_duration >= skip.max_duration);
+  }
+  DMITIGR_WINCOM_CHECK(!fake::object_count);
+}
+
+} // namespace
+
+int main()
+{
+  return w::test::run([]
+  {
+    test_histogram();
+    test_enumerator();
+  });
+}
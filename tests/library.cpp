@@ -0,0 +1,268 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../fake/tasc.hpp"
+#include "../batch_range.hpp"
+#include "../library.hpp"
+#include "../tasc.hpp"
+#include "unit.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <span>
+#include <thread>
+
+namespace fake = dmitigr::wincom::fake;
+namespace ts = dmitigr::wincom::tasc::v2;
+namespace w = dmitigr::wincom;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+namespace {
+
+unsigned init_count() noexcept
+{
+  return fake::detail::thread_state().init_count;
+}
+
+/// Runs `f` on a new thread (without COM initialized).
+template<class F>
+void on_thread(F&& f)
+{
+  std::exception_ptr error;
+  std::thread{[&]
+  {
+    try {
+      f();
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }}.join();
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void test_scope()
+{
+  on_thread([]
+  {
+    DMITIGR_WINCOM_CHECK(!w::current_apartment());
+    {
+      const w::Library library;
+      DMITIGR_WINCOM_CHECK(w::current_apartment()
+        == w::Apartment_model::multithreaded);
+      {
+        const w::Library nested{COINIT_MULTITHREADED};
+        DMITIGR_WINCOM_CHECK(init_count() == 2);
+        DMITIGR_WINCOM_CHECK_THROW(w::Win_error,
+          w::Library{w::Apartment_model::apartment_threaded});
+      }
+      DMITIGR_WINCOM_CHECK(w::current_apartment()
+        == w::Apartment_model::multithreaded);
+      const ts::Task_service service;
+      DMITIGR_WINCOM_CHECK(init_count() == 1);
+    }
+    DMITIGR_WINCOM_CHECK(!w::current_apartment());
+    DMITIGR_WINCOM_CHECK(!init_count());
+  });
+}
+
+void test_ensure_library()
+{
+  on_thread([]
+  {
+    // The wrappers initialize COM lazily, once per thread.
+    {
+      const ts::Task_service service;
+      DMITIGR_WINCOM_CHECK(w::current_apartment()
+        == w::Apartment_model::multithreaded);
+      const auto calls = fake::call_count("CoInitializeEx");
+      const ts::Task_service other;
+      DMITIGR_WINCOM_CHECK(fake::call_count("CoInitializeEx") == calls);
+      DMITIGR_WINCOM_CHECK(init_count() == 1);
+    }
+    // The scope doesn't interfere with the lazy initialization.
+    {
+      const w::Library library;
+      DMITIGR_WINCOM_CHECK(init_count() == 2);
+    }
+    DMITIGR_WINCOM_CHECK(w::current_apartment()
+      == w::Apartment_model::multithreaded);
+
+    // Not uninitialized at the thread exit unless released.
+    w::release_library();
+    DMITIGR_WINCOM_CHECK(!w::current_apartment());
+    DMITIGR_WINCOM_CHECK(!init_count());
+    w::release_library();
+    DMITIGR_WINCOM_CHECK(!init_count());
+
+    DMITIGR_WINCOM_CHECK(w::ensure_library(
+      w::Apartment_model::apartment_threaded)
+      == w::Apartment_model::apartment_threaded);
+    DMITIGR_WINCOM_CHECK(init_count() == 1);
+    w::release_library();
+  });
+
+  // The conflict with the apartment initialized by someone else.
+  on_thread([]
+  {
+    CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+    DMITIGR_WINCOM_CHECK(w::ensure_library()
+      == w::Apartment_model::apartment_threaded);
+    DMITIGR_WINCOM_CHECK(init_count() == 1);
+    w::release_library();
+    DMITIGR_WINCOM_CHECK(init_count() == 1);
+    CoUninitialize();
+  });
+}
+
+void test_require_apartment()
+{
+  on_thread([]
+  {
+    {
+      const w::Library library{w::Apartment_model::apartment_threaded};
+      w::require_apartment(w::Apartment_model::apartment_threaded);
+      DMITIGR_WINCOM_CHECK_THROW(w::Win_error,
+        w::require_apartment(w::Apartment_model::multithreaded));
+    }
+    DMITIGR_WINCOM_CHECK(!init_count());
+
+    // Without the scope the library is initialized lazily.
+    w::require_apartment(w::Apartment_model::multithreaded);
+    DMITIGR_WINCOM_CHECK_THROW(w::Win_error,
+      w::require_apartment(w::Apartment_model::apartment_threaded));
+    DMITIGR_WINCOM_CHECK(init_count() == 1);
+    w::release_library();
+  });
+}
+
+/// The fetcher which checks the apartment of the helper thread.
+struct Fetcher final {
+  using Slot = int;
+  using Value = int;
+  using Thread_scope = w::Library;
+
+  std::size_t count{};
+
+  std::size_t fetch(const std::span<int> slots)
+  {
+    DMITIGR_WINCOM_CHECK(w::current_apartment()
+      == w::Apartment_model::multithreaded);
+    const auto result = std::min(slots.size(), count);
+    for (std::size_t i{}; i < result; ++i)
+      slots[i] = static_cast<int>(count--);
+    return result;
+  }
+
+  int convert(const int slot) const noexcept
+  {
+    return slot;
+  }
+
+  static void clear(int&) noexcept
+  {}
+};
+
+void test_thread_scope()
+{
+  on_thread([]
+  {
+    const w::Library library;
+    int sum{};
+    w::Basic_batch_range<Fetcher> range{Fetcher{100}, {8, true}};
+    for (const auto value : range)
+      sum += value;
+    DMITIGR_WINCOM_CHECK(sum == 5050);
+  });
+}
+
+void test_sampler()
+{
+  on_thread([]
+  {
+    {
+      ts::Task_service_sampler sampler;
+      DMITIGR_WINCOM_CHECK(sampler().empty());
+      DMITIGR_WINCOM_CHECK(init_count() == 1);
+    }
+    // Uninitialized by the sampler rather than at the thread exit.
+    DMITIGR_WINCOM_CHECK(!init_count());
+  });
+}
+
+void test_deadline()
+{
+  const auto elapsed = [start = std::chrono::steady_clock::now()]
+  {
+    return std::chrono::steady_clock::now() - start;
+  };
+
+  // The pending call is cancelled.
+  fake::configure_fault("Test::hang", fake::Fault{seconds{5}});
+  DMITIGR_WINCOM_CHECK_THROW(w::Timeout_error, w::with_deadline(
+    milliseconds{20}, []
+    {
+      w::throw_if_error(fake::enter("Test::hang"), "cannot hang");
+    }));
+  DMITIGR_WINCOM_CHECK(elapsed() < seconds{4});
+
+  // The cancellation is repeated with backoff rather than on every tick.
+  const auto cancel_count = fake::call_count("CoCancelCall");
+  w::with_deadline(milliseconds{20}, []
+  {
+    std::this_thread::sleep_for(milliseconds{400});
+  });
+  const auto cancels = fake::call_count("CoCancelCall") - cancel_count;
+  DMITIGR_WINCOM_CHECK(2 <= cancels && cancels <= 8);
+
+  // The slow cancellation doesn't block the other deadlines.
+  fake::configure_fault("CoCancelCall", fake::Fault{milliseconds{300}});
+  std::thread expired{[]
+  {
+    w::with_deadline(milliseconds{10}, []
+    {
+      std::this_thread::sleep_for(milliseconds{50});
+    });
+  }};
+  std::this_thread::sleep_for(milliseconds{40});
+  const auto start = elapsed();
+  w::with_deadline(seconds{10}, []{});
+  DMITIGR_WINCOM_CHECK(elapsed() - start < milliseconds{100});
+  expired.join();
+  fake::reset_faults();
+}
+
+} // namespace
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    fake::tasc::register_classes();
+    test_scope();
+    test_ensure_library();
+    test_require_apartment();
+    test_thread_scope();
+    test_sampler();
+    test_deadline();
+    fake::tasc::store().clear();
+  });
+}
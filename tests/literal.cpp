@@ -0,0 +1,116 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../fake/firewall.hpp"
+#include "../fake/tasc.hpp"
+#include "../firewall.hpp"
+#include "../literal.hpp"
+#include "../tasc.hpp"
+#include "unit.hpp"
+
+#include <initializer_list>
+#include <optional>
+#include <string_view>
+
+namespace fw = dmitigr::wincom::firewall;
+namespace ts = dmitigr::wincom::tasc::v2;
+namespace w = dmitigr::wincom;
+
+namespace {
+enum class Color { red, green, blue, cyan };
+} // namespace
+
+template<>
+inline constexpr auto dmitigr::wincom::literal_map<Color> =
+  make_literal_map<Color>({
+  {Color::red, "COLOR_RED"},
+  {Color::green, "COLOR_GREEN"},
+  {Color::blue, "COLOR_BLUE"}
+});
+
+namespace {
+
+template<typename E>
+bool is_round_trip(const std::initializer_list<E> values)
+{
+  for (const auto value : values) {
+    const auto* const literal = w::to_literal(value);
+    if (!literal || w::from_literal<E>(literal) != value)
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    // Generic.
+    static_assert(w::to_literal(Color::green)
+      == std::string_view{"COLOR_GREEN"});
+    static_assert(w::from_literal<Color>("COLOR_BLUE") == Color::blue);
+    static_assert(!w::from_literal<Color>("COLOR_CYAN"));
+    static_assert(!w::from_literal<Color>("COLOR_BLU"));
+    static_assert(!w::from_literal<Color>(""));
+    static_assert(!w::to_literal(Color::cyan));
+    DMITIGR_WINCOM_CHECK(is_round_trip({Color::red, Color::green,
+          Color::blue}));
+
+    // Task Scheduler.
+    static_assert(ts::from_literal<TASK_STATE>("TASK_STATE_READY")
+      == TASK_STATE_READY);
+    static_assert(ts::to_literal(TASK_TRIGGER_MONTHLYDOW)
+      == std::string_view{"TASK_TRIGGER_MONTHLYDOW"});
+    DMITIGR_WINCOM_CHECK(is_round_trip({TASK_STATE_UNKNOWN,
+          TASK_STATE_DISABLED, TASK_STATE_QUEUED, TASK_STATE_READY,
+          TASK_STATE_RUNNING}));
+    DMITIGR_WINCOM_CHECK(is_round_trip({TASK_TRIGGER_EVENT, TASK_TRIGGER_TIME,
+          TASK_TRIGGER_DAILY, TASK_TRIGGER_WEEKLY, TASK_TRIGGER_MONTHLY,
+          TASK_TRIGGER_MONTHLYDOW, TASK_TRIGGER_IDLE,
+          TASK_TRIGGER_REGISTRATION, TASK_TRIGGER_BOOT, TASK_TRIGGER_LOGON,
+          TASK_TRIGGER_SESSION_STATE_CHANGE,
+          TASK_TRIGGER_CUSTOM_TRIGGER_01}));
+    DMITIGR_WINCOM_CHECK(!ts::from_literal<TASK_TRIGGER_TYPE2>(
+        "TASK_TRIGGER_MONTHLY_DOW"));
+
+    // Firewall.
+    static_assert(fw::from_literal<NET_FW_ACTION>("NET_FW_ACTION_ALLOW")
+      == NET_FW_ACTION_ALLOW);
+    DMITIGR_WINCOM_CHECK(is_round_trip({NET_FW_ACTION_BLOCK,
+          NET_FW_ACTION_ALLOW}));
+    DMITIGR_WINCOM_CHECK(is_round_trip({NET_FW_IP_PROTOCOL_TCP,
+          NET_FW_IP_PROTOCOL_UDP, NET_FW_IP_PROTOCOL_ANY}));
+    DMITIGR_WINCOM_CHECK(is_round_trip({NET_FW_IP_VERSION_V4,
+          NET_FW_IP_VERSION_V6, NET_FW_IP_VERSION_ANY}));
+    DMITIGR_WINCOM_CHECK(is_round_trip({NET_FW_MODIFY_STATE_OK,
+          NET_FW_MODIFY_STATE_GP_OVERRIDE,
+          NET_FW_MODIFY_STATE_INBOUND_BLOCKED}));
+    DMITIGR_WINCOM_CHECK(is_round_trip({NET_FW_PROFILE_DOMAIN,
+          NET_FW_PROFILE_STANDARD, NET_FW_PROFILE_CURRENT}));
+    DMITIGR_WINCOM_CHECK(is_round_trip({NET_FW_PROFILE2_DOMAIN,
+          NET_FW_PROFILE2_PRIVATE, NET_FW_PROFILE2_PUBLIC,
+          NET_FW_PROFILE2_ALL}));
+    DMITIGR_WINCOM_CHECK(is_round_trip({NET_FW_RULE_DIR_IN,
+          NET_FW_RULE_DIR_OUT}));
+    DMITIGR_WINCOM_CHECK(is_round_trip({NET_FW_SCOPE_ALL,
+          NET_FW_SCOPE_LOCAL_SUBNET, NET_FW_SCOPE_CUSTOM}));
+    DMITIGR_WINCOM_CHECK(is_round_trip({NET_FW_SERVICE_FILE_AND_PRINT,
+          NET_FW_SERVICE_UPNP, NET_FW_SERVICE_REMOTE_DESKTOP,
+          NET_FW_SERVICE_NONE}));
+  });
+}
@@ -0,0 +1,239 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../enumerator.hpp"
+#include "../fake/object.hpp"
+#include "../library.hpp"
+#include "../partitioned_enumeration.hpp"
+#include "unit.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace fake = dmitigr::wincom::fake;
+namespace w = dmitigr::wincom;
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// The stub fetcher
+// -----------------------------------------------------------------------------
+
+/// The stub of the COM apartment.
+struct Apartment final {
+  explicit Apartment(w::Apartment_model) noexcept
+  {}
+};
+
+using Stub_pool = w::Basic_apartment_pool<Apartment>;
+
+/// The fetcher of the consecutive integers.
+class Fetcher final {
+public:
+  using Slot = int;
+  using Value = int;
+
+  Fetcher(const int size, const bool is_cloneable) noexcept
+    : size_{size}
+    , is_cloneable_{is_cloneable}
+  {}
+
+  std::size_t fetch(const std::span<int> slots)
+  {
+    std::size_t result{};
+    for (; result < slots.size() && position_ < size_; ++result)
+      slots[result] = position_++;
+    return result;
+  }
+
+  int convert(const int slot) const noexcept
+  {
+    return slot;
+  }
+
+  static void clear(int&) noexcept
+  {}
+
+  std::optional<Fetcher> clone() const
+  {
+    ++clone_count;
+    return is_cloneable_ ? std::optional<Fetcher>{*this} : std::nullopt;
+  }
+
+  void skip(const std::size_t count) noexcept
+  {
+    position_ = std::min(size_, position_ + static_cast<int>(count));
+  }
+
+  inline static thread_local int clone_count;
+
+private:
+  int size_{};
+  int position_{};
+  bool is_cloneable_{};
+};
+
+void check_sequence(const std::vector<int>& values, const int size)
+{
+  DMITIGR_WINCOM_CHECK(values.size() == static_cast<std::size_t>(size));
+  for (int i{}; i < size; ++i)
+    DMITIGR_WINCOM_CHECK(values[i] == i);
+}
+
+void test_partitions()
+{
+  Stub_pool::Options pool_options;
+  pool_options.worker_count = 4;
+  Stub_pool pool{std::move(pool_options)};
+  w::Partition_options options;
+  options.min_partition_size = 10;
+  options.batch_size = 7;
+
+  // In order, including the elements beyond the expected count.
+  for (const int expected : {1000, 900, 1100}) {
+    Fetcher source{1000, true};
+    Fetcher::clone_count = 0;
+    check_sequence(w::collect_partitioned(source, expected, pool, options),
+      1000);
+    DMITIGR_WINCOM_CHECK(Fetcher::clone_count == 4);
+  }
+
+  // Unordered, every element exactly once.
+  {
+    Fetcher source{1000, true};
+    std::mutex mutex;
+    std::vector<int> counts(1000);
+    w::for_each_partitioned(source, 1000, pool, [&](const int value)
+    {
+      const std::lock_guard lg{mutex};
+      ++counts[value];
+    }, options);
+    for (const int count : counts)
+      DMITIGR_WINCOM_CHECK(count == 1);
+  }
+
+  // Limited number of partitions.
+  {
+    Fetcher source{1000, true};
+    Fetcher::clone_count = 0;
+    options.partition_count = 2;
+    check_sequence(w::collect_partitioned(source, 1000, pool, options), 1000);
+    DMITIGR_WINCOM_CHECK(Fetcher::clone_count == 2);
+    options.partition_count = 0;
+  }
+
+  // Too small to be partitioned.
+  {
+    Fetcher source{15, true};
+    Fetcher::clone_count = 0;
+    check_sequence(w::collect_partitioned(source, 15, pool, options), 15);
+    DMITIGR_WINCOM_CHECK(Fetcher::clone_count == 0);
+  }
+}
+
+void test_fallback()
+{
+  Stub_pool::Options pool_options;
+  pool_options.worker_count = 4;
+  Stub_pool pool{std::move(pool_options)};
+  w::Partition_options options;
+  options.min_partition_size = 10;
+
+  Fetcher source{1000, false};
+  const auto caller = std::this_thread::get_id();
+  int count{};
+  w::for_each_partitioned(source, 1000, pool, [&](const int value)
+  {
+    DMITIGR_WINCOM_CHECK(std::this_thread::get_id() == caller);
+    DMITIGR_WINCOM_CHECK(value == count++);
+  }, options);
+  DMITIGR_WINCOM_CHECK(count == 1000);
+
+  options.batch_size = 0;
+  DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+    w::collect_partitioned(source, 1000, pool, options));
+}
+
+// -----------------------------------------------------------------------------
+// Enumerator
+// -----------------------------------------------------------------------------
+
+struct Item final : fake::Object<IDispatch> {
+  explicit Item(const int index) noexcept
+    : index{index}
+  {}
+
+  int index{};
+};
+
+class Element final : public w::Unknown_api<Element, IDispatch> {
+  using Ua = w::Unknown_api<Element, IDispatch>;
+public:
+  using Ua::Ua;
+
+  int index() const noexcept
+  {
+    return static_cast<const Item&>(w::detail::api(*this)).index;
+  }
+};
+
+void test_enumerator()
+{
+  const w::Library library;
+  {
+    auto items = std::make_shared<fake::Enum_variant::Items>();
+    for (int i{}; i < 1000; ++i)
+      items->emplace_back(new Item{i});
+    w::Enumerator_fetcher<Element> source{w::Enumerator{
+        static_cast<IEnumVARIANT*>(new fake::Enum_variant{items})}};
+    w::Apartment_pool::Options pool_options;
+    pool_options.worker_count = 4;
+    w::Apartment_pool pool{std::move(pool_options)};
+    w::Partition_options options;
+    options.min_partition_size = 10;
+
+    const auto elements = w::collect_partitioned(source, 1000, pool, options);
+    DMITIGR_WINCOM_CHECK(elements.size() == 1000);
+    for (int i{}; i < 1000; ++i)
+      DMITIGR_WINCOM_CHECK(elements[i].index() == i);
+
+    // The errors of the workers are propagated.
+    fake::configure_fault("IEnumVARIANT::Next", fake::Fault{{}, 1});
+    DMITIGR_WINCOM_CHECK_THROW(w::Win_error,
+      w::collect_partitioned(source, 1000, pool, options));
+    fake::reset_faults();
+  }
+  DMITIGR_WINCOM_CHECK(fake::object_count == 0);
+}
+
+} // namespace
+
+int main()
+{
+  return w::test::run([]
+  {
+    test_partitions();
+    test_fallback();
+    test_enumerator();
+  });
+}
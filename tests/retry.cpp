@@ -0,0 +1,279 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../fake/wmi.hpp"
+#include "../library.hpp"
+#include "../retry.hpp"
+#include "../wmi.hpp"
+#include "unit.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace fake = dmitigr::wincom::fake;
+namespace test = dmitigr::wincom::test;
+namespace w = dmitigr::wincom;
+
+using std::chrono::milliseconds;
+
+namespace {
+
+/// The error with `HRESULT`.
+class Error final : public std::runtime_error {
+public:
+  explicit Error(const std::int32_t code)
+    : std::runtime_error{"error"}
+    , code_{code}
+  {}
+
+  std::int32_t code() const noexcept
+  {
+    return code_;
+  }
+
+private:
+  std::int32_t code_{};
+};
+
+/// @returns The policy without jitter.
+w::Retry_policy exact_policy()
+{
+  w::Retry_policy result;
+  result.jitter = 0;
+  return result;
+}
+
+void test_classifier()
+{
+  for (const HRESULT err : {RPC_E_CALL_REJECTED, RPC_E_SERVERCALL_RETRYLATER,
+      HRESULT_FROM_WIN32(RPC_S_SERVER_UNAVAILABLE),
+      static_cast<HRESULT>(RPC_S_SERVER_UNAVAILABLE),
+      WBEM_E_TRANSPORT_FAILURE})
+    DMITIGR_WINCOM_CHECK(w::is_transient_error(err));
+  for (const HRESULT err : {S_OK, S_FALSE, E_FAIL, E_ACCESSDENIED,
+      RPC_E_CALL_CANCELED})
+    DMITIGR_WINCOM_CHECK(!w::is_transient_error(err));
+}
+
+void test_backoff()
+{
+  const w::Retry_policy policy;
+  DMITIGR_WINCOM_CHECK(w::backoff_delay(policy, 0) == milliseconds{100});
+  DMITIGR_WINCOM_CHECK(w::backoff_delay(policy, 1) == milliseconds{200});
+  DMITIGR_WINCOM_CHECK(w::backoff_delay(policy, 5) == milliseconds{3200});
+  DMITIGR_WINCOM_CHECK(w::backoff_delay(policy, 6) == milliseconds{5000});
+  DMITIGR_WINCOM_CHECK(w::backoff_delay(policy, 100) == milliseconds{5000});
+
+  // The jitter reduces the delay by up to the half.
+  DMITIGR_WINCOM_CHECK(w::backoff_delay(policy, 1, .5) == milliseconds{150});
+  DMITIGR_WINCOM_CHECK(w::backoff_delay(policy, 1, 1) == milliseconds{100});
+  DMITIGR_WINCOM_CHECK(w::backoff_delay(policy, 1, 2) == milliseconds{100});
+  DMITIGR_WINCOM_CHECK(w::backoff_delay(policy, 1, -1) == milliseconds{200});
+
+  // The delay of the rejected calls grows with the elapsed time.
+  auto exact = exact_policy();
+  DMITIGR_WINCOM_CHECK(w::rejection_delay(exact, {}) == milliseconds{100});
+  DMITIGR_WINCOM_CHECK(w::rejection_delay(exact, milliseconds{300})
+    == milliseconds{400});
+  // Cancelled after the total delay of the attempts (100 + 200 + 400).
+  DMITIGR_WINCOM_CHECK(w::rejection_delay(exact, milliseconds{650})
+    == milliseconds{50});
+  DMITIGR_WINCOM_CHECK(!w::rejection_delay(exact, milliseconds{700}));
+  exact.timeout = milliseconds{2000};
+  DMITIGR_WINCOM_CHECK(w::rejection_delay(exact, milliseconds{500})
+    == milliseconds{600});
+  DMITIGR_WINCOM_CHECK(w::rejection_delay(exact, milliseconds{1500})
+    == milliseconds{500});
+  DMITIGR_WINCOM_CHECK(!w::rejection_delay(exact, milliseconds{2000}));
+}
+
+void test_with_retry()
+{
+  const test::Fake_clock clock;
+  auto policy = exact_policy();
+
+  // Succeeds after the transient errors.
+  {
+    const auto stats = w::retry_stats();
+    const auto start = clock.now();
+    int attempts{};
+    const auto result = w::basic_with_retry<Error>(policy, [&]
+    {
+      if (++attempts < 3)
+        throw Error{RPC_E_CALL_REJECTED};
+      return attempts;
+    }, clock);
+    DMITIGR_WINCOM_CHECK(result == 3);
+    DMITIGR_WINCOM_CHECK(clock.now() - start == milliseconds{300});
+    const auto after = w::retry_stats();
+    DMITIGR_WINCOM_CHECK(after.calls == stats.calls + 1);
+    DMITIGR_WINCOM_CHECK(after.retries == stats.retries + 2);
+    DMITIGR_WINCOM_CHECK(after.exhausted == stats.exhausted);
+    DMITIGR_WINCOM_CHECK(after.added_latency
+      == stats.added_latency + milliseconds{300});
+  }
+
+  // Not repeated on the other errors.
+  {
+    int attempts{};
+    DMITIGR_WINCOM_CHECK_THROW(Error, w::basic_with_retry<Error>(policy, [&]
+    {
+      ++attempts;
+      throw Error{E_ACCESSDENIED};
+    }, clock));
+    DMITIGR_WINCOM_CHECK_THROW(std::logic_error,
+      w::basic_with_retry<Error>(policy, [&]
+      {
+        ++attempts;
+        throw std::logic_error{"bug"};
+      }, clock));
+    DMITIGR_WINCOM_CHECK(attempts == 2);
+  }
+
+  // Exhausted by the number of attempts.
+  {
+    const auto stats = w::retry_stats();
+    int attempts{};
+    DMITIGR_WINCOM_CHECK_THROW(Error, w::basic_with_retry<Error>(policy, [&]
+    {
+      ++attempts;
+      throw Error{WBEM_E_TRANSPORT_FAILURE};
+    }, clock));
+    DMITIGR_WINCOM_CHECK(attempts == 4);
+    DMITIGR_WINCOM_CHECK(w::retry_stats().exhausted == stats.exhausted + 1);
+  }
+
+  // Exhausted by the deadline: the second delay would exceed it.
+  {
+    policy.timeout = milliseconds{250};
+    const auto start = clock.now();
+    int attempts{};
+    DMITIGR_WINCOM_CHECK_THROW(Error, w::basic_with_retry<Error>(policy, [&]
+    {
+      ++attempts;
+      throw Error{RPC_E_SERVERCALL_RETRYLATER};
+    }, clock));
+    DMITIGR_WINCOM_CHECK(attempts == 2);
+    DMITIGR_WINCOM_CHECK(clock.now() - start == milliseconds{100});
+  }
+
+  // The delays are jittered within the bounds.
+  {
+    w::Retry_policy jittered;
+    jittered.max_attempts = 2;
+    for (int i{}; i < 20; ++i) {
+      const auto start = clock.now();
+      bool is_failed{};
+      w::basic_with_retry<Error>(jittered, [&]
+      {
+        if (!std::exchange(is_failed, true))
+          throw Error{RPC_E_CALL_REJECTED};
+      }, clock);
+      const auto delay = clock.now() - start;
+      DMITIGR_WINCOM_CHECK(milliseconds{50} <= delay);
+      DMITIGR_WINCOM_CHECK(delay <= milliseconds{100});
+    }
+  }
+}
+
+void test_message_filter()
+{
+  w::Message_filter filter{exact_policy()};
+  constexpr auto cancel = static_cast<DWORD>(-1);
+  DMITIGR_WINCOM_CHECK(filter.RetryRejectedCall(nullptr, 0, SERVERCALL_REJECTED)
+    == cancel);
+  DMITIGR_WINCOM_CHECK(filter.RetryRejectedCall(nullptr, 0,
+      SERVERCALL_RETRYLATER) == 100);
+  DMITIGR_WINCOM_CHECK(filter.RetryRejectedCall(nullptr, 650,
+      SERVERCALL_RETRYLATER) == 50);
+  const auto exhausted = w::retry_stats().exhausted;
+  DMITIGR_WINCOM_CHECK(filter.RetryRejectedCall(nullptr, 700,
+      SERVERCALL_RETRYLATER) == cancel);
+  DMITIGR_WINCOM_CHECK(w::retry_stats().exhausted == exhausted + 1);
+  DMITIGR_WINCOM_CHECK(filter.HandleInComingCall(0, nullptr, 0, nullptr)
+    == SERVERCALL_ISHANDLED);
+
+  // Registered in the STA only.
+  std::thread{[]
+  {
+    const w::Library library{w::Apartment_model::apartment_threaded};
+    {
+      const w::Message_filter_registration registration;
+      DMITIGR_WINCOM_CHECK(fake::detail::thread_state().message_filter
+        == &registration.filter());
+    }
+    DMITIGR_WINCOM_CHECK(!fake::detail::thread_state().message_filter);
+  }}.join();
+  std::thread{[]
+  {
+    const w::Library library{w::Apartment_model::multithreaded};
+    DMITIGR_WINCOM_CHECK_THROW(w::Win_error, w::Message_filter_registration{});
+  }}.join();
+}
+
+void test_wrapper()
+{
+  fake::wmi::register_classes();
+  fake::wmi::repository().add_namespace(L"ROOT\\CIMV2");
+  {
+    const w::Library library;
+    w::wmi::Locator locator;
+    auto services = locator.connect_server(_bstr_t{L"\\\\host\\root\\cimv2"},
+      nullptr, nullptr, nullptr, 0, nullptr);
+    const auto query = [&services]
+    {
+      services.exec_query(std::wstring{L"SELECT * FROM Win32_Process"});
+    };
+
+    // Not repeated by default.
+    fake::configure_fault("IWbemServices::ExecQuery",
+      fake::Fault{{}, 1, 2, RPC_E_CALL_REJECTED});
+    DMITIGR_WINCOM_CHECK_THROW(w::Win_error, query());
+    fake::reset_faults();
+
+    auto policy = exact_policy();
+    policy.initial_delay = milliseconds{1};
+    w::configure_retry_policy(policy);
+    const auto stats = w::retry_stats();
+    fake::configure_fault("IWbemServices::ExecQuery",
+      fake::Fault{{}, 1, 2, RPC_E_CALL_REJECTED});
+    query();
+    fake::reset_faults();
+    w::configure_retry_policy(std::nullopt);
+    DMITIGR_WINCOM_CHECK(w::retry_stats().retries == stats.retries + 2);
+  }
+  fake::wmi::repository().clear();
+  DMITIGR_WINCOM_CHECK(!fake::object_count);
+}
+
+} // namespace
+
+int main()
+{
+  return test::run([]
+  {
+    test_classifier();
+    test_backoff();
+    test_with_retry();
+    test_message_filter();
+    test_wrapper();
+  });
+}
@@ -0,0 +1,228 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../fake/runtime.hpp"
+#include "../library.hpp"
+#include "../sta_executor.hpp"
+#include "unit.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace w = dmitigr::wincom;
+
+namespace {
+
+/// The events of the executor thread.
+std::vector<std::string> events;
+std::atomic_int pump_failures;
+std::atomic_int wait_failures;
+std::atomic_int wait_count;
+std::atomic_int poll_count;
+
+/// The stub of the message pump.
+class Pump final {
+public:
+  Pump()
+  {
+    if (pump_failures > 0 && pump_failures-- > 0)
+      throw std::runtime_error{"cannot initialize apartment"};
+  }
+
+  void wait()
+  {
+    ++wait_count;
+    if (wait_failures > 0 && wait_failures-- > 0)
+      throw std::runtime_error{"cannot wait for messages"};
+    std::unique_lock lk{mutex_};
+    woken_.wait(lk, [this]{return is_woken_;});
+    is_woken_ = false;
+    events.emplace_back("wait");
+  }
+
+  void poll()
+  {
+    ++poll_count;
+    events.emplace_back("poll");
+  }
+
+  void wake() noexcept
+  {
+    const std::lock_guard lg{mutex_};
+    is_woken_ = true;
+    woken_.notify_one();
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable woken_;
+  bool is_woken_{};
+};
+
+using Executor = w::Basic_sta_executor<Pump>;
+
+/// The coroutine which is started eagerly and never awaited.
+struct Detached final {
+  struct promise_type final {
+    Detached get_return_object() noexcept {return {};}
+    std::suspend_never initial_suspend() noexcept {return {};}
+    std::suspend_never final_suspend() noexcept {return {};}
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept {std::terminate();}
+  };
+};
+
+Detached resume_on(Executor& executor, std::promise<bool>& resumed)
+{
+  co_await executor.schedule();
+  resumed.set_value(executor.is_current());
+}
+
+void test_submit()
+{
+  Executor executor;
+  DMITIGR_WINCOM_CHECK(!executor.is_current());
+  DMITIGR_WINCOM_CHECK(executor.submit([&executor]
+  {
+    return executor.is_current();
+  }).get());
+
+  auto error = executor.submit([]{throw std::runtime_error{"failed"};});
+  DMITIGR_WINCOM_CHECK_THROW(std::runtime_error, error.get());
+  executor.post([]{throw std::runtime_error{"ignored"};});
+  DMITIGR_WINCOM_CHECK(executor.submit([]{return 1;}).get() == 1);
+
+  std::promise<bool> resumed;
+  resume_on(executor, resumed);
+  DMITIGR_WINCOM_CHECK(resumed.get_future().get());
+
+  const auto stats = executor.stats();
+  DMITIGR_WINCOM_CHECK(stats.executed >= 4);
+  DMITIGR_WINCOM_CHECK(stats.failed == 1);
+  DMITIGR_WINCOM_CHECK(!stats.queued);
+  DMITIGR_WINCOM_CHECK(stats.max_latency >= stats.mean_latency());
+}
+
+void test_messages_between_batches()
+{
+  events.clear();
+  {
+    Executor executor;
+    std::promise<void> done;
+    // Every task posts the next one, so the queue is never empty.
+    std::function<void(int)> chain = [&](const int n)
+    {
+      events.push_back("task");
+      if (n)
+        executor.post([&chain, n]{chain(n - 1);});
+      else
+        done.set_value();
+    };
+    executor.post([&chain]{chain(10);});
+    done.get_future().get();
+  }
+
+  // The messages are dispatched after every batch.
+  std::vector<std::string> tasks;
+  for (const auto& event : events) {
+    if (event != "wait")
+      tasks.push_back(event);
+  }
+  DMITIGR_WINCOM_CHECK(tasks.size() == 22);
+  for (std::size_t i{}; i < tasks.size(); ++i)
+    DMITIGR_WINCOM_CHECK(tasks[i] == (i % 2 ? "poll" : "task"));
+}
+
+void test_lifetime()
+{
+  pump_failures = 1;
+  DMITIGR_WINCOM_CHECK_THROW(std::runtime_error, Executor{});
+
+  std::atomic_int completed{};
+  {
+    Executor executor;
+    for (int i{}; i < 1000; ++i)
+      executor.post([&completed]{++completed;});
+  }
+  // The queued tasks are completed.
+  DMITIGR_WINCOM_CHECK(completed == 1000);
+}
+
+void test_broken_pump()
+{
+  wait_failures = 1;
+  wait_count = 0;
+  Executor executor;
+  for (int i{}; i < 1000 && !executor.pump_error(); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  DMITIGR_WINCOM_CHECK_THROW(std::runtime_error,
+    std::rethrow_exception(executor.pump_error()));
+
+  // The thread doesn't spin and the broken pump is no longer used.
+  std::this_thread::sleep_for(std::chrono::milliseconds{50});
+  DMITIGR_WINCOM_CHECK(wait_count == 1);
+  const int polls = poll_count;
+
+  // The tasks are still run.
+  for (int i{}; i < 100; ++i)
+    DMITIGR_WINCOM_CHECK(executor.submit([i]{return i;}).get() == i);
+  std::atomic_int completed{};
+  executor.post([&completed]{++completed;});
+  DMITIGR_WINCOM_CHECK(executor.submit([&completed]
+  {
+    return completed.load();
+  }).get() == 1);
+  DMITIGR_WINCOM_CHECK(wait_count == 1);
+  DMITIGR_WINCOM_CHECK(poll_count == polls);
+}
+
+void test_sta_executor()
+{
+  w::Sta_executor executor;
+  DMITIGR_WINCOM_CHECK(executor.submit([]
+  {
+    // The apartment is already initialized as STA by the pump.
+    return CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+  }).get() == RPC_E_CHANGED_MODE);
+  for (int i{}; i < 100; ++i)
+    DMITIGR_WINCOM_CHECK(executor.submit([i]{return i;}).get() == i);
+}
+
+} // namespace
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    test_submit();
+    test_messages_between_batches();
+    test_lifetime();
+    test_broken_pump();
+    test_sta_executor();
+  });
+}
@@ -0,0 +1,158 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../tasc_columnar.hpp"
+#include "unit.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace col = dmitigr::wincom::tasc::v2::detail::columnar;
+namespace ts = dmitigr::wincom::tasc::v2;
+using namespace std::chrono;
+
+namespace {
+
+ts::Task_definition_snapshot definition(const int index)
+{
+  ts::Task_definition_snapshot result;
+  result.registration.author = result.intern(L"Author");
+  result.registration.uri = result.intern(L"\\App\\T" + std::to_wstring(index));
+  result.principal.user_id = result.intern(L"SYSTEM");
+  result.principal.logon_type = ts::Logon_type::service_account;
+  result.principal.run_level = ts::Run_level::highest;
+  result.settings.is_enabled = index % 2;
+  result.settings.is_hidden = index % 3;
+
+  ts::Action_snapshot action;
+  action.type = ts::Action_type::show_message;
+  action.path = result.intern(L"cmd.exe");
+  action.arguments = result.intern(L"/c echo é");
+  result.actions.push_back(action);
+
+  ts::Trigger_snapshot trigger;
+  trigger.type = ts::Trigger_type::custom_trigger_01;
+  trigger.start_boundary = ts::Schedule_time{seconds{1'700'000'000 + index}};
+  trigger.repetition.interval = minutes{5};
+  result.triggers.push_back(trigger);
+  trigger.type = ts::Trigger_type::boot;
+  trigger.start_boundary.reset();
+  result.triggers.push_back(trigger);
+  return result;
+}
+
+void test_round_trip()
+{
+  ts::Inventory_writer writer;
+  for (int i{}; i < 5; ++i)
+    writer.add({L"\\App\\T" + std::to_wstring(i), ts::Task_state::running,
+        45000.5 + i}, definition(i));
+  const auto data = writer.serialize();
+
+  const ts::Inventory_reader reader{data};
+  DMITIGR_WINCOM_CHECK(reader.size() == 5);
+  auto cursor = reader.cursor();
+  ts::Inventory_task task;
+  for (int i{}; i < 5; ++i) {
+    DMITIGR_WINCOM_CHECK(cursor.next(task));
+    DMITIGR_WINCOM_CHECK(task.path == "\\App\\T" + std::to_string(i));
+    DMITIGR_WINCOM_CHECK(task.state == ts::Task_state::running);
+    DMITIGR_WINCOM_CHECK(task.author == "Author");
+    DMITIGR_WINCOM_CHECK(task.user_id == "SYSTEM");
+    DMITIGR_WINCOM_CHECK(task.logon_type == ts::Logon_type::service_account);
+    DMITIGR_WINCOM_CHECK(task.run_level == ts::Run_level::highest);
+    DMITIGR_WINCOM_CHECK(task.is_enabled == bool(i % 2));
+    DMITIGR_WINCOM_CHECK(task.is_hidden == bool(i % 3));
+    DMITIGR_WINCOM_CHECK(task.actions.size() == 1);
+    DMITIGR_WINCOM_CHECK(task.actions[0].type
+      == ts::Action_type::show_message);
+    DMITIGR_WINCOM_CHECK(task.actions[0].arguments == "/c echo \xc3\xa9");
+    DMITIGR_WINCOM_CHECK(task.triggers.size() == 2);
+    DMITIGR_WINCOM_CHECK(task.triggers[0].type
+      == ts::Trigger_type::custom_trigger_01);
+    DMITIGR_WINCOM_CHECK(task.triggers[0].start_boundary
+      == ts::Schedule_time{seconds{1'700'000'000 + i}});
+    DMITIGR_WINCOM_CHECK(task.triggers[0].repetition_interval == minutes{5});
+    DMITIGR_WINCOM_CHECK(task.triggers[1].type == ts::Trigger_type::boot);
+    DMITIGR_WINCOM_CHECK(!task.triggers[1].start_boundary);
+    DMITIGR_WINCOM_CHECK(reader.state(i) == ts::Task_state::running);
+  }
+  DMITIGR_WINCOM_CHECK(!cursor.next(task));
+}
+
+void test_out_of_range_values()
+{
+  ts::Inventory_writer writer;
+  writer.add({L"\\A", ts::Task_state::ready}, definition(0));
+
+  // Rejected without a trace in the other rows.
+  DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+    writer.add({L"\\B", static_cast<ts::Task_state>(8)}, definition(1)));
+  DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+    writer.add({L"\\B", static_cast<ts::Task_state>(-1)}, definition(1)));
+  auto bad = definition(1);
+  bad.triggers.back().type = static_cast<ts::Trigger_type>(16);
+  DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+    writer.add({L"\\B", ts::Task_state::ready}, bad));
+  DMITIGR_WINCOM_CHECK(writer.size() == 1);
+
+  writer.add({L"\\C", ts::Task_state::disabled}, definition(2));
+  const auto data = writer.serialize();
+  const ts::Inventory_reader reader{data};
+  DMITIGR_WINCOM_CHECK(reader.size() == 2);
+  DMITIGR_WINCOM_CHECK(reader.state(0) == ts::Task_state::ready);
+  DMITIGR_WINCOM_CHECK(reader.state(1) == ts::Task_state::disabled);
+}
+
+void test_put_bits()
+{
+  // The excess bits are discarded instead of being ORed into the neighbours.
+  const std::vector<std::uint8_t> values{0, 0xff, 0, 5, 0};
+  std::vector<std::uint8_t> data;
+  col::put_bits(data, values, 3);
+  const col::Bit_column column{data, values.size()};
+  DMITIGR_WINCOM_CHECK(column[0] == 0);
+  DMITIGR_WINCOM_CHECK(column[1] == 7);
+  DMITIGR_WINCOM_CHECK(column[2] == 0);
+  DMITIGR_WINCOM_CHECK(column[3] == 5);
+  DMITIGR_WINCOM_CHECK(column[4] == 0);
+
+  data.clear();
+  col::put_bits(data, values, 8);
+  const col::Bit_column bytes{data, values.size()};
+  DMITIGR_WINCOM_CHECK(bytes[1] == 0xff);
+
+  DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+    col::put_bits(data, values, 0));
+  DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+    col::put_bits(data, values, 9));
+}
+
+} // namespace
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    test_round_trip();
+    test_out_of_range_values();
+    test_put_bits();
+  });
+}
@@ -0,0 +1,207 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../tasc_completion.hpp"
+#include "unit.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ts = dmitigr::wincom::tasc::v2;
+using namespace std::chrono;
+using dmitigr::wincom::Timeout_error;
+
+namespace {
+
+/// The running instances and the failures of the sampler.
+struct Service final {
+  std::mutex mutex;
+  std::set<std::wstring> running;
+  int failures{}; // negative value denotes infinity
+  double failure_rate{};
+  std::minstd_rand engine{1};
+
+  std::vector<std::wstring> sample()
+  {
+    const std::lock_guard lg{mutex};
+    if (failures < 0 || (failures > 0 && failures--)
+      || std::bernoulli_distribution{failure_rate}(engine))
+      throw std::runtime_error{"service unavailable"};
+    return {running.begin(), running.end()};
+  }
+
+  void start(const std::wstring& guid)
+  {
+    const std::lock_guard lg{mutex};
+    running.insert(guid);
+  }
+
+  void stop(const std::wstring& guid)
+  {
+    const std::lock_guard lg{mutex};
+    running.erase(guid);
+  }
+};
+
+struct Sampler final {
+  std::shared_ptr<Service> service;
+
+  std::vector<std::wstring> operator()()
+  {
+    return service->sample();
+  }
+};
+
+using Poller = ts::Completion_poller<Sampler>;
+
+Poller::Options options(const unsigned max_failures = 5)
+{
+  Poller::Options result;
+  result.min_interval = milliseconds{1};
+  result.max_interval = milliseconds{10};
+  result.max_failures = max_failures;
+  return result;
+}
+
+template<class T>
+bool is_ready(const std::future<T>& future, const milliseconds timeout)
+{
+  return future.wait_for(timeout) == std::future_status::ready;
+}
+
+} // namespace
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    Poller::Options invalid;
+    invalid.max_failures = 0;
+    DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+      Poller(Sampler{std::make_shared<Service>()}, invalid));
+
+    // Completion.
+    {
+      const auto service = std::make_shared<Service>();
+      Poller poller{Sampler{service}, options()};
+      service->start(L"a");
+      auto a = poller.wait(L"a");
+      DMITIGR_WINCOM_CHECK(!is_ready(a, milliseconds{20}));
+      DMITIGR_WINCOM_CHECK(poller.pending_count() == 1);
+      service->stop(L"a");
+      DMITIGR_WINCOM_CHECK(a.get() >= milliseconds{20});
+      DMITIGR_WINCOM_CHECK(poller.pending_count() == 0);
+    }
+
+    // Transient failures of the sampler are retried.
+    {
+      const auto service = std::make_shared<Service>();
+      service->failures = 4;
+      Poller poller{Sampler{service}, options(5)};
+      auto b = poller.wait(L"b");
+      DMITIGR_WINCOM_CHECK(is_ready(b, seconds{5}));
+      DMITIGR_WINCOM_CHECK(b.get() > Poller::Duration{});
+    }
+
+    // Persistent failures of the sampler are given up after the limit.
+    {
+      const auto service = std::make_shared<Service>();
+      service->failures = -1;
+      Poller poller{Sampler{service}, options(3)};
+      auto c = poller.wait(L"c");
+      DMITIGR_WINCOM_CHECK(is_ready(c, seconds{5}));
+      DMITIGR_WINCOM_CHECK_THROW(std::runtime_error, c.get());
+      DMITIGR_WINCOM_CHECK(poller.pending_count() == 0);
+    }
+
+    // Deadlines.
+    {
+      const auto service = std::make_shared<Service>();
+      service->start(L"d");
+      service->start(L"e");
+      Poller poller{Sampler{service}, options()};
+      auto d = poller.wait(L"d", milliseconds{30});
+      auto e = poller.wait(L"e");
+      DMITIGR_WINCOM_CHECK(is_ready(d, seconds{5}));
+      DMITIGR_WINCOM_CHECK_THROW(Timeout_error, d.get());
+      DMITIGR_WINCOM_CHECK(!is_ready(e, milliseconds{1}));
+
+      // The deadline while the sampler is failing gives its error.
+      service->failures = -1;
+      auto f = poller.wait(L"f", milliseconds{30});
+      DMITIGR_WINCOM_CHECK(is_ready(f, seconds{5}));
+      try {
+        f.get();
+        DMITIGR_WINCOM_CHECK(false);
+      } catch (const Timeout_error&) {
+        DMITIGR_WINCOM_CHECK(false);
+      } catch (const std::runtime_error&) {}
+    }
+
+    // Stopping completes the pending waits.
+    std::future<Poller::Duration> g;
+    {
+      const auto service = std::make_shared<Service>();
+      service->start(L"g");
+      Poller poller{Sampler{service}, options()};
+      g = poller.wait(L"g");
+    }
+    DMITIGR_WINCOM_CHECK_THROW(std::runtime_error, g.get());
+
+    // Many waiters while the sampler fails now and then.
+    {
+      constexpr int thread_count{8};
+      constexpr int wait_count{200};
+      const auto service = std::make_shared<Service>();
+      service->failure_rate = 0.3;
+      Poller poller{Sampler{service}, options(50)};
+      std::atomic_int completed{};
+      std::vector<std::thread> threads;
+      for (int t{}; t < thread_count; ++t) {
+        threads.emplace_back([&, t]
+        {
+          std::vector<std::future<Poller::Duration>> futures;
+          for (int i{}; i < wait_count; ++i) {
+            const auto guid = std::to_wstring(t) + L"." + std::to_wstring(i);
+            service->start(guid);
+            futures.push_back(poller.wait(guid));
+            if (i >= 8)
+              service->stop(std::to_wstring(t) + L"." + std::to_wstring(i - 8));
+          }
+          for (int i{wait_count - 8}; i < wait_count; ++i)
+            service->stop(std::to_wstring(t) + L"." + std::to_wstring(i));
+          for (auto& future : futures) {
+            future.get(); // doesn't throw
+            ++completed;
+          }
+        });
+      }
+      for (auto& thread : threads)
+        thread.join();
+      DMITIGR_WINCOM_CHECK(completed == thread_count * wait_count);
+      DMITIGR_WINCOM_CHECK(poller.pending_count() == 0);
+    }
+  });
+}
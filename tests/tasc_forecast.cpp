@@ -0,0 +1,147 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../hash.hpp"
+#include "../tasc_forecast.hpp"
+#include "unit.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace ts = dmitigr::wincom::tasc::v2;
+using namespace std::chrono;
+using dmitigr::wincom::fnv1a;
+
+namespace {
+
+ts::Trigger_snapshot daily(const ts::Schedule_time start)
+{
+  ts::Trigger_snapshot result;
+  result.type = ts::Trigger_type::daily;
+  result.start_boundary = start;
+  return result;
+}
+
+} // namespace
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    using std::u16string_view;
+    using std::u32string_view;
+    using std::string_view;
+    using std::wstring_view;
+
+    // The hash of UTF-16 code units in little-endian.
+    static_assert(fnv1a(u16string_view{u"\\A"}) == 0xca89033be6b44620);
+    static_assert(fnv1a(u32string_view{U"\U0001F600"}) == 0xf39a100fb654058a);
+    static_assert(fnv1a(u16string_view{u"\xD83D\xDE00"}) == 0xf39a100fb654058a);
+    static_assert(fnv1a(wstring_view{L"\\A"}) == 0xca89033be6b44620);
+    static_assert(fnv1a(string_view{"\\A"}) == 0xca89033be6b44620);
+    DMITIGR_WINCOM_CHECK(ts::task_key(wstring_view{L"\\App\\Backup"})
+      == ts::task_key(string_view{"\\App\\Backup"}));
+
+    DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+      ts::Load_forecaster(sys_seconds{}, minutes{}));
+    DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+      ts::Load_forecaster(sys_seconds{}, minutes{1}, 0));
+
+    const sys_seconds origin{sys_days{2024y/June/1} + 30s};
+    const auto hot = daily(local_days{2024y/January/1} + 2h);
+    const auto hot_east = daily(local_days{2024y/January/1} + 5h);
+    const auto warm = daily(local_days{2024y/January/1} + 3h);
+
+    /*
+     * A fleet of 1000 hosts split between two forecasters. A quarter of the
+     * hosts is at UTC+03:00 and starts the hot task at 05:00 local time,
+     * which is the same instant as 02:00 at UTC+00:00.
+     */
+    ts::Load_forecaster first{origin, hours{24}, 2};
+    ts::Load_forecaster second{origin, hours{24}, 2};
+    DMITIGR_WINCOM_CHECK(first.origin() == sys_days{2024y/June/1});
+    DMITIGR_WINCOM_CHECK(first.horizon() == hours{24});
+    for (int host{}; host < 1000; ++host) {
+      auto& forecaster = host % 2 ? first : second;
+      const bool is_east = host % 4 == 0;
+      const auto& trigger = is_east ? hot_east : hot;
+      const seconds offset{is_east ? 3h : 0h};
+      forecaster.add(wstring_view{L"\\Hot"}, std::span{&trigger, 1},
+        offset);
+      if (host % 10 == 0)
+        forecaster.add(wstring_view{L"\\Warm"}, std::span{&warm, 1}, 0s);
+      // The noise which runs at 02:00 UTC too.
+      forecaster.add(0x1000 + static_cast<std::uint64_t>(host),
+        std::span{&trigger, 1}, offset);
+    }
+    first.merge(second);
+    DMITIGR_WINCOM_CHECK(first.histogram().size() == 1440);
+    DMITIGR_WINCOM_CHECK(first.histogram()[120] == 2000);
+    DMITIGR_WINCOM_CHECK(first.histogram()[180] == 100);
+    DMITIGR_WINCOM_CHECK(first.histogram()[121] == 0);
+    DMITIGR_WINCOM_CHECK(first.peak() == 2000);
+
+    /*
+     * The slot of the noise is overestimated up to the count of the hot task,
+     * but the hot task itself is tracked and never underestimated.
+     */
+    const auto herds = first.herds(100);
+    DMITIGR_WINCOM_CHECK(herds.size() == 3);
+    const auto hot_key = ts::task_key(u16string_view{u"\\Hot"});
+    const auto hot_herd = std::find_if(herds.begin(), herds.end(),
+      [hot_key](const auto& herd){return herd.task_key == hot_key;});
+    DMITIGR_WINCOM_CHECK(hot_herd != herds.end());
+    DMITIGR_WINCOM_CHECK(hot_herd->minute == sys_days{2024y/June/1} + 2h);
+    DMITIGR_WINCOM_CHECK(hot_herd->count == 1000);
+    DMITIGR_WINCOM_CHECK(herds[2].minute == sys_days{2024y/June/1} + 3h);
+    DMITIGR_WINCOM_CHECK(herds[2].task_key
+      == ts::task_key(string_view{"\\Warm"}));
+    DMITIGR_WINCOM_CHECK(herds[2].count == 100);
+    DMITIGR_WINCOM_CHECK(first.herds(2001).empty());
+
+    ts::Load_forecaster other{origin, hours{12}};
+    DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument, first.merge(other));
+
+    first.clear();
+    DMITIGR_WINCOM_CHECK(first.peak() == 0 && first.herds(1).empty());
+
+    // The same local time in the different time zones is not a herd.
+    ts::Load_forecaster zones{origin, hours{24}};
+    zones.add(wstring_view{L"\\Hot"}, std::span{&hot, 1}, 0s);
+    zones.add(wstring_view{L"\\Hot"}, std::span{&hot, 1}, 1h);
+    zones.add(wstring_view{L"\\Hot"}, std::span{&hot, 1}, -5h);
+    DMITIGR_WINCOM_CHECK(zones.histogram()[120] == 1);
+    DMITIGR_WINCOM_CHECK(zones.histogram()[60] == 1);
+    DMITIGR_WINCOM_CHECK(zones.histogram()[420] == 1);
+    DMITIGR_WINCOM_CHECK(zones.herds(2).empty());
+
+    // The triggers of the task which fire within the same minute.
+    ts::Load_forecaster dups{origin, hours{24}};
+    const std::vector<ts::Trigger_snapshot> triggers{
+      daily(local_days{2024y/January/1} + 4h + 10s),
+      daily(local_days{2024y/January/1} + 4h + 40s),
+      daily(local_days{2024y/January/1} + 4h + 1min)};
+    dups.add(wstring_view{L"\\Dup"}, std::span{triggers}, 0s);
+    dups.add(wstring_view{L"\\Dup"}, std::span{triggers}, 0s);
+    DMITIGR_WINCOM_CHECK(dups.histogram()[240] == 2);
+    DMITIGR_WINCOM_CHECK(dups.histogram()[241] == 2);
+    DMITIGR_WINCOM_CHECK(dups.peak() == 2);
+  });
+}
@@ -0,0 +1,170 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../tasc_index.hpp"
+#include "unit.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ts = dmitigr::wincom::tasc::v2;
+
+namespace {
+
+using Q = ts::Task_query;
+using Paths = std::vector<std::wstring_view>;
+
+ts::Task_definition_snapshot definition(const std::wstring_view author,
+  const std::wstring_view command, const std::wstring_view arguments,
+  const ts::Action_type type = ts::Action_type::exec)
+{
+  ts::Task_definition_snapshot result;
+  result.registration.author = result.intern(author);
+  result.registration.uri = result.intern(L"urn:" + std::wstring{command});
+  ts::Action_snapshot action;
+  action.type = type;
+  action.path = result.intern(command);
+  action.arguments = result.intern(arguments);
+  result.actions.push_back(action);
+  return result;
+}
+
+ts::Task_index fixture()
+{
+  ts::Task_index result;
+  result.add(L"\\A", definition(L"Alice", L"powershell.exe", L"-enc AAAA"));
+  result.add(L"\\B", definition(L"Bob", L"PowerShell.exe", L"-File x.ps1"));
+  result.add(L"\\C", definition(L"alice", L"cmd.exe", L"/c echo -enc"));
+  result.add(L"\\D", definition(L"Microsoft", L"powershell.exe", L"-enc",
+      ts::Action_type::com_handler));
+  return result;
+}
+
+void test_leaves()
+{
+  const auto index = fixture();
+  DMITIGR_WINCOM_CHECK(index.size() == 4);
+  DMITIGR_WINCOM_CHECK(index.search(Q::command_line(L"POWERSHELL"))
+    == Paths{L"\\A", L"\\B"});
+  DMITIGR_WINCOM_CHECK(index.search(Q::command_line(L"-enc"))
+    == Paths{L"\\A", L"\\C"});
+  // The needles shorter than a trigram are verified by the scan.
+  DMITIGR_WINCOM_CHECK(index.search(Q::command_line(L"/c"))
+    == Paths{L"\\C"});
+  DMITIGR_WINCOM_CHECK(index.search(Q::command_line(L"")).size() == 4);
+  // The trigrams match but the substring doesn't.
+  DMITIGR_WINCOM_CHECK(index.search(Q::command_line(L"exe -enc x")).empty());
+  DMITIGR_WINCOM_CHECK(index.search(Q::command_line(L"notepad")).empty());
+
+  DMITIGR_WINCOM_CHECK(index.search(Q::author(L"ALICE"))
+    == Paths{L"\\A", L"\\C"});
+  DMITIGR_WINCOM_CHECK(index.search(Q::uri(L"urn:cmd.exe")) == Paths{L"\\C"});
+  DMITIGR_WINCOM_CHECK(index.search(Q::path(L"\\b")) == Paths{L"\\B"});
+  DMITIGR_WINCOM_CHECK(index.search(Q::path(L"\\E")).empty());
+}
+
+void test_boolean()
+{
+  const auto index = fixture();
+  DMITIGR_WINCOM_CHECK(index.search(Q::command_line(L"powershell")
+      && Q::command_line(L"-enc")) == Paths{L"\\A"});
+  DMITIGR_WINCOM_CHECK(index.search(Q::author(L"Bob")
+      || Q::command_line(L"cmd.exe")) == Paths{L"\\B", L"\\C"});
+  DMITIGR_WINCOM_CHECK(index.search(!Q::author(L"alice"))
+    == Paths{L"\\B", L"\\D"});
+  DMITIGR_WINCOM_CHECK(index.search(!!Q::author(L"alice"))
+    == Paths{L"\\A", L"\\C"});
+  DMITIGR_WINCOM_CHECK(index.search(Q::command_line(L"-enc")
+      && !Q::author(L"Alice")).empty());
+  DMITIGR_WINCOM_CHECK(index.search(!Q::author(L"Alice") && !Q::path(L"\\D"))
+    == Paths{L"\\B"});
+  DMITIGR_WINCOM_CHECK(index.search((Q::author(L"Bob") || Q::author(L"alice"))
+      && !Q::command_line(L"-enc")) == Paths{L"\\B"});
+}
+
+void test_updates()
+{
+  auto index = fixture();
+  index.add(L"\\a", definition(L"Bob", L"notepad.exe", L""));
+  DMITIGR_WINCOM_CHECK(index.size() == 4);
+  DMITIGR_WINCOM_CHECK(index.search(Q::command_line(L"-enc"))
+    == Paths{L"\\C"});
+  DMITIGR_WINCOM_CHECK(index.search(Q::author(L"Bob"))
+    == Paths{L"\\B", L"\\a"});
+
+  DMITIGR_WINCOM_CHECK(index.remove(L"\\B"));
+  DMITIGR_WINCOM_CHECK(!index.remove(L"\\B"));
+  DMITIGR_WINCOM_CHECK(index.size() == 3);
+  DMITIGR_WINCOM_CHECK(index.search(Q::author(L"Bob")) == Paths{L"\\a"});
+  DMITIGR_WINCOM_CHECK(index.search(!Q::author(L"Bob"))
+    == Paths{L"\\C", L"\\D"});
+
+  ts::Task_delta<ts::Task_definition_snapshot> delta;
+  delta.change = ts::Task_change::removed;
+  delta.signature.path = L"\\C";
+  index.apply(delta);
+  delta.change = ts::Task_change::added;
+  delta.signature.path = L"\\E";
+  delta.task_definition = definition(L"Eve", L"rundll32.exe", L"x.dll");
+  index.apply(delta);
+  // Modified without the definition are left as is.
+  delta.change = ts::Task_change::modified;
+  delta.task_definition.reset();
+  index.apply(delta);
+  DMITIGR_WINCOM_CHECK(index.size() == 3);
+  DMITIGR_WINCOM_CHECK(index.search(Q::command_line(L"rundll"))
+    == Paths{L"\\E"});
+  DMITIGR_WINCOM_CHECK(index.search(Q::path(L"\\C")).empty());
+
+  index.clear();
+  DMITIGR_WINCOM_CHECK(!index.size());
+  DMITIGR_WINCOM_CHECK(index.search(!Q::path(L"\\E")).empty());
+}
+
+void test_compaction()
+{
+  ts::Task_index index;
+  for (int round{}; round < 4; ++round) {
+    for (int i{}; i < 1000; ++i)
+      index.add(L"\\T" + std::to_wstring(i), definition(L"Author",
+          L"tool" + std::to_wstring(round) + L".exe", L""));
+  }
+  DMITIGR_WINCOM_CHECK(index.size() == 1000);
+  DMITIGR_WINCOM_CHECK(index.search(Q::command_line(L"tool3")).size() == 1000);
+  DMITIGR_WINCOM_CHECK(index.search(Q::command_line(L"tool0")).empty());
+  DMITIGR_WINCOM_CHECK(index.search(Q::author(L"Author")).size() == 1000);
+  const auto paths = index.search(Q::path(L"\\T999"));
+  DMITIGR_WINCOM_CHECK(paths.size() == 1 && paths[0] == L"\\T999");
+
+  index.compact();
+  DMITIGR_WINCOM_CHECK(index.size() == 1000);
+  DMITIGR_WINCOM_CHECK(index.search(Q::command_line(L"tool3")).size() == 1000);
+}
+
+} // namespace
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    test_leaves();
+    test_boolean();
+    test_updates();
+    test_compaction();
+  });
+}
@@ -0,0 +1,203 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../fake/tasc.hpp"
+#include "../tasc.hpp"
+#include "../tasc_monitor.hpp"
+#include "unit.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fake = dmitigr::wincom::fake;
+namespace test = dmitigr::wincom::test;
+namespace ts = dmitigr::wincom::tasc::v2;
+
+using Monitor = ts::Running_task_monitor<>;
+using Event = Monitor::Event;
+using Time_point = Monitor::Time_point;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+namespace {
+
+/// @returns The sample of the task instance `guid`.
+ts::Running_task_sample task(const wchar_t* const guid)
+{
+  return ts::Running_task_sample{guid, std::wstring{L"\\"}.append(guid),
+    ts::Task_state::running, 1};
+}
+
+/// @returns The events emitted by `monitor` on `sample` taken at `now`.
+std::vector<Event> update(Monitor& monitor,
+  std::vector<ts::Running_task_sample> sample, const Time_point now)
+{
+  std::vector<Event> result;
+  const auto count = monitor.update(std::move(sample), now,
+    [&result](Event&& event){result.push_back(std::move(event));});
+  DMITIGR_WINCOM_CHECK(count == result.size());
+  return result;
+}
+
+void test_diff()
+{
+  Monitor monitor;
+  const Time_point t0{seconds{1000}};
+
+  // The first sample starts all the instances (duplicates are ignored).
+  auto events = update(monitor, {task(L"B"), task(L"A"), task(L"B")}, t0);
+  DMITIGR_WINCOM_CHECK(events.size() == 2);
+  DMITIGR_WINCOM_CHECK(events[0].kind == Event::Kind::started);
+  DMITIGR_WINCOM_CHECK(events[0].task.instance_guid == L"A");
+  DMITIGR_WINCOM_CHECK(events[1].task.path == L"\\B");
+  DMITIGR_WINCOM_CHECK(events[1].elapsed == Monitor::Duration{});
+  DMITIGR_WINCOM_CHECK(monitor.running().size() == 2);
+
+  // The same sample emits nothing.
+  const auto t1 = t0 + seconds{1};
+  DMITIGR_WINCOM_CHECK(update(monitor, {task(L"A"), task(L"B")}, t1).empty());
+
+  // The stopped and the started instances.
+  const auto t2 = t1 + seconds{2};
+  events = update(monitor, {task(L"C"), task(L"A")}, t2);
+  DMITIGR_WINCOM_CHECK(events.size() == 2);
+  DMITIGR_WINCOM_CHECK(events[0].kind == Event::Kind::stopped);
+  DMITIGR_WINCOM_CHECK(events[0].task.instance_guid == L"B");
+  DMITIGR_WINCOM_CHECK(events[0].elapsed == seconds{3});
+  DMITIGR_WINCOM_CHECK(events[1].kind == Event::Kind::started);
+  DMITIGR_WINCOM_CHECK(events[1].task.instance_guid == L"C");
+
+  // The start time of the instance is kept while it's running.
+  const auto& running = monitor.running();
+  DMITIGR_WINCOM_CHECK(running.size() == 2);
+  DMITIGR_WINCOM_CHECK(running[0].task.instance_guid == L"A");
+  DMITIGR_WINCOM_CHECK(running[0].started_at == t0);
+  DMITIGR_WINCOM_CHECK(running[1].started_at == t2);
+
+  // All the instances stopped.
+  events = update(monitor, {}, t2 + seconds{5});
+  DMITIGR_WINCOM_CHECK(events.size() == 2);
+  DMITIGR_WINCOM_CHECK(events[0].elapsed == seconds{8});
+  DMITIGR_WINCOM_CHECK(events[1].elapsed == seconds{5});
+  DMITIGR_WINCOM_CHECK(monitor.running().empty());
+}
+
+void test_interval()
+{
+  DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+    Monitor(Monitor::Options{Monitor::Duration{}, seconds{1}}));
+  DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+    Monitor(Monitor::Options{seconds{2}, seconds{1}}));
+
+  Monitor monitor{Monitor::Options{milliseconds{100}, milliseconds{1000}}};
+  DMITIGR_WINCOM_CHECK(monitor.interval() == milliseconds{100});
+  Time_point now{seconds{1000}};
+  update(monitor, {task(L"A")}, now);
+  DMITIGR_WINCOM_CHECK(monitor.interval() == milliseconds{100});
+
+  // Doubled after each quiet sample up to the maximum.
+  for (const int expected : {200, 400, 800, 1000, 1000}) {
+    now += monitor.interval();
+    update(monitor, {task(L"A")}, now);
+    DMITIGR_WINCOM_CHECK(monitor.interval() == milliseconds{expected});
+  }
+
+  // Reset to the minimum after any transition.
+  update(monitor, {}, now + seconds{1});
+  DMITIGR_WINCOM_CHECK(monitor.interval() == milliseconds{100});
+  update(monitor, {}, now + seconds{2});
+  DMITIGR_WINCOM_CHECK(monitor.interval() == milliseconds{200});
+  update(monitor, {task(L"B")}, now + seconds{3});
+  DMITIGR_WINCOM_CHECK(monitor.interval() == milliseconds{100});
+}
+
+void test_running_tasks()
+{
+  CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+  fake::tasc::register_classes();
+  {
+    ts::Task_service service;
+    service.connect();
+    auto root = service.folder(std::wstring{L"\\"});
+    ts::Task_registration spec;
+    spec.path = L"\\Busy";
+    spec.definition = std::wstring{LR"(<Task><Settings>
+      <MultipleInstancesPolicy>Parallel</MultipleInstancesPolicy>
+      </Settings><Actions><Exec><Command>cmd.exe</Command></Exec></Actions>
+      </Task>)"};
+    spec.flags = TASK_CREATE;
+    auto task = root.register_task(spec);
+
+    Monitor monitor;
+    const Time_point t0{seconds{1000}};
+    DMITIGR_WINCOM_CHECK(
+      update(monitor, service.running_tasks(0).samples(), t0).empty());
+
+    auto first = task.run();
+    auto second = task.run();
+    auto third = task.run();
+    auto events = update(monitor, service.running_tasks(0).samples(),
+      t0 + seconds{1});
+    DMITIGR_WINCOM_CHECK(events.size() == 3);
+    for (const auto& event : events) {
+      DMITIGR_WINCOM_CHECK(event.kind == Event::Kind::started);
+      DMITIGR_WINCOM_CHECK(event.task.path == L"\\Busy");
+      DMITIGR_WINCOM_CHECK(event.task.state == ts::Task_state::running);
+    }
+
+    // The stopped instance.
+    const auto guid = second.instance_guid<std::wstring>();
+    second.stop();
+    events = update(monitor, service.running_tasks(0).samples(2),
+      t0 + seconds{3});
+    DMITIGR_WINCOM_CHECK(events.size() == 1);
+    DMITIGR_WINCOM_CHECK(events[0].kind == Event::Kind::stopped);
+    DMITIGR_WINCOM_CHECK(events[0].task.instance_guid == guid);
+    DMITIGR_WINCOM_CHECK(events[0].elapsed == seconds{2});
+    DMITIGR_WINCOM_CHECK(monitor.running().size() == 2);
+
+    // The finished and the new instances.
+    fake::tasc::store().finish_all();
+    auto fourth = task.run();
+    events = update(monitor, service.running_tasks(0).samples(),
+      t0 + seconds{4});
+    DMITIGR_WINCOM_CHECK(events.size() == 3);
+    DMITIGR_WINCOM_CHECK(std::count_if(events.begin(), events.end(),
+      [](const auto& e){return e.kind == Event::Kind::stopped;}) == 2);
+    DMITIGR_WINCOM_CHECK(monitor.running().size() == 1);
+    DMITIGR_WINCOM_CHECK(monitor.running()[0].task.instance_guid
+      == fourth.instance_guid<std::wstring>());
+    fake::tasc::store().finish_all();
+  }
+  fake::tasc::store().clear();
+  CoUninitialize();
+  DMITIGR_WINCOM_CHECK(!fake::object_count);
+}
+
+} // namespace
+
+int main()
+{
+  return test::run([]
+  {
+    test_diff();
+    test_interval();
+    test_running_tasks();
+  });
+}
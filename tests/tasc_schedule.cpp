@@ -0,0 +1,247 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../tasc_schedule.hpp"
+#include "unit.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ts = dmitigr::wincom::tasc::v2;
+using namespace std::chrono;
+
+namespace {
+
+ts::Schedule_time at(const int y, const unsigned m, const unsigned d,
+  const int h = 0, const int mi = 0)
+{
+  return local_days{year{y}/month{m}/day{d}} + hours{h} + minutes{mi};
+}
+
+ts::Trigger_snapshot trigger(const ts::Trigger_type type,
+  const ts::Schedule_time start)
+{
+  ts::Trigger_snapshot result;
+  result.type = type;
+  result.start_boundary = start;
+  return result;
+}
+
+std::vector<ts::Schedule_time> fire_times(const ts::Trigger_snapshot& trigger,
+  const ts::Schedule_time from, const std::size_t count)
+{
+  std::vector<ts::Schedule_time> result;
+  ts::Fire_time_generator generator{trigger, from};
+  while (result.size() < count) {
+    if (const auto t = generator.next())
+      result.push_back(*t);
+    else
+      break;
+  }
+  return result;
+}
+
+using Times = std::vector<ts::Schedule_time>;
+
+} // namespace
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    using ts::Trigger_type;
+
+    // Durations.
+    DMITIGR_WINCOM_CHECK(ts::parse_duration("PT1H") == hours{1});
+    DMITIGR_WINCOM_CHECK(ts::parse_duration(L"P1DT2H3M4S") ==
+      days{1} + hours{2} + minutes{3} + seconds{4});
+    DMITIGR_WINCOM_CHECK(ts::parse_duration("") == seconds{});
+    DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument, ts::parse_duration("P"));
+    DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument, ts::parse_duration("1H"));
+    DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+      ts::parse_duration("PT1H2D"));
+
+    // Boundaries without zone designator.
+    DMITIGR_WINCOM_CHECK(ts::parse_boundary("2024-01-01T10:00:00")
+      == ts::Boundary{at(2024, 1, 1, 10)});
+    DMITIGR_WINCOM_CHECK(ts::parse_boundary(L"2024-02-29T23:59:59.123")
+      == ts::Boundary{at(2024, 2, 29, 23, 59) + seconds{59}});
+    DMITIGR_WINCOM_CHECK(ts::to_schedule_time(ts::Boundary{at(2024, 1, 1)},
+        hours{5}) == at(2024, 1, 1));
+    DMITIGR_WINCOM_CHECK(ts::to_schedule_time(ts::Boundary{at(2024, 1, 1)})
+      == at(2024, 1, 1));
+
+    // Boundaries with zone designator.
+    {
+      const auto utc = ts::parse_boundary("2024-01-01T10:00:00Z");
+      DMITIGR_WINCOM_CHECK(utc == ts::Boundary{sys_days{2024y/1/1} + 10h});
+      DMITIGR_WINCOM_CHECK(ts::parse_boundary(L"2024-01-01T13:30:00+03:30")
+        == utc);
+      DMITIGR_WINCOM_CHECK(ts::parse_boundary("2023-12-31T23:00:00.5-11:00")
+        == utc);
+      DMITIGR_WINCOM_CHECK(ts::to_schedule_time(utc, hours{3})
+        == at(2024, 1, 1, 13));
+      DMITIGR_WINCOM_CHECK(ts::to_schedule_time(utc, -hours{10})
+        == at(2024, 1, 1));
+      DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+        ts::parse_boundary("2024-01-01T10:00:00+03"));
+#ifndef _WIN32
+      // The offset of the host is taken at the instant of the boundary.
+      ::setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+      ::tzset();
+      DMITIGR_WINCOM_CHECK(ts::to_schedule_time(utc) == at(2024, 1, 1, 11));
+      DMITIGR_WINCOM_CHECK(ts::to_schedule_time(
+          ts::parse_boundary("2024-07-01T10:00:00Z")) == at(2024, 7, 1, 12));
+#endif
+    }
+    DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+      ts::parse_boundary("2023-02-29T00:00:00"));
+    DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+      ts::parse_boundary("2024-01-01 00:00:00"));
+
+    // Time trigger without repetition.
+    {
+      const auto t = trigger(Trigger_type::time, at(2024, 1, 1, 10));
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2023, 1, 1), 3)
+        == Times{at(2024, 1, 1, 10)});
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2024, 1, 1, 11), 3).empty());
+    }
+
+    // Time trigger with indefinite repetition started long before `from`.
+    {
+      auto t = trigger(Trigger_type::time, at(2020, 1, 1));
+      t.repetition.interval = hours{1};
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2024, 6, 1), 2)
+        == (Times{at(2024, 6, 1), at(2024, 6, 1, 1)}));
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2024, 6, 1, 0, 30), 1)
+        == Times{at(2024, 6, 1, 1)});
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2020, 6, 1), 1)
+        == Times{at(2020, 6, 1)});
+      DMITIGR_WINCOM_CHECK(ts::next_fire_time(std::span{&t, 1},
+          at(2024, 6, 1, 0, 1)) == at(2024, 6, 1, 1));
+    }
+
+    // Time trigger with limited repetition.
+    {
+      auto t = trigger(Trigger_type::time, at(2024, 1, 1, 10));
+      t.repetition.interval = hours{1};
+      t.repetition.duration = hours{3};
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2024, 1, 1), 3)
+        == (Times{at(2024, 1, 1, 10), at(2024, 1, 1, 11),
+            at(2024, 1, 1, 12)}));
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2024, 1, 2), 1).empty());
+    }
+
+    // Daily trigger every 2 days.
+    {
+      auto t = trigger(Trigger_type::daily, at(2024, 1, 1, 9));
+      t.days_interval = 2;
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2024, 1, 2), 2)
+        == (Times{at(2024, 1, 3, 9), at(2024, 1, 5, 9)}));
+      t.end_boundary = at(2024, 1, 4);
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2024, 1, 2), 2)
+        == Times{at(2024, 1, 3, 9)});
+      t.days_interval = 0;
+      DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+        ts::Fire_time_generator{t});
+    }
+
+    // Daily trigger with indefinite repetition.
+    {
+      auto t = trigger(Trigger_type::daily, at(2020, 1, 1, 1));
+      t.repetition.interval = hours{6};
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2024, 6, 1, 2), 3)
+        == (Times{at(2024, 6, 1, 7), at(2024, 6, 1, 13), at(2024, 6, 1, 19)}));
+    }
+
+    // Weekly trigger on Mondays and Fridays.
+    {
+      auto t = trigger(Trigger_type::weekly, at(2024, 1, 1, 8));
+      t.days_of_week = (1 << 1) | (1 << 5);
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2024, 1, 1), 3)
+        == (Times{at(2024, 1, 1, 8), at(2024, 1, 5, 8), at(2024, 1, 8, 8)}));
+      t.weeks_interval = 2;
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2024, 1, 6), 1)
+        == Times{at(2024, 1, 15, 8)});
+    }
+
+    // Monthly trigger on the 1st, the 15th and the last days.
+    {
+      auto t = trigger(Trigger_type::monthly, at(2024, 1, 1, 12));
+      t.months_of_year = 0b11;
+      t.days_of_month = (1 << 0) | (1 << 14);
+      t.is_run_on_last_day_of_month = true;
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2024, 1, 20), 5)
+        == (Times{at(2024, 1, 31, 12), at(2024, 2, 1, 12), at(2024, 2, 15, 12),
+            at(2024, 2, 29, 12), at(2025, 1, 1, 12)}));
+    }
+
+    // Monthly trigger on the second Monday and the last Friday.
+    {
+      auto t = trigger(Trigger_type::monthly_dow, at(2024, 1, 1, 12));
+      t.months_of_year = 1;
+      t.days_of_week = (1 << 1) | (1 << 5);
+      t.weeks_of_month = 1 << 1;
+      t.is_run_on_last_week_of_month = true;
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2024, 1, 1), 5)
+        == (Times{at(2024, 1, 8, 12), at(2024, 1, 12, 12), at(2024, 1, 26, 12),
+            at(2024, 1, 29, 12), at(2025, 1, 10, 12)}));
+    }
+
+    // Triggers which never fire.
+    {
+      auto t = trigger(Trigger_type::daily, at(2024, 1, 1));
+      t.is_enabled = false;
+      DMITIGR_WINCOM_CHECK(fire_times(t, at(2024, 1, 1), 1).empty());
+      DMITIGR_WINCOM_CHECK(
+        fire_times(trigger(Trigger_type::boot, at(2024, 1, 1)),
+          at(2024, 1, 1), 1).empty());
+    }
+
+    // Batch expansion agrees with the generator.
+    {
+      std::vector<ts::Trigger_snapshot> triggers;
+      for (int i{}; i < 16; ++i) {
+        auto t = trigger(i % 4 == 3 ? Trigger_type::weekly :
+          Trigger_type::daily, at(2023, 1, 1 + i, i));
+        t.days_interval = static_cast<std::int16_t>(1 + i % 3);
+        t.days_of_week = 0x7f;
+        if (i % 5 == 4)
+          t.end_boundary = at(2024, 3, 1);
+        if (i % 7 == 6)
+          t.repetition.interval = hours{5};
+        triggers.push_back(t);
+      }
+      const auto from = at(2024, 2, 20, 7);
+      const auto expanded = ts::expand(triggers, from, 32);
+      for (std::size_t i{}; i < triggers.size(); ++i) {
+        const auto expected = fire_times(triggers[i], from, 32);
+        const auto actual = expanded.of(i);
+        DMITIGR_WINCOM_CHECK(actual.size() == expected.size());
+        for (std::size_t j{}; j < actual.size(); ++j)
+          DMITIGR_WINCOM_CHECK(
+            actual[j] == expected[j].time_since_epoch().count());
+      }
+      const auto next = ts::next_fire_time(triggers, from);
+      DMITIGR_WINCOM_CHECK(next && *next == from);
+    }
+  });
+}
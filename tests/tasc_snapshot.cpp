@@ -0,0 +1,272 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../fake/tasc.hpp"
+#include "../tasc.hpp"
+#include "../tasc_snapshot.hpp"
+#include "unit.hpp"
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+namespace fake = dmitigr::wincom::fake;
+namespace test = dmitigr::wincom::test;
+namespace ts = dmitigr::wincom::tasc::v2;
+
+using namespace std::chrono;
+
+namespace {
+
+const std::wstring definition_xml{LR"(<?xml version="1.0" encoding="UTF-16"?>
+<Task version="1.4">
+  <RegistrationInfo>
+    <Author>Admin</Author>
+    <Description>Nightly backup</Description>
+    <URI>\Backup</URI>
+  </RegistrationInfo>
+  <Triggers>
+    <CalendarTrigger>
+      <StartBoundary>2024-01-01T02:00:00</StartBoundary>
+      <ScheduleByDay><DaysInterval>1</DaysInterval></ScheduleByDay>
+    </CalendarTrigger>
+  </Triggers>
+  <Principals>
+    <Principal id="Author">
+      <UserId>S-1-5-18</UserId>
+      <DisplayName>System</DisplayName>
+      <RunLevel>HighestAvailable</RunLevel>
+    </Principal>
+  </Principals>
+  <Settings>
+    <MultipleInstancesPolicy>Queue</MultipleInstancesPolicy>
+    <StartWhenAvailable>true</StartWhenAvailable>
+    <Hidden>false</Hidden>
+    <ExecutionTimeLimit>PT2H</ExecutionTimeLimit>
+    <Priority>5</Priority>
+    <RestartOnFailure>
+      <Interval>PT5M</Interval>
+      <Count>3</Count>
+    </RestartOnFailure>
+  </Settings>
+  <Actions Context="Author">
+    <Exec id="copy">
+      <Command>robocopy.exe</Command>
+      <Arguments>C:\Data D:\Backup</Arguments>
+      <WorkingDirectory>C:\</WorkingDirectory>
+    </Exec>
+    <ComHandler>
+      <ClassId>{8C57A4B2-0F6E-4A11-9E3B-6F0D3C2B1A00}</ClassId>
+      <Data>full</Data>
+    </ComHandler>
+  </Actions>
+</Task>)"};
+
+/// @returns `xml` with `from` replaced with `to`.
+std::wstring replaced(std::wstring xml, const std::wstring_view from,
+  const std::wstring_view to)
+{
+  const auto pos = xml.find(from);
+  DMITIGR_WINCOM_CHECK(pos != std::wstring::npos);
+  return xml.replace(pos, from.size(), to);
+}
+
+/// The connected service which registers the tasks.
+class Fixture final {
+public:
+  Fixture()
+  {
+    service_.connect();
+  }
+
+  /// @returns The snapshot of the definition registered with `xml`.
+  ts::Task_definition_snapshot snapshot(const std::wstring& xml)
+  {
+    return task(xml).task_definition().snapshot();
+  }
+
+  /// @returns The task registered with `xml`.
+  ts::Registered_task task(const std::wstring& xml)
+  {
+    ts::Task_registration spec;
+    spec.path = L"\\T" + std::to_wstring(++count_);
+    spec.definition = xml;
+    return service_.folder(std::wstring{L"\\"}).register_task(spec);
+  }
+
+  ts::Task_service& service() noexcept
+  {
+    return service_;
+  }
+
+private:
+  ts::Task_service service_;
+  int count_{};
+};
+
+void test_wrappers(Fixture& fixture)
+{
+  const auto definition = fixture.task(definition_xml).task_definition();
+
+  const auto actions = definition.actions();
+  DMITIGR_WINCOM_CHECK(actions.count() == 2);
+  const auto exec = actions.item(1);
+  DMITIGR_WINCOM_CHECK(exec.type() == TASK_ACTION_EXEC);
+  DMITIGR_WINCOM_CHECK(exec.id<std::wstring>() == L"copy");
+  const auto exec_action = ts::Exec_action::query(
+    &dmitigr::wincom::detail::api(exec));
+  DMITIGR_WINCOM_CHECK(exec_action.path<std::wstring>() == L"robocopy.exe");
+  DMITIGR_WINCOM_CHECK(exec_action.arguments<std::wstring>()
+    == L"C:\\Data D:\\Backup");
+  DMITIGR_WINCOM_CHECK(exec_action.working_directory<std::wstring>()
+    == L"C:\\");
+  DMITIGR_WINCOM_CHECK(actions.item(2).type() == TASK_ACTION_COM_HANDLER);
+
+  const auto settings = definition.settings();
+  DMITIGR_WINCOM_CHECK(settings.is_enabled());
+  DMITIGR_WINCOM_CHECK(!settings.is_hidden());
+  DMITIGR_WINCOM_CHECK(settings.is_start_when_available());
+  DMITIGR_WINCOM_CHECK(settings.priority() == 5);
+  DMITIGR_WINCOM_CHECK(settings.restart_count() == 3);
+  DMITIGR_WINCOM_CHECK(settings.restart_interval<std::wstring>() == L"PT5M");
+  DMITIGR_WINCOM_CHECK(settings.multiple_instances() == TASK_INSTANCES_QUEUE);
+  DMITIGR_WINCOM_CHECK(settings.compatibility() == TASK_COMPATIBILITY_V2_2);
+
+  const auto principal = definition.principal();
+  DMITIGR_WINCOM_CHECK(principal.id<std::wstring>() == L"Author");
+  DMITIGR_WINCOM_CHECK(principal.user_id<std::wstring>() == L"S-1-5-18");
+  DMITIGR_WINCOM_CHECK(principal.display_name<std::wstring>() == L"System");
+  DMITIGR_WINCOM_CHECK(principal.run_level() == TASK_RUNLEVEL_HIGHEST);
+
+  // The new exec action of the new definition.
+  auto created = fixture.service().new_task();
+  auto action = created.actions().create(TASK_ACTION_EXEC);
+  auto created_exec = ts::Exec_action::query(
+    &dmitigr::wincom::detail::api(action));
+  created_exec.set_path(std::wstring{L"cmd.exe"})
+    .set_arguments(std::wstring{L"/c exit"})
+    .set_working_directory(std::wstring{L"C:\\Temp"});
+  const auto snapshot = created.snapshot();
+  DMITIGR_WINCOM_CHECK(snapshot.actions.size() == 1);
+  DMITIGR_WINCOM_CHECK(snapshot.text(snapshot.actions[0].path) == L"cmd.exe");
+  DMITIGR_WINCOM_CHECK(snapshot.text(snapshot.actions[0].working_directory)
+    == L"C:\\Temp");
+}
+
+void test_snapshot(Fixture& fixture)
+{
+  const auto s = fixture.snapshot(definition_xml);
+  DMITIGR_WINCOM_CHECK(s.text(s.registration.author) == L"Admin");
+  DMITIGR_WINCOM_CHECK(s.text(s.registration.description)
+    == L"Nightly backup");
+  DMITIGR_WINCOM_CHECK(s.text(s.registration.uri) == L"\\Backup");
+  DMITIGR_WINCOM_CHECK(s.text(s.registration.version).empty());
+
+  DMITIGR_WINCOM_CHECK(s.text(s.principal.id) == L"Author");
+  DMITIGR_WINCOM_CHECK(s.text(s.principal.user_id) == L"S-1-5-18");
+  DMITIGR_WINCOM_CHECK(s.text(s.principal.display_name) == L"System");
+  DMITIGR_WINCOM_CHECK(s.principal.run_level == ts::Run_level::highest);
+
+  DMITIGR_WINCOM_CHECK(s.settings.is_enabled);
+  DMITIGR_WINCOM_CHECK(s.settings.is_start_when_available);
+  DMITIGR_WINCOM_CHECK(!s.settings.is_hidden);
+  DMITIGR_WINCOM_CHECK(s.settings.priority == 5);
+  DMITIGR_WINCOM_CHECK(s.settings.restart_count == 3);
+  DMITIGR_WINCOM_CHECK(s.settings.restart_interval == minutes{5});
+  DMITIGR_WINCOM_CHECK(s.settings.execution_time_limit == hours{2});
+  DMITIGR_WINCOM_CHECK(s.settings.multiple_instances
+    == ts::Instances_policy::queue);
+  DMITIGR_WINCOM_CHECK(s.settings.compatibility == ts::Compatibility::v2_2);
+
+  DMITIGR_WINCOM_CHECK(s.actions.size() == 2);
+  const auto& exec = s.actions[0];
+  DMITIGR_WINCOM_CHECK(exec.type == ts::Action_type::exec);
+  DMITIGR_WINCOM_CHECK(s.text(exec.id) == L"copy");
+  DMITIGR_WINCOM_CHECK(s.text(exec.path) == L"robocopy.exe");
+  DMITIGR_WINCOM_CHECK(s.text(exec.arguments) == L"C:\\Data D:\\Backup");
+  DMITIGR_WINCOM_CHECK(s.text(exec.working_directory) == L"C:\\");
+  DMITIGR_WINCOM_CHECK(s.text(exec.class_id).empty());
+  const auto& handler = s.actions[1];
+  DMITIGR_WINCOM_CHECK(handler.type == ts::Action_type::com_handler);
+  DMITIGR_WINCOM_CHECK(s.text(handler.class_id)
+    == L"{8C57A4B2-0F6E-4A11-9E3B-6F0D3C2B1A00}");
+  DMITIGR_WINCOM_CHECK(s.text(handler.data) == L"full");
+  DMITIGR_WINCOM_CHECK(s.text(handler.path).empty());
+
+  DMITIGR_WINCOM_CHECK(s.triggers.size() == 1);
+  DMITIGR_WINCOM_CHECK(s.triggers[0].type == ts::Trigger_type::daily);
+  DMITIGR_WINCOM_CHECK(s.triggers[0].start_boundary
+    == local_days{2024y/January/1} + 2h);
+}
+
+void test_equality(Fixture& fixture)
+{
+  // The equal definitions.
+  const auto original = fixture.snapshot(definition_xml);
+  const auto same = fixture.snapshot(definition_xml);
+  DMITIGR_WINCOM_CHECK(original == same);
+  DMITIGR_WINCOM_CHECK(original.hash() == same.hash());
+  auto copy = original;
+  DMITIGR_WINCOM_CHECK(copy == original && copy.hash() == original.hash());
+
+  // The definitions differing in a single field.
+  const auto check_differs = [&](const std::wstring_view from,
+    const std::wstring_view to)
+  {
+    const auto other = fixture.snapshot(replaced(definition_xml, from, to));
+    DMITIGR_WINCOM_CHECK(!(other == original));
+    DMITIGR_WINCOM_CHECK(other.hash() != original.hash());
+  };
+  // Action (including the text of the same length).
+  check_differs(L"D:\\Backup</Arguments>", L"E:\\Backup</Arguments>");
+  check_differs(L"<Command>robocopy.exe", L"<Command>xcopy.exe");
+  check_differs(L"<Exec id=\"copy\">", L"<Exec id=\"move\">");
+  check_differs(L"<Data>full</Data>", L"<Data>diff</Data>");
+  // Settings.
+  check_differs(L"<Priority>5", L"<Priority>7");
+  check_differs(L"<Hidden>false", L"<Hidden>true");
+  check_differs(L"<Count>3", L"<Count>4");
+  check_differs(L"PT2H", L"PT3H");
+  check_differs(L"<MultipleInstancesPolicy>Queue",
+    L"<MultipleInstancesPolicy>Parallel");
+  // Principal.
+  check_differs(L"HighestAvailable", L"LeastPrivilege");
+  check_differs(L"S-1-5-18", L"S-1-5-19");
+  check_differs(L"<DisplayName>System", L"<DisplayName>Local");
+  // Registration info and trigger.
+  check_differs(L"<Author>Admin", L"<Author>Other");
+  check_differs(L"T02:00:00", L"T03:00:00");
+}
+
+} // namespace
+
+int main()
+{
+  return test::run([]
+  {
+    CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    fake::tasc::register_classes();
+    {
+      Fixture fixture;
+      test_wrappers(fixture);
+      test_snapshot(fixture);
+      test_equality(fixture);
+    }
+    fake::tasc::store().clear();
+    CoUninitialize();
+    DMITIGR_WINCOM_CHECK(!fake::object_count);
+  });
+}
@@ -0,0 +1,148 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../tasc_sync.hpp"
+#include "unit.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ts = dmitigr::wincom::tasc::v2;
+
+namespace {
+
+using Delta = ts::Task_delta<std::wstring>;
+
+ts::Task_signature signature(std::wstring path, const std::uint64_t xml_hash,
+  const ts::Task_state state = ts::Task_state::ready,
+  const double last_run_time = 0)
+{
+  return {std::move(path), state, last_run_time, xml_hash};
+}
+
+struct Sync_result final {
+  ts::Sync_stats stats;
+  std::vector<Delta> deltas;
+  std::vector<std::wstring> fetched;
+};
+
+Sync_result sync(ts::Inventory_sync& inventory,
+  std::vector<ts::Task_signature> current)
+{
+  Sync_result result;
+  result.stats = inventory.sync(std::move(current),
+    [&result](const ts::Task_signature& sig)
+    {
+      result.fetched.push_back(sig.path);
+      return L"<Task>" + sig.path + L"</Task>";
+    },
+    [&result](Delta&& delta)
+    {
+      result.deltas.push_back(std::move(delta));
+    });
+  return result;
+}
+
+} // namespace
+
+int main()
+{
+  return dmitigr::wincom::test::run([]
+  {
+    using ts::Task_change;
+    using ts::Task_state;
+
+    DMITIGR_WINCOM_CHECK(ts::xml_hash(std::wstring_view{L"<Task/>"})
+      == ts::xml_hash(std::string_view{"<Task/>"}));
+
+    ts::Inventory_sync inventory;
+
+    // The initial sync emits everything as added (duplicates are ignored).
+    {
+      const auto r = sync(inventory, {signature(L"\\B", 2),
+          signature(L"\\A", 1), signature(L"\\C", 3), signature(L"\\A", 1)});
+      DMITIGR_WINCOM_CHECK(r.stats.added == 3 && r.stats.fetched == 3);
+      DMITIGR_WINCOM_CHECK(r.deltas.size() == 3);
+      DMITIGR_WINCOM_CHECK(r.deltas[0].change == Task_change::added);
+      DMITIGR_WINCOM_CHECK(r.deltas[0].signature.path == L"\\A");
+      DMITIGR_WINCOM_CHECK(r.deltas[0].task_definition == L"<Task>\\A</Task>");
+      DMITIGR_WINCOM_CHECK(inventory.signatures().size() == 3);
+      DMITIGR_WINCOM_CHECK(inventory.signatures()[2].path == L"\\C");
+    }
+
+    // Nothing changed, nothing fetched.
+    {
+      const auto r = sync(inventory, {signature(L"\\C", 3),
+          signature(L"\\A", 1), signature(L"\\B", 2)});
+      DMITIGR_WINCOM_CHECK(r.stats.unchanged == 3);
+      DMITIGR_WINCOM_CHECK(r.deltas.empty() && r.fetched.empty());
+    }
+
+    // Every kind of change.
+    {
+      const auto r = sync(inventory, {
+          signature(L"\\A", 1, Task_state::running, 45000.5),
+          signature(L"\\C", 30),
+          signature(L"\\D", 4)});
+      DMITIGR_WINCOM_CHECK(r.stats.added == 1);
+      DMITIGR_WINCOM_CHECK(r.stats.removed == 1);
+      DMITIGR_WINCOM_CHECK(r.stats.modified == 2);
+      DMITIGR_WINCOM_CHECK(r.stats.unchanged == 0);
+      DMITIGR_WINCOM_CHECK(r.stats.fetched == 2);
+      DMITIGR_WINCOM_CHECK((r.fetched == std::vector<std::wstring>{L"\\C",
+          L"\\D"}));
+      DMITIGR_WINCOM_CHECK(r.deltas.size() == 4);
+
+      const auto& a = r.deltas[0];
+      DMITIGR_WINCOM_CHECK(a.change == Task_change::modified);
+      DMITIGR_WINCOM_CHECK(a.changed == (Delta::state | Delta::last_run_time));
+      DMITIGR_WINCOM_CHECK(!a.task_definition);
+
+      const auto& b = r.deltas[1];
+      DMITIGR_WINCOM_CHECK(b.change == Task_change::removed);
+      DMITIGR_WINCOM_CHECK(b.signature == signature(L"\\B", 2));
+
+      const auto& c = r.deltas[2];
+      DMITIGR_WINCOM_CHECK(c.change == Task_change::modified);
+      DMITIGR_WINCOM_CHECK(c.changed == Delta::definition);
+      DMITIGR_WINCOM_CHECK(c.task_definition == L"<Task>\\C</Task>");
+
+      DMITIGR_WINCOM_CHECK(r.deltas[3].change == Task_change::added);
+      DMITIGR_WINCOM_CHECK(r.deltas[3].signature.path == L"\\D");
+    }
+
+    // The state is kept if the emitter throws.
+    {
+      const std::vector current{signature(L"\\A", 1), signature(L"\\E", 5)};
+      DMITIGR_WINCOM_CHECK_THROW(std::runtime_error,
+        inventory.sync(current,
+          [](const ts::Task_signature&){return std::wstring{};},
+          [](Delta&&){throw std::runtime_error{"emit"};}));
+      DMITIGR_WINCOM_CHECK(inventory.signatures().size() == 3);
+      const auto r = sync(inventory, current);
+      DMITIGR_WINCOM_CHECK(r.stats.added == 1 && r.stats.removed == 2);
+      DMITIGR_WINCOM_CHECK(r.stats.modified == 1);
+    }
+
+    // Reset.
+    inventory.reset();
+    DMITIGR_WINCOM_CHECK(inventory.signatures().empty());
+    DMITIGR_WINCOM_CHECK(sync(inventory, {signature(L"\\A", 1)}).stats.added
+      == 1);
+  });
+}
@@ -0,0 +1,215 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../timer_wheel.hpp"
+#include "unit.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace test = dmitigr::wincom::test;
+namespace w = dmitigr::wincom;
+
+using std::chrono::milliseconds;
+
+namespace {
+
+/// The clock with the static time advanced manually.
+struct Clock final {
+  using duration = std::chrono::milliseconds;
+  using rep = duration::rep;
+  using period = duration::period;
+  using time_point = std::chrono::time_point<Clock>;
+  static constexpr bool is_steady{true};
+
+  static time_point current;
+
+  static time_point now() noexcept
+  {
+    return current;
+  }
+
+  static void advance(const duration value) noexcept
+  {
+    current += value;
+  }
+};
+
+Clock::time_point Clock::current{std::chrono::hours{1000}};
+
+using Wheel = w::Basic_timer_wheel<Clock>;
+
+/// Counts the calls of `data` which is `int`.
+bool count(void* const data) noexcept
+{
+  ++*static_cast<int*>(data);
+  return false;
+}
+
+/// Counts the calls of `data` which is `int`, and repeats 3 times.
+bool repeat(void* const data) noexcept
+{
+  return ++*static_cast<int*>(data) < 3;
+}
+
+void test_arming()
+{
+  Wheel wheel{milliseconds{10}, 8};
+  DMITIGR_WINCOM_CHECK(wheel.tick() == milliseconds{10});
+  int fired{};
+  Wheel::Timer timer{count, &fired};
+
+  // The deadline is rounded up to the tick.
+  wheel.arm(timer, Clock::now() + milliseconds{15});
+  DMITIGR_WINCOM_CHECK(wheel.size() == 1);
+  DMITIGR_WINCOM_CHECK_THROW(std::logic_error,
+    wheel.arm(timer, Clock::now()));
+  Clock::advance(milliseconds{15});
+  DMITIGR_WINCOM_CHECK(!wheel.advance(Clock::now()));
+  DMITIGR_WINCOM_CHECK(!fired);
+  Clock::advance(milliseconds{5});
+  DMITIGR_WINCOM_CHECK(wheel.advance(Clock::now()) == 1);
+  DMITIGR_WINCOM_CHECK(fired == 1);
+  DMITIGR_WINCOM_CHECK(!wheel.size());
+
+  // The past deadline expires on the next tick.
+  wheel.arm(timer, Clock::now() - milliseconds{100});
+  DMITIGR_WINCOM_CHECK(!wheel.advance(Clock::now()));
+  Clock::advance(milliseconds{10});
+  DMITIGR_WINCOM_CHECK(wheel.advance(Clock::now()) == 1);
+  DMITIGR_WINCOM_CHECK(fired == 2);
+
+  // The disarmed timer doesn't expire.
+  wheel.arm(timer, Clock::now() + milliseconds{10});
+  DMITIGR_WINCOM_CHECK(wheel.disarm(timer));
+  DMITIGR_WINCOM_CHECK(!wheel.disarm(timer));
+  Clock::advance(milliseconds{100});
+  DMITIGR_WINCOM_CHECK(!wheel.advance(Clock::now()));
+  DMITIGR_WINCOM_CHECK(fired == 2);
+
+  // The repeating timer expires on every tick.
+  int repeated{};
+  Wheel::Timer repeating{repeat, &repeated};
+  wheel.arm(repeating, Clock::now());
+  for (int i{}; i < 5; ++i) {
+    Clock::advance(milliseconds{10});
+    wheel.advance(Clock::now());
+  }
+  DMITIGR_WINCOM_CHECK(repeated == 3);
+  DMITIGR_WINCOM_CHECK(!wheel.size());
+
+  // Invalid arguments.
+  DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+    Wheel(milliseconds{}));
+  DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument,
+    Wheel(milliseconds{1}, 0));
+}
+
+void test_rounds()
+{
+  Wheel wheel{milliseconds{10}, 8};
+  int near{};
+  int far{};
+  Wheel::Timer near_timer{count, &near};
+  Wheel::Timer far_timer{count, &far};
+
+  // The timers of the same slot but of the different rounds.
+  wheel.arm(near_timer, Clock::now() + milliseconds{30});
+  wheel.arm(far_timer, Clock::now() + milliseconds{30 + 3*80});
+  for (int i{}; i < 3; ++i) {
+    Clock::advance(milliseconds{10});
+    wheel.advance(Clock::now());
+  }
+  DMITIGR_WINCOM_CHECK(near == 1);
+  DMITIGR_WINCOM_CHECK(!far);
+  for (int i{}; i < 3*8 - 1; ++i) {
+    Clock::advance(milliseconds{10});
+    wheel.advance(Clock::now());
+  }
+  DMITIGR_WINCOM_CHECK(!far);
+  Clock::advance(milliseconds{10});
+  DMITIGR_WINCOM_CHECK(wheel.advance(Clock::now()) == 1);
+  DMITIGR_WINCOM_CHECK(far == 1);
+
+  // The jump over many rounds expires all the timers.
+  wheel.arm(near_timer, Clock::now() + milliseconds{20});
+  wheel.arm(far_timer, Clock::now() + milliseconds{1000});
+  Clock::advance(milliseconds{10'000});
+  DMITIGR_WINCOM_CHECK(wheel.advance(Clock::now()) == 2);
+  DMITIGR_WINCOM_CHECK(near == 2 && far == 2);
+}
+
+void test_many()
+{
+  constexpr std::size_t timer_count{100'000};
+  Wheel wheel{milliseconds{1}};
+  int fired{};
+  std::vector<std::unique_ptr<Wheel::Timer>> timers;
+  timers.reserve(timer_count);
+  for (std::size_t i{}; i < timer_count; ++i) {
+    timers.push_back(std::make_unique<Wheel::Timer>(count, &fired));
+    wheel.arm(*timers.back(),
+      Clock::now() + milliseconds{static_cast<int>(i % 5000)});
+  }
+  DMITIGR_WINCOM_CHECK(wheel.size() == timer_count);
+  for (std::size_t i{}; i < timer_count; i += 2)
+    DMITIGR_WINCOM_CHECK(wheel.disarm(*timers[i]));
+  DMITIGR_WINCOM_CHECK(wheel.size() == timer_count / 2);
+  for (int i{}; i < 5; ++i) {
+    Clock::advance(milliseconds{1000});
+    wheel.advance(Clock::now());
+  }
+  DMITIGR_WINCOM_CHECK(fired == static_cast<int>(timer_count / 2));
+  DMITIGR_WINCOM_CHECK(!wheel.size());
+}
+
+/// Sets `data` which is `std::atomic_bool`.
+bool set(void* const data) noexcept
+{
+  static_cast<std::atomic_bool*>(data)->store(true);
+  return false;
+}
+
+void test_thread()
+{
+  std::atomic_bool fired{};
+  w::Timer_thread thread{milliseconds{5}};
+  w::Timer_thread::Wheel::Timer timer{set, &fired};
+  thread.wheel().arm(timer,
+    std::chrono::steady_clock::now() + milliseconds{20});
+  for (int i{}; i < 1000 && !fired; ++i)
+    std::this_thread::sleep_for(milliseconds{5});
+  DMITIGR_WINCOM_CHECK(fired);
+  DMITIGR_WINCOM_CHECK(!thread.wheel().size());
+}
+
+} // namespace
+
+int main()
+{
+  return test::run([]
+  {
+    test_arming();
+    test_rounds();
+    test_many();
+    test_thread();
+  });
+}
@@ -0,0 +1,236 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../fake/wmi.hpp"
+#include "../library.hpp"
+#include "../tracing.hpp"
+#include "../wmi.hpp"
+#include "unit.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace fake = dmitigr::wincom::fake;
+namespace w = dmitigr::wincom;
+
+namespace {
+
+/// @returns The kept calls of `method_name`.
+std::vector<w::Trace_event> events(const std::string_view method_name)
+{
+  auto result = w::trace_events();
+  std::erase_if(result, [method_name](const auto& e)
+  {
+    return e.method_name != method_name;
+  });
+  return result;
+}
+
+void test_scope()
+{
+  // Disabled.
+  {
+    w::Trace_scope trace{"Test", "disabled"};
+  }
+  DMITIGR_WINCOM_CHECK(events("disabled").empty());
+
+  w::configure_tracing(w::Trace_config{std::chrono::nanoseconds{0}});
+  {
+    w::Trace_scope trace{"Test", "kept", []
+    {
+      return std::wstring_view{L"hosté \"x\""};
+    }};
+    trace.set_result(E_FAIL);
+  }
+  auto kept = events("kept");
+  DMITIGR_WINCOM_CHECK(kept.size() == 1);
+  DMITIGR_WINCOM_CHECK(kept[0].class_name == "Test");
+  DMITIGR_WINCOM_CHECK(kept[0].args == "host? \"x\"");
+  DMITIGR_WINCOM_CHECK(kept[0].hresult == E_FAIL);
+  DMITIGR_WINCOM_CHECK(!kept[0].is_exception);
+  DMITIGR_WINCOM_CHECK(kept[0].thread);
+
+  // The summary of the arguments is truncated.
+  {
+    w::Trace_scope trace{"Test", "truncated", []
+    {
+      return std::string(100, 'a');
+    }};
+  }
+  DMITIGR_WINCOM_CHECK(events("truncated").at(0).args
+    == std::string(w::detail::Trace_ring::max_args_size, 'a'));
+
+  // Completed by an exception.
+  try {
+    w::Trace_scope trace{"Test", "thrown"};
+    throw std::runtime_error{"error"};
+  } catch (const std::runtime_error&) {}
+  DMITIGR_WINCOM_CHECK(events("thrown").at(0).is_exception);
+
+  // Tail sampling: the fast calls are not kept.
+  w::configure_tracing(w::Trace_config{std::chrono::milliseconds{5}});
+  bool is_summarized{};
+  {
+    w::Trace_scope trace{"Test", "fast", [&is_summarized]
+    {
+      is_summarized = true;
+      return std::string_view{};
+    }};
+  }
+  {
+    w::Trace_scope trace{"Test", "slow"};
+    std::this_thread::sleep_for(std::chrono::milliseconds{6});
+  }
+  DMITIGR_WINCOM_CHECK(events("fast").empty());
+  DMITIGR_WINCOM_CHECK(!is_summarized);
+  const auto slow = events("slow");
+  DMITIGR_WINCOM_CHECK(slow.size() == 1);
+  DMITIGR_WINCOM_CHECK(slow[0].duration >= std::chrono::milliseconds{5});
+  w::configure_tracing(std::nullopt);
+}
+
+void test_ring()
+{
+  w::configure_tracing(w::Trace_config{std::chrono::nanoseconds{0}});
+  const auto count = w::trace_event_count();
+  constexpr auto capacity = w::detail::Trace_ring::capacity;
+  std::thread{[]
+  {
+    for (std::size_t i{}; i < capacity + 44; ++i)
+      w::Trace_scope trace{"Test", "wrapped", [i]{return std::to_string(i);}};
+  }}.join();
+  DMITIGR_WINCOM_CHECK(w::trace_event_count() == count + capacity + 44);
+
+  // Only the most recent calls are kept.
+  const auto wrapped = events("wrapped");
+  DMITIGR_WINCOM_CHECK(wrapped.size() == capacity);
+  std::vector<std::size_t> numbers;
+  for (const auto& e : wrapped)
+    numbers.push_back(std::stoul(e.args));
+  std::sort(numbers.begin(), numbers.end());
+  for (std::size_t i{}; i < numbers.size(); ++i)
+    DMITIGR_WINCOM_CHECK(numbers[i] == i + 44);
+  w::configure_tracing(std::nullopt);
+}
+
+void test_concurrency()
+{
+  w::configure_tracing(w::Trace_config{std::chrono::nanoseconds{0}});
+  std::atomic_bool is_stopped{};
+  std::vector<std::thread> writers;
+  for (const auto* const name : {"first", "second"}) {
+    writers.emplace_back([&is_stopped, name]
+    {
+      const auto args = [name]{return std::string(40, *name);};
+      while (!is_stopped)
+        w::Trace_scope trace{"Test", name, args};
+    });
+  }
+
+  // The reader never sees partially written calls.
+  for (int i{}; i < 200; ++i) {
+    for (const auto& e : w::trace_events()) {
+      if (e.method_name == "first" || e.method_name == "second") {
+        DMITIGR_WINCOM_CHECK(e.class_name == "Test");
+        DMITIGR_WINCOM_CHECK(e.args == std::string(40, e.method_name[0]));
+      }
+    }
+  }
+  is_stopped = true;
+  for (auto& writer : writers)
+    writer.join();
+  DMITIGR_WINCOM_CHECK(events("first").at(0).thread
+    != events("second").at(0).thread);
+  w::configure_tracing(std::nullopt);
+}
+
+void test_chrome_trace()
+{
+  w::Trace_event event;
+  event.class_name = "wmi::Locator";
+  event.method_name = "connect_server";
+  event.args = R"(\\host "a")";
+  event.hresult = E_ACCESSDENIED;
+  event.is_exception = true;
+  event.thread = 3;
+  event.start = std::chrono::steady_clock::time_point{
+    std::chrono::nanoseconds{1'234'567}};
+  event.duration = std::chrono::nanoseconds{3'000'001};
+  DMITIGR_WINCOM_CHECK(w::to_chrome_trace({event, event}) ==
+    R"({"traceEvents":[)"
+    R"({"name":"wmi::Locator::connect_server","cat":"wincom","ph":"X",)"
+    R"("pid":1,"tid":3,"ts":1234.567,"dur":3000.001,"args":{)"
+    R"("hresult":"0x80070005","args":"\\\\host \"a\"","exception":true}},)"
+    R"({"name":"wmi::Locator::connect_server","cat":"wincom","ph":"X",)"
+    R"("pid":1,"tid":3,"ts":1234.567,"dur":3000.001,"args":{)"
+    R"("hresult":"0x80070005","args":"\\\\host \"a\"","exception":true}})"
+    R"(],"displayTimeUnit":"ms"})");
+  DMITIGR_WINCOM_CHECK(w::to_chrome_trace({}) ==
+    R"({"traceEvents":[],"displayTimeUnit":"ms"})");
+}
+
+void test_wrapper()
+{
+  fake::wmi::register_classes();
+  fake::wmi::repository().add_namespace(L"ROOT\\CIMV2");
+  {
+    const w::Library library;
+    w::wmi::Locator locator;
+    w::configure_tracing(w::Trace_config{std::chrono::milliseconds{5}});
+    const auto connect = [&locator](const wchar_t* const resource)
+    {
+      locator.connect_server(_bstr_t{resource}, nullptr, nullptr, nullptr, 0,
+        nullptr);
+    };
+    connect(L"\\\\fast\\root\\cimv2");
+    fake::configure_fault("IWbemLocator::ConnectServer",
+      fake::Fault{std::chrono::milliseconds{6}});
+    connect(L"\\\\slow\\root\\cimv2");
+    fake::reset_faults();
+    w::configure_tracing(std::nullopt);
+
+    const auto connects = events("connect_server");
+    DMITIGR_WINCOM_CHECK(connects.size() == 1);
+    DMITIGR_WINCOM_CHECK(connects[0].class_name == "wmi::Locator");
+    DMITIGR_WINCOM_CHECK(connects[0].args == R"(\\slow\root\cimv2)");
+    DMITIGR_WINCOM_CHECK(connects[0].hresult == S_OK);
+  }
+  fake::wmi::repository().clear();
+  DMITIGR_WINCOM_CHECK(!fake::object_count);
+}
+
+} // namespace
+
+int main()
+{
+  return w::test::run([]
+  {
+    test_scope();
+    test_ring();
+    test_concurrency();
+    test_chrome_trace();
+    test_wrapper();
+  });
+}
@@ -0,0 +1,156 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace dmitigr::wincom::test {
+
+/**
+ * @brief Checks the condition of the test.
+ *
+ * @throws `std::logic_error` with the location if `condition` is `false`.
+ */
+inline void check(const bool condition, const char* const expression,
+  const char* const file, const int line)
+{
+  if (!condition)
+    throw std::logic_error{std::string{file}.append(":")
+      .append(std::to_string(line)).append(": check failed: ")
+      .append(expression)};
+}
+
+/**
+ * @returns `EXIT_SUCCESS` if `f()` returns normally, or `EXIT_FAILURE` if it
+ * throws (the error is printed).
+ */
+template<class F>
+int run(F&& f) noexcept
+{
+  try {
+    f();
+    return EXIT_SUCCESS;
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "%s\n", e.what());
+  } catch (...) {
+    std::fprintf(stderr, "unknown error\n");
+  }
+  return EXIT_FAILURE;
+}
+
+// -----------------------------------------------------------------------------
+// Fake_clock
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief The manually advanced clock compatible with `System_retry_clock`.
+ *
+ * @details The copies share the time.
+ */
+class Fake_clock final {
+public:
+  using Time_point = std::chrono::steady_clock::time_point;
+
+  /// @returns The current time.
+  Time_point now() const noexcept
+  {
+    return *now_;
+  }
+
+  /// Advances the time by `duration`.
+  void sleep_for(const std::chrono::nanoseconds duration) const noexcept
+  {
+    advance(duration);
+  }
+
+  /// Advances the time by `duration`.
+  void advance(const std::chrono::nanoseconds duration) const noexcept
+  {
+    *now_ += std::chrono::duration_cast<Time_point::duration>(duration);
+  }
+
+private:
+  std::shared_ptr<Time_point> now_{
+    std::make_shared<Time_point>(std::chrono::hours{1000})};
+};
+
+// -----------------------------------------------------------------------------
+// Benchmarks
+// -----------------------------------------------------------------------------
+
+/// @returns `small` if the benchmark is run with `--small`, or `full`.
+inline std::size_t workload(const int argc, const char* const* const argv,
+  const std::size_t full, const std::size_t small) noexcept
+{
+  return argc > 1 && !std::strcmp(argv[1], "--small") ? small : full;
+}
+
+/**
+ * @brief Calls `f()` and prints the elapsed time per operation.
+ *
+ * @param count The number of operations made by `f`.
+ *
+ * @returns The elapsed time per operation in nanoseconds.
+ */
+template<class F>
+double measure(const char* const name, const std::size_t count, F&& f)
+{
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const std::chrono::duration<double, std::nano> elapsed{
+    std::chrono::steady_clock::now() - start};
+  const auto result = elapsed.count() / static_cast<double>(count ? count : 1);
+  std::printf("%s: %zu ops, %.1f ns/op, %.3f ms total\n", name, count, result,
+    elapsed.count() / 1e6);
+  return result;
+}
+
+/// Prevents the optimizer from discarding `value`.
+template<typename T>
+inline void do_not_optimize(const T& value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+} // namespace dmitigr::wincom::test
+
+#define DMITIGR_WINCOM_CHECK(...) dmitigr::wincom::test::check( \
+  static_cast<bool>(__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+#define DMITIGR_WINCOM_CHECK_THROW(E, ...) do {                          \
+    bool dmitigr_wincom_is_thrown{};                                    \
+    try {                                                               \
+      __VA_ARGS__;                                                      \
+    } catch (const E&) {                                                \
+      dmitigr_wincom_is_thrown = true;                                  \
+    }                                                                   \
+    dmitigr::wincom::test::check(dmitigr_wincom_is_thrown,              \
+      "throws " #E ": " #__VA_ARGS__, __FILE__, __LINE__);              \
+  } while (false)
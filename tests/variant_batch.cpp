@@ -0,0 +1,221 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "../fake/object.hpp"
+#include "../object.hpp"
+#include "../variant_batch.hpp"
+#include "unit.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace fake = dmitigr::wincom::fake;
+namespace w = dmitigr::wincom;
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// The portable stand-in of VARIANT
+// -----------------------------------------------------------------------------
+
+/// The number of strings which are not freed.
+inline std::ptrdiff_t string_count;
+
+/// The variant which is either empty, or an integer, or an owned string.
+struct Variant final {
+  enum class Type { empty, integer, string } type{};
+  int integer{};
+  std::string* string{};
+};
+
+Variant make_integer(const int value) noexcept
+{
+  return {Variant::Type::integer, value, nullptr};
+}
+
+Variant make_string(std::string value)
+{
+  ++string_count;
+  return {Variant::Type::string, 0, new std::string{std::move(value)}};
+}
+
+struct Traits final {
+  using Variant = ::Variant;
+
+  static void clear(Variant& variant) noexcept
+  {
+    if (variant.type == Variant::Type::string) {
+      delete variant.string;
+      --string_count;
+    }
+    variant = {};
+  }
+
+  static bool is_empty(const Variant& variant) noexcept
+  {
+    return variant.type == Variant::Type::empty;
+  }
+
+  template<class T>
+  static std::optional<T> get(const Variant& variant) noexcept
+  {
+    if constexpr (std::is_same_v<T, int>) {
+      if (variant.type == Variant::Type::integer)
+        return variant.integer;
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+      if (variant.type == Variant::Type::string)
+        return *variant.string;
+    }
+    return std::nullopt;
+  }
+};
+
+using Batch = w::Basic_variant_batch<Traits>;
+
+void test_fill()
+{
+  {
+    Batch batch{4};
+    DMITIGR_WINCOM_CHECK(batch.capacity() == 4);
+    DMITIGR_WINCOM_CHECK(batch.is_empty());
+
+    // Filling by the callee.
+    auto slots = batch.prepare();
+    DMITIGR_WINCOM_CHECK(slots.size() == 4);
+    slots[0] = make_integer(1);
+    slots[1] = make_string("two");
+    batch.commit(2);
+    DMITIGR_WINCOM_CHECK(batch.size() == 2);
+    DMITIGR_WINCOM_CHECK(batch.get<int>(0) == 1);
+    DMITIGR_WINCOM_CHECK(!batch.get<int>(1));
+    DMITIGR_WINCOM_CHECK(batch.get<std::string_view>(1) == "two");
+    // The value refers to the data owned by the batch.
+    DMITIGR_WINCOM_CHECK(batch.get<std::string_view>(1)->data()
+      == batch[1].string->data());
+    DMITIGR_WINCOM_CHECK_THROW(std::out_of_range, batch.get<int>(2));
+    DMITIGR_WINCOM_CHECK_THROW(std::out_of_range, batch.commit(5));
+
+    // Reuse clears the filled slots.
+    slots = batch.prepare();
+    DMITIGR_WINCOM_CHECK(batch.is_empty());
+    DMITIGR_WINCOM_CHECK(!string_count);
+    DMITIGR_WINCOM_CHECK(batch.stats().cleared == 2);
+
+    // Filling one by one.
+    for (int i{}; i < 4; ++i)
+      batch.add() = make_string(std::to_string(i));
+    DMITIGR_WINCOM_CHECK_THROW(std::length_error, batch.add());
+    DMITIGR_WINCOM_CHECK(batch.filled().size() == 4);
+    DMITIGR_WINCOM_CHECK(string_count == 4);
+
+    // Detached values are owned by the caller.
+    auto detached = batch.detach(3);
+    DMITIGR_WINCOM_CHECK(Traits::is_empty(batch[3]));
+    batch.clear();
+    DMITIGR_WINCOM_CHECK(string_count == 1);
+    Traits::clear(detached);
+
+    DMITIGR_WINCOM_CHECK(batch.stats().batches == 2);
+    DMITIGR_WINCOM_CHECK(batch.stats().cleared == 6);
+    DMITIGR_WINCOM_CHECK(!batch.stats().leaked);
+
+    batch.add() = make_string("x");
+  }
+  // The destructor clears the filled slots.
+  DMITIGR_WINCOM_CHECK(!string_count);
+
+  DMITIGR_WINCOM_CHECK_THROW(std::invalid_argument, Batch{0});
+}
+
+void test_leaks()
+{
+#ifndef NDEBUG
+  Batch batch{4};
+  auto slots = batch.prepare();
+  slots[0] = make_string("a");
+  slots[1] = make_string("b");
+  batch.commit(1); // the slot 1 is filled but not committed
+  batch.prepare();
+  DMITIGR_WINCOM_CHECK(batch.stats().leaked == 1);
+  DMITIGR_WINCOM_CHECK(!string_count);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Variant_batch
+// -----------------------------------------------------------------------------
+
+struct Item final : fake::Object<IDispatch> {};
+
+void test_variant_batch()
+{
+  {
+    auto items = std::make_shared<fake::Enum_variant::Items>();
+    for (int i{}; i < 10; ++i)
+      items->emplace_back(new Item);
+    fake::Ref<IEnumVARIANT> enumerator{new fake::Enum_variant{items}};
+    items.reset();
+
+    w::Variant_batch batch{4};
+    HRESULT err{S_OK};
+    std::size_t count{};
+    while (err == S_OK) {
+      const auto slots = batch.prepare();
+      ULONG fetched{};
+      err = enumerator->Next(static_cast<ULONG>(slots.size()), slots.data(),
+        &fetched);
+      batch.commit(fetched);
+      for (std::size_t i{}; i < batch.size(); ++i) {
+        DMITIGR_WINCOM_CHECK(batch.get<IDispatch*>(i));
+        DMITIGR_WINCOM_CHECK(batch.get<IUnknown*>(i));
+        DMITIGR_WINCOM_CHECK(!batch.get<LONG>(i));
+        ++count;
+      }
+    }
+    DMITIGR_WINCOM_CHECK(count == 10);
+
+    batch.prepare();
+    auto& text = batch.add();
+    text.vt = VT_BSTR;
+    text.bstrVal = SysAllocString(L"text");
+    auto& number = batch.add();
+    number.vt = VT_I4;
+    number.lVal = 42;
+    DMITIGR_WINCOM_CHECK(batch.get<std::wstring_view>(0) == L"text");
+    DMITIGR_WINCOM_CHECK(batch.get<LONG>(1) == 42);
+    DMITIGR_WINCOM_CHECK(!batch.get<double>(1));
+  }
+  DMITIGR_WINCOM_CHECK(!fake::object_count);
+  DMITIGR_WINCOM_CHECK(!fake::bstr_count);
+}
+
+} // namespace
+
+int main()
+{
+  return w::test::run([]
+  {
+    test_fill();
+    test_leaks();
+    test_variant_batch();
+  });
+}
@@ -0,0 +1,257 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "../base/noncopymove.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom {
+
+/**
+ * @brief The hashed timer wheel.
+ *
+ * @details The timers are kept in the intrusive lists of the slots indexed
+ * by the expiration tick modulo the number of slots, so arming and
+ * disarming are O(1), and `advance()` visits the slots of the elapsed ticks
+ * only. The expiration is rounded up to the tick.
+ *
+ * @tparam Clock The clock with static `now()`, such as
+ * `std::chrono::steady_clock`.
+ *
+ * @remarks Thread-safe. The callbacks are called under the lock, so they
+ * must be short and must not use the wheel.
+ */
+template<class Clock>
+class Basic_timer_wheel final : private Noncopymove {
+public:
+  using Time_point = typename Clock::time_point;
+  using Duration = typename Clock::duration;
+
+  /// The timer owned by the caller.
+  class Timer final : private Noncopymove {
+  public:
+    /**
+     * @brief The constructor.
+     *
+     * @param callback The function of `data` called when the timer expires,
+     * which returns `true` to be called again on the next tick.
+     */
+    Timer(bool (*callback)(void*) noexcept, void* const data) noexcept
+      : callback_{callback}
+      , data_{data}
+    {}
+
+  private:
+    friend Basic_timer_wheel;
+
+    bool (*callback_)(void*) noexcept{};
+    void* data_{};
+    Timer* prev_{};
+    Timer* next_{};
+    std::int64_t expiry_{};
+    bool is_armed_{};
+  };
+
+  /// The constructor.
+  explicit Basic_timer_wheel(const Duration tick,
+    const std::size_t slot_count = 1024)
+    : tick_{tick}
+    , start_{Clock::now()}
+    , slots_(slot_count)
+  {
+    if (!(tick.count() > 0))
+      throw std::invalid_argument{"cannot create timer wheel: invalid tick"};
+    else if (!slot_count)
+      throw std::invalid_argument{"cannot create timer wheel: zero slots"};
+  }
+
+  /// @returns The tick.
+  Duration tick() const noexcept
+  {
+    return tick_;
+  }
+
+  /**
+   * @brief Arms `timer` to expire at `deadline` (not earlier than on the
+   * next tick).
+   *
+   * @par Requires
+   * `timer` is not armed, and outlives its arming.
+   */
+  void arm(Timer& timer, const Time_point deadline)
+  {
+    const std::lock_guard lg{mutex_};
+    if (timer.is_armed_)
+      throw std::logic_error{"cannot arm armed timer"};
+    const auto ticks = (deadline - start_ + tick_ - Duration{1}) / tick_;
+    link(timer, std::max<std::int64_t>(ticks, current_ + 1));
+  }
+
+  /// @returns `true` if `timer` was armed.
+  bool disarm(Timer& timer) noexcept
+  {
+    const std::lock_guard lg{mutex_};
+    if (!timer.is_armed_)
+      return false;
+    unlink(timer);
+    return true;
+  }
+
+  /**
+   * @brief Calls the callbacks of the timers expired by `now`.
+   *
+   * @returns The number of the callbacks called.
+   */
+  std::size_t advance(const Time_point now)
+  {
+    const std::lock_guard lg{mutex_};
+    const std::int64_t target = (now - start_) / tick_;
+    if (target <= current_)
+      return 0;
+
+    std::size_t result{};
+    const auto slot_count = static_cast<std::int64_t>(slots_.size());
+    const auto steps = std::min(target - current_, slot_count);
+    for (std::int64_t i{1}; i <= steps; ++i) {
+      auto* timer = slots_[static_cast<std::size_t>(
+          (current_ + i) % slot_count)];
+      while (timer) {
+        auto* const next = timer->next_;
+        if (timer->expiry_ <= target) {
+          unlink(*timer);
+          ++result;
+          if (timer->callback_(timer->data_))
+            link(*timer, target + 1);
+        }
+        timer = next;
+      }
+    }
+    current_ = target;
+    return result;
+  }
+
+  /// @returns The number of armed timers.
+  std::size_t size() const noexcept
+  {
+    const std::lock_guard lg{mutex_};
+    return size_;
+  }
+
+private:
+  Duration tick_{};
+  Time_point start_;
+  mutable std::mutex mutex_;
+  std::vector<Timer*> slots_;
+  std::int64_t current_{};
+  std::size_t size_{};
+
+  void link(Timer& timer, const std::int64_t expiry) noexcept
+  {
+    auto& head = slots_[static_cast<std::size_t>(expiry) % slots_.size()];
+    timer.expiry_ = expiry;
+    timer.prev_ = nullptr;
+    timer.next_ = head;
+    if (head)
+      head->prev_ = &timer;
+    head = &timer;
+    timer.is_armed_ = true;
+    ++size_;
+  }
+
+  void unlink(Timer& timer) noexcept
+  {
+    if (timer.prev_)
+      timer.prev_->next_ = timer.next_;
+    else
+      slots_[static_cast<std::size_t>(timer.expiry_) % slots_.size()] =
+        timer.next_;
+    if (timer.next_)
+      timer.next_->prev_ = timer.prev_;
+    timer.prev_ = timer.next_ = nullptr;
+    timer.is_armed_ = false;
+    --size_;
+  }
+};
+
+/// The timer wheel advanced by the own thread every tick.
+class Timer_thread final : private Noncopymove {
+public:
+  using Wheel = Basic_timer_wheel<std::chrono::steady_clock>;
+
+  /// Stops the thread.
+  ~Timer_thread()
+  {
+    {
+      const std::lock_guard lg{mutex_};
+      is_stopping_ = true;
+    }
+    cond_.notify_all();
+    thread_.join();
+  }
+
+  /**
+   * @brief The constructor.
+   *
+   * @param after_advance The function called by the thread after every
+   * advance of the wheel, outside of its lock (e.g. to do the work of the
+   * callbacks which is too long to do under the lock).
+   */
+  explicit Timer_thread(const Wheel::Duration tick,
+    const std::size_t slot_count = 1024,
+    std::function<void(Wheel&)> after_advance = {})
+    : wheel_{tick, slot_count}
+    , after_advance_{std::move(after_advance)}
+    , thread_{&Timer_thread::run, this}
+  {}
+
+  /// @returns The wheel.
+  Wheel& wheel() noexcept
+  {
+    return wheel_;
+  }
+
+private:
+  Wheel wheel_;
+  std::function<void(Wheel&)> after_advance_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool is_stopping_{};
+  std::thread thread_;
+
+  void run()
+  {
+    std::unique_lock lk{mutex_};
+    while (!cond_.wait_for(lk, wheel_.tick(), [this]{return is_stopping_;})) {
+      wheel_.advance(std::chrono::steady_clock::now());
+      if (after_advance_)
+        after_advance_(wheel_);
+    }
+  }
+};
+
+} // namespace dmitigr::wincom
@@ -0,0 +1,446 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "../base/noncopymove.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom {
+
+// -----------------------------------------------------------------------------
+// Trace_event
+// -----------------------------------------------------------------------------
+
+/// The configuration of the call tracer.
+struct Trace_config final {
+  /// The minimum duration of the call to be kept.
+  std::chrono::nanoseconds threshold{std::chrono::milliseconds{1}};
+};
+
+/// The traced call.
+struct Trace_event final {
+  /// The name of the wrapper class.
+  std::string_view class_name;
+  /// The name of the method of the wrapper.
+  std::string_view method_name;
+  /// The summary of the arguments (truncated).
+  std::string args;
+  /// The `HRESULT` of the call.
+  std::int32_t hresult{};
+  /// Was the call completed by an exception?
+  bool is_exception{};
+  /// The number of the tracing thread (reused after the thread exit).
+  std::uint32_t thread{};
+  std::chrono::steady_clock::time_point start;
+  std::chrono::nanoseconds duration{};
+};
+
+namespace detail {
+
+/// The ring buffer of the calls traced by a thread (single writer).
+class Trace_ring final {
+public:
+  /// The number of the most recent calls kept.
+  static constexpr std::size_t capacity{256};
+
+  /// The maximum size of the summary of the arguments.
+  static constexpr std::size_t max_args_size{47};
+
+  explicit Trace_ring(const std::uint32_t thread) noexcept
+    : thread_{thread}
+  {}
+
+  /// Writes the call to the next slot without locking.
+  void write(const char* const class_name, const char* const method_name,
+    const std::string_view args, const std::int32_t hresult,
+    const bool is_exception, const std::int64_t start,
+    const std::int64_t duration) noexcept
+  {
+    const auto head = head_.load(std::memory_order_relaxed);
+    auto& slot = slots_[head % capacity];
+    const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.class_name.store(class_name, std::memory_order_relaxed);
+    slot.method_name.store(method_name, std::memory_order_relaxed);
+    std::array<char, sizeof(Slot::args)> bytes{};
+    std::memcpy(bytes.data(), args.data(),
+      std::min(args.size(), max_args_size));
+    for (std::size_t i{}; i < slot.args.size(); ++i) {
+      std::uint64_t word;
+      std::memcpy(&word, bytes.data() + i*sizeof(word), sizeof(word));
+      slot.args[i].store(word, std::memory_order_relaxed);
+    }
+    slot.hresult.store(hresult, std::memory_order_relaxed);
+    slot.is_exception.store(is_exception, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(duration, std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  /// Appends the consistent slots to `result`.
+  void read(std::vector<Trace_event>& result) const
+  {
+    for (const auto& slot : slots_) {
+      const auto sequence = slot.sequence.load(std::memory_order_acquire);
+      if (!sequence || sequence % 2)
+        continue;
+
+      Trace_event event;
+      event.class_name = slot.class_name.load(std::memory_order_relaxed);
+      event.method_name = slot.method_name.load(std::memory_order_relaxed);
+      std::array<char, sizeof(Slot::args)> bytes;
+      for (std::size_t i{}; i < slot.args.size(); ++i) {
+        const auto word = slot.args[i].load(std::memory_order_relaxed);
+        std::memcpy(bytes.data() + i*sizeof(word), &word, sizeof(word));
+      }
+      event.hresult = slot.hresult.load(std::memory_order_relaxed);
+      event.is_exception = slot.is_exception.load(std::memory_order_relaxed);
+      event.start = std::chrono::steady_clock::time_point{
+        std::chrono::steady_clock::duration{
+          slot.start.load(std::memory_order_relaxed)}};
+      event.duration = std::chrono::nanoseconds{
+        slot.duration.load(std::memory_order_relaxed)};
+
+      // Skip the slot rewritten while being read.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+        continue;
+
+      event.args.assign(bytes.data(), std::strlen(bytes.data()));
+      event.thread = thread_;
+      result.push_back(std::move(event));
+    }
+  }
+
+  /// @returns The number of calls written so far.
+  std::uint64_t written_count() const noexcept
+  {
+    return head_.load(std::memory_order_acquire);
+  }
+
+private:
+  struct Slot final {
+    // Odd while the slot is being written.
+    std::atomic_uint32_t sequence{};
+    std::atomic<const char*> class_name{};
+    std::atomic<const char*> method_name{};
+    std::array<std::atomic_uint64_t, (max_args_size + 1)/8> args{};
+    std::atomic<std::int32_t> hresult{};
+    std::atomic_bool is_exception{};
+    std::atomic_int64_t start{};
+    std::atomic_int64_t duration{};
+  };
+
+  std::array<Slot, capacity> slots_{};
+  std::atomic_uint64_t head_{};
+  std::uint32_t thread_{};
+};
+
+/// The registry of the per-thread rings.
+class Trace_registry final {
+public:
+  /// @returns The instance (which is never destroyed).
+  static Trace_registry& instance()
+  {
+    static auto* const result = new Trace_registry;
+    return *result;
+  }
+
+  /// @returns The ring of the current thread.
+  static Trace_ring& ring()
+  {
+    if (!current_ring_)
+      acquire_ring();
+    return *current_ring_;
+  }
+
+  /// @returns The threshold in nanoseconds, or `-1` if tracing is disabled.
+  std::int64_t threshold() const noexcept
+  {
+    return threshold_.load(std::memory_order_relaxed);
+  }
+
+  void configure(const std::optional<Trace_config>& config) noexcept
+  {
+    threshold_.store(config ? std::max<std::int64_t>(
+        config->threshold.count(), 0) : -1, std::memory_order_relaxed);
+  }
+
+  /// @returns The events of all the rings in order of start.
+  std::vector<Trace_event> snapshot() const
+  {
+    std::vector<Trace_event> result;
+    {
+      const std::lock_guard lg{mutex_};
+      for (const auto& ring : rings_)
+        ring->read(result);
+    }
+    std::sort(result.begin(), result.end(),
+      [](const auto& lhs, const auto& rhs){return lhs.start < rhs.start;});
+    return result;
+  }
+
+  /// @returns The number of calls kept so far, including overwritten ones.
+  std::uint64_t written_count() const
+  {
+    const std::lock_guard lg{mutex_};
+    std::uint64_t result{};
+    for (const auto& ring : rings_)
+      result += ring->written_count();
+    return result;
+  }
+
+private:
+  /// Returns the ring to the registry at the thread exit.
+  struct Ring_holder final {
+    ~Ring_holder()
+    {
+      if (current_ring_) {
+        auto& registry = instance();
+        const std::lock_guard lg{registry.mutex_};
+        registry.free_rings_.push_back(current_ring_);
+        current_ring_ = nullptr;
+      }
+    }
+  };
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Trace_ring>> rings_;
+  std::vector<Trace_ring*> free_rings_;
+  std::atomic_int64_t threshold_{-1};
+  constinit static inline thread_local Trace_ring* current_ring_{};
+
+  Trace_registry() = default;
+
+  static void acquire_ring()
+  {
+    thread_local Ring_holder holder;
+    auto& registry = instance();
+    const std::lock_guard lg{registry.mutex_};
+    if (!registry.free_rings_.empty()) {
+      current_ring_ = registry.free_rings_.back();
+      registry.free_rings_.pop_back();
+    } else {
+      registry.rings_.push_back(std::make_unique<Trace_ring>(
+          static_cast<std::uint32_t>(registry.rings_.size() + 1)));
+      current_ring_ = registry.rings_.back().get();
+    }
+  }
+};
+
+/// The summary of no arguments.
+struct No_trace_args final {
+  std::string_view operator()() const noexcept
+  {
+    return {};
+  }
+};
+
+/// Appends `value` to `result` with non-ASCII characters replaced by `?`.
+template<class Char>
+void append_trace_args(std::string& result,
+  const std::basic_string_view<Char> value)
+{
+  const auto size = std::min(value.size(),
+    Trace_ring::max_args_size - result.size());
+  for (std::size_t i{}; i < size; ++i) {
+    const auto ch = value[i];
+    result += ch >= 0x20 && ch < 0x7f ? static_cast<char>(ch) : '?';
+  }
+}
+
+} // namespace detail
+
+/// Enables tracing with `config`, or disables it if `config` is empty.
+inline void configure_tracing(const std::optional<Trace_config>& config)
+{
+  detail::Trace_registry::instance().configure(config);
+}
+
+/**
+ * @returns The kept calls of all the threads in order of start (up to the
+ * `256` most recent ones per thread).
+ */
+inline std::vector<Trace_event> trace_events()
+{
+  return detail::Trace_registry::instance().snapshot();
+}
+
+/// @returns The number of calls kept so far, including overwritten ones.
+inline std::uint64_t trace_event_count()
+{
+  return detail::Trace_registry::instance().written_count();
+}
+
+/**
+ * @returns The JSON object of `events` in the Chrome Trace Event Format
+ * (complete events in microseconds, loadable by `chrome://tracing` or
+ * Perfetto).
+ */
+inline std::string to_chrome_trace(const std::vector<Trace_event>& events)
+{
+  const auto us = [](const auto duration)
+  {
+    char buf[32];
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      duration).count();
+    std::snprintf(buf, sizeof(buf), "%lld.%03lld",
+      static_cast<long long>(ns / 1000), static_cast<long long>(ns % 1000));
+    return std::string{buf};
+  };
+  const auto escaped = [](const std::string_view value)
+  {
+    std::string result;
+    for (const char ch : value) {
+      if (ch == '"' || ch == '\\')
+        result += '\\';
+      result += ch;
+    }
+    return result;
+  };
+
+  std::string result{"{\"traceEvents\":["};
+  bool is_first{true};
+  for (const auto& e : events) {
+    if (!is_first)
+      result += ',';
+    is_first = false;
+    char hresult[16];
+    std::snprintf(hresult, sizeof(hresult), "0x%08X",
+      static_cast<unsigned>(e.hresult));
+    result.append("{\"name\":\"").append(e.class_name).append("::")
+      .append(e.method_name)
+      .append("\",\"cat\":\"wincom\",\"ph\":\"X\",\"pid\":1,\"tid\":")
+      .append(std::to_string(e.thread))
+      .append(",\"ts\":").append(us(e.start.time_since_epoch()))
+      .append(",\"dur\":").append(us(e.duration))
+      .append(",\"args\":{\"hresult\":\"").append(hresult)
+      .append("\",\"args\":\"").append(escaped(e.args)).append("\"");
+    if (e.is_exception)
+      result.append(",\"exception\":true");
+    result.append("}}");
+  }
+  result.append("],\"displayTimeUnit\":\"ms\"}");
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Trace_scope
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Traces the call made within the scope, which is kept if tracing is
+ * enabled and the call lasted not less than the configured threshold.
+ *
+ * @details The summary of the arguments is made only for the kept calls.
+ *
+ * @tparam Args The type of function which returns the summary of the
+ * arguments convertible to either `std::string_view` or `std::wstring_view`.
+ *
+ * @par Requirements
+ * The names are string literals.
+ *
+ * @par Example
+ * @code
+ * Trace_scope trace{"Locator", "connect_server",
+ *   [&]{return std::wstring_view{network_resource};}};
+ * const auto err = ...;
+ * trace.set_result(err);
+ * @endcode
+ */
+template<class Args = detail::No_trace_args>
+class Trace_scope final : private Noncopymove {
+public:
+  /// Records the call if it's kept.
+  ~Trace_scope()
+  {
+    if (!is_started_)
+      return;
+
+    const auto finish = std::chrono::steady_clock::now();
+    const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      finish - start_).count();
+    if (duration < threshold_)
+      return;
+
+    const bool is_exception{std::uncaught_exceptions() > exception_count_};
+    std::string args;
+    try {
+      using R = std::invoke_result_t<Args&>;
+      if constexpr (std::is_convertible_v<R, std::string_view>)
+        detail::append_trace_args(args, std::string_view{args_()});
+      else
+        detail::append_trace_args(args, std::wstring_view{args_()});
+    } catch (...) {}
+    detail::Trace_registry::ring().write(class_name_, method_name_, args,
+      hresult_, is_exception, start_.time_since_epoch().count(), duration);
+  }
+
+  /// Starts the tracing of the call if tracing is enabled.
+  Trace_scope(const char* const class_name, const char* const method_name,
+    Args args = {})
+    : class_name_{class_name}
+    , method_name_{method_name}
+    , args_{std::move(args)}
+    , threshold_{detail::Trace_registry::instance().threshold()}
+    , is_started_{threshold_ >= 0}
+  {
+    if (is_started_) {
+      exception_count_ = std::uncaught_exceptions();
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  /// Sets the result of the call.
+  void set_result(const long hresult) noexcept
+  {
+    hresult_ = static_cast<std::int32_t>(hresult);
+  }
+
+private:
+  const char* class_name_{};
+  const char* method_name_{};
+  Args args_;
+  std::int64_t threshold_{};
+  bool is_started_{};
+  int exception_count_{};
+  std::int32_t hresult_{};
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace dmitigr::wincom
@@ -0,0 +1,220 @@
+// -*- C++ -*-
+//
+// Copyright 2024 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "../base/noncopymove.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::wincom {
+
+/**
+ * @brief A contiguous array of variants which owns the filled ones.
+ *
+ * @details The slots are filled either at once by the callee (e.g. by
+ * `IEnumVARIANT::Next()`) between `prepare()` and `commit()`, or one by one
+ * by `add()`. The filled slots are cleared in bulk by `clear()`, which is
+ * implied by `prepare()` and the destructor, so the array is reused without
+ * leaks.
+ *
+ * @tparam Traits The type with:
+ *   - `Variant`, which is value-initialized to the empty state;
+ *   - `static void clear(Variant&) noexcept`, which frees the value and
+ *   sets the empty state;
+ *   - `static bool is_empty(const Variant&) noexcept`;
+ *   - `template<class T> static std::optional<T> get(const Variant&) noexcept`,
+ *   which returns the value of type `T` without copying the data it refers
+ *   to, or `std::nullopt` if the variant holds a value of another type.
+ * (See `Variant_batch`.)
+ */
+template<class Traits>
+class Basic_variant_batch final : private Noncopymove {
+public:
+  using Variant = typename Traits::Variant;
+
+  /// The statistics of the batch.
+  struct Stats final {
+    /// The number of calls of `prepare()`.
+    std::size_t batches{};
+    /// The number of filled slots cleared.
+    std::size_t cleared{};
+    /**
+     * The number of non-empty slots found beyond the filled ones, i.e. filled
+     * but not committed. (Such slots are cleared when found. Detected only if
+     * `NDEBUG` is not defined.)
+     */
+    std::size_t leaked{};
+  };
+
+  /// Clears the filled slots.
+  ~Basic_variant_batch()
+  {
+    clear();
+    detect_leaks();
+  }
+
+  /// The constructor.
+  explicit Basic_variant_batch(const std::size_t capacity)
+    : slots_(capacity)
+  {
+    if (!capacity)
+      throw std::invalid_argument{"cannot create variant batch: zero capacity"};
+  }
+
+  /**
+   * @brief Clears the batch.
+   *
+   * @returns All the slots to be filled. (Should be followed by `commit()`.)
+   */
+  std::span<Variant> prepare() noexcept
+  {
+    clear();
+    detect_leaks();
+    ++stats_.batches;
+    return slots_;
+  }
+
+  /// Marks the first `size` slots returned by `prepare()` as filled.
+  void commit(const std::size_t size)
+  {
+    if (size > slots_.size())
+      throw std::out_of_range{"cannot commit variant batch: size exceeds"
+        " capacity"};
+    size_ = size;
+  }
+
+  /**
+   * @returns The next empty slot which is marked as filled.
+   *
+   * @throws `std::length_error` if the batch is full.
+   */
+  Variant& add()
+  {
+    if (size_ == slots_.size())
+      throw std::length_error{"cannot add to full variant batch"};
+    return slots_[size_++];
+  }
+
+  /// @returns The number of filled slots.
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  /// @returns The number of slots.
+  std::size_t capacity() const noexcept
+  {
+    return slots_.size();
+  }
+
+  /// @returns `true` if there are no filled slots.
+  bool is_empty() const noexcept
+  {
+    return !size_;
+  }
+
+  /// @returns The filled slots.
+  std::span<Variant> filled() noexcept
+  {
+    return std::span{slots_}.first(size_);
+  }
+
+  /// @overload
+  std::span<const Variant> filled() const noexcept
+  {
+    return std::span{slots_}.first(size_);
+  }
+
+  /// @returns The slot at `index`.
+  Variant& operator[](const std::size_t index) noexcept
+  {
+    return slots_[index];
+  }
+
+  /// @overload
+  const Variant& operator[](const std::size_t index) const noexcept
+  {
+    return slots_[index];
+  }
+
+  /**
+   * @returns The value of type `T` at `index`, or `std::nullopt` if the
+   * slot holds a value of another type.
+   *
+   * @remarks The returned value (e.g. string view or interface pointer) is
+   * owned by the batch and valid until the slot is cleared.
+   */
+  template<class T>
+  std::optional<T> get(const std::size_t index) const
+  {
+    if (!(index < size_))
+      throw std::out_of_range{"variant batch index out of range"};
+    return Traits::template get<T>(slots_[index]);
+  }
+
+  /**
+   * @returns The value at `index` which the caller is responsible to clear.
+   *
+   * @par Effects
+   * The slot at `index` is empty.
+   */
+  Variant detach(const std::size_t index)
+  {
+    if (!(index < size_))
+      throw std::out_of_range{"variant batch index out of range"};
+    return std::exchange(slots_[index], Variant{});
+  }
+
+  /// Clears the filled slots.
+  void clear() noexcept
+  {
+    for (std::size_t i{}; i < size_; ++i)
+      Traits::clear(slots_[i]);
+    stats_.cleared += size_;
+    size_ = 0;
+  }
+
+  /// @returns The statistics.
+  const Stats& stats() const noexcept
+  {
+    return stats_;
+  }
+
+private:
+  std::vector<Variant> slots_;
+  std::size_t size_{};
+  Stats stats_;
+
+  void detect_leaks() noexcept
+  {
+#ifndef NDEBUG
+    for (std::size_t i{size_}; i < slots_.size(); ++i) {
+      if (!Traits::is_empty(slots_[i])) {
+        Traits::clear(slots_[i]);
+        ++stats_.leaked;
+      }
+    }
+#endif
+  }
+};
+
+} // namespace dmitigr::wincom
@@ -21,11 +21,14 @@
 #include "../base/noncopymove.hpp"
 #include "../winbase/combase.hpp"
 #include "exceptions.hpp"
+#include "library.hpp"
 #include "object.hpp"
+#include "tracing.hpp"
 
 #include <cstdint>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 #include <Wbemidl.h>
 
@@ -49,7 +52,7 @@ public:
         " invalid name"};
 
     Value value;
-    const auto err = detail::api(*this).Get(name, 0,
+    const auto err = detail::call<&Api::Get>(*this, "Get", name, 0,
       &value.data.data(), &value.type, flavor);
     throw_if_error(err, "cannot get property "+winbase::utf16_to_utf8(name)
       +" of IWbemClassObject");
@@ -63,11 +66,15 @@ class Enum_class_object final :
 public:
   using Ua::Ua;
 
+  /// The proxy blanket is applied by `Services::exec_query()`.
+  static constexpr bool is_proxy_blanket_applied{true};
+
   Class_object next(const long timeout = WBEM_INFINITE)
   {
     IWbemClassObject* result{};
     ULONG result_count{};
-    const auto err = api().Next(timeout, 1, &result, &result_count);
+    const auto err = detail::call<&Api::Next>(*this, "Next", timeout, 1,
+      &result, &result_count);
     if (err == WBEM_S_NO_ERROR)
       return Class_object{result};
     else if (err != WBEM_S_FALSE)
@@ -81,20 +88,29 @@ class Services final : public Unknown_api<Services, IWbemServices> {
 public:
   using Ua::Ua;
 
+  /// The proxy blanket is applied by `Locator::connect_server()`.
+  static constexpr bool is_proxy_blanket_applied{true};
+
   template<class String>
   Enum_class_object exec_query(const String& query,
     const long flags = WBEM_FLAG_RETURN_IMMEDIATELY|WBEM_FLAG_FORWARD_ONLY,
     IWbemContext* const ctx = {}) const
   {
     IEnumWbemClassObject* result{};
-    const auto err = detail::api(*this).ExecQuery(detail::bstr("WQL"),
-      detail::bstr(query),
-      flags,
-      ctx,
-      &result);
-    throw_if_error(err, "cannot execute query to retrieve objects from"
-      " WMI services");
-    return Enum_class_object{result};
+    detail::with_configured_retry([&]
+    {
+      const auto err = detail::call<&Api::ExecQuery>(*this, "ExecQuery",
+        detail::bstr("WQL"),
+        detail::bstr(query),
+        flags,
+        ctx,
+        &result);
+      throw_if_error(err, "cannot execute query to retrieve objects from"
+        " WMI services");
+    });
+    Enum_class_object enumerator{result};
+    apply_proxy_blanket(&enumerator.api());
+    return enumerator;
   }
 
   /**
@@ -110,8 +126,8 @@ public:
     IWbemContext* const ctx = {}) const
   {
     IWbemClassObject* result{};
-    const auto err = detail::api(*this).GetObject(path, flags, ctx, &result,
-      nullptr);
+    const auto err = detail::call<&Api::GetObject>(*this, "GetObject", path,
+      flags, ctx, &result, nullptr);
     throw_if_error(err, "cannot get object from WMI services");
     return Class_object{result};
   }
@@ -130,19 +146,41 @@ public:
     const BSTR authority,
     IWbemContext* const ctx = {})
   {
+    Trace_scope trace{"wmi::Locator", "connect_server", [network_resource]
+    {
+      return std::wstring_view{network_resource ? network_resource : L""};
+    }};
     IWbemServices* result{};
-    const auto err = api().ConnectServer(
-      network_resource,
-      user,
-      password,
-      locale,
-      security_flags,
-      authority,
-      ctx,
-      &result);
-    throw_if_error(err, "cannot connect to "
-      +winbase::com::to_string(network_resource));
-    return Services{result};
+    detail::with_configured_circuit_breaker(host(network_resource), [&]
+    {
+      const auto err = detail::call<&Api::ConnectServer>(*this,
+        "ConnectServer",
+        network_resource,
+        user,
+        password,
+        locale,
+        security_flags,
+        authority,
+        ctx,
+        &result);
+      trace.set_result(err);
+      throw_if_error(err, "cannot connect to "
+        +winbase::com::to_string(network_resource));
+    });
+    Services services{result};
+    apply_proxy_blanket(&services.api());
+    return services;
+  }
+
+private:
+  /// @returns The host of `network_resource` like `\\\\host\\namespace`.
+  static std::wstring_view host(const BSTR network_resource) noexcept
+  {
+    std::wstring_view result{network_resource ? network_resource : L""};
+    if (!(result.starts_with(L"\\\\") || result.starts_with(L"//")))
+      return {};
+    result.remove_prefix(2);
+    return result.substr(0, result.find_first_of(L"\\/"));
   }
 };
 